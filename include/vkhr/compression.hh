@@ -0,0 +1,31 @@
+#ifndef VKHR_COMPRESSION_HH
+#define VKHR_COMPRESSION_HH
+
+#include <vkhr/memory_map.hh>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vkhr {
+    // Lossless coding of 32-bit words, that predicts each of them from the word 'stride' before (e.g.
+    // the same component of the previous vertex in a strand) and stores the difference ZigZag-encoded
+    // as a variable-length integer, so (e.g.) the indices of the segments only take a byte each. Floats
+    // are first mapped to integers with the same ordering, which makes their differences small whenever
+    // the floats are close, but the vertices along a strand are still around a million ulps apart, so
+    // they take three or four bytes instead of four. The words are split into ChunkSize chunks which
+    // don't depend on each other, and are (de)compressed in parallel. A compressed stream starts with
+    // a chunk table.
+    namespace compression {
+        static constexpr std::size_t ChunkSize { 65536 }; // words.
+
+        std::vector<char> compress(Span<std::uint32_t> words, std::size_t stride);
+        std::vector<char> compress(Span<float> floats, std::size_t stride);
+
+        // Of 'count' words, or false if the stream is shorter (or longer) than what was compressed.
+        bool decompress(const char* stream, std::size_t stream_size, std::uint32_t* words, std::size_t count, std::size_t stride);
+        bool decompress(const char* stream, std::size_t stream_size, float* floats, std::size_t count, std::size_t stride);
+    }
+}
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef VKHR_IMAGE_HH
 #define VKHR_IMAGE_HH
 
+#include <vkhr/job_system.hh>
+
 #include <glm/glm.hpp>
 
 #include <vector>
@@ -41,6 +43,9 @@ namespace vkhr {
         std::string save_time(const std::string& path) const;
         std::string save_time() const;
 
+        // The file that save_time would save into, e.g. for saving with an ImageWriter instead.
+        static std::string get_time_file_path(const std::string& path = "");
+
         void set_quality(int quality); // saving JPEG.
 
         unsigned get_width() const;
@@ -65,7 +70,8 @@ namespace vkhr {
         void clear();
         void clear(const Color& color);
 
-        void copy(const std::vector<glm::dvec3>& floating_point_data, double samples);
+        // Resolves the sum of the samples (mirrored), with the alpha as the number of them, with SSE.
+        void copy(const glm::vec4* floating_point_data); // get_pixel_count() of them.
 
         // TODO: support bilinear and bicubic interpolation later.
         void resize(const unsigned width, const unsigned height);
@@ -76,6 +82,10 @@ namespace vkhr {
 
         std::size_t get_shaded_pixel_count(const Color& background_color) const;
 
+        // Of the RGB channels in [0, 1], or infinite if the images aren't the same size. If it's
+        // given, the absolute differences of each pixel are also written into difference_image.
+        float get_root_mean_square_error(const Image& image, Image* difference_image = nullptr) const;
+
         template<typename F> void filter_neighborhood(F functor);
         template<typename F> void filter(F functor);
 
@@ -89,35 +99,35 @@ namespace vkhr {
 
     template<typename F>
     void Image::filter_neighborhood(F functor) {
-        #pragma omp parallel for schedule(dynamic)
-        for (int j = 0; j < get_height(); ++j)
-        for (int i = 0; i < get_width();  ++i) {
-            Color neighborhood_pixels[9];
-            constexpr int s = 3;
-
-            for (int y = -1; y <= 1; ++y)
-            for (int x = -1; x <= 1; ++x) {
-                const int p { (y + 1)*s + (x + 1) };
-                if ((i + x) < 0 || (i + x) > get_width() ||
-                    (j + y) < 0 || (j + y) > get_height()) {
-                    neighborhood_pixels[p] = { 0, 0, 0, 1 };
-                } else {
-                    neighborhood_pixels[p] = get_pixel(i+x, j+y);
+        JobSystem::get().parallel_for(0, get_height(), 16, [&](int j) {
+            for (int i = 0; i < get_width();  ++i) {
+                Color neighborhood_pixels[9];
+                constexpr int s = 3;
+
+                for (int y = -1; y <= 1; ++y)
+                for (int x = -1; x <= 1; ++x) {
+                    const int p { (y + 1)*s + (x + 1) };
+                    if ((i + x) < 0 || (i + x) > get_width() ||
+                        (j + y) < 0 || (j + y) > get_height()) {
+                        neighborhood_pixels[p] = { 0, 0, 0, 1 };
+                    } else {
+                        neighborhood_pixels[p] = get_pixel(i+x, j+y);
+                    }
                 }
-            }
 
-            set_pixel(i, j, functor(i, j, get_pixel(i, j),
-                                    neighborhood_pixels));
-        }
+                set_pixel(i, j, functor(i, j, get_pixel(i, j),
+                                        neighborhood_pixels));
+            }
+        });
     }
 
     template<typename F>
     void Image::filter(F functor) {
-        #pragma omp parallel for schedule(dynamic)
-        for (int j = 0; j < get_height(); ++j)
-        for (int i = 0; i < get_width();  ++i) {
-            set_pixel(i, j,  functor(i, j, get_pixel(i, j)));
-        }
+        JobSystem::get().parallel_for(0, get_height(), 16, [&](int j) {
+            for (int i = 0; i < get_width();  ++i) {
+                set_pixel(i, j,  functor(i, j, get_pixel(i, j)));
+            }
+        });
     }
 }
 
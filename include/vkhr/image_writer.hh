@@ -0,0 +1,44 @@
+#ifndef VKHR_IMAGE_WRITER_HH
+#define VKHR_IMAGE_WRITER_HH
+
+#include <vkhr/image.hh>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace vkhr {
+    // Encodes and saves the images on a thread of its own, in the order they were queued, so the
+    // frame they were taken in (e.g. a screenshot or a benchmark capture) doesn't wait for stb.
+    // The thread is only started once there's something to save, and finishes the queue on exit.
+    class ImageWriter final {
+    public:
+        ImageWriter() = default;
+        ~ImageWriter() noexcept;
+
+        ImageWriter(const ImageWriter&) = delete;
+        ImageWriter& operator=(const ImageWriter&) = delete;
+
+        void save(Image&& image, const std::string& file_path);
+
+        void wait(); // until all of the queued images have been saved.
+        std::size_t get_queued_count() const;
+
+    private:
+        void write_loop();
+
+        std::deque<std::pair<Image, std::string>> queue;
+        std::size_t writing { 0 }; // taken off the queue, but not saved yet.
+
+        mutable std::mutex queue_mutex;
+        std::condition_variable queued, written;
+        bool stopping { false };
+
+        std::thread write_thread;
+    };
+}
+
+#endif
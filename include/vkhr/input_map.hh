@@ -8,6 +8,7 @@
 
 #include <glm/glm.hpp>
 
+#include <chrono>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -150,6 +151,11 @@ namespace vkhr {
         bool released(const std::string& id) const;
 
         glm::vec2 get_mouse_position() const;
+        // Of every key, button, scroll, character and cursor movement so far, to notice any input.
+        std::size_t get_event_count() const;
+        // When the oldest of the events since the last call was polled (GLFW has no times of its
+        // own), and the time_point's epoch if there were none, e.g. for the input-to-photon latency.
+        std::chrono::steady_clock::time_point take_event_time();
         glm::vec2 get_scroll_offset() const;
         void reset_scrolling_offset();
 
@@ -170,6 +176,9 @@ namespace vkhr {
         static void scroll_callback(GLFWwindow*, double, double);
         static void key_callback(GLFWwindow*, int, int, int, int);
         static void char_callback(GLFWwindow*, unsigned int);
+        static void cursor_callback(GLFWwindow*, double, double);
+
+        void record_event();
 
         std::unordered_map<Input::Key, Input::State> key_state_map;
         std::unordered_map<Input::MouseButton, Input::State> mouse_button_state;
@@ -178,6 +187,9 @@ namespace vkhr {
 
         glm::vec2 scroll_offsets { 0.0f };
 
+        std::size_t event_count { 0 };
+        std::chrono::steady_clock::time_point first_event_time;
+
         bool mouse_locked { false };
         GLFWwindow* handle;
     };
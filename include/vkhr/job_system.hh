@@ -0,0 +1,254 @@
+#ifndef VKHR_JOB_SYSTEM_HH
+#define VKHR_JOB_SYSTEM_HH
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace vkhr {
+    // The one pool of threads every parallel loop and background load in vkhr runs on, so that
+    // the ray tracer, the voxelization and the asset loads can all run at once without having
+    // more threads than cores. It's sized to leave a core for the calling (render) thread, and
+    // that thread helps with its own loops too. Every worker has its own deque of jobs, which it
+    // takes the newest one from, and steals the oldest ones from the others when it's empty. The
+    // Low priority jobs (e.g. the loads) are only taken when there's nothing else left to run.
+    // On machines with more than one NUMA node, the workers are pinned to the cores of them, in
+    // blocks of consecutive workers per node, so parallel_for_nodes can keep memory on its node.
+    class JobSystem final {
+    public:
+        using Job = std::function<void()>;
+
+        enum Priority {
+            High,
+            Low
+        };
+
+        class Task;
+        using Handle = std::shared_ptr<Task>;
+
+        static JobSystem& get();
+
+        // Only before the first get(), later it's the same pool. 0 for one less than the cores.
+        static void set_thread_count(unsigned worker_count);
+
+        unsigned get_thread_count() const; // the workers, and the thread calling parallel_for.
+
+        // 0 on the threads that aren't workers, and 1 to get_thread_count() - 1 on the workers.
+        static unsigned get_thread_index();
+
+        // 1 if there's only one (or it isn't Linux), and then none of the workers are pinned.
+        unsigned get_numa_node_count() const;
+        static unsigned get_numa_node(); // the calling thread's, which is 0 on the non-workers.
+
+        // Runs the job once all of its dependencies have finished, which can be null handles.
+        Handle submit(Job job, const std::vector<Handle>& dependencies = { }, Priority priority = High);
+
+        // Blocks until the task has run, and rethrows what it threw. The workers run other jobs.
+        void wait(const Handle& task);
+        void wait(const std::vector<Handle>& tasks); // all of them, and then rethrows the first.
+
+        static bool is_done(const Handle& task);
+
+        // Calls function(i) for every i in [begin, end), in chunks of grain size iterations, on at
+        // most max_threads threads (0 for all of them) including the calling thread, and returns
+        // after they're all done. It's fine to nest them, since the caller always runs chunks too.
+        template<typename Function>
+        void parallel_for(int begin, int end, int grain, Function&& function, unsigned max_threads = 0);
+
+        // Like parallel_for one iteration at a time, but [begin, end) is split into a contiguous
+        // range per NUMA node, which the threads pinned to that node run first, and only then the
+        // other nodes' ones. The same loop over the same range then touches the same memory on the
+        // same node, so e.g. the pages that were first written by it stay local (and see below).
+        template<typename Function>
+        void parallel_for_nodes(int begin, int end, Function&& function, unsigned max_threads = 0);
+
+        ~JobSystem() noexcept;
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        class Task final {
+        public:
+            Task(Job job, Priority priority);
+
+        private:
+            friend class JobSystem;
+
+            Job job;
+            Priority priority;
+
+            std::atomic<unsigned> unfinished_dependencies { 1 }; // until it's submitted.
+
+            std::mutex mutex;
+            std::condition_variable finished_condition;
+            std::vector<Handle> dependents;
+            std::exception_ptr exception;
+            bool finished { false };
+        };
+
+    private:
+        JobSystem(unsigned worker_count);
+
+        void worker_loop(unsigned worker);
+
+        std::vector<unsigned> worker_nodes; // and the cores they're pinned to, if there are any.
+        std::vector<int> worker_cores;
+        unsigned numa_node_count { 1 };
+
+        void enqueue(Handle task);
+        Handle dequeue(unsigned worker); // own, stolen, and then low priority ones.
+        bool run_one(unsigned worker);
+        void finish(const Handle& task);
+
+        struct WorkerQueue {
+            std::mutex mutex;
+            std::deque<Handle> tasks;
+        };
+
+        std::vector<std::unique_ptr<WorkerQueue>> worker_queues;
+        WorkerQueue low_priority_queue;
+
+        std::atomic<unsigned> next_queue { 0 }; // for the ones that aren't submitted by workers.
+
+        std::mutex sleep_mutex;
+        std::condition_variable sleep_condition;
+        std::atomic<std::size_t> queued_tasks { 0 };
+        bool stopping { false };
+
+        std::vector<std::thread> workers;
+    };
+
+    template<typename Function>
+    void JobSystem::parallel_for(int begin, int end, int grain, Function&& function, unsigned max_threads) {
+        if (begin >= end)
+            return;
+
+        grain = std::max(grain, 1);
+
+        int chunks = (end - begin + grain - 1) / grain;
+
+        unsigned threads = max_threads ? std::min(max_threads, get_thread_count()) : get_thread_count();
+        unsigned helpers = std::min(threads, static_cast<unsigned>(chunks)) - 1;
+
+        if (helpers == 0) {
+            for (int i = begin; i < end; ++i)
+                function(i);
+            return;
+        }
+
+        // Shared with the helpers, which might only start after the loop is done, and find nothing.
+        struct Loop {
+            std::atomic<int> next_chunk { 0 };
+            std::atomic<int> finished_chunks { 0 };
+            std::mutex mutex;
+            std::condition_variable finished_condition;
+            std::exception_ptr exception;
+        };
+
+        auto loop = std::make_shared<Loop>();
+
+        auto run_chunks = [=, &function]() {
+            int chunk;
+            while ((chunk = loop->next_chunk.fetch_add(1)) < chunks) {
+                int first = begin + chunk * grain, last = std::min(first + grain, end);
+
+                try {
+                    for (int i = first; i < last; ++i)
+                        function(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock { loop->mutex };
+                    if (!loop->exception)
+                        loop->exception = std::current_exception();
+                }
+
+                if (loop->finished_chunks.fetch_add(1) + 1 == chunks) {
+                    std::lock_guard<std::mutex> lock { loop->mutex };
+                    loop->finished_condition.notify_all();
+                }
+            }
+        };
+
+        // The function is only used while there still are chunks left, i.e. before this returns.
+        for (unsigned helper { 0 }; helper < helpers; ++helper)
+            submit(run_chunks);
+
+        run_chunks();
+
+        // The chunks still running on the other threads. Only the workers run someone else's jobs
+        // meanwhile, since the other threads' loops have per-thread state that's indexed by that.
+        if (auto worker = get_thread_index()) {
+            while (loop->finished_chunks < chunks)
+                if (!run_one(worker - 1))
+                    std::this_thread::yield();
+        } else {
+            std::unique_lock<std::mutex> lock { loop->mutex };
+            loop->finished_condition.wait(lock, [&] { return loop->finished_chunks == chunks; });
+        }
+
+        if (loop->exception)
+            std::rethrow_exception(loop->exception);
+    }
+
+    template<typename Function>
+    void JobSystem::parallel_for_nodes(int begin, int end, Function&& function, unsigned max_threads) {
+        unsigned nodes = get_numa_node_count();
+        if (nodes == 1 || begin >= end)
+            return parallel_for(begin, end, 1, function, max_threads);
+
+        struct alignas(64) Range { // so the nodes' counters don't share a cache line.
+            std::atomic<int> next;
+            int end;
+        };
+
+        std::vector<Range> ranges(nodes);
+        for (unsigned node { 0 }; node < nodes; ++node) {
+            ranges[node].next = begin + static_cast<int>(static_cast<long long>(end - begin) * node / nodes);
+            ranges[node].end  = begin + static_cast<int>(static_cast<long long>(end - begin) * (node + 1) / nodes);
+        }
+
+        // Every call takes exactly one of the iterations, and there are as many calls as there are
+        // of them, so there's always one left for it on some node, and each of them is run once.
+        parallel_for(begin, end, 1, [&](int) {
+            unsigned home = get_numa_node();
+            for (unsigned i { 0 }; i < nodes; ++i) {
+                auto& range = ranges[(home + i) % nodes];
+                int iteration = range.next.fetch_add(1);
+                if (iteration < range.end) {
+                    function(iteration);
+                    return;
+                }
+            }
+        }, max_threads);
+    }
+
+    // Leaves the (trivial) elements uninitialized when a vector is resized, so their pages are put
+    // on the node of the thread that writes them first, e.g. in a parallel_for_nodes that clears
+    // them, and not on the one that resized it. Only for the buffers that are cleared after that.
+    template<typename T>
+    struct FirstTouchAllocator : std::allocator<T> {
+        template<typename U>
+        struct rebind { using other = FirstTouchAllocator<U>; };
+
+        FirstTouchAllocator() noexcept = default;
+        template<typename U>
+        FirstTouchAllocator(const FirstTouchAllocator<U>&) noexcept { }
+
+        template<typename U>
+        void construct(U* element) noexcept { ::new (static_cast<void*>(element)) U; }
+        template<typename U, typename... Arguments>
+        void construct(U* element, Arguments&&... arguments) {
+            ::new (static_cast<void*>(element)) U(std::forward<Arguments>(arguments)...);
+        }
+    };
+}
+
+#endif
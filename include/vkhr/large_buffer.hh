@@ -0,0 +1,47 @@
+#ifndef VKHR_LARGE_BUFFER_HH
+#define VKHR_LARGE_BUFFER_HH
+
+#include <cstddef>
+#include <vector>
+
+namespace vkhr {
+    // For the arrays that are tens to hundreds of MiB, like the volumes and the strands, where the
+    // scattered accesses (e.g. of voxelize_segments) miss the TLB on every other one with 4 KiB
+    // pages. They're aligned to a cache line, and the ones that are at least a HugePageSize are
+    // aligned to (and rounded up to) whole huge pages, and on Linux they're advised to be backed
+    // by transparent huge pages. It's only a hint, so it's still 4 KiB pages if THP is disabled.
+    namespace large_buffer {
+        static constexpr std::size_t CacheLineSize { 64 };
+        static constexpr std::size_t HugePageSize  { 2 * 1024 * 1024 };
+
+        void* allocate(std::size_t size_in_bytes);
+        void deallocate(void* memory, std::size_t size_in_bytes) noexcept;
+    }
+
+    template<typename T>
+    struct LargeAllocator {
+        using value_type = T;
+
+        LargeAllocator() noexcept = default;
+        template<typename U>
+        LargeAllocator(const LargeAllocator<U>&) noexcept { }
+
+        T* allocate(std::size_t count) {
+            return static_cast<T*>(large_buffer::allocate(count * sizeof(T)));
+        }
+
+        void deallocate(T* memory, std::size_t count) noexcept {
+            large_buffer::deallocate(memory, count * sizeof(T));
+        }
+    };
+
+    template<typename T, typename U>
+    bool operator==(const LargeAllocator<T>&, const LargeAllocator<U>&) noexcept { return true;  }
+    template<typename T, typename U>
+    bool operator!=(const LargeAllocator<T>&, const LargeAllocator<U>&) noexcept { return false; }
+
+    template<typename T>
+    using LargeBuffer = std::vector<T, LargeAllocator<T>>;
+}
+
+#endif
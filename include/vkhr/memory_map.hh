@@ -0,0 +1,129 @@
+#ifndef VKHR_MEMORY_MAP_HH
+#define VKHR_MEMORY_MAP_HH
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace vkhr {
+    // Read-only view into contiguous memory, either owned by some
+    // std::vector, or living in a memory-mapped file (see below).
+    template<typename T>
+    class Span final {
+    public:
+        Span() = default;
+        Span(const T* data, std::size_t size);
+        template<typename Allocator>
+        Span(const std::vector<T, Allocator>& vector); // e.g. a LargeBuffer.
+
+        const T* data() const;
+        std::size_t size() const;
+        std::size_t size_in_bytes() const;
+        bool empty() const;
+
+        const T* begin() const;
+        const T* end() const;
+
+        const T& operator[](std::size_t i) const;
+
+    private:
+        const T* pointer  { nullptr };
+        std::size_t count { 0 };
+    };
+
+    class MemoryMap final {
+    public:
+        MemoryMap() = default;
+        MemoryMap(const std::string& file_path);
+        ~MemoryMap() noexcept;
+
+        MemoryMap(MemoryMap&& memory_map) noexcept;
+        MemoryMap& operator=(MemoryMap&& memory_map) noexcept;
+
+        friend void swap(MemoryMap& lhs, MemoryMap& rhs);
+
+        operator bool() const;
+
+        bool open(const std::string& file_path);
+        void close();
+
+        const char* get_data() const;
+        std::size_t get_size() const;
+
+        // Drops the pages that have been read from the resident memory. They are read back
+        // from the file when they're touched again, since nothing in the mapping is written.
+        void evict() const;
+
+        // Returns an empty span if the region lies outside the file,
+        // or if it doesn't start at an offset that's aligned to a T.
+        template<typename T>
+        Span<T> view(std::size_t offset, std::size_t count) const;
+
+    private:
+        const char* data { nullptr };
+        std::size_t size { 0 };
+
+#ifdef WINDOWS
+        void* file_handle    { nullptr };
+        void* mapping_handle { nullptr };
+#else
+        int file_descriptor { -1 };
+#endif
+    };
+
+    template<typename T>
+    Span<T>::Span(const T* data, std::size_t size)
+                 : pointer { data }, count { size } {  }
+
+    template<typename T>
+    template<typename Allocator>
+    Span<T>::Span(const std::vector<T, Allocator>& vector)
+                 : pointer { vector.data() }, count { vector.size() } {  }
+
+    template<typename T>
+    const T* Span<T>::data() const {
+        return pointer;
+    }
+
+    template<typename T>
+    std::size_t Span<T>::size() const {
+        return count;
+    }
+
+    template<typename T>
+    std::size_t Span<T>::size_in_bytes() const {
+        return count * sizeof(T);
+    }
+
+    template<typename T>
+    bool Span<T>::empty() const {
+        return count == 0;
+    }
+
+    template<typename T>
+    const T* Span<T>::begin() const {
+        return pointer;
+    }
+
+    template<typename T>
+    const T* Span<T>::end() const {
+        return pointer + count;
+    }
+
+    template<typename T>
+    const T& Span<T>::operator[](std::size_t i) const {
+        return pointer[i];
+    }
+
+    template<typename T>
+    Span<T> MemoryMap::view(std::size_t offset, std::size_t count) const {
+        if (data == nullptr || offset + count * sizeof(T) > size || offset % alignof(T) != 0)
+            return Span<T> {  };
+        return Span<T> {
+            reinterpret_cast<const T*>(data + offset),
+            count
+        };
+    }
+}
+
+#endif
@@ -8,7 +8,12 @@
 // e.g. shared path could be: /usr/share/vkhr/
 // need to supply SHARED_PATH at compile time!
 
+#ifndef VKHR_CACHE_PATH
+#define VKHR_CACHE_PATH "build/"
+#endif
+
 #define ASSET(PATH)  VKHR_ASSETS_PATH PATH
+#define CACHE(PATH)  VKHR_CACHE_PATH  PATH
 
 #define IMAGE(PATH)  ASSET("images/"  PATH)
 #define MODEL(PATH)  ASSET("models/"  PATH)
@@ -5,16 +5,39 @@
 
 #include <vkhr/rasterizer/model.hh>
 #include <vkhr/rasterizer/hair_style.hh>
+#include <vkhr/rasterizer/hair_batch.hh>
 #include <vkhr/rasterizer/billboard.hh>
 #include <vkhr/rasterizer/linked_list.hh>
+#include <vkhr/rasterizer/weighted_blended.hh>
+#include <vkhr/rasterizer/temporal_anti_aliasing.hh>
+#include <vkhr/rasterizer/hair_target.hh>
+#include <vkhr/rasterizer/light_tiles.hh>
+#include <vkhr/rasterizer/depth_pyramid.hh>
+#include <vkhr/rasterizer/scattering_lut.hh>
+#include <vkhr/rasterizer/ray_tracer.hh>
+#include <vkhr/rasterizer/shading_rate_image.hh>
+#include <vkhr/rasterizer/stereo_target.hh>
+#include <vkhr/rasterizer/render_graph.hh>
 #include <vkhr/rasterizer/volume.hh>
+#include <vkhr/rasterizer/volume_target.hh>
 
 #include <vkhr/rasterizer/depth_map.hh>
+#include <vkhr/rasterizer/opacity_map.hh>
+#include <vkhr/rasterizer/filtered_shadow_map.hh>
 #include <vkhr/renderer.hh>
 #include <vkhr/rasterizer/pipeline.hh>
+#include <vkhr/rasterizer/quality_controller.hh>
+#include <vkhr/trace_recorder.hh>
+#include <vkhr/image_writer.hh>
+#include <vkhr/scene_graph/camera_path.hh>
 
 #include <vkpp/vkpp.hh>
 
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <future>
+#include <limits>
 #include <queue>
 #include <vector>
 #include <unordered_map>
@@ -25,7 +48,12 @@ namespace vk = vkpp;
 namespace vkhr {
     class Rasterizer final : public Renderer {
     public:
-        Rasterizer(Window& window, const SceneGraph& scene_graph);
+        // The frames_in_flight (2 or 3) is how many frames the CPU may record ahead of the GPU,
+        // it isn't tied to the swapchain image count. More is better throughput, but more latency.
+        // If the window is_offscreen, it has no surface, and the frames are only in the swapchain.
+        // With device_group, the GPU's whole device group is used, see peer_voxelization_enabled.
+        Rasterizer(Window& window, const SceneGraph& scene_graph, std::uint32_t frames_in_flight = 2,
+                   bool device_group = false);
 
         void build_render_passes();
         void recreate_swapchain(Window& window, SceneGraph& scene_graph);
@@ -34,29 +62,199 @@ namespace vkhr {
         void load(const SceneGraph& scene) override;
         void update(const SceneGraph& scene_graphs);
 
+        // After SceneGraph::reload, which only uploads the reloaded (or new) styles and models again,
+        // and re-uses the rest. All the per-scene buffers, maps and pipelines are still re-created.
+        void reload(const SceneGraph& scene_graph, const SceneGraph::Changes& changes);
+
         std::uint32_t fetch_next_frame();
 
         void draw(const SceneGraph& scene) override;
         void draw(Image& fullscreen_image);
+        // Only uploads the updated tiles (tile_size a side) of it since the last draw, see Billboard::stream_tiles.
+        void draw(Image& fullscreen_image, const std::vector<glm::uvec2>& updated_tiles, std::uint32_t tile_size);
+        // Traces the scene with ray queries instead, with the settings of the CPU raytracer, see vulkan::Raytracer.
+        void draw(const SceneGraph& scene_graph, const Raytracer& raytracer);
+        bool gpu_raytracing_enabled() const;
+
+        // Steps the simulation outside of a frame, and reads the strands back for the CPU raytracer,
+        // which refits its BVHs to them in update_hair_styles. It waits for them, but it's only done
+        // while the simulation is being ray traced, which takes far longer than the readback anyway.
+        void simulate(const SceneGraph& scene_graph, Raytracer& raytracer);
 
         void draw_depth(const SceneGraph& scene_graph, vk::CommandBuffer& command_buffer);
-        void draw_model(const SceneGraph& scene_graph, Pipeline& pipeline, vk::CommandBuffer& command_buffer, glm::mat4 = glm::mat4 { 1.0f });
+        // All of the shadow maps in one pass instead, fetching the geometry once, if any of them are dirty.
+        void draw_multiview_depth(const SceneGraph& scene_graph, const std::vector<bool>& dirty_shadow_maps, vk::CommandBuffer& command_buffer);
+        // Hashes what's drawn into shadow_maps[light] (the light, the nodes in it, and the settings), see draw_depth.
+        std::size_t get_shadow_map_state(const SceneGraph& scene_graph, std::uint32_t light) const;
+        // The first_node and node_count are for only drawing some of the nodes, e.g. in record_in_parallel.
+        // For draw_hairs they're the first_style and style_count of hair_instances[view] instead, see below.
+        void draw_model(const SceneGraph& scene_graph, Pipeline& pipeline, vk::CommandBuffer& command_buffer, glm::mat4 = glm::mat4 { 1.0f },
+                        std::uint32_t view = 0, // for model_visibility, in the same order as in draw_hairs.
+                        std::size_t first_node = 0, std::size_t node_count = std::numeric_limits<std::size_t>::max());
         void draw_color(const SceneGraph& scene_graph, vk::CommandBuffer& command_buffer);
-        void draw_hairs(const SceneGraph& scene_graph, Pipeline& pipeline, vk::CommandBuffer& command_buffer, glm::mat4 = glm::mat4 { 1.0f });
+        void draw_hairs(const SceneGraph& scene_graph, Pipeline& pipeline, vk::CommandBuffer& command_buffer, glm::mat4 = glm::mat4 { 1.0f },
+                        std::uint32_t view = 0, // 0 for the camera and 1 + i for shadow_maps[i], see cull_strands,
+                                                // and after those, for all of the lights (see draw_multiview_depth).
+                        vulkan::HairStyle::Expansion expansion = vulkan::HairStyle::Expansion::VertexInputs,
+                        std::size_t first_style = 0, std::size_t style_count = std::numeric_limits<std::size_t>::max());
+        // The nodes that are too far away to be raymarched are drawn as billboards with the impostors
+        // that were baked by the raytracer (see --bake-impostors) instead, over impostor_instances.
+        void draw_impostors(const SceneGraph& scene_graph, Pipeline& pipeline, vk::CommandBuffer& command_buffer,
+                            std::size_t first_style = 0, std::size_t style_count = std::numeric_limits<std::size_t>::max());
         void voxelize(const SceneGraph& a_scene_graph, vk::CommandBuffer& command_buffer);
 
-        // Direct Volume Render (DVR) the hair strands. This needs to be done after drawing models and styles.
-        void strand_dvr(const SceneGraph& scene_graph, Pipeline& pipeline, vk::CommandBuffer& command_buffer);
+        // Only the styles with dirty_volumes are voxelized (and so acquired) in the frame; the others keep
+        // their volumes from the last time, like the shadow maps. They're all dirty while simulating.
+        void update_volume_states(const SceneGraph& scene_graph);
+        // Hashes what the volumes of the style are voxelized from (its bounds, nodes, the light and the settings).
+        std::size_t get_volume_state(const SceneGraph& scene_graph, const HairStyle* hair_style) const;
+        std::size_t volume_pipeline_revision { 0 }; // bumped when the shaders are recompiled.
+
+        // Culls the strands that are outside of the view's frustum on the GPU, and with an occlusion_threshold,
+        // also the strands behind dense parts of the volume (which needs to be voxelized), for the indirect draws.
+        // With model_occlusion, the camera's strands behind the models in model_depth_pyramid are culled too.
+        void cull_strands(const SceneGraph& scene_graph, std::uint32_t view, const glm::mat4& view_projection,
+                          float occlusion_threshold, vk::CommandBuffer& command_buffer, bool model_occlusion = false);
+
+        // The transparency that orders the camera's segments exactly, without any per-pixel memory: sorted_hair_instances
+        // are the styles of hair_instances[0] farthest first (by their bounds' centers, from their first node), and each
+        // of their segments are sorted back-to-front on the GPU (see vulkan::HairStyle::sort), after cull_strands, so that
+        // draw_sorted_hairs can blend them straight into the color pass. Shared styles are sorted for their first node.
+        void sort_segments(const SceneGraph& scene_graph, vk::CommandBuffer& command_buffer);
+        void draw_sorted_hairs(const SceneGraph& scene_graph, Pipeline& pipeline, vk::CommandBuffer& command_buffer,
+                               std::size_t first_style = 0, std::size_t style_count = std::numeric_limits<std::size_t>::max());
+        bool depth_sorting_enabled() const;
+
+        // Voxelizes on the async compute queue, overlapping with the depth pass (if there's one).
+        void submit_voxelization(const SceneGraph& scene_graph);
+
+        // Steps the strands of every hair style if the simulation is enabled, before anything else in
+        // the frame reads their vertices, timed in the query pool of the queue that it's submitted to
+        // (if there is one). Each style collides against the model closest to the node it's drawn in.
+        void simulate(const SceneGraph& scene_graph, vk::CommandBuffer& command_buffer, vk::QueryPool* query_pool);
+
+        Simulation simulation; // settings of it.
+
+        // Adjusts imgui.parameters every frame to keep the hair passes within its budget, if enabled.
+        QualityController quality_controller;
+
+        // Direct Volume Render (DVR) the hair strands. This needs to be done after drawing models and styles,
+        // in the second subpass, with the depth_view being the input attachment of its render pass' framebuffer.
+        void strand_dvr(const SceneGraph& scene_graph, Pipeline& pipeline, vk::ImageView& depth_view, vk::CommandBuffer& command_buffer);
+
+        // Raymarches styles with raymarch_scale > 1 into the volume_targets. Must be outside a render pass.
+        void scaled_strand_dvr(const SceneGraph& scene_graph, Pipeline& pipeline, vk::CommandBuffer& command_buffer);
+        bool scaled_strand_dvr_enabled() const;
+
+        // Writes where each rasterized node's volume becomes opaque into the depth buffer, after the models and
+        // before the strands, so that the strands hidden behind it fail their early depth test instead of being
+        // shaded and inserted into the PPLL. Not with the WBOIT, since it doesn't sort, or the scaled hair pass.
+        void draw_opaque_depth(const SceneGraph& scene_graph, Pipeline& pipeline, vk::CommandBuffer& command_buffer,
+                               std::size_t first_node = 0, std::size_t node_count = std::numeric_limits<std::size_t>::max());
+        bool opaque_depth_enabled() const;
+
+        // Accumulates the strands into the layers of opacity_maps[light] with hair_opacity_pipeline. It must
+        // be in the opacity_pass, after the light's depth map was drawn, since its layers start from that map.
+        void draw_opacity(const SceneGraph& scene_graph, std::uint32_t light, const glm::mat4& projection, vk::CommandBuffer& command_buffer,
+                          std::size_t first_style = 0, std::size_t style_count = std::numeric_limits<std::size_t>::max());
+        bool deep_opacity_maps_enabled() const;
+
+        // Prefilters the dirty shadow_maps into the filtered_shadow_maps after they are drawn, see draw_depth.
+        void filter_shadow_maps(const std::vector<bool>& dirty_shadow_maps, vk::CommandBuffer& command_buffer);
+        bool prefiltered_shadows_enabled() const;
+        // Or only converts them to linear depths in there, which the ADSM reads without any filtering.
+        void linearize_shadow_maps(const std::vector<bool>& dirty_shadow_maps, vk::CommandBuffer& command_buffer);
+        bool linear_shadow_maps_enabled() const;
+
+        // Rasterizes the styles that are software_rasterized in compute, into the PPLL for ppll.resolve.
+        // Must be outside a render pass, and after the color pass, since it reads from its depth buffer (see the render graph in draw_color).
+        void rasterize_strands(const SceneGraph& scene_graph, vk::ImageView& depth_view, vk::CommandBuffer& command_buffer);
+        bool software_rasterizer_enabled() const;
+
+        // Resolves it after the PPLL, in draw_color, with the camera jittered in update, see TemporalAntiAliasing.
+        bool temporal_anti_aliasing_enabled() const;
+
+        // Draws the hair passes into the hair_target at parameters.render_scale, instead of in the color pass,
+        // and upscales them over the models after the PPLL has been resolved into it, see draw_scaled_hairs.
+        bool scaled_hair_enabled() const;
+        void draw_scaled_hairs(const SceneGraph& scene_graph, Pipeline& hair_pipeline, vulkan::HairStyle::Expansion expansion,
+                               vk::CommandBuffer& command_buffer);
+        VkExtent2D get_hair_extent() const; // the color extent, if it's not scaled.
+        void set_hair_viewport(vk::CommandBuffer& command_buffer); // and shading rate, of the pipelines drawn in both.
 
         void destroy_pipelines();
         void destroy_render_passes();
         bool recompile_pipeline_shaders(Pipeline& pipeline);
+
+        // Compiles the shaders that have changed on another thread, while the current pipelines are still
+        // being drawn with, and then only rebuilds the pipelines with new SPIR-V at the start of the frame
+        // after it's done, see rebuild_recompiled_pipelines. It does nothing if it's still compiling.
         void recompile();
+        bool recompiling() const;
+
+        std::vector<vk::ShaderModule*> get_shader_modules();
+        void rebuild_recompiled_pipelines();
+        std::future<vk::ShaderModule::Sources> shader_compilation;
 
         bool swapchain_is_dirty() const;
 
+        // For the on-demand rendering, false if draw(scene_graph) would only draw the last frame again,
+        // i.e. the camera, lights, nodes and parameters haven't changed since it, and no simulation,
+        // screenshot, benchmark or recompile is going on. It's true for SettleFrames after any change,
+        // since e.g. the TAA and the dynamic quality take a few frames to converge, and the frames in
+        // flight need to be waited for to hand over the screenshots. Otherwise, the last image stays.
+        bool redraw_needed(const SceneGraph& scene_graph);
+        void request_redraw(); // e.g. for the input, which could change the GUI.
+
         Interface& get_imgui();
 
+        // Of the views in the color pass, which is each eye's half of the swapchain with stereo.
+        VkExtent2D get_color_extent() const;
+        bool stereo_enabled() const;
+
+        // In milliseconds, averaged over the last few frames.
+        struct FrameLatency {
+            float cpu_wait { 0.0f }; // blocked waiting for a frame in flight to finish.
+            float latency  { 0.0f }; // from the submit until the CPU saw that the GPU was done.
+            float peak_latency { 0.0f };
+
+            // But these are only of the latest frame, for e.g. the frame-time graph in the UI.
+            float cpu_time { 0.0f }; // from the last wait until this one, i.e. without cpu_wait.
+            float frame_interval { 0.0f }; // between the starts of the latest two frames.
+
+            // From the oldest input a frame was drawn with (see record_input_time) until it was on
+            // the screen, with VK_GOOGLE_display_timing, or else till the CPU saw the GPU was done.
+            float input_latency { 0.0f };
+            float peak_input_latency { 0.0f };
+            bool input_to_display { false };
+        };
+
+        const FrameLatency& get_frame_latency() const;
+        std::uint32_t get_frames_in_flight() const;
+
+        // Blocks until the next frame's one in flight is done, which draw does if it hasn't been,
+        // so that e.g. the low-latency mode can only poll the input after it, and not a frame early.
+        void wait_for_frame();
+        // When the oldest input the next frame is drawn with happened, if there was any, which is
+        // kept until a frame is submitted, and then correlated with when it got to the screen.
+        void record_input_time(std::chrono::steady_clock::time_point input_time);
+
+        // Of the memory that is on the GPU for each of these, in bytes. The swapchain is estimated,
+        // since its images belong to the driver, and other is what's left in the device allocator.
+        struct MemoryUsage {
+            VkDeviceSize geometry    { 0 };
+            VkDeviceSize volumes     { 0 };
+            VkDeviceSize ppll        { 0 };
+            VkDeviceSize shadow_maps { 0 };
+            VkDeviceSize swapchain   { 0 };
+            VkDeviceSize other       { 0 };
+        };
+
+        MemoryUsage get_memory_usage();
+        // Of every heap, see vk::PhysicalDevice::get_memory_budgets and VK_EXT_memory_budget.
+        std::vector<vk::PhysicalDevice::MemoryBudget> get_memory_budgets() const;
+        std::uint32_t get_device_memory_heap() const; // i.e. the VRAM.
+
         struct Benchmark {
             std::string description;
             std::string scene;
@@ -68,14 +266,43 @@ namespace vkhr {
             float viewing_distance;
             float strand_reduction;
             int   raymarch_steps;
+
+            vulkan::HairStyle::Expansion strand_expansion { vulkan::HairStyle::Expansion::VertexInputs };
+            bool temporal_anti_aliasing { false }; // or the GPAA of the strands.
+
+            int warmup_frames   { 60 }; // before the timestamps are recorded,
+            int measured_frames { 60 }; // and these are averaged in the CSV.
+
+            bool pipeline_statistics { false }; // and the PPLL fragments, see the CSV.
+
+            // Keyframes the camera is moved through (linearly) over all of the frames above, at
+            // a fixed step per frame, so the motion is the same in every run and on every GPU.
+            // When it's empty it stays at the scene's camera, but at the viewing_distance of it.
+            CameraPath camera_path;
         };
 
         void append_benchmark(const Benchmark& benchmark_parameters);
         void start_benchmark(SceneGraph& scene_graph);
         void append_benchmarks(const std::vector<Benchmark>& params);
+        // Queues every combination of the parameters of each of the benchmarks in a suite file,
+        // see share/benchmarks/default.json for the format. Returns false if it can't be parsed.
+        bool append_benchmarks(const std::string& suite_file);
 
         bool benchmark(SceneGraph& scene_graph);
 
+        // Copies the next frame that's drawn (without the GUI) into a host-visible buffer, and hands
+        // it over once that frame in flight is waited for again, instead of stalling for the copy.
+        void request_screenshot(std::function<void(Image&&)> screenshot_ready);
+        // As above, but then it's saved on the image_writer's thread, by date if there's no path.
+        void save_screenshot(const std::string& file_path = "");
+        // Hands over the screenshots of the frames still in flight (in order), e.g. before exiting.
+        void finish_screenshots();
+
+        // Steps the simulation by this many seconds per frame instead of by the time between them,
+        // e.g. for the video capture, where frames take as long as the encoder does. 0 is realtime.
+        void set_fixed_time_step(float seconds);
+
+        // These wait for the GPU, and are only for when the frame is needed right away, e.g. tools.
         Image get_screenshot(const SceneGraph& scene_graph);
         Image get_screenshot(const SceneGraph& scene_graph,
                              Raytracer& raytracer_instance);
@@ -83,11 +310,23 @@ namespace vkhr {
     private:
         Image get_screenshot();
 
+        // Moves the already uploaded styles and models out of these, instead of uploading them again.
+        void load(const SceneGraph& scene_graph,
+                  std::unordered_map<const HairStyle*, vulkan::HairStyle> loaded_styles,
+                  std::unordered_map<const Model*, vulkan::Model> loaded_models);
+
         vk::Instance instance;
         vk::PhysicalDevice physical_device;
         vk::Device device;
 
+        // Kept between runs, so only new or changed shaders need a rebuild.
+        vk::PipelineCache pipeline_cache;
+
         vk::CommandPool command_pool;
+        vk::CommandPool compute_command_pool; // async.
+
+        // Batches the uploads of everything made in load into one submit.
+        vk::StagingRing staging_ring;
 
         vk::Surface window_surface;
         vk::SwapChain swap_chain;
@@ -95,51 +334,385 @@ namespace vkhr {
         mutable bool swapchain_dirty { false };
 
         vk::RenderPass depth_pass;
+        vk::RenderPass multiview_depth_pass; // for the shadow_map_array, re-created in load.
+        vk::RenderPass opacity_pass;
         vk::RenderPass color_pass;
         vk::RenderPass imgui_pass;
+        vk::RenderPass scaled_volume_pass;
+        vk::RenderPass weighted_blended_pass;
+        vk::RenderPass hair_pass; // compatible with the color pass.
 
         vk::DescriptorPool descriptor_pool;
+        vk::DescriptorCache descriptor_cache;
 
         std::vector<vkpp::Framebuffer> framebuffers;
-        std::vector<vk::Semaphore> image_available, render_complete;
+        std::vector<vk::Semaphore> image_available; // per frame in flight.
+        std::vector<vk::Semaphore> render_complete; // per swapchain image.
+
+        // Signaled with the frame's number when it's done, so each frame waits
+        // for the value it was last submitted with before it's reused by CPU.
+        // If VK_KHR_timeline_semaphore is missing, command_buffer_finished are.
+        bool timeline_pacing { false };
+#ifdef VK_KHR_timeline_semaphore
+        vk::TimelineSemaphore frame_timeline;
+#endif
         std::vector<vk::Fence> command_buffer_finished;
+        std::uint64_t frames_submitted { 0 };
+        std::vector<std::uint64_t> frame_timeline_values;
+
+        std::vector<std::chrono::steady_clock::time_point> frame_submit_times;
+        std::chrono::steady_clock::time_point last_wait_start, last_wait_end;
+        FrameLatency frame_latency;
+        bool frame_waited { false }; // until the frame is submitted.
+
+        std::chrono::steady_clock::time_point next_input_time;
+        std::vector<std::chrono::steady_clock::time_point> frame_input_times;
+
+        // With it the presents with any input are given ids, and are waited for till they're shown
+        // (see the ones pending here) without blocking, since their timings are polled every frame.
+        bool display_timing { false };
+        std::uint32_t present_ids { 0 };
+        std::deque<std::pair<std::uint32_t, std::chrono::steady_clock::time_point>> pending_presents;
+        void measure_input_latency(std::chrono::steady_clock::time_point input_time,
+                                   std::chrono::steady_clock::time_point shown_time,
+                                   bool displayed);
+        void fetch_presentation_timing();
+        void submit_frame(const std::vector<vk::Semaphore*>& wait,
+                          const std::vector<VkPipelineStageFlags>& wait_stages,
+                          const std::vector<vk::Semaphore*>& signal);
+        void present_frame();
+
+        // The readbacks of the requested screenshots, one for each frame in flight, see draw.
+        struct ScreenshotReadback {
+            vk::HostBuffer buffer;
+            VkDeviceSize size { 0 };
+            std::uint32_t width { 0 }, height { 0 };
+            std::vector<std::function<void(Image&&)>> screenshots_ready; // or none if not in use.
+        };
+
+        std::vector<ScreenshotReadback> screenshot_readbacks;
+        std::vector<std::function<void(Image&&)>> screenshot_requests; // for the next frame.
+        void read_back_screenshot(vk::CommandBuffer& command_buffer);
+        void harvest_screenshot(std::uint32_t frame_index); // after the frame was waited for.
+
+        ImageWriter image_writer;
+
+        // A GPU timestamp (in ns) and the CPU time (of the TraceRecorder) it was written at,
+        // for putting the GPU passes in the trace on the same timeline as all the CPU scopes.
+        double gpu_calibration_time { 0.0 }, cpu_calibration_time { 0.0 };
+        void calibrate_timestamps();
+        void record_trace(const vk::QueryPool& query_pool);
+
+        // Hand-off between compute and graphics for the async voxelization.
+        std::vector<vk::Semaphore> voxelization_complete, volumes_released;
+        bool volumes_in_use { false }; // i.e. wait on volumes_released.
+
+        // If the device group has a second GPU, the async voxelization is submitted to it instead,
+        // and it copies the volumes into peer_volumes (in the memory of the first GPU), where the
+        // frame copies them back from with receive_volumes (see vulkan::HairStyle). Not with the
+        // simulation on, since the simulated strands would only be on the second GPU's memory.
+        static constexpr std::uint32_t PeerDevice { 1 };
+        bool peer_voxelization_supported { false };
+        bool peer_voxelization_enabled() const;
+        vk::DeviceBuffer peer_volumes;
+
+        // The frames are only drawn and presented by the first GPU, unlike the uploads (see Queue).
+        std::uint32_t get_frame_device() const;
+
+        static constexpr std::uint32_t SettleFrames { 16 };
+
+        struct DrawnState {
+            glm::mat4 view_matrix { 0.0f }, projection_matrix { 0.0f };
+            std::size_t light_source_revision { 0 }, node_revision { 0 };
+            Interface::Parameters parameters { };
+        } drawn_state; // of the last redraw_needed.
+        std::uint32_t settle_frames { SettleFrames };
+
+        std::chrono::steady_clock::time_point last_simulation_step;
+        float simulation_time { 0.0f }; // for the wind.
+        float fixed_time_step { 0.0f };
 
         vk::Sampler depth_sampler;
 
-        std::uint32_t frame { 0 };
+        // Half and quarter resolution raymarching targets.
+        std::vector<vulkan::VolumeTarget> volume_targets;
+        void create_volume_targets();
+
+        // Raymarched volume colors (with depth in alpha) per frame in flight, for the temporal accumulation.
+        std::vector<vk::Image> volume_history;
+        std::vector<vk::DeviceMemory> volume_history_memory;
+        std::vector<vk::ImageView> volume_history_views;
+        void create_volume_history();
+        void prepare_volume_history(vk::CommandBuffer& command_buffer);
+
+        // Segments binned per screen tile for rasterize_strands, shared by all styles like the voxels.
+        vk::StorageBuffer strand_tile_counts;
+        vk::StorageBuffer strand_tile_segments;
+        void create_strand_tiles();
+
+        glm::mat4 previous_view_projection { 1.0f };
+        std::uint32_t frame_number { 0 };
+
+        std::uint32_t frames_in_flight { 2 };
+
+        std::uint32_t frame { 0 }; // in flight, for the per-frame resources.
         std::uint32_t latest_drawn_frame { 0 };
-        float level_of_detail = 0;
 
-        std::vector<vk::UniformBuffer> camera;
-        std::vector<vk::UniformBuffer> lights;
-        std::vector<vk::UniformBuffer> params;
+        std::uint32_t frame_image { 0 }; // acquired swapchain image.
+        std::uint32_t latest_drawn_image { 0 };
+
+        // The LoD of every node in get_nodes_with_hair_styles, from its distance, for rasterizing the
+        // near nodes, raymarching the far ones, and drawing the ones in between the two with both of
+        // them. Nodes whose bounds are outside of the view, or smaller than a pixel, aren't drawn.
+        struct NodeLevelOfDetail {
+            float level_of_detail;
+            float screen_area; // of its bounding sphere, in pixels.
+            bool on_screen;
+            bool impostor; // beyond lod_impostor_distance, so neither rasterized nor raymarched.
+        };
+
+        std::vector<NodeLevelOfDetail> hair_node_lods;
+        void update_hair_levels_of_detail(const SceneGraph& scene_graph);
+
+        // With parameters.adaptive_shadows, every shadow map is only drawn in a power-of-two square of
+        // about ShadowTexelsPerPixel texels for each pixel of the on-screen hair in the light, so their
+        // bake time follows how large the hair is on screen. They're grown right away, but are only
+        // shrunk once they're less than half as large, so they're not re-baked at every boundary.
+        // The light's matrices are scaled to the square when they're uploaded, see lights.glsl.
+        void update_shadow_map_resolutions(const SceneGraph& scene_graph);
+        std::size_t shadow_resolution_revision { 0 }; // added to the light revisions.
+        static constexpr float ShadowTexelsPerPixel { 1.0f };
+        static constexpr std::uint32_t MinShadowMapResolution { 128 };
+
+        // Sets the strand_ratio of the styles so that there are about parameters.strands_per_pixel over
+        // the largest area that they cover on screen (in any rasterized node). The strands have been
+        // shuffled when loading, so any prefix of their segments is a valid LoD, and the draws only
+        // need to shrink their count, while the shaders compensate with a higher opacity for them.
+        // With parameters.strand_merging, it's the closest cut of their hierarchy instead, where the
+        // strands that are left stand in for the ones that were merged into them, see HairStyle::merge.
+        void reduce_strands(const SceneGraph& scene_graph);
+
+        // The nearest and farthest of them, for only running the passes at least one node needs.
+        float nearest_level_of_detail  { 1.0f };
+        float farthest_level_of_detail { 0.0f };
+
+        // Task and mesh shaders are used for the pulled strands when VK_EXT_mesh_shader is there.
+        bool mesh_shading { false };
+
+        // With VK_KHR_ray_query (and the acceleration structures), the raytracer can also be run
+        // on the GPU, which is built on the first frame that is traced, and thrown away on loads.
+        bool ray_queries { false };
+#ifdef VK_KHR_ray_query
+        vulkan::Raytracer gpu_raytracer;
+        Pipeline ray_tracing_pipeline;
+#endif
+
+        // With VK_NV_shading_rate_image, the hair and the volume pipelines (not the stereo or WBOIT ones)
+        // are built with a shading rate palette, and it's only with parameters.variable_rate_shading that
+        // the shading_rate_image is bound for them, since they're at 1x1 with none, see set_hair_viewport.
+        bool shading_rate_images { false };
+        VkExtent2D shading_rate_texel_size { 0, 0 };
+        bool shading_rate_pipelines() const;
+        bool variable_rate_shading_enabled() const;
+        void set_hair_shading_rate(vk::CommandBuffer& command_buffer);
+#ifdef VK_NV_shading_rate_image
+        vulkan::ShadingRateImage shading_rate_image;
+        Pipeline shading_rate_pipeline;
+#endif
+
+        // Or else there's no hair_curves_pipeline, and the strands are drawn as pulled lines.
+        bool tessellated_curves { false };
+
+        // With VK_KHR_multiview (core in 1.1), and two or more lights, the shadow_maps are the layers of the
+        // shadow_map_array, and with parameters.multiview_shadows they're all drawn in a single pass, since
+        // otherwise the same geometry is drawn again for every light. There's no culling of it per light then.
+        bool multiview_supported { false };
+        std::uint32_t max_multiview_views { 0 };
+        bool multiview_shadows_enabled() const;
+
+        // With parameters.batched_depth, the hair of each shadow map is drawn with one indirect draw for all
+        // of the styles in it, from the hair_batch, which is a VK_KHR_draw_indirect_count draw if it's there.
+        // Those views aren't culled, since each style has its own culled segments, and the batch can't have.
+        bool indirect_count { false };
+        vulkan::HairBatch hair_batch;
+        Pipeline hair_batch_depth_pipeline;
+        bool hair_batch_enabled() const;
+
+        // Also with VK_KHR_multiview, if the camera is_stereo, both eyes are drawn in the same color pass
+        // into the stereo_target, with the eyes' matrices in the camera's ViewProjection, and the shadows
+        // and the volumes are shared between them. Only the paths with multiview shaders are drawn then,
+        // which are the vertex input strands, the models and the raymarcher into the PPLL (without the
+        // temporal accumulation), see use_stereo_paths, so the rest is switched off while it's stereo.
+        bool stereo_rendering { false };
+        vulkan::StereoTarget stereo_target;
+        void use_stereo_paths(Interface::Parameters& parameters) const;
+        vk::ImageView& get_depth_buffer_view(); // the color pass', i.e. the stereo_target's too.
+
+        // If the line pipelines were built for the strips (parameters.line_strips), which are
+        // never culled, since cull.comp outputs the segments that survived as line lists.
+        bool strip_topology { false };
+        void set_strip_topology(bool line_strips); // and rebuilds the pipelines if it changed.
+
+        // The shading and shadow parameters in params.glsl as specialization constants, which are baked
+        // into the pipelines with parameters.specialized_shaders, so the compiler can drop the branches
+        // and unroll the filter kernels. When any of them change, the pipelines are rebuilt, which comes
+        // from the device's PipelineCache for the variants that were built before. Otherwise it's all
+        // zero, and the shaders read them from the params UBO instead, for tweaking them cheaply.
+        struct ShaderParameters {
+            std::uint32_t specialized;
+            std::int32_t shading_model;
+            std::int32_t deep_shadows_kernel_size;
+            std::int32_t deep_shadows_sampling_type;
+            std::int32_t deep_shadows_stride_size;
+            std::int32_t deep_shadows_on;
+            std::int32_t deep_shadows_prefiltered;
+            std::int32_t pcf_shadows_kernel_size;
+            std::int32_t pcf_shadows_sampling_type;
+            std::int32_t pcf_shadows_on;
+            std::int32_t shadow_technique;
+        } shader_parameters { };
+        void specialize_shaders(); // and rebuilds the pipelines if they changed.
+
+        // The map entries of the shader_parameters above, at the offset into the shader's constant data.
+        static void add_shader_parameters(std::vector<VkSpecializationMapEntry>& constants, std::size_t offset);
+        static constexpr std::uint32_t ParamsConstantId { 16 }; // PARAMS_CONSTANT_ID in params.glsl.
+
+        // Only packed if every hair style in the scene asks for it.
+        HairStyle::Quantization strand_quantization { HairStyle::Quantization::None };
+
+        // The per-frame constants, bump-allocated from the frame's ring when the scene is loaded.
+        std::vector<vk::UniformRing> frame_constants;
+        std::vector<vk::UniformRing::Range> camera;
+        std::vector<vk::UniformRing::Range> lights;
+        std::vector<std::size_t> light_revisions; // of the light buffers in lights, only re-uploaded on changes.
+        std::vector<vk::UniformRing::Range> params;
+
+        // The HairStyle::Parameters of every hair style, one per stride, for one dynamic set binding.
+        vk::UniformBuffer strand_parameters;
+        VkDeviceSize strand_parameters_stride { 0 };
+
+        // Every hair style is drawn once for all of the nodes that share it, with the model matrices
+        // of those nodes packed from first_instance onwards, instead of with a draw for every node.
+        // Only the rasterized nodes are instanced, and only those inside each view's frustum, so all
+        // of the views (the camera and the shadow maps, in that order) are packed into one buffer.
+        struct HairInstances {
+            const HairStyle* hair_style;
+            std::uint32_t first_instance;
+            std::uint32_t instance_count;
+        };
+
+        std::vector<std::vector<HairInstances>> hair_instances; // [view]
+        std::vector<HairInstances> sorted_hair_instances; // of the camera, see sort_segments.
+        std::vector<HairInstances> impostor_instances; // on-screen impostor nodes, for the camera only.
+        std::vector<vulkan::HairStyle::Instance> hair_instance_data;
+        std::vector<vk::HostBuffer> hair_instance_buffers; // one per frame in flight.
+        void update_hair_instances(const SceneGraph& scene_graph);
+        void resize_hair_instances(std::size_t instance_count); // the pipelines need to be rebuilt.
+
+        // If each model node's bounds are inside of the frustum of the view, [view][node].
+        std::vector<std::vector<bool>> model_visibility;
+        void update_model_visibility(const SceneGraph& scene_graph);
+
+        // Scratch counters for the voxelization, big enough for the largest volume.
+        vk::StorageBuffer strand_voxels;
+        vk::StorageBuffer voxel_statistics;
 
         Pipeline hair_depth_pipeline;
+        Pipeline hair_opacity_pipeline;
+        Pipeline shadow_filter_pipeline;
         Pipeline mesh_depth_pipeline;
+        Pipeline hair_multiview_depth_pipeline;
+        Pipeline mesh_multiview_depth_pipeline;
         Pipeline hair_voxel_pipeline;
+        Pipeline hair_voxel_resolve_pipeline;
+        Pipeline hair_volume_mip_pipeline;
+        Pipeline hair_transmittance_pipeline;
+        Pipeline hair_ambient_occlusion_pipeline;
+        Pipeline hair_distance_field_pipeline;
+        Pipeline hair_simulation_pipeline;
+        Pipeline hair_interpolation_pipeline;
+        Pipeline hair_bounds_pipeline;
+        Pipeline hair_cull_pipeline;
+        Pipeline hair_bin_pipeline;
+        Pipeline hair_tile_pipeline;
+        Pipeline hair_sort_keys_pipeline;
+        Pipeline hair_sort_histogram_pipeline;
+        Pipeline hair_sort_scan_pipeline;
+        Pipeline hair_sort_scatter_pipeline;
 
         Pipeline strand_dvr_pipeline;
+        Pipeline hair_opaque_depth_pipeline;
         Pipeline ppll_blend_pipeline;
+        Pipeline wboit_composite_pipeline;
+        Pipeline taa_resolve_pipeline;
+        Pipeline hair_downsample_pipeline;
+        Pipeline hair_upscale_pipeline;
+
+        Pipeline scaled_dvr_pipeline;
+        Pipeline dvr_upsample_pipeline;
 
         Pipeline hair_style_pipeline;
+        Pipeline hair_pulled_lines_pipeline;
+        Pipeline hair_pulled_quads_pipeline;
+        Pipeline hair_curves_pipeline;
+        Pipeline hair_wboit_pipeline;
+        Pipeline hair_sorted_pipeline;
         Pipeline model_mesh_pipeline;
         Pipeline billboards_pipeline;
+        Pipeline hair_impostor_pipeline;
 
+        vulkan::DepthMapArray shadow_map_array; // if the shadow_maps are its layers.
         std::vector<vulkan::DepthMap> shadow_maps;
+        std::vector<vulkan::OpacityMap> opacity_maps; // one for each of the shadow_maps.
+        std::vector<vulkan::FilteredShadowMap> filtered_shadow_maps; // and these too.
         std::unordered_map<const HairStyle*, vulkan::HairStyle> hair_styles;
         std::unordered_map<const Model*, vulkan::Model> models;
         vulkan::Billboard fullscreen_billboard;
 
         vulkan::LinkedList ppll;
+        // Or switches to/from the deferred shading, and rebuilds the pipelines, if either changed.
+        void resize_ppll(std::size_t node_count, bool deferred_shading, bool packed_nodes);
+        void build_ppll_resolve_pipeline(); // the deferred one if the PPLL is.
+
+        // Used instead of the PPLL for the rasterized strands with parameters.transparency.
+        vulkan::WeightedBlended weighted_blended;
+
+        // Used instead of the GPAA of the strands with parameters.temporal_anti_aliasing.
+        vulkan::TemporalAntiAliasing temporal_anti_aliasing;
+        glm::vec2 camera_jitter { 0.0f }; // of the frame, in pixels.
+
+        // The strands, the PPLL and the raymarched volumes at parameters.render_scale, see scaled_hair_enabled.
+        vulkan::HairTarget hair_target;
+
+        // The lights reaching each screen tile, culled before the color pass, see draw_color.
+        vulkan::LightTiles light_tiles;
+        Pipeline light_culling_pipeline;
+
+        // The depth of the models from the camera, drawn before the strands are culled, so the ones that
+        // are hidden behind them (e.g. the back of the head) are never drawn. Without stereo, since the
+        // eyes are culled from behind them both (see Camera::get_culling_view_projection).
+        vulkan::DepthPyramid model_depth_pyramid;
+        Pipeline depth_pyramid_pipeline;
+        bool model_occlusion_enabled(const SceneGraph& scene_graph) const;
+        void draw_model_depth(const SceneGraph& scene_graph, const glm::mat4& view_projection, vk::CommandBuffer& command_buffer);
+
+        // Of the Marschner model, baked when the fiber has changed, before anything is shaded.
+        vulkan::ScatteringLut scattering_lut;
+        Pipeline scattering_lut_pipeline;
+        void bake_scattering_lut(vk::CommandBuffer& command_buffer);
 
         Interface imgui;
 
         void set_benchmark_configurations(const Benchmark& benchmark,       SceneGraph& scene_graph);
+        void follow_benchmark_camera_path(const Benchmark& benchmark,       SceneGraph& scene_graph);
         std::string get_benchmark_results(const Benchmark& benchmark, const SceneGraph& scene_graph,
                                           const Image& screenshot); // For finding the shaded pixels.
         std::string get_benchmark_header();
+        nlohmann::json get_benchmark_json(const Benchmark& benchmark, const SceneGraph& scene_graph,
+                                          const Image& screenshot);
 
         std::string final_benchmark_csv { "" };
+        nlohmann::json final_benchmark_json; // the same, but with all statistics, for dashboards.
         std::string benchmark_start_time;
         int benchmark_counter  = 0;
         int queued_benchmarks  = 0;
@@ -147,18 +720,115 @@ namespace vkhr {
         int frames_benchmarked = 0;
         Benchmark loaded_benchmark;
         std::string benchmark_directory { "" };
+        // Of every measured frame in the loaded_benchmark, saved next to its screenshot.
+        std::string benchmark_frame_csv { "" };
+        void record_benchmark_frame();
+        // Of the frame after the last measured one, read back without waiting for it.
+        Image benchmark_screenshot;
+        bool benchmark_captured { false };
 
         std::vector<vk::QueryPool> query_pools;
+        // Reset and written on the async compute queue, its timestamps are merged into the frame's.
+        std::vector<vk::QueryPool> compute_query_pools;
+        // Counts the invocations of the sections in the primary command buffers, if the GPU can.
+        std::vector<vk::QueryPool> statistics_pools;
+        bool pipeline_statistics_supported { false };
+        bool pipeline_statistics_enabled() const;
+        vk::QueryPool* get_statistics_pool();
 
         std::vector<vk::CommandBuffer> command_buffers;
+        std::vector<vk::CommandBuffer> compute_command_buffers;
+
+        // Every thread has its own command pool per frame in flight (since pools can't be shared
+        // between threads) with the secondary command buffers it has recorded the draws into.
+        struct RecordingThread {
+            vk::CommandPool command_pool;
+            std::deque<vk::CommandBuffer> command_buffers;
+            std::size_t recorded { 0 }; // this frame.
+        };
+
+        std::vector<std::vector<RecordingThread>> recording_threads; // [frame][thread].
+
+        // Some of the nodes of a subpass, which are recorded in a secondary command buffer.
+        struct RecordingBatch {
+            vk::RenderPass* render_pass;
+            std::uint32_t subpass;
+            vk::Framebuffer* framebuffer;
+            std::function<void(vk::CommandBuffer&)> record;
+            vk::CommandBuffer* command_buffer { nullptr };
+            std::size_t key { 0 }; // of its StaticBatch, if it's one.
+            std::size_t state { 0 }; // of what it records, see append_batches.
+        };
+
+        // The batches that record the same commands in every frame, e.g. the models, which are only
+        // recorded again when their state changes, and otherwise executed as they are. They're kept
+        // per frame in flight, like the recording threads, since the last one might still be running,
+        // and without the framebuffer, so that they can be executed in any of the swapchain images.
+        struct StaticBatch {
+            vk::CommandPool command_pool; // its own, since any of the threads could record it.
+            vk::CommandBuffer command_buffer;
+            std::size_t recorded_state { 0 };
+        };
+
+        std::vector<std::unordered_map<std::size_t, StaticBatch>> static_batches; // [frame][key].
+        std::size_t static_batch_revision { 0 }; // bumped when what they've recorded is re-created.
+        bool static_batches_enabled() const;
+
+        // Everything the draw_model and draw_hairs of the camera record, besides their resources.
+        std::size_t get_model_draw_state(const SceneGraph& scene_graph) const;
+        std::size_t get_hair_draw_state(const Pipeline& pipeline, vulkan::HairStyle::Expansion expansion) const;
+
+        // Splits the nodes into a batch per thread, with the timestamp for the whole range, if any.
+        // With a state too (and a timestamp, which tells them apart) they're static batches instead.
+        void append_batches(std::vector<RecordingBatch>& batches, std::size_t node_count,
+                            vk::RenderPass& render_pass, std::uint32_t subpass, vk::Framebuffer& framebuffer,
+                            const std::function<void(std::size_t, std::size_t, vk::CommandBuffer&)>& record,
+                            const char* timestamp = nullptr, std::size_t state = 0);
+
+        // Records the batches on every thread, which are then executed in the same order by the caller.
+        void record_in_parallel(std::vector<RecordingBatch>& batches);
+        void execute_batches(std::vector<RecordingBatch>& batches, std::size_t first, std::size_t last,
+                             vk::CommandBuffer& command_buffer);
+        bool parallel_recording_enabled() const;
+        void reset_recording_threads();
+
+        // The ImGui pass, which executes the recorded GUI instead if it's Interface::overlay_cached.
+        // It's recorded when the GUI has been built again, into one of these that none of the other
+        // frames in flight is still executing, and then executed as it is by every frame after that.
+        void draw_overlay(vk::CommandBuffer& command_buffer);
+
+        struct OverlayBatch {
+            vk::CommandBuffer command_buffer;
+            std::uint32_t pending_frames { 0 }; // a bit for each frame in flight that executed it.
+        };
+
+        std::vector<OverlayBatch> overlay_batches; // one per frame in flight, so there's one free.
+        OverlayBatch* latest_overlay { nullptr };
+        std::size_t overlay_revision { 0 }; // of the GUI that's recorded in it.
 
         friend class vulkan::HairStyle;
         friend class vulkan::Model;
         friend class vulkan::Volume;
         friend class vulkan::Billboard;
         friend class vulkan::LinkedList;
+        friend class vulkan::WeightedBlended;
+        friend class vulkan::TemporalAntiAliasing;
+        friend class vulkan::HairTarget;
+        friend class vulkan::LightTiles;
+        friend class vulkan::DepthPyramid;
+        friend class vulkan::HairBatch;
+        friend class vulkan::ScatteringLut;
+        friend class vulkan::StereoTarget;
+#ifdef VK_KHR_ray_query
+        friend class vulkan::Raytracer;
+#endif
+#ifdef VK_NV_shading_rate_image
+        friend class vulkan::ShadingRateImage;
+#endif
 
         friend class vulkan::DepthMap;
+        friend class vulkan::DepthMapArray;
+        friend class vulkan::VolumeTarget;
 
         friend class ::vkhr::Interface;
     };
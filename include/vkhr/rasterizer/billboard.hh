@@ -8,6 +8,8 @@
 
 #include <vkhr/scene_graph/camera.hh>
 
+#include <glm/glm.hpp>
+
 #include <vkpp/buffer.hh>
 #include <vkpp/command_buffer.hh>
 #include <vkpp/descriptor_set.hh>
@@ -15,6 +17,8 @@
 #include <vkpp/image.hh>
 #include <vkpp/sampler.hh>
 
+#include <vector>
+
 namespace vk = vkpp;
 
 namespace vkhr {
@@ -35,6 +39,13 @@ namespace vkhr {
 
             void send_img(vk::DescriptorSet&, Image&, vk::CommandBuffer&);
 
+            // Only copies the tiles (tile_size pixels a side, by their top-left pixel) of the image that
+            // changed since the last one into the frame's part of the persistently mapped upload_buffer,
+            // and from there into the billboard, so each frame in flight has its own, and nothing waits.
+            // Everything is uploaded the first time, or with a tile_size of 0. For the fullscreen ones.
+            void stream_tiles(Image& image, const std::vector<glm::uvec2>& tiles, std::uint32_t tile_size,
+                              std::uint32_t frame, vk::CommandBuffer& command_buffer);
+
             void draw(Pipeline& pipeline,
                       vk::DescriptorSet& descriptor_set,
                       vk::CommandBuffer& command_buffer) override;
@@ -47,6 +58,10 @@ namespace vkhr {
             vk::DeviceImage billboard_image;
             vk::Sampler billboard_sampler;
 
+            vk::HostBuffer upload_buffer; // a billboard for every frame in flight.
+            unsigned char* upload_data { nullptr };
+            bool uploaded { false };
+
             static int id;
         };
     }
@@ -17,6 +17,8 @@ namespace vk = vkpp;
 namespace vkhr {
     class Rasterizer;
     namespace vulkan {
+        class DepthMapArray;
+
         class DepthMap final {
         public:
             DepthMap(const std::uint32_t width, Rasterizer& vulkan_renderer,
@@ -30,8 +32,20 @@ namespace vkhr {
 
             DepthMap(Rasterizer& vulkan_renderer);
 
+            // Only a view of one of the layers, so that it can be sampled and drawn like the others, but the
+            // memory belongs to the depth_map_array, where all of the layers can be drawn at once instead.
+            DepthMap(DepthMapArray& depth_map_array, std::uint32_t layer,
+                     Rasterizer& vulkan_renderer, const LightSource& light_source);
+
             void update_dynamic_viewport_scissor_depth(vk::CommandBuffer& cb);
 
+            // Only the top-left square of it is drawn, and sampled with the light's matrix scaled to
+            // it (see Rasterizer::update_shadow_map_resolutions), the rest is left as it was cleared.
+            void set_resolution(std::uint32_t resolution);
+            std::uint32_t get_resolution() const;
+            std::uint32_t get_width() const; // of the whole image.
+            float get_resolution_scale() const; // of the whole image that's used.
+
             static VkFormat          get_attachment_format();
             static VkImageLayout     get_read_depth_layout();
             static VkImageLayout     get_attachment_layout();
@@ -41,9 +55,16 @@ namespace vkhr {
             vk::Framebuffer& get_framebuffer();
             vk::ImageView& get_image_view();
 
+            VkDeviceSize get_size_in_bytes() const; // of its memory, i.e. none for a layer.
+
             const LightSource* light { nullptr };
 
+            // Of everything that was drawn into it, so it is only re-baked once any of that changes.
+            std::size_t baked_state { 0 };
+
         private:
+            void create_sampler_and_viewport(std::uint32_t width, std::uint32_t height, Rasterizer& vulkan_renderer);
+
             vk::Image image;
             vk::DeviceMemory memory;
             vk::ImageView image_view;
@@ -52,6 +73,9 @@ namespace vkhr {
 
             VkViewport viewport;
             VkRect2D scissor;
+            VkExtent2D extent { 0, 0 };
+
+            bool array_layer { false };
 
             float constant_factor;
             float clamp;
@@ -59,6 +83,38 @@ namespace vkhr {
 
             static int id;
         };
+
+        // A depth map for every light in the layers of one image, so that they can all be drawn in a
+        // single pass with multiview (see Rasterizer::draw_multiview_depth), with the geometry fetched
+        // once for all of the lights instead of once per light. The layers are DepthMaps of their own too.
+        class DepthMapArray final {
+        public:
+            DepthMapArray(const std::uint32_t width, const std::uint32_t layers, Rasterizer& vulkan_renderer);
+
+            DepthMapArray() = default;
+
+            void update_dynamic_viewport_scissor_depth(vk::CommandBuffer& cb);
+
+            vk::Image& get_image();
+            vk::Framebuffer& get_framebuffer(); // for the multiview depth pass.
+
+            std::uint32_t get_layer_count() const;
+
+            VkDeviceSize get_size_in_bytes() const;
+
+        private:
+            vk::Image image;
+            vk::DeviceMemory memory;
+            vk::ImageView image_view;
+            vk::Framebuffer framebuffer;
+
+            VkViewport viewport;
+            VkRect2D scissor;
+
+            std::uint32_t layer_count { 0 };
+
+            static int id;
+        };
     }
 }
 
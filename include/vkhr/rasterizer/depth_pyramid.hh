@@ -0,0 +1,62 @@
+#ifndef VKHR_VULKAN_DEPTH_PYRAMID_HH
+#define VKHR_VULKAN_DEPTH_PYRAMID_HH
+
+#include <vkhr/rasterizer/pipeline.hh>
+#include <vkhr/rasterizer/depth_map.hh>
+
+#include <vkpp/command_buffer.hh>
+#include <vkpp/device_memory.hh>
+#include <vkpp/image.hh>
+#include <vkpp/sampler.hh>
+
+#include <cstdint>
+#include <vector>
+
+namespace vk = vkpp;
+
+namespace vkhr {
+    class Rasterizer;
+    namespace vulkan {
+        // The depth of the models from the camera, drawn in a pre-pass with the same pipeline as their
+        // shadow maps, and the mip chain of the farthest of them (see depth_pyramid.comp), so that the
+        // strand clusters that are behind the models can be culled before they're drawn (see cull.comp),
+        // e.g. the back of the head, instead of each of their fragments failing the depth test later.
+        class DepthPyramid final {
+        public:
+            DepthPyramid(Rasterizer& vulkan_renderer, std::uint32_t width, std::uint32_t height);
+
+            DepthPyramid() = default;
+
+            DepthMap& get_depth_map(); // drawn into with the depth_pass before build.
+
+            // Every level from the depth map, after the models have been drawn into it.
+            void build(Pipeline& pipeline, std::uint32_t frame, vk::CommandBuffer& command_buffer);
+
+            static void build_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer);
+
+            vk::Sampler& get_sampler();
+            vk::ImageView& get_image_view(); // of every level, in the general layout.
+
+            std::uint32_t get_mip_levels() const;
+
+            static constexpr std::uint32_t GroupSize { 8 };
+
+        private:
+            DepthMap depth_map;
+
+            // The first level is at half of the depth map's size, which is even.
+            vk::Image image;
+            vk::DeviceMemory memory;
+            vk::ImageView image_view;
+            std::vector<vk::ImageView> storage_views; // one per level.
+
+            vk::Sampler sampler;
+
+            std::uint32_t mip_levels { 0 };
+
+            static int id;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef VKHR_VULKAN_FILTERED_SHADOW_MAP_HH
+#define VKHR_VULKAN_FILTERED_SHADOW_MAP_HH
+
+#include <vkhr/rasterizer/pipeline.hh>
+#include <vkhr/rasterizer/depth_map.hh>
+
+#include <vkpp/command_buffer.hh>
+#include <vkpp/device_memory.hh>
+#include <vkpp/image.hh>
+#include <vkpp/sampler.hh>
+
+#include <cstdint>
+
+namespace vk = vkpp;
+
+namespace vkhr {
+    class Rasterizer;
+    namespace vulkan {
+        // Depth map of a light with the Gaussian PCF of approximate_deep_shadows
+        // already applied to it, in two separable passes, so that the strands
+        // only need to take one tap of it, instead of a kernel_width² of them.
+        class FilteredShadowMap final {
+        public:
+            FilteredShadowMap(const std::uint32_t width, Rasterizer& vulkan_renderer);
+
+            FilteredShadowMap() = default;
+
+            // The rows, then the columns, with the kernel in the parameters, see filter_deep_shadows.comp.
+            void filter(Pipeline& pipeline, DepthMap& depth_map, std::uint32_t frame, vk::CommandBuffer& command_buffer);
+            // Or only the depths from 0 at the light's near to 1 at its far, see linear_approximate_deep_shadows.
+            void linearize(Pipeline& pipeline, DepthMap& depth_map, float near, float far,
+                           std::uint32_t frame, vk::CommandBuffer& command_buffer);
+
+            static void build_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer);
+
+            static VkFormat get_format();
+
+            vk::Sampler& get_sampler();
+            vk::ImageView& get_image_view();
+
+            VkDeviceSize get_size_in_bytes() const; // of its memory.
+
+            static constexpr std::uint32_t GroupSize { 256 };
+
+        private:
+            std::uint32_t width { 0 };
+
+            vk::Image rows_image; // after the first pass.
+            vk::DeviceMemory rows_memory;
+            vk::ImageView rows_view;
+
+            vk::Image image;
+            vk::DeviceMemory memory;
+            vk::ImageView image_view;
+            vk::ImageView storage_view;
+
+            vk::Sampler sampler;
+
+            static int id;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef VKHR_VULKAN_HAIR_BATCH_HH
+#define VKHR_VULKAN_HAIR_BATCH_HH
+
+#include <vkhr/rasterizer/pipeline.hh>
+
+#include <vkhr/scene_graph/hair_style.hh>
+
+#include <vkpp/buffer.hh>
+#include <vkpp/command_buffer.hh>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace vk = vkpp;
+
+namespace vkhr {
+    class Rasterizer;
+    namespace vulkan {
+        // The vertices and segments of every hair style copied after each other into one pair of buffers,
+        // so that a shadow map is drawn with a single indirect draw of all the styles in the light's view,
+        // with a command for each style (and its nodes as the instances). The volume bounds each style is
+        // dequantized with are picked by gl_DrawID, see strand_batch_depth.vert. It's only for the depth
+        // passes, since the color pass samples the volumes of each style, that are bound one at a time.
+        class HairBatch final {
+        public:
+            // With a region of the draws for each of the views, see Rasterizer::hair_instances.
+            HairBatch(Rasterizer& vulkan_renderer, std::uint32_t views);
+
+            HairBatch() = default;
+
+            // Copies the vertices of the styles again, e.g. after they've been simulated.
+            void refresh(vk::CommandBuffer& command_buffer);
+
+            // Writes this frame's draws of the styles in every view of hair_instances, before they're
+            // recorded, since they might be recorded from many threads (see record_in_parallel).
+            void update(std::uint32_t frame);
+
+            // The ones of hair_instances[view] from the last update, inside of a depth pass.
+            void draw(Pipeline& pipeline, std::uint32_t frame, std::uint32_t view,
+                      const glm::mat4& projection, vk::CommandBuffer& command_buffer);
+
+            // If there's anything to draw, and with one line width, since it can't change within the draw.
+            bool is_drawable() const;
+
+            static void depth_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer);
+
+        private:
+            struct Range {
+                VkDeviceSize vertex_bytes;
+                std::int32_t vertex_offset;
+                std::uint32_t first_index;
+                std::uint32_t index_count;
+            };
+
+            std::unordered_map<const vkhr::HairStyle*, Range> ranges;
+
+            vk::DeviceBuffer vertices;
+            vk::DeviceBuffer indices;
+
+            // Written at every draw, one per frame in flight, with the draws of each view after each other.
+            std::vector<vk::HostBuffer> draw_commands; // VkDrawIndexedIndirectCommand.
+            std::vector<vk::HostBuffer> draw_counts;
+            std::vector<vk::HostBuffer> draw_bounds;
+            std::vector<std::uint32_t> draw_count; // [view], of the last update.
+
+            std::uint32_t views { 0 };
+
+            Rasterizer* vulkan_renderer { nullptr };
+
+            static int id;
+        };
+    }
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define VKHR_VULKAN_HAIR_STYLE_HH
 
 #include <vkhr/scene_graph/hair_style.hh>
+#include <vkhr/scene_graph/simulation.hh>
 
 #include <vkhr/rasterizer/pipeline.hh>
 #include <vkhr/rasterizer/volume.hh>
@@ -14,37 +15,248 @@
 #include <vkpp/descriptor_set.hh>
 #include <vkpp/pipeline.hh>
 
+#include <vector>
+#include <string>
+
 namespace vk = vkpp;
 
 namespace vkhr {
     class Rasterizer;
     namespace vulkan {
+        class Model;
         class HairStyle final : public Drawable {
         public:
+            // The parameter_slot is its Parameters in Rasterizer::strand_parameters.
             HairStyle(const vkhr::HairStyle& hair_style,
-                      vkhr::Rasterizer& vulkan_renderer);
+                      vkhr::Rasterizer& vulkan_renderer,
+                      std::uint32_t parameter_slot = 0);
 
             HairStyle() = default;
 
             void load(const vkhr::HairStyle& hair_style,
                       vkhr::Rasterizer& scene_renderer);
 
-            void voxelize(Pipeline& voxelization_pipeline, vk::DescriptorSet& descriptor_set, vk::CommandBuffer& command_buffer);
+            // Re-voxelizes the strands into the density and tangent volumes and their mip chains, and then
+            // integrates the light's transmittance through them and the local AO into their volumes, as well as
+            // the distance field of the empty space. The voxel counters are shared by all hair styles (see
+            // Rasterizer) since they're only used in this pass.
+            // If recorded on an async compute queue, the volumes are released to the graphics one,
+            // which needs to call acquire_volumes before sampling them (after waiting for compute).
+            // With the compute family as both, they're only read by compute, e.g. transfer_volumes.
+            void voxelize(Pipeline& voxelization_pipeline, Pipeline& resolve_pipeline, Pipeline& mip_pipeline,
+                          Pipeline& transmittance_pipeline, Pipeline& ambient_occlusion_pipeline,
+                          Pipeline& distance_field_pipeline, std::uint32_t frame, vk::StorageBuffer& voxels, vk::StorageBuffer& voxel_statistics, vk::CommandBuffer& command_buffer,
+                          std::uint32_t compute_queue_family = VK_QUEUE_FAMILY_IGNORED,
+                          std::uint32_t graphics_queue_family = VK_QUEUE_FAMILY_IGNORED);
+            void acquire_volumes(std::uint32_t compute_queue_family, std::uint32_t graphics_queue_family,
+                                 vk::CommandBuffer& command_buffer);
+
+            // When another GPU of the device group voxelized them (see Rasterizer::peer_voxelization),
+            // which copies its volumes into 'peer_buffer' in this GPU's memory after voxelize, and
+            // then they're copied back into this GPU's volumes, instead of acquire_volumes. They're
+            // at 'offset' in it, and take up get_volume_transfer_size bytes of it from there on.
+            void transfer_volumes(vk::Buffer& peer_buffer, VkDeviceSize offset, vk::CommandBuffer& command_buffer);
+            void receive_volumes(vk::Buffer& peer_buffer, VkDeviceSize offset, vk::CommandBuffer& command_buffer);
+            VkDeviceSize get_volume_transfer_size();
+
+            // Steps the strands with the settings in 'simulation' (see simulate.comp), in place in the
+            // vertex and tangent buffers, so the rest of the frame (and the voxelization) uses them.
+            // The strands are pushed out of the collider's distance field, if there is one, where
+            // 'hair_to_collider' takes the strands into the space the distance field was baked in.
+            // With follow_hair, only the guides are simulated, and interpolate.comp moves the rest.
+            // The tangents are written along with the vertices, and bounds.comp then refits the
+            // clusters and (for float vertices) the volume_bounds in the parameter slot to them.
+            void simulate(Pipeline& simulation_pipeline, Pipeline& interpolation_pipeline, Pipeline& bounds_pipeline,
+                          std::uint32_t frame, const Simulation& simulation,
+                          float time_step, float time, vk::CommandBuffer& command_buffer,
+                          Model* collider = nullptr, const glm::mat4& hair_to_collider = glm::mat4 { 1.0f });
+
+            // Copies the (simulated) vertices into host memory after simulate, which fetch_vertices then
+            // decodes into the layout of the raytracer, once that command buffer has finished executing.
+            // The thickness isn't simulated, so it's the one in 'hair_style', which they were loaded from.
+            void read_back_vertices(vk::Device& device, vk::CommandBuffer& command_buffer);
+            void fetch_vertices(const vkhr::HairStyle& hair_style, std::vector<glm::vec4>& position_thickness,
+                                std::vector<glm::vec3>& tangents);
+
+            // Pushed before simulating the strands.
+            struct SimulationConstants {
+                glm::vec4 gravity; // and time step.
+                glm::vec4 wind;    // and time.
+                glm::mat4 hair_to_collider;
+                float damping;
+                float global_stiffness;
+                float global_range;
+                float local_stiffness;
+                std::uint32_t local_iterations;
+                std::uint32_t strand_count;
+                float collision_margin;
+                std::uint32_t collisions;
+            };
+
+            // Pushed before interpolating the strands from their guides.
+            struct InterpolationConstants {
+                std::uint32_t guide_count;
+                std::uint32_t strand_count;
+            };
+
+            // Pushed before refitting the bounds, and then again to resolve them.
+            struct BoundsConstants {
+                std::uint32_t resolve;
+            };
+
             void draw_volume(Pipeline& volume_pipeline,    vk::DescriptorSet& descriptor_set, vk::CommandBuffer& command_buffer);
 
+            // The billboards of 'instance_count' nodes (see Instances below) in one draw, with the style's
+            // octahedral impostor, if it has been baked (see Raytracer::bake_impostor) and loaded with it.
+            void draw_impostor(Pipeline& impostor_pipeline, vk::DescriptorSet& descriptor_set, vk::CommandBuffer& command_buffer,
+                               std::uint32_t instance_count);
+            bool has_impostor() const;
+
             void draw(Pipeline& vulkan_strand_rasterizer_pipeline,
                       vk::DescriptorSet& descriptor_set,
                       vk::CommandBuffer& command_buffer) override;
 
-            static void build_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer);
-            static void depth_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer);
+            // Culls the clusters of segments outside of the 'clip' frustum, or behind more than a few bricks of
+            // hair as seen from the 'eye' (in model space), and compacts the rest into the view's index buffer.
+            // After this, the draw with the same view index does an indirect draw of the surviving segments.
+            // View 0 is the camera and the rest are the shadow maps, an 'occlusion_threshold' of 0 disables
+            // the occlusion test, which needs the volumes to be voxelized and readable for the current frame.
+            // With 'model_depth_levels', the clusters behind the models in the Rasterizer's DepthPyramid
+            // are culled too, which has to be built from the same 'clip' (so it's only for the camera).
+            void cull(Pipeline& cull_pipeline, std::uint32_t view, const glm::mat4& clip, const glm::vec3& eye,
+                      float occlusion_threshold, vk::CommandBuffer& command_buffer,
+                      std::uint32_t model_depth_levels = 0);
+            void disable_culling(std::uint32_t view); // e.g. if the style is shared by many nodes.
+
+            // Rasterizes the strands in compute instead, for when they're thinner than a pixel, where the
+            // hardware mostly spends its time on tiny primitives and PPLL atomics. First bin_segments.comp
+            // appends the segments into the (screen-space) tiles they overlap, then tile_raster.comp sums
+            // their coverage and color per pixel in shared memory, and inserts a single fragment into the
+            // PPLL for every covered pixel. Must be outside a render pass, with the depth_view readable.
+            void rasterize(Pipeline& bin_pipeline, Pipeline& tile_pipeline, std::uint32_t frame, const glm::mat4& model,
+                           float level_of_detail, vk::StorageBuffer& tile_counts, VkExtent2D tiles,
+                           vk::ImageView& depth_view, vk::Sampler& depth_sampler, vk::CommandBuffer& command_buffer);
+
+            // How segments reach the rasterizer: as vertex inputs, or pulled from storage buffers in
+            // strand_pulled.vert (by gl_VertexIndex) as lines or quads expanded to the strand width.
+            // If the device has mesh shaders (Rasterizer::mesh_shading) the pulled ones use them
+            // instead, with strand.task frustum culling the clusters and strand_*.mesh emitting
+            // the segments of the visible ones, so these skip the culled buffers from cull too.
+            // Curves are drawn as patches of four pulled vertices (see curve_patches) that are
+            // tessellated into the lines of the Catmull-Rom curve through them, with the level
+            // from how curved and long each segment is on the screen, and are never culled.
+            enum class Expansion : std::uint32_t {
+                VertexInputs      = 0,
+                PulledLines       = 1,
+                PulledQuads       = 2,
+                TessellatedCurves = 3
+            };
+
+            // Pushed before the instanced draw below, with 'model' applied on top of the matrices
+            // of the instances from 'first_instance' onwards (see Rasterizer::hair_instances).
+            struct Instances {
+                glm::mat4 model;
+                std::uint32_t first_instance;
+            };
+
+            // What is stored for each instance, with the level of detail of its node.
+            struct Instance {
+                glm::mat4 model;
+                float level_of_detail;
+                float padding[3]; // for the std430 array stride.
+            };
+
+            // Draws 'instance_count' nodes sharing the style in one draw, which are never culled.
+            void draw(Pipeline& vulkan_strand_rasterizer_pipeline,
+                      vk::DescriptorSet& descriptor_set,
+                      vk::CommandBuffer& command_buffer,
+                      std::uint32_t view,
+                      Expansion expansion = Expansion::VertexInputs,
+                      std::uint32_t instance_count = 1);
+
+            // Sorts the camera's segments back-to-front by the view depth of their midpoints, with a radix sort
+            // of 16-bit keys in compute: sort_keys.comp quantizes them within the depth range of the style's bounds
+            // in 'model_view', and then for each 8-bit digit sort_histogram.comp counts them per block of keys,
+            // sort_scan.comp turns those counts into offsets, and sort_scatter.comp moves them there (stably),
+            // which writes the segments' indices in that order after the last digit. Like in draw, it's the
+            // culled segments if cull was called for the camera and it's only one node, so it has to be after
+            // that, and outside a render pass. Then draw_sorted draws them in that order with one draw.
+            void sort(Pipeline& key_pipeline, Pipeline& histogram_pipeline, Pipeline& scan_pipeline, Pipeline& scatter_pipeline,
+                      std::uint32_t frame, const glm::mat4& model_view, std::uint32_t instance_count,
+                      vk::CommandBuffer& command_buffer);
+            // With the vertex inputs and the line list topology of the DepthSorted pipeline, see below.
+            void draw_sorted(Pipeline& vulkan_strand_rasterizer_pipeline,
+                             vk::DescriptorSet& descriptor_set,
+                             vk::CommandBuffer& command_buffer,
+                             std::uint32_t instance_count = 1);
+
+            // Pushed before each pass of the sort.
+            struct SortConstants {
+                glm::mat4 model_view;
+                float nearest_depth;
+                float depth_range;
+                std::uint32_t segment_count;
+                std::uint32_t culled;
+                std::uint32_t pass;
+                std::uint32_t block_count;
+            };
+
+            // How the strands' fragments are made transparent, in the same order as Interface::Parameters::transparency.
+            // The PPLL sorts them per pixel, the WeightedBlended targets don't, and with DepthSorted they're blended
+            // straight into the color pass, after the segments are sorted (see sort), so it's only for VertexInputs.
+            enum class Transparency : std::uint32_t {
+                LinkedLists     = 0,
+                WeightedBlended = 1,
+                DepthSorted     = 2
+            };
+
+            static void build_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer,
+                                       Expansion expansion = Expansion::VertexInputs,
+                                       Transparency transparency = Transparency::LinkedLists);
+            // With multiview, into every layer of the Rasterizer::shadow_map_array, see strand_multiview_depth.vert.
+            static void depth_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer, bool multiview = false);
+            static void opacity_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer);
+            static void impostor_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer);
             static void voxel_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer);
+            static void voxel_resolve_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer);
+            static void volume_mip_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer);
+            static void transmittance_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer);
+            static void ambient_occlusion_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer);
+            static void distance_field_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer);
+            static void simulation_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer);
+            static void interpolation_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer);
+            static void bounds_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer);
+            static void cull_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer);
+            static void bin_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer);
+            static void tile_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer);
+            static void sort_keys_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer);
+            static void sort_histogram_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer);
+            static void sort_scan_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer);
+            static void sort_scatter_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer);
+
+            // One set of culled indices and draw command per view, with the descriptor set for culling it.
+            void create_culling_buffers(Pipeline& cull_pipeline, Rasterizer& vulkan_renderer);
+
+            // One set per frame in flight, shared by the bin and tile pipelines (which have the same layout).
+            void create_tile_descriptor_sets(Pipeline& tile_pipeline, Rasterizer& vulkan_renderer);
+
+            // The keys, histograms and sorted indices, with one set per frame in flight shared by the sort pipelines.
+            void create_sort_buffers(Pipeline& sort_pipeline, Rasterizer& vulkan_renderer);
+
+            static void add_vertex_inputs(Pipeline& pipeline_reference, vkhr::HairStyle::Quantization quantization);
+            // Line strips with primitive restart if Rasterizer::strip_topology, drawn with the strips.
+            static void set_line_topology(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer);
 
             void update_parameters();
 
+            // E.g. when it's re-used by Rasterizer::reload, which re-creates the strand_parameters.
+            void set_parameter_slot(std::uint32_t parameter_slot, vkhr::Rasterizer& vulkan_renderer);
+
             std::size_t get_geometry_size() const;
             std::size_t get_volume_size()   const;
 
+            static constexpr float Shininess { 80.0f }; // of every style, for Kajiya-Kay.
+
             struct Parameters {
                 AABB volume_bounds;
                 glm::vec3 volume_resolution;
@@ -53,31 +265,196 @@ namespace vkhr {
                 float hair_opacity;
                 float hair_shininess;
                 float strand_ratio;
+                int dual_scattering; // see dual_scattering.glsl.
+                float quantized_thickness; // see HairStyle::get_quantized_thickness.
             } parameters;
 
             void reduce(float ratio);
 
+            // Reduces them to the cut of the strand hierarchy closest to the ratio (see generate_clusters),
+            // with the coverage of the strands that are left scaled by how many of them they stand in for.
+            // Screen-space strands are as wide as any other (which is fine, since they are thinner than a
+            // pixel this far away), so the merged strand's coverage is widened with its thickness instead.
+            void merge(float ratio);
+            float get_merged_ratio(float ratio) const; // of that cut.
+            bool is_mergeable() const; // if it had its clusters, and isn't Packed.
+            bool is_merged() const;
+
+            // Raymarched at 1/scale of the resolution (see Rasterizer::update).
+            std::uint32_t raymarch_scale { 1 };
+
+            // In between the LoD distances, and if Interface::Parameters::software_rasterizer is on.
+            bool software_rasterized { false };
+
+            // Pixel wide lines, without the GPAA, if the temporal anti-aliasing is on.
+            bool native_width { false };
+
+            // What draw records into the command buffer for the view, other than the resources bound
+            // (and the parameters, which are read from their buffer), see Rasterizer::record_in_parallel.
+            struct DrawState {
+                float strand_ratio;
+                float strand_radius;
+                std::uint32_t merged_level; // of the thickness, or 0.
+                std::uint32_t flags; // native_width, software_rasterized, culled and mesh_shading.
+            };
+
+            DrawState get_draw_state(std::uint32_t view) const;
+
+            // What the volumes were last voxelized from, and if they have to be again in this frame.
+            std::size_t voxelized_state { 0 };
+            bool dirty_volumes { true };
+
+            static constexpr std::uint32_t BrickSize { 8 }; // Voxels per occupancy texel, see occupancy.glsl.
+            static constexpr std::uint32_t BrickApron { 1 }; // Voxels around each brick in the pools, see sample_volume.glsl.
+            static constexpr std::uint32_t BrickPoolWidth { 16 }; // Bricks per row and column of the pools.
+            static constexpr std::uint32_t MipScale { 4 }; // The mip chains start at 1/4 the resolution, see sample_volume.glsl.
+            static constexpr std::uint32_t ClusterSize { 64 }; // Segments per cluster, see cull.comp.
+            static constexpr std::uint32_t MeshTaskSize { 32 }; // Clusters per task, see strand.task.
+            static constexpr std::uint32_t TileSize { 16 }; // Pixels per side of a tile, see tiles.glsl.
+            static constexpr std::uint32_t TileSegments { 512 }; // Segments binned per tile, see tiles.glsl.
+            static constexpr std::uint32_t SortRadix { 256 }; // Digits of each pass over the keys, see sort.glsl.
+            static constexpr std::uint32_t SortBlockSize { 4096 }; // Keys per group of the sort, see sort.glsl.
+
         private:
+            // Allocates the bricks of 'strand_volume' with strands near them in the density and tangent pools,
+            // and creates the indirection into them in volume_bricks. Returns the resolution of the pools.
+            glm::uvec3 create_brick_pool(const vkhr::HairStyle::Volume& strand_volume,
+                                         LargeBuffer<unsigned char>& density_pool,
+                                         LargeBuffer<glm::i8vec2>& tangent_pool,
+                                         Rasterizer& vulkan_renderer);
+
+            // Binds the copy of descriptor_set with its parameters, volume, and writes.
+            void bind(Pipeline& pipeline, vk::DescriptorSet& descriptor_set, vk::CommandBuffer& command_buffer,
+                      bool vertex_inputs = true, std::vector<vk::DescriptorSet::Write> writes = {});
+
+            std::vector<vk::DeviceImage*> get_voxelized_volumes(); // all of the ones voxelize writes.
+
+            static std::vector<vk::DescriptorSet::Binding> tile_descriptor_bindings(Rasterizer& vulkan_renderer);
+            static void build_tile_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer, const std::string& shader, const std::string& name);
+            static void build_sort_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer, const std::string& shader, const std::string& name);
+
+            std::uint32_t get_sort_block_count() const; // for all of the segments.
+
+            bool mesh_shading { false }; // see Rasterizer::mesh_shading.
+
+            // Packed: vertices contains all of the attributes interleaved.
+            vkhr::HairStyle::Quantization quantization { vkhr::HairStyle::Quantization::None };
+
             vk::IndexBuffer  segments;
+            vk::IndexBuffer  curve_patches; // see create_curve_patches.
+            vk::IndexBuffer  strips; // see create_strip_indices, 16-bit if they fit.
             vk::VertexBuffer vertices;
             vk::VertexBuffer tangents;
             vk::VertexBuffer thickness;
 
+            // The thickness of every ClusterLevels cut, scaled by the merged strands, and zero past it.
+            std::vector<vk::VertexBuffer> merged_thickness;
+            unsigned merged_level { 0 };
+            bool merged { false };
+
+            vk::VertexBuffer& get_thickness(); // of the cut if it's merged.
+
             vk::ImageView density_view;
+            vk::ImageView density_storage_view; // for voxelize.
             vk::DeviceImage density_volume;
             vk::Sampler density_sampler;
 
             vk::ImageView tangent_view;
+            vk::ImageView tangent_storage_view; // for voxelize.
             vk::DeviceImage tangent_volume;
             vk::Sampler tangent_sampler;
 
-            vk::UniformBuffer parameter_buffer;
+            // Slot + 1 of every brick, and the brick of every slot in the pools above.
+            vk::StorageBuffer volume_bricks;
+            std::uint32_t brick_slot_count { 0 };
+
+            // Down to a voxel, for raymarching from afar. They are dense, but small.
+            vk::ImageView density_mips_view;
+            std::vector<vk::ImageView> density_mip_storage_views;
+            vk::DeviceImage density_mips;
+
+            vk::ImageView tangent_mips_view;
+            std::vector<vk::ImageView> tangent_mip_storage_views;
+            vk::DeviceImage tangent_mips;
+
+            vk::Sampler mip_sampler;
+
+            // From lights[0] to every voxel, at the resolution of the first mip level (see transmittance.comp).
+            vk::ImageView transmittance_view;
+            vk::ImageView transmittance_storage_view; // for voxelize.
+            vk::DeviceImage transmittance_volume;
+
+            // The local ambient occlusion of each voxel, at the same resolution (see ambient_occlusion.comp).
+            vk::ImageView ambient_occlusion_view;
+            vk::ImageView ambient_occlusion_storage_view; // for voxelize.
+            vk::DeviceImage ambient_occlusion_volume;
+
+            // The distance to the nearest voxel with strands, at the same resolution (see distance_field.comp).
+            vk::ImageView distance_field_view;
+            vk::ImageView distance_field_storage_view; // for voxelize.
+            vk::DeviceImage distance_field;
+
+            vk::ImageView occupancy_view;
+            vk::DeviceImage occupancy_volume; // Max density per brick.
+            vk::Sampler occupancy_sampler;
+
+            // Baked by Raytracer::bake_ambient_occlusion, or 1x1x1 if it hasn't been (LAO).
+            vk::ImageView occlusion_view;
+            vk::DeviceImage occlusion_volume;
+            vk::Sampler occlusion_sampler;
+
+            // The atlases of vkhr::HairStyle::Impostor, which are left empty if it hasn't been baked.
+            vk::ImageView impostor_occlusion_view;
+            vk::DeviceImage impostor_occlusion;
+            vk::ImageView impostor_tangents_view;
+            vk::DeviceImage impostor_tangents;
+            vk::Sampler impostor_sampler;
+            bool impostor_loaded { false };
+
+            // Shared by all hair styles, so the sets are too, with the offset bound with them.
+            vk::UniformBuffer* parameter_buffer { nullptr };
+            std::uint32_t parameter_offset { 0 };
+
+            // Rest pose and last step of the vertices, with the first vertex and vertex count of the strands.
+            vk::StorageBuffer rest_positions;
+            vk::StorageBuffer previous_positions;
+            vk::StorageBuffer strands;
+            std::uint32_t strand_count { 0 };
+
+            vk::StorageBuffer guides; // see vkhr::HairStyle::generate_guides.
+            std::uint32_t guide_count { 0 };
+
+            vk::StorageBuffer clusters; // see vkhr::HairStyle::SegmentCluster.
+            std::uint32_t cluster_count { 0 };
+
+            // The corners of the simulated strands (see bounds.comp), reset once they've been resolved.
+            vk::StorageBuffer simulated_bounds;
+
+            // Of the vertices and the tangents, see read_back_vertices (only the vertices if Packed).
+            vk::HostBuffer vertex_readback;
+            vk::HostBuffer tangent_readback;
+
+            std::vector<vk::DeviceBuffer> culled_segments;
+            std::vector<vk::DeviceBuffer> culled_draws; // VkDrawIndexedIndirectCommand.
+            std::vector<vk::DescriptorSet> cull_descriptor_sets;
+            std::vector<bool> culled_views;
+
+            std::vector<vk::DescriptorSet> tile_descriptor_sets;
+
+            // The keys are sorted into sorted_keys, and then the segments into sorted_segments, see sort.
+            vk::DeviceBuffer sort_keys;
+            vk::DeviceBuffer sorted_keys;
+            vk::DeviceBuffer sort_histograms;
+            vk::DeviceBuffer sorted_segments;
+            std::vector<vk::DescriptorSet> sort_descriptor_sets;
+            bool sorted_culled { false }; // if they're the culled segments, with the culled draw's count.
 
             Volume volume;
 
             std::size_t segments_per_strand;
 
             friend class Volume;
+            friend class HairBatch;
 
             static int id;
         };
@@ -0,0 +1,91 @@
+#ifndef VKHR_VULKAN_HAIR_TARGET_HH
+#define VKHR_VULKAN_HAIR_TARGET_HH
+
+#include <vkhr/rasterizer/pipeline.hh>
+
+#include <vkpp/command_buffer.hh>
+#include <vkpp/device_memory.hh>
+#include <vkpp/framebuffer.hh>
+#include <vkpp/swap_chain.hh>
+#include <vkpp/image.hh>
+#include <vkpp/sampler.hh>
+
+#include <cstdint>
+
+namespace vk = vkpp;
+
+namespace vkhr {
+    class Rasterizer;
+    namespace vulkan {
+        // Target the hair passes (the strands, the PPLL and the raymarched
+        // volumes) are drawn into at a lower resolution than the models. It
+        // is as large as the swapchain, and only a top-left part of it that
+        // is the render scale is drawn into, so the scale can change every
+        // frame without re-creating anything. The color pass' models are
+        // downsampled into it first, and the hair upscaled over them after.
+        class HairTarget final {
+        public:
+            HairTarget(Rasterizer& vulkan_renderer);
+
+            HairTarget() = default;
+
+            void set_render_scale(float render_scale);
+            float get_render_scale() const;
+
+            VkExtent2D get_extent() const; // at the render scale.
+
+            void update_dynamic_viewport_scissor_depth(vk::CommandBuffer& cb);
+
+            // In the first subpass of the hair pass, from the swapchain image that has to be in the general layout
+            // and the depth buffer in the read-only one, so that the strands are tested against the models' depth.
+            void downsample(vk::SwapChain& swap_chain, std::uint32_t frame, std::uint32_t image,
+                            Pipeline& pipeline, vk::CommandBuffer& command_buffer);
+
+            // Over the swapchain image, which has to be in the general layout, same as in LinkedList::resolve.
+            void upscale(vk::SwapChain& swap_chain, std::uint32_t frame, std::uint32_t image,
+                         Pipeline& pipeline, vk::CommandBuffer& command_buffer);
+
+            static void build_downsample_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer);
+            static void build_upscale_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer);
+
+            static VkImageUsageFlags get_color_usage_flags();
+            static VkImageUsageFlags get_depth_usage_flags();
+
+            vk::Framebuffer& get_framebuffer();
+
+            vk::Image& get_color_image();
+            vk::ImageView& get_color_view();
+
+            vk::Image& get_depth_image();
+            vk::ImageView& get_depth_view();
+
+            static constexpr float MinimumScale { 0.25f };
+
+        private:
+            std::uint32_t width  { 0 },
+                          height { 0 };
+
+            float render_scale { 1.0f };
+
+            vk::Image color_image;
+            vk::DeviceMemory color_memory;
+            vk::ImageView color_view;
+
+            vk::Image depth_image;
+            vk::DeviceMemory depth_memory;
+            vk::ImageView depth_view;
+
+            vk::Framebuffer framebuffer;
+            vk::Sampler sampler;
+
+            VkViewport viewport { };
+            VkRect2D scissor { };
+
+            Rasterizer* vulkan_renderer { nullptr };
+
+            static int id;
+        };
+    }
+}
+
+#endif
@@ -20,6 +20,8 @@
 #include <imgui_impl_vulkan.h>
 #include <imgui_impl_glfw.h>
 
+#include <chrono>
+
 namespace vkhr {
     class Rasterizer;
     class Interface final {
@@ -52,9 +54,19 @@ namespace vkhr {
             Voxelizer = 3
         };
 
+        // Show how much each pixel costs instead, as a heatmap up to the cost_view_range of them.
+        enum CostView : int {
+            NoCostView = 0,
+            FragmentCost = 1, // PPLL nodes of the pixel, counted in its resolve.
+            RaymarchCost = 2, // samples taken by volume_surface.
+            TraceCost = 3 // microseconds per pixel of its tile, in the Raytracer.
+        };
+
         enum ShadowTechnique : int {
             ConventionalShadowMaps = 0,
-            ApproximateDeepShadows = 1
+            ApproximateDeepShadows = 1,
+            DeepOpacityMaps = 2,
+            TransmittanceVolume = 3 // see transmittance.comp.
         };
 
         struct Parameters {
@@ -83,6 +95,86 @@ namespace vkhr {
             float lod_minified_distance;
 
             int benchmarking;
+
+            int scaled_raymarch;
+            int temporal_accumulation;
+
+            int strand_culling;
+            int strand_expansion; // see vulkan::HairStyle::Expansion.
+            int software_rasterizer; // see Rasterizer::rasterize_strands.
+
+            int strand_reduction; // see Rasterizer::reduce_strands.
+            float strands_per_pixel;
+
+            int adaptive_ppll; // see LinkedList::get_recommended_node_count.
+            int ppll_tile_budget; // nodes per tile, or zero for none.
+
+            int transparency; // 0 for the PPLL, 1 for weighted blended OIT, 2 for the depth sorted segments.
+            int parallel_recording; // see Rasterizer::record_in_parallel.
+
+            int raymarch_mips; // see volume_mip_level in shade_volume.glsl.
+
+            int adsm_prefiltered; // see Rasterizer::filter_shadow_maps.
+
+            int pipeline_statistics; // see Rasterizer::pipeline_statistics_enabled.
+
+            int deferred_shading; // see resolve_deferred.comp.
+
+            int ao_volume; // see ambient_occlusion.comp.
+
+            int line_strips; // see Rasterizer::strip_topology.
+
+            int packed_ppll; // see LinkedList::PackedNodeSize.
+
+            int lod_dithering; // see lod_dithered in scheme.glsl.
+
+            int specialized_shaders; // see Rasterizer::ShaderParameters.
+
+            int multiview_shadows; // see Rasterizer::draw_multiview_depth.
+
+            int light_culling; // see cull_lights.comp.
+
+            int impostors; // see Rasterizer::draw_impostors.
+            float lod_impostor_distance;
+
+            int gpu_raytracing; // see vulkan::Raytracer.
+
+            int marschner_shading; // instead of Kajiya-Kay, see vulkan::ScatteringLut.
+            float marschner_shift; // the fiber, in degrees (see get_hair_fiber).
+            float marschner_width;
+            float marschner_azimuthal_width;
+            float marschner_eta;
+
+            int temporal_anti_aliasing; // instead of GPAA, see vulkan::TemporalAntiAliasing.
+
+            float render_scale; // of the hair passes, see vulkan::HairTarget.
+
+            int variable_rate_shading; // see vulkan::ShadingRateImage.
+
+            int batched_depth; // every hair style in one draw, see vulkan::HairBatch.
+
+            int opaque_depth; // of the volumes before the strands, see Rasterizer::draw_opaque_depth.
+
+            int strand_merging; // instead of only dropping them, see Rasterizer::reduce_strands.
+
+            int on_demand; // only draws when something changed, see Rasterizer::redraw_needed.
+
+            int sphere_tracing; // past the empty space of the volumes, see distance_field.comp.
+
+            int adaptive_steps; // as large as a pixel's footprint, see volume_surface.
+
+            int cost_view; // see CostView and heatmap.glsl.
+            float cost_view_range;
+
+            int low_latency; // polls the input after waiting for the frame, see main.cc.
+
+            int adaptive_shadows; // see Rasterizer::update_shadow_map_resolutions.
+
+            int linear_shadow_maps; // in the filtered_shadow_maps, see Rasterizer::linearize_shadow_maps.
+
+            int static_batches; // only recorded again when they change, see Rasterizer::StaticBatch.
+
+            int cached_overlay; // see Interface::overlay_cached.
         } parameters {
             KajiyaKay,
 
@@ -108,6 +200,87 @@ namespace vkhr {
             Renderer::Type::Rasterizer,
             800.0,
 
+            false,
+
+            false,
+            false,
+
+            true,
+            0,
+            false,
+
+            false,
+            1.0f,
+
+            true,
+            0,
+
+            0,
+
+            true,
+
+            true,
+
+            true,
+
+            false,
+
+            false,
+
+            true,
+
+            false,
+
+            false,
+
+            true,
+
+            false,
+
+            true,
+
+            true,
+
+            true,
+            2400.0,
+
+            true,
+
+            false,
+            -7.5f,
+            7.5f,
+            20.0f,
+            1.55f,
+
+            false,
+
+            1.0f,
+
+            false,
+
+            false,
+
+            false,
+
+            false,
+
+            false,
+
+            true,
+
+            false,
+
+            NoCostView,
+            64.0f,
+
+            false,
+
+            false,
+
+            false,
+
+            true,
+
             false
         };
 
@@ -117,10 +290,15 @@ namespace vkhr {
         bool typing_text() const;
 
         bool hide();
+        bool is_visible() const;
         void toggle_visibility();
         void set_visibility(bool visible);
         bool show();
 
+        // With the CPU and GPU frame times, a graph of the frame intervals with the hitches in them,
+        // and the VRAM used by each part of the renderer against what's left in the memory budget.
+        void toggle_hud();
+
         void switch_scene(const std::string& scene_name, SceneGraph& scene_graph, Rasterizer& rasterizer);
         void switch_scene(SceneGraph& scene_graph,
                           Rasterizer& rasterizer,
@@ -131,6 +309,8 @@ namespace vkhr {
         bool raytracing_enabled();
         void toggle_light_rotation();
         bool raymarcher_enabled(float level_of_detail);
+        bool impostors_enabled(float distance); // past where it's only raymarched.
+        vulkan::ScatteringLut::Fiber get_hair_fiber() const; // with marschner_shift etc.
         void toggle_renderer();
         void make_current_renderer(Renderer::Type ren);
 
@@ -139,14 +319,70 @@ namespace vkhr {
         std::string get_performance(const std::string& relevant_performance_parameters = "");
         std::string get_performance_header();
 
+        // Over the last get_profile_limit() timestamps of a profile, with the outliers (more than
+        // three scaled median absolute deviations away from the median) left out of robust_mean.
+        struct ProfileStatistics {
+            float mean { 0.0f };
+            float min  { 0.0f };
+            float p50  { 0.0f };
+            float p95  { 0.0f };
+            float p99  { 0.0f };
+            float max  { 0.0f };
+            float standard_deviation { 0.0f };
+            float robust_mean { 0.0f };
+            std::size_t outliers { 0 };
+        };
+
+        ProfileStatistics get_profile_statistics(const std::string& profile) const;
+
+        // Of the latest frame with statistics, with the fragments that were written into the PPLL.
+        void record_statistics(const std::unordered_map<std::string, vkpp::QueryPool::PipelineStatistics>& statistics,
+                               std::size_t ppll_fragments);
+        nlohmann::json get_performance_json() const; // the statistics of every exported profile.
+
         int get_profile_limit() const;
+        void set_profile_limit(int frames); // drops the recorded timestamps.
 
         void record_performance(const std::unordered_map<std::string, float>& timestamps);
+        float get_latest_timestamp(const std::string& profile) const; // or 0 if it wasn't there.
+
+        // With the cached_overlay on (or while benchmarking, so it doesn't perturb the measurements),
+        // the GUI is only built again when there's input, the parameters change, or the timings that
+        // are shown are due to be refreshed, and else the latest one is drawn again from its recorded
+        // command buffer and vertices, see Rasterizer::draw_overlay. It's bumped each time it's built.
+        bool overlay_cached() const;
+        std::size_t get_overlay_revision() const;
 
     private:
+        bool overlay_changed(); // since it was last built, from the input of this frame.
+
+        static constexpr std::chrono::milliseconds OverlayRefresh { 250 }; // of the timings shown.
+
+        std::chrono::steady_clock::time_point overlay_time; // of when the overlay was last built.
+        std::size_t overlay_revision { 0 };
+        bool overlay_input { false }; // then, so a release is built too.
+        ImVec2 overlay_display_size { 0.0f, 0.0f };
+        ImVec2 overlay_mouse_position { 0.0f, 0.0f };
+        bool overlay_gui_visible { false };
+        bool overlay_hud_visible { false };
+        Parameters overlay_parameters { };
+
         void traverse(SceneGraph& scene_graph, Rasterizer& rasterizer, Raytracer& ray_tracer);
         void traverse(SceneGraph::Node* node,  Rasterizer& rasterizer, Raytracer& ray_tracer);
 
+        void record_frame_times(Rasterizer& rasterizer);
+        void draw_hud(Rasterizer& rasterizer);
+
+        bool hud_visible { false };
+
+        static constexpr int HudFrames { 240 };
+        static constexpr float HitchFactor { 2.0f }; // times the median frame interval.
+
+        std::vector<float> cpu_frame_times,
+                           gpu_frame_times,
+                           frame_intervals;
+        int hud_offset { 0 };
+
         int scene_file { 0 };
         int previous_scene_file { 0 };
 
@@ -156,6 +392,9 @@ namespace vkhr {
         std::vector<std::string> shaders;
         std::vector<std::string> shadow_maps;
         std::vector<std::string> shadow_samplers;
+        std::vector<std::string> strand_expansions;
+        std::vector<std::string> transparencies;
+        std::vector<std::string> cost_views;
 
         int simulation_effect { 0 };
 
@@ -181,6 +420,29 @@ namespace vkhr {
             "Resolve the PPLL",
         };
 
+        std::unordered_map<std::string, vkpp::QueryPool::PipelineStatistics> pipeline_statistics;
+        std::size_t ppll_fragments { 0 };
+
+        // Appended to the CSV (after the means above) for every exported profile.
+        std::vector<std::string> export_statistics {
+            "Min",
+            "P50",
+            "P95",
+            "P99",
+            "Max",
+            "SD",
+            "Robust Mean",
+        };
+
+        // And the invocation counts of each pipeline statistic, after everything above.
+        std::vector<std::string> export_invocations {
+            "Vertex Invocations",
+            "Geometry Invocations",
+            "Clipped Primitives",
+            "Fragment Invocations",
+            "Compute Invocations",
+        };
+
         static bool get_string_from_vector(void*, int, const char**);
 
         bool light_debugger { false };
@@ -0,0 +1,54 @@
+#ifndef VKHR_VULKAN_LIGHT_TILES_HH
+#define VKHR_VULKAN_LIGHT_TILES_HH
+
+#include <vkhr/rasterizer/pipeline.hh>
+
+#include <vkpp/buffer.hh>
+#include <vkpp/command_buffer.hh>
+
+#include <cstdint>
+
+namespace vk = vkpp;
+
+namespace vkhr {
+    class Rasterizer;
+    namespace vulkan {
+        // A mask of the lights that reach each screen tile, which is culled with the
+        // range of the point lights every frame (see cull_lights.comp), so that the
+        // strands and the volumes only loop over the lights in their tile when they
+        // are shaded, instead of all of the lights in the scene for every fragment.
+        class LightTiles final {
+        public:
+            // With the tiles of every view (e.g. both eyes with stereo) after each other.
+            LightTiles(Rasterizer& vulkan_renderer, std::uint32_t width, std::uint32_t height,
+                       std::uint32_t views = 1);
+
+            LightTiles() = default;
+
+            // Before the color pass, since both the fragment and compute shaders read it.
+            void cull(Pipeline& pipeline, std::uint32_t frame, vk::CommandBuffer& command_buffer);
+
+            static void build_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer);
+
+            vk::StorageBuffer& get_buffer();
+
+            // Pixels per side, see light_tiles.glsl.
+            static constexpr std::uint32_t TileSize { 16 };
+            static constexpr std::uint32_t GroupSize { 8 };
+
+            // The bits of the masks, see SceneGraph's limit on the light count.
+            static constexpr std::uint32_t MaximumLights { 32 };
+
+        private:
+            std::uint32_t tiles_x { 0 },
+                          tiles_y { 0 },
+                          views   { 0 };
+
+            vk::StorageBuffer masks;
+
+            static int id;
+        };
+    }
+}
+
+#endif
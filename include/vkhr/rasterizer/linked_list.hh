@@ -8,6 +8,8 @@
 #include <vkpp/descriptor_set.hh>
 #include <vkpp/image.hh>
 
+#include <vector>
+
 namespace vk = vkpp;
 
 namespace vkhr {
@@ -15,25 +17,77 @@ namespace vkhr {
     namespace vulkan {
         class LinkedList {
         public:
-            LinkedList(vkhr::Rasterizer& rasterizer,  std::uint32_t width, std::uint32_t height, std::size_t node_size, std::size_t node_count);
+            LinkedList(vkhr::Rasterizer& rasterizer,  std::uint32_t width, std::uint32_t height, std::size_t node_size, std::size_t node_count,
+                       bool deferred_shading = false, bool packed_nodes = false);
 
             LinkedList() = default;
 
-            void create(vkhr::Rasterizer& rasterizer, std::uint32_t width, std::uint32_t height, std::size_t node_size, std::size_t node_count);
-
+            // With deferred_shading the strands are only shaded in the resolve (see resolve_deferred.comp),
+            // for the nodes in the k-buffer, which needs ShadingSize more per node for what they're shaded with.
+            // With packed_nodes too, the nodes are PackedNodeSize instead of node_size (see ppll.glsl), with less
+            // precision, and the hair color in the shading. It's only for the deferred shading since a shaded
+            // node's color doesn't fit into them otherwise, so the packed_nodes are ignored without it.
+            void create(vkhr::Rasterizer& rasterizer, std::uint32_t width, std::uint32_t height, std::size_t node_size, std::size_t node_count,
+                        bool deferred_shading = false, bool packed_nodes = false);
+
+            // The heads are tagged with the frame's tag in their upper TagBits, and the ones from earlier
+            // frames count as null in ppll.glsl, so the heads image only has to be cleared when the tag
+            // wraps around, every TagCount frames, instead of every frame. The counters always are.
             void clear(vk::CommandBuffer& command_buffer);
 
-            void resolve(vk::SwapChain& swap_chain, std::uint32_t frame, Pipeline& ppll_resolving_pipeline, vk::CommandBuffer& command_buffers);
+            // Into the swapchain image, which has to be in the general layout, see Rasterizer::draw_color.
+            void resolve(vk::SwapChain& swap_chain, std::uint32_t frame, std::uint32_t image, Pipeline& ppll_resolving_pipeline, vk::CommandBuffer& command_buffers);
+            // Or into the top-left extent of another image in the general layout, e.g. the HairTarget.
+            void resolve(vk::ImageView& color_view, VkExtent2D extent, std::uint32_t frame, Pipeline& ppll_resolving_pipeline, vk::CommandBuffer& command_buffers);
+
+            // Copies the node counter into the frame's readback buffer after the resolve. It's then read by
+            // fetch_node_counter when the frame's fence has been waited on, i.e. a few frames late, so that
+            // we never stall. The counter keeps counting beyond the node count, so it'll include overflows.
+            // The writes to the counter have to be made visible to the transfer before, by the render graph.
+            void read_back_node_counter(std::uint32_t frame, vk::CommandBuffer& command_buffer);
+            void fetch_node_counter(std::uint32_t frame);
+
+            // Grows the node pool as soon as it overflows, but only shrinks it if the high-water mark stays
+            // well below the node count for a while, returning the node count that the PPLL should have.
+            std::size_t get_recommended_node_count() const;
+
+            struct Statistics {
+                std::uint32_t fragments { 0 }; // in the latest frame read back.
+                std::uint32_t high_water_mark { 0 }; // since the last shrink check.
+                std::uint32_t overflow { 0 }; // fragments lost in the latest frame.
+                std::uint32_t frames { 0 }; // read back since the last shrink check.
+            };
+
+            const Statistics& get_statistics() const;
 
             static constexpr std::size_t AverageFragmentsPerPixel = 32; // Only a estimated average fragments per pixel.
             static constexpr std::size_t NodeSize = 12; // { [R, G, B, A], Fragment Depth, Index To Previous Fragment }.
+            static constexpr std::size_t PackedNodeSize = 8; // { [Depth, Depth, Depth, Coverage], [Index To Previous Fragment, AO] }.
+            static constexpr std::size_t ShadingSize = 4; // { [Tangent, Tangent, AO, Alpha] } in the deferred shading.
             static constexpr std::uint32_t Null = 0xffffffff; // Encodes end of some list (or an invalid entry somehow).
+            static constexpr std::uint32_t KBufferSize = 16; // Closest fragments that are sorted per pixel in resolve.
+            static constexpr std::uint32_t TileSize = 16; // Pixels per side of the tiles with their own budget, see ppll.glsl.
+            static constexpr std::uint32_t TagBits = 4; // Of the heads, leaving the rest for the node index.
+            static constexpr std::uint32_t TagCount = (1 << TagBits) - 1; // Null has the all-ones tag.
+            static constexpr std::size_t MaximumNodeCount = (1 << (32 - TagBits)) - 1;
+
+            static constexpr std::size_t MinimumFragmentsPerPixel = 2; // The pool never shrinks under this,
+            static constexpr std::size_t MaximumFragmentsPerPixel = 64; // and never grows beyond this one.
+            static constexpr std::uint32_t ShrinkInterval = 120; // Frames between each shrink check.
+
+            static constexpr std::size_t ResolutionSlack = 256; // The heads are rounded up to it, see fits.
 
             std::size_t get_width() const;
             std::size_t get_node_count() const;
             std::size_t get_node_size() const;
             std::size_t get_height() const;
 
+            bool is_deferred() const;
+            bool is_packed() const;
+
+            // The heads (and their tiles) are allocated with some slack, so the swapchain can be resized
+            // without a new PPLL as long as it still fits into them, and only the resolution is updated.
+            bool fits(std::size_t width, std::size_t height) const;
             void update_resolution(std::size_t width, std::size_t height);
 
             std::size_t get_heads_size_in_bytes() const;
@@ -44,25 +98,37 @@ namespace vkhr {
             vk::StorageBuffer& get_node_counter();
             vk::UniformBuffer& get_parameters();
             vk::StorageBuffer& get_nodes();
+            vk::StorageBuffer& get_shading(); // only one (unused) entry if not deferred.
 
             static void build_pipeline(Pipeline& pipeline, Rasterizer& rasterizer); // Builds the PPLL resolve pipeline.
+            static void build_deferred_pipeline(Pipeline& pipeline, Rasterizer& rasterizer); // if rasterizer.ppll.is_deferred().
 
         private:
             std::size_t width;
             std::size_t node_size;
             std::size_t height;
 
+            std::size_t heads_width  { 0 },
+                        heads_height { 0 };
+
             struct Parameters {
                 std::uint32_t node_count;
+                std::uint32_t deferred_shading;
+                std::uint32_t packed_nodes;
             } parameters_buffer;
 
             VkClearColorValue null_value;
+            std::uint32_t tag; // of the current frame's heads.
 
             vk::DeviceImage   heads;
             vk::ImageView     heads_view;
             vk::StorageBuffer node_counter;
             vk::UniformBuffer parameters;
             vk::StorageBuffer nodes;
+            vk::StorageBuffer shading;
+
+            std::vector<vk::HostBuffer> node_counter_readbacks; // one per frame in flight.
+            Statistics statistics;
 
             static int id;
         };
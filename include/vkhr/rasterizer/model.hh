@@ -34,12 +34,22 @@ namespace vkhr {
             static void build_pipeline(Pipeline& pipeline_reference,
                                        Rasterizer& vulkan_renderer);
             static void depth_pipeline(Pipeline& pipeline_reference,
-                                       Rasterizer& vulkan_renderer);
+                                       Rasterizer& vulkan_renderer,
+                                       bool multiview = false); // see multiview_depth_map.vert.
+
+            // Signed distance field in the model space, that's used
+            // to collide strands against. Laid out as a vec4 origin
+            // (w = resolution), vec4 size then all of the distances.
+            vk::StorageBuffer& get_distance_field();
+            bool has_distance_field() const;
 
         private:
             vk::IndexBuffer  elements;
             vk::VertexBuffer vertices;
 
+            vk::StorageBuffer distance_field;
+            bool distance_field_loaded { false };
+
 #ifdef USE_MODEL_TEXTURE
 			vk::ImageView model_view;
 			vk::DeviceImage model_image;
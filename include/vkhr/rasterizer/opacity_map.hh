@@ -0,0 +1,59 @@
+#ifndef VKHR_VULKAN_OPACITY_MAP_HH
+#define VKHR_VULKAN_OPACITY_MAP_HH
+
+#include <vkhr/rasterizer/pipeline.hh>
+
+#include <vkpp/command_buffer.hh>
+#include <vkpp/device_memory.hh>
+#include <vkpp/framebuffer.hh>
+#include <vkpp/image.hh>
+#include <vkpp/sampler.hh>
+
+#include <cstdint>
+
+namespace vk = vkpp;
+
+namespace vkhr {
+    class Rasterizer;
+    namespace vulkan {
+        // Deep opacity map (Yuksel and Keyser 2008) of a light, with the
+        // number of strands in each of its layers in one RGBA texel. The
+        // layers start at the light's depth map, with the nearest strand,
+        // so all of them are found in one more geometry pass of the hair.
+        class OpacityMap final {
+        public:
+            OpacityMap(const std::uint32_t width, Rasterizer& vulkan_renderer);
+
+            OpacityMap() = default;
+
+            void update_dynamic_viewport_scissor_depth(vk::CommandBuffer& cb);
+
+            void set_resolution(std::uint32_t resolution); // the same square as its DepthMap.
+
+            static VkFormat          get_layer_format();
+            static VkImageLayout     get_read_layer_layout();
+            static VkImageUsageFlags get_layer_usage_flags();
+
+            vk::Sampler& get_sampler();
+            vk::Framebuffer& get_framebuffer();
+            vk::ImageView& get_image_view();
+
+            VkDeviceSize get_size_in_bytes() const; // of its memory.
+
+        private:
+            vk::Image image;
+            vk::DeviceMemory memory;
+            vk::ImageView image_view;
+            vk::Framebuffer framebuffer;
+            vk::Sampler sampler;
+
+            VkViewport viewport;
+            VkRect2D scissor;
+            std::uint32_t width { 0 };
+
+            static int id;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef VKHR_QUALITY_CONTROLLER_HH
+#define VKHR_QUALITY_CONTROLLER_HH
+
+#include <vkhr/rasterizer/interface.hh>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace vkhr {
+    // Holds the GPU time of the hair passes under a budget by stepping between quality levels,
+    // where each level scales down the strands per pixel, the raycasting samples, the ADSM PCF
+    // kernel, the LoD distances and the hair's render scale, from the parameters it had when it
+    // was enabled (level zero).
+    // It steps down right after the budget has been exceeded for a while, but only steps up after
+    // it has been well below it (by Headroom) for much longer, and waits for the timestamps of the
+    // new level to come in after each step, so that the levels won't oscillate around the budget.
+    class QualityController final {
+    public:
+        void enable(const Interface::Parameters& parameters);
+        void disable(Interface::Parameters& parameters); // restores the quality it had.
+        bool is_enabled() const;
+
+        // With the latest timestamps of the frame, see Interface::record_performance.
+        void update(const std::unordered_map<std::string, float>& timestamps,
+                    Interface::Parameters& parameters);
+
+        float budget { 4.0f }; // ms
+        float get_hair_time() const; // smoothed.
+        int get_level() const;
+
+        static constexpr int Levels { 8 };
+
+        static constexpr float Headroom { 0.2f }; // below the budget before stepping up.
+        static constexpr int DegradeFrames { 10 };
+        static constexpr int ImproveFrames { 90 };
+        static constexpr int SettleFrames  { 20 }; // after a step.
+
+        // The passes that are counted as the hair's part of the frame time.
+        static const std::vector<std::string> HairProfiles;
+
+    private:
+        void apply(Interface::Parameters& parameters) const;
+
+        bool enabled { false };
+        Interface::Parameters baseline;
+
+        int level { 0 };
+        float hair_time { 0.0f };
+
+        int frames_over  { 0 };
+        int frames_under { 0 };
+        int settle_frames { 0 };
+    };
+}
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef VKHR_VULKAN_RAY_TRACER_HH
+#define VKHR_VULKAN_RAY_TRACER_HH
+
+#include <vkhr/rasterizer/pipeline.hh>
+
+#include <vkpp/acceleration_structure.hh>
+#include <vkpp/buffer.hh>
+#include <vkpp/command_buffer.hh>
+#include <vkpp/device_memory.hh>
+#include <vkpp/image.hh>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace vk = vkpp;
+
+namespace vkhr {
+    class Rasterizer;
+    class Raytracer;
+    class SceneGraph;
+    class HairStyle;
+    namespace vulkan {
+#ifdef VK_KHR_ray_query
+        // The GPU version of the Raytracer's reference, which traces the hair with ray queries from
+        // trace.comp, with the same visualizations, light sampling, shadows and AO. Each hair style
+        // is a bottom level acceleration structure of its segments as AABBs, from the rest pose, and
+        // every node it's in is an instance of it in the top level one, that's rebuilt every frame.
+        // It's one sample per pixel for every trace, accumulated until the state passed changes.
+        class Raytracer final {
+        public:
+            Raytracer(Rasterizer& vulkan_renderer, const SceneGraph& scene_graph);
+
+            Raytracer() = default;
+
+            // Into the swapchain image's general view, which has to be in the general layout.
+            void trace(const SceneGraph& scene_graph, const vkhr::Raytracer& settings, std::size_t state,
+                       Pipeline& pipeline, std::uint32_t frame, vk::ImageView& framebuffer,
+                       vk::CommandBuffer& command_buffer);
+
+            void clear(); // i.e. restarts the accumulation on the next trace.
+
+            bool is_built() const;
+            std::uint32_t get_width()  const;
+            std::uint32_t get_height() const;
+
+            static void build_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer);
+
+            static constexpr std::uint32_t GroupSize { 8 };
+
+        private:
+            // The same layout as Style in trace.comp.
+            struct Style {
+                glm::vec3 diffuse;
+                float exponent;
+                std::uint32_t first_segment;
+                std::uint32_t padding[3];
+            };
+
+            std::uint32_t width  { 0 },
+                          height { 0 };
+
+            std::uint32_t samples { 0 };
+            std::size_t accumulated_state { 0 };
+
+            vk::StorageBuffer segments; // both of the vertices (with their radius) of every segment.
+            vk::StorageBuffer styles;
+
+            std::unordered_map<const HairStyle*, std::uint32_t> style_indices; // or it has no segments.
+            std::vector<vk::AddressableBuffer> segment_bounds;
+            std::vector<vk::AccelerationStructure> bottom_levels;
+
+            std::uint32_t max_instances { 0 };
+            std::vector<vk::AddressableBuffer> instances; // per frame in flight.
+            std::vector<vk::AccelerationStructure> top_levels;
+
+            vk::Image accumulation;
+            vk::DeviceMemory accumulation_memory;
+            vk::ImageView accumulation_view;
+
+            static int id;
+        };
+#endif
+    }
+}
+
+#endif
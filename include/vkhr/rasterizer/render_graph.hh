@@ -0,0 +1,76 @@
+#ifndef VKHR_VULKAN_RENDER_GRAPH_HH
+#define VKHR_VULKAN_RENDER_GRAPH_HH
+
+#include <vkpp/command_buffer.hh>
+#include <vkpp/image.hh>
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace vk = vkpp;
+
+namespace vkhr {
+    namespace vulkan {
+        // Records passes one after the other, with the barriers in between them found from what
+        // each pass says it reads and writes, instead of having every pass guess what came before
+        // it and transition things back when it's done. The barriers before a pass are all batched
+        // into a single vkCmdPipelineBarrier, and layouts are only changed when a pass needs them,
+        // e.g. the swapchain image stays in the general layout between two compute passes. Images
+        // are transitioned with all of their mips and layers, while buffers are only tracked as global
+        // memory barriers, so a "buffer" can just as well be a group of them used together.
+        class RenderGraph final {
+        public:
+            using Resource = std::size_t;
+
+            struct State {
+                VkPipelineStageFlags stage;
+                VkAccessFlags access;
+                VkImageLayout layout { VK_IMAGE_LAYOUT_UNDEFINED }; // buffers don't have one.
+            };
+
+            struct Access {
+                Resource resource;
+                State state;
+                bool write;
+            };
+
+            using Record = std::function<void(vk::CommandBuffer& command_buffer)>;
+
+            // In the state that the commands before the graph left them in, which counts as a
+            // write, so the first pass using them will wait on the commands before the graph.
+            Resource import_image(vk::Image& image, const State& state);
+            Resource import_buffer(const State& state);
+
+            void add_pass(const std::vector<Access>& accesses, Record record);
+
+            // The state the commands after the graph expect to find it in. They are assumed to
+            // write to it, but if no pass used it and it's in that layout already it's skipped.
+            void release(Resource resource, const State& state);
+
+            void execute(vk::CommandBuffer& command_buffer);
+
+        private:
+            struct Tracked {
+                vk::Image* image;
+                VkImageLayout layout;
+                State written; // by the last write.
+                State read;    // since it, i.e. what has seen the write.
+                bool accessed;
+            };
+
+            struct Pass {
+                std::vector<Access> accesses;
+                Record record;
+            };
+
+            void barrier(const std::vector<Access>& accesses, vk::CommandBuffer& command_buffer);
+
+            std::vector<Tracked> resources;
+            std::vector<Pass> passes;
+            std::vector<Access> releases;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef VKHR_VULKAN_SCATTERING_LUT_HH
+#define VKHR_VULKAN_SCATTERING_LUT_HH
+
+#include <vkhr/rasterizer/pipeline.hh>
+
+#include <vkpp/command_buffer.hh>
+#include <vkpp/device_memory.hh>
+#include <vkpp/image.hh>
+#include <vkpp/sampler.hh>
+
+#include <cstdint>
+
+namespace vk = vkpp;
+
+namespace vkhr {
+    class Rasterizer;
+    namespace vulkan {
+        // The longitudinal (M) and azimuthal (N) scattering terms of the R, TT and TRT lobes of the
+        // Marschner model, with the azimuthal ones integrated over the fiber as in d'Eon et al. 2011,
+        // baked by scattering_lut.comp into its layers, so that marschner.glsl only has to fetch
+        // them instead of evaluating the BSDF for every fragment. They don't depend on the color of
+        // the hair, which is applied as an absorption along the mean path of the TT and TRT lobes,
+        // so there's only the one for all of the styles, and it's baked again if the fiber changes.
+        // The last two are the average forward and backward scattering of the dual scattering in
+        // Zinke et al. 2008, which dual_scattering.glsl combines with the strands to the light.
+        class ScatteringLut final {
+        public:
+            // With the angles in radians, and the shifts and widths of TT and TRT from the R lobe's.
+            struct Fiber {
+                float longitudinal_shift; // alpha_R, negative towards the root.
+                float longitudinal_width; // beta_R.
+                float azimuthal_width;
+                float refraction_index;
+
+                bool operator==(const Fiber& fiber) const;
+                bool operator!=(const Fiber& fiber) const;
+            };
+
+            ScatteringLut(Rasterizer& vulkan_renderer);
+
+            ScatteringLut() = default;
+
+            // If the fiber is different from the one it was baked with last, or it hasn't been yet.
+            bool needs_baking(const Fiber& fiber) const;
+
+            // Before the color pass, after the frames still sampling since they were submitted first.
+            void bake(Pipeline& pipeline, const Fiber& fiber, vk::CommandBuffer& command_buffer);
+
+            static void build_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer);
+
+            vk::ImageView& get_image_view();
+            vk::Sampler& get_sampler();
+
+            // M (with cos(theta_i)) and cos(theta_d) by sin(theta_i) and sin(theta_r), N (over
+            // cos^2(theta_d)) by phi / pi and cos(theta_d), and the mean paths of TT and TRT.
+            // Then the R, TT and TRT scattered forward with the TT path, and backward with the
+            // TRT one, by cos(theta_d) only (the same along a row), each baked by a workgroup.
+            enum Layer : std::uint32_t {
+                Longitudinal = 0,
+                Azimuthal    = 1,
+                Absorption   = 2,
+                Forward      = 3,
+                Backward     = 4
+            };
+
+            static constexpr std::uint32_t Layers { 5 };
+            static constexpr std::uint32_t Resolution { 128 };
+
+        private:
+            vk::Image lut;
+            vk::DeviceMemory lut_memory;
+            vk::ImageView lut_view;
+            vk::ImageView lut_storage_view; // for the bake.
+            vk::Sampler lut_sampler;
+
+            Fiber baked_fiber { };
+            bool baked { false };
+
+            static int id;
+        };
+    }
+}
+
+#endif
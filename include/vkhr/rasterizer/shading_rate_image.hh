@@ -0,0 +1,60 @@
+#ifndef VKHR_VULKAN_SHADING_RATE_IMAGE_HH
+#define VKHR_VULKAN_SHADING_RATE_IMAGE_HH
+
+#include <vkhr/rasterizer/pipeline.hh>
+
+#include <vkpp/command_buffer.hh>
+#include <vkpp/device_memory.hh>
+#include <vkpp/image.hh>
+
+#include <cstdint>
+#include <vector>
+
+namespace vk = vkpp;
+
+namespace vkhr {
+    class Rasterizer;
+    namespace vulkan {
+        class LinkedList;
+#ifdef VK_NV_shading_rate_image
+        // Rate the hair and volume pipelines shade each region of the framebuffer at, with one texel every
+        // shadingRateTexelSize pixels of it. It's 2x2 (one invocation for four pixels) where the hair is so
+        // dense that the strands in it can't be told apart, and 1x1 anywhere else, e.g. at its silhouettes.
+        // It comes from the previous frame's PPLL (see shading_rate.comp), so it's a frame late, and it's
+        // generated before the PPLL is cleared. The coarse fragments still link a node into every pixel.
+        class ShadingRateImage final {
+        public:
+            ShadingRateImage(Rasterizer& vulkan_renderer);
+
+            ShadingRateImage() = default;
+
+            // Has to be before the PPLL is cleared for the frame, since it needs the previous frame's heads,
+            // and leaves the image in the shading rate layout for the color pass and the hair pass after it.
+            void generate(LinkedList& ppll, std::uint32_t frame, Pipeline& pipeline, vk::CommandBuffer& command_buffer);
+
+            void bind(vk::CommandBuffer& command_buffer);
+
+            static void build_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer);
+
+            // The entries that shading_rate.comp writes, of the palette of the hair and volume pipelines.
+            static const std::vector<VkShadingRatePaletteEntryNV>& get_palette();
+
+            static constexpr std::uint32_t InteriorFragments { 8 }; // in every pixel of a texel for it to be coarse.
+
+        private:
+            std::uint32_t width  { 0 },
+                          height { 0 }; // in texels.
+
+            VkExtent2D texel_size { 0, 0 };
+
+            vk::Image image;
+            vk::DeviceMemory memory;
+            vk::ImageView view;
+
+            static int id;
+        };
+#endif
+    }
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef VKHR_VULKAN_STEREO_TARGET_HH
+#define VKHR_VULKAN_STEREO_TARGET_HH
+
+#include <vkpp/command_buffer.hh>
+#include <vkpp/device_memory.hh>
+#include <vkpp/framebuffer.hh>
+#include <vkpp/image.hh>
+
+#include <cstdint>
+
+namespace vk = vkpp;
+
+namespace vkhr {
+    class Rasterizer;
+    namespace vulkan {
+        // The color and depth of both eyes in the layers of one image each, which the color pass
+        // is drawn into with multiview for stereo, in a single pass for the two of them (see the
+        // Rasterizer::draw_color). Then the eyes are copied side by side into the swapchain image,
+        // where the PPLL is resolved on top of them, with the heads of an eye in its half as well.
+        class StereoTarget final {
+        public:
+            StereoTarget(Rasterizer& vulkan_renderer);
+
+            StereoTarget() = default;
+
+            // With the layers in the transfer source layout, and the destination in the transfer
+            // destination one, the left eye to the left half of the image, the right eye to the right.
+            void copy(vk::Image& destination, vk::CommandBuffer& command_buffer);
+
+            vk::Image& get_color_image();
+            vk::Framebuffer& get_framebuffer(); // for the color pass.
+            vk::ImageView& get_depth_view(); // both the layers.
+
+            VkDeviceSize get_size_in_bytes() const;
+
+            static constexpr std::uint32_t Eyes { 2 };
+
+        private:
+            vk::Image color_image;
+            vk::DeviceMemory color_memory;
+            vk::ImageView color_view;
+
+            vk::Image depth_image;
+            vk::DeviceMemory depth_memory;
+            vk::ImageView depth_view;
+
+            vk::Framebuffer framebuffer;
+
+            static int id;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef VKHR_VULKAN_TEMPORAL_ANTI_ALIASING_HH
+#define VKHR_VULKAN_TEMPORAL_ANTI_ALIASING_HH
+
+#include <vkhr/rasterizer/pipeline.hh>
+
+#include <vkpp/command_buffer.hh>
+#include <vkpp/device_memory.hh>
+#include <vkpp/swap_chain.hh>
+#include <vkpp/image.hh>
+#include <vkpp/sampler.hh>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace vk = vkpp;
+
+namespace vkhr {
+    class Rasterizer;
+    namespace vulkan {
+        // Temporal anti-aliasing, as a cheaper alternative to the GPAA of
+        // the strands. The projection is jittered by a sub-pixel offset
+        // each frame (see Camera::get_jitter), the strands are drawn at
+        // their native width without any coverage, and the frames are
+        // accumulated into a history, reprojected with the camera, that
+        // is clamped to the neighborhood of each pixel to reject ghosts.
+        class TemporalAntiAliasing final {
+        public:
+            TemporalAntiAliasing(Rasterizer& vulkan_renderer);
+
+            TemporalAntiAliasing() = default;
+
+            struct Resolve {
+                glm::vec2 jitter; // of this frame, in pixels.
+                std::uint32_t history_valid;
+            };
+
+            // Blends the reprojected history with the swapchain image, and writes the result to both of them,
+            // same as LinkedList::resolve the image has to be in the general layout (see the render graph).
+            void resolve(vk::SwapChain& swap_chain, std::uint32_t frame, std::uint32_t previous_frame, std::uint32_t image,
+                         const glm::vec2& jitter, Pipeline& pipeline, vk::CommandBuffer& command_buffer);
+
+            // When there's been no resolve in the previous frame, so there's no history to reproject yet.
+            void invalidate();
+
+            static void build_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer);
+
+            static VkFormat get_history_format();
+
+        private:
+            std::uint32_t width  { 0 },
+                          height { 0 };
+
+            Rasterizer* vulkan_renderer { nullptr };
+
+            // One per frame in flight, the previous frame's is read.
+            std::vector<vk::Image> history_images;
+            std::vector<vk::DeviceMemory> history_memory;
+            std::vector<vk::ImageView> history_views;
+
+            vk::Sampler sampler;
+
+            bool history_valid { false };
+
+            static int id;
+        };
+    }
+}
+
+#endif
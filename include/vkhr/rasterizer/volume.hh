@@ -26,28 +26,58 @@ namespace vkhr {
 
             void load(HairStyle& hair_style, vkhr::Rasterizer& renderer);
 
-            void set_current_volume(vk::ImageView& density_view, vk::ImageView& tangent_view);
-            void set_volume_parameters(vk::UniformBuffer& buffer);
-            void set_volume_sampler(vk::Sampler& density_sample, vk::Sampler& tangent_sampler);
+            void set_current_volume(vk::ImageView& density_view, vk::ImageView& tangent_view, vk::ImageView& occupancy_view, vk::ImageView& occlusion_view,
+                                    vk::StorageBuffer& volume_bricks); // the indirection into the density and tangent pools.
+            void set_volume_parameters(std::uint32_t offset); // into Rasterizer::strand_parameters.
+            void set_volume_sampler(vk::Sampler& density_sample, vk::Sampler& tangent_sampler, vk::Sampler& occupancy_sampler, vk::Sampler& occlusion_sampler);
+            void set_volume_mips(vk::ImageView& density_mips, vk::ImageView& tangent_mips, vk::Sampler& mip_sampler); // for far away.
+            void set_volume_transmittance(vk::ImageView& transmittance_view, vk::ImageView& ambient_occlusion_view, vk::Sampler& sampler);
+            void set_volume_distance_field(vk::ImageView& distance_field_view, vk::Sampler& sampler); // for sphere_tracing.
 
             std::vector<glm::vec3> generate_aabb_vertices(const AABB& aabb) const;
             std::vector<unsigned>  generate_aabb_elements() const;
 
+            // Pushed for every node before drawing its volumes, see volume.glsl.
+            struct Object {
+                glm::mat4 model;
+                float level_of_detail;
+            };
+
             void draw(Pipeline& vulkan_volume_rasterizer_pipeline,
                       vk::DescriptorSet& descriptor_set,
                       vk::CommandBuffer& command_buffer) override;
 
             static void build_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer);
 
+            // For raymarching into a VolumeTarget, which is upsampled into the PPLL with the other.
+            static void build_scaled_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer);
+            static void build_upsample_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer);
+
+            // Only writes the depth where the volume becomes opaque, in the first color sub-pass, see opaque_depth.frag.
+            static void build_opaque_depth_pipeline(Pipeline& pipeline_reference, Rasterizer& vulkan_renderer);
+
         private:
             vk::IndexBuffer  elements;
             vk::VertexBuffer vertices;
 
             vk::ImageView* tangent_view  { nullptr };
             vk::ImageView* density_view  { nullptr };
-            vk::UniformBuffer* parameter_buffer { nullptr };
+            vk::ImageView* occupancy_view { nullptr };
+            vk::ImageView* occlusion_view { nullptr };
+            vk::StorageBuffer* volume_bricks { nullptr };
+            vk::ImageView* density_mips { nullptr };
+            vk::ImageView* tangent_mips { nullptr };
+            vk::Sampler* mip_sampler { nullptr };
+            vk::ImageView* transmittance_view { nullptr };
+            vk::ImageView* ambient_occlusion_view { nullptr };
+            vk::Sampler* transmittance_sampler { nullptr };
+            vk::ImageView* distance_field_view { nullptr };
+            vk::Sampler* distance_field_sampler { nullptr };
+            std::uint32_t parameter_offset { 0 };
             vk::Sampler* density_sampler { nullptr };
             vk::Sampler* tangent_sampler { nullptr };
+            vk::Sampler* occupancy_sampler { nullptr };
+            vk::Sampler* occlusion_sampler { nullptr };
 
             static int id;
         };
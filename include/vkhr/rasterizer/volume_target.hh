@@ -0,0 +1,63 @@
+#ifndef VKHR_VULKAN_VOLUME_TARGET_HH
+#define VKHR_VULKAN_VOLUME_TARGET_HH
+
+#include <vkhr/rasterizer/pipeline.hh>
+
+#include <vkpp/command_buffer.hh>
+#include <vkpp/device_memory.hh>
+#include <vkpp/framebuffer.hh>
+#include <vkpp/image.hh>
+#include <vkpp/sampler.hh>
+
+#include <cstdint>
+
+namespace vk = vkpp;
+
+namespace vkhr {
+    class Rasterizer;
+    namespace vulkan {
+        // Reduced resolution target the volumes are raymarched into. It
+        // keeps the surface depth around, so we can upsample the result
+        // against the full resolution depth buffer before compositing.
+        class VolumeTarget final {
+        public:
+            VolumeTarget(const std::uint32_t scale, Rasterizer& vulkan_renderer);
+
+            VolumeTarget() = default;
+
+            void update_dynamic_viewport_scissor_depth(vk::CommandBuffer& cb);
+
+            static VkFormat          get_color_format();
+            static VkImageLayout     get_read_color_layout();
+            static VkImageUsageFlags get_color_usage_flags();
+
+            std::uint32_t get_scale() const;
+
+            vk::Sampler& get_sampler();
+            vk::Framebuffer& get_framebuffer();
+            vk::ImageView& get_color_view();
+            vk::ImageView& get_depth_view();
+
+        private:
+            std::uint32_t scale { 1 };
+
+            vk::Image color_image;
+            vk::DeviceMemory color_memory;
+            vk::ImageView color_view;
+
+            vk::Image depth_image;
+            vk::DeviceMemory depth_memory;
+            vk::ImageView depth_view;
+
+            vk::Framebuffer framebuffer;
+            vk::Sampler sampler;
+
+            VkViewport viewport;
+            VkRect2D scissor;
+
+            static int id;
+        };
+    }
+}
+
+#endif
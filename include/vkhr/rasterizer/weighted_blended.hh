@@ -0,0 +1,63 @@
+#ifndef VKHR_VULKAN_WEIGHTED_BLENDED_HH
+#define VKHR_VULKAN_WEIGHTED_BLENDED_HH
+
+#include <vkhr/rasterizer/pipeline.hh>
+
+#include <vkpp/command_buffer.hh>
+#include <vkpp/device_memory.hh>
+#include <vkpp/framebuffer.hh>
+#include <vkpp/swap_chain.hh>
+#include <vkpp/image.hh>
+#include <vkpp/sampler.hh>
+
+#include <cstdint>
+
+namespace vk = vkpp;
+
+namespace vkhr {
+    class Rasterizer;
+    namespace vulkan {
+        // Weighted blended OIT, as a cheaper alternative to the PPLL. The
+        // strands are accumulated into two fixed-size targets, so there's
+        // no node pool that can overflow and nothing to sort, but the
+        // result is only an approximation of the correctly sorted blend.
+        class WeightedBlended final {
+        public:
+            WeightedBlended(Rasterizer& vulkan_renderer);
+
+            WeightedBlended() = default;
+
+            // Blends the average color over the swapchain image, same as LinkedList::resolve,
+            // so the image has to be in the general layout here as well (see the render graph).
+            void composite(vk::SwapChain& swap_chain, std::uint32_t frame, std::uint32_t image, Pipeline& pipeline, vk::CommandBuffer& command_buffer);
+
+            static void build_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer);
+
+            static VkFormat          get_accumulation_format();
+            static VkFormat          get_revealage_format();
+            static VkImageLayout     get_read_layout();
+            static VkImageUsageFlags get_usage_flags();
+
+            vk::Framebuffer& get_framebuffer();
+
+        private:
+            std::uint32_t width  { 0 },
+                          height { 0 };
+
+            vk::Image accumulation_image;
+            vk::DeviceMemory accumulation_memory;
+            vk::ImageView accumulation_view;
+
+            vk::Image revealage_image;
+            vk::DeviceMemory revealage_memory;
+            vk::ImageView revealage_view;
+
+            vk::Framebuffer framebuffer;
+            vk::Sampler sampler;
+
+            static int id;
+        };
+    }
+}
+
+#endif
@@ -2,30 +2,66 @@
 #define VKHR_RAY_TRACER_HH
 
 #include <vkhr/renderer.hh>
+#include <vkhr/job_system.hh>
 
 #include <vkhr/ray_tracer/model.hh>
 #include <vkhr/ray_tracer/hair_style.hh>
 #include <vkhr/ray_tracer/ray.hh>
+#include <vkhr/ray_tracer/volume.hh>
 
 #include <embree3/rtcore.h>
 
+#include <atomic>
+#include <mutex>
 #include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace vkhr {
     class Interface;
     class Raytracer final : public Renderer {
     public:
-        Raytracer(const SceneGraph& scene_graph);
+        // With deferred_load nothing is built until the first draw, since building the BVHs is slow,
+        // and in the app they're only needed once it's switched to, so it doesn't delay startup.
+        // The Embree device is then created on that load too, which is why it takes the thread_count
+        // (0 for all of the JobSystem's), since Embree's threads can't be changed after it's created.
+        Raytracer(const SceneGraph& scene_graph, bool deferred_load = false, unsigned thread_count = 0);
 
         ~Raytracer() noexcept;
 
         void load(const SceneGraph& scene_graph) override;
         void draw(const SceneGraph& scene_graph) override;
 
-        glm::vec3 light_shading(const Ray& ray, const Camera& camera,
-                                const LightSource& light,
-                                RTCIntersectContext& context);
-        float ambient_occlusion(const glm::vec3& point, RTCIntersectContext& context);
+        // Releases the loaded scene, and only loads this one on the next draw, like above.
+        void defer_load(const SceneGraph& scene_graph);
+        bool is_loaded() const;
+
+        // After SceneGraph::reload: only builds the reloaded styles again, and moves the instances to
+        // their nodes' transforms. It's loaded again if the nodes were, unless it's still deferred.
+        void reload(const SceneGraph& scene_graph, const SceneGraph::Changes& changes);
+
+        // Keeps drawing on a background thread instead, and only picks up the camera and the lights
+        // from here, restarting when the scene changes (now_dirty), so the window stays responsive.
+        // The get_framebuffer will then be the last finished one, double-buffered with the thread.
+        void draw_in_background(const SceneGraph& scene_graph);
+        void stop_background(); // e.g. before changing the styles.
+        bool in_background() const;
+
+        // One of the lights per sample, with a probability proportional to its (attenuated) luminance at
+        // the point, so the lights that contribute the most get the most shadow rays. The shading is then
+        // divided by that probability, so the accumulated samples still converge to the sum of the lights.
+        static std::size_t sample_light(const std::vector<LightSource>& lights, const glm::vec3& point,
+                                        float sample, float& probability);
+
+        // The shadow and occlusion rays are traced together with the tile's other rays before shading.
+        Ray shadow_ray(const Ray& ray, const LightSource& light, unsigned pixel);
+        Ray occlusion_ray(const glm::vec3& point, unsigned pixel);
+
+        glm::vec3 light_shading(const Ray& ray, const Ray& shadow_ray,
+                                const Camera& camera,
+                                const LightSource& light);
+        float ambient_occlusion(const Ray& occlusion_ray);
 
         Raytracer(Raytracer&& raytracer) noexcept;
         Raytracer& operator=(Raytracer&& raytracer) noexcept;
@@ -39,8 +75,63 @@ namespace vkhr {
 
         void clear();
 
+        // The top-left pixels of the TileSize tiles of get_framebuffer that have changed since it was last
+        // called, so only those need to be uploaded to display it, see vulkan::Billboard::stream_tiles.
+        std::vector<glm::uvec2> get_updated_tiles();
+
         void recreate(unsigned width, unsigned height);
 
+        // Stops sampling the pixels whose standard error (of the luminance) is below the threshold,
+        // so the other, noisy, pixels (e.g. the strand edges or AO) get all of the samples instead.
+        void set_noise_threshold(float noise_threshold); // 0 samples every pixel in every draw.
+        bool converged() const; // if every pixel is below it.
+
+        // Draws until every pixel is below the noise threshold, for e.g. reference images. Returns
+        // the number of draws it took, which are at most max_draws if that doesn't happen before,
+        // or fewer if it's been drawing for more than max_seconds (if that's above 0) by then.
+        std::size_t draw_until_converged(const SceneGraph& scene_graph, float noise_threshold,
+                                         std::size_t max_draws, float max_seconds = 0.0f);
+
+        static constexpr unsigned MinimumSamples { 16 }; // before estimating the variance.
+
+        // For splitting a render over many processes (or machines): each one traces its own range of
+        // the (Morton ordered) tiles and/or of the sample indices with the same seed, and saves what
+        // it has accumulated, and then they're merged by adding them together before resolving them.
+        void set_seed(std::uint32_t seed);
+        void set_tile_range(std::size_t first_tile, std::size_t tile_count); // 0 tiles for all.
+        void set_sample_offset(std::size_t first_sample);
+
+        bool save_accumulation(const std::string& file_path) const;
+        bool merge_accumulation(const std::string& file_path);
+
+        static constexpr unsigned TileSize { 16 };
+
+        // Bakes how many of the rays (inside the ao_radius, in every direction) aren't occluded by the
+        // style's own strands, at the voxels of its bounding box, which is the one the rasterizer's
+        // density volume also uses. The rasterizer samples it instead of the LAO if it's been saved
+        // to the style's get_ambient_occlusion_path(), e.g. with --bake-ao in the headless mode.
+        HairStyle::Volume bake_ambient_occlusion(const HairStyle& hair_style, unsigned resolution, unsigned samples);
+
+        // Bakes the views of the style's octahedral impostor (see HairStyle::Impostor) with 'samples'
+        // rays per texel, which the rasterizer draws instead of the style for the farthest nodes if it
+        // has been saved to the style's get_impostor_path(), e.g. with --bake-impostors when headless.
+        HairStyle::Impostor bake_impostor(const HairStyle& hair_style, unsigned views, unsigned resolution, unsigned samples);
+
+        // E.g. RTC_BUILD_QUALITY_REFIT and RTC_SCENE_FLAG_DYNAMIC for simulated styles, so that their
+        // BVHs can be refit in update_hair_styles after moving, instead of built again. For the next load.
+        void set_build_quality(RTCBuildQuality geometry_quality, RTCBuildQuality scene_quality, RTCSceneFlags scene_flags);
+
+        // The vertices (in model space, with the thickness) and tangents of a style that has moved away
+        // from the ones in it, e.g. read back from the rasterizer's simulation, see Rasterizer::simulate.
+        struct MovedStrands {
+            std::vector<glm::vec4> position_thickness;
+            std::vector<glm::vec3> tangents;
+        };
+
+        // The styles without any moved_strands are updated with the ones that they have themselves.
+        void update_hair_styles(const SceneGraph& scene_graph, // or loads again, if they've changed size.
+                                const std::unordered_map<const HairStyle*, MovedStrands>& moved_strands = { });
+
         enum VisualizationMethod {
             Shaded           = 0,
             CombinedShadows  = 1,
@@ -48,7 +139,34 @@ namespace vkhr {
             AmbientOcclusion = 3
         };
 
+        // Raymarches the styles' volumes on the CPU instead of tracing their strands, like the raymarched
+        // level of detail of the rasterizer (see embree::Volume), with the same visualization method, so
+        // it can be validated against the strands, and without a GPU, e.g. with --raymarch in headless.
+        void set_raymarching(bool raymarching);
+        bool raymarching_enabled() const;
+
+        // For tracing with the same settings on the GPU, see vulkan::Raytracer.
+        VisualizationMethod get_visualization_method() const;
+        bool shadows_enabled() const;
+        bool marschner_enabled() const;
+        float get_ao_radius() const;
+
     private:
+        void trace(const Camera& camera, const std::vector<LightSource>& lights);
+        void clear_samples();
+
+        void background_loop();
+        std::thread background_thread;
+        std::mutex  background_mutex;
+        std::atomic<bool> background_stop { false };
+        std::atomic<bool> cancel_trace { false }; // the pass is thrown away.
+        bool background_restart { false };
+        Camera      background_camera;
+        std::vector<LightSource> background_lights;
+        Image finished_framebuffer; // by the thread, and then displayed_framebuffer.
+        Image displayed_framebuffer;
+        bool finished_frame { false };
+
         void set_flush_to_zero();
         void set_denormal_zero();
 
@@ -57,26 +175,87 @@ namespace vkhr {
 
         VisualizationMethod visualization_method { Shaded };
 
+        // Shows the time per pixel of each tile (in µs, up to the range) instead, see Interface::TraceCost.
+        bool trace_cost { false };
+        float trace_cost_range { 64.0f };
+
+        // The hair is shaded with the Marschner model instead, see Interface::get_hair_fiber.
+        bool marschner_shading { false };
+        embree::ScatteringLut scattering_lut;
+
+        bool raymarching { false };
+        embree::Volume::Settings raymarch_settings; // the rasterizer's, see Interface::transform.
+        void raymarch(const std::vector<Ray>& rays, const std::vector<unsigned>& pixels,
+                      const Camera& camera, const std::vector<LightSource>& lights,
+                      std::vector<glm::vec3>& sample_colors);
+
+        // Of the hair_styles, which are only loaded when they're first raymarched, and voxelized
+        // again instead of being loaded from the cache after update_hair_styles has moved them.
+        std::vector<embree::Volume> volumes;
+        bool volumes_moved { false };
+        void load_volumes();
+
         mutable RTCDevice device { nullptr };
         mutable RTCScene  scene  { nullptr };
 
+        const SceneGraph* deferred_scene { nullptr };
+        void load_deferred(); // if there's a scene waiting.
+        void create_device();
+        void release_scene();
+
+        RTCBuildQuality geometry_build_quality { RTC_BUILD_QUALITY_MEDIUM };
+        RTCBuildQuality scene_build_quality    { RTC_BUILD_QUALITY_MEDIUM };
+        RTCSceneFlags   scene_flags            { RTC_SCENE_FLAG_NONE };
+
         float ao_radius { 2.50f };
         std::size_t samples { 0 };
 
-        std::vector<glm::dvec3> back_buffer;
+        // Sum of the samples, and only resolved into the framebuffer when someone fetches it. They're
+        // first touched when they're cleared, by tile like in trace, so every NUMA node's tiles are
+        // on it too (see JobSystem::parallel_for_nodes), and not on the one that happened to resize.
+        std::vector<glm::vec4, FirstTouchAllocator<glm::vec4>> back_buffer; // sample count in alpha.
+        std::vector<float, FirstTouchAllocator<float>> luminance_squares; // sum of, for the variance.
+        bool pixel_converged(unsigned pixel) const;
+        float noise_threshold { 0.0f };
+        std::size_t converged_pixels { 0 };
+        mutable bool resolve_needed { false };
+        void resolve() const;
+
+        // The top-left pixels of the TileSize x TileSize tiles of the framebuffer, in Morton order,
+        // which are handed out one by one to the threads, so the neighbouring rays stay together.
+        std::vector<glm::uvec2> tiles;
+        void build_tiles();
+
+        // If the tiles have changed since get_updated_tiles, in the pass being traced, and then in the
+        // finished_framebuffer and displayed_framebuffer when it's in the background, like the images.
+        std::vector<unsigned char> traced_tiles, finished_tiles, displayed_tiles;
+        void update_all_tiles(); // e.g. when the framebuffer has been replaced.
+
+        std::size_t first_tile { 0 }, tile_count { 0 };
+        std::size_t sample_offset { 0 };
+        std::size_t pixels_in_range { 0 }; // of the tiles.
+
+        unsigned thread_count { 0 };
 
+        // Stateless, so the threads don't share anything: each pixel and dimension (e.g. the light or
+        // the AO) has its own CMJ pattern of CMJWidth x CMJWidth samples, which we step through with
+        // the pixel's sample count, then scrambling it for the next round of samples (and 3rd dimension).
+        static constexpr int CMJWidth { 16 };
         std::uint32_t seed { 0 };
-        float sample(float min,  float max);
-        std::uint32_t xorshift();
+        unsigned pixel_samples(unsigned pixel) const;
+        std::uint32_t pattern(unsigned pixel, unsigned dimension) const;
+        glm::vec2 sample(unsigned pixel, unsigned dimension);
+        float sample_float(unsigned pixel, unsigned dimension);
 
         // "Correlated Multi-Jittered Sampling":
         float rand_float(unsigned i, unsigned p);
         unsigned permute(unsigned i, unsigned l, unsigned p);
         glm::vec2 cmj(int s, int m, int n, int p);
 
-        Image framebuffer;
+        mutable Image framebuffer;
 
         std::vector<embree::HairStyle> hair_styles;
+        std::vector<std::size_t> instance_styles; // of hair_styles, by instance ID.
         std::vector<embree::Model>     models;
 
         friend class embree::HairStyle;
@@ -4,6 +4,7 @@
 #include <vkhr/scene_graph/hair_style.hh>
 
 #include <vkhr/ray_tracer/shadable.hh>
+#include <vkhr/ray_tracer/scattering_lut.hh>
 
 #include <glm/glm.hpp>
 
@@ -26,12 +27,44 @@ namespace vkhr {
             glm::vec3 shade(const Ray& surface_intersection,
                             const LightSource& light_source,
                             const Camera& projection_camera) override;
+            // With the Marschner model instead of Kajiya-Kay, from the terms in the scattering_lut.
+            glm::vec3 shade(const Ray& surface_intersection,
+                            const LightSource& light_source,
+                            const Camera& projection_camera,
+                            const ScatteringLut& scattering_lut) const;
+
+            // Same as the two above, but at a point with a (world space) tangent, which isn't on any
+            // of the strands, e.g. an isosurface of the volume that embree::Volume has raymarched.
+            glm::vec3 shade(const glm::vec3& surface_position,
+                            const glm::vec3& strand_direction,
+                            const LightSource& light_source,
+                            const Camera& projection_camera);
+            glm::vec3 shade(const glm::vec3& surface_position,
+                            const glm::vec3& strand_direction,
+                            const LightSource& light_source,
+                            const Camera& projection_camera,
+                            const ScatteringLut& scattering_lut) const;
+
+            float get_hair_alpha() const; // the opacity of a strand.
+
             glm::vec4 get_tangent(const Ray& position) const;
+            glm::vec3 get_model_tangent(const Ray& position) const; // for rays traced in get_scene.
 
             unsigned get_geometry() const;
 
+            // With only the style's own geometry, which is instanced by every node that has it.
+            RTCScene get_scene() const;
+
             void update_parameters(const vkhr::vulkan::HairStyle& hair_style);
 
+            // Re-fetches the vertices after they've moved, and refits (or rebuilds) the BVH with them.
+            // Returns false if the style doesn't have the same number of vertices anymore (reload it).
+            bool update_vertices();
+            // With vertices that moved away from the style's, e.g. read back from the simulation, so
+            // they're copied into our own buffers, and the style itself is left at its rest pose.
+            bool update_vertices(const std::vector<glm::vec4>& moved_vertices,
+                                 const std::vector<glm::vec3>& moved_tangents);
+
             const vkhr::HairStyle* get_pointer() const;
 
         private:
@@ -42,16 +75,23 @@ namespace vkhr {
                                  const glm::vec3& light,
                                  const glm::vec3& eye);
 
+            // Shares them with the geometry, and commits it and the scene, so its BVH is refit.
+            void update_buffers(Span<glm::vec4> vertices, Span<glm::vec3> tangents);
+
             unsigned geometry { RTC_INVALID_GEOMETRY_ID };
 
             const vkhr::HairStyle* pointer { nullptr };
 
             RTCScene scene { nullptr };
+            RTCScene instances { nullptr };
 
             glm::vec3 hair_diffuse;
             float     hair_exponent;
+            float     hair_alpha;
 
-            std::vector<glm::vec4> position_thickness;
+            std::vector<glm::vec4> position_thickness; // only if it's not shared with the style.
+            std::vector<glm::vec3> moved_tangents; // or if it's moved away from the style's.
+            std::size_t vertex_count { 0 };
         };
     }
 }
@@ -28,6 +28,8 @@ namespace vkhr {
                                   const glm::vec3& light,
                                   const glm::vec3& eye);
 
+            std::vector<std::uint32_t> elements; // only if the model's are 16-bit.
+
             RTCScene scene { nullptr };
 
             unsigned geometry { RTC_INVALID_GEOMETRY_ID };
@@ -5,6 +5,8 @@
 
 #include <glm/glm.hpp>
 
+#include <vector>
+
 namespace vkhr {
     class Ray final {
     public:
@@ -32,6 +34,7 @@ namespace vkhr {
 
         unsigned get_primitive_id() const;
         unsigned get_geometry_id()  const;
+        unsigned get_instance_id()  const; // of the node, see Raytracer::load.
         bool hit_geometry(unsigned) const;
 
         glm::vec3 get_intersection_point() const;
@@ -40,6 +43,12 @@ namespace vkhr {
         bool occluded_by(RTCScene& scene, RTCIntersectContext& context);
         bool occluded_by(RTCScene& scene, RTCIntersectContext& context, float radius);
 
+        // Traces all of the rays as one stream, which lets Embree trace them as packets.
+        static void intersect(std::vector<Ray>& rays, RTCScene& scene, RTCIntersectContext& context);
+        static void occluded(std::vector<Ray>& rays, RTCScene& scene, RTCIntersectContext& context);
+
+        void set_far_plane(float tfar_plane_t_value);
+
     private:
         RTCRayHit ray_hit { };
     };
@@ -0,0 +1,44 @@
+#ifndef VKHR_EMBREE_SCATTERING_LUT_HH
+#define VKHR_EMBREE_SCATTERING_LUT_HH
+
+#include <vkhr/rasterizer/scattering_lut.hh>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace vkhr {
+    namespace embree {
+        // The same terms as vulkan::ScatteringLut, baked with the same integration as scattering_lut.comp,
+        // and looked up like marschner.glsl (bilinearly), so that the ray tracer shades the hair the same.
+        class ScatteringLut final {
+        public:
+            using Fiber = vulkan::ScatteringLut::Fiber;
+
+            ScatteringLut() = default;
+            ScatteringLut(const Fiber& fiber);
+
+            void bake(const Fiber& fiber);
+
+            // See marschner in marschner.glsl, with the eye direction being from the eye too.
+            glm::vec3 marschner(const glm::vec3& color,
+                                const glm::vec3& intensity,
+                                const glm::vec3& tangent,
+                                const glm::vec3& light,
+                                const glm::vec3& eye) const;
+
+            bool needs_baking(const Fiber& fiber) const;
+
+        private:
+            glm::vec4 lookup(vulkan::ScatteringLut::Layer layer, glm::vec2 uv) const;
+
+            static constexpr int FiberSamples { 64 };
+
+            std::vector<glm::vec4> texels; // of all the layers.
+
+            Fiber baked_fiber { };
+        };
+    }
+}
+
+#endif
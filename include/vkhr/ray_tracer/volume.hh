@@ -0,0 +1,81 @@
+#ifndef VKHR_EMBREE_VOLUME_HH
+#define VKHR_EMBREE_VOLUME_HH
+
+#include <vkhr/scene_graph/hair_style.hh>
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <vector>
+
+namespace vkhr {
+    namespace embree {
+        // The CPU counterpart of the raymarched level of detail (see shade_volume.glsl), which marches
+        // the same 256^3 densities and tangents as vulkan::HairStyle, with the same isosurface, LAO and
+        // ADSM, so it can be compared against the traced strands without a GPU. It's only ever marched
+        // at the full resolution, without the mips, sphere tracing or temporal accumulation, which only
+        // trade the quality for speed there. The empty bricks are skipped, exactly like the occupancy.
+        class Volume final {
+        public:
+            Volume() = default;
+
+            // From the style's volume cache if it's current, else it's voxelized (e.g. after it moved).
+            Volume(const vkhr::HairStyle& hair_style, bool use_cache = true);
+            void load(const vkhr::HairStyle& hair_style, bool use_cache = true);
+
+            // Same as the rasterizer's parameters of the same names, see Interface::transform.
+            struct Settings {
+                float isosurface { 0.115f };
+                unsigned raycast_steps { 1024 };
+                float occlusion_radius { 2.50f };
+                float ao_exponent { 10.0f };
+                float ao_max { 0.160f };
+
+                bool operator==(const Settings& settings) const;
+                bool operator!=(const Settings& settings) const;
+            };
+
+            static constexpr unsigned PacketSize { 4 }; // rays, one per SSE lane.
+
+            struct Surface {
+                glm::vec3 position; // in model space.
+                float density { 0.0f }; // accumulated in isosurfaces, and 0 if nothing was hit.
+            };
+
+            // The isosurface along each of the rays (in model space, with normalized directions) from
+            // where they enter the bounding box, for the radius of it, like volume_surface does. Rays
+            // past 'count' are ignored. With the 'hair_alpha' coverage the march stops when saturated.
+            void find_surfaces(const std::array<glm::vec3, PacketSize>& origins,
+                               const std::array<glm::vec3, PacketSize>& directions,
+                               unsigned count, const Settings& settings, float hair_alpha,
+                               std::array<Surface, PacketSize>& surfaces) const;
+
+            // Both of these are filtered, and zero outside, like clamping to the border on the GPU.
+            float sample_density(const glm::vec3& position) const;
+            glm::vec3 sample_tangent(const glm::vec3& position) const; // the decoded model space one.
+
+            // The volume_approximated_deep_shadows and local_ambient_occlusion in model space.
+            float deep_shadows(const glm::vec3& position, const glm::vec3& light_position,
+                               float hair_alpha, const Settings& settings) const;
+            float local_ambient_occlusion(const glm::vec3& position, const Settings& settings) const;
+
+            const vkhr::HairStyle::Volume& get_volume() const;
+
+        private:
+            float fetch_density(int x, int y, int z) const; // 0 outside.
+            glm::vec2 fetch_tangent(int x, int y, int z) const;
+
+            // Like skip_empty_brick in occupancy.glsl: moves 't' by whole steps through an empty brick.
+            bool skip_empty_brick(const glm::vec3& start, const glm::vec3& end, float& t, float step_size) const;
+
+            vkhr::HairStyle::Volume volume; // Bricked, if it can be.
+
+            // The max density of each brick, dilated by one brick, like the rasterizer's occupancy.
+            std::vector<unsigned char> occupancy;
+            glm::ivec3 bricks { 0 };
+            glm::ivec3 resolution { 0 };
+        };
+    }
+}
+
+#endif
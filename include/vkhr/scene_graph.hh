@@ -13,6 +13,7 @@ using json = nlohmann::json;
 
 #include <list>
 
+#include <filesystem>
 #include <string>
 #include <memory>
 #include <unordered_map>
@@ -25,13 +26,51 @@ namespace vkhr {
         SceneGraph() = default;
         SceneGraph(const std::string& file_path);
 
+        // Only re-computes the subtrees of nodes that have been moved since the last call,
+        // and only rebuilds the node caches if a node's children, models or styles changed.
         void traverse_nodes();
 
         bool load(const std::string& scene_path);
 
+        // What reload has found on disk and reloaded, so the renderers only rebuild those, see e.g.
+        // Rasterizer::reload. The reloaded assets are the same objects, at the same addresses.
+        struct Changes {
+            std::vector<const HairStyle*> hair_styles; // reloaded or new.
+            std::vector<const Model*> models;
+
+            bool nodes  { false }; // they've all been parsed again, e.g. with other assets.
+            bool lights { false }; // some were added or removed, the others are in-place.
+            bool moved  { false }; // the nodes' transforms, the lights, or the camera.
+
+            bool empty() const;
+        };
+
+        // If any of the scene's files have been written to since they were loaded. Only stat:s them.
+        bool has_modified_files() const;
+
+        // Loads the modified styles and models again, in place, and diffs a modified scene file with
+        // the one it was loaded from, so the moved nodes, the lights and the camera are updated, and
+        // the nodes are only parsed again if they've got other assets or children. Files it couldn't
+        // read (e.g. while they're being written) are ignored until they've been written to again.
+        Changes reload();
+
+        // Puts another style into the same element (so the same nodes draw it), as reload would, e.g.
+        // for the thumbnails of a library of styles, which are loaded with load_style meanwhile.
+        Changes replace(const HairStyle& hair_style, HairStyle&& replacement);
+
+        // Maps in its cache if it's current, or loads, prepares and caches it. On any thread.
+        static HairStyle load_style(const std::string& file_path);
+
+        // For a "camera" object, in the same format as in the scene files, e.g. the benchmark suites'.
+        static bool parse_camera_object(const nlohmann::json& camera, Camera& scene_camera);
+
         HairStyle& add_style(const std::string& asset_path);
         Model&     add_model(const std::string& asset_path);
 
+        // Packs the vertices of the styles loaded after it on the GPU (see HairStyle::Quantization), e.g.
+        // from --quantize. With None, they're packed if their files say so. It's not saved in the caches.
+        static void set_style_quantization(HairStyle::Quantization quantization);
+
         std::string get_uuid();
 
         Model& add(Model&& model);
@@ -41,6 +80,10 @@ namespace vkhr {
 
         void clear();
 
+        // See HairStyle::release_host_arrays, e.g. after the Rasterizer has loaded them, but before the
+        // Raytracer is built (it shares them). Returns false if any of the styles have to keep theirs.
+        bool release_host_arrays();
+
         bool remove(std::unordered_map<std::string, Model>::iterator model);
         bool remove(std::unordered_map<std::string, HairStyle>::iterator hair_style);
         const std::unordered_map<std::string, HairStyle>& get_hair_styles() const;
@@ -49,6 +92,8 @@ namespace vkhr {
         mutable std::vector<LightSource::Buffer> light_source_buffers;
 
         std::vector<LightSource::Buffer>& fetch_light_source_buffers() const;
+        std::size_t get_light_source_revision() const; // bumped when any of the buffers change.
+        std::size_t get_node_revision() const; // and when any of the nodes have moved.
         const std::list<LightSource>& get_light_sources() const;
 
         const Camera& get_camera() const;
@@ -95,6 +140,13 @@ namespace vkhr {
             void set_model_matrix(const glm::mat4& m);
             const glm::mat4& get_model_matrix() const;
 
+            // Of the node's own models and styles in world space, found in traverse_nodes.
+            void compute_bounds();
+            const AABB& get_bounds() const;
+
+            // If the bounds are (conservatively) inside the frustum of a camera's or a light's matrix.
+            bool in_frustum(const glm::mat4& view_projection) const;
+
             const glm::mat4& get_matrix() const;
 
             void set_node_name(const std::string& n);
@@ -103,6 +155,13 @@ namespace vkhr {
         private:
             void recompute_transform() const;
 
+            // Flags the node and all of its ancestors, so traverse_nodes can find it from the root.
+            void mark_dirty(bool restructured = false);
+
+            bool transform_dirty { true }; // of the node and the whole subtree under it.
+            bool subtree_dirty   { true }; // somewhere under (or at) this node.
+            bool subtree_restructured { true };
+
             float rotation_angle;
             glm::vec3 rotation_axis;
             glm::vec3 translation;
@@ -114,6 +173,8 @@ namespace vkhr {
 
             mutable glm::mat4 model_matrix;
 
+            AABB bounds { glm::vec3 { 0.0f }, 0.0f, glm::vec3 { 0.0f }, 0.0f };
+
             std::vector<Node*> children;
             std::vector<HairStyle*> hair_styles;
             std::vector<Model*> models;
@@ -123,6 +184,7 @@ namespace vkhr {
             std::string node_name;
 
             friend class Interface;
+            friend class SceneGraph;
         };
 
         Node* find_node_by_name(const std::string& name);
@@ -164,21 +226,41 @@ namespace vkhr {
         Error get_last_error_state() const;
 
     private:
-        void traverse(Node& node, const glm::mat4& parent_matrix);
+        void traverse(Node& node, const glm::mat4& parent_matrix, bool parent_moved, bool rebuild_caches);
 
         void link_nodes(nlohmann::json& parser);
+        bool parse_nodes(nlohmann::json& parser); // and links them, from the root.
+        void clear_nodes();
+
+        void reload_scene(nlohmann::json& parser, Changes& changes);
+        void mark_changed_nodes(const Changes& changes); // the ones with the changed assets.
+        void record_write_time(const std::string& file_path);
+
+        // Loads (and pre-processes) every style and model of the nodes as JobSystem tasks,
+        // so parse_node only needs to look them up, instead of loading them one after another.
+        void load_assets(nlohmann::json& parser);
+        static void load_files(std::unordered_map<std::string, HairStyle>& style_loads,
+                               std::unordered_map<std::string, Model>& model_loads);
+        static void prepare_style(HairStyle& hair_style);
+        static constexpr std::size_t StrandClusterSize { 64 }; // see HairStyle::sort_strands.
+        static void prepare_model(Model& model);
 
         bool parse_camera(nlohmann::json& parser, Camera& camera);
         bool parse_light(nlohmann::json& parser,  LightSource& light);
         bool parse_node(nlohmann::json& parser,   Node& node, int i);
+        static void parse_transform(const nlohmann::json& parser, Node& node);
 
         void build_node_cache(Node& chnode);
         void destroy_previous_node_caches();
 
-        void rebuild_lights_buffer_caches();
+        bool rebuild_lights_buffer_caches();
 
         std::vector<Node*> hair_style_cache;
         std::vector<Node*> model_node_cache;
+        bool node_caches_dirty { true };
+
+        std::size_t light_source_revision { 0 };
+        std::size_t node_revision { 0 };
 
         Node* root;
         unsigned root_index = 0;
@@ -192,6 +274,12 @@ namespace vkhr {
 
         std::size_t unique_name { 0 };
         std::string scene_path { "" };
+        std::string scene_file { "" };
+
+        nlohmann::json scene_json; // as it was last parsed, to diff with.
+
+        // Of the scene file and its styles and models, from when they were (re-)loaded.
+        std::unordered_map<std::string, std::filesystem::file_time_type> write_times;
 
         mutable Error error_state {
             Error::None
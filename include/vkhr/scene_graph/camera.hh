@@ -11,6 +11,8 @@
 #include <glm/gtc/quaternion.hpp>
 #include <glm/glm.hpp>
 
+#include <cstdint>
+
 namespace vkhr {
     struct ViewProjection {
         glm::mat4 view;
@@ -19,6 +21,18 @@ namespace vkhr {
         float look_at_distance;
         float near, far;
         glm::vec2 resolution;
+
+        // Only filled in by the Rasterizer, for the temporal reprojection.
+        glm::mat4 previous_view_projection { 1.0f };
+        std::uint32_t frame_number { 0 };
+
+        // And for stereo, where the color pass is drawn for both of the eyes
+        // with multiview, otherwise there is only one, which is the camera.
+        std::uint32_t view_count { 1 };
+        // Of the hair passes, which can be drawn at a lower resolution, see vulkan::HairTarget.
+        glm::vec2 hair_resolution { 0.0f }; // and to the std140 alignment of the matrices.
+        glm::mat4 eye_views[2];
+        glm::vec4 eye_positions[2];
     };
 
     class Interface;
@@ -64,6 +78,19 @@ namespace vkhr {
 
         void zoom(float amount);
 
+        // With stereo, the eyes are eye_separation apart along the left direction, and look
+        // the same way as the camera (in parallel), which stays in the middle between them.
+        void  set_eye_separation(float eye_separation);
+        float get_eye_separation() const;
+        bool  is_stereo() const;
+
+        glm::vec3 get_eye_position(std::uint32_t eye) const; // the left one is 0.
+        glm::mat4 get_eye_view_matrix(std::uint32_t eye) const;
+
+        // A frustum that both of the eyes' frustums are inside of, for culling what
+        // either of them could see, or the camera's view_projection if it's not stereo.
+        glm::mat4 get_culling_view_projection() const;
+
         void  set_distance(float distance);
         float get_distance() const;
 
@@ -82,6 +109,13 @@ namespace vkhr {
 
         ViewProjection& get_transform() const;
 
+        // Sub-pixel offset of the frame in the Halton (2, 3) sequence, in pixels from the pixel center,
+        // for the temporal anti-aliasing, which moves the projection of every frame by it, see below.
+        static glm::vec2 get_jitter(std::uint32_t frame);
+        glm::mat4 get_jittered_projection_matrix(const glm::vec2& jitter) const;
+
+        static constexpr std::uint32_t JitterSamples { 8 };
+
         static ViewProjection IdentityVPMatrix;
 
     private:
@@ -104,6 +138,8 @@ namespace vkhr {
 
         mutable float distance { 0.0f };
 
+        float eye_separation { 0.0f };
+
         glm::vec2 last_mouse_position;
 
         mutable ViewingPlane viewing_plane;
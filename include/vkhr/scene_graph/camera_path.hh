@@ -0,0 +1,54 @@
+#ifndef VKHR_CAMERA_PATH_HH
+#define VKHR_CAMERA_PATH_HH
+
+#include <vkhr/scene_graph/camera.hh>
+
+#include <nlohmann/json.hpp>
+
+#include <string>
+#include <vector>
+
+namespace vkhr {
+    // Keyframes of the camera at some time (in seconds) after the first one, recorded while it's
+    // moved with Camera::control (see --record-path) and replayed in the benchmarks. Each one has
+    // the same format as the scene's camera, with the time, so a keyframe file looks like this:
+    // { "cameraPath": [ { "time": 0.0, "origin": [...], "lookAt": [...], "upward": [...] } ] }.
+    class CameraPath final {
+    public:
+        CameraPath() = default;
+        CameraPath(const std::string& file_path);
+
+        bool load(const std::string& file_path);
+        bool save(const std::string& file_path) const;
+
+        // The "cameraPath" array. Keyframes without a time are one second after the last.
+        bool parse(const nlohmann::json& keyframes);
+        nlohmann::json dump() const;
+
+        void add_keyframe(const Camera& camera, float time);
+
+        // Only adds a keyframe if the camera has moved, otherwise it just makes the last one
+        // (of the two the camera has been still between) later, so the files stay small.
+        void record(const Camera& camera, float time);
+
+        // Linearly in between the two keyframes around the time (after the first keyframe's),
+        // and clamped to the first and the last keyframe, so a time of get_duration is the end.
+        void sample(float time, Camera& camera) const;
+
+        float get_duration() const;
+
+        std::size_t size() const;
+        bool empty() const;
+        void clear();
+
+    private:
+        struct Keyframe {
+            Camera camera;
+            float time;
+        };
+
+        std::vector<Keyframe> keyframes;
+    };
+}
+
+#endif
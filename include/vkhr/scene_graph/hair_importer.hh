@@ -0,0 +1,32 @@
+#ifndef VKHR_HAIR_IMPORTER_HH
+#define VKHR_HAIR_IMPORTER_HH
+
+#include <vkhr/memory_map.hh>
+
+#include <string>
+
+namespace vkhr {
+    class HairStyle;
+
+    // Reads the strands of the formats the grooms are authored in straight from the mapped file into
+    // a style's arrays, which HairStyle::load does by the extension, so they're then prepared and cached
+    // like any .hair (see SceneGraph::load_style) and only imported again when the file is newer. The
+    // strands are located first, which only touches the headers and the vertex counts, and the bulk of
+    // it is then copied in parallel chunks, since it's all little-endian binary that needs no parsing.
+    //
+    //  * TressFX .tfx: the positions of strands with the same vertex count (the w, its inverse mass, is
+    //    dropped). Its strand UVs and per-strand thicknesses aren't used, the latter are generated.
+    //  * Alembic .abc, the Ogawa ones (not HDF5): the first sample of every curves object (P, nVertices
+    //    and the width, i.e. twice the thickness, if any) merged into one style, in object space, since
+    //    the transforms aren't applied. Curves with fewer than two vertices are dropped.
+    namespace hair_importer {
+        bool is_importable(const std::string& file_path); // by the extension.
+
+        bool import(const MemoryMap& file, const std::string& file_path, HairStyle& hair_style);
+
+        bool import_tressfx(const MemoryMap& file, HairStyle& hair_style);
+        bool import_alembic(const MemoryMap& file, HairStyle& hair_style);
+    }
+}
+
+#endif
@@ -7,8 +7,14 @@
 
 #include <glm/gtx/component_wise.hpp>
 
+#include <vkhr/large_buffer.hh>
+#include <vkhr/memory_map.hh>
+#include <vkhr/image.hh>
+
+#include <cstdint>
 #include <string>
 #include <fstream>
+#include <memory>
 #include <vector>
 #include <array>
 
@@ -33,6 +39,7 @@ namespace vkhr {
             WritingFileHeader,
 
             InvalidSignature,
+            ImportingFile,
 
             ReadingSegments,
             ReadingVertices,
@@ -41,6 +48,9 @@ namespace vkhr {
             ReadingColor,
             ReadingTangents,
             ReadingIndices,
+            ReadingGuides,
+            ReadingPositionThickness,
+            ReadingClusters,
 
             WritingSegments,
             WritingVertices,
@@ -49,15 +59,57 @@ namespace vkhr {
             WritingColor,
             WritingTangents,
             WritingIndices,
+            WritingGuides,
+            WritingPositionThickness,
+            WritingClusters,
 
             InvalidFormat
         };
 
         operator bool() const;
         Error get_last_error_state() const;
+        void reset_error_state(); // e.g. if it failed to save a copy.
 
+        // The TressFX and Alembic grooms are imported instead, see hair_importer.hh.
         bool load(const std::string& file_path);
-        bool save(const std::string& file_path) const;
+        // Compressed files (a HAIZ signature) are decompressed in parallel
+        // when loaded, see compression.hh. Only the integer fields shrink
+        // much (the indices to around a quarter), since the floats' low bits
+        // are noise, so the whole file is only a few percent smaller.
+        bool save(const std::string& file_path, bool compressed = false) const;
+        bool is_compressed() const;
+
+        // Memory-maps the file instead of reading it into the vectors
+        // below, which are left empty. Use the get_*_span() functions
+        // to access the data. Anything that modifies the hair (e.g. a
+        // shuffle) will first unmap() it, copying the arrays to heap.
+        // Compressed files can't be mapped, so they're loaded instead,
+        // and so are the ones without aligned fields (see FieldAlignment).
+        bool map(const std::string& file_path);
+        bool is_mapped() const;
+        void unmap();
+
+        // Once the strands are on the GPU: maps the style from its cache, if it wasn't already, and
+        // drops the mapped pages, so that the arrays don't take any memory until e.g. the ray tracer
+        // or a save reads them, which pages them back in from it. Without a current cache (e.g. if it
+        // couldn't be written) they're kept, and it returns false.
+        bool release_host_arrays();
+
+        // The one it was loaded (or mapped) from, for finding its baked volumes.
+        const std::string& get_file_path() const;
+        void set_file_path(const std::string& file_path); // e.g. if mapped from a cache.
+        std::string get_ambient_occlusion_path() const; // see Raytracer::bake_ambient_occlusion.
+        std::string get_impostor_path() const; // see Raytracer::bake_impostor.
+
+        // The style after SceneGraph::prepare_style (in this same format) and its voxelized strands
+        // (see vulkan::HairStyle), which are cached next to it, since they're slow to re-generate.
+        // Bump CacheVersion when what's generated changes, so that older caches aren't used.
+        static constexpr unsigned CacheVersion { 4 };
+        static std::string get_cache_path(const std::string& file_path);
+        std::string get_volume_cache_path() const;
+
+        // If it exists and was written after the file it was generated from.
+        static bool cache_is_current(const std::string& cache_path, const std::string& file_path);
 
         unsigned get_strand_count() const;
         void set_strand_count(const unsigned strand_count);
@@ -71,6 +123,9 @@ namespace vkhr {
         bool has_color() const;
         bool has_tangents() const;
         bool has_indices() const;
+        bool has_guides() const;
+        bool has_position_thickness() const;
+        bool has_clusters() const;
         bool has_bounding_box() const;
 
         unsigned get_default_segment_count() const;
@@ -86,25 +141,150 @@ namespace vkhr {
 
         AABB get_bounding_box() const;
 
+        // How the renderers should pack vertices when uploading them.
+        // The file itself always stores the full precision attributes.
+        enum class Quantization {
+            None,
+            Packed // 16-bit unorm position / thickness & octahedral tangent.
+        };
+
+        Quantization get_quantization() const;
+        void set_quantization(const Quantization quantization);
+
+        // The thickness of its thickest vertex, which a Packed thickness of 1 stands for. It's saved
+        // in the header, and is only read back from a file that's Packed, since it wasn't in older.
+        float get_quantized_thickness() const;
+
+        // The thickness is 16-bit too, and not 8, since it's in the w of the position, which the
+        // vertex would have to 32-bit align anyway, so a narrower one wouldn't make it smaller.
+        struct QuantizedVertex {
+            glm::u16vec4 position_thickness; // unorm inside the bounding box, and of the thickest.
+            glm::i16vec2 tangent; // octahedron encoded.
+        };
+
+        // Only valid after the bounding box and tangents are generated.
+        std::vector<QuantizedVertex> create_quantized_data() const;
+
+        // Bounds of 'cluster_size' consecutive segments, laid out like cull.comp expects.
+        struct SegmentCluster {
+            glm::vec3 lower;
+            std::uint32_t first_segment;
+            glm::vec3 upper;
+            std::uint32_t segment_count;
+        };
+
+        // Only valid after the indices are generated.
+        std::vector<SegmentCluster> create_segment_clusters(std::size_t cluster_size) const;
+
+        // Four indices per segment: the vertex before it, its two ends, and the vertex after
+        // it, with an end repeated at the root and the tip, for the patches of the Catmull-Rom
+        // curves that are tessellated by strand_curve.tesc. Also needs the indices generated.
+        std::vector<unsigned> create_curve_patches() const;
+
         struct Volume {
             glm::vec3 resolution;
             AABB bounds; // world
 
-            std::vector<unsigned char> densities;
-            std::vector<glm::i8vec4>    tangents;
+            LargeBuffer<unsigned char> densities;
+            LargeBuffer<glm::i8vec2>    tangents; // octahedron encoded, like the quantized ones.
+
+            // Scratch of voxelize_segments, shared by its threads and kept for voxelizing it again.
+            LargeBuffer<glm::vec3> precise_tangents;
+
+            // How the voxels are ordered in both of the buffers above. Linear is x-major, i.e. the
+            // voxel i + j*w + k*w*h, like the files and the 3-D images. Bricked is BrickSize^3 bricks
+            // one after the other (in that order too), with the voxels of each brick inside of it,
+            // so the neighbours in y and z are in the same few cache lines (a z slice of a brick is
+            // one of them). It's only for the resolutions that are multiples of the BrickSize.
+            enum class Layout {
+                Linear,
+                Bricked
+            };
+
+            static constexpr unsigned BrickSize { 8 }; // same as the rasterizer's brick pools.
+
+            Layout layout { Layout::Linear };
+
+            std::size_t get_index(const glm::uvec3& voxel) const; // in the buffers, of that voxel.
+
+            // Swizzles the buffers into the other layout in parallel, e.g. back to Linear before an
+            // upload. False if it can't be bricked, and then it's left as it was.
+            bool set_layout(Layout layout);
 
             void normalize();
-            bool save(const std::string& f_path);
+            bool save(const std::string& f_path); // and the tangents if any, always Linear.
+            bool load(const std::string& f_path); // with the resolution set, and it's Linear.
 
             template<typename F>
             Volume downsample(F);
         };
 
+        // Of the baked volumes that are saved next to the style, e.g. the ambient occlusion.
+        static constexpr unsigned BakedResolution { 64 };
+
+        // For drawing the style as a billboard when it's too far away for even raymarching it to be
+        // worth it (see Rasterizer::draw_impostors). The atlases are Views x Views views of it, from
+        // the directions of the octahedron unfolded into a square (see get_view_direction), and each
+        // view is an orthographic projection of its bounding sphere at Resolution x Resolution. The
+        // shading is done when it's drawn, so only the coverage and self-occlusion are baked into it.
+        static constexpr unsigned ImpostorViews { 8 };
+        static constexpr unsigned ImpostorResolution { 64 };
+
+        struct Impostor {
+            Image occlusion; // with the coverage in alpha.
+            Image tangents;  // in model space, with the depth into the sphere in alpha.
+
+            unsigned views { ImpostorViews };
+
+            // As <file_path>.png and <file_path>.tangents.png, since they're only a few views.
+            bool save(const std::string& file_path) const;
+            bool load(const std::string& file_path); // with the views set.
+
+            // Towards the eye of the view, and the two axes of its image plane (or the billboard).
+            static glm::vec3 get_view_direction(unsigned view_x, unsigned view_y, unsigned views);
+            static void get_view_axes(const glm::vec3& direction, glm::vec3& right, glm::vec3& up);
+        };
+
         Volume voxelize_vertices(std::size_t width, std::size_t height, std::size_t depth) const;
-        Volume voxelize_segments(std::size_t width, std::size_t height, std::size_t depth) const;
+        // In the layout if the resolution can be in it (see Volume::Layout), else it's Linear.
+        Volume voxelize_segments(std::size_t width, std::size_t height, std::size_t depth,
+                                 Volume::Layout layout = Volume::Layout::Linear) const;
+        void voxelize_segments(Volume& volume, std::size_t width, std::size_t height, std::size_t depth,
+                               Volume::Layout layout = Volume::Layout::Linear) const;
 
         void shuffle();
-        void reduce(float ratio);
+        void reduce(float ratio); // and throws away the guides.
+
+        // After a shuffle: splits the strands into bands of 1/16, 1/16, 1/8, 1/4 and 1/2 of them,
+        // and sorts each band by the Morton order of the roots into clusters of 'cluster_size'
+        // strands, which are then put in a random order (as are the strands in each cluster).
+        // Every band is still a random sample of the strands, so a prefix of them is a valid
+        // LoD, but strands that are next to each other are now mostly also near in the style,
+        // which helps the vertex fetches, PPLL insertion, voxelization, and segment culling.
+        void sort_strands(std::size_t cluster_size); // and throws away the guides.
+
+        // Only keeps every 'stride' vertex of the strands (and their tips), for when they
+        // are drawn as curves through them instead. Tangents and indices are regenerated.
+        void decimate(unsigned stride);
+
+        // Picks the first 'ratio' of the (already shuffled) strands as
+        // guides, and gives every strand the guide with the closest root,
+        // so only the guides need to be simulated, and the rest of them
+        // follow along. Since the guides come first, they are the ones a
+        // reduce would keep, and get_guide_count is the number of those.
+        void generate_guides(float ratio);
+        unsigned get_guide_count() const;
+
+        // After a sort_strands: merges the strands past each cut of the strands (the first get_cluster_cut
+        // of them), into the strand before that cut with the closest root. The cuts are the coarser levels
+        // of a strand hierarchy, where the strands that are left stand in for the ones that were merged into
+        // them, instead of those just being dropped like in a reduce. It's thrown away by the re-orders too.
+        void generate_clusters();
+        static constexpr unsigned ClusterLevels { 4 }; // i.e. the 1/2, 1/4, 1/8 and 1/16 of the strands.
+        unsigned get_cluster_cut(unsigned level) const;
+
+        // How many strands each strand before the cut of the level stands in for (itself included).
+        std::vector<float> create_cluster_weights(unsigned level) const;
 
         void generate_thickness(float radius);
 
@@ -115,31 +295,67 @@ namespace vkhr {
 
         // In case we need to pack the data (raytracer and alignment).
         std::vector<glm::vec4> create_position_thickness_data() const;
+
+        // Stores the vertices and their thickness in the layout above too, as a field of its own, so
+        // the ray tracer can share it (usually straight from the mapped cache) instead of packing it,
+        // see SceneGraph::prepare_style. It's dropped by everything that moves the vertices around.
+        void generate_position_thickness();
         std::vector<glm::vec4> create_tangent_transparency_data() const;
         std::vector<glm::vec4> create_color_transparency_data() const;
 
         void generate_indices();
 
+        // Where each strand's vertices start (an exclusive prefix sum of its segments + 1) and one
+        // past the last, so the strands can be processed independently, e.g. in the generate_*.
+        std::vector<std::size_t> create_strand_offsets() const;
+
+        // The vertices of each strand in order, with a RestartIndex after it, so that lines
+        // strips with primitive restart take about one index per vertex instead of two.
+        std::vector<unsigned> create_strip_indices() const;
+
+        static constexpr unsigned RestartIndex { 0xFFFFFFFF };
+
         // Let the user do what he pleases with the hair data.
         // Consistency with arrays is checked upon file write.
+        // They're LargeBuffers, since a style is easily millions of vertices (see large_buffer.hh).
 
-        std::vector<unsigned short> segments;
-        std::vector<glm::vec3> vertices;
-        std::vector<float> thickness;
-        std::vector<float> transparency;
-        std::vector<glm::vec3> color;
+        LargeBuffer<unsigned short> segments;
+        LargeBuffer<glm::vec3> vertices;
+        LargeBuffer<float> thickness;
+        LargeBuffer<float> transparency;
+        LargeBuffer<glm::vec3> color;
 
-        const std::vector<float>& get_thickness() const;
-        const std::vector<glm::vec3>& get_vertices() const;
-        const std::vector<unsigned short>& get_segments() const;
-        const std::vector<float>& get_transparency() const;
-        const std::vector<glm::vec3>& get_color() const;
+        const LargeBuffer<float>& get_thickness() const;
+        const LargeBuffer<glm::vec3>& get_vertices() const;
+        const LargeBuffer<unsigned short>& get_segments() const;
+        const LargeBuffer<float>& get_transparency() const;
+        const LargeBuffer<glm::vec3>& get_color() const;
 
-        std::vector<glm::vec3> tangents;
-        std::vector<unsigned>  indices;
+        LargeBuffer<glm::vec3> tangents;
+        LargeBuffer<unsigned>  indices;
 
-        const std::vector<glm::vec3>& get_tangents() const;
-        const std::vector<unsigned>&  get_indices()  const;
+        const LargeBuffer<glm::vec3>& get_tangents() const;
+        const LargeBuffer<unsigned>&  get_indices()  const;
+
+        LargeBuffer<unsigned> guides; // of every strand.
+
+        const LargeBuffer<unsigned>& get_guides() const;
+
+        LargeBuffer<unsigned> clusters; // the strand each one is merged into at the first cut it's past.
+
+        LargeBuffer<glm::vec4> position_thickness;
+
+        // Views into the mapped file if is_mapped(), else the vectors.
+        Span<unsigned short> get_segment_span() const;
+        Span<glm::vec3> get_vertex_span() const;
+        Span<float> get_thickness_span() const;
+        Span<float> get_transparency_span() const;
+        Span<glm::vec3> get_color_span() const;
+        Span<glm::vec3> get_tangent_span() const;
+        Span<unsigned>  get_index_span()   const;
+        Span<unsigned>  get_guide_span()   const;
+        Span<glm::vec4> get_position_thickness_span() const;
+        Span<unsigned>  get_cluster_span() const;
 
         std::size_t get_size() const;
 
@@ -159,7 +375,13 @@ namespace vkhr {
                          has_tangents     : 1,
                          has_indices      : 1,
                          has_bounding_box : 1,
-                         future_extension : 24;
+                         quantization     : 2,
+                         has_guides       : 1,
+                         compressed       : 1,
+                         has_position_thickness : 1,
+                         has_clusters     : 1,
+                         aligned          : 1,
+                         future_extension : 17;
             } field;
 
             unsigned default_segment_count;
@@ -167,25 +389,35 @@ namespace vkhr {
                      default_transparency;
             float    default_color[3];
 
-            char information[64];
+            char information[60];
+
+            float    quantized_thickness; // see get_quantized_thickness.
 
             float    bounding_box_min[3];
             float    bounding_box_max[3];
         } file_header;
 
+        // Uncompressed files are saved with each field starting at a multiple of it, so that the
+        // mapped ones can be viewed as their types (and vec4s by SIMD loads) right in the file.
+        static constexpr std::size_t FieldAlignment { 16 };
+        std::size_t align_field(std::size_t offset) const; // if the header says it's aligned.
+
         bool valid_signature() const;
         bool format_is_valid() const;
 
         void complete_header() const;
         void update_bitfield() const;
+        void update_quantized_thickness() const;
 
         bool set_error_state(const Error error_state) const;
 
-        std::uint64_t seed;
+        std::string file_path;
+
+        std::uint64_t seed { 88172645463325252ull }; // if not from the file constructor.
         static std::uint64_t xorshift64(std::uint64_t s[1]);
 
         template<typename T>
-        bool read_field(std::ifstream& file, std::vector<T>& field);
+        bool read_field(std::ifstream& file, LargeBuffer<T>& field);
 
         bool read_segments(std::ifstream& file);
         bool read_vertices(std::ifstream& file);
@@ -194,9 +426,35 @@ namespace vkhr {
         bool read_color(std::ifstream& file);
         bool read_tangents(std::ifstream& file);
         bool read_indices(std::ifstream& file);
+        bool read_guides(std::ifstream& file);
+        bool read_position_thickness(std::ifstream& file);
+        bool read_clusters(std::ifstream& file);
+
+        bool import(const std::string& file_path);
+
+        // All of the fields above, after the header, as compressed streams.
+        Error read_compressed(std::ifstream& file);
+
+        template<typename T>
+        bool map_field(std::size_t& offset, bool has_field,
+                       std::size_t count, Span<T>& field);
+
+        // Shared, since copies of a mapped style can point to the same file.
+        std::shared_ptr<MemoryMap> memory_map;
+
+        Span<unsigned short> mapped_segments;
+        Span<glm::vec3> mapped_vertices;
+        Span<float> mapped_thickness;
+        Span<float> mapped_transparency;
+        Span<glm::vec3> mapped_color;
+        Span<glm::vec3> mapped_tangents;
+        Span<unsigned>  mapped_indices;
+        Span<unsigned>  mapped_guides;
+        Span<glm::vec4> mapped_position_thickness;
+        Span<unsigned>  mapped_clusters;
 
         template<typename T>
-        bool write_field(std::ofstream& file, const std::vector<T>& field) const;
+        bool write_field(std::ofstream& file, const Span<T>& field) const;
 
         bool write_segments(std::ofstream& file) const;
         bool write_vertices(std::ofstream& file) const;
@@ -205,12 +463,20 @@ namespace vkhr {
         bool write_color(std::ofstream& file) const;
         bool write_tangents(std::ofstream& file) const;
         bool write_indices(std::ofstream& file) const;
+        bool write_guides(std::ofstream& file) const;
+        bool write_position_thickness(std::ofstream& file) const;
+        bool write_clusters(std::ofstream& file) const;
+
+        Error write_compressed(std::ofstream& file) const;
 
         mutable Error error_state { Error::None };
     };
 
     template<typename T>
-    bool HairStyle::read_field(std::ifstream& file, std::vector<T>& field) {
+    bool HairStyle::read_field(std::ifstream& file, LargeBuffer<T>& field) {
+        auto offset = static_cast<std::size_t>(file.tellg());
+        if (!file.seekg(align_field(offset)))
+            return false;
         if (!file.read(reinterpret_cast<char*>(field.data()),
                        field.size() * sizeof(field[0])))
             return false;
@@ -218,13 +484,47 @@ namespace vkhr {
     }
 
     template<typename T>
-    bool HairStyle::write_field(std::ofstream& file, const std::vector<T>& field) const {
+    bool HairStyle::map_field(std::size_t& offset, bool has_field,
+                              std::size_t count, Span<T>& field) {
+        if (!has_field) {
+            field = Span<T> {  };
+            return true;
+        }
+
+        offset = align_field(offset);
+        field = memory_map->view<T>(offset, count);
+        offset += count * sizeof(T);
+
+        return field.size() == count;
+    }
+
+    template<typename T>
+    bool HairStyle::write_field(std::ofstream& file, const Span<T>& field) const {
+        static constexpr char padding[FieldAlignment] { };
+        auto offset = static_cast<std::size_t>(file.tellp());
+        if (!file.write(padding, align_field(offset) - offset))
+            return false;
         if (!file.write(reinterpret_cast<const char*>(field.data()),
                         field.size() * sizeof(field[0])))
             return false;
         return true;
     }
 
+    inline std::size_t HairStyle::Volume::get_index(const glm::uvec3& voxel) const {
+        std::size_t width  = static_cast<std::size_t>(resolution.x),
+                    height = static_cast<std::size_t>(resolution.y);
+
+        if (layout == Layout::Linear)
+            return voxel.x + voxel.y*width + voxel.z*width*height;
+
+        glm::uvec3 brick { voxel / BrickSize }, inside { voxel % BrickSize };
+
+        std::size_t brick_index = brick.x + brick.y*(width / BrickSize) + brick.z*(width / BrickSize)*(height / BrickSize);
+
+        return brick_index*BrickSize*BrickSize*BrickSize + inside.x + inside.y*BrickSize + inside.z*BrickSize*BrickSize;
+    }
+
+    // In the same layout, if the half resolution can still be in it.
     template<typename F>
     HairStyle::Volume HairStyle::Volume::downsample(F filter) {
         Volume volume {
@@ -232,25 +532,22 @@ namespace vkhr {
             bounds // no change
         };
 
-        volume.densities.resize(volume.resolution.x * volume.resolution.y * volume.resolution.z, 0);
+        volume.set_layout(layout);
 
-        glm::ivec3 grid        = resolution;
-        glm::ivec3 volume_grid = volume.resolution;
+        volume.densities.resize(volume.resolution.x * volume.resolution.y * volume.resolution.z, 0);
 
-        for (int k = 0; k < volume.resolution.z; ++k)
-        for (int j = 0; j < volume.resolution.y; ++j)
-        for (int i = 0; i < volume.resolution.x; ++i) {
+        for (unsigned k = 0; k < volume.resolution.z; ++k)
+        for (unsigned j = 0; j < volume.resolution.y; ++j)
+        for (unsigned i = 0; i < volume.resolution.x; ++i) {
             std::array<unsigned char, 8> neighborhood;
 
-            for (int z = 0; z < 2; ++z)
-            for (int y = 0; y < 2; ++y)
-            for (int x = 0; x < 2; ++x) {
-                neighborhood[x + 2*y + 4*z] = densities[(2*i + x) + (2*j + y)*grid.x + (2*k + z)*grid.x*grid.y];
+            for (unsigned z = 0; z < 2; ++z)
+            for (unsigned y = 0; y < 2; ++y)
+            for (unsigned x = 0; x < 2; ++x) {
+                neighborhood[x + 2*y + 4*z] = densities[get_index({ 2*i + x, 2*j + y, 2*k + z })];
             }
 
-            std::size_t index = i + j*volume_grid.x + k*volume_grid.x*volume_grid.y;
-
-            volume.densities[index] = filter(neighborhood);
+            volume.densities[volume.get_index({ i, j, k })] = filter(neighborhood);
         }
 
         return volume;
@@ -14,12 +14,16 @@ namespace vkhr {
             Directional
         };
 
+        // Padded to the array stride of std140, which rounds the structs up to a vec4.
         struct Buffer {
             glm::vec4 vector;
             glm::vec4 intensity;
             glm::mat4 view_projection;
             glm::vec3 origin;
             float near, far;
+            float range { 0.0f }; // see set_range.
+            float shadow_map_scale { 1.0f }; // of the shadow map that's used, set by the Rasterizer.
+            float padding[1] { };
         };
 
         LightSource() = default;
@@ -29,6 +33,7 @@ namespace vkhr {
                     float light_cutoff = 0.0);
 
         const Buffer& get_buffer() const;
+        bool buffer_is_dirty() const; // since the last call.
 
         Type get_type() const;
         const std::string& get_type_name() const;
@@ -52,6 +57,13 @@ namespace vkhr {
         void set_cutoff_factor(float cutoff);
         float get_cutoff_factor() const;
 
+        // Distance at which a point light has faded out, so that it's only shaded in the
+        // tiles it reaches (see cull_lights.comp). Zero is unbounded, and no attenuation,
+        // which is what a directional light always is. The falloff is the same as UE4's.
+        void set_range(float range);
+        float get_range() const;
+        float get_attenuation(const glm::vec3& position) const;
+
     private:
         void set_vector(glm::vec3 vector);
 
@@ -71,6 +83,8 @@ namespace vkhr {
         Type type;
         Buffer buffer;
 
+        mutable bool buffer_dirty { true };
+
         mutable std::string type_string;
 
         friend class Interface;
@@ -3,21 +3,38 @@
 
 #include <tiny_obj_loader.h>
 
+#include <vkhr/memory_map.hh>
+
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <glm/glm.hpp>
 #include <vector>
 #include "vkhr/image.hh"
+#include "vkhr/texture.hh"
 
 namespace vkhr {
+    struct AABB;
     class Model final {
     public:
         Model() = default;
         Model(const std::string& file_path);
 
+        // From the mesh cache next to the .obj when it's current, otherwise the .obj is parsed, its
+        // vertices deduplicated and reordered for the post-transform cache, overdraw and fetches,
+        // and the cache is written for the next time (it's just not cached if it can't be written).
         bool load(const std::string& file_path);
 
         operator bool() const;
 
+        // Bump CacheVersion when the layout or the optimization changes, so older caches aren't used.
+        static constexpr unsigned CacheVersion { 1 };
+        static std::string get_cache_path(const std::string& file_path);
+
+        bool save(const std::string& cache_path) const;
+        bool map(const std::string& cache_path); // and only in the page cache from here on.
+        bool is_mapped() const;
+
         const tinyobj::attrib_t& get_attributes() const;
         const std::vector<tinyobj::material_t>& get_materials() const;
         const std::vector<tinyobj::shape_t>& get_shapes() const;
@@ -28,23 +45,74 @@ namespace vkhr {
             glm::vec2 texcoord;
         };
 
-        const std::vector<Vertex>& get_vertices() const;
-        const std::vector<std::uint32_t>& get_elements() const;
+        // Either mapped or the ones parsed from the .obj, with only one of the element
+        // spans non-empty: the 16-bit one whenever all of the vertices fit, see above.
+        Span<Vertex> get_vertex_span() const;
+        Span<std::uint32_t> get_element_span() const;
+        Span<std::uint16_t> get_short_element_span() const;
+        std::size_t get_element_count() const;
+
+        AABB get_bounding_box() const; // of the vertices.
+
+        // Signed distances to the closest triangle (negative behind it, i.e. inside) at the voxel centers
+        // of the bounding box grown by 'padding' on each side, for e.g. colliding the simulated strands
+        // against it at a cost that doesn't depend on the triangle count. Baked on all of the threads.
+        struct DistanceField {
+            glm::uvec3 resolution;
+            glm::vec3  origin;
+            glm::vec3  size;
+            std::vector<float> distances;
+
+            float sample(const glm::vec3& position) const; // trilinear, clamped.
+        };
+
+        void generate_distance_field(unsigned resolution, float padding = 0.10f);
+        const DistanceField& get_distance_field() const;
+        bool has_distance_field() const;
 
 #ifdef USE_MODEL_TEXTURE
 		vkhr::Image get_image() const;
+		// Block-compressed with its mips if there's a .ktx2 or a .dds next to it, instead of the .png.
+		const Texture& get_texture() const;
 #endif
 
     private:
+        bool load_obj(const std::string& file_path);
+        void optimize(); // see load.
+
+        std::uint32_t get_element(std::size_t i) const;
+
         bool success { false };
         tinyobj::attrib_t attributes;
         std::vector<tinyobj::shape_t> shapes;
         std::vector<tinyobj::material_t> materials;
         std::vector<std::uint32_t> elements;
+        std::vector<std::uint16_t> short_elements;
         std::vector<Vertex> vertices;
 
+        struct CacheHeader {
+            char signature[4]; // "VKHM".
+            std::uint32_t version;
+            std::uint32_t vertex_count;
+            std::uint32_t element_count;
+            std::uint32_t element_size; // 2 or 4 bytes.
+            glm::vec3 bounds_min;
+            glm::vec3 bounds_max;
+        };
+
+        std::shared_ptr<MemoryMap> memory_map; // shared by the copies of the model.
+        Span<Vertex> mapped_vertices;
+        Span<std::uint32_t> mapped_elements;
+        Span<std::uint16_t> mapped_short_elements;
+
+        glm::vec3 bounds_min { 0.0f };
+        glm::vec3 bounds_max { 0.0f };
+
+        DistanceField distance_field { };
+
 #ifdef USE_MODEL_TEXTURE
 		Image image;
+		Texture texture;
 #endif
     };
 }
@@ -1,7 +1,40 @@
 #ifndef VKHR_SIMULATION_HH
 #define VKHR_SIMULATION_HH
 
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
 namespace vkhr {
+    // Settings for the strand simulation, done in place on the vertices of the hair styles on the GPU
+    // by strands/simulate.comp (see vulkan::HairStyle::simulate), similar to the one in TressFX: the
+    // strands are integrated with Verlet, pulled back towards their rest shape globally (towards the
+    // rest positions, near the root) and locally (the rest direction from the parent vertex), and then
+    // the segments get their rest lengths back. The roots stay attached, and all of this is done in
+    // the model space of the style, so moving the nodes themselves doesn't make the strands swing.
+    struct Simulation {
+        bool enabled { false };
+
+        glm::vec3 gravity { 0.0f, -9.82f, 0.0f };
+        float damping { 0.05f }; // of the velocity each step.
+
+        glm::vec3 wind_direction { 1.0f, 0.0f, 0.0f };
+        float wind_strength { 0.0f }; // in gusts that vary between strands.
+
+        float global_stiffness { 0.05f };
+        float global_range     { 0.30f }; // of the vertices from the root.
+        float local_stiffness  { 0.50f };
+
+        std::uint32_t local_iterations { 2 };
+
+        bool follow_hair { true }; // only simulate the guides, with the rest following them.
+
+        bool collisions { true }; // against the nearest model's distance field.
+        float collision_margin { 0.01f };
+
+        // Steps longer than this are clamped, e.g. after a hitch, since Verlet would blow up.
+        float max_time_step { 1.0f / 30.0f };
+    };
 }
 
-#endif
\ No newline at end of file
+#endif
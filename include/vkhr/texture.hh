@@ -0,0 +1,68 @@
+#ifndef VKHR_TEXTURE_HH
+#define VKHR_TEXTURE_HH
+
+#include <vkhr/memory_map.hh>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vkhr {
+    // A block-compressed texture with its mip chain, as a KTX2 or a DDS file (e.g. from toktx or
+    // texconv), that's kept memory-mapped so the levels are copied straight from the file into the
+    // staging buffer, without being decoded. Only the 2D ones without supercompression are read.
+    class Texture final {
+    public:
+        enum class Format {
+            BC1, // RGB(A) in 8 bytes a block, e.g. for the color.
+            BC5, // RG in 16 bytes a block, e.g. for tangent space normals.
+            BC7  // RGBA in 16 bytes a block, with the best quality.
+        };
+
+        struct Level {
+            std::size_t offset; // into the file.
+            std::size_t size;   // in bytes.
+            unsigned width, height;
+        };
+
+        Texture() = default;
+        Texture(const std::string& file_path);
+
+        bool load(const std::string& file_path);
+        operator bool() const;
+
+        // The first of path_without_extension + .ktx2 or .dds that loads.
+        static Texture find(const std::string& path_without_extension);
+
+        Format get_format() const;
+        bool is_srgb() const;
+
+        unsigned get_width() const;
+        unsigned get_height() const;
+
+        const std::vector<Level>& get_levels() const;
+        const char* get_level_data(std::size_t level) const;
+        std::size_t get_size_in_bytes() const; // of every level.
+
+        static std::size_t get_block_size(Format format); // in bytes, of 4x4 texels.
+        static std::size_t get_level_size(Format format, unsigned width, unsigned height);
+
+    private:
+        bool load_ktx2();
+        bool load_dds();
+        bool add_levels(std::size_t offset, std::size_t level_count); // tightly packed after each other.
+
+        Format format    { Format::BC1 };
+        bool   srgb      { false };
+        unsigned width   { 0 },
+                 height  { 0 };
+
+        std::vector<Level> levels;
+
+        std::shared_ptr<const MemoryMap> file; // shared by the copies of the model.
+    };
+}
+
+#endif
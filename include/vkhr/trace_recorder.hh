@@ -0,0 +1,44 @@
+#ifndef VKHR_TRACE_RECORDER_HH
+#define VKHR_TRACE_RECORDER_HH
+
+#include <chrono>
+#include <string>
+
+namespace vkhr {
+    // Records the CPU scopes and GPU passes between start and stop as a Chrome trace (which
+    // can be opened in chrome://tracing or Perfetto), to see how the CPU and GPU overlap. It's
+    // global so any part of the renderer can add scopes to it without threading it through,
+    // and is only the cost of an atomic load for every scope when it isn't recording anything.
+    class TraceRecorder final {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        static void start(const std::string& trace_path);
+        static bool stop(); // writes the trace, false if it couldn't.
+
+        static bool is_recording();
+
+        static double get_time(); // microseconds since the process began.
+        static double get_time(Clock::time_point time_point);
+
+        // The GPU passes go in their own track, with their (calibrated) CPU times, see below.
+        static void record_cpu_span(const char* name, double begin_time, double end_time);
+        static void record_gpu_span(const std::string& name, double begin_time, double end_time);
+
+        // Records the time between its construction and destruction, on the calling thread.
+        class Scope final {
+        public:
+            Scope(const char* name);
+            ~Scope() noexcept;
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            const char* name;
+            double begin_time { -1.0 };
+        };
+    };
+}
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef VKHR_VIDEO_WRITER_HH
+#define VKHR_VIDEO_WRITER_HH
+
+#include <vkhr/image.hh>
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace vkhr {
+    // Streams the frames (e.g. from Rasterizer::request_screenshot) into a Y4M file (in 4:4:4), a
+    // raw RGBA one if it ends with .rgba, or into the stdin of a command if it starts with a pipe,
+    // e.g. "|ffmpeg -y -i - turntable.mp4", on a thread of its own, in the order they're written.
+    // The rate is only in the header, as the frames are expected to be rendered at a fixed step.
+    class VideoWriter final {
+    public:
+        VideoWriter() = default;
+        VideoWriter(const std::string& output, unsigned frame_rate);
+        ~VideoWriter() noexcept; // and writes what's still queued.
+
+        VideoWriter(const VideoWriter&) = delete;
+        VideoWriter& operator=(const VideoWriter&) = delete;
+
+        bool open(const std::string& output, unsigned frame_rate);
+        bool is_open() const;
+        void close();
+
+        // Waits if there's already MaximumQueuedFrames queued, so that a slow encoder at the other
+        // end of the pipe slows down the rendering instead of having the frames pile up in memory.
+        void write(Image&& frame);
+
+        std::size_t get_written_frames() const;
+
+        static constexpr std::size_t MaximumQueuedFrames { 8 };
+
+    private:
+        void write_loop();
+        bool write_frame(const Image& frame);
+
+        std::FILE* file { nullptr };
+        bool piped { false };
+        bool raw   { false };
+        bool header_written { false };
+        unsigned frame_rate { 60 };
+
+        std::vector<unsigned char> planes; // scratch, for the YUV conversion.
+
+        std::deque<Image> queue;
+        std::size_t written_frames { 0 };
+
+        mutable std::mutex queue_mutex;
+        std::condition_variable queued, dequeued;
+        bool stopping { false };
+
+        std::thread write_thread;
+    };
+}
+
+#endif
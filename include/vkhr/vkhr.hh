@@ -3,15 +3,19 @@
 
 #include <vkhr/arg_parser.hh>
 #include <vkhr/image.hh>
+#include <vkhr/memory_map.hh>
 #include <vkhr/paths.hh>
 #include <vkhr/window.hh>
 #include <vkhr/input_map.hh>
+#include <vkhr/job_system.hh>
 #include <vkhr/renderer.hh>
+#include <vkhr/trace_recorder.hh>
 
 #include <vkhr/scene_graph.hh>
 
 #include <vkhr/scene_graph/billboard.hh>
 #include <vkhr/scene_graph/camera.hh>
+#include <vkhr/scene_graph/hair_importer.hh>
 #include <vkhr/scene_graph/hair_style.hh>
 #include <vkhr/scene_graph/light_source.hh>
 #include <vkhr/scene_graph/model.hh>
@@ -26,6 +30,7 @@
 #include <vkhr/rasterizer/interface.hh>
 #include <vkhr/rasterizer/model.hh>
 #include <vkhr/rasterizer/pipeline.hh>
+#include <vkhr/rasterizer/quality_controller.hh>
 
 #include <vkhr/ray_tracer.hh>
 
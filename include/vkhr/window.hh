@@ -19,13 +19,15 @@ namespace vkhr {
     public:
         Window(const int width, const int height, const std::string& title,
                const Image& icon, const bool startup_in_fullscreen = false,
-               const bool enable_vsync = false); // set in Vulkan swapchain
+               const bool enable_vsync = false, // set in Vulkan swapchain
+               const bool offscreen = false); // never shown, without a display.
         ~Window() noexcept;
 
         bool is_open() const;
         void close(); // kill
 
         bool is_fullscreen() const;
+        bool is_offscreen() const; // the Rasterizer renders it without a surface.
 
         void toggle_fullscreen();
         void toggle_fullscreen(bool fullscreen);
@@ -63,10 +65,14 @@ namespace vkhr {
         void append_string(const std::string& text) const;
 
         void poll_events(); // Called once per frame.
+        // Instead of poll_events, for when nothing was drawn, it sleeps until there's an event or
+        // the timeout (in seconds), and that time isn't in the next delta time (for the camera).
+        void wait_events(float timeout);
 
         float get_vertical_dpi()   const;
         float get_horizontal_dpi() const;
         bool  surface_is_dirty()   const;
+        bool  needs_refresh()      const; // e.g. it was uncovered, so the last image is gone.
 
         void  set_time(const float time);
         float get_current_time() const;
@@ -78,7 +84,8 @@ namespace vkhr {
         int width, height;
         std::string title;
         bool fullscreen { false },
-             vsync; // for Vulkan.
+             vsync, // for Vulkan.
+             offscreen;
 
         GLFWwindow* handle { nullptr };
 
@@ -90,6 +97,7 @@ namespace vkhr {
               vertical_dpi;
 
         static void framebuffer_callback(GLFWwindow* handle, int width, int height);
+        static void refresh_callback(GLFWwindow* handle);
 
         mutable std::string append;
 
@@ -100,6 +108,7 @@ namespace vkhr {
               fps_update { 0 };
 
         mutable bool surface_dirty { false };
+        mutable bool refresh_needed { false };
 
         friend class Interface;
     };
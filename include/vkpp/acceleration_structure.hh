@@ -0,0 +1,67 @@
+#ifndef VKPP_ACCELERATION_STRUCTURE_HH
+#define VKPP_ACCELERATION_STRUCTURE_HH
+
+#include <vkpp/buffer.hh>
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+
+namespace vkpp {
+    class Device;
+    class CommandBuffer;
+
+#ifdef VK_KHR_acceleration_structure
+    // A bottom level one over a single geometry (e.g. a hair style's segments as AABBs) or a
+    // top level one over the instances of those, with its storage and scratch buffers sized for
+    // up to the given number of primitives, so it can be rebuilt (e.g. the top level every frame)
+    // with the same or fewer of them. Needs VK_KHR_acceleration_structure, and setup_function_pointers
+    // called on the device, along with the one of the AddressableBuffer it's stored in.
+    class AccelerationStructure final {
+    public:
+        AccelerationStructure() = default;
+        AccelerationStructure(Device& device,
+                              VkAccelerationStructureTypeKHR type,
+                              const VkAccelerationStructureGeometryKHR& geometry,
+                              std::uint32_t max_primitive_count,
+                              VkBuildAccelerationStructureFlagsKHR flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR);
+
+        ~AccelerationStructure() noexcept;
+
+        AccelerationStructure(AccelerationStructure&& acceleration_structure) noexcept;
+        AccelerationStructure& operator=(AccelerationStructure&& acceleration_structure) noexcept;
+
+        friend void swap(AccelerationStructure& lhs, AccelerationStructure& rhs);
+
+        VkAccelerationStructureKHR& get_handle();
+
+        // Records the build, which has to finish (a barrier on the build stage) before tracing.
+        void build(CommandBuffer& command_buffer,
+                   const VkAccelerationStructureGeometryKHR& geometry,
+                   std::uint32_t primitive_count);
+
+        VkDeviceAddress get_device_address() const;
+        VkDeviceSize get_size() const;
+
+        static void setup_function_pointers(VkDevice device);
+
+    private:
+        static PFN_vkCreateAccelerationStructureKHR vkCreateAccelerationStructureKHR;
+        static PFN_vkDestroyAccelerationStructureKHR vkDestroyAccelerationStructureKHR;
+        static PFN_vkGetAccelerationStructureBuildSizesKHR vkGetAccelerationStructureBuildSizesKHR;
+        static PFN_vkGetAccelerationStructureDeviceAddressKHR vkGetAccelerationStructureDeviceAddressKHR;
+        static PFN_vkCmdBuildAccelerationStructuresKHR vkCmdBuildAccelerationStructuresKHR;
+
+        VkAccelerationStructureTypeKHR type;
+        VkBuildAccelerationStructureFlagsKHR flags;
+
+        AddressableBuffer storage;
+        AddressableBuffer scratch;
+
+        VkDevice device { VK_NULL_HANDLE };
+        VkAccelerationStructureKHR handle { VK_NULL_HANDLE };
+    };
+#endif
+}
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef VKPP_BUFFER_HH
 #define VKPP_BUFFER_HH
 
+#include <vkhr/memory_map.hh>
 #include <vkpp/device_memory.hh>
 
 #include <vulkan/vulkan.h>
@@ -47,6 +48,10 @@ namespace vkpp {
         void bind(DeviceMemory& device_memory,
                   std::uint32_t offset = 0);
 
+        // Every GPU of the device group binds the memory's instance on memory_device, so the others
+        // reach it as peer memory. It's only the one instance on the devices that aren't grouped.
+        void bind_peer(DeviceMemory& device_memory, std::uint32_t device_count, std::uint32_t memory_device);
+
     protected:
         VkDeviceSize size_in_bytes;
         VkSharingMode sharing_mode;
@@ -74,12 +79,50 @@ namespace vkpp {
 
         DeviceBuffer(Device& device, VkDeviceSize size, VkBufferUsageFlags usage);
 
+        // In the memory of only that GPU of the Device's group, for all of them, see bind_peer.
+        DeviceBuffer(Device& device, VkDeviceSize size, VkBufferUsageFlags usage, std::uint32_t memory_device);
+
         DeviceMemory& get_device_memory();
 
     protected:
         DeviceMemory device_memory;
     };
 
+#ifdef VK_KHR_buffer_device_address
+    // A buffer that is read through its address, e.g. by the acceleration structure builds,
+    // instead of being bound. Needs VK_KHR_buffer_device_address (and its bufferDeviceAddress
+    // feature) to be enabled, and setup_function_pointers called on the device it's created on.
+    class AddressableBuffer : public Buffer {
+    public:
+        AddressableBuffer() = default;
+
+        friend void swap(AddressableBuffer& lhs, AddressableBuffer& rhs);
+        AddressableBuffer& operator=(AddressableBuffer&& buffer) noexcept;
+        AddressableBuffer(AddressableBuffer&& buffer) noexcept;
+
+        AddressableBuffer(Device& device,
+                          CommandPool& command_pool,
+                          const void* buffer,
+                          VkDeviceSize size,
+                          VkBufferUsageFlags usage);
+
+        // Host visible ones are written with get_device_memory().copy, e.g. every frame.
+        AddressableBuffer(Device& device, VkDeviceSize size, VkBufferUsageFlags usage,
+                          DeviceMemory::Type type = DeviceMemory::Type::DeviceLocal);
+
+        DeviceMemory& get_device_memory();
+
+        VkDeviceAddress get_device_address() const;
+
+        static void setup_function_pointers(VkDevice device);
+
+    private:
+        static PFN_vkGetBufferDeviceAddressKHR vkGetBufferDeviceAddressKHR;
+
+        DeviceMemory device_memory;
+    };
+#endif
+
     class VertexBuffer : public DeviceBuffer {
     public:
         struct Attribute {
@@ -104,6 +147,13 @@ namespace vkpp {
                      std::uint32_t binding = 0,
                      const std::vector<Attribute> attributes = {});
 
+        template<typename T>
+        VertexBuffer(Device& device,
+                     CommandPool& command_buffer,
+                     const vkhr::Span<T>& vertices,
+                     std::uint32_t binding = 0,
+                     const std::vector<Attribute> attributes = {});
+
         std::uint32_t get_binding_id() const;
 
         const VkVertexInputBindingDescription& get_binding() const;
@@ -134,6 +184,14 @@ namespace vkpp {
                     CommandPool& command_buffer,
                     const std::vector<unsigned>& indices);
 
+        IndexBuffer(Device& device,
+                    CommandPool& command_buffer,
+                    const vkhr::Span<unsigned short>& indices);
+
+        IndexBuffer(Device& device,
+                    CommandPool& command_buffer,
+                    const vkhr::Span<unsigned>& indices);
+
         VkIndexType get_type() const;
 
         std::uint32_t count() const;
@@ -216,13 +274,16 @@ namespace vkpp {
         UniformBuffer(Device& device,
                       const std::vector<T>& vector);
 
+        // With any other usage, e.g. as a storage buffer it's also written to on the GPU.
         UniformBuffer(Device& device,
-                      VkDeviceSize size);
+                      VkDeviceSize size,
+                      VkBufferUsageFlags usage = 0);
 
         static std::vector<UniformBuffer> create(Device& device, VkDeviceSize size, std::size_t n = 1, const char* name = "");
 
         template<typename T> void update(std::vector<T>& vec);
         template<typename T> void update(T& uniform_data_obj);
+        template<typename T> void update(const T& uniform_data_obj, VkDeviceSize offset); // e.g. a dynamic slot.
     };
 
     template<typename T>
@@ -271,10 +332,22 @@ namespace vkpp {
                                const std::vector<T>& vertices,
                                std::uint32_t binding,
                                const std::vector<Attribute> attributes)
+                              : VertexBuffer { device,
+                                               command_buffer,
+                                               vkhr::Span<T> { vertices },
+                                               binding,
+                                               attributes } {  }
+
+    template<typename T>
+    VertexBuffer::VertexBuffer(Device& device,
+                               CommandPool& command_buffer,
+                               const vkhr::Span<T>& vertices,
+                               std::uint32_t binding,
+                               const std::vector<Attribute> attributes)
                               : DeviceBuffer { device,
                                                command_buffer,
                                                vertices.data(),
-                                               sizeof(vertices[0]) * vertices.size(),
+                                               sizeof(T) * vertices.size(),
                                                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
                                                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT } {
         this->attributes.reserve(attributes.size());
@@ -287,7 +360,7 @@ namespace vkpp {
 
         this->element_count = vertices.size();
 
-        this->binding = { binding, sizeof(vertices[0]), VK_VERTEX_INPUT_RATE_VERTEX };
+        this->binding = { binding, sizeof(T), VK_VERTEX_INPUT_RATE_VERTEX };
     }
 
     template<typename T>
@@ -323,6 +396,11 @@ namespace vkpp {
         device_memory.copy(device_memory.get_size(), data);
     }
 
+    template<typename T>
+    void UniformBuffer::update(const T& data_object, VkDeviceSize offset) {
+        device_memory.copy(sizeof(T), &data_object, offset);
+    }
+
     template<typename T>
     void UniformBuffer::update(std::vector<T>& data_vector) {
         device_memory.copy(data_vector.size() * sizeof(T),
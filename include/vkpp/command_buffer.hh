@@ -17,6 +17,7 @@ namespace vkhr::vulkan { class DepthMap; }
 namespace vkpp {
     class Device;
     class Queue;
+    class StagingRing;
 
     class CommandBuffer final {
     public:
@@ -42,6 +43,14 @@ namespace vkpp {
 
         void begin(VkCommandBufferUsageFlags = Simultaneous);
 
+        // For secondary command buffers that are executed inside that subpass.
+        void begin(RenderPass& render_pass, std::uint32_t subpass,
+                   Framebuffer& framebuffer,
+                   VkCommandBufferUsageFlags = SingleSubmit);
+        // Without the framebuffer, so it can be executed in any of them, e.g. the swapchain's.
+        void begin(RenderPass& render_pass, std::uint32_t subpass,
+                   VkCommandBufferUsageFlags = 0);
+
         void pipeline_barrier(VkPipelineStageFlags source_stage_mask,
                               VkPipelineStageFlags destination_stage_mask,
                               VkMemoryBarrier memory_barrier);
@@ -52,8 +61,18 @@ namespace vkpp {
                               VkPipelineStageFlags destination_stage_mask,
                               VkImageMemoryBarrier image_memory_barrier);
 
+        // All of them in one go, e.g. for all the barriers before a pass.
+        void pipeline_barrier(VkPipelineStageFlags source_stage_mask,
+                              VkPipelineStageFlags destination_stage_mask,
+                              const std::vector<VkMemoryBarrier>& memory_barriers,
+                              const std::vector<VkBufferMemoryBarrier>& buffer_memory_barriers,
+                              const std::vector<VkImageMemoryBarrier>& image_memory_barriers);
+
         void blit_image(Image& source, Image& destination, VkFilter filter);
         void copy_image(Image& source, Image& destination);
+        // All of the source's layer into the destination's first one, e.g. for a part of it.
+        void copy_image(Image& source, Image& destination,
+                        std::uint32_t source_layer, VkOffset3D destination_offset);
 
         void fill_buffer(Buffer& buffer, VkDeviceSize offset, VkDeviceSize size, std::uint32_t data);
         void clear_color_image(Image& image, VkClearColorValue clear_color);
@@ -61,15 +80,32 @@ namespace vkpp {
         void copy_buffer(Buffer& source, Buffer& destination,
                          std::uint32_t source_offset = 0,
                          std::uint32_t destination_offset = 0);
-        void copy_buffer_image(Buffer& source, Image& destination);
-
+        void copy_buffer_image(Buffer& source, Image& destination,
+                               VkDeviceSize source_offset = 0);
+        // Only these regions of it, e.g. the parts of an image that changed.
+        void copy_buffer_image(Buffer& source, Image& destination,
+                               const std::vector<VkBufferImageCopy>& regions);
+        void copy_image_buffer(Image& source, Buffer& destination,
+                               VkDeviceSize destination_offset = 0);
+        void copy_image_buffer(Image& source, Buffer& destination,
+                               const std::vector<VkBufferImageCopy>& regions);
+
+        // With VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS only execute_commands can go in the subpass.
+        void begin_render_pass(RenderPass& render_pass,
+                               vkhr::vulkan::DepthMap&,
+                               VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
         void begin_render_pass(RenderPass& render_pass,
-                               vkhr::vulkan::DepthMap&);
+                               Framebuffer& framebuffer,
+                               VkClearValue clear_color,
+                               VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
         void begin_render_pass(RenderPass& render_pass,
                                Framebuffer& framebuffer,
-                               VkClearValue clear_color);
+                               const std::vector<VkClearValue>& clear_values, // one per attachment.
+                               VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
 
-        void next_subpass();
+        void next_subpass(VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
+
+        void execute_commands(const std::vector<CommandBuffer*>& secondary_command_buffers);
 
         void set_viewport(VkViewport& viewport);
         void set_scissor(VkRect2D& new_scissor);
@@ -86,8 +122,10 @@ namespace vkpp {
                            std::uint32_t size_in_bytes = 0);
 
         void bind_pipeline(Pipeline& pipeline);
+        // One offset for each dynamic buffer in the set, in binding order.
         void bind_descriptor_set(DescriptorSet& descriptor_set,
-                                 Pipeline& pipeline);
+                                 Pipeline& pipeline,
+                                 const std::vector<std::uint32_t>& dynamic_offsets = {});
 
         void bind_vertex_buffer(std::uint32_t first_binding,
                                 std::uint32_t binding_count,
@@ -116,6 +154,45 @@ namespace vkpp {
                           std::int32_t  vertex_offset  = 0,
                           std::uint32_t first_instance = 0);
 
+        void draw_indirect(Buffer& buffer,
+                           VkDeviceSize offset = 0,
+                           std::uint32_t draw_count = 1,
+                           std::uint32_t stride = sizeof(VkDrawIndirectCommand));
+
+        void draw_indexed_indirect(Buffer& buffer,
+                                   VkDeviceSize offset = 0,
+                                   std::uint32_t draw_count = 1,
+                                   std::uint32_t stride = sizeof(VkDrawIndexedIndirectCommand));
+
+#ifdef VK_EXT_mesh_shader
+        // Needs VK_EXT_mesh_shader to be enabled, and setup_function_pointers called on that device.
+        void draw_mesh_tasks(std::uint32_t group_count_x = 1,
+                             std::uint32_t group_count_y = 1,
+                             std::uint32_t group_count_z = 1);
+
+        static void setup_function_pointers(VkDevice device);
+#endif
+
+#ifdef VK_NV_shading_rate_image
+        // Needs VK_NV_shading_rate_image to be enabled, and setup_shading_rate_function_pointers called on that device.
+        // The image has to be in the shading rate layout, and without one every texel of it counts as being a zero.
+        void bind_shading_rate_image(ImageView& image_view);
+        void unbind_shading_rate_image();
+
+        static void setup_shading_rate_function_pointers(VkDevice device);
+#endif
+
+#ifdef VK_KHR_draw_indirect_count
+        // Needs VK_KHR_draw_indirect_count to be enabled, and setup_indirect_count_function_pointers called on that device.
+        // Draws the commands up to the count that is in count_buffer, or max_draw_count of them if that's less.
+        void draw_indexed_indirect_count(Buffer& buffer, VkDeviceSize offset,
+                                         Buffer& count_buffer, VkDeviceSize count_offset,
+                                         std::uint32_t max_draw_count,
+                                         std::uint32_t stride = sizeof(VkDrawIndexedIndirectCommand));
+
+        static void setup_indirect_count_function_pointers(VkDevice device);
+#endif
+
         void end_render_pass();
 
         void dispatch(std::uint32_t group_count_x = 1,
@@ -136,6 +213,19 @@ namespace vkpp {
         void end_query(QueryPool& query_pool, std::uint32_t index);
 
     private:
+        void begin(RenderPass& render_pass, std::uint32_t subpass,
+                   VkFramebuffer framebuffer, VkCommandBufferUsageFlags usage);
+
+#ifdef VK_EXT_mesh_shader
+        static PFN_vkCmdDrawMeshTasksEXT vkCmdDrawMeshTasksEXT;
+#endif
+#ifdef VK_NV_shading_rate_image
+        static PFN_vkCmdBindShadingRateImageNV vkCmdBindShadingRateImageNV;
+#endif
+#ifdef VK_KHR_draw_indirect_count
+        static PFN_vkCmdDrawIndexedIndirectCountKHR vkCmdDrawIndexedIndirectCountKHR;
+#endif
+
         Queue* queue_family    { nullptr };
 
         VkDevice        device { VK_NULL_HANDLE };
@@ -190,7 +280,12 @@ namespace vkpp {
         allocate(std::uint32_t amount,
                  VkCommandBufferLevel command_level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
 
+        // If there's one, uploads with this pool are batched there, see vkpp::StagingRing.
+        void set_staging_ring(StagingRing* staging_ring);
+        StagingRing* get_staging_ring();
+
     private:
+        StagingRing* staging_ring { nullptr };
         Queue* queue_family  { nullptr };
         VkDevice device      { VK_NULL_HANDLE };
         VkCommandPool handle { VK_NULL_HANDLE };
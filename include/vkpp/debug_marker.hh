@@ -30,6 +30,11 @@ namespace vkpp {
         static void end(CommandBuffer&    command_buffer);
         static void end(CommandBuffer&    command_buffer, const char* name, QueryPool& query_pool);
         static void close(CommandBuffer&  command_buffer, const char* name, QueryPool& query_pool);
+
+        // Also counts the invocations of the section in the statistics_pool, if it's given. Those
+        // queries can't nest, and have to begin and end in the same subpass (or outside of one).
+        static void begin(CommandBuffer&  command_buffer, const char* name, QueryPool& query_pool, QueryPool* statistics_pool);
+        static void close(CommandBuffer&  command_buffer, const char* name, QueryPool& query_pool, QueryPool* statistics_pool);
         static void close(CommandBuffer&  command_buffer);
 
     private:
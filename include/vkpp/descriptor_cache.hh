@@ -0,0 +1,63 @@
+#ifndef VKPP_DESCRIPTOR_CACHE_HH
+#define VKPP_DESCRIPTOR_CACHE_HH
+
+#include <vkpp/descriptor_set.hh>
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+#include <mutex>
+#include <map>
+
+namespace vkpp {
+    class Device;
+
+    // Copies of the descriptor sets with the per-draw resources bound, keyed
+    // by the set they were copied from and those resources. Since the same
+    // draws are recorded each frame, the copies are only written once, and
+    // not before every draw, which would also overwrite the bindings of the
+    // earlier draws in that command buffer. They're allocated from a chain
+    // of pools that grows when full, and all of them are freed in one go by
+    // reset, e.g. when the pipelines (and their layouts) are being rebuilt.
+    class DescriptorCache final {
+    public:
+        DescriptorCache() = default;
+
+        DescriptorCache(Device& device, const std::vector<VkDescriptorPoolSize>& pool_sizes);
+
+        DescriptorCache(DescriptorCache&& descriptor_cache) noexcept;
+        DescriptorCache& operator=(DescriptorCache&& descriptor_cache) noexcept;
+
+        friend void swap(DescriptorCache& lhs, DescriptorCache& rhs);
+
+        DescriptorSet& get(DescriptorSet& descriptor_set,
+                           const std::vector<DescriptorSet::Write>& writes);
+
+        void reset(); // frees all of the cached sets.
+
+        std::size_t size() const;
+        std::size_t get_pool_count() const;
+
+    private:
+        VkDescriptorSet allocate(DescriptorSet::Layout& layout);
+
+        struct Entry {
+            DescriptorSet descriptor_set;
+            std::uint64_t version; // of the set copied from.
+        };
+
+        using Key = std::vector<std::uint64_t>;
+
+        std::map<Key, Entry> entries;
+
+        std::vector<DescriptorPool> descriptor_pools;
+        std::vector<VkDescriptorPoolSize> pool_sizes;
+
+        Device* device { nullptr };
+
+        std::mutex mutex; // sets can be requested while recording in parallel.
+    };
+}
+
+#endif
@@ -1,9 +1,11 @@
 #ifndef VKPP_DESCRIPTOR_SET_HH
 #define VKPP_DESCRIPTOR_SET_HH
 
+#include <vkpp/acceleration_structure.hh>
 #include <vkpp/buffer.hh>
 #include <vkpp/sampler.hh>
 #include <vkpp/image.hh>
+#include <vkpp/uniform_ring.hh>
 
 #include <vulkan/vulkan.h>
 
@@ -12,6 +14,7 @@
 
 namespace vkpp {
     class Device;
+    class DescriptorCache;
     class DescriptorSet final {
     public:
         struct Binding {
@@ -37,6 +40,10 @@ namespace vkpp {
                    VkDeviceSize offset = 0,
                    VkDeviceSize size = VK_WHOLE_SIZE);
 
+        void write(std::uint32_t binding,
+                   UniformRing& uniform_ring,
+                   const UniformRing::Range& range);
+
         void write(std::uint32_t binding,
                    ImageView& image_view);
 
@@ -44,6 +51,36 @@ namespace vkpp {
                    ImageView& image_view,
                    Sampler& sampler);
 
+#ifdef VK_KHR_acceleration_structure
+        void write(std::uint32_t binding,
+                   AccelerationStructure& acceleration_structure);
+#endif
+
+        // A binding of the resources used by a single draw, e.g. one hair style, see with.
+        struct Write {
+            Write(std::uint32_t binding, Buffer& buffer);
+            Write(std::uint32_t binding, ImageView& image_view);
+            Write(std::uint32_t binding, ImageView& image_view, Sampler& sampler);
+
+            std::uint32_t binding;
+
+            VkBuffer      buffer       { VK_NULL_HANDLE };
+            VkImageView   image_view   { VK_NULL_HANDLE };
+            VkImageLayout image_layout { VK_IMAGE_LAYOUT_UNDEFINED };
+            VkSampler     sampler      { VK_NULL_HANDLE };
+        };
+
+        void write(const Write& write);
+
+        // Returns a copy of this set with the bindings replaced from the descriptor cache of
+        // the pool it was allocated from, so the same set is reused for the same resources,
+        // instead of writing the per-draw resources into this set before every single draw.
+        // Without a descriptor cache they're written into this set and it's returned as is.
+        DescriptorSet& with(const std::vector<Write>& writes);
+
+        const std::vector<std::uint32_t>& get_written_bindings() const;
+        std::uint64_t get_version() const; // i.e. how many times it's been written.
+
         class Layout final {
         public:
             Layout() = default;
@@ -72,18 +109,26 @@ namespace vkpp {
             VkDescriptorSetLayout handle { VK_NULL_HANDLE };
         };
 
+        // If the descriptor_pool is VK_NULL_HANDLE the set is freed along with its pool instead.
         DescriptorSet(VkDescriptorSet& descriptor_set,
                       VkDescriptorPool& descriptor_pool,
                       Layout* descriptor_set_layout,
-                      VkDevice& device);
+                      VkDevice& device,
+                      DescriptorCache* descriptor_cache = nullptr);
 
         Layout& get_layout();
 
     private:
+        void updated(std::uint32_t binding);
+
         VkDescriptorSet  handle { VK_NULL_HANDLE };
         VkDescriptorPool pool   { VK_NULL_HANDLE };
         Layout*          layout { nullptr };
         VkDevice         device { VK_NULL_HANDLE };
+
+        DescriptorCache* cache  { nullptr };
+        std::vector<std::uint32_t> written_bindings;
+        std::uint64_t version { 0 };
     };
 
     class DescriptorPool final {
@@ -108,9 +153,18 @@ namespace vkpp {
                                             DescriptorSet::Layout& layout,
                                             std::string name = "");
 
+        // Frees every set allocated from it at once, so only when none of them are left.
+        void reset();
+
+        // The sets allocated after this use it in DescriptorSet::with.
+        void set_descriptor_cache(DescriptorCache* descriptor_cache);
+        DescriptorCache* get_descriptor_cache();
+
     private:
         std::vector<VkDescriptorPoolSize> pool_sizes;
 
+        DescriptorCache* descriptor_cache { nullptr };
+
         VkDevice         device { VK_NULL_HANDLE };
         VkDescriptorPool handle { VK_NULL_HANDLE };
     };
@@ -6,9 +6,11 @@
 #include <vkpp/extension.hh>
 
 #include <vkpp/queue.hh>
+#include <vkpp/memory_allocator.hh>
 
 #include <vulkan/vulkan.h>
 
+#include <memory>
 #include <vector>
 #include <unordered_map>
 #include <string>
@@ -20,7 +22,9 @@ namespace vkpp {
         Device(PhysicalDevice& physical_device,
                const std::vector<Layer>& enabled_instance_layers,
                const std::vector<Extension>& required_extensions,
-               const VkPhysicalDeviceFeatures& required_features);
+               const VkPhysicalDeviceFeatures& required_features,
+               const void* extension_features = nullptr, // e.g. VkPhysicalDeviceMeshShaderFeaturesEXT chain.
+               const std::vector<VkPhysicalDevice>& device_group = {}); // see Instance::find_device_group.
         ~Device() noexcept;
 
         Device(Device&& device) noexcept;
@@ -32,6 +36,13 @@ namespace vkpp {
 
         PhysicalDevice& get_physical_device() const;
 
+        // Used when creating any pipeline on this device, see vkpp::PipelineCache.
+        void set_pipeline_cache(VkPipelineCache pipeline_cache);
+        VkPipelineCache get_pipeline_cache() const;
+
+        MemoryAllocator* get_memory_allocator(); // for DeviceMemory.
+        MemoryAllocator::Statistics get_memory_statistics() const;
+
         template<typename T> std::vector<T> find(const std::vector<T>& requested,
                                                  const std::vector<T>& available) const;
         std::vector<Extension> find(const std::vector<Extension>& extensions) const;
@@ -42,12 +53,21 @@ namespace vkpp {
         const std::vector<Extension>& get_enabled_extensions() const;
 
         bool has_compute_queue() const;
+        bool has_async_compute_queue() const; // i.e. not the graphics queue.
         bool has_graphics_queue() const;
         bool has_transfer_queue() const;
         bool has_present_queue() const;
 
         void wait_idle();
 
+        // How many GPUs it was created on, i.e. 1 if not on a device group. Every allocation is made
+        // on all of them, and every command buffer is only run on device 0, unless it's submitted to
+        // another one, see Queue::submit with a device index (and DeviceBuffer for the peer memory).
+        std::uint32_t get_device_count() const;
+
+        // If 'local_device' can copy into 'remote_device's instance in the heap, e.g. to hand it over.
+        bool has_peer_copies(std::uint32_t heap_index, std::uint32_t local_device, std::uint32_t remote_device) const;
+
         Queue& get_compute_queue();  // WARNING: there may or may NOT be a queue of the
         Queue& get_graphics_queue(); // type you want, in that case make sure to check
         Queue& get_transfer_queue(); // if the resulting queue is nullptr. In most cases
@@ -71,6 +91,12 @@ namespace vkpp {
 
         PhysicalDevice* physical_device { nullptr };
 
+        VkPipelineCache pipeline_cache { VK_NULL_HANDLE };
+
+        std::uint32_t device_count { 1 };
+
+        std::unique_ptr<MemoryAllocator> memory_allocator;
+
         VkDevice handle { VK_NULL_HANDLE };
     };
 
@@ -1,6 +1,8 @@
 #ifndef VKPP_DEVICE_MEMORY_HH
 #define VKPP_DEVICE_MEMORY_HH
 
+#include <vkpp/memory_allocator.hh>
+
 #include <vulkan/vulkan.h>
 
 #include <cstdint>
@@ -22,9 +24,15 @@ namespace vkpp {
             DeviceLocal
         };
 
+        // These are sub-allocated from the device's MemoryAllocator, see get_offset.
         DeviceMemory(Device& device, VkMemoryRequirements requirements,
                      Type type = Type::HostVisible); // Warning!
 
+        // Not sub-allocated, since the whole allocation gets the flags, e.g. the device address
+        // bit for the buffers that the shaders and the acceleration structure builds address.
+        DeviceMemory(Device& device, VkMemoryRequirements requirements,
+                     Type type, VkMemoryAllocateFlags flags);
+
         ~DeviceMemory() noexcept;
 
         DeviceMemory(DeviceMemory&& memory) noexcept;
@@ -37,6 +45,8 @@ namespace vkpp {
         VkDeviceSize  get_size() const;
         std::uint32_t get_type() const;
 
+        VkDeviceSize get_offset() const; // into get_handle(), for binding.
+
         void map(VkDeviceSize offset, VkDeviceSize size, void** data);
         void unmap();
 
@@ -46,6 +56,9 @@ namespace vkpp {
         std::uint32_t type;
         VkDeviceSize  size;
 
+        MemoryAllocator::Allocation allocation;
+        MemoryAllocator* allocator { nullptr };
+
         VkDevice device       { VK_NULL_HANDLE };
         VkDeviceMemory handle { VK_NULL_HANDLE };
     };
@@ -40,6 +40,11 @@ namespace vkpp {
                     ImageView& depth_attachment,
                     const VkExtent2D& extent);
 
+        Framebuffer(VkDevice& device,
+                    RenderPass& render_pass,
+                    const std::vector<VkImageView>& attachments,
+                    const VkExtent2D& extent); // e.g. if owned by others.
+
         ~Framebuffer() noexcept;
 
         Framebuffer(Framebuffer&& device) noexcept;
@@ -2,6 +2,8 @@
 #define VKPP_IMAGE_HH
 
 #include <vkhr/image.hh>
+#include <vkhr/large_buffer.hh>
+#include <vkhr/texture.hh>
 #include <vkpp/device_memory.hh>
 #include <vkpp/sampler.hh>
 #include <vkpp/buffer.hh>
@@ -10,6 +12,7 @@
 
 #include <cstdint>
 #include <utility>
+#include <vector>
 
 namespace vkpp {
     class Queue;
@@ -27,7 +30,8 @@ namespace vkpp {
               std::uint32_t depth, VkFormat format, VkImageUsageFlags usage,
               std::uint32_t mip_levels = 1,
               VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT,
-              VkImageTiling tiling_mode = VK_IMAGE_TILING_OPTIMAL);
+              VkImageTiling tiling_mode = VK_IMAGE_TILING_OPTIMAL,
+              std::uint32_t array_layers = 1); // for a 2D array if depth is 1.
 
         Image(Device& device, std::uint32_t width, std::uint32_t height,
               VkFormat format, VkImageUsageFlags usage,
@@ -54,22 +58,33 @@ namespace vkpp {
         VkImageUsageFlags get_usage() const;
 
         std::uint32_t get_mip_levels() const;
+        std::uint32_t get_array_layers() const;
         VkSampleCountFlagBits get_samples() const;
 
         VkSharingMode get_sharing_mode() const;
         VkImageTiling get_tiling_mode() const;
         VkImageLayout get_layout() const;
+        // When it was transitioned by a barrier recorded somewhere else, e.g. by a render graph.
+        void set_layout(VkImageLayout layout);
 
         VkImageAspectFlags get_aspect_mask() const;
 
+        // Of every mip level and layer, unlike the two below, which only do the base one.
         void transition(CommandBuffer& command_buffer,
                         VkAccessFlags src_access, VkAccessFlags dst_access,
                         VkImageLayout src_layout, VkImageLayout dst_layout,
-                        VkPipelineStageFlags src, VkPipelineStageFlags dst);
+                        VkPipelineStageFlags src, VkPipelineStageFlags dst,
+                        std::uint32_t src_queue_family = VK_QUEUE_FAMILY_IGNORED,
+                        std::uint32_t dst_queue_family = VK_QUEUE_FAMILY_IGNORED);
 
         void transition(CommandBuffer& command_buffer, VkImageLayout from, VkImageLayout to);
         void transition(CommandBuffer& command_buffer, VkImageLayout to);
 
+        // Of every mip level after each other, tightly packed from the offset, which is moved past them.
+        // Empty if the format isn't one of the uncompressed ones that get_texel_size knows the size of.
+        std::vector<VkBufferImageCopy> get_buffer_regions(VkDeviceSize& offset) const;
+        static VkDeviceSize get_texel_size(VkFormat format); // or 0.
+
         VkDeviceMemory& get_bound_memory();
         VkMemoryRequirements get_memory_requirements() const;
         void bind(DeviceMemory& device_memory,
@@ -80,6 +95,7 @@ namespace vkpp {
         VkFormat format;
         VkImageUsageFlags usage;
         std::uint32_t mip_levels;
+        std::uint32_t array_layers { 1 };
         VkSampleCountFlagBits samples;
 
         VkImageAspectFlags aspect_mask;
@@ -104,10 +120,18 @@ namespace vkpp {
         DeviceImage& operator=(DeviceImage&& image) noexcept;
         DeviceImage(DeviceImage&& image) noexcept;
 
+        // With more than one mip level, the rest of them are generated from the image by blits.
         DeviceImage(Device& device, CommandPool& command_pool,
                     vkhr::Image& image,
                     std::uint32_t mip_levels = 1);
 
+        // With all of the texture's levels, which are copied straight from its file into the staging.
+        DeviceImage(Device& device, CommandPool& command_pool,
+                    const vkhr::Texture& texture);
+
+        static VkFormat get_texture_format(const vkhr::Texture& texture);
+        static std::uint32_t get_mip_chain_length(std::uint32_t width, std::uint32_t height); // down to 1x1.
+
         DeviceImage(Device& device, std::uint32_t width, std::uint32_t height, VkDeviceSize size_in_bytes,
                     VkFormat format = VK_FORMAT_R8G8B8A8_UNORM,
                     VkImageUsageFlags usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT);
@@ -115,13 +139,13 @@ namespace vkpp {
         DeviceImage(Device& device,
                     std::uint32_t width, std::uint32_t height, std::uint32_t depth,
                     CommandPool& command_pool,
-                    std::vector<unsigned char>& volume,
+                    vkhr::LargeBuffer<unsigned char>& volume,
                     std::uint32_t mip_levels = 1);
 
         DeviceImage(Device& device,
                     std::uint32_t width, std::uint32_t height, std::uint32_t depth,
                     CommandPool& command_pool,
-                    std::vector<glm::i8vec4>& volume,
+                    vkhr::LargeBuffer<glm::i8vec2>& volume, // octahedral.
                     std::uint32_t mip_levels = 1);
 
         DeviceImage(Device& device,
@@ -129,6 +153,7 @@ namespace vkpp {
                     VkDeviceSize size_in_bytes, CommandPool& command_pool, VkFormat format = VK_FORMAT_R8_UNORM,
                     VkImageUsageFlags usage = VK_IMAGE_USAGE_STORAGE_BIT |
                                               VK_IMAGE_USAGE_SAMPLED_BIT |
+                                              VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
                                               VK_IMAGE_USAGE_TRANSFER_DST_BIT);
 
         DeviceMemory& get_device_memory();
@@ -138,9 +163,17 @@ namespace vkpp {
         DeviceMemory& get_staging_memory();
 
         void staged_copy(vkhr::Image& image,                 CommandBuffer& command_buffer);
-        void staged_copy(std::vector<unsigned char>& volume, CommandBuffer& command_buffer);
+        void staged_copy(vkhr::LargeBuffer<unsigned char>& volume, CommandBuffer& command_buffer);
 
     private:
+        // Batched if it has a staging ring. Without any regions the staging is copied into the base level,
+        // and the other levels are generated from it if asked to, otherwise the regions have every level.
+        void upload(CommandPool& command_pool, const std::vector<VkBufferImageCopy>& regions = {},
+                    bool generate_mips = false);
+        void record_upload(CommandBuffer& command_buffer, const std::vector<VkBufferImageCopy>& regions,
+                           bool generate_mips);
+        void generate_mipmaps(CommandBuffer& command_buffer); // from the base level in the transfer layout.
+
         Buffer       staging_buffer;
         DeviceMemory staging_memory;
 
@@ -153,6 +186,9 @@ namespace vkpp {
 
         ImageView(VkDevice& device, VkImageView& image, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
         ImageView(Device& device,     Image& image,     VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        ImageView(Device& device,     Image& image,     VkImageLayout layout,
+                  std::uint32_t base_mip_level, std::uint32_t mip_level_count = 1,
+                  std::uint32_t base_array_layer = 0, std::uint32_t array_layer_count = 1);
 
         ~ImageView() noexcept;
 
@@ -46,6 +46,10 @@ namespace vkpp {
 
         const std::vector<PhysicalDevice>& get_physical_devices() const;
 
+        // The GPUs in the same device group as this one (e.g. linked by NVLink or CrossFire), with it
+        // first, for a Device created on all of them. Only the one if it isn't grouped with any others.
+        std::vector<VkPhysicalDevice> find_device_group(PhysicalDevice& physical_device) const;
+
         DebugMessenger& get_debug_messenger();
 
         static Version get_api_version();
@@ -0,0 +1,79 @@
+#ifndef VKPP_MEMORY_ALLOCATOR_HH
+#define VKPP_MEMORY_ALLOCATOR_HH
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace vkpp {
+    class PhysicalDevice;
+
+    // Sub-allocates DeviceMemory out of large blocks per memory type, so
+    // we don't run into maxMemoryAllocationCount with many small buffers,
+    // and so we don't pay for a vkAllocateMemory on each one of them. The
+    // host-visible blocks stay mapped, since any memory can be mapped once.
+    class MemoryAllocator final {
+    public:
+        MemoryAllocator(VkDevice device, PhysicalDevice& physical_device,
+                        VkDeviceSize block_size = DefaultBlockSize);
+        ~MemoryAllocator() noexcept;
+
+        MemoryAllocator(const MemoryAllocator&) = delete;
+        MemoryAllocator& operator=(const MemoryAllocator&) = delete;
+
+        struct Block;
+
+        struct Allocation {
+            VkDeviceMemory memory { VK_NULL_HANDLE };
+            VkDeviceSize offset { 0 };
+            VkDeviceSize size   { 0 };
+            void* mapped { nullptr };   // into the block, if host-visible.
+            Block* block { nullptr };   // or none for dedicated allocations.
+        };
+
+        Allocation allocate(const VkMemoryRequirements& requirements, std::uint32_t type);
+        void free(const Allocation& allocation);
+
+        struct Statistics {
+            VkDeviceSize reserved { 0 }; // in blocks and dedicated allocations.
+            VkDeviceSize used     { 0 };
+            std::uint32_t blocks { 0 };
+            std::uint32_t allocations { 0 };
+            std::uint32_t dedicated_allocations { 0 };
+        };
+
+        Statistics get_statistics() const;
+
+        static constexpr VkDeviceSize DefaultBlockSize { 64 * 1024 * 1024 };
+
+        struct Block {
+            VkDeviceMemory memory { VK_NULL_HANDLE };
+            std::uint32_t type;
+            VkDeviceSize size;
+            void* mapped { nullptr };
+            std::map<VkDeviceSize, VkDeviceSize> free_ranges; // offset to size.
+        };
+
+    private:
+        bool sub_allocate(Block& block, VkDeviceSize size, VkDeviceSize alignment, Allocation& allocation);
+        Block* create_block(std::uint32_t type);
+
+        VkDeviceSize block_size;
+        VkDeviceSize buffer_image_granularity;
+        const VkPhysicalDeviceMemoryProperties* memory_properties;
+
+        std::vector<std::unique_ptr<Block>> blocks;
+
+        Statistics statistics;
+
+        mutable std::mutex mutex;
+
+        VkDevice device { VK_NULL_HANDLE };
+    };
+}
+
+#endif
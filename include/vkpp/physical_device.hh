@@ -38,6 +38,16 @@ namespace vkpp {
         std::uint32_t get_device_memory_heap() const;
         VkDeviceSize  get_device_memory_size() const;
 
+        // Of each memory heap, from VK_EXT_memory_budget if the device has it (and it's enabled),
+        // which includes the other processes' usage too. If not, the budget is the heap's size.
+        struct MemoryBudget {
+            VkDeviceSize budget { 0 };
+            VkDeviceSize usage  { 0 }; // or none if unknown.
+        };
+
+        bool has_memory_budget() const;
+        std::vector<MemoryBudget> get_memory_budgets() const;
+
         static constexpr VkMemoryPropertyFlagBits HostVisibleMemory {
             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
         };
@@ -68,12 +78,14 @@ namespace vkpp {
         bool has_every_queue() const;
 
         bool has_compute_queue() const;
+        bool has_async_compute_queue() const;
         bool has_graphics_queue() const;
         bool has_transfer_queue() const;
         bool has_present_queue() const;
 
         bool has_present_queue(Surface& surface) const;
         void assign_present_queue_indices(Surface& surface);
+        void assign_present_queue_indices(); // off-screen, it's the graphics queue, but never used.
         void query_surface_capabilities(Surface& surface);
 
         std::int32_t get_compute_queue_family_index() const;
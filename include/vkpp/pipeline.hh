@@ -126,6 +126,8 @@ namespace vkpp {
             void set_topology(VkPrimitiveTopology topology);
             VkPrimitiveTopology get_topology() const;
 
+            void enable_primitive_restart(bool enabled = true);
+
             VkPipelineInputAssemblyStateCreateInfo input_assembly_state {
                 VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
                 nullptr,
@@ -162,6 +164,36 @@ namespace vkpp {
                 nullptr // pScissors
             };
 
+#ifdef VK_NV_shading_rate_image
+            // The shading rate of each region is then the entry of the palette that the shading rate image
+            // bound with CommandBuffer::bind_shading_rate_image has for it, and the samples of the coarse
+            // fragments are in pixel-major order in gl_SampleMaskIn. It's only for the one viewport.
+            void enable_shading_rate_image(const std::vector<VkShadingRatePaletteEntryNV>& palette);
+
+            std::vector<VkShadingRatePaletteEntryNV> shading_rate_palette_entries;
+
+            VkShadingRatePaletteNV shading_rate_palette {
+                0, // shadingRatePaletteEntryCount
+                nullptr // pShadingRatePaletteEntries
+            };
+
+            VkPipelineViewportCoarseSampleOrderStateCreateInfoNV coarse_sample_order_state {
+                VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_COARSE_SAMPLE_ORDER_STATE_CREATE_INFO_NV,
+                nullptr,
+                VK_COARSE_SAMPLE_ORDER_TYPE_PIXEL_MAJOR_NV, // sampleOrderType
+                0, // customSampleOrderCount
+                nullptr // pCustomSampleOrders
+            };
+
+            VkPipelineViewportShadingRateImageStateCreateInfoNV shading_rate_image_state {
+                VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_SHADING_RATE_IMAGE_STATE_CREATE_INFO_NV,
+                nullptr,
+                VK_FALSE, // shadingRateImageEnable
+                0, // viewportCount
+                nullptr // pShadingRatePalettes
+            };
+#endif
+
             float get_line_width() const;
             void set_line_width(float line_width);
             VkPolygonMode get_polygon_mode() const;
@@ -239,8 +271,11 @@ namespace vkpp {
             std::vector<VkPipelineColorBlendAttachmentState> attachments;
 
             void disable_blending_for(std::uint32_t attachment);
+            void disable_color_writes_for(std::uint32_t attachment); // e.g. for depth-only passes.
             void enable_additive_blending_for(std::uint32_t attachment);
             void enable_alpha_blending_for(std::uint32_t attachment);
+            void enable_accumulation_blending_for(std::uint32_t attachment); // i.e. src + dst.
+            void enable_revealage_blending_for(std::uint32_t attachment); // i.e. (1 - src) * dst.
 
             VkPipelineColorBlendStateCreateInfo    color_blending_state {
                 VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
@@ -0,0 +1,44 @@
+#ifndef VKPP_PIPELINE_CACHE_HH
+#define VKPP_PIPELINE_CACHE_HH
+
+#include <vulkan/vulkan.h>
+
+#include <string>
+#include <vector>
+
+namespace vkpp {
+    class Device;
+    class PipelineCache final {
+    public:
+        PipelineCache() = default;
+
+        // Loads the cache from the directory if there is one for this device
+        // and driver, otherwise starts with an empty cache which is written
+        // there on save. The file is keyed by the pipeline cache UUID, since
+        // the driver will reject (or worse) the data of any other version.
+        PipelineCache(Device& device, const std::string& directory);
+
+        ~PipelineCache() noexcept;
+
+        PipelineCache(PipelineCache&& pipeline_cache) noexcept;
+        PipelineCache& operator=(PipelineCache&& pipeline_cache) noexcept;
+
+        friend void swap(PipelineCache& lhs, PipelineCache& rhs);
+
+        VkPipelineCache& get_handle();
+
+        const std::string& get_path() const;
+
+        std::vector<char> get_data() const;
+
+        bool save() const; // false if it couldn't be written.
+
+    private:
+        std::string path;
+
+        VkDevice        device { VK_NULL_HANDLE };
+        VkPipelineCache handle { VK_NULL_HANDLE };
+    };
+}
+
+#endif
@@ -36,8 +36,33 @@ namespace vkpp {
 
         std::uint32_t get_timestamp_query_count() const;
 
+        // From the queries written since the last reset, without waiting for them, so it's best
+        // called after that command buffer's fence. Unavailable ones keep their last durations.
         std::unordered_map<std::string, float>& request_timestamp_queries();
 
+        struct TimestampSpan {
+            double begin; // in ns, on the GPU's own clock.
+            double end;
+        };
+
+        // Of the same timestamps as the last request_timestamp_queries.
+        const std::unordered_map<std::string, TimestampSpan>& get_timestamp_spans() const;
+
+        // For the pools of VK_QUERY_TYPE_PIPELINE_STATISTICS, with the counters that it was created
+        // with (the others are left as zero), of the last time each of the named queries was available.
+        struct PipelineStatistics {
+            std::uint64_t vertex_invocations   { 0 };
+            std::uint64_t geometry_invocations { 0 };
+            std::uint64_t clipping_primitives  { 0 };
+            std::uint64_t fragment_invocations { 0 };
+            std::uint64_t compute_invocations  { 0 };
+        };
+
+        void set_statistics_query(const std::string& name, std::uint32_t query);
+        std::uint32_t get_statistics_query(const std::string& name) const;
+
+        std::unordered_map<std::string, PipelineStatistics>& request_statistics_queries();
+
         VkQueryType get_query_type() const;
         VkQueryPipelineStatisticFlags get_pipeline_statistics_flag() const;
         std::uint32_t get_query_count() const;
@@ -66,6 +91,11 @@ namespace vkpp {
 
         std::unordered_map<std::string, TimestampPair> timestamps;
         std::unordered_map<std::string, float> timestamp_ms_time;
+        std::unordered_map<std::string, TimestampSpan> timestamp_spans;
+
+        std::unordered_map<std::string, std::uint32_t> statistics_queries;
+        std::unordered_map<std::string, PipelineStatistics> statistics;
+        std::vector<std::uint64_t> statistics_buffer;
 
         std::uint64_t* timestamp_buffer { nullptr };
 
@@ -9,6 +9,7 @@
 #include <vulkan/vulkan.h>
 
 #include <cstdint>
+#include <vector>
 
 namespace vkpp {
     class Queue final {
@@ -21,6 +22,10 @@ namespace vkpp {
 
         std::uint32_t get_family_index() const;
 
+        // E.g. the uploads, which without a device index run on every GPU of the Device's group,
+        // while their semaphores are waited for and signaled on the first. Else only on that one.
+        static constexpr std::uint32_t AllDevices { ~0u };
+
         Queue& submit(CommandBuffer& command_buffer);
 
         Queue& submit(CommandBuffer& command_buffer,
@@ -38,6 +43,36 @@ namespace vkpp {
                       Semaphore& signal,
                       Fence& fence);
 
+        Queue& submit(CommandBuffer& command_buffer,
+                      const std::vector<Semaphore*>& wait,
+                      const std::vector<VkPipelineStageFlags>& wait_stages,
+                      const std::vector<Semaphore*>& signal);
+
+        Queue& submit(CommandBuffer& command_buffer,
+                      const std::vector<Semaphore*>& wait,
+                      const std::vector<VkPipelineStageFlags>& wait_stages,
+                      const std::vector<Semaphore*>& signal,
+                      Fence& fence,
+                      std::uint32_t device_index = AllDevices);
+
+        // The semaphores are waited for and signaled on that GPU too, so another GPU can wait on them.
+        Queue& submit(CommandBuffer& command_buffer,
+                      const std::vector<Semaphore*>& wait,
+                      const std::vector<VkPipelineStageFlags>& wait_stages,
+                      const std::vector<Semaphore*>& signal,
+                      std::uint32_t device_index);
+
+#ifdef VK_KHR_timeline_semaphore
+        // Also signals the timeline semaphore with the value when it's done.
+        Queue& submit(CommandBuffer& command_buffer,
+                      const std::vector<Semaphore*>& wait,
+                      const std::vector<VkPipelineStageFlags>& wait_stages,
+                      const std::vector<Semaphore*>& signal,
+                      TimelineSemaphore& timeline,
+                      std::uint64_t timeline_value,
+                      std::uint32_t device_index = AllDevices);
+#endif
+
         Queue& wait_idle();
 
         Queue& present(SwapChain& swap_chain,
@@ -47,7 +82,21 @@ namespace vkpp {
         Queue& present(SwapChain& swap_chain,
                        std::uint32_t indices);
 
+#ifdef VK_GOOGLE_display_timing
+        // With an id to find it by in SwapChain::get_past_presentation_timing, for when it was shown.
+        Queue& present(SwapChain& swap_chain,
+                       std::uint32_t indices,
+                       Semaphore& wait,
+                       std::uint32_t present_id);
+#endif
+
     private:
+        Queue& submit(CommandBuffer& command_buffer,
+                      const std::vector<Semaphore*>& wait,
+                      const std::vector<VkPipelineStageFlags>& wait_stages,
+                      const std::vector<Semaphore*>& signal,
+                      VkFence fence, std::uint32_t device_index = AllDevices);
+
         std::uint32_t family_index { 42 };
         VkQueue handle { VK_NULL_HANDLE };
     };
@@ -7,7 +7,7 @@
 #include <utility>
 #include <cstdint>
 
-namespace vkhr::vulkan { class DepthMap; }
+namespace vkhr::vulkan { class DepthMap; class OpacityMap; class VolumeTarget; class WeightedBlended; }
 
 namespace vkpp {
     class Device;
@@ -37,10 +37,13 @@ namespace vkpp {
 
         RenderPass() = default;
 
+        // With a view mask, every subpass is drawn once for each of the views in it, into that layer of
+        // the (layered) attachments, and shaders can tell which one it is from gl_ViewIndex (multiview).
         RenderPass(Device& logical_device,
                    const std::vector<Attachment>& attachments,
                    const std::vector<Subpass>& subpasses,
-                   const std::vector<Dependency>& dependencies = { });
+                   const std::vector<Dependency>& dependencies = { },
+                   std::uint32_t view_mask = 0);
 
         RenderPass(Device& logical_device,
                    const std::vector<Attachment>& attachments,
@@ -69,9 +72,15 @@ namespace vkpp {
 
         bool has_depth_attachment() const;
 
-        static void create_modified_color_pass(RenderPass& color_pass, Device& device, SwapChain& window_swap_chain);
+        static void create_modified_color_pass(RenderPass& color_pass, Device& device, SwapChain& window_swap_chain,
+                                               std::uint32_t view_mask = 0); // for stereo.
         static void create_standard_depth_pass(RenderPass& depth_pass, Device& device);
+        static void create_multiview_depth_pass(RenderPass& depth_pass, Device& device, std::uint32_t view_count);
+        static void create_opacity_layer_pass(RenderPass& opacity_pass, Device& device);
         static void create_standard_imgui_pass(RenderPass& imgui_pass, Device& device, SwapChain& window_swap_chain);
+        static void create_scaled_volume_pass(RenderPass& volume_pass, Device& device);
+        static void create_weighted_blended_pass(RenderPass& weighted_blended_pass, Device& device, SwapChain& window_swap_chain);
+        static void create_hair_pass(RenderPass& hair_pass, Device& device, SwapChain& window_swap_chain); // see HairTarget.
 
     private:
         std::vector<VkAttachmentDescription> attachments;
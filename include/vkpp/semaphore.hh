@@ -31,6 +31,44 @@ namespace vkpp {
         VkDevice    device { VK_NULL_HANDLE };
         VkSemaphore handle { VK_NULL_HANDLE };
     };
+
+#ifdef VK_KHR_timeline_semaphore
+    // A 64-bit counter that only goes up, signaled by queue submissions
+    // (e.g. Queue::submit with a value), and waited on by the host. Needs
+    // VK_KHR_timeline_semaphore and setup_function_pointers on the device.
+    class TimelineSemaphore final {
+    public:
+        TimelineSemaphore() = default;
+        TimelineSemaphore(Device& device, std::uint64_t initial_value = 0);
+
+        ~TimelineSemaphore() noexcept;
+
+        static TimelineSemaphore create(Device& device, const char* name);
+
+        TimelineSemaphore(TimelineSemaphore&& semaphore) noexcept;
+        TimelineSemaphore& operator=(TimelineSemaphore&& semaphore) noexcept;
+
+        friend void swap(TimelineSemaphore& lhs, TimelineSemaphore& rhs);
+
+        VkSemaphore& get_handle();
+
+        std::uint64_t get_value() const;
+
+        // Returns false if the value wasn't reached before the timeout.
+        bool wait(std::uint64_t value, std::uint64_t timeout = UINT64_MAX) const;
+        void signal(std::uint64_t value);
+
+        static void setup_function_pointers(VkDevice device);
+
+    private:
+        static PFN_vkGetSemaphoreCounterValueKHR vkGetSemaphoreCounterValueKHR;
+        static PFN_vkWaitSemaphoresKHR vkWaitSemaphoresKHR;
+        static PFN_vkSignalSemaphoreKHR vkSignalSemaphoreKHR;
+
+        VkDevice    device { VK_NULL_HANDLE };
+        VkSemaphore handle { VK_NULL_HANDLE };
+    };
+#endif
 }
 
 #endif
@@ -3,11 +3,14 @@
 
 #define VKPP_SHADER_MODULE_GLSLC "glslc -O -g -c"
 #define VKPP_SHADER_MODULE_HLSLC "glslc -O -g -fshader-stage=compute -fentry-point="
+#define VKPP_SHADER_MODULE_SPV14 " --target-spv=spv1.4" // mesh and task shaders.
 
 #include <vulkan/vulkan.h>
 
 #include <string>
 #include <vector>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace vkpp {
     class Device;
@@ -29,7 +32,11 @@ namespace vkpp {
             TesselationEvaluation = VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT,
             Geometry = VK_SHADER_STAGE_GEOMETRY_BIT,
             Fragment = VK_SHADER_STAGE_FRAGMENT_BIT,
-            Compute = VK_SHADER_STAGE_COMPUTE_BIT
+            Compute = VK_SHADER_STAGE_COMPUTE_BIT,
+#ifdef VK_EXT_mesh_shader
+            Task = VK_SHADER_STAGE_TASK_BIT_EXT,
+            Mesh = VK_SHADER_STAGE_MESH_BIT_EXT
+#endif
         };
 
         ShaderModule(ShaderModule&& shader_module) noexcept;
@@ -39,8 +46,25 @@ namespace vkpp {
 
         VkShaderModule& get_handle();
 
+        // Only spawns the compiler if the source, or any file it #includes,
+        // has changed since the last time, see compile. And then reloads the
+        // module if the resulting SPIR-V is different from the current one.
         bool recompile();
 
+        bool compile(); // false if the sources haven't changed.
+        bool reload();  // false if the SPIR-V is still the same.
+
+        // Compiles the distinct shaders in parallel, so recompile only needs to reload them.
+        static void compile(const std::vector<ShaderModule*>& shader_modules);
+
+        // The shader modules' sources, with the hashes they were last compiled from, to be compiled on
+        // another thread while the modules are still in use (since it doesn't touch them). The hashes
+        // are then given back to the modules with update_sources, so that reload picks up the SPIR-V.
+        using Sources = std::unordered_map<std::string, std::uint32_t>; // file path -> hashed sources.
+        static Sources get_sources(const std::vector<ShaderModule*>& shader_modules);
+        static void compile(Sources& sources); // in parallel, only the ones that changed.
+        static void update_sources(const std::vector<ShaderModule*>& shader_modules, const Sources& sources);
+
         Type get_stage() const;
         std::size_t get_file_size() const;
         const std::string& get_file_path() const;
@@ -58,12 +82,19 @@ namespace vkpp {
         std::uint32_t djb2a(const std::vector<char>& data);
         std::wstring to_lpcwstr(const std::string& string);
 
+        std::uint32_t hash_sources() const;
+        static std::uint32_t hash_sources(const std::string& file_path);
+        static bool compile(const std::string& file_path, std::uint32_t& hashed_sources);
+        static void read_sources(const std::string& file_path, std::vector<char>& sources,
+                                 std::unordered_set<std::string>& visited_files);
+
         Type shader_type;
         std::string file_path;
         std::string file_name;
         std::string file_extension;
         std::size_t file_size { 0 };
         std::uint32_t hashed_spirv;
+        std::uint32_t hashed_sources { 0 };
         std::vector<char> spirv;
 
         void* constants_data { nullptr };
@@ -0,0 +1,69 @@
+#ifndef VKPP_STAGING_RING_HH
+#define VKPP_STAGING_RING_HH
+
+#include <vkpp/buffer.hh>
+#include <vkpp/command_buffer.hh>
+#include <vkpp/device_memory.hh>
+#include <vkpp/fence.hh>
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+
+namespace vkpp {
+    class Device;
+
+    // Persistently mapped staging memory that batches all of the uploads
+    // between a begin and submit into a single command buffer, instead of
+    // paying for a submit and wait per resource. While it's recording, the
+    // resources created with its command pool are uploaded through it. If
+    // it runs out of space, whatever is recorded so far is submitted, and
+    // it starts over at the beginning of the ring. Anything larger than it
+    // falls back to the usual (blocking) upload path of those resources.
+    class StagingRing final {
+    public:
+        StagingRing() = default;
+
+        StagingRing(Device& device, CommandPool& command_pool,
+                    VkDeviceSize size_in_bytes = DefaultSize);
+
+        StagingRing(StagingRing&& staging_ring) noexcept;
+        StagingRing& operator=(StagingRing&& staging_ring) noexcept;
+
+        friend void swap(StagingRing& lhs, StagingRing& rhs);
+
+        void begin();
+        bool is_recording() const;
+
+        // False if it's never going to fit, otherwise the copy is recorded.
+        bool copy(const void* data, VkDeviceSize size, Buffer& destination);
+
+        CommandBuffer& get_command_buffer();
+
+        void submit(); // and waits for everything to complete.
+
+        VkDeviceSize get_size() const;
+        VkDeviceSize get_uploaded_bytes() const; // since the last begin.
+
+        static constexpr VkDeviceSize DefaultSize { 32 * 1024 * 1024 };
+
+    private:
+        void flush();
+
+        Buffer buffer;
+        DeviceMemory memory;
+        char* mapped { nullptr };
+
+        VkDeviceSize offset { 0 };
+        VkDeviceSize uploaded_bytes { 0 };
+
+        bool recording { false };
+
+        CommandBuffer command_buffer;
+        Fence fence;
+
+        CommandPool* command_pool { nullptr };
+    };
+}
+
+#endif
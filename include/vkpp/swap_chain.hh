@@ -30,6 +30,12 @@ namespace vkpp {
                   const PresentationMode& preferred_present_mode,
                   const VkExtent2D& preferred_window_extent,
                   VkSwapchainKHR old_swapchain = nullptr);
+        // Off-screen, without a surface: image_count device-local images of the format and extent,
+        // which are "acquired" in turn, and never presented. Everything else works just the same.
+        SwapChain(Device& device, CommandPool& command_pool,
+                  const VkSurfaceFormatKHR& format,
+                  const VkExtent2D& extent,
+                  std::uint32_t image_count);
         ~SwapChain() noexcept;
 
         SwapChain(SwapChain&& device) noexcept;
@@ -47,6 +53,7 @@ namespace vkpp {
         std::vector<Framebuffer> create_framebuffers(RenderPass& render_pass);
 
         ImageView& get_depth_buffer_view();
+        Image& get_depth_buffer_image(); // e.g. for transitions.
 
         std::vector<ImageView>& get_image_views();
         std::vector<ImageView>& get_general_image_views();
@@ -74,14 +81,27 @@ namespace vkpp {
         void set_state(VkResult);
         bool out_of_date() const;
 
+        bool is_offscreen() const; // there's nothing to wait for or to present to.
+
         const VkSurfaceFormatKHR& get_surface_format() const;
 
         std::uint32_t size() const;
 
         static PresentationMode mode(bool vsync);
 
+#ifdef VK_GOOGLE_display_timing
+        // Of the presents with a present id (see Queue::present) that were displayed since the
+        // last call, with the CLOCK_MONOTONIC time they were actually on the screen, in nanoseconds.
+        // Needs VK_GOOGLE_display_timing and setup_display_timing_function_pointers on the device.
+        std::vector<VkPastPresentationTimingGOOGLE> get_past_presentation_timing();
+
+        static void setup_display_timing_function_pointers(VkDevice device);
+#endif
+
     private:
         void create_swapchain_images(std::uint32_t image_count);
+        void create_offscreen_images(Device& device, std::uint32_t image_count);
+        void create_image_views();
         void create_swapchain_depths(Device& device, CommandBuffer& cmd_list);
 
         bool choose_format(const VkSurfaceFormatKHR& preferred_format);
@@ -94,6 +114,9 @@ namespace vkpp {
         std::vector<ImageView>  image_views;
         std::vector<ImageView>  general_image_views;
 
+        std::vector<DeviceMemory> image_memories; // only for the off-screen images.
+        std::uint32_t next_image { 0 };
+
         Image depth_buffer_image;
         DeviceMemory depth_buffer_memory;
         ImageView depth_buffer_view;
@@ -108,6 +131,10 @@ namespace vkpp {
 
         VkDevice device       { VK_NULL_HANDLE };
         VkSwapchainKHR handle { VK_NULL_HANDLE };
+
+#ifdef VK_GOOGLE_display_timing
+        static PFN_vkGetPastPresentationTimingGOOGLE vkGetPastPresentationTimingGOOGLE;
+#endif
     };
 }
 
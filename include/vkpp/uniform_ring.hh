@@ -0,0 +1,74 @@
+#ifndef VKPP_UNIFORM_RING_HH
+#define VKPP_UNIFORM_RING_HH
+
+#include <vkpp/buffer.hh>
+#include <vkpp/device_memory.hh>
+
+#include <vulkan/vulkan.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace vkpp {
+    class Device;
+
+    // Persistently mapped and host coherent memory that uniform ranges are
+    // bump-allocated from, e.g. one ring per frame in flight with all that
+    // frame's constants. Updating a range is then just a memcpy, without a
+    // map and unmap (or a separate buffer) for each one of them. Until the
+    // ring is reset the ranges stay where they are, so the descriptors for
+    // them only have to be written once, and not on every single update.
+    class UniformRing final {
+    public:
+        UniformRing() = default;
+
+        UniformRing(Device& device, VkDeviceSize size_in_bytes = DefaultSize);
+
+        UniformRing(UniformRing&& uniform_ring) noexcept;
+        UniformRing& operator=(UniformRing&& uniform_ring) noexcept;
+
+        friend void swap(UniformRing& lhs, UniformRing& rhs);
+
+        struct Range {
+            VkDeviceSize offset { 0 };
+            VkDeviceSize size   { 0 };
+        };
+
+        // Aligned to minUniformBufferOffsetAlignment, throws if it's full.
+        Range allocate(VkDeviceSize size_in_bytes);
+
+        void reset(); // the old ranges can be reused after this.
+
+        template<typename T> void update(const Range& range, const T& data);
+        template<typename T> void update(const Range& range, const std::vector<T>& data);
+
+        Buffer& get_buffer();
+
+        VkDeviceSize get_size() const;
+        VkDeviceSize get_used_bytes() const;
+
+        static constexpr VkDeviceSize DefaultSize { 64 * 1024 };
+
+    private:
+        Buffer buffer;
+        DeviceMemory memory;
+        char* mapped { nullptr };
+
+        VkDeviceSize offset { 0 };
+        VkDeviceSize alignment { 1 };
+    };
+
+    template<typename T>
+    void UniformRing::update(const Range& range, const T& data) {
+        std::memcpy(mapped + range.offset, &data, std::min<VkDeviceSize>(sizeof(T), range.size));
+    }
+
+    template<typename T>
+    void UniformRing::update(const Range& range, const std::vector<T>& data) {
+        std::memcpy(mapped + range.offset, data.data(), std::min<VkDeviceSize>(sizeof(T) * data.size(), range.size));
+    }
+}
+
+#endif
@@ -1,12 +1,14 @@
 #ifndef VKPP_VKPP_HH
 #define VKPP_VKPP_HH
 
+#include <vkpp/acceleration_structure.hh>
 #include <vkpp/append.hh>
 #include <vkpp/application.hh>
 #include <vkpp/buffer.hh>
 #include <vkpp/command_buffer.hh>
 #include <vkpp/debug_marker.hh>
 #include <vkpp/debug_messenger.hh>
+#include <vkpp/descriptor_cache.hh>
 #include <vkpp/descriptor_set.hh>
 #include <vkpp/device.hh>
 #include <vkpp/device_memory.hh>
@@ -17,16 +19,20 @@
 #include <vkpp/image.hh>
 #include <vkpp/instance.hh>
 #include <vkpp/layer.hh>
+#include <vkpp/memory_allocator.hh>
 #include <vkpp/physical_device.hh>
 #include <vkpp/pipeline.hh>
+#include <vkpp/pipeline_cache.hh>
 #include <vkpp/query.hh>
 #include <vkpp/queue.hh>
 #include <vkpp/render_pass.hh>
 #include <vkpp/sampler.hh>
 #include <vkpp/semaphore.hh>
 #include <vkpp/shader_module.hh>
+#include <vkpp/staging_ring.hh>
 #include <vkpp/surface.hh>
 #include <vkpp/swap_chain.hh>
+#include <vkpp/uniform_ring.hh>
 #include <vkpp/version.hh>
 
 #endif
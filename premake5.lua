@@ -42,15 +42,12 @@ EMBREE = "foreign/embree"
 -- With MinGW x64, always static link with the default C++ stdlib.
 STATIC_LINK = "-static -static-libstdc++ -static-libgcc -lpthread"
 
-project (name)
-    targetdir "bin"
-    kind "WindowedApp"
-
+-- Shared between the renderer and the micro-benchmarks, which only differ by main.
+function vkhr_sources()
     includedirs "include"
     files { "include/**.hh" }
     files { "src/"..name.."/**.cc" }
     files { "src/vkpp/**.cc" }
-    files   "src/main.cc"
 
     os.vpaths() -- Virtual paths.
 
@@ -81,9 +78,9 @@ project (name)
         includedirs { EMBREE.."/include" }
         includedirs { GLFW.."/include" }
 
-        buildoptions { "-fopenmp" }
+        buildoptions { "-pthread" }
 
-        linkoptions { STATIC_LINK, "-fopenmp", "-mwindows", "-lstdc++fs" }
+        linkoptions { STATIC_LINK, "-pthread", "-mwindows", "-lstdc++fs" }
 
         links { SDK.."/lib/vulkan-1" }
         links { GLFW.."/lib/glfw3dll" }
@@ -95,8 +92,6 @@ project (name)
 
         entrypoint "mainCRTStartup"
 
-        buildoptions { "/openmp" }
-
         files { GLFW.."/include/GLFW/*.h" }
         files { EMBREE.."/include/embree3/*.h" }
 
@@ -105,5 +100,22 @@ project (name)
         links { EMBREE.."/lib/embree3.lib" }
     filter "system:linux or bsd or solaris"
         links { "embree3", "glfw", "vulkan" }
-        linkoptions  { "-fopenmp", "-lstdc++fs" }
-        buildoptions { "-fopenmp" }
+        linkoptions  { "-pthread", "-lstdc++fs" }
+        buildoptions { "-pthread" }
+    filter {}
+end
+
+project (name)
+    targetdir "bin"
+    kind "WindowedApp"
+
+    files "src/main.cc"
+    vkhr_sources()
+
+-- CPU micro-benchmarks of the hair processing, e.g. bin/vkhr-benchmarks voxelize.
+project (name.."-benchmarks")
+    targetdir "bin"
+    kind "ConsoleApp"
+
+    files { "src/benchmarks/**.cc" }
+    vkhr_sources()
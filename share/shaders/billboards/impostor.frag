@@ -0,0 +1,64 @@
+#version 460 core
+
+#include "../scene_graph/camera.glsl"
+#include "../scene_graph/params.glsl"
+#include "../scene_graph/lights.glsl"
+
+#include "../shading/kajiya-kay.glsl"
+
+#include "../strands/strand.glsl"
+
+#include "impostor.glsl"
+
+layout(location = 0) in PipelineIn {
+    vec4 position;
+    vec2 texcoord;
+    flat vec2 view_origin;
+    flat vec3 depth_axis;
+    flat mat3 tangent_frame;
+} fs_in;
+
+layout(binding = 57) uniform sampler2D impostor_occlusion;
+layout(binding = 58) uniform sampler2D impostor_tangents;
+
+layout(location = 0) out vec4 color;
+
+// Shaded like the raymarched strands, but without any shadows, since they're too far away to see them.
+void main() {
+    // So the views next to it don't bleed into its edges.
+    vec2 half_texel = 0.5f / vec2(textureSize(impostor_occlusion, 0));
+    vec2 texcoord = clamp(fs_in.texcoord, fs_in.view_origin + half_texel,
+                          fs_in.view_origin + 1.0f / float(impostor_views) - half_texel);
+
+    vec4 occlusion = texture(impostor_occlusion, texcoord);
+    if (occlusion.a < 1.0f / 255.0f)
+        discard; // no strands.
+
+    vec4 tangent_depth = texture(impostor_tangents, texcoord);
+
+    vec3 position = fs_in.position.xyz + fs_in.depth_axis * tangent_depth.a;
+    vec3 tangent  = normalize(fs_in.tangent_frame * (tangent_depth.xyz * 2.0f - 1.0f));
+
+    vec3 eye_normal = normalize(position - camera.position);
+
+    vec3 shading = vec3(0.0);
+
+    for (uint i = 0; i < lights_size; ++i) {
+        vec3 light_direction = normalize(lights[i].origin - position);
+        vec3 light_bulb_color = lights[i].intensity * light_attenuation(lights[i], position);
+
+        vec3 light_shading = vec3(1.0);
+
+        if (shading_model == KAJIYA_KAY) {
+            light_shading = kajiya_kay(hair_color, light_bulb_color, hair_exponent,
+                                       tangent, light_direction, eye_normal);
+        }
+
+        shading += light_shading;
+    }
+
+    vec4 clip_position = camera.projection * camera.view * vec4(position, 1.0f);
+    gl_FragDepth = clip_position.z / clip_position.w;
+
+    color = vec4(shading * occlusion.rgb, occlusion.a);
+}
@@ -0,0 +1,35 @@
+#ifndef VKHR_IMPOSTOR_GLSL
+#define VKHR_IMPOSTOR_GLSL
+
+// The octahedral impostor of the style (see HairStyle::Impostor), with impostor_views x impostor_views
+// views of its bounding sphere in the atlases. The billboard is the image plane of the view that's the
+// closest to the direction of the eye, so it's only ever turned towards the eye by one of the views.
+
+layout(constant_id = 1) const uint impostor_views = 8;
+
+// Same as HairStyle::Impostor::get_view_direction.
+vec3 impostor_view_direction(uvec2 view) {
+    vec2 octahedron = (vec2(view) + 0.5f) / float(impostor_views) * 2.0f - 1.0f;
+    vec3 direction = vec3(octahedron, 1.0f - abs(octahedron.x) - abs(octahedron.y));
+    if (direction.z < 0.0f) direction.xy = (1.0f - abs(direction.yx)) * vec2(direction.x >= 0.0f ? 1.0f : -1.0f,
+                                                                              direction.y >= 0.0f ? 1.0f : -1.0f);
+    return normalize(direction);
+}
+
+// Same as HairStyle::Impostor::get_view_axes.
+void impostor_view_axes(vec3 direction, out vec3 right, out vec3 up) {
+    vec3 upward = abs(direction.y) > 0.999f ? vec3(0.0f, 0.0f, 1.0f) : vec3(0.0f, 1.0f, 0.0f);
+    right = normalize(cross(upward, direction));
+    up    = cross(direction, right);
+}
+
+// The view whose direction is the closest to it.
+uvec2 impostor_view(vec3 direction) {
+    direction /= abs(direction.x) + abs(direction.y) + abs(direction.z);
+    vec2 octahedron = direction.xy;
+    if (direction.z < 0.0f) octahedron = (1.0f - abs(direction.yx)) * vec2(direction.x >= 0.0f ? 1.0f : -1.0f,
+                                                                           direction.y >= 0.0f ? 1.0f : -1.0f);
+    return min(uvec2((octahedron * 0.5f + 0.5f) * float(impostor_views)), uvec2(impostor_views - 1));
+}
+
+#endif
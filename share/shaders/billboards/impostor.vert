@@ -0,0 +1,45 @@
+#version 460 core
+
+#include "../scene_graph/camera.glsl"
+
+#include "../strands/strand.glsl"
+#include "../strands/instances.glsl"
+
+#include "billboard.glsl"
+#include "impostor.glsl"
+
+layout(location = 0) out PipelineOut {
+    vec4 position; // on the billboard.
+    vec2 texcoord;
+    flat vec2 view_origin; // in the atlases.
+    flat vec3 depth_axis; // through the sphere.
+    flat mat3 tangent_frame;
+} vs_out;
+
+void main() {
+    mat4 projection_view = camera.projection * camera.view;
+
+    mat4 model = instance_model(gl_InstanceIndex);
+
+    vec3  center = volume_bounds.origin + volume_bounds.size / 2.0f;
+    float radius = length(volume_bounds.size) / 2.0f;
+
+    vec3 eye = (inverse(model) * vec4(camera.position, 1.0f)).xyz;
+
+    uvec2 view = impostor_view(normalize(eye - center));
+    vec3 direction = impostor_view_direction(view);
+
+    vec3 right, up;
+    impostor_view_axes(direction, right, up);
+
+    vec2 corner = positions[gl_VertexIndex];
+    vec3 position = center + (direction + corner.x * right + corner.y * up) * radius;
+
+    vs_out.position = model * vec4(position, 1.0f);
+    vs_out.view_origin = vec2(view) / float(impostor_views);
+    vs_out.texcoord = vs_out.view_origin + texcoords[gl_VertexIndex] / float(impostor_views);
+    vs_out.depth_axis = (model * vec4(-direction * 2.0f * radius, 0.0f)).xyz;
+    vs_out.tangent_frame = mat3(model);
+
+    gl_Position = projection_view * vs_out.position;
+}
@@ -0,0 +1,21 @@
+#version 460 core
+
+layout(location = 0) in PipelineIn {
+    vec2 texcoord;
+} fs_in;
+
+// The color pass' models at the full resolution, see vulkan::HairTarget.
+layout(binding = 9) uniform sampler2D depth_buffer;
+layout(binding = 10, rgba8) uniform readonly image2D color;
+
+layout(location = 0) out vec4 hair_color;
+
+// Point samples the models into the hair target, so that the hair is blended
+// on top of them and tested against their depth like in the color pass. They
+// are without any alpha, which is how upscale.comp knows where the hair isn't.
+
+void main() {
+    ivec2 pixel = ivec2(fs_in.texcoord * vec2(textureSize(depth_buffer, 0)));
+    hair_color = vec4(imageLoad(color, pixel).rgb, 0.0f);
+    gl_FragDepth = texelFetch(depth_buffer, pixel, 0).r;
+}
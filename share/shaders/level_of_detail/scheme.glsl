@@ -10,4 +10,33 @@ float lod(float magnified_distance, float minified_distance, float current_dista
     else return smoothstep(magnified_distance, minified_distance, current_distance);
 }
 
+// Same as above, but with the blend of a single node, see Rasterizer::update.
+float lod(float node_level_of_detail) {
+    if      (renderer == 0) return 0.0f;
+    else if (renderer == 2) return 1.0f;
+    else return node_level_of_detail;
+}
+
+// With lod_dithering, each pixel of a node in between the LoD distances is either only rasterized
+// or only raymarched (with the whole coverage), instead of both of them being blended, so that such
+// a node costs about as much as one of them. Which one is the node's blend dithered with a 4x4 Bayer
+// matrix, that's fine enough to be hidden in the hair. Not with the scaled raymarch, since it's later
+// upsampled, and its pixels aren't the same as the rasterizer's.
+bool lod_dithered() {
+    return renderer == 1 && lod_dithering == YES && scaled_raymarch == NO;
+}
+
+const float lod_bayer_matrix[16] = {
+     0.5f / 16.0f,  8.5f / 16.0f,  2.5f / 16.0f, 10.5f / 16.0f,
+    12.5f / 16.0f,  4.5f / 16.0f, 14.5f / 16.0f,  6.5f / 16.0f,
+     3.5f / 16.0f, 11.5f / 16.0f,  1.5f / 16.0f,  9.5f / 16.0f,
+    15.5f / 16.0f,  7.5f / 16.0f, 13.5f / 16.0f,  5.5f / 16.0f
+};
+
+// Same as above, but either 0 or 1 in the pixel if it's dithered.
+float lod(float node_level_of_detail, ivec2 pixel) {
+    if (!lod_dithered()) return lod(node_level_of_detail);
+    return node_level_of_detail > lod_bayer_matrix[(pixel.y & 3) * 4 + (pixel.x & 3)] ? 1.0f : 0.0f;
+}
+
 #endif
@@ -8,6 +8,35 @@ layout(binding = 0) uniform Camera {
     float look_at_distance;
     float near, far;
     vec2 resolution;
+    mat4 previous_view_projection;
+    uint frame_number;
+    uint view_count;
+    vec2 hair_resolution; // of the hair passes, see vulkan::HairTarget.
+    mat4 eye_views[2];
+    vec4 eye_positions[2];
 } camera;
 
+// With stereo, the color pass is drawn for both of the eyes with multiview, so
+// the shaders in it are compiled with STEREO (and GL_EXT_multiview) to see the
+// eye in gl_ViewIndex, and otherwise both of the eyes are just the camera. The
+// eyes are side by side in the swapchain image, and so are their PPLL heads.
+#ifdef STEREO
+#define CAMERA_EYE gl_ViewIndex
+#else
+#define CAMERA_EYE 0
+#endif
+
+mat4 eye_view_projection() {
+    return camera.projection * camera.eye_views[CAMERA_EYE];
+}
+
+vec3 eye_position() {
+    return camera.eye_positions[CAMERA_EYE].xyz;
+}
+
+// Where the pixel of the eye is in the swapchain image.
+ivec2 eye_pixel(ivec2 pixel) {
+    return pixel + ivec2(CAMERA_EYE * int(camera.resolution.x), 0);
+}
+
 #endif
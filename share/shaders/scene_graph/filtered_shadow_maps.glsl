@@ -0,0 +1,9 @@
+#ifndef VKHR_FILTERED_SHADOW_MAPS_GLSL
+#define VKHR_FILTERED_SHADOW_MAPS_GLSL
+
+#include "lights.glsl"
+
+// The shadow maps after filter_deep_shadows.comp, see prefiltered_deep_shadows.glsl.
+layout(binding = 40) uniform sampler2D filtered_shadow_maps[lights_size];
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef VKHR_LIGHT_TILES_GLSL
+#define VKHR_LIGHT_TILES_GLSL
+
+#include "camera.glsl"
+#include "lights.glsl"
+
+// Pixels per side of a tile, and a mask of the lights that reach
+// somewhere inside of it (bit i for lights[i]), which is written by
+// cull_lights.comp, so the shading only loops over those lights. It
+// fits all of them, since there are never more than 32 of them. The
+// tiles of each of the views (for stereo) are after one another here.
+#define LIGHT_TILE_SIZE 16
+
+layout(std430, binding = 56) buffer LightTiles {
+    uint light_tiles[];
+};
+
+uvec2 light_tile_grid() {
+    return (uvec2(camera.resolution) + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE;
+}
+
+uint light_tile_index(uvec2 tile, uint view) {
+    uvec2 grid = light_tile_grid();
+    return tile.x + (tile.y + view * grid.y) * grid.x;
+}
+
+// Of the pixel in the eye's view (see camera.glsl), in the hair's resolution, since
+// only the hair is shaded with the tiles, and they're culled at the camera's.
+uint light_tile_mask(ivec2 pixel) {
+    pixel = ivec2(vec2(pixel) * camera.resolution / camera.hair_resolution);
+    uvec2 tile = min(uvec2(max(pixel, ivec2(0))) / LIGHT_TILE_SIZE, light_tile_grid() - 1);
+    return light_tiles[light_tile_index(tile, CAMERA_EYE)];
+}
+
+// The loops over lights_size are with a constant index, since it's not dynamically uniform
+// between the tiles, so the shadow maps (of the lights) can be indexed without nonuniformEXT.
+bool light_in_tile(uint light_mask, uint light) {
+    return (light_mask & (1u << light)) != 0u;
+}
+
+#endif
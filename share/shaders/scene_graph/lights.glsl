@@ -10,12 +10,30 @@ struct Light {
     vec3 origin;
     float near;
     float far;
+    float range; // or 0 if it's unbounded.
+    // Of the shadow map that's drawn and sampled, which 'matrix' already maps to. The filters are in
+    // texels of the whole map, so they're scaled with it to cover as much of the hair as they did.
+    float shadow_map_scale;
 };
 
-layout(constant_id = 0) const uint lights_size = 1;
+// Unless it's already taken, e.g. by the vertex_format in strand_multiview_depth.vert.
+#ifndef LIGHTS_SIZE_CONSTANT_ID
+#define LIGHTS_SIZE_CONSTANT_ID 0
+#endif
+
+layout(constant_id = LIGHTS_SIZE_CONSTANT_ID) const uint lights_size = 1;
 
 layout(binding = 1) uniform Lights {
     Light lights[lights_size];
 };
 
+// Same windowed falloff as LightSource::get_attenuation, and 1 for directional lights.
+float light_attenuation(Light light, vec3 position) {
+    if (light.type == 0.0f || light.range <= 0.0f)
+        return 1.0f;
+    float d = distance(light.origin, position) / light.range;
+    float window = clamp(1.0f - d*d*d*d, 0.0f, 1.0f);
+    return window * window;
+}
+
 #endif
@@ -0,0 +1,9 @@
+#ifndef VKHR_OPACITY_MAPS_GLSL
+#define VKHR_OPACITY_MAPS_GLSL
+
+#include "lights.glsl"
+
+// The layers of every light's deep opacity map, see deep_opacity_maps.glsl.
+layout(binding = 32) uniform sampler2D opacity_maps[lights_size];
+
+#endif
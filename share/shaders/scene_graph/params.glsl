@@ -5,19 +5,19 @@
 #define NO   0
 
 layout(binding = 4) uniform Params {
-    int shading_model;
+    int uniform_shading_model;
 
-    int deep_shadows_kernel_size;
-    int deep_shadows_sampling_type;
-    int deep_shadows_stride_size;
-    int deep_shadows_on;
+    int uniform_deep_shadows_kernel_size;
+    int uniform_deep_shadows_sampling_type;
+    int uniform_deep_shadows_stride_size;
+    int uniform_deep_shadows_on;
 
-    int pcf_shadows_kernel_size;
-    int pcf_shadows_sampling_type;
+    int uniform_pcf_shadows_kernel_size;
+    int uniform_pcf_shadows_sampling_type;
     float pcf_shadows_bias;
-    int pcf_shadows_on;
+    int uniform_pcf_shadows_on;
 
-    int shadow_technique;
+    int uniform_shadow_technique;
 
     float isosurface;
     float raycast_steps;
@@ -30,6 +30,111 @@ layout(binding = 4) uniform Params {
     float minified_distance;
 
     int benchmarking;
+
+    int scaled_raymarch;
+    int temporal_accumulation;
+
+    int strand_culling;
+    int strand_expansion;
+    int software_rasterizer;
+
+    int strand_reduction;
+    float strands_per_pixel;
+
+    int adaptive_ppll;
+    int ppll_tile_budget;
+
+    int transparency;
+
+    int parallel_recording;
+
+    int raymarch_mips;
+
+    int uniform_deep_shadows_prefiltered;
+
+    int pipeline_statistics;
+
+    int deferred_shading;
+
+    int ao_volume;
+
+    int line_strips;
+
+    int packed_ppll;
+
+    int lod_dithering;
+
+    int specialized_shaders;
+
+    int multiview_shadows;
+
+    int light_culling;
+
+    int impostors;
+    float impostor_distance;
+
+    int gpu_raytracing;
+
+    int marschner_shading;
+    float marschner_shift;
+    float marschner_width;
+    float marschner_azimuthal_width;
+    float marschner_eta;
+
+    int temporal_anti_aliasing;
+
+    float render_scale;
+
+    int variable_rate_shading;
+
+    int batched_depth;
+
+    int opaque_depth;
+
+    int strand_merging;
+
+    int on_demand;
+
+    int sphere_tracing;
+
+    int adaptive_steps;
+
+    int cost_view;
+    float cost_view_range;
+
+    int low_latency;
+
+    int adaptive_shadows;
+
+    int linear_shadow_maps;
 };
 
+// With specialized_params (see Rasterizer::ShaderParameters), these are baked into the pipelines
+// instead, so the compiler can drop the branches that aren't taken and unroll the filter kernels.
+// Otherwise they're read from the uniforms above, so that they can still be tweaked while running.
+#define PARAMS_CONSTANT_ID 16
+
+layout(constant_id = PARAMS_CONSTANT_ID +  0) const bool specialized_params = false;
+layout(constant_id = PARAMS_CONSTANT_ID +  1) const int specialized_shading_model = 0;
+layout(constant_id = PARAMS_CONSTANT_ID +  2) const int specialized_deep_shadows_kernel_size = 0;
+layout(constant_id = PARAMS_CONSTANT_ID +  3) const int specialized_deep_shadows_sampling_type = 0;
+layout(constant_id = PARAMS_CONSTANT_ID +  4) const int specialized_deep_shadows_stride_size = 1;
+layout(constant_id = PARAMS_CONSTANT_ID +  5) const int specialized_deep_shadows_on = 0;
+layout(constant_id = PARAMS_CONSTANT_ID +  6) const int specialized_deep_shadows_prefiltered = 0;
+layout(constant_id = PARAMS_CONSTANT_ID +  7) const int specialized_pcf_shadows_kernel_size = 0;
+layout(constant_id = PARAMS_CONSTANT_ID +  8) const int specialized_pcf_shadows_sampling_type = 0;
+layout(constant_id = PARAMS_CONSTANT_ID +  9) const int specialized_pcf_shadows_on = 0;
+layout(constant_id = PARAMS_CONSTANT_ID + 10) const int specialized_shadow_technique = 0;
+
+#define shading_model              (specialized_params ? specialized_shading_model              : uniform_shading_model)
+#define deep_shadows_kernel_size   (specialized_params ? specialized_deep_shadows_kernel_size   : uniform_deep_shadows_kernel_size)
+#define deep_shadows_sampling_type (specialized_params ? specialized_deep_shadows_sampling_type : uniform_deep_shadows_sampling_type)
+#define deep_shadows_stride_size   (specialized_params ? specialized_deep_shadows_stride_size   : uniform_deep_shadows_stride_size)
+#define deep_shadows_on            (specialized_params ? specialized_deep_shadows_on            : uniform_deep_shadows_on)
+#define deep_shadows_prefiltered   (specialized_params ? specialized_deep_shadows_prefiltered   : uniform_deep_shadows_prefiltered)
+#define pcf_shadows_kernel_size    (specialized_params ? specialized_pcf_shadows_kernel_size    : uniform_pcf_shadows_kernel_size)
+#define pcf_shadows_sampling_type  (specialized_params ? specialized_pcf_shadows_sampling_type  : uniform_pcf_shadows_sampling_type)
+#define pcf_shadows_on             (specialized_params ? specialized_pcf_shadows_on             : uniform_pcf_shadows_on)
+#define shadow_technique           (specialized_params ? specialized_shadow_technique           : uniform_shadow_technique)
+
 #endif
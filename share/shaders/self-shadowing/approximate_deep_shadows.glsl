@@ -5,6 +5,7 @@
 
 #include "../utils/math.glsl"
 #include "../volumes/sample_volume.glsl"
+#include "../volumes/occupancy.glsl"
 #include "linearize_depth.glsl"
 #include "tex2Dproj.glsl"
 
@@ -27,9 +28,45 @@ float volume_approximated_deep_shadows(sampler3D volume, vec3 strand_position, v
     float step_size = 1.0f / steps; // for raymarch.
     for (float t = 0.0f; t < 1.0f; t += step_size) {
         vec3 point = mix(strand_position, light_position, t);
-        strands += sample_volume(volume, point,
-                                 volume_origin,
-                                 volume_size).r * thickness;
+        strands += sample_bricked_volume(volume, point,
+                                         volume_origin,
+                                         volume_size).r * thickness;
+    }
+
+    return pow(1.0f - strand_alpha, strands);
+}
+
+// Same as above, but skips the empty bricks of 'occupancy' on the way to the light.
+float volume_approximated_deep_shadows(sampler3D volume, usampler3D occupancy, vec3 strand_position, vec3 light_position, float steps,
+                                       float strand_alpha, vec3 volume_origin, vec3 volume_size, float thickness) {
+    float strands = 0;
+    float step_size = 1.0f / steps; // for raymarch.
+    for (float t = 0.0f; t < 1.0f; t += step_size) {
+        if (skip_empty_brick(occupancy, strand_position, light_position, t, step_size, volume_origin, volume_size))
+            continue;
+        vec3 point = mix(strand_position, light_position, t);
+        strands += sample_bricked_volume(volume, point,
+                                         volume_origin,
+                                         volume_size).r * thickness;
+    }
+
+    return pow(1.0f - strand_alpha, strands);
+}
+
+// Same as above, but from the 'volume_level' of the volume and its mip chain, see sample_volume_level.
+float volume_approximated_deep_shadows(sampler3D volume, sampler3D volume_mips, float volume_level, usampler3D occupancy,
+                                       vec3 strand_position, vec3 light_position, float steps,
+                                       float strand_alpha, vec3 volume_origin, vec3 volume_size, float thickness) {
+    float strands = 0;
+    float step_size = 1.0f / steps; // for raymarch.
+    bool skip_bricks = volume_level_skips_bricks(volume_level);
+    for (float t = 0.0f; t < 1.0f; t += step_size) {
+        if (skip_bricks && skip_empty_brick(occupancy, strand_position, light_position, t, step_size, volume_origin, volume_size))
+            continue;
+        vec3 point = mix(strand_position, light_position, t);
+        strands += sample_volume_level(volume, volume_mips, volume_level, point,
+                                       volume_origin,
+                                       volume_size).r * thickness;
     }
 
     return pow(1.0f - strand_alpha, strands);
@@ -72,4 +109,75 @@ float approximate_deep_shadows(sampler2D shadow_map, // the non-linearized shado
     return visibility / total_weight;
 }
 
+// Same as above, but from the linear depths of linear_shadow_map (see filter_deep_shadows.comp), so
+// the strand's depth is only linearized once, and the taps are 2x2 gathers of the texels around it,
+// weighted by their distance to it, for the (r+1)² gathers of a (2r+1)² kernel instead of its taps.
+// The jitter spreads the taps further than one texel, so with it they are sampled one at a time.
+// 'strand_radius' is per unit of the non-linear depths, it's scaled to the linear depth at the strand.
+float linear_approximate_deep_shadows(sampler2D linear_shadow_map, // of filter_deep_shadows.comp's linearized pass.
+                                      vec4 light_space_strand, // fragment in the shadow maps light coordinate system.
+                                      float near, float far, // of the light's projection, in lights.glsl.
+                                      float kernel_width, // size of the PCF kernel, common values are 3x3 or 5x5 too.
+                                      float smoothing, // this jitter/stride parameter which creates smoother shadows.
+                                      float strand_radius, // the radius of the hair strands to calculate the density.
+                                      float strand_opacity) { // inv. proportional to amount of light passing through.
+    vec3 projected_strand = light_space_strand.xyz / light_space_strand.w;
+
+    float view_depth = light_view_depth(projected_strand.z, near, far);
+    float light_depth = linear_light_depth(projected_strand.z, near, far);
+    float strand_density = strand_radius * near * far / (view_depth * view_depth);
+    float strand_transmittance = log2(1.0f - strand_opacity);
+
+    vec2 shadow_map_size = textureSize(linear_shadow_map, 0);
+
+    float kernel_range = floor((kernel_width - 1.0f) / 2.0f);
+    float sigma_stddev = max((kernel_width / 2.0f) / 2.4f * smoothing, 0.5f);
+    float sigma_squared = sigma_stddev * sigma_stddev;
+
+    float visibility = 0.0f;
+    float total_weight = 0.0f;
+
+    if (smoothing <= 1.0f) {
+        vec2 strand_texel = projected_strand.xy * shadow_map_size - 0.5f;
+        vec2 first_texel = floor(strand_texel) - kernel_range;
+
+        for (float y = 0.0f; y <= kernel_range; y += 1.0f)
+        for (float x = 0.0f; x <= kernel_range; x += 1.0f) {
+            vec2 texel = first_texel + 2.0f * vec2(x, y); // the top-left texel of the gather.
+            vec4 shadow_depths = textureGather(linear_shadow_map, (texel + 1.0f) / shadow_map_size, 0);
+
+            // In the order that textureGather returns them.
+            vec2 offsets[4] = { vec2(0.0f, 1.0f), vec2(1.0f, 1.0f), vec2(1.0f, 0.0f), vec2(0.0f, 0.0f) };
+
+            for (int i = 0; i < 4; ++i) {
+                vec2 distance = texel + offsets[i] - strand_texel;
+                float weight = exp(-dot(distance, distance) / (2.0f * sigma_squared));
+
+                float strand_depth = max(light_depth - shadow_depths[i], 0.0f);
+                float strand_count = strand_depth * strand_density;
+                if (strand_depth > 1e-5) strand_count += 1;
+
+                visibility   += exp2(strand_transmittance * strand_count) * weight;
+                total_weight += weight;
+            }
+        }
+    } else {
+        for (float y = -kernel_range; y <= +kernel_range; y += 1.0f)
+        for (float x = -kernel_range; x <= +kernel_range; x += 1.0f) {
+            vec2 offset = vec2(x, y) * smoothing;
+            float weight = exp(-dot(offset, offset) / (2.0f * sigma_squared));
+
+            float shadow_depth = texture(linear_shadow_map, projected_strand.xy + offset / shadow_map_size).r;
+            float strand_depth = max(light_depth - shadow_depth, 0.0f);
+            float strand_count = strand_depth * strand_density;
+            if (strand_depth > 1e-5) strand_count += 1;
+
+            visibility   += exp2(strand_transmittance * strand_count) * weight;
+            total_weight += weight;
+        }
+    }
+
+    return visibility / total_weight;
+}
+
 #endif
@@ -0,0 +1,19 @@
+#version 460 core
+
+#include "../scene_graph/shadow_maps.glsl"
+
+#include "deep_opacity_maps.glsl"
+
+// After the transforms in instances.glsl, since it's the same for all of the styles.
+layout(push_constant) uniform Opacity {
+    layout(offset = 68) uint light;
+} opacity;
+
+layout(location = 0) out vec4 layers;
+
+// Every strand is added to the layer it's in (and the ones after), which are
+// found from the depth map of the same light, i.e. from the nearest strand.
+void main() {
+    float shadow_depth = texelFetch(shadow_maps[opacity.light], ivec2(gl_FragCoord.xy), 0).r;
+    layers = deep_opacity_layers(gl_FragCoord.z - shadow_depth);
+}
@@ -0,0 +1,78 @@
+#ifndef VKHR_DEEP_OPACITY_MAPS_GLSL
+#define VKHR_DEEP_OPACITY_MAPS_GLSL
+
+#define DEEP_OPACITY_MAPS 2
+
+#include "../utils/math.glsl"
+#include "tex2Dproj.glsl"
+
+// Depth of the first layer behind the strand nearest to the light, in the
+// same (non-linear) depth as the shadow maps, i.e. around eight strands if
+// we use the strand radius in approximate_deep_shadows. The layers double
+// in depth, since most of the light is gone after the first few of them.
+#define DEEP_OPACITY_LAYER_DEPTH (8.0f / 15000.0f)
+
+const vec4 deep_opacity_layer_ends = vec4(1.0f, 2.0f, 4.0f, 8.0f) * DEEP_OPACITY_LAYER_DEPTH;
+const vec4 deep_opacity_layer_starts = vec4(0.0f, deep_opacity_layer_ends.xyz);
+
+// The layers a strand at 'strand_depth' behind the shadow map's depth is in.
+// It's counted in its own and every layer after it, so that each one stores
+// all of the strands until its end, and a lookup doesn't have to add them.
+vec4 deep_opacity_layers(float strand_depth) {
+    return vec4(greaterThanEqual(deep_opacity_layer_ends, vec4(strand_depth)));
+}
+
+// Based on "Deep Opacity Maps" by Cem Yuksel and John Keyser in 2008. The
+// strands in front of a fragment are interpolated between the layers that
+// it lies in, and like approximate_deep_shadow, each of them absorbs some.
+float deep_opacity_shadow(vec4 layers, float shadow_depth, float light_depth, float strand_alpha) {
+    float strand_depth = max(light_depth - shadow_depth, 0.0f);
+
+    vec4 layer_strands = layers - vec4(0.0f, layers.xyz); // only from each one.
+    vec4 layer_covered = clamp((strand_depth - deep_opacity_layer_starts) /
+                               (deep_opacity_layer_ends - deep_opacity_layer_starts),
+                               0.0f, 1.0f);
+
+    float strand_count = dot(layer_strands, layer_covered);
+
+    return pow(1.0f - strand_alpha, strand_count);
+}
+
+// Same Gaussian PCF as approximate_deep_shadows, but with the strands found
+// in 'opacity_map' instead of guessing them from the depth and the radius.
+float deep_opacity_maps(sampler2D opacity_map, // the layers of the light in deep_opacity_map.frag.
+                        sampler2D shadow_map, // depth of the first strand the light sees, for layers.
+                        vec4 light_space_strand, // fragment in the shadow maps light coordinate system.
+                        float kernel_width, // size of the PCF kernel, common values are 3x3 or 5x5 too.
+                        float smoothing, // the jitter/stride parameter which creates smoother shadows.
+                        float strand_opacity) { // inv. proportional to the amount of light going through.
+    float visibility = 0.0f;
+
+    vec2 shadow_map_size = textureSize(shadow_map, 0);
+
+    float kernel_range = (kernel_width - 1.0f) / 2.0f;
+    float sigma_stddev = (kernel_width / 2.0f) / 2.4f;
+    float sigma_squared = sigma_stddev * sigma_stddev;
+
+    float light_depth = light_space_strand.z / light_space_strand.w;
+    vec2 shadow_map_stride = shadow_map_size / smoothing; // stride.
+
+    float total_weight = 0.0f;
+
+    for (float y = -kernel_range; y <= +kernel_range; y += 1.0f)
+    for (float x = -kernel_range; x <= +kernel_range; x += 1.0f) {
+        float exponent = -1.0f * (x*x + y*y) / (2.0f*sigma_squared); // Gaussian RBDF.
+        float local_weight = 1.0f / (2.0f*M_PI*sigma_squared) * pow(M_E, exponent);
+
+        vec2 displacement = vec2(x, y) / shadow_map_stride;
+        float shadow_depth = tex2Dproj(shadow_map, light_space_strand, displacement).r;
+        vec4 layers = tex2Dproj(opacity_map, light_space_strand, displacement);
+
+        visibility   += deep_opacity_shadow(layers, shadow_depth, light_depth, strand_opacity) * local_weight;
+        total_weight += local_weight;
+    }
+
+    return visibility / total_weight;
+}
+
+#endif
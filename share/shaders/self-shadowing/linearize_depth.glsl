@@ -6,4 +6,14 @@ float linearize_depth(float depth, float near, float far) {
     return (2.0f * near) / (far+near - depth * (far-near));
 }
 
+// The view-space depth of a light's [0, 1] depth, and the same from 0 at near to 1 at far, which
+// is what the linear shadow maps store (see filter_deep_shadows.comp) and the ones they're against.
+float light_view_depth(float depth, float near, float far) {
+    return near * far / (far - depth * (far - near));
+}
+
+float linear_light_depth(float depth, float near, float far) {
+    return (light_view_depth(depth, near, far) - near) / (far - near);
+}
+
 #endif
@@ -0,0 +1,16 @@
+#version 460 core
+
+#extension GL_EXT_multiview : require
+
+#include "../scene_graph/lights.glsl"
+
+layout(push_constant) uniform Object {
+    mat4 model;
+} object;
+
+layout(location = 0) in vec3 position;
+
+// Same as depth_map.vert, but the light's transform is picked by the view instead.
+void main() {
+    gl_Position = lights[gl_ViewIndex].matrix * object.model * vec4(position, 1.0f);
+}
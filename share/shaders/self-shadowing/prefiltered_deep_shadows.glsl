@@ -0,0 +1,27 @@
+#ifndef VKHR_PREFILTERED_DEEP_SHADOWS_GLSL
+#define VKHR_PREFILTERED_DEEP_SHADOWS_GLSL
+
+#include "tex2Dproj.glsl"
+
+// The ADSM is pow(1 - alpha, (d - z) * radius), i.e. exp(-c * d) * exp(c * z), so
+// the taps of its PCF can be summed as exp(c * z) in advance (like in an ESM) and
+// stored as log(sum) / c, which is still a depth, and can be linearly filtered. c
+// is exact for an alpha around a half with the radius of approximate_deep_shadows.
+#define ADSM_FILTER_EXPONENT 10000.0f
+
+// Same as approximate_deep_shadows, but with the PCF done in filter_deep_shadows.comp.
+float prefiltered_deep_shadows(sampler2D filtered_shadow_map, // the exponentially filtered depths of the light.
+                               vec4 light_space_strand, // fragment in the shadow maps light coordinate system.
+                               float strand_radius, // the radius of the hair strands to calculate the density.
+                               float strand_opacity) { // inv. proportional to amount of light passing through.
+    float light_depth  = light_space_strand.z / light_space_strand.w;
+    float shadow_depth = tex2Dproj(filtered_shadow_map, light_space_strand, vec2(0.0f)).r;
+
+    float strand_depth = max(light_depth - shadow_depth, 0.0f);
+    float strand_count = strand_depth * strand_radius;
+    if (strand_depth > 1e-5) strand_count += 1; // as in approximate_deep_shadow.
+
+    return pow(1.0f - strand_opacity, strand_count);
+}
+
+#endif
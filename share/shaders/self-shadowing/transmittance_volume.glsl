@@ -0,0 +1,16 @@
+#ifndef VKHR_TRANSMITTANCE_VOLUME_GLSL
+#define VKHR_TRANSMITTANCE_VOLUME_GLSL
+
+#define TRANSMITTANCE_VOLUME 3
+
+#include "../volumes/sample_volume.glsl"
+
+// Transmittance from lights[0] to every voxel of the style, from the volume's transmittance.comp.
+layout(binding = 19) uniform sampler3D strand_transmittance;
+
+// Same result as volume_approximated_deep_shadows (but filtered), with a single trilinear lookup.
+float transmittance_volume(vec3 strand_position, vec3 volume_origin, vec3 volume_size) {
+    return sample_volume(strand_transmittance, strand_position, volume_origin, volume_size).r;
+}
+
+#endif
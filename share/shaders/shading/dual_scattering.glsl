@@ -0,0 +1,97 @@
+#ifndef VKHR_DUAL_SCATTERING_GLSL
+#define VKHR_DUAL_SCATTERING_GLSL
+
+#include "../utils/math.glsl"
+#include "marschner.glsl"
+
+// The d_f and d_b of Zinke et al., for how much denser than a single strand the hair is around a fiber.
+#define DENSITY_FACTOR 0.7f
+
+// Every self-shadowing technique is pow(1 - alpha, strands) of the strands in front of the light (see
+// approximate_deep_shadow), or the same from the strand voxels, so the strand count can be recovered.
+float shadowing_strand_count(float visibility, float strand_alpha) {
+    return log(max(visibility, 1e-4f)) / log(1.0f - clamp(strand_alpha, 1e-3f, 0.999f));
+}
+
+vec3 longitudinal_gaussians(vec3 variance, vec3 x) {
+    return exp(-x*x / (2.0f * variance)) / sqrt(2.0f * M_PI * variance);
+}
+
+// Based on "Dual Scattering Approximation for Fast Multiple Scattering in Hair" by A. Zinke et al. 2008,
+// with the average forward and backward scattering from the Forward and Backward layers of the LUT. The
+// visibility is the self-shadowing of the light, which gives the strands scattering it on the way there,
+// and its fraction that arrives directly, lit with marschner and the local backscattering from around it.
+// The rest arrives after the global multiple scattering forward through them. Which with the three fetches
+// of marschner is five, and the shift and width are the R lobe's in radians, like in Fiber. It replaces a
+// marschner(...) * visibility, and the light and eye directions are the same as in marschner too.
+vec3 dual_scattering(vec3 color, vec3 intensity, vec3 tangent, vec3 light, vec3 eye,
+                     float visibility, float strand_alpha, float longitudinal_shift, float longitudinal_width) {
+    vec3 direct_scattering = marschner(color, vec3(1.0f), tangent, light, eye);
+
+    float sin_theta_i = clamp(dot(tangent, light), -1.0f, 1.0f);
+    float sin_theta_r = clamp(dot(tangent, -eye), -1.0f, 1.0f);
+    float theta_i = asin(sin_theta_i);
+    float theta_r = asin(sin_theta_r);
+    float theta_h = 0.5f * (theta_i + theta_r);
+    float cos_theta_d = cos(0.5f * (theta_r - theta_i));
+    float cos_theta_i = cos(theta_i);
+
+    vec4 forward  = texture(scattering_lut, vec3(0.5f, cos_theta_d, 3));
+    vec4 backward = texture(scattering_lut, vec3(0.5f, cos_theta_d, 4));
+
+    vec3 absorption = max(color, vec3(1e-3f));
+    vec3 tt_absorption  = pow(absorption, vec3(forward.w));
+    vec3 trt_absorption = pow(absorption, vec3(backward.w));
+
+    vec3 a_f = forward.r  + forward.g  * tt_absorption + forward.b  * trt_absorption;
+    vec3 a_b = backward.r + backward.g * tt_absorption + backward.b * trt_absorption;
+
+    // R, TT and TRT, as in scattering_lut.comp, and averaged by how much each of them scatters.
+    vec3 alphas = vec3(1.0f, -0.5f, -1.5f) * longitudinal_shift;
+    vec3 betas  = vec3(1.0f,  0.5f,  2.0f) * longitudinal_width;
+
+    float alpha_f = dot(forward.rgb,  alphas) / max(dot(forward.rgb,  vec3(1.0f)), 1e-4f);
+    float alpha_b = dot(backward.rgb, alphas) / max(dot(backward.rgb, vec3(1.0f)), 1e-4f);
+    float beta_f  = sqrt(dot(forward.rgb,  betas*betas) / max(dot(forward.rgb,  vec3(1.0f)), 1e-4f));
+    float beta_b  = sqrt(dot(backward.rgb, betas*betas) / max(dot(backward.rgb, vec3(1.0f)), 1e-4f));
+
+    float strands = shadowing_strand_count(visibility, strand_alpha);
+
+    // The global multiple scattering: attenuated and spread out by every strand forward scattering it.
+    vec3 transmittance = DENSITY_FACTOR * pow(a_f, vec3(strands));
+    float spread = beta_f*beta_f * strands;
+
+    // The local multiple scattering: the light that's scattered back from the strands around the fiber.
+    vec3 a_f2 = a_f * a_f;
+    vec3 a_b2 = a_b * a_b;
+    vec3 a_b3 = a_b2 * a_b;
+    vec3 through = max(1.0f - a_f2, vec3(1e-3f));
+
+    vec3 backscattering = a_b * a_f2 / through + a_b3 * a_f2 / (through * through * through);
+    vec3 backscattering_shift = alpha_b * (1.0f - 2.0f * a_b2 / (through * through)) +
+                                alpha_f * (2.0f * through * through + 4.0f * a_f2 * a_b2) / (through * through * through);
+    vec3 backscattering_width = (1.0f + DENSITY_FACTOR * a_f2) *
+                                (a_b * sqrt(2.0f * beta_f*beta_f + beta_b*beta_b) + a_b3 * sqrt(2.0f * beta_f*beta_f + 3.0f * beta_b*beta_b)) /
+                                max(a_b + a_b3 * (2.0f * beta_f + 3.0f * beta_b), vec3(1e-4f));
+    vec3 backscattering_variance = max(backscattering_width * backscattering_width, vec3(1e-4f));
+
+    float normalization = cos_theta_i / (M_PI * max(cos_theta_d*cos_theta_d, 1e-2f));
+
+    // Per color channel, since how much is scattered depends on the absorption.
+    vec3 direct_backscattering = 2.0f * backscattering * normalization *
+                                 longitudinal_gaussians(backscattering_variance, theta_h - backscattering_shift);
+    vec3 global_backscattering = 2.0f * backscattering * normalization *
+                                 longitudinal_gaussians(backscattering_variance + spread, theta_h - backscattering_shift);
+
+    // The single scattering of the light that has been spread out, with N averaged over the forward half.
+    // Per lobe here, and not per color channel.
+    vec3 m = longitudinal_gaussians(betas*betas + spread, theta_h - alphas);
+    vec3 global_scattering = (m.x * forward.r + m.y * forward.g * tt_absorption + m.z * forward.b * trt_absorption) * normalization;
+
+    vec3 direct = direct_scattering + DENSITY_FACTOR * direct_backscattering;
+    vec3 global = transmittance * DENSITY_FACTOR * (global_backscattering + global_scattering);
+
+    return intensity * (visibility * direct + (1.0f - visibility) * global);
+}
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef VKHR_MARSCHNER_GLSL
+#define VKHR_MARSCHNER_GLSL
+
+#include "../utils/math.glsl"
+
+// The terms baked by scattering_lut.comp, see vulkan::ScatteringLut.
+layout(binding = 65) uniform sampler2DArray scattering_lut;
+
+// Based on "Light Scattering from Human Hair Fibers" by S. Marschner et al., but with the
+// longitudinal and the azimuthal terms of R, TT and TRT looked up, so it's three fetches.
+// The color is the fiber's transmittance from a TRT head on. Like in kajiya_kay, the eye
+// direction is the one from the eye to the strand, and the light the one to the light.
+vec3 marschner(vec3 color, vec3 intensity, vec3 tangent, vec3 light, vec3 eye) {
+    float sin_theta_i = dot(tangent, light);
+    float sin_theta_r = dot(tangent, -eye);
+
+    vec3 light_perpendicular = light + tangent * -sin_theta_i;
+    vec3 eye_perpendicular  = -eye + tangent * -sin_theta_r;
+
+    float cos_phi = dot(light_perpendicular, eye_perpendicular) *
+                    inversesqrt(dot(light_perpendicular, light_perpendicular) *
+                                dot(eye_perpendicular, eye_perpendicular) + 1e-4f);
+
+    float phi = acos(clamp(cos_phi, -1.0f, 1.0f));
+
+    vec4 m = texture(scattering_lut, vec3(sin_theta_i * 0.5f + 0.5f, sin_theta_r * 0.5f + 0.5f, 0));
+    vec3 n = texture(scattering_lut, vec3(phi / M_PI, m.a, 1)).rgb;
+    vec2 paths = texture(scattering_lut, vec3(phi / M_PI, m.a, 2)).xy;
+
+    vec3 absorption = max(color, vec3(1e-3f));
+
+    vec3 scattering = m.r * n.r +
+                      m.g * n.g * pow(absorption, vec3(paths.x)) +
+                      m.b * n.b * pow(absorption, vec3(paths.y));
+
+    return intensity * scattering;
+}
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef VKHR_CLUSTER_GLSL
+#define VKHR_CLUSTER_GLSL
+
+// Segments per cluster, see HairStyle::ClusterSize.
+#define CLUSTER_SIZE 64
+
+// See vkhr::HairStyle::SegmentCluster.
+struct Cluster {
+    vec3 lower;
+    uint first_segment;
+    vec3 upper;
+    uint segment_count;
+};
+
+// Bits are set for each of the clip planes the point is outside of.
+uint outcode(vec4 point) {
+    uint code = 0;
+    if (point.x < -point.w) code |= 0x01;
+    if (point.x > +point.w) code |= 0x02;
+    if (point.y < -point.w) code |= 0x04;
+    if (point.y > +point.w) code |= 0x08;
+    if (point.z <  0.0f)    code |= 0x10;
+    if (point.z > +point.w) code |= 0x20;
+    return code;
+}
+
+vec3 cluster_corner(Cluster cluster, uint corner) {
+    return mix(cluster.lower, cluster.upper, vec3(corner & 1, (corner >> 1) & 1, (corner >> 2) & 1));
+}
+
+#endif
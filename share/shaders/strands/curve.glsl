@@ -0,0 +1,32 @@
+#ifndef VKHR_CURVE_GLSL
+#define VKHR_CURVE_GLSL
+
+// Most lines a segment is subdivided into, the hardware goes up to at least 64.
+#define CURVE_MAX_SUBDIVISIONS 16.0f
+
+// How far (in pixels) the lines may be from the curve, see curve_subdivisions.
+#define CURVE_TOLERANCE 0.5f
+
+// Uniform Catmull-Rom spline between p1 and p2, with t in [0, 1].
+vec3 catmull_rom(vec3 p0, vec3 p1, vec3 p2, vec3 p3, float t) {
+    return 0.5f * ((2.0f * p1) +
+                   (-p0 + p2) * t +
+                   (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t * t +
+                   (-p0 + 3.0f * p1 - 3.0f * p2 + p3) * t * t * t);
+}
+
+// And its derivative, which is the strand tangent.
+vec3 catmull_rom_tangent(vec3 p0, vec3 p1, vec3 p2, vec3 p3, float t) {
+    return 0.5f * ((-p0 + p2) +
+                   (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * 2.0f * t +
+                   (-p0 + 3.0f * p1 - 3.0f * p2 + p3) * 3.0f * t * t);
+}
+
+// An arc that turns by 'angle' over 'length' pixels is at most length * angle / 8n
+// pixels away from the n lines it's split into, so that is kept under the tolerance.
+// Straight, short or far away segments end up as just the one, like the other paths.
+float curve_subdivisions(float screen_length, float angle) {
+    return clamp(ceil(screen_length * angle / (8.0f * CURVE_TOLERANCE)), 1.0f, CURVE_MAX_SUBDIVISIONS);
+}
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef VKHR_INSTANCES_GLSL
+#define VKHR_INSTANCES_GLSL
+
+// Every node that shares a hair style is drawn in the same instanced draw, with the
+// model matrices of the nodes packed one after the other by Rasterizer::update, and
+// the style's first one in the push constant. The pushed matrix is applied on top of
+// them, it's the identity in the color pass and the light's transform in the depth.
+// Each instance has the level of detail of its node too, for blending with volumes.
+
+struct Instance {
+    mat4 model;
+    float level_of_detail;
+};
+
+layout(std430, binding = 28) readonly buffer Instances {
+    Instance instances[];
+};
+
+layout(push_constant) uniform Object {
+    mat4 model;
+    uint first_instance;
+} object;
+
+mat4 instance_model(uint instance) {
+    return object.model * instances[object.first_instance + instance].model;
+}
+
+float instance_level_of_detail(uint instance) {
+    return instances[object.first_instance + instance].level_of_detail;
+}
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef VKHR_MESH_TASKS_GLSL
+#define VKHR_MESH_TASKS_GLSL
+
+#include "cluster.glsl"
+
+// Clusters per task shader group, see HairStyle::MeshTaskSize.
+#define MESH_TASK_SIZE 32
+
+layout(std430, binding = 24) readonly buffer Clusters {
+    Cluster clusters[];
+};
+
+// Indices of the clusters that survived strand.task, one mesh shader group each,
+// and the instance of the hair style that they were culled against.
+struct MeshTasks {
+    uint clusters[MESH_TASK_SIZE];
+    uint instance;
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef VKHR_SIMULATION_GLSL
+#define VKHR_SIMULATION_GLSL
+
+#include "strand.glsl"
+
+// Shared by the passes that move the strands in place, i.e. simulate.comp and interpolate.comp.
+
+layout(constant_id = 0) const uint vertex_format = FLOAT_VERTICES;
+
+// Both formats are three words per vertex (see HairStyle::QuantizedVertex),
+// and both are written in place, so the rasterizer just draws them after.
+layout(std430, binding = 0) buffer Vertices {
+    uint vertices[];
+};
+
+layout(std430, binding = 1) buffer Tangents {
+    float tangents[];
+};
+
+layout(std430, binding = 3) readonly buffer RestPositions {
+    vec4 rest_positions[];
+};
+
+// The first vertex and the vertex count of each strand.
+layout(std430, binding = 5) readonly buffer Strands {
+    uvec2 strands[];
+};
+
+vec3 load_position(uint vertex) {
+    if (vertex_format == PACKED_VERTICES) {
+        vec2 xy = unpackUnorm2x16(vertices[3*vertex + 0]);
+        float z = unpackUnorm2x16(vertices[3*vertex + 1]).x;
+        return decode_strand_position(vec3(xy, z));
+    }
+
+    return vec3(uintBitsToFloat(vertices[3*vertex + 0]),
+                uintBitsToFloat(vertices[3*vertex + 1]),
+                uintBitsToFloat(vertices[3*vertex + 2]));
+}
+
+void store_position(uint vertex, vec3 position) {
+    if (vertex_format == PACKED_VERTICES) {
+        // Can't leave the bounding box it was quantized in.
+        vec3 unorm = clamp((position - volume_bounds.origin) / volume_bounds.size, 0.0f, 1.0f);
+        vertices[3*vertex + 0] = packUnorm2x16(unorm.xy);
+        vertices[3*vertex + 1] = (vertices[3*vertex + 1] & 0xffff0000u) | // keeps the thickness.
+                                 (packUnorm2x16(vec2(unorm.z, 0.0f)) & 0x0000ffffu);
+    } else {
+        vertices[3*vertex + 0] = floatBitsToUint(position.x);
+        vertices[3*vertex + 1] = floatBitsToUint(position.y);
+        vertices[3*vertex + 2] = floatBitsToUint(position.z);
+    }
+}
+
+void store_tangent(uint vertex, vec3 tangent) {
+    if (vertex_format == PACKED_VERTICES) {
+        vertices[3*vertex + 2] = packSnorm2x16(encode_strand_tangent(tangent));
+    } else {
+        tangents[3*vertex + 0] = tangent.x;
+        tangents[3*vertex + 1] = tangent.y;
+        tangents[3*vertex + 2] = tangent.z;
+    }
+}
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef VKHR_SORT_GLSL
+#define VKHR_SORT_GLSL
+
+#include "vertex_pulling.glsl"
+
+// The segments are sorted back-to-front by their 16-bit view depth keys
+// with a least significant digit radix sort, one 8-bit digit per pass, see
+// HairStyle::sort. Every group of the histogram and scatter passes takes a
+// block of consecutive keys, in tiles of as many as there are threads.
+#define SORT_RADIX 256
+#define SORT_GROUP_SIZE 256
+#define SORT_BLOCK_SIZE 4096 // see HairStyle::SortBlockSize.
+
+// Only the index count of the VkDrawIndexedIndirectCommand from cull.comp.
+layout(std430, binding = 57) readonly buffer CulledDraw {
+    uint culled_index_count;
+};
+
+// Ping-ponged between the passes: the key, and the segment it's for.
+layout(std430, binding = 58) buffer SortKeys {
+    uvec2 sort_keys[];
+};
+
+layout(std430, binding = 59) buffer SortedKeys {
+    uvec2 sorted_keys[];
+};
+
+// The count (and then the offset) of every digit in each block, digit-major.
+layout(std430, binding = 60) buffer SortHistograms {
+    uint sort_histograms[];
+};
+
+// The segments' indices, in the order they're drawn in, see HairStyle::draw_sorted.
+layout(std430, binding = 61) writeonly buffer SortedSegments {
+    uint sorted_indices[];
+};
+
+layout(push_constant) uniform Sorting {
+    mat4 model_view;
+    float nearest_depth;
+    float depth_range;
+    uint segment_count; // of the full draw, if it isn't culled.
+    uint culled;
+    uint pass;
+    uint block_count;
+} sorting;
+
+uint sort_segment_count() {
+    if (sorting.culled != 0)
+        return culled_index_count / 2;
+    return sorting.segment_count;
+}
+
+uint sort_digit(uint key) {
+    return (key >> (8 * sorting.pass)) & (SORT_RADIX - 1);
+}
+
+uvec2 load_sort_key(uint i) {
+    return sorting.pass == 0 ? sort_keys[i] : sorted_keys[i];
+}
+
+#endif
@@ -13,6 +13,47 @@ layout(binding = 2) uniform Strand {
     float hair_alpha;
     float hair_exponent;
     float strand_ratio;
+    int dual_scattering_on; // see dual_scattering.glsl.
+    float quantized_thickness; // of the thickest vertex.
 };
 
+#define FLOAT_VERTICES  0
+#define PACKED_VERTICES 1
+
+// See HairStyle::create_quantized_data for the packing.
+
+vec3 decode_strand_position(vec3 position) {
+    return volume_bounds.origin + position * volume_bounds.size;
+}
+
+vec2 encode_strand_tangent(vec3 tangent) {
+    vec2 octahedron = tangent.xy / max(abs(tangent.x) + abs(tangent.y) + abs(tangent.z), 1e-8f);
+    vec2 signs = mix(vec2(-1.0f), vec2(1.0f), greaterThanEqual(octahedron, vec2(0.0f)));
+    if (tangent.z < 0.0f) octahedron = (1.0f - abs(octahedron.yx)) * signs;
+    return octahedron;
+}
+
+vec3 decode_strand_tangent(vec2 octahedron) {
+    vec3 tangent = vec3(octahedron, 1.0f - abs(octahedron.x) - abs(octahedron.y));
+    if (tangent.z < 0.0f) tangent.xy = (1.0f - abs(tangent.yx)) * sign(tangent.xy);
+    return normalize(tangent);
+}
+
+// The tangent volumes are octahedral too, with (0, 0) in the empty voxels.
+vec3 decode_volume_tangent(vec2 octahedron) {
+    if (octahedron == vec2(0.0f))
+        return vec3(0.0f);
+    return decode_strand_tangent(octahedron);
+}
+
+float decode_strand_thickness(float thickness) {
+    return thickness * quantized_thickness;
+}
+
+// With only strand_ratio of the strands left, each of them has to be more opaque for the hair
+// to let the same amount of light through as all of them would, e.g. 1 - (1 - a)^(1 / ratio).
+float reduced_strand_alpha() {
+    return 1.0f - pow(1.0f - hair_alpha, 1.0f / max(strand_ratio, 0.001f));
+}
+
 #endif
@@ -3,30 +3,43 @@
 #include "../scene_graph/camera.glsl"
 
 #include "strand.glsl"
+#include "instances.glsl"
 
 layout(location = 0) in vec3  position;
 layout(location = 1) in vec3  tangent;
 layout(location = 2) in float thickness;
 
-layout(push_constant) uniform Object {
-    mat4 model;
-} object;
+layout(constant_id = 0) const uint vertex_format = FLOAT_VERTICES;
 
 layout(location = 0) out PipelineOut {
     vec4 position;
     vec3 tangent;
     float thickness;
+    flat float level_of_detail;
 } vs_out;
 
 void main() {
     mat4 projection_view = camera.projection * camera.view;
 
-    vec4 world_position = object.model * vec4(position, 1.0f);
-    vec4 world_tangent  = object.model * vec4(tangent,  0.0f);
+    vec3  strand_position  = position;
+    vec3  strand_tangent   = tangent;
+    float strand_thickness = thickness;
+
+    if (vertex_format == PACKED_VERTICES) {
+        strand_position  = decode_strand_position(position);
+        strand_tangent   = decode_strand_tangent(tangent.xy);
+        strand_thickness = decode_strand_thickness(thickness);
+    }
+
+    mat4 model = instance_model(gl_InstanceIndex);
+
+    vec4 world_position = model * vec4(strand_position, 1.0f);
+    vec4 world_tangent  = model * vec4(strand_tangent,  0.0f);
 
     vs_out.position  = world_position;
     vs_out.tangent   = world_tangent.xyz;
-    vs_out.thickness = thickness;
+    vs_out.thickness = strand_thickness;
+    vs_out.level_of_detail = instance_level_of_detail(gl_InstanceIndex);
 
     gl_Position = projection_view * world_position;
 }
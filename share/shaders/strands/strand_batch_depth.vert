@@ -0,0 +1,28 @@
+#version 460 core
+
+#include "strand.glsl"
+#include "instances.glsl"
+
+layout(location = 0) in vec3 position;
+
+layout(constant_id = 0) const uint vertex_format = FLOAT_VERTICES;
+
+// The volume_bounds of every hair style in vulkan::HairBatch, for each view after
+// each other, since the Strand block is only the first style's. Here the pushed
+// first_instance is the view's first draw, as firstInstance is already added to
+// gl_InstanceIndex by the indirect draws that are in the same order as the bounds.
+layout(std430, binding = 33) readonly buffer Draws {
+    AABB draw_bounds[];
+};
+
+// Same as strand_depth.vert, but for all of the hair styles in one indirect draw.
+void main() {
+    vec3 strand_position = position;
+
+    if (vertex_format == PACKED_VERTICES) {
+        AABB bounds = draw_bounds[object.first_instance + gl_DrawID];
+        strand_position = bounds.origin + position * bounds.size;
+    }
+
+    gl_Position = object.model * instances[gl_InstanceIndex].model * vec4(strand_position, 1.0f);
+}
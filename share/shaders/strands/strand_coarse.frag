@@ -0,0 +1,11 @@
+#version 460 core
+
+#extension GL_NV_shading_rate_image : require
+#extension GL_ARB_post_depth_coverage : require
+
+// Only the pixels of a coarse fragment that are in front of the models.
+layout(post_depth_coverage) in;
+
+#define SHADING_RATE_IMAGE
+
+#include "strand_fragment.glsl"
@@ -0,0 +1,25 @@
+#version 460 core
+
+#include "vertex_pulling.glsl"
+#include "instances.glsl"
+
+// The control points of the Catmull-Rom patches of strand_curve.tesc, which are
+// pulled by the indices of HairStyle::curve_patches (four per segment) like in
+// strand_pulled.vert, and only taken into world space here, the curve between
+// the middle two of them is evaluated in strand_curve.tese after tessellation.
+
+layout(location = 0) out ControlPoint {
+    vec4 position;
+    vec3 tangent;
+    float thickness;
+    float level_of_detail;
+} vs_out;
+
+void main() {
+    mat4 model = instance_model(gl_InstanceIndex);
+
+    vs_out.position  = model * vec4(load_position(gl_VertexIndex), 1.0f);
+    vs_out.tangent   = (model * vec4(load_tangent(gl_VertexIndex), 0.0f)).xyz;
+    vs_out.thickness = load_thickness(gl_VertexIndex);
+    vs_out.level_of_detail = instance_level_of_detail(gl_InstanceIndex);
+}
@@ -0,0 +1,17 @@
+#version 460 core
+
+#include "strand.glsl"
+#include "instances.glsl"
+
+layout(location = 0) in vec3 position;
+
+layout(constant_id = 0) const uint vertex_format = FLOAT_VERTICES;
+
+void main() {
+    vec3 strand_position = position;
+
+    if (vertex_format == PACKED_VERTICES)
+        strand_position = decode_strand_position(position);
+
+    gl_Position = instance_model(gl_InstanceIndex) * vec4(strand_position, 1.0f);
+}
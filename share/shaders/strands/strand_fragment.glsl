@@ -0,0 +1,232 @@
+#ifndef VKHR_STRAND_FRAGMENT_GLSL
+#define VKHR_STRAND_FRAGMENT_GLSL
+
+// Shared by strand.frag, which inserts the fragments into the PPLL, and
+// strand_wboit.frag, which accumulates them in weighted blended OIT, and
+// strand_stereo.frag, which is strand.frag for both eyes, see camera.glsl,
+// and strand_coarse.frag, which is strand.frag with coarse fragments too.
+
+#include "../scene_graph/camera.glsl"
+#include "../shading/kajiya-kay.glsl"
+#include "../shading/marschner.glsl"
+#include "../shading/dual_scattering.glsl"
+#include "../self-shadowing/approximate_deep_shadows.glsl"
+#include "../self-shadowing/deep_opacity_maps.glsl"
+#include "../self-shadowing/prefiltered_deep_shadows.glsl"
+#include "../self-shadowing/transmittance_volume.glsl"
+#include "../volumes/local_ambient_occlusion.glsl"
+#include "../volumes/ambient_occlusion_volume.glsl"
+
+#include "../transparency/ppll.glsl"
+#include "../level_of_detail/scheme.glsl"
+#include "../anti-aliasing/gpaa.glsl"
+#include "../variable_rate_shading/coarse_fragment.glsl"
+
+#include "../scene_graph/lights.glsl"
+#include "../scene_graph/light_tiles.glsl"
+#include "../scene_graph/shadow_maps.glsl"
+#include "../scene_graph/opacity_maps.glsl"
+#include "../scene_graph/filtered_shadow_maps.glsl"
+#include "../scene_graph/params.glsl"
+
+#include "strand.glsl"
+
+layout(early_fragment_tests) in;
+
+layout(location = 0) in PipelineIn {
+    vec4 position;
+    vec3 tangent;
+    float thickness;
+    flat float level_of_detail;
+} fs_in;
+
+layout(push_constant) uniform Object {
+    mat4 model;
+} object;
+
+layout(binding = 3) uniform sampler3D strand_density;
+layout(binding = 16) uniform sampler3D strand_occlusion;
+
+// From the style's own volumes, which is why it's done here even with the deferred shading.
+float strand_ambient_occlusion() {
+    if (shading_model == ADSM)
+        return 1.0f;
+
+    if (has_baked_ambient_occlusion(strand_occlusion)) {
+        return baked_ambient_occlusion(strand_occlusion,
+                                       fs_in.position.xyz,
+                                       volume_bounds.origin,
+                                       volume_bounds.size,
+                                       ao_exponent);
+    } else if (ao_volume == YES) {
+        return ambient_occlusion_volume(fs_in.position.xyz,
+                                        volume_bounds.origin,
+                                        volume_bounds.size,
+                                        ao_exponent);
+    } else {
+        return local_ambient_occlusion(strand_density,
+                                       fs_in.position.xyz,
+                                       volume_bounds.origin,
+                                       volume_bounds.size,
+                                       2, occlusion_radius,
+                                       ao_exponent, ao_max);
+    }
+}
+
+// From the shadow maps of lights[light], but only lights[0] has a transmittance volume.
+float strand_self_shadowing(uint light) {
+    if (deep_shadows_on != YES || shading_model == LAO)
+        return 1.0f;
+
+    vec4 shadow_space_fragment = lights[light].matrix * fs_in.position;
+
+    if (shadow_technique == TRANSMITTANCE_VOLUME && light == 0) {
+        return transmittance_volume(fs_in.position.xyz,
+                                    volume_bounds.origin,
+                                    volume_bounds.size);
+    } else if (shadow_technique == DEEP_OPACITY_MAPS) {
+        return deep_opacity_maps(opacity_maps[light], shadow_maps[light],
+                                 shadow_space_fragment,
+                                 deep_shadows_kernel_size,
+                                 deep_shadows_stride_size * lights[light].shadow_map_scale,
+                                 hair_alpha);
+    } else if (deep_shadows_prefiltered == YES) {
+        return prefiltered_deep_shadows(filtered_shadow_maps[light],
+                                        shadow_space_fragment,
+                                        15000.0f, hair_alpha);
+    } else if (linear_shadow_maps == YES) {
+        return linear_approximate_deep_shadows(filtered_shadow_maps[light],
+                                               shadow_space_fragment,
+                                               lights[light].near, lights[light].far,
+                                               deep_shadows_kernel_size,
+                                               deep_shadows_stride_size * lights[light].shadow_map_scale,
+                                               15000.0f, hair_alpha);
+    } else {
+        return approximate_deep_shadows(shadow_maps[light],
+                                        shadow_space_fragment,
+                                        deep_shadows_kernel_size,
+                                        deep_shadows_stride_size * lights[light].shadow_map_scale,
+                                        15000.0f, hair_alpha);
+    }
+}
+
+#ifdef WEIGHTED_BLENDED
+// See vulkan::WeightedBlended for how they are blended and composited.
+layout(location = 0) out vec4 accumulation;
+layout(location = 1) out float revealage;
+#else
+layout(location = 0) out vec4 color;
+
+// Into the PPLL of every pixel that the fragment covers, with the shading for resolve_deferred.comp,
+// or as an already shaded node. It's more than one pixel if it was shaded coarsely, all with the same
+// color and depth, but still with their own node each, since they're all sorted in their own k-buffer.
+void link_strand_fragment(vec4 fragment_color, bool shaded, uint shading) {
+    ivec2 origin = coarse_fragment_origin();
+    ivec2 size = coarse_fragment_size();
+
+    for (int y = 0; y < size.y; ++y)
+    for (int x = 0; x < size.x; ++x) {
+        if (!coarse_fragment_covers(ivec2(x, y)))
+            continue;
+
+        ivec2 pixel = eye_pixel(origin + ivec2(x, y));
+
+        uint node = ppll_next_node(pixel, uint(ppll_tile_budget));
+        if (node == PPLL_NULL_NODE) continue;
+        if (shaded)
+            ppll_node_data(node, fragment_color, gl_FragCoord.z);
+        else
+            ppll_deferred_node_data(node, fragment_color, gl_FragCoord.z, shading);
+        ppll_link_node(pixel, node);
+    }
+}
+#endif
+
+void main() {
+    float level_of_detail = lod(fs_in.level_of_detail, ivec2(gl_FragCoord.xy));
+    if (level_of_detail == 1.0f) discard; // e.g. raymarched here, see lod_dithered.
+
+    // The jitter of the temporal anti-aliasing covers the strand over the frames instead.
+    float coverage = temporal_anti_aliasing == YES ? 1.0f : gpaa(gl_FragCoord.xy, fs_in.position,
+                                                                 eye_view_projection(),
+                                                                 camera.hair_resolution, strand_width);
+
+    coverage *= reduced_strand_alpha(); // Alpha used for transparency.
+    if (coverage < 0.001) discard; // Shading not worth it!
+
+    coverage *= 1 - level_of_detail;
+    coverage *= fs_in.thickness * STRAND_SCALING; // Slowly fades the strand at the tip.
+    coverage  = min(coverage, 1.0f); // a merged strand can stand in for many, see HairStyle::merge.
+
+#if !defined(WEIGHTED_BLENDED) && !defined(DEPTH_SORTED)
+    // The lighting and the self-shadowing are left to resolve_deferred.comp, so that they're
+    // only done for the fragments that make it into the k-buffer of a pixel, not all of them.
+    // Except with the dual scattering, which is per style, and a node has no room to say so.
+    if (ppll_deferred != 0 && !(shading_model == KAJIYA_KAY && dual_scattering_on == YES)) {
+        vec3 albedo = shading_model == KAJIYA_KAY ? hair_color : vec3(1.0f);
+
+        link_strand_fragment(vec4(albedo, coverage), false,
+                             ppll_pack_shading(fs_in.tangent, strand_ambient_occlusion(), hair_alpha));
+
+        discard; // Fragments shaded in the resolve.
+    }
+#endif
+
+    vec3 eye_normal = normalize(fs_in.position.xyz - eye_position());
+
+    // Only the lights reaching the tile, and the other shading models just show lights[0]'s shadows.
+    uint light_mask = shading_model == KAJIYA_KAY ? light_tile_mask(ivec2(gl_FragCoord.xy)) : 1u;
+
+    vec3 shading = vec3(0.0);
+
+    for (uint i = 0; i < lights_size; ++i) {
+        if (!light_in_tile(light_mask, i))
+            continue;
+
+        vec3 light_direction = normalize(lights[i].origin - fs_in.position.xyz);
+        vec3 light_bulb_color = lights[i].intensity * light_attenuation(lights[i], fs_in.position.xyz);
+
+        if (shading_model == KAJIYA_KAY && dual_scattering_on == YES) {
+            shading += dual_scattering(hair_color, light_bulb_color,
+                                       fs_in.tangent, light_direction, eye_normal,
+                                       strand_self_shadowing(i), hair_alpha,
+                                       radians(marschner_shift), radians(marschner_width));
+            continue; // with its own self-shadowing.
+        }
+
+        vec3 light_shading = vec3(1.0);
+
+        if (shading_model == KAJIYA_KAY && marschner_shading == YES) {
+            light_shading = marschner(hair_color, light_bulb_color,
+                                      fs_in.tangent, light_direction, eye_normal);
+        } else if (shading_model == KAJIYA_KAY) {
+            light_shading = kajiya_kay(hair_color, light_bulb_color, hair_exponent,
+                                       fs_in.tangent, light_direction, eye_normal);
+        }
+
+        shading += light_shading * strand_self_shadowing(i);
+    }
+
+    float occlusion = strand_ambient_occlusion();
+
+#ifdef WEIGHTED_BLENDED
+    // Same weight as eq. 10 in McGuire and Bavoil 2013, but with the
+    // window-space depth, which stays on the same scale with the LoD.
+    float weight = clamp(pow(min(1.0f, coverage * 10.0f) + 0.01f, 3.0f) * 1e8f *
+                         pow(1.0f - gl_FragCoord.z * 0.9f, 3.0f), 1e-2f, 3e3f);
+
+    accumulation = vec4(shading * occlusion * coverage, coverage) * weight;
+    revealage = coverage;
+#elif defined(DEPTH_SORTED)
+    // Blended over what's behind it, since they're drawn back-to-front, see HairStyle::sort.
+    color = vec4(shading * occlusion, coverage);
+#else
+    color = vec4(shading * occlusion, coverage);
+
+    link_strand_fragment(color, true, PPLL_SHADED_NODE);
+
+    discard; // Fragments resolved in next pass.
+#endif
+}
+
+#endif
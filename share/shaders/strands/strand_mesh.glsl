@@ -0,0 +1,92 @@
+#ifndef VKHR_STRAND_MESH_GLSL
+#define VKHR_STRAND_MESH_GLSL
+
+#include "vertex_pulling.glsl"
+#include "mesh_tasks.glsl"
+#include "instances.glsl"
+
+// Shared by strand_lines.mesh and strand_quads.mesh, since the output topology can't
+// be a specialization constant. Each group emits one of the clusters strand.task has
+// found to be visible, with one segment per thread, as a line or as a quad expanded
+// in screen-space to the strand width (the same way as with strand_pulled.vert).
+
+#ifdef STRAND_QUADS
+#define VERTICES_PER_SEGMENT   4
+#define PRIMITIVES_PER_SEGMENT 2
+layout(triangles, max_vertices = VERTICES_PER_SEGMENT * CLUSTER_SIZE,
+                  max_primitives = PRIMITIVES_PER_SEGMENT * CLUSTER_SIZE) out;
+#else
+#define VERTICES_PER_SEGMENT   2
+#define PRIMITIVES_PER_SEGMENT 1
+layout(lines, max_vertices = VERTICES_PER_SEGMENT * CLUSTER_SIZE,
+              max_primitives = PRIMITIVES_PER_SEGMENT * CLUSTER_SIZE) out;
+#endif
+
+layout(local_size_x = CLUSTER_SIZE) in;
+
+taskPayloadSharedEXT MeshTasks mesh_tasks;
+
+layout(location = 0) out PipelineOut {
+    vec4 position;
+    vec3 tangent;
+    float thickness;
+    flat float level_of_detail;
+} ms_out[];
+
+void emit_vertex(uint index, vec4 clip_position, vec4 world_position, vec4 world_tangent, float strand_thickness) {
+    gl_MeshVerticesEXT[index].gl_Position = clip_position;
+
+    ms_out[index].position  = world_position;
+    ms_out[index].tangent   = world_tangent.xyz;
+    ms_out[index].thickness = strand_thickness;
+    ms_out[index].level_of_detail = instance_level_of_detail(mesh_tasks.instance);
+}
+
+void main() {
+    Cluster cluster = clusters[mesh_tasks.clusters[gl_WorkGroupID.x]];
+
+    // strand.task has already made sure the first segment is within it.
+    uint segment_limit = uint(indices.length() * strand_ratio) / 2;
+    uint segment_count = min(cluster.segment_count, segment_limit - cluster.first_segment);
+
+    SetMeshOutputsEXT(VERTICES_PER_SEGMENT * segment_count, PRIMITIVES_PER_SEGMENT * segment_count);
+
+    uint thread = gl_LocalInvocationIndex;
+
+    if (thread >= segment_count)
+        return;
+
+    mat4 projection_view = camera.projection * camera.view;
+    mat4 model = instance_model(mesh_tasks.instance);
+
+    uint segment = cluster.first_segment + thread;
+    uint first_vertex = VERTICES_PER_SEGMENT * thread;
+
+    for (uint end = 0; end < 2; ++end) {
+        uint vertex = indices[2*segment + end];
+
+        vec4 world_position = model * vec4(load_position(vertex), 1.0f);
+        vec4 world_tangent  = model * vec4(load_tangent(vertex),  0.0f);
+        float strand_thickness = load_thickness(vertex);
+
+        vec4 clip_position = projection_view * world_position;
+
+#ifdef STRAND_QUADS
+        emit_vertex(first_vertex + 2*end + 0, expand_strand(clip_position, world_position, world_tangent, -1.0f),
+                    world_position, world_tangent, strand_thickness);
+        emit_vertex(first_vertex + 2*end + 1, expand_strand(clip_position, world_position, world_tangent, +1.0f),
+                    world_position, world_tangent, strand_thickness);
+#else
+        emit_vertex(first_vertex + end, clip_position, world_position, world_tangent, strand_thickness);
+#endif
+    }
+
+#ifdef STRAND_QUADS
+    gl_PrimitiveTriangleIndicesEXT[2*thread + 0] = first_vertex + uvec3(0, 1, 2);
+    gl_PrimitiveTriangleIndicesEXT[2*thread + 1] = first_vertex + uvec3(2, 1, 3);
+#else
+    gl_PrimitiveLineIndicesEXT[thread] = first_vertex + uvec2(0, 1);
+#endif
+}
+
+#endif
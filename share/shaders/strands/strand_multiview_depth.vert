@@ -0,0 +1,24 @@
+#version 460 core
+
+#extension GL_EXT_multiview : require
+
+#define LIGHTS_SIZE_CONSTANT_ID 1
+
+#include "strand.glsl"
+#include "instances.glsl"
+#include "../scene_graph/lights.glsl"
+
+layout(location = 0) in vec3 position;
+
+layout(constant_id = 0) const uint vertex_format = FLOAT_VERTICES;
+
+// Same as strand_depth.vert, but into every shadow map in one draw, with the light's
+// transform picked by the view, and the pushed matrix is the identity (see draw_hairs).
+void main() {
+    vec3 strand_position = position;
+
+    if (vertex_format == PACKED_VERTICES)
+        strand_position = decode_strand_position(position);
+
+    gl_Position = lights[gl_ViewIndex].matrix * instance_model(gl_InstanceIndex) * vec4(strand_position, 1.0f);
+}
@@ -0,0 +1,54 @@
+#version 460 core
+
+#include "vertex_pulling.glsl"
+#include "instances.glsl"
+
+// Same as strand.vert, but without any vertex inputs, since the attributes
+// are pulled from storage buffers instead. With quads, each segment is six
+// non-indexed vertices (two triangles) that are expanded in screen-space to
+// the strand width, so the lines need neither a geometry shader nor "wide
+// lines". Only quads read the segments, lines are drawn indexed as before.
+
+#define PULLED_LINES 1
+#define PULLED_QUADS 2
+
+layout(constant_id = 1) const uint expansion = PULLED_LINES;
+
+layout(location = 0) out PipelineOut {
+    vec4 position;
+    vec3 tangent;
+    float thickness;
+    flat float level_of_detail;
+} vs_out;
+
+// End of the segment (0 or 1) and the side (-1 or +1) of the quad corners.
+const ivec2 quad_corners[6] = ivec2[6](ivec2(0, -1), ivec2(0, +1), ivec2(1, -1),
+                                       ivec2(1, -1), ivec2(0, +1), ivec2(1, +1));
+
+void main() {
+    mat4 projection_view = camera.projection * camera.view;
+
+    uint vertex = gl_VertexIndex;
+    ivec2 corner = ivec2(0);
+
+    if (expansion == PULLED_QUADS) {
+        uint segment = gl_VertexIndex / 6;
+        corner = quad_corners[gl_VertexIndex % 6];
+        vertex = indices[2*segment + corner.x];
+    }
+
+    mat4 model = instance_model(gl_InstanceIndex);
+
+    vec4 world_position = model * vec4(load_position(vertex), 1.0f);
+    vec4 world_tangent  = model * vec4(load_tangent(vertex),  0.0f);
+
+    vs_out.position  = world_position;
+    vs_out.tangent   = world_tangent.xyz;
+    vs_out.thickness = load_thickness(vertex);
+    vs_out.level_of_detail = instance_level_of_detail(gl_InstanceIndex);
+
+    gl_Position = projection_view * world_position;
+
+    if (expansion == PULLED_QUADS)
+        gl_Position = expand_strand(gl_Position, world_position, world_tangent, float(corner.y));
+}
@@ -0,0 +1,5 @@
+#version 460 core
+
+#define DEPTH_SORTED
+
+#include "strand_fragment.glsl"
@@ -0,0 +1,7 @@
+#version 460 core
+
+#extension GL_EXT_multiview : require
+
+#define STEREO
+
+#include "strand_fragment.glsl"
@@ -0,0 +1,5 @@
+#version 460 core
+
+#define WEIGHTED_BLENDED
+
+#include "strand_fragment.glsl"
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef VKHR_TILES_GLSL
+#define VKHR_TILES_GLSL
+
+// The lights_size constant is 0 in tile_raster.comp.
+#define VERTEX_FORMAT_CONSTANT_ID 1
+
+#include "vertex_pulling.glsl"
+
+// Pixels per side of a tile, and the most segments binned
+// into each of them, see HairStyle::TileSize / TileSegments.
+#define TILE_SIZE 16
+#define TILE_SEGMENTS 512
+
+layout(std430, binding = 25) buffer TileCounts {
+    uint tile_counts[];
+};
+
+layout(std430, binding = 26) buffer TileSegments {
+    uint tile_segments[];
+};
+
+layout(push_constant) uniform Object {
+    mat4 model;
+    float level_of_detail;
+} object;
+
+uvec2 tile_grid() {
+    return (uvec2(camera.hair_resolution) + TILE_SIZE - 1) / TILE_SIZE;
+}
+
+vec4 world_position(uint vertex) {
+    return object.model * vec4(load_position(vertex), 1.0f);
+}
+
+// Window coordinates in xy, depth in z, and it's only in front of the eye if w > 0.
+vec4 window_position(vec4 world_position) {
+    vec4 clip_position = camera.projection * camera.view * world_position;
+    vec3 ndc_position  = clip_position.xyz / clip_position.w;
+    return vec4((ndc_position.xy * 0.5f + 0.5f) * camera.hair_resolution,
+                ndc_position.z, clip_position.w);
+}
+
+#endif
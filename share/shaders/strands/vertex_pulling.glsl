@@ -0,0 +1,84 @@
+#ifndef VKHR_VERTEX_PULLING_GLSL
+#define VKHR_VERTEX_PULLING_GLSL
+
+#include "../scene_graph/camera.glsl"
+#include "../scene_graph/params.glsl"
+
+#include "strand.glsl"
+
+// Strand attributes are pulled from storage buffers instead of vertex inputs,
+// by strand_pulled.vert and the mesh shaders. The bindings start right after
+// the shadow maps in HairStyle's layout (see HairStyle::build_pipeline).
+
+// Shaders that also need lights_size (which is 0) can move it.
+#ifndef VERTEX_FORMAT_CONSTANT_ID
+#define VERTEX_FORMAT_CONSTANT_ID 0
+#endif
+
+layout(constant_id = VERTEX_FORMAT_CONSTANT_ID) const uint vertex_format = FLOAT_VERTICES;
+
+// Both formats are three words per vertex (see HairStyle::QuantizedVertex).
+layout(std430, binding = 20) readonly buffer Vertices {
+    uint vertices[];
+};
+
+layout(std430, binding = 21) readonly buffer Tangents {
+    float tangents[];
+};
+
+layout(std430, binding = 22) readonly buffer Thickness {
+    float thickness[];
+};
+
+layout(std430, binding = 23) readonly buffer Segments {
+    uint indices[];
+};
+
+vec3 load_position(uint vertex) {
+    if (vertex_format == PACKED_VERTICES) {
+        vec2 xy = unpackUnorm2x16(vertices[3*vertex + 0]);
+        float z = unpackUnorm2x16(vertices[3*vertex + 1]).x;
+        return decode_strand_position(vec3(xy, z));
+    }
+
+    return vec3(uintBitsToFloat(vertices[3*vertex + 0]),
+                uintBitsToFloat(vertices[3*vertex + 1]),
+                uintBitsToFloat(vertices[3*vertex + 2]));
+}
+
+vec3 load_tangent(uint vertex) {
+    if (vertex_format == PACKED_VERTICES)
+        return decode_strand_tangent(unpackSnorm2x16(vertices[3*vertex + 2]));
+    return vec3(tangents[3*vertex + 0],
+                tangents[3*vertex + 1],
+                tangents[3*vertex + 2]);
+}
+
+float load_thickness(uint vertex) {
+    if (vertex_format == PACKED_VERTICES)
+        return decode_strand_thickness(unpackUnorm2x16(vertices[3*vertex + 1]).y);
+    return thickness[vertex];
+}
+
+// Moves the clip space position to 'side' (-1 or +1) of the strand by half of the
+// strand width (in pixels), along the screen-space normal of its world tangent. It
+// is the native pixel wide strand with the temporal anti-aliasing, and no GPAA.
+vec4 expand_strand(vec4 clip_position, vec4 world_position, vec4 world_tangent, float side) {
+    mat4 projection_view = camera.projection * camera.view;
+
+    vec4 clip_tangent = projection_view * (world_position + world_tangent);
+    vec2 screen_direction = (clip_tangent.xy / clip_tangent.w - clip_position.xy / clip_position.w) * camera.hair_resolution;
+    screen_direction = length(screen_direction) > 0.0f ? normalize(screen_direction) : vec2(1.0f, 0.0f);
+
+    vec2 screen_normal = vec2(-screen_direction.y, screen_direction.x);
+
+    // Half of the strand width to each side, in NDC units.
+    float width = temporal_anti_aliasing == YES ? 1.0f : strand_width;
+    vec2 offset = screen_normal * side * width / camera.hair_resolution;
+
+    clip_position.xy += offset * clip_position.w;
+
+    return clip_position;
+}
+
+#endif
@@ -12,39 +12,198 @@ struct Node {
 
 layout(binding = 5, r32ui) uniform uimage2D ppll_heads;
 layout(binding = 6, std430) buffer LinkedList {
-    Node ppll_nodes[];
+    uint ppll_nodes[]; // a Node in 3 words, or 2 words with ppll_packed.
 };
 
-layout(binding = 7) uniform Config { uint ppll_size; };
+layout(binding = 7) uniform Config { uint ppll_size; uint ppll_deferred; uint ppll_packed; };
+// Pixels per side of the tiles with a budget, see LinkedList::TileSize.
+#define PPLL_TILE_SIZE 16
+
 layout(binding = 8, std430) buffer LinkedListCounter {
     uint ppll_counter;
+    uint ppll_tag; // of this frame's heads, see LinkedList::clear.
+    uint ppll_tile_counters[];
+};
+
+// The upper bits of the heads are the tag of the frame they were linked
+// in, and the heads from any other frame are null, so that they're only
+// cleared when the tag wraps around. PPLL_NULL_NODE's tag is never used.
+#define PPLL_TAG_SHIFT 28
+#define PPLL_NODE_MASK 0x0fffffffu
+
+uint ppll_untag_node(uint head) {
+    if ((head >> PPLL_TAG_SHIFT) != ppll_tag)
+        return PPLL_NULL_NODE;
+    return head & PPLL_NODE_MASK;
+}
+
+// Only with the deferred shading (ppll_deferred), where the node of a strand fragment has its hair
+// color and coverage, and what else it needs to be shaded with in resolve_deferred.comp is here:
+// its tangent, ambient occlusion and alpha, see ppll_pack_shading, or PPLL_SHADED_NODE for nodes
+// that were shaded already when they were inserted, e.g. by the raymarcher or tile rasterizer.
+layout(binding = 17, std430) buffer LinkedListShading {
+    uint ppll_shading[];
 };
 
+#define PPLL_SHADED_NODE 0u
+
+// Only with the deferred shading too (ppll_packed), the nodes are 8 bytes: the depth in 24 bits
+// and the coverage in 8 bits, then the previous node in 28 bits (PPLL_NODE_MASK being its null)
+// and the ambient occlusion in 4 bits. The rest of a node goes in its ppll_shading, which has a
+// tangent in octahedral 8:8 bits, the hair color in 4:4:4 bits and the alpha in 4 (never zero),
+// or the color of a node that was shaded already with them zero, see ppll_packed_node_data.
+#define PPLL_NODE_WORDS (ppll_packed != 0 ? 2u : 3u)
+#define PPLL_PREV_WORD  (ppll_packed != 0 ? 1u : 2u)
+
 uint ppll_next_node() {
     uint next_node = atomicAdd(ppll_counter, 1u);
     if (next_node > ppll_size)
         return PPLL_NULL_NODE;
-    ppll_nodes[next_node].prev = PPLL_NULL_NODE;
+    ppll_nodes[next_node * PPLL_NODE_WORDS + PPLL_PREV_WORD] = PPLL_NULL_NODE;
+    if (ppll_deferred != 0)
+        ppll_shading[next_node] = PPLL_SHADED_NODE;
     return next_node;
 }
 
+// Same as above, but the tile of the pixel gets at most tile_budget nodes
+// (none if it's zero), so a close-up can't take the whole pool by itself.
+uint ppll_next_node(ivec2 pixel, uint tile_budget) {
+    if (tile_budget != 0) {
+        uint tile_columns = (imageSize(ppll_heads).x + PPLL_TILE_SIZE - 1) / PPLL_TILE_SIZE;
+        uvec2 tile = uvec2(pixel) / PPLL_TILE_SIZE;
+        if (atomicAdd(ppll_tile_counters[tile.y * tile_columns + tile.x], 1u) >= tile_budget)
+            return PPLL_NULL_NODE;
+    }
+
+    return ppll_next_node();
+}
+
+// In [0, 1] from a tangent, with the lower hemisphere folded over.
+vec2 ppll_pack_octahedron(vec3 tangent) {
+    tangent /= abs(tangent.x) + abs(tangent.y) + abs(tangent.z);
+    vec2 octahedron = tangent.xy;
+    if (tangent.z < 0.0f) octahedron = (1.0f - abs(tangent.yx)) * vec2(tangent.x >= 0.0f ? 1.0f : -1.0f,
+                                                                       tangent.y >= 0.0f ? 1.0f : -1.0f);
+    return clamp(octahedron * 0.5f + 0.5f, 0.0f, 1.0f);
+}
+
+vec3 ppll_unpack_octahedron(vec2 octahedron) {
+    octahedron = octahedron * 2.0f - 1.0f;
+    vec3 tangent = vec3(octahedron, 1.0f - abs(octahedron.x) - abs(octahedron.y));
+    if (tangent.z < 0.0f) tangent.xy = (1.0f - abs(tangent.yx)) * sign(tangent.xy);
+    return normalize(tangent);
+}
+
+// The tangent in octahedral 10:10 bits, then the ambient occlusion and the alpha in 6 bits each.
+// The alpha is never stored as zero, so the packed shading is never the same as PPLL_SHADED_NODE.
+uint ppll_pack_shading(vec3 tangent, float occlusion, float alpha) {
+    uvec2 packed_tangent = uvec2(round(ppll_pack_octahedron(tangent) * 1023.0f));
+    uint packed_occlusion = uint(round(clamp(occlusion, 0.0f, 1.0f) * 63.0f));
+    uint packed_alpha = uint(max(round(clamp(alpha, 0.0f, 1.0f) * 63.0f), 1.0f));
+    return packed_tangent.x | (packed_tangent.y << 10) | (packed_occlusion << 20) | (packed_alpha << 26);
+}
+
+void ppll_unpack_shading(uint shading, out vec3 tangent, out float occlusion, out float alpha) {
+    tangent = ppll_unpack_octahedron(vec2(shading & 0x3ffu, (shading >> 10) & 0x3ffu) / 1023.0f);
+    occlusion = float((shading >> 20) & 0x3fu) / 63.0f;
+    alpha = float(shading >> 26) / 63.0f;
+}
+
+uint ppll_pack_depth_coverage(float depth, float coverage) {
+    return (uint(round(clamp(depth, 0.0f, 1.0f) * 16777215.0f)) << 8) |
+            uint(round(clamp(coverage, 0.0f, 1.0f) * 255.0f));
+}
+
+void ppll_packed_node_data(uint node, vec4 color, float depth, uint shading) {
+    ppll_nodes[node * 2u + 0u] = ppll_pack_depth_coverage(depth, color.a);
+
+    if (shading == PPLL_SHADED_NODE) {
+        ppll_shading[node] = packUnorm4x8(vec4(color.rgb, 0.0f));
+        return;
+    }
+
+    vec3 tangent;
+    float occlusion, alpha;
+    ppll_unpack_shading(shading, tangent, occlusion, alpha);
+
+    uvec2 packed_tangent = uvec2(round(ppll_pack_octahedron(tangent) * 255.0f));
+    uvec3 packed_color = uvec3(round(clamp(color.rgb, 0.0f, 1.0f) * 15.0f));
+    uint packed_alpha = uint(max(round(alpha * 15.0f), 1.0f));
+    ppll_shading[node] = packed_tangent.x | (packed_tangent.y << 8) | (packed_color.r << 16) |
+                         (packed_color.g << 20) | (packed_color.b << 24) | (packed_alpha << 28);
+
+    uint packed_occlusion = uint(round(occlusion * 15.0f));
+    ppll_nodes[node * 2u + 1u] = (packed_occlusion << PPLL_TAG_SHIFT) | (ppll_nodes[node * 2u + 1u] & PPLL_NODE_MASK);
+}
+
 void ppll_node_data(uint node, vec4 color, float depth) {
-    ppll_nodes[node].color = packUnorm4x8(color);
-    ppll_nodes[node].depth = depth; // don't pack
+    if (ppll_packed != 0) {
+        ppll_packed_node_data(node, color, depth, PPLL_SHADED_NODE);
+        return;
+    }
+
+    ppll_nodes[node * 3u + 0u] = packUnorm4x8(color);
+    ppll_nodes[node * 3u + 1u] = floatBitsToUint(depth); // don't pack
+
+    // Or resolve_deferred.comp would shade it again with what was left from another node.
+    if (ppll_deferred != 0)
+        ppll_shading[node] = PPLL_SHADED_NODE;
+}
+
+void ppll_deferred_node_data(uint node, vec4 color, float depth, uint shading) {
+    if (ppll_packed != 0) {
+        ppll_packed_node_data(node, color, depth, shading);
+        return;
+    }
+
+    ppll_node_data(node, color, depth);
+    ppll_shading[node] = shading;
+}
+
+// Same as ppll_pack_shading for packed nodes too, so the resolves don't have to know about them.
+uint ppll_node_shading(uint node) {
+    uint shading = ppll_shading[node];
+    if (ppll_packed == 0)
+        return shading;
+    if ((shading >> 28) == 0)
+        return PPLL_SHADED_NODE;
+
+    vec3 tangent = ppll_unpack_octahedron(vec2(shading & 0xffu, (shading >> 8) & 0xffu) / 255.0f);
+    float occlusion = float(ppll_nodes[node * 2u + 1u] >> PPLL_TAG_SHIFT) / 15.0f;
+    float alpha = float(shading >> 28) / 15.0f;
+    return ppll_pack_shading(tangent, occlusion, alpha);
 }
 
 Node ppll_node(uint node) {
-    return ppll_nodes[node];
+    if (ppll_packed == 0)
+        return Node(ppll_nodes[node * 3u + 0u], uintBitsToFloat(ppll_nodes[node * 3u + 1u]),
+                    ppll_nodes[node * 3u + 2u]);
+
+    uint depth_coverage = ppll_nodes[node * 2u + 0u];
+    uint prev = ppll_nodes[node * 2u + 1u] & PPLL_NODE_MASK;
+    uint shading = ppll_shading[node];
+
+    vec3 color = unpackUnorm4x8(shading).rgb; // if it was shaded already.
+    if ((shading >> 28) != 0)
+        color = vec3((shading >> 16) & 0xfu, (shading >> 20) & 0xfu, (shading >> 24) & 0xfu) / 15.0f;
+
+    return Node(packUnorm4x8(vec4(color, float(depth_coverage & 0xffu) / 255.0f)),
+                float(depth_coverage >> 8) / 16777215.0f,
+                prev == PPLL_NODE_MASK ? PPLL_NULL_NODE : prev);
 }
 
 uint ppll_head_node(ivec2 pixel) {
-    return imageLoad(ppll_heads, pixel).r;
+    return ppll_untag_node(imageLoad(ppll_heads, pixel).r);
 }
 
 void ppll_link_node(ivec2 pixel, uint next_node) {
     uint prev_node = imageAtomicExchange(ppll_heads, pixel,
-                                         next_node);
-    ppll_nodes[next_node].prev = prev_node;
+                                         (ppll_tag << PPLL_TAG_SHIFT) | next_node);
+    uint prev_word = next_node * PPLL_NODE_WORDS + PPLL_PREV_WORD;
+    if (ppll_packed != 0) // keeping the ambient occlusion.
+        ppll_nodes[prev_word] = (ppll_nodes[prev_word] & ~PPLL_NODE_MASK) | (ppll_untag_node(prev_node) & PPLL_NODE_MASK);
+    else
+        ppll_nodes[prev_word] = ppll_untag_node(prev_node);
 }
 
 #endif
@@ -0,0 +1,15 @@
+#ifndef VKHR_HEATMAP_GLSL
+#define VKHR_HEATMAP_GLSL
+
+// The cost_view of Interface::CostView, which replaces the colors of the pixels with how much they cost.
+#define NO_COST_VIEW       0
+#define FRAGMENT_COST_VIEW 1
+#define RAYMARCH_COST_VIEW 2
+
+// From dark blue (no cost) through cyan, green and yellow to dark red (a cost of 'range' and above).
+vec3 heatmap(float cost, float range) {
+    float x = clamp(cost / max(range, 1e-6f), 0.0f, 1.0f);
+    return clamp(vec3(1.5f) - abs(4.0f * x - vec3(3.0f, 2.0f, 1.0f)), 0.0f, 1.0f);
+}
+
+#endif
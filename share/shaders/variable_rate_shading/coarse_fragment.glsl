@@ -0,0 +1,32 @@
+#ifndef VKHR_COARSE_FRAGMENT_GLSL
+#define VKHR_COARSE_FRAGMENT_GLSL
+
+// With SHADING_RATE_IMAGE (and GL_NV_shading_rate_image enabled before the includes), a
+// fragment can be a block of gl_FragmentSizeNV pixels that's shaded once (coarsely), see
+// vulkan::ShadingRateImage. What the fragment shader writes to a pixel by itself, e.g. a
+// PPLL node, then has to be written to each of the pixels that it covers, and those have
+// a bit each in gl_SampleMaskIn, row by row, since the pipelines' sample order is pixel-
+// major and there's only one sample per pixel. Otherwise it's only the one pixel in them.
+
+ivec2 coarse_fragment_size() {
+#ifdef SHADING_RATE_IMAGE
+    return gl_FragmentSizeNV;
+#else
+    return ivec2(1);
+#endif
+}
+
+// The top-left pixel of the fragment, since gl_FragCoord is the center of all of them.
+ivec2 coarse_fragment_origin() {
+    return ivec2(gl_FragCoord.xy) - coarse_fragment_size() / 2;
+}
+
+bool coarse_fragment_covers(ivec2 offset) {
+#ifdef SHADING_RATE_IMAGE
+    return (gl_SampleMaskIn[0] & (1 << (offset.y * gl_FragmentSizeNV.x + offset.x))) != 0;
+#else
+    return true;
+#endif
+}
+
+#endif
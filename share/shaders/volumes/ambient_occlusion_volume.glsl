@@ -0,0 +1,14 @@
+#ifndef VKHR_AMBIENT_OCCLUSION_VOLUME_GLSL
+#define VKHR_AMBIENT_OCCLUSION_VOLUME_GLSL
+
+#include "sample_volume.glsl"
+
+// The local ambient occlusion of every voxel of the style, from the volume's ambient_occlusion.comp.
+layout(binding = 14) uniform sampler3D strand_ambient_occlusion_volume;
+
+// Same as local_ambient_occlusion, but with a single trilinear lookup instead of the kernel's taps.
+float ambient_occlusion_volume(vec3 fragment_position, vec3 volume_origin, vec3 volume_size, float intensity) {
+    return pow(sample_volume(strand_ambient_occlusion_volume, fragment_position, volume_origin, volume_size).r, intensity);
+}
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef VKHR_DISTANCE_FIELD_GLSL
+#define VKHR_DISTANCE_FIELD_GLSL
+
+#include "sample_volume.glsl"
+
+// The distance from every cell of the first mip level to the nearest one with any strands in it,
+// in cells, stored as a fraction of 255 of them (see distance_field.comp, it's run in voxelize).
+layout(binding = 34) uniform sampler3D strand_distance_field;
+
+// How many cells closer than the cell center the density can be: half a cell diagonal on both
+// sides, and what the filtering of the bricks reaches past the cell (and more for the mip levels).
+#define DISTANCE_FIELD_MARGIN 2.0f
+
+// Like skip_empty_brick, it moves 't' forward by whole steps of 'step_size' and returns true if
+// the point at 't' is far enough away from the nearest strand, or leaves 't' alone. All of the
+// steps it moves past are empty at 'volume_level', so the result is the same, but with fewer.
+bool skip_empty_space(vec3 start, vec3 end, inout float t, float step_size, float volume_level, vec3 volume_origin, vec3 volume_size) {
+    vec3 cells = textureSize(strand_distance_field, 0);
+    ivec3 cell = ivec3(floor((mix(start, end, t) - volume_origin) / volume_size * cells));
+
+    if (any(lessThan(cell, ivec3(0))) || any(greaterThanEqual(cell, ivec3(cells))))
+        return false; // Let the caller deal with the outside.
+
+    float margin = DISTANCE_FIELD_MARGIN;
+    if (volume_level >= VOLUME_MIP_BASE)
+        margin += exp2(floor(volume_level) - VOLUME_MIP_BASE + 1.0f);
+
+    float cells_away = texelFetch(strand_distance_field, cell, 0).r * 255.0f - margin;
+    if (cells_away <= 0.0f)
+        return false;
+
+    vec3 cell_size = volume_size / cells;
+    float safe_distance = cells_away * min(min(cell_size.x, cell_size.y), cell_size.z) / max(length(end - start), 1e-5f);
+
+    t += floor(safe_distance / step_size) * step_size;
+
+    return true;
+}
+
+#endif
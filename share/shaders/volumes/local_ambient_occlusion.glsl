@@ -15,7 +15,7 @@ float local_ambient_occlusion(sampler3D volume,
     float density = 0.0f;
 
     float kernel_radius = (kernel_size - 1.0f) / 2.0f;
-    vec3 voxel_space = volume_size / textureSize(volume, 0);
+    vec3 voxel_space = volume_size / volume_resolution;
     float voxel_scaling = radius / kernel_radius;
     vec3 voxel_sample_scaling = voxel_scaling * voxel_space;
 
@@ -23,10 +23,23 @@ float local_ambient_occlusion(sampler3D volume,
     for (float y = -kernel_radius; y <= +kernel_radius; y += 1.0f)
     for (float x = -kernel_radius; x <= +kernel_radius; x += 1.0f) {
         vec3 sample_position = fragment_position + vec3(x, y, z) * voxel_sample_scaling;
-        density += min(sample_volume(volume, sample_position, volume_origin, volume_size).r, min_intensity);
+        density += min(sample_bricked_volume(volume, sample_position, volume_origin, volume_size).r, min_intensity);
     }
 
     return pow(1.0f - density / pow(kernel_size, 3.0f), intensity);
 }
 
+// Baked with Raytracer::bake_ambient_occlusion over the same bounding box as the density,
+// as the fraction of unoccluded rays. If it hasn't been, it's only a voxel: use the LAO.
+bool has_baked_ambient_occlusion(sampler3D occlusion) {
+    return textureSize(occlusion, 0).x > 1;
+}
+
+float baked_ambient_occlusion(sampler3D occlusion,
+                              vec3 fragment_position,
+                              vec3 volume_origin, vec3 volume_size,
+                              float intensity) {
+    return pow(sample_volume(occlusion, fragment_position, volume_origin, volume_size).r, intensity);
+}
+
 #endif
@@ -0,0 +1,44 @@
+#ifndef VKHR_OCCUPANCY_GLSL
+#define VKHR_OCCUPANCY_GLSL
+
+// The occupancy volume has the max density of a brick of voxels, dilated by one brick, so any
+// filtered samples taken from a brick with zero occupancy are guaranteed to be empty as well.
+#define VOLUME_BRICK_SIZE 8
+
+// True if the point at 't' on the ray from 'start' to 'end' is in an empty brick. In that case
+// 'exit_distance' is how far we can move (in units of 't') without leaving the empty brick.
+bool empty_brick(usampler3D occupancy, vec3 start, vec3 end, float t, vec3 volume_origin, vec3 volume_size, out float exit_distance) {
+    vec3 bricks = textureSize(occupancy, 0);
+    vec3 brick_position = (mix(start, end, t) - volume_origin) / volume_size * bricks;
+    ivec3 brick = ivec3(floor(brick_position));
+
+    exit_distance = 0.0f;
+
+    if (any(lessThan(brick, ivec3(0))) || any(greaterThanEqual(brick, ivec3(bricks))))
+        return false; // Let the caller deal with the outside.
+
+    if (texelFetch(occupancy, brick, 0).r != 0u)
+        return false;
+
+    vec3 direction = (end - start) / volume_size * bricks;
+    direction = mix(direction, vec3(1e-6f), equal(direction, vec3(0.0f)));
+
+    vec3 exit_plane = vec3(brick) + step(0.0f, direction);
+    vec3 exit_distances = (exit_plane - brick_position) / direction;
+
+    exit_distance = max(min(min(exit_distances.x, exit_distances.y), exit_distances.z), 0.0f);
+
+    return true;
+}
+
+// Moves 't' forward by whole steps of 'step_size' through an empty brick and returns true, or
+// leaves it alone if the brick is occupied. The sample at 't' can be skipped if this is true.
+bool skip_empty_brick(usampler3D occupancy, vec3 start, vec3 end, inout float t, float step_size, vec3 volume_origin, vec3 volume_size) {
+    float exit_distance;
+    if (!empty_brick(occupancy, start, end, t, volume_origin, volume_size, exit_distance))
+        return false;
+    t += floor(exit_distance / step_size) * step_size;
+    return true;
+}
+
+#endif
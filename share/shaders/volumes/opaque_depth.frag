@@ -0,0 +1,63 @@
+#version 460 core
+
+#include "../scene_graph/camera.glsl"
+#include "../scene_graph/params.glsl"
+
+#include "../level_of_detail/scheme.glsl"
+
+#include "sample_volume.glsl"
+#include "occupancy.glsl"
+#include "distance_field.glsl"
+
+#include "volume.glsl"
+
+// Where the hair becomes opaque, so the strands behind it fail the early depth test, before they're
+// shaded and inserted into the PPLL. It's marched from the bounding box along the eye ray, counting
+// the strands like volume_approximated_deep_shadows, until fewer than 1% of the light gets through.
+// Conservative, since the depth is written one step past that point, and not where there's no such
+// point or where the node isn't rasterized. See Rasterizer::draw_opaque_depth for where it's drawn.
+
+#define OPAQUE_TRANSMITTANCE 0.01f
+
+layout(location = 0) in PipelineIn {
+    vec4 position;
+} fs_in;
+
+layout(binding = 3)  uniform sampler3D strand_density;
+layout(binding = 11) uniform usampler3D strand_occupancy;
+
+void main() {
+    if (lod(object.level_of_detail, ivec2(gl_FragCoord.xy)) == 1.0f)
+        discard; // only raymarched here; no strands to reject.
+
+    float raycast_length = volume_bounds.radius;
+    vec3  raycast_start = fs_in.position.xyz;
+    vec3  raycast_direction = normalize(raycast_start - eye_position());
+    vec3  raycast_end = raycast_start + raycast_direction * raycast_length;
+
+    float opaque_strands = log(OPAQUE_TRANSMITTANCE) / log(1.0f - clamp(hair_alpha, 1e-3f, 0.999f));
+
+    float strands = 0.0f;
+    float step_size = 1.0f / raycast_steps;
+
+    for (float t = 0.0f; t < 1.0f; t += step_size) {
+        if (sphere_tracing == YES && skip_empty_space(raycast_start, raycast_end, t, step_size, 0.0f, volume_bounds.origin, volume_bounds.size))
+            continue;
+
+        if (skip_empty_brick(strand_occupancy, raycast_start, raycast_end, t, step_size, volume_bounds.origin, volume_bounds.size))
+            continue;
+
+        vec3 point = mix(raycast_start, raycast_end, t);
+        strands += sample_bricked_volume(strand_density, point,
+                                         volume_bounds.origin,
+                                         volume_bounds.size).r * 11.0f;
+
+        if (strands >= opaque_strands) {
+            vec4 projection = eye_view_projection() * vec4(mix(raycast_start, raycast_end, min(t + step_size, 1.0f)), 1.0f);
+            gl_FragDepth = projection.z / projection.w;
+            return;
+        }
+    }
+
+    discard;
+}
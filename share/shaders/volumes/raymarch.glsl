@@ -2,17 +2,22 @@
 #define VKHR_RAYMARCH_GLSL
 
 #include "sample_volume.glsl"
+#include "occupancy.glsl"
 
 // Simple raymarcher that samples the volume in equal-sized steps from the 'start' to the 'end' of the ray.
-vec4 raymarch(sampler3D volume, vec3 start, vec3 end, vec3 volume_origin, vec3 volume_size, uint samples) {
+// Samples that land in empty bricks of the 'occupancy' volume are skipped since they don't contribute.
+vec4 raymarch(sampler3D volume, usampler3D occupancy, vec3 start, vec3 end, vec3 volume_origin, vec3 volume_size, uint samples) {
     vec4 accumulator = vec4(0.0);
     float steps = 1.0f / samples;
 
     for (float t = 0.0f; t < 1.0f; t += steps) {
+        if (skip_empty_brick(occupancy, start, end, t, steps, volume_origin, volume_size))
+            continue;
+
         vec3 point = mix(start, end, t);
-        accumulator += sample_volume(volume, point,
-                                     volume_origin,
-                                     volume_size);
+        accumulator += sample_bricked_volume(volume, point,
+                                             volume_origin,
+                                             volume_size);
     }
 
     return accumulator;
@@ -2,15 +2,80 @@
 #define VKHR_SAMPLE_VOLUME_GLSL
 
 #include "../utils/math.glsl"
+#include "../strands/strand.glsl"
+#include "occupancy.glsl"
+
+// Density and tangents live in a pool of bricks of VOLUME_BRICK_SIZE^3 voxels with an apron of one
+// voxel, so that filtering inside a brick never reads from the next slot. Only bricks with strands
+// in them (or next to them) get a slot, see HairStyle::create_brick_pool. The first entries here are
+// the slot + 1 of each brick in the volume (zero when empty), followed by the brick of each slot.
+#define VOLUME_BRICK_APRON 1
+#define VOLUME_POOL_WIDTH 16
+
+layout(std430, binding = 29) readonly buffer VolumeBricks {
+    uint volume_bricks[];
+};
+
+ivec3 volume_brick_grid() {
+    return (ivec3(volume_resolution) + VOLUME_BRICK_SIZE - 1) / VOLUME_BRICK_SIZE;
+}
+
+// Where the slot's brick starts in the pool, including the apron.
+ivec3 volume_pool_offset(uint slot) {
+    ivec3 pool_brick = ivec3(slot % VOLUME_POOL_WIDTH,
+                             (slot / VOLUME_POOL_WIDTH) % VOLUME_POOL_WIDTH,
+                             slot / (VOLUME_POOL_WIDTH * VOLUME_POOL_WIDTH));
+    return pool_brick * (VOLUME_BRICK_SIZE + 2 * VOLUME_BRICK_APRON);
+}
 
 // Samples volume at 'volume_origin' with world dimensions 'volume_size' at the 'fragment_position'.
 vec4 sample_volume(sampler3D volume, vec3 fragment_position, vec3 volume_origin, vec3 volume_size) {
     return texture(volume, (fragment_position - volume_origin) / volume_size);
 }
 
+// Same as above, but through the brick indirection. Empty bricks read as zero without touching the pool.
+vec4 sample_bricked_volume(sampler3D pool, vec3 fragment_position, vec3 volume_origin, vec3 volume_size) {
+    vec3 voxel_position = (fragment_position - volume_origin) / volume_size * volume_resolution;
+    ivec3 bricks = volume_brick_grid();
+    ivec3 brick = ivec3(floor(voxel_position / VOLUME_BRICK_SIZE));
+
+    if (any(lessThan(brick, ivec3(0))) || any(greaterThanEqual(brick, bricks)))
+        return vec4(0.0f);
+
+    uint slot = volume_bricks[brick.x + brick.y * bricks.x + brick.z * bricks.x * bricks.y];
+
+    if (slot == 0u)
+        return vec4(0.0f);
+
+    vec3 pool_position = volume_pool_offset(slot - 1u) + VOLUME_BRICK_APRON +
+                         (voxel_position - brick * VOLUME_BRICK_SIZE);
+
+    return textureLod(pool, pool_position / textureSize(pool, 0), 0.0f);
+}
+
+// The mip chain from downsample_volume.comp starts at 1/4 of the resolution, so the levels
+// before it are sampled from the bricks at the full resolution (there's no 1/2 level).
+#define VOLUME_MIP_BASE 2.0f
+
+// Samples 'level' of the volume, in between the brick pool and its mip chain 'mips'.
+vec4 sample_volume_level(sampler3D pool, sampler3D mips, float level, vec3 fragment_position, vec3 volume_origin, vec3 volume_size) {
+    if (level < VOLUME_MIP_BASE)
+        return sample_bricked_volume(pool, fragment_position, volume_origin, volume_size);
+    return textureLod(mips, (fragment_position - volume_origin) / volume_size, level - VOLUME_MIP_BASE);
+}
+
+// Samples 'level' of the octahedral tangents, which are filtered before being decoded.
+vec3 sample_volume_tangent(sampler3D pool, sampler3D mips, float level, vec3 fragment_position, vec3 volume_origin, vec3 volume_size) {
+    return decode_volume_tangent(sample_volume_level(pool, mips, level, fragment_position, volume_origin, volume_size).xy);
+}
+
+// The occupancy is only dilated by a brick, and the filtering of the coarse levels reaches past it.
+bool volume_level_skips_bricks(float level) {
+    return level <= VOLUME_MIP_BASE + 1.0f;
+}
+
 // High-quality volume filter that takes the Gaussian of the local N*N*N neighborhood centered at 'fragment_position'.
 vec4 filter_volume(sampler3D volume, float kernel_width, vec3 fragment_position, vec3 volume_origin, vec3 volume_size) {
-    vec3 volume_resolution = textureSize(volume, 0);
     vec3 volume_space = (volume_size / volume_resolution);
 
     float kernel_range = (kernel_width - 1.0f) / 2.0f;
@@ -25,9 +90,9 @@ vec4 filter_volume(sampler3D volume, float kernel_width, vec3 fragment_position,
     for (float x = -kernel_range; x <= +kernel_range; x += 1.0f) {
         float exponent = -1.0f * (x*x + y*y + z*z) / 2.0f*sigma_squared;
         float local_weight = 1.0f / (2.0f*M_PI*sigma_squared) * pow(M_E, exponent);
-        density += sample_volume(volume,
-                                 fragment_position + vec3(x, y, z) * volume_space,
-                                 volume_origin, volume_size) * local_weight;
+        density += sample_bricked_volume(volume,
+                                         fragment_position + vec3(x, y, z) * volume_space,
+                                         volume_origin, volume_size) * local_weight;
         total_weight += local_weight;
     }
 
@@ -0,0 +1,196 @@
+#ifndef VKHR_SHADE_VOLUME_GLSL
+#define VKHR_SHADE_VOLUME_GLSL
+
+#include "../scene_graph/camera.glsl"
+#include "../scene_graph/lights.glsl"
+#include "../scene_graph/light_tiles.glsl"
+#include "../self-shadowing/approximate_deep_shadows.glsl"
+#include "../self-shadowing/transmittance_volume.glsl"
+#include "../shading/kajiya-kay.glsl"
+#include "../shading/marschner.glsl"
+#include "../shading/dual_scattering.glsl"
+
+#include "../level_of_detail/scheme.glsl"
+
+#include "../utils/rand.glsl"
+#include "../utils/heatmap.glsl"
+
+#include "raymarch.glsl"
+#include "sample_volume.glsl"
+#include "local_ambient_occlusion.glsl"
+#include "ambient_occlusion_volume.glsl"
+#include "volume_rendering.glsl"
+
+#include "../scene_graph/params.glsl"
+
+#include "volume.glsl"
+
+// Picks the level of the volume's mip chain where a voxel covers a step of the raymarch, or the pixel
+// it's seen in at its distance, whichever's larger (also see sample_volume_level for these levels).
+float volume_mip_level(vec3 raycast_start, float raycast_length, float steps) {
+    vec3 voxel_size = volume_bounds.size / volume_resolution;
+    float voxel_length = max(max(voxel_size.x, voxel_size.y), voxel_size.z);
+    float pixel_length = 2.0f * distance(eye_position(), raycast_start) / (camera.projection[1][1] * camera.hair_resolution.y);
+    return max(log2(max(pixel_length, raycast_length / steps) / voxel_length), 0.0f);
+}
+
+// Finds and shades the strand surface along the ray starting at the
+// volume's bounding box, with the alpha being zero if nothing's hit.
+// The surface depth is written to depth (with the [0, 1] NDC range).
+// When it's temporally accumulated, we take 4x fewer steps, but with
+// the ray start jittered every frame, so it converges to the same.
+// Far away, it's raymarched through the mip chains of the volumes,
+// with only as many steps as there are voxels in the level it uses,
+// or with adaptive_steps, with steps as large as a pixel's footprint.
+// Only the lights in the light_mask are shaded, see light_tiles.glsl.
+vec4 shade_volume(sampler3D strand_density, sampler3D strand_tangent, usampler3D strand_occupancy,
+                  sampler3D strand_occlusion, sampler3D density_mips, sampler3D tangent_mips,
+                  vec3 raycast_start, float depth_buffer, bool temporal, uint light_mask,
+                  out float depth, out vec3 surface) {
+    float raycast_length = volume_bounds.radius;
+    vec3  raycast_direction = normalize(raycast_start - eye_position());
+    vec3  raycast_end    = raycast_start + raycast_direction * raycast_length;
+
+    float steps = raycast_steps;
+    float level = 0.0f;
+    float step_weight = 1.0f;
+
+    // How much a pixel's footprint grows per unit of distance from the eye (see volume_mip_level).
+    float step_spread = 0.0f;
+    if (adaptive_steps == YES)
+        step_spread = 2.0f / (camera.projection[1][1] * camera.hair_resolution.y);
+
+    if (raymarch_mips == YES) {
+        level = volume_mip_level(raycast_start, raycast_length, steps);
+        if (level >= VOLUME_MIP_BASE && adaptive_steps != YES) {
+            vec3 voxel_size = volume_bounds.size / volume_resolution * exp2(floor(level));
+            float reduced_steps = clamp(raycast_length / max(max(voxel_size.x, voxel_size.y), voxel_size.z), 1.0f, steps);
+            step_weight = steps / reduced_steps;
+            steps = reduced_steps;
+        }
+    }
+
+    if (temporal) {
+        steps = max(raycast_steps / 4.0f, 1.0f);
+        float jitter = rand(gl_FragCoord.xy + float(camera.frame_number % 1024u));
+        raycast_start += raycast_direction * raycast_length * jitter / steps;
+    }
+
+    // Past this, the coverage below is saturated, so the raymarch can stop there.
+    float coverage_scale = (lod_dithered() ? 1.0f : lod(object.level_of_detail)) * hair_alpha;
+    float saturated_density = isosurface / max(coverage_scale, 1e-6f);
+
+    vec4 surface_position = volume_surface(strand_density, density_mips, level,
+                                           strand_occupancy,
+                                           raycast_start, raycast_end,
+                                           steps, step_weight, step_spread,
+                                           isosurface, saturated_density,
+                                           volume_bounds.origin,
+                                           volume_bounds.size,
+                                           depth_buffer);
+
+    depth = 1.0f;
+    surface = surface_position.xyz;
+
+    // Opaque, and where the ray enters the volume, so every pixel that's raymarched shows it.
+    if (cost_view == RAYMARCH_COST_VIEW) {
+        vec4 entry = eye_view_projection() * vec4(raycast_start, 1.0f);
+        depth = entry.z / entry.w;
+        surface = raycast_start;
+        return vec4(heatmap(volume_surface_steps, cost_view_range), 1.0f);
+    }
+
+    if (surface_position.a == 0.0f)
+        return vec4(0.0f);
+
+    float coverage = min(coverage_scale * surface_position.a, 1.0f);
+
+    vec3 eye_direction = normalize(surface_position.xyz - eye_position());
+
+    vec3 surface_tangent = sample_volume_tangent(strand_tangent, tangent_mips, level,
+                                                 surface_position.xyz,
+                                                 volume_bounds.origin,
+                                                 volume_bounds.size);
+
+    // With a shadow ray each (or the transmittance for lights[0]), and the other shading models just show lights[0].
+    if (shading_model != KAJIYA_KAY)
+        light_mask = 1u;
+
+    vec3 shading = vec3(0.0);
+
+    for (uint i = 0; i < lights_size; ++i) {
+        if (!light_in_tile(light_mask, i))
+            continue;
+
+        vec3 light_direction = normalize(lights[i].origin - surface_position.xyz);
+        vec3 light_bulb_intensity = lights[i].intensity * light_attenuation(lights[i], surface_position.xyz);
+
+        vec3 light_shading = vec3(1.0);
+
+        // It's shaded after the self-shadowing below instead, since that's where the strands in the way are from.
+        bool dual_scattered = shading_model == KAJIYA_KAY && dual_scattering_on == YES;
+
+        if (shading_model == KAJIYA_KAY && marschner_shading == YES && !dual_scattered) {
+            light_shading = marschner(hair_color, light_bulb_intensity,
+                                      surface_tangent, light_direction, eye_direction);
+        } else if (shading_model == KAJIYA_KAY && !dual_scattered) {
+            light_shading = kajiya_kay(hair_color, light_bulb_intensity, hair_exponent,
+                                       surface_tangent, light_direction, eye_direction);
+        }
+
+        if (deep_shadows_on == YES && shading_model != LAO && shadow_technique == TRANSMITTANCE_VOLUME && i == 0) {
+            light_shading *= transmittance_volume(surface_position.xyz,
+                                                  volume_bounds.origin,
+                                                  volume_bounds.size);
+        } else if (deep_shadows_on == YES && shading_model != LAO) {
+            light_shading *= volume_approximated_deep_shadows(strand_density, density_mips, level,
+                                                              strand_occupancy,
+                                                              surface_position.xyz,
+                                                              lights[i].origin,
+                                                              steps, hair_alpha,
+                                                              volume_bounds.origin,
+                                                              volume_bounds.size,
+                                                              11.0f * step_weight);
+        }
+
+        if (dual_scattered) {
+            light_shading = dual_scattering(hair_color, light_bulb_intensity,
+                                            surface_tangent, light_direction, eye_direction,
+                                            light_shading.r, hair_alpha,
+                                            radians(marschner_shift), radians(marschner_width));
+        }
+
+        shading += light_shading;
+    }
+
+    float occlusion = 1.000f;
+
+    if (shading_model != ADSM) {
+        if (has_baked_ambient_occlusion(strand_occlusion)) {
+            occlusion *= baked_ambient_occlusion(strand_occlusion,
+                                                 surface_position.xyz,
+                                                 volume_bounds.origin,
+                                                 volume_bounds.size,
+                                                 ao_exponent);
+        } else if (ao_volume == YES) {
+            occlusion *= ambient_occlusion_volume(surface_position.xyz,
+                                                  volume_bounds.origin,
+                                                  volume_bounds.size,
+                                                  ao_exponent);
+        } else {
+            occlusion *= local_ambient_occlusion(strand_density,
+                                                 surface_position.xyz,
+                                                 volume_bounds.origin,
+                                                 volume_bounds.size,
+                                                 2, occlusion_radius,
+                                                 ao_exponent, ao_max);
+        }
+    }
+
+    vec4 surface = eye_view_projection() * vec4(surface_position.xyz, 1.0f);
+    depth = surface.z / surface.w;
+
+    return vec4(shading * occlusion, coverage);
+}
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef VKHR_TEMPORAL_ACCUMULATION_GLSL
+#define VKHR_TEMPORAL_ACCUMULATION_GLSL
+
+#include "../self-shadowing/linearize_depth.glsl"
+
+// Weight of the current frame in the exponential moving average.
+#define TEMPORAL_BLEND_FACTOR 0.1f
+// Relative (linear) depth difference that's still the same surface.
+#define TEMPORAL_DEPTH_TOLERANCE 0.05f
+
+// Finds where the surface was on the screen in the previous frame,
+// returns false if it was outside of it (so nothing to accumulate).
+bool reproject(vec3 surface, mat4 previous_view_projection, vec2 resolution,
+               out ivec2 previous_pixel, out float previous_depth) {
+    vec4 previous = previous_view_projection * vec4(surface, 1.0f);
+    vec3 previous_ndc = previous.xyz / previous.w;
+
+    previous_pixel = ivec2((previous_ndc.xy * 0.5f + 0.5f) * resolution);
+    previous_depth = previous_ndc.z;
+
+    return previous.w > 0.0f && all(greaterThanEqual(previous_pixel, ivec2(0))) &&
+                                all(lessThan(previous_pixel, ivec2(resolution)));
+}
+
+// Blends the history (with its depth in alpha) if it's the same surface as before.
+vec3 accumulate(vec3 color, vec4 history, float previous_depth, float near, float far) {
+    float history_depth  = linearize_depth(history.a,      near, far);
+    float expected_depth = linearize_depth(previous_depth, near, far);
+
+    if (history.a >= 1.0f || abs(history_depth - expected_depth) > TEMPORAL_DEPTH_TOLERANCE * expected_depth)
+        return color; // disoccluded or something else was in the history.
+
+    return mix(history.rgb, color, TEMPORAL_BLEND_FACTOR);
+}
+
+#endif
@@ -0,0 +1,47 @@
+#version 460 core
+
+#include "../scene_graph/camera.glsl"
+
+#include "../transparency/ppll.glsl"
+
+#include "upsample.glsl"
+
+layout(location = 0) in PipelineIn {
+    vec2 texcoord;
+} fs_in;
+
+layout(input_attachment_index = 1, binding = 9) uniform subpassInput depth_buffer;
+
+layout(binding = 12) uniform sampler2D half_volume_color;
+layout(binding = 13) uniform sampler2D half_volume_depth;
+layout(binding = 14) uniform sampler2D quarter_volume_color;
+layout(binding = 15) uniform sampler2D quarter_volume_depth;
+
+void insert_fragment(vec4 color, float depth) {
+    if (color.a == 0.0f)
+        return;
+
+    uint node = ppll_next_node();
+    if (node == PPLL_NULL_NODE) return;
+    ppll_node_data(node, color, depth);
+    ppll_link_node(ivec2(gl_FragCoord.xy), node);
+}
+
+void main() {
+    float depth_buffer = subpassLoad(depth_buffer).r;
+
+    float half_depth, quarter_depth;
+
+    vec4 half_color    = upsample_volume(half_volume_color,    half_volume_depth,
+                                         fs_in.texcoord, depth_buffer,
+                                         camera.near, camera.far, half_depth);
+    vec4 quarter_color = upsample_volume(quarter_volume_color, quarter_volume_depth,
+                                         fs_in.texcoord, depth_buffer,
+                                         camera.near, camera.far, quarter_depth);
+
+    // Both are sorted with the rest in the PPLL.
+    insert_fragment(half_color,    half_depth);
+    insert_fragment(quarter_color, quarter_depth);
+
+    discard; // Fragments resolved in next pass.
+}
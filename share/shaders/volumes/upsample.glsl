@@ -0,0 +1,61 @@
+#ifndef VKHR_UPSAMPLE_GLSL
+#define VKHR_UPSAMPLE_GLSL
+
+#include "../self-shadowing/linearize_depth.glsl"
+
+// Joint bilateral upsampling of a reduced resolution raymarch: we
+// weight the 2x2 closest taps by bilinear weights, but drop a tap
+// if it's behind the full resolution depth (i.e. it's occluded by
+// some mesh or strand) and penalize taps that are far away in the
+// depth from the closest one. This keeps silhouettes from bleeding.
+vec4 upsample_volume(sampler2D volume_color, sampler2D volume_depth, vec2 texcoord,
+                     float depth_buffer, float near, float far, out float depth) {
+    vec2 volume_size = textureSize(volume_color, 0);
+    vec2 sample_position = texcoord * volume_size - 0.5f;
+    ivec2 base_texel = ivec2(floor(sample_position));
+    vec2  bilinear = fract(sample_position);
+
+    ivec2 clamp_texel = ivec2(volume_size) - 1;
+
+    vec4  tap_color[4];
+    float tap_depth[4];
+    float tap_weight[4];
+
+    float nearest_depth = 1.0f;
+
+    for (int i = 0; i < 4; ++i) {
+        ivec2 offset = ivec2(i & 1, i >> 1);
+        ivec2 texel  = clamp(base_texel + offset, ivec2(0), clamp_texel);
+
+        tap_color[i] = texelFetch(volume_color, texel, 0);
+        tap_depth[i] = texelFetch(volume_depth, texel, 0).r;
+
+        vec2 weight = mix(1.0f - bilinear, bilinear, vec2(offset));
+        tap_weight[i] = weight.x * weight.y;
+
+        if (tap_color[i].a == 0.0f || tap_depth[i] >= depth_buffer)
+            tap_weight[i] = 0.0f;
+        else nearest_depth = min(nearest_depth, tap_depth[i]);
+    }
+
+    depth = nearest_depth;
+
+    float reference_depth = linearize_depth(nearest_depth, near, far);
+
+    vec4  color = vec4(0.0f);
+    float total = 0.0f;
+
+    for (int i = 0; i < 4; ++i) {
+        float depth_difference = abs(linearize_depth(tap_depth[i], near, far) - reference_depth);
+        float weight = tap_weight[i] / (depth_difference + 1e-3f);
+        color += tap_color[i] * weight;
+        total += weight;
+    }
+
+    if (total == 0.0f)
+        return vec4(0.0f);
+
+    return color / total;
+}
+
+#endif
@@ -0,0 +1,15 @@
+#version 460 core
+
+layout(location = 0) out PipelineOut {
+    vec2 texcoord;
+} vs_out;
+
+// Fullscreen triangle, without needing any vertex buffers bound.
+
+void main() {
+    vec2 texcoord = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+
+    vs_out.texcoord = texcoord;
+
+    gl_Position = vec4(texcoord * 2.0f - 1.0f, 0.0f, 1.0f);
+}
@@ -3,4 +3,10 @@
 
 #include "../strands/strand.glsl"
 
+// The node the volume is raymarched for, see Rasterizer::strand_dvr.
+layout(push_constant) uniform Object {
+    mat4 model;
+    float level_of_detail;
+} object;
+
 #endif
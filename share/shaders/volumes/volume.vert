@@ -6,10 +6,6 @@
 
 layout(location = 0) in vec3 position;
 
-layout(push_constant) uniform Object {
-    mat4 model;
-} object;
-
 layout(location = 0) out PipelineOut {
     vec4 position;
 } vs_out;
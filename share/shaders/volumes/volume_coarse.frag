@@ -0,0 +1,7 @@
+#version 460 core
+
+#extension GL_NV_shading_rate_image : require
+
+#define SHADING_RATE_IMAGE
+
+#include "volume_fragment.glsl"
@@ -0,0 +1,84 @@
+#ifndef VKHR_VOLUME_FRAGMENT_GLSL
+#define VKHR_VOLUME_FRAGMENT_GLSL
+
+// Shared by volume.frag and volume_coarse.frag, which is the same with coarse fragments.
+
+#include "../transparency/ppll.glsl"
+#include "../variable_rate_shading/coarse_fragment.glsl"
+
+#include "shade_volume.glsl"
+#include "temporal_accumulation.glsl"
+
+layout(location = 0) in PipelineIn {
+    vec4 position;
+} fs_in;
+
+layout(binding = 3)  uniform sampler3D strand_density;
+layout(binding = 10) uniform sampler3D strand_tangent;
+layout(binding = 11) uniform usampler3D strand_occupancy;
+layout(binding = 16) uniform sampler3D strand_occlusion;
+layout(binding = 30) uniform sampler3D strand_density_mips;
+layout(binding = 31) uniform sampler3D strand_tangent_mips;
+
+layout(input_attachment_index = 1, binding = 9) uniform subpassInput depth_buffer;
+
+// Shaded volume (with the depth in alpha) in last frame and this frame.
+layout(binding = 12, rgba32f) uniform readonly  image2D previous_history;
+layout(binding = 13, rgba32f) uniform writeonly image2D current_history;
+
+layout(location = 0) out vec4 color;
+
+void main() {
+    if (lod(object.level_of_detail, ivec2(gl_FragCoord.xy)) == 0.0f)
+        discard; // e.g. rasterized here, see lod_dithered.
+
+    float depth_buffer = subpassLoad(depth_buffer).r;
+
+    float depth;
+    vec3  surface;
+
+    bool temporal = temporal_accumulation == YES;
+
+    color = shade_volume(strand_density, strand_tangent, strand_occupancy,
+                         strand_occlusion, strand_density_mips, strand_tangent_mips,
+                         fs_in.position.xyz, depth_buffer, temporal,
+                         light_tile_mask(ivec2(gl_FragCoord.xy)),
+                         depth, surface);
+
+    if (color.a == 0.0f)
+        discard;
+
+    if (temporal) {
+        ivec2 previous_pixel;
+        float previous_depth;
+
+        if (reproject(surface, camera.previous_view_projection, camera.hair_resolution, previous_pixel, previous_depth)) {
+            color.rgb = accumulate(color.rgb, imageLoad(previous_history, previous_pixel),
+                                   previous_depth, camera.near, camera.far);
+        }
+    }
+
+    // Every pixel of it if it's coarse, see coarse_fragment.glsl.
+    ivec2 origin = coarse_fragment_origin();
+    ivec2 size = coarse_fragment_size();
+
+    for (int y = 0; y < size.y; ++y)
+    for (int x = 0; x < size.x; ++x) {
+        if (!coarse_fragment_covers(ivec2(x, y)))
+            continue;
+
+        ivec2 pixel = origin + ivec2(x, y);
+
+        if (temporal)
+            imageStore(current_history, pixel, vec4(color.rgb, depth));
+
+        uint node = ppll_next_node();
+        if (node == PPLL_NULL_NODE) continue;
+        ppll_node_data(node, color, depth);
+        ppll_link_node(pixel, node);
+    }
+
+    discard; // Fragments resolved in next pass.
+}
+
+#endif
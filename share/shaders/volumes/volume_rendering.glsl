@@ -2,38 +2,77 @@
 #define VKHR_VOLUME_RENDERING_GLSL
 
 #include "sample_volume.glsl"
+#include "occupancy.glsl"
+#include "distance_field.glsl"
 
 // Find the normal of the surface at 'position' by taking the finite difference of a point.
 vec3 volume_normal(sampler3D volume, vec3 position, vec3 volume_origin, vec3 volume_size) {
-    vec3 epsilon = volume_size / textureSize(volume, 0);
-    float dx = sample_volume(volume, position + vec3(epsilon.x, 0, 0), volume_origin, volume_size).r -
-               sample_volume(volume, position - vec3(epsilon.x, 0, 0), volume_origin, volume_size).r;
-    float dy = sample_volume(volume, position + vec3(0, epsilon.y, 0), volume_origin, volume_size).r -
-               sample_volume(volume, position - vec3(0, epsilon.y, 0), volume_origin, volume_size).r;
-    float dz = sample_volume(volume, position + vec3(0, 0, epsilon.z), volume_origin, volume_size).r -
-               sample_volume(volume, position - vec3(0, 0, epsilon.z), volume_origin, volume_size).r;
+    vec3 epsilon = volume_size / volume_resolution;
+    float dx = sample_bricked_volume(volume, position + vec3(epsilon.x, 0, 0), volume_origin, volume_size).r -
+               sample_bricked_volume(volume, position - vec3(epsilon.x, 0, 0), volume_origin, volume_size).r;
+    float dy = sample_bricked_volume(volume, position + vec3(0, epsilon.y, 0), volume_origin, volume_size).r -
+               sample_bricked_volume(volume, position - vec3(0, epsilon.y, 0), volume_origin, volume_size).r;
+    float dz = sample_bricked_volume(volume, position + vec3(0, 0, epsilon.z), volume_origin, volume_size).r -
+               sample_bricked_volume(volume, position - vec3(0, 0, epsilon.z), volume_origin, volume_size).r;
     return -normalize(vec3(dx, dy, dz)); // the normals!
 }
 
+// The steps the last volume_surface took, skipped or not, for the RAYMARCH_COST_VIEW.
+float volume_surface_steps = 0.0f;
+
 // Finds the isosurface of a volume with at least 'surface_density' starting from 'volume_start' to 'volume_end' when it has been sampled 'step' times.
-vec4 volume_surface(sampler3D volume, vec3 volume_start, vec3 volume_end, float steps, float surface_density, vec3 volume_origin, vec3 volume_size, float depth_buffer) {
+// Steps inside the empty bricks of 'occupancy' are skipped, since they don't change the accumulated density anyway, and so are the ones that are too
+// far from the strands with sphere_tracing (see skip_empty_space). The samples are taken from the 'volume_level' of the volume and its 'volume_mips'
+// (see sample_volume_level), and weighted by 'step_weight' if fewer steps are taken because of it. With a 'step_spread', the steps grow to the size
+// of a pixel at their distance from the eye, which is 'step_spread' times it, so 'steps' is the most that are taken (and with raymarch_mips, they're
+// sampled from the level of their own size). It stops once the surface is found and 'saturated_density' is reached, since the coverage is clamped.
+vec4 volume_surface(sampler3D volume, sampler3D volume_mips, float volume_level, usampler3D occupancy, vec3 volume_start, vec3 volume_end, float steps, float step_weight,
+                    float step_spread, float surface_density, float saturated_density, vec3 volume_origin, vec3 volume_size, float depth_buffer) {
     float accumulated_density = 0.0f;
     float step_size = (1.0f / steps);
+    bool skip_bricks = volume_level_skips_bricks(volume_level);
+
+    float ray_length = max(distance(volume_start, volume_end), 1e-5f);
+    float start_distance = distance(eye_position(), volume_start) / ray_length; // in units of 't'.
+
+    vec3 voxel_size = volume_size / volume_resolution;
+    float voxel_length = max(max(voxel_size.x, voxel_size.y), voxel_size.z);
+
+    float step_length = step_size;
+    float level = volume_level;
+
+    volume_surface_steps = 0.0f;
 
     vec3 surface_point = vec3(0.0f);
     bool surface_point_found = false;
     bool entry_point_found   = false;
     vec3 entry_point   = vec3(0.0f);
 
-    for (float t = 0.0f; t < 1.0f; t += step_size) {
+    for (float t = 0.0f; t < 1.0f; t += step_length) {
+        if (step_spread > 0.0f) {
+            step_length = max(step_size, step_spread * (start_distance + t));
+            if (raymarch_mips == YES) {
+                level = max(volume_level, log2(step_length * ray_length / voxel_length));
+                skip_bricks = volume_level_skips_bricks(level);
+            }
+        }
+
+        volume_surface_steps += 1.0f;
+
         vec3 P = mix(volume_start, volume_end, t);
-        vec4 projection = camera.projection * camera.view * vec4(P, 1.0f);
+        vec4 projection = eye_view_projection() * vec4(P, 1.0f);
         float depth = projection.z / projection.w;
 
         if (depth_buffer < depth)
             break;
 
-        float density = sample_volume(volume, P, volume_origin, volume_size).r;
+        if (sphere_tracing == YES && skip_empty_space(volume_start, volume_end, t, step_length, level, volume_origin, volume_size))
+            continue;
+
+        if (skip_bricks && skip_empty_brick(occupancy, volume_start, volume_end, t, step_length, volume_origin, volume_size))
+            continue;
+
+        float density = sample_volume_level(volume, volume_mips, level, P, volume_origin, volume_size).r * step_weight * (step_length / step_size);
         accumulated_density += density; // total amount of screen-space density
 
         if (density != 0.0f) {
@@ -44,6 +83,9 @@ vec4 volume_surface(sampler3D volume, vec3 volume_start, vec3 volume_end, float
                 entry_point_found = true;
             }
         }
+
+        if (surface_point_found && accumulated_density >= saturated_density)
+            break; // nothing after this changes the surface or its coverage.
     }
 
     if (!surface_point_found && entry_point_found)
@@ -0,0 +1,37 @@
+#version 460 core
+
+#include "shade_volume.glsl"
+
+layout(location = 0) in PipelineIn {
+    vec4 position;
+} fs_in;
+
+layout(binding = 3)  uniform sampler3D strand_density;
+layout(binding = 10) uniform sampler3D strand_tangent;
+layout(binding = 11) uniform usampler3D strand_occupancy;
+layout(binding = 16) uniform sampler3D strand_occlusion;
+layout(binding = 30) uniform sampler3D strand_density_mips;
+layout(binding = 31) uniform sampler3D strand_tangent_mips;
+
+layout(location = 0) out vec4 color;
+
+// Same as volume.frag, but into a reduced resolution target,
+// that is upsampled to the framebuffer later in upsample.frag.
+// There's no depth buffer to terminate rays at yet, so instead
+// we write the surface depth, and reject occluded ones later.
+
+void main() {
+    float depth;
+    vec3  surface;
+
+    color = shade_volume(strand_density, strand_tangent, strand_occupancy,
+                         strand_occlusion, strand_density_mips, strand_tangent_mips,
+                         fs_in.position.xyz, 1.0f, false,
+                         ~0u, // since the pixels here aren't the ones of the light tiles.
+                         depth, surface);
+
+    if (color.a == 0.0f)
+        discard;
+
+    gl_FragDepth = depth;
+}
@@ -0,0 +1,53 @@
+#version 460 core
+
+#extension GL_EXT_multiview : require
+
+#define STEREO
+
+#include "../transparency/ppll.glsl"
+
+#include "shade_volume.glsl"
+
+layout(location = 0) in PipelineIn {
+    vec4 position;
+} fs_in;
+
+layout(binding = 3)  uniform sampler3D strand_density;
+layout(binding = 10) uniform sampler3D strand_tangent;
+layout(binding = 11) uniform usampler3D strand_occupancy;
+layout(binding = 16) uniform sampler3D strand_occlusion;
+layout(binding = 30) uniform sampler3D strand_density_mips;
+layout(binding = 31) uniform sampler3D strand_tangent_mips;
+
+// Of the eye's own layer, see vulkan::StereoTarget.
+layout(input_attachment_index = 1, binding = 9) uniform subpassInput depth_buffer;
+
+layout(location = 0) out vec4 color;
+
+// Same as volume.frag, but for both eyes in one go, and without the temporal
+// accumulation, since there's only the one history, see use_stereo_paths.
+void main() {
+    if (lod(object.level_of_detail, ivec2(gl_FragCoord.xy)) == 0.0f)
+        discard; // e.g. rasterized here, see lod_dithered.
+
+    float depth_buffer = subpassLoad(depth_buffer).r;
+
+    float depth;
+    vec3  surface;
+
+    color = shade_volume(strand_density, strand_tangent, strand_occupancy,
+                         strand_occlusion, strand_density_mips, strand_tangent_mips,
+                         fs_in.position.xyz, depth_buffer, false,
+                         light_tile_mask(ivec2(gl_FragCoord.xy)),
+                         depth, surface);
+
+    if (color.a == 0.0f)
+        discard;
+
+    uint node = ppll_next_node();
+    if (node == PPLL_NULL_NODE) discard;
+    ppll_node_data(node, color, depth);
+    ppll_link_node(eye_pixel(ivec2(gl_FragCoord.xy)), node);
+
+    discard; // Fragments resolved in next pass.
+}
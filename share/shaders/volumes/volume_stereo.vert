@@ -0,0 +1,24 @@
+#version 460 core
+
+#extension GL_EXT_multiview : require
+
+#define STEREO
+
+#include "../scene_graph/camera.glsl"
+
+#include "volume.glsl"
+
+layout(location = 0) in vec3 position;
+
+layout(location = 0) out PipelineOut {
+    vec4 position;
+} vs_out;
+
+// Same as volume.vert, but for both eyes in one go.
+void main() {
+    vec4 world_position = object.model * vec4(position, 1.0f);
+
+    vs_out.position = world_position;
+
+    gl_Position = eye_view_projection() * world_position;
+}
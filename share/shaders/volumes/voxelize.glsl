@@ -0,0 +1,49 @@
+#ifndef VKHR_VOXELIZE_GLSL
+#define VKHR_VOXELIZE_GLSL
+
+// Two words per voxel, the first has the sample count in the low 16 bits
+// and the z tangent sum in the high ones, and the second one has x and y.
+// Tangents are biased to [0, 254] so that 255 samples fit in 16 bits each.
+layout(std430, binding = 5) coherent buffer Voxels {
+    uint voxels[];
+};
+
+layout(std430, binding = 6) coherent buffer VoxelStatistics {
+    uint voxel_max_density;
+};
+
+#define VOXEL_MAX_DENSITY 255u
+
+uvec3 encode_voxel_tangent(vec3 tangent) {
+    return uvec3(round(clamp(tangent, -1.0f, +1.0f) * 127.0f) + 127.0f);
+}
+
+// Returns the new density of the voxel, or zero if it was already saturated.
+uint add_voxel_sample(uint voxel, uvec3 tangent) {
+    uint sample_word = 1u | (tangent.z << 16);
+    uint previous = atomicAdd(voxels[2*voxel + 0], sample_word);
+
+    if ((previous & 0xFFFFu) >= VOXEL_MAX_DENSITY) {
+        atomicAdd(voxels[2*voxel + 0], 0u - sample_word);
+        return 0u; // Undo it, the counters are modular.
+    }
+
+    atomicAdd(voxels[2*voxel + 1], tangent.x | (tangent.y << 16));
+
+    return (previous & 0xFFFFu) + 1u;
+}
+
+uint load_voxel_density(uint voxel) {
+    return voxels[2*voxel + 0] & 0xFFFFu;
+}
+
+vec3 load_voxel_tangent(uint voxel) {
+    uint density = load_voxel_density(voxel);
+    if (density == 0u) return vec3(0.0f);
+    uvec3 tangent_sum = uvec3(voxels[2*voxel + 1] & 0xFFFFu,
+                              voxels[2*voxel + 1] >> 16,
+                              voxels[2*voxel + 0] >> 16);
+    return (vec3(tangent_sum) / float(density) - 127.0f) / 127.0f;
+}
+
+#endif
@@ -0,0 +1,304 @@
+#include <vkhr/paths.hh>
+#include <vkhr/image.hh>
+
+#include <vkhr/scene_graph.hh>
+#include <vkhr/ray_tracer.hh>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Micro-benchmarks of the CPU side of the hair processing, in the spirit of
+// Google Benchmark but without the dependency: each one is run over all the
+// styles in share/styles, repeating the timed region until it has taken at
+// least MinimumTime, and reports the time per iteration, per segment and the
+// rate over the bytes it touched. Run with a filter (a substring), e.g.
+// bin/vkhr-benchmarks voxelize, to only run the benchmarks matching it.
+
+class BenchmarkState {
+public:
+    // Keeps going until the timed region took long enough to be stable.
+    bool keep_running() {
+        if (iterations == 0) {
+            start_time = std::chrono::steady_clock::now();
+        } else if (elapsed_time() >= MinimumTime || iterations >= MaximumIterations) {
+            pause_timing();
+            return false;
+        }
+
+        ++iterations;
+        return true;
+    }
+
+    // For e.g. restoring the input between iterations, which isn't timed.
+    void pause_timing() {
+        elapsed += std::chrono::steady_clock::now() - start_time;
+        paused = true;
+    }
+
+    void resume_timing() {
+        start_time = std::chrono::steady_clock::now();
+        paused = false;
+    }
+
+    double get_nanoseconds() const {
+        return std::chrono::duration<double, std::nano> { elapsed }.count() / iterations;
+    }
+
+    std::size_t get_iterations() const { return iterations; }
+
+    void set_items_processed(std::size_t items) { items_processed = items; }
+    void set_bytes_processed(std::size_t bytes) { bytes_processed = bytes; }
+
+    std::size_t get_items_processed() const { return items_processed; }
+    std::size_t get_bytes_processed() const { return bytes_processed; }
+
+    static constexpr double      MinimumTime       { 0.5 }; // s
+    static constexpr std::size_t MaximumIterations { 1000000 };
+
+private:
+    double elapsed_time() const {
+        auto total = elapsed;
+        if (!paused) total += std::chrono::steady_clock::now() - start_time;
+        return std::chrono::duration<double> { total }.count();
+    }
+
+    std::size_t iterations { 0 };
+    std::chrono::steady_clock::time_point  start_time;
+    std::chrono::steady_clock::duration    elapsed { 0 };
+    bool paused { false };
+
+    std::size_t items_processed { 0 }; // per iteration.
+    std::size_t bytes_processed { 0 };
+};
+
+// The style is loaded (and prepared) once, and given to each benchmark as is.
+struct Benchmark {
+    std::string name;
+    std::function<void(BenchmarkState&, const std::string&, const vkhr::HairStyle&)> function;
+};
+
+static std::size_t get_style_bytes(const vkhr::HairStyle& hair_style) {
+    return hair_style.get_vertex_count() * sizeof(glm::vec3);
+}
+
+static void load(BenchmarkState& state, const std::string& style_path, const vkhr::HairStyle& hair_style) {
+    vkhr::HairStyle loaded_style;
+    while (state.keep_running())
+        loaded_style.load(style_path);
+    state.set_items_processed(hair_style.get_segment_count());
+    state.set_bytes_processed(std::filesystem::file_size(style_path));
+}
+
+static void generate_tangents(BenchmarkState& state, const std::string&, const vkhr::HairStyle& hair_style) {
+    auto style_copy = hair_style;
+    while (state.keep_running())
+        style_copy.generate_tangents();
+    state.set_items_processed(hair_style.get_segment_count());
+    state.set_bytes_processed(get_style_bytes(hair_style) * 2); // vertices in, tangents out.
+}
+
+static void generate_indices(BenchmarkState& state, const std::string&, const vkhr::HairStyle& hair_style) {
+    auto style_copy = hair_style;
+    while (state.keep_running())
+        style_copy.generate_indices();
+    state.set_items_processed(hair_style.get_segment_count());
+    state.set_bytes_processed(hair_style.get_segment_count() * 2 * sizeof(unsigned));
+}
+
+static void voxelize_segments(BenchmarkState& state, const std::string&, const vkhr::HairStyle& hair_style) {
+    vkhr::HairStyle::Volume volume;
+    while (state.keep_running())
+        hair_style.voxelize_segments(volume, 256, 256, 256);
+    state.set_items_processed(hair_style.get_segment_count());
+    state.set_bytes_processed(get_style_bytes(hair_style) * 2 + volume.densities.size());
+}
+
+static void voxelize_segments_bricked(BenchmarkState& state, const std::string&, const vkhr::HairStyle& hair_style) {
+    vkhr::HairStyle::Volume volume;
+    while (state.keep_running())
+        hair_style.voxelize_segments(volume, 256, 256, 256, vkhr::HairStyle::Volume::Layout::Bricked);
+    state.set_items_processed(hair_style.get_segment_count());
+    state.set_bytes_processed(get_style_bytes(hair_style) * 2 + volume.densities.size());
+}
+
+static void voxelize_vertices(BenchmarkState& state, const std::string&, const vkhr::HairStyle& hair_style) {
+    vkhr::HairStyle::Volume volume;
+    while (state.keep_running())
+        volume = hair_style.voxelize_vertices(256, 256, 256);
+    state.set_items_processed(hair_style.get_segment_count());
+    state.set_bytes_processed(get_style_bytes(hair_style) + volume.densities.size());
+}
+
+static void normalize_volume(BenchmarkState& state, const std::string&, const vkhr::HairStyle& hair_style) {
+    auto voxelized = hair_style.voxelize_segments(256, 256, 256);
+    auto volume = voxelized;
+    while (state.keep_running()) {
+        volume.normalize();
+        state.pause_timing();
+        volume.densities = voxelized.densities;
+        state.resume_timing();
+    }
+
+    state.set_items_processed(hair_style.get_segment_count());
+    state.set_bytes_processed(volume.densities.size());
+}
+
+static void downsample_volume(BenchmarkState& state, const std::string&, const vkhr::HairStyle& hair_style) {
+    auto volume = hair_style.voxelize_segments(256, 256, 256);
+    while (state.keep_running()) {
+        volume.downsample([](const std::array<unsigned char, 8>& neighborhood) {
+            return *std::max_element(neighborhood.begin(), neighborhood.end());
+        });
+    }
+
+    state.set_items_processed(hair_style.get_segment_count());
+    state.set_bytes_processed(volume.densities.size() + volume.densities.size() / 8);
+}
+
+// Bricked and back, i.e. what an upload of a voxelized one costs.
+static void swizzle_volume(BenchmarkState& state, const std::string&, const vkhr::HairStyle& hair_style) {
+    auto volume = hair_style.voxelize_segments(256, 256, 256, vkhr::HairStyle::Volume::Layout::Bricked);
+    while (state.keep_running()) {
+        volume.set_layout(vkhr::HairStyle::Volume::Layout::Linear);
+        volume.set_layout(vkhr::HairStyle::Volume::Layout::Bricked);
+    }
+
+    state.set_items_processed(hair_style.get_segment_count());
+    state.set_bytes_processed((volume.densities.size() + volume.tangents.size() * sizeof(volume.tangents[0])) * 4);
+}
+
+static void reduce(BenchmarkState& state, const std::string&, const vkhr::HairStyle& hair_style) {
+    vkhr::HairStyle style_copy;
+    while (state.keep_running()) {
+        state.pause_timing();
+        style_copy = hair_style;
+        state.resume_timing();
+        style_copy.reduce(0.5f);
+    }
+
+    state.set_items_processed(hair_style.get_segment_count());
+    state.set_bytes_processed(hair_style.get_size());
+}
+
+static void generate_clusters(BenchmarkState& state, const std::string&, const vkhr::HairStyle& hair_style) {
+    vkhr::HairStyle style_copy;
+    while (state.keep_running()) {
+        state.pause_timing();
+        style_copy = hair_style;
+        state.resume_timing();
+        style_copy.generate_clusters();
+    }
+
+    state.set_items_processed(hair_style.get_segment_count());
+    state.set_bytes_processed(hair_style.get_strand_count() * (sizeof(glm::vec3) + sizeof(unsigned)));
+}
+
+static void create_position_thickness_data(BenchmarkState& state, const std::string&, const vkhr::HairStyle& hair_style) {
+    while (state.keep_running()) {
+        auto position_thickness = hair_style.create_position_thickness_data();
+        if (position_thickness.empty()) break;
+    }
+
+    state.set_items_processed(hair_style.get_segment_count());
+    state.set_bytes_processed(hair_style.get_vertex_count() * (sizeof(glm::vec3) + sizeof(float) + sizeof(glm::vec4)));
+}
+
+static void image_copy(BenchmarkState& state, const std::string&, const vkhr::HairStyle&) {
+    vkhr::Image image { 1280, 720 };
+    std::vector<glm::vec4> floating_point_data(1280 * 720, glm::vec4 { 0.5f });
+    while (state.keep_running())
+        image.copy(floating_point_data);
+    state.set_items_processed(floating_point_data.size()); // pixels, not segments.
+    state.set_bytes_processed(floating_point_data.size() * (sizeof(glm::vec4) + 4));
+}
+
+// The per tile numbers are for one thread, since the tiles are traced in parallel.
+// Only for the styles with a scene of the same name, e.g. share/scenes/bear.vkhr.
+static void raytracer_draw(BenchmarkState& state, const std::string& style_path, const vkhr::HairStyle&) {
+    auto scene_path = SCENE("") + std::filesystem::path { style_path }.stem().string() + ".vkhr";
+    if (!std::filesystem::exists(scene_path))
+        return; // skipped.
+
+    vkhr::SceneGraph scene_graph { scene_path };
+    scene_graph.get_camera().set_resolution(1280, 720);
+
+    vkhr::Raytracer ray_tracer { scene_graph, false, 1 };
+
+    constexpr std::size_t Tiles { 16 };
+    ray_tracer.set_tile_range(0, Tiles);
+
+    while (state.keep_running())
+        ray_tracer.draw(scene_graph);
+
+    state.set_items_processed(Tiles); // i.e. "per segment" is per tile here.
+    state.set_bytes_processed(Tiles * vkhr::Raytracer::TileSize * vkhr::Raytracer::TileSize * 4);
+}
+
+static const std::vector<Benchmark> benchmarks {
+    { "HairStyle::load",                           load },
+    { "HairStyle::generate_tangents",              generate_tangents },
+    { "HairStyle::generate_indices",               generate_indices },
+    { "HairStyle::voxelize_segments",              voxelize_segments },
+    { "HairStyle::voxelize_segments (bricked)",    voxelize_segments_bricked },
+    { "HairStyle::voxelize_vertices",              voxelize_vertices },
+    { "HairStyle::Volume::normalize",              normalize_volume },
+    { "HairStyle::Volume::downsample",             downsample_volume },
+    { "HairStyle::Volume::set_layout",             swizzle_volume },
+    { "HairStyle::reduce",                         reduce },
+    { "HairStyle::generate_clusters",              generate_clusters },
+    { "HairStyle::create_position_thickness_data", create_position_thickness_data },
+    { "Image::copy",                               image_copy },
+    { "Raytracer::draw (tile)",                    raytracer_draw }
+};
+
+int main(int argc, char** argv) {
+    std::string filter { argc > 1 ? argv[1] : "" };
+
+    std::vector<std::string> style_paths;
+    for (const auto& entry : std::filesystem::directory_iterator { STYLE("") })
+        if (entry.path().extension() == ".hair")
+            style_paths.push_back(entry.path().string());
+    std::sort(style_paths.begin(), style_paths.end());
+
+    std::printf("%-56s %16s %12s %14s %12s\n", "Benchmark", "Time (ns)", "Iterations", "ns/segment", "MB/s");
+
+    for (const auto& style_path : style_paths) {
+        auto style_name = std::filesystem::path { style_path }.stem().string();
+
+        vkhr::HairStyle hair_style { style_path };
+        if (!hair_style) {
+            std::fprintf(stderr, "Couldn't load: %s!\n", style_path.c_str());
+            continue;
+        }
+
+        vkhr::SceneGraph::prepare_style(hair_style);
+
+        for (const auto& benchmark : benchmarks) {
+            auto name = benchmark.name + "/" + style_name;
+            if (name.find(filter) == std::string::npos)
+                continue;
+
+            BenchmarkState state;
+            benchmark.function(state, style_path, hair_style);
+            if (state.get_iterations() == 0)
+                continue;
+
+            auto nanoseconds = state.get_nanoseconds();
+            auto per_item = nanoseconds / std::max<std::size_t>(state.get_items_processed(), 1);
+            auto bytes_per_second = state.get_bytes_processed() / (nanoseconds * 1e-9);
+
+            std::printf("%-56s %16.0f %12zu %14.3f %12.1f\n", name.c_str(), nanoseconds,
+                        state.get_iterations(), per_item, bytes_per_second / 1e6);
+        }
+    }
+
+    return 0;
+}
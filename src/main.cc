@@ -5,19 +5,50 @@
 #include <vkhr/input_map.hh>
 
 #include <vkhr/rasterizer.hh>
+#include <vkhr/video_writer.hh>
+#include <vkhr/image_writer.hh>
 #include <vkhr/scene_graph.hh>
 #include <vkhr/ray_tracer.hh>
+#include <vkhr/trace_recorder.hh>
+#include <vkhr/job_system.hh>
+#include <vkhr/scene_graph/camera_path.hh>
+#include <vkhr/scene_graph/hair_importer.hh>
 
 #include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtx/rotate_vector.hpp>
 
-void build_benchmarks(vkhr::Rasterizer& dut);
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+int render_headless(vkhr::ArgParser& argp, vkhr::SceneGraph& scene_graph);
+int render_thumbnails(vkhr::ArgParser& argp, vkhr::SceneGraph& scene_graph, vkhr::Window& window,
+                      vkhr::Rasterizer& rasterizer, vkhr::Raytracer& ray_tracer);
+int compare_benchmarks(vkhr::ArgParser& argp);
 
 int main(int argc, char** argv) {
     vkhr::ArgParser argp { vkhr::arguments };
     auto scene_file = argp.parse(argc, argv);
 
+    if (!std::string { argp["compare"].value.string }.empty())
+        return compare_benchmarks(argp);
+
     if (scene_file.empty()) scene_file = SCENE("ponytail.vkhr");
 
+    if (std::string trace { argp["trace"].value.string }; !trace.empty())
+        vkhr::TraceRecorder::start(trace); // written when we exit.
+
+    vkhr::JobSystem::set_thread_count(argp["jobs"].value.integer); // before the assets load.
+    vkhr::SceneGraph::set_style_quantization(argp["quantize"].value.boolean ? vkhr::HairStyle::Quantization::Packed
+                                                                          : vkhr::HairStyle::Quantization::None);
+
     vkhr::SceneGraph scene_graph { scene_file };
     auto& camera { (scene_graph.get_camera()) };
 
@@ -25,23 +56,40 @@ int main(int argc, char** argv) {
         height = argp["y"].value.integer;
 
     camera.set_resolution(width, height);
+    camera.set_eye_separation(argp["stereo"].value.floating);
 
-    vkhr::Raytracer ray_tracer { scene_graph };
+    if (argp["headless"].value.boolean) {
+        auto status = render_headless(argp, scene_graph);
+        vkhr::TraceRecorder::stop();
+        return status;
+    }
+
+    vkhr::Raytracer ray_tracer { scene_graph, true, // only built when it's first drawn.
+                                 static_cast<unsigned>(std::max(argp["cores"].value.integer, 0)) };
+
+    // Nothing would ever close it off-screen, so it's only for the modes that finish on their own.
+    bool offscreen { argp["offscreen"].value.boolean };
+    bool thumbnails { !std::string { argp["thumbnails"].value.string }.empty() };
+    if (offscreen && !argp["benchmark"].value.boolean && std::string { argp["capture"].value.string }.empty() && !thumbnails) {
+        std::cerr << "Off-screen rendering needs --benchmark, --capture or --thumbnails!" << std::endl;
+        return 1;
+    }
 
     const vkhr::Image vulkan_icon { IMAGE("vulkan_icon.png") };
-    vkhr::Window window { width, height, "VKHR", vulkan_icon };
+    vkhr::Window window { width, height, "VKHR", vulkan_icon, false, false, offscreen };
 
-    if (argp["fullscreen"].value.boolean)
+    if (argp["fullscreen"].value.boolean && !offscreen)
         window.toggle_fullscreen();
 
     window.enable_vsync(argp["vsync"].value.boolean);
 
-    if (argp["benchmark"].value.boolean == 1)
+    if (argp["benchmark"].value.boolean == 1 || thumbnails)
         window.enable_vsync(false);
 
     vkhr::InputMap input_map { window };
 
     input_map.bind("toggle_ui", vkhr::Input::Key::U);
+    input_map.bind("toggle_hud", vkhr::Input::Key::H);
     input_map.bind("grab", vkhr::Input::MouseButton::Left);
     input_map.bind("toggle_fullscreen", vkhr::Input::Key::F11);
     input_map.bind("take_screenshot", vkhr::Input::Key::S);
@@ -51,30 +99,105 @@ int main(int argc, char** argv) {
     input_map.bind("rotate_light", vkhr::Input::Key::L);
     input_map.bind("recompile", vkhr::Input::Key::R);
 
-    vkhr::Rasterizer rasterizer { window, scene_graph };
+    vkhr::Rasterizer rasterizer { window, scene_graph, static_cast<std::uint32_t>(argp["frames"].value.integer),
+                                  argp["device-group"].value.boolean };
+
+    // The strands are on the GPU now, so they only come back if the ray tracer is switched on.
+    if (argp["gpu-resident"].value.boolean && !scene_graph.release_host_arrays())
+        std::cerr << "Some hair styles aren't cached, keeping their arrays!" << std::endl;
+
+    if (camera.is_stereo() && !rasterizer.stereo_enabled()) {
+        std::cerr << "Stereo needs VK_KHR_multiview, drawing one view!" << std::endl;
+        camera.set_eye_separation(0.0f);
+    }
+
+    // With stereo, each of the eyes gets half of the window.
+    camera.set_resolution(rasterizer.get_color_extent().width, rasterizer.get_color_extent().height);
 
     if (argp["ui"].value.boolean == 0)
         rasterizer.get_imgui().hide();
 
     auto& imgui = rasterizer.get_imgui();
 
-    window.show();
+    imgui.parameters.on_demand = argp["on-demand"].value.boolean;
+
+    if (!offscreen)
+        window.show();
+
+    if (thumbnails) {
+        auto status = render_thumbnails(argp, scene_graph, window, rasterizer, ray_tracer);
+        vkhr::TraceRecorder::stop();
+        return status;
+    }
 
     if (argp["benchmark"].value.boolean == 1) {
-        build_benchmarks(rasterizer);
+        std::string suite { argp["suite"].value.string };
+        if (suite.empty()) suite = ASSET("benchmarks/default.json");
+
+        if (!rasterizer.append_benchmarks(suite)) {
+            std::cerr << "Couldn't load: " << suite << "!" << std::endl;
+            return 1;
+        }
+
         rasterizer.start_benchmark(scene_graph);
     }
 
+    std::string record_path { argp["record-path"].value.string };
+    vkhr::CameraPath camera_path; // replayed in a benchmark.
+    float camera_path_time { 0.0f };
+
+    // Renders at a fixed step of 1 / capture-rate per frame, no matter how long one takes, and
+    // streams them to the --capture writer, e.g. a Y4M file or "|ffmpeg -i - output.mp4".
+    std::string capture { argp["capture"].value.string };
+    unsigned capture_rate = static_cast<unsigned>(std::max(argp["capture-rate"].value.integer, 1));
+    int capture_frames { argp["capture-frames"].value.integer }; // 0 is until exit or path end.
+    vkhr::CameraPath capture_path;
+    vkhr::VideoWriter video_writer;
+    int captured_frames { 0 };
+
+    if (!capture.empty()) {
+        std::string capture_path_file { argp["capture-path"].value.string };
+        if (!capture_path_file.empty() && !capture_path.load(capture_path_file)) {
+            std::cerr << "Couldn't load: " << capture_path_file << "!" << std::endl;
+            return 1;
+        }
+
+        if (capture_frames == 0 && !capture_path.empty())
+            capture_frames = static_cast<int>(std::ceil(capture_path.get_duration() * capture_rate)) + 1;
+
+        if (!video_writer.open(capture, capture_rate)) {
+            std::cerr << "Couldn't open: " << capture << "!" << std::endl;
+            return 1;
+        }
+
+        rasterizer.set_fixed_time_step(1.0f / capture_rate);
+        window.enable_vsync(false); // since it's not realtime anyway.
+    }
+
+    std::size_t input_events { input_map.get_event_count() };
+
+    // The scene's files are polled for saves this often, and then only the changed ones are reloaded.
+    bool hot_reload { argp["hot-reload"].value.boolean && !argp["benchmark"].value.boolean && capture.empty() };
+    constexpr std::chrono::milliseconds HotReloadInterval { 500 };
+    auto next_reload_poll = std::chrono::steady_clock::now() + HotReloadInterval;
+
     while (window.is_open()) {
+        // Otherwise the input is from before waiting for the frame in flight, up to a frame ago.
+        if (imgui.parameters.low_latency) {
+            rasterizer.wait_for_frame();
+            window.poll_events();
+        }
+
         if (input_map.just_pressed("quit")) {
             window.close();
         } else if (input_map.just_pressed("toggle_ui")) {
             imgui.toggle_visibility();
+        } else if (input_map.just_pressed("toggle_hud")) {
+            imgui.toggle_hud();
         } else if (input_map.just_pressed("toggle_fullscreen")) {
             window.toggle_fullscreen();
         } else if (input_map.just_pressed("take_screenshot")) {
-            rasterizer.get_screenshot(scene_graph, ray_tracer)
-                      .save_time(); // label using date/time.
+            rasterizer.save_screenshot(); // label using date/time.
         } else if (input_map.just_pressed("toggle_renderer")) {
             imgui.toggle_renderer();
         } else if (input_map.just_pressed("rotate_light")) {
@@ -83,9 +206,32 @@ int main(int argc, char** argv) {
             rasterizer.recompile();
         }
 
-        camera.control(input_map, window.update_delta_time(),
+        auto delta_time = window.update_delta_time();
+
+        if (video_writer.is_open())
+            delta_time = 1.0f / capture_rate;
+
+        camera.control(input_map, delta_time,
                        rasterizer.get_imgui().wants_focus());
 
+        if (video_writer.is_open() && !capture_path.empty())
+            capture_path.sample(static_cast<float>(captured_frames) / capture_rate, camera);
+
+        if (!record_path.empty()) {
+            camera_path.record(camera, camera_path_time);
+            camera_path_time += delta_time;
+        }
+
+        if (hot_reload && std::chrono::steady_clock::now() >= next_reload_poll) {
+            next_reload_poll = std::chrono::steady_clock::now() + HotReloadInterval;
+            if (scene_graph.has_modified_files()) {
+                ray_tracer.stop_background(); // it shares the vertices being reloaded.
+                auto changes = scene_graph.reload();
+                rasterizer.reload(scene_graph, changes);
+                ray_tracer.reload(scene_graph, changes);
+            }
+        }
+
         scene_graph.traverse_nodes();
 
         imgui.transform(scene_graph, rasterizer, ray_tracer);
@@ -95,153 +241,465 @@ int main(int argc, char** argv) {
             rasterizer.recreate_swapchain(window, scene_graph); // slow!?
         }
 
-        if (imgui.raytracing_enabled()) {
-            ray_tracer.draw(scene_graph);
+        if (video_writer.is_open()) {
+            rasterizer.request_screenshot([&video_writer](vkhr::Image&& frame) {
+                video_writer.write(std::move(frame));
+            });
+
+            if (capture_frames != 0 && ++captured_frames >= capture_frames)
+                window.close(); // after this last frame.
+            else if (capture_frames == 0)
+                ++captured_frames;
+        }
+
+        // Any input could change the GUI, and the window could've lost the last image it presented.
+        if (input_map.get_event_count() != input_events || window.needs_refresh()) {
+            input_events = input_map.get_event_count();
+            rasterizer.request_redraw();
+        }
+
+        bool drawn { true }; // or the last image is still there, with nothing new to draw.
+
+        rasterizer.record_input_time(input_map.take_event_time());
+
+        if (imgui.raytracing_enabled() && rasterizer.gpu_raytracing_enabled()) {
+            ray_tracer.stop_background(); // only its settings are used.
+            rasterizer.draw(scene_graph, ray_tracer);
+        } else if (imgui.raytracing_enabled()) {
+            rasterizer.simulate(scene_graph, ray_tracer); // so it traces the strands where they've moved.
+            ray_tracer.draw_in_background(scene_graph); // keeps tracing, even when nothing is drawn.
             auto& framebuffer = ray_tracer.get_framebuffer();
-            rasterizer.draw(framebuffer);
+            auto updated_tiles = ray_tracer.get_updated_tiles();
+            drawn = !imgui.parameters.on_demand || !updated_tiles.empty() || rasterizer.redraw_needed(scene_graph);
+            if (drawn)
+                rasterizer.draw(framebuffer, updated_tiles, vkhr::Raytracer::TileSize);
         } else {
-            rasterizer.draw(scene_graph);
+            ray_tracer.stop_background();
+            drawn = !imgui.parameters.on_demand || rasterizer.redraw_needed(scene_graph);
+            if (drawn)
+                rasterizer.draw(scene_graph);
         }
 
         // Benchmark the renderer and dump timings.
         if (argp["benchmark"].value.boolean == 1) {
             if (!rasterizer.benchmark(scene_graph))
-                return 0; // benchmark is complete!
+                break; // benchmark is complete!
         }
 
-        window.poll_events();
+        // For the tiles the ray tracer finishes meanwhile, or it could sleep until the next input.
+        if (drawn) {
+            if (!imgui.parameters.low_latency)
+                window.poll_events();
+        } else
+            window.wait_events(imgui.raytracing_enabled() ? 1.0f / 60.0f : 0.25f);
+    }
+
+    if (video_writer.is_open()) {
+        rasterizer.finish_screenshots();
+        video_writer.close();
+    }
+
+    if (!record_path.empty() && !camera_path.save(record_path)) {
+        std::cerr << "Couldn't save: " << record_path << "!" << std::endl;
+        vkhr::TraceRecorder::stop();
+        return 1;
     }
 
+    vkhr::TraceRecorder::stop();
+
     return 0;
 }
 
-void build_benchmarks(vkhr::Rasterizer& rasterizer) {
-    vkhr::Rasterizer::Benchmark default_parameter {
-        "Benchmark Scenario",
-        SCENE("ponytail.vkhr"),
-        1280,
-        720,
-        vkhr::Renderer::Rasterizer,
-        226,
-        1.0,
-        512
+// Ray traces the scene for --samples (or until --seconds or --noise are reached, if
+// they're set) and saves it to --output, without creating a window or any Vulkan.
+// For a render split between many workers, each one is given the same --seed and
+// its own --first-tile and --tiles, or --first-sample, and saves its accumulation
+// to a file, which are then merged by another run with a comma-separated --merge.
+// With --raymarch the styles' volumes are raymarched instead of their strands, as
+// the rasterizer's raymarched level of detail would, to compare it against them.
+// With --bake-ao it only bakes the ambient occlusion volume of every hair style,
+// with --samples rays per voxel, and saves it next to it for the rasterizer.
+// With --bake-impostors it does the same for their octahedral impostors, with
+// --samples rays per texel, for drawing the farthest nodes as billboards.
+// With --compress it saves a compressed copy of every (prepared) hair style, as
+// <style>.z.hair, which can replace the original one since it loads the same.
+// With --decimate N it saves a copy with only every N-th vertex of the strands,
+// as <style>.cN.hair, for drawing them with the "Tessellated Curves" expansion.
+int render_headless(vkhr::ArgParser& argp, vkhr::SceneGraph& scene_graph) {
+    if (auto stride = argp["decimate"].value.integer; stride > 1) {
+        for (const auto& hair_style : scene_graph.get_hair_styles()) {
+            auto decimated_path = hair_style.second.get_file_path();
+            if (auto extension = decimated_path.rfind(".hair"); extension != std::string::npos)
+                decimated_path.erase(extension);
+            decimated_path += ".c" + std::to_string(stride) + ".hair";
+
+            auto decimated_style = hair_style.second;
+            decimated_style.decimate(stride);
+
+            if (!decimated_style.save(decimated_path)) {
+                std::cerr << "Couldn't save: " << decimated_path << "!" << std::endl;
+                return 1;
+            }
+
+            std::cout << decimated_path << ": " << decimated_style.get_vertex_count() << " of "
+                      << hair_style.second.get_vertex_count() << " vertices" << std::endl;
+        }
+
+        return 0;
+    }
+
+    if (argp["compress"].value.boolean) {
+        for (const auto& hair_style : scene_graph.get_hair_styles()) {
+            auto compressed_path = hair_style.second.get_file_path();
+            if (auto extension = compressed_path.rfind(".hair"); extension != std::string::npos)
+                compressed_path.erase(extension);
+            compressed_path += ".z.hair";
+
+            if (!hair_style.second.save(compressed_path, true)) {
+                std::cerr << "Couldn't save: " << compressed_path << "!" << std::endl;
+                return 1;
+            }
+
+            std::error_code error; // since it's only a few percent smaller, see HairStyle::save.
+            std::cout << compressed_path << ": " << std::filesystem::file_size(compressed_path, error) << " of "
+                      << hair_style.second.get_size() << " bytes" << std::endl;
+        }
+
+        return 0;
+    }
+
+    vkhr::Raytracer ray_tracer { scene_graph, false, static_cast<unsigned>(std::max(argp["cores"].value.integer, 0)) };
+    ray_tracer.set_raymarching(argp["raymarch"].value.boolean);
+
+    if (argp["seed"].value.integer != 0)
+        ray_tracer.set_seed(static_cast<std::uint32_t>(argp["seed"].value.integer));
+    ray_tracer.set_tile_range(std::max(argp["first-tile"].value.integer, 0),
+                              std::max(argp["tiles"].value.integer, 0));
+    ray_tracer.set_sample_offset(std::max(argp["first-sample"].value.integer, 0));
+
+    auto samples = static_cast<std::size_t>(std::max(argp["samples"].value.integer, 1));
+
+    if (argp["bake-ao"].value.boolean) {
+        for (const auto& hair_style : scene_graph.get_hair_styles()) {
+            auto ambient_occlusion = ray_tracer.bake_ambient_occlusion(hair_style.second,
+                                                                       vkhr::HairStyle::BakedResolution,
+                                                                       static_cast<unsigned>(samples));
+            auto ambient_occlusion_path = hair_style.second.get_ambient_occlusion_path();
+            if (!ambient_occlusion.save(ambient_occlusion_path)) {
+                std::cerr << "Couldn't save: " << ambient_occlusion_path << "!" << std::endl;
+                return 1;
+            }
+
+            std::cout << ambient_occlusion_path << ": " << samples << " samples" << std::endl;
+        }
+
+        return 0;
+    }
+
+    if (argp["bake-impostors"].value.boolean) {
+        for (const auto& hair_style : scene_graph.get_hair_styles()) {
+            auto impostor = ray_tracer.bake_impostor(hair_style.second,
+                                                     vkhr::HairStyle::ImpostorViews,
+                                                     vkhr::HairStyle::ImpostorResolution,
+                                                     static_cast<unsigned>(samples));
+            auto impostor_path = hair_style.second.get_impostor_path();
+            if (!impostor.save(impostor_path)) {
+                std::cerr << "Couldn't save: " << impostor_path << "!" << std::endl;
+                return 1;
+            }
+
+            std::cout << impostor_path << ": " << samples << " samples" << std::endl;
+        }
+
+        return 0;
+    }
+
+    std::string output { argp["output"].value.string };
+
+    if (std::string merge { argp["merge"].value.string }; !merge.empty()) {
+        std::size_t begin { 0 };
+        while (begin <= merge.size()) {
+            auto end = std::min(merge.find(',', begin), merge.size());
+            auto accumulation = merge.substr(begin, end - begin);
+            if (!accumulation.empty() && !ray_tracer.merge_accumulation(accumulation)) {
+                std::cerr << "Couldn't merge: " << accumulation << "!" << std::endl;
+                return 1;
+            }
+
+            begin = end + 1;
+        }
+
+        if (!ray_tracer.get_framebuffer().save(output)) {
+            std::cerr << "Couldn't save: " << output << "!" << std::endl;
+            return 1;
+        }
+
+        return 0;
+    }
+
+    auto sample = ray_tracer.draw_until_converged(scene_graph, argp["noise"].value.floating,
+                                                  samples, argp["seconds"].value.floating);
+
+    if (std::string accumulation { argp["accumulation"].value.string }; !accumulation.empty()) {
+        if (!ray_tracer.save_accumulation(accumulation)) {
+            std::cerr << "Couldn't save: " << accumulation << "!" << std::endl;
+            return 1;
+        }
+    }
+
+    if (!ray_tracer.get_framebuffer().save(output)) {
+        std::cerr << "Couldn't save: " << output << "!" << std::endl;
+        return 1;
+    }
+
+    std::cout << output << ": " << sample << " samples" << std::endl;
+
+    return 0;
+}
+
+// Renders a thumbnail (or a turntable of --thumbnail-views of them) of every style in --thumbnails,
+// a directory of .hair files or a file with one path per line, all with the same Rasterizer, its
+// pipelines, and the scene: each style replaces the scene's first one, in the same node, and the
+// camera orbits it from the scene camera's direction. The next style is loaded by the JobSystem
+// while this one is drawn, and the images are read back and saved without waiting for them (see
+// Rasterizer::request_screenshot), so it's bound by the GPU, and not by the loads or the encoder.
+// They're saved next to the styles, as <style>.png (or <style>.<view>.png), or in --thumbnail-path.
+// With --thumbnail-samples they're ray traced instead, with as many samples, or until --noise.
+int render_thumbnails(vkhr::ArgParser& argp, vkhr::SceneGraph& scene_graph, vkhr::Window& window,
+                      vkhr::Rasterizer& rasterizer, vkhr::Raytracer& ray_tracer) {
+    std::filesystem::path thumbnails { argp["thumbnails"].value.string };
+    std::vector<std::string> style_paths;
+
+    std::error_code error;
+    if (std::filesystem::is_directory(thumbnails, error)) {
+        for (const auto& entry : std::filesystem::directory_iterator { thumbnails, error })
+            if (entry.path().extension() == ".hair" || vkhr::hair_importer::is_importable(entry.path().string()))
+                style_paths.push_back(entry.path().string());
+        std::sort(style_paths.begin(), style_paths.end());
+    } else {
+        std::ifstream list { thumbnails };
+        if (!list) {
+            std::cerr << "Couldn't open: " << thumbnails.string() << "!" << std::endl;
+            return 1;
+        }
+
+        std::string style_path;
+        while (std::getline(list, style_path))
+            if (!style_path.empty() && style_path[0] != '#')
+                style_paths.push_back(style_path);
+    }
+
+    const auto& hair_nodes = scene_graph.get_nodes_with_hair_styles();
+    if (hair_nodes.empty() || hair_nodes.front()->get_hair_styles().empty()) {
+        std::cerr << "The scene has no hair style to replace: " << scene_graph.get_scene_path() << "!" << std::endl;
+        return 1;
+    }
+
+    const auto* hair_node = hair_nodes.front();
+    const auto& hair_style = *hair_node->get_hair_styles().front();
+
+    std::filesystem::path thumbnail_directory { argp["thumbnail-path"].value.string };
+    int views   = std::max(argp["thumbnail-views"].value.integer, 1),
+        frames  = std::max(argp["thumbnail-frames"].value.integer, 1), // for the TAA to converge.
+        samples = std::max(argp["thumbnail-samples"].value.integer, 0);
+
+    auto noise = argp["noise"].value.floating;
+
+    auto& camera = scene_graph.get_camera();
+    auto view_direction = glm::normalize(camera.get_position() - camera.get_look_at_point());
+    auto up_direction = camera.get_up_direction();
+
+    // Of the narrower of the two fields of view, so the style's bounding sphere fits in both.
+    float field_of_view { 2.0f * std::atan(std::tan(camera.get_field_of_view() / 2.0f) * std::min(camera.get_aspect_ratio(), 1.0f)) };
+
+    vkhr::ImageWriter image_writer;
+    auto& job_system = vkhr::JobSystem::get();
+
+    // One style ahead of the one being drawn, which is only taken once its load has finished.
+    vkhr::HairStyle next_style;
+    auto submit_load = [&](std::size_t i) {
+        if (i >= style_paths.size())
+            return vkhr::JobSystem::Handle { };
+        return job_system.submit([&next_style, style_path = style_paths[i]] {
+            next_style = vkhr::SceneGraph::load_style(style_path);
+        }, { }, vkhr::JobSystem::Low);
+    };
+
+    auto next_load = submit_load(0);
+
+    std::size_t rendered { 0 };
+
+    for (std::size_t i { 0 }; i < style_paths.size() && window.is_open(); ++i) {
+        job_system.wait(next_load);
+        auto style = std::move(next_style);
+        next_load = submit_load(i + 1);
+
+        if (!style) {
+            std::cerr << "Couldn't load: " << style_paths[i] << "!" << std::endl;
+            continue;
+        }
+
+        auto changes = scene_graph.replace(hair_style, std::move(style));
+        rasterizer.reload(scene_graph, changes);
+        ray_tracer.reload(scene_graph, changes);
+
+        const auto& bounds = hair_node->get_bounds();
+        glm::vec3 center { bounds.origin + bounds.size / 2.0f };
+        float distance { glm::length(bounds.size) / 2.0f / std::sin(field_of_view / 2.0f) };
+
+        std::filesystem::path style_path { style_paths[i] };
+        auto directory = thumbnail_directory.empty() ? style_path.parent_path() : thumbnail_directory;
+
+        for (int view { 0 }; view < views && window.is_open(); ++view) {
+            auto direction = glm::rotate(view_direction, glm::two_pi<float>() * view / views, up_direction);
+            camera.look_at(center, center + direction * distance, up_direction);
+
+            auto file_name = style_path.stem().string();
+            if (views > 1)
+                file_name += "." + std::to_string(view);
+            auto thumbnail_path = (directory / (file_name + ".png")).string();
+
+            if (samples > 0) {
+                ray_tracer.clear();
+                ray_tracer.draw_until_converged(scene_graph, noise, static_cast<std::size_t>(samples));
+                image_writer.save(vkhr::Image { ray_tracer.get_framebuffer() }, thumbnail_path);
+            } else {
+                for (int frame { 0 }; frame < frames && window.is_open(); ++frame) {
+                    if (window.surface_is_dirty() || rasterizer.swapchain_is_dirty())
+                        rasterizer.recreate_swapchain(window, scene_graph);
+
+                    if (frame == frames - 1) {
+                        rasterizer.request_screenshot([&image_writer, thumbnail_path](vkhr::Image&& thumbnail) {
+                            image_writer.save(std::move(thumbnail), thumbnail_path);
+                        });
+                    }
+
+                    rasterizer.draw(scene_graph);
+                    window.poll_events();
+                }
+            }
+        }
+
+        std::cout << style_paths[i] << ": " << views << (views == 1 ? " view" : " views") << std::endl;
+
+        ++rendered;
+    }
+
+    job_system.wait(next_load); // since it writes into next_style.
+
+    rasterizer.finish_screenshots(); // before the image_writer finishes its queue.
+    image_writer.wait();
+
+    std::cout << rendered << " of " << style_paths.size() << " styles rendered" << std::endl;
+
+    return rendered == style_paths.size() ? 0 : 1;
+}
+
+// Compares the benchmark results of --compare <baseline>.json,<current>.json (as written
+// next to the CSV in benchmark mode), matching the scenarios by their description and
+// parameters. A pass regressed if its robust mean went up by more than --threshold, as
+// a fraction, and by more than the standard deviation of the baseline (i.e. its noise).
+// The screenshots regressed if their RMSE is above --max-rmse, and their differences
+// are saved next to the current ones. Returns 1 if anything regressed, for the CI runs.
+int compare_benchmarks(vkhr::ArgParser& argp) {
+    std::string compare { argp["compare"].value.string };
+    auto separator = compare.find(',');
+    if (separator == std::string::npos) {
+        std::cerr << "Expected: --compare <baseline>.json,<current>.json!" << std::endl;
+        return 1;
+    }
+
+    std::filesystem::path result_paths[2] { compare.substr(0, separator),
+                                            compare.substr(separator + 1) };
+    nlohmann::json results[2];
+
+    for (int i { 0 }; i < 2; ++i) {
+        std::ifstream file { result_paths[i] };
+        if (!file) {
+            std::cerr << "Couldn't open: " << result_paths[i].string() << "!" << std::endl;
+            return 1;
+        }
+
+        try {
+            results[i] = nlohmann::json::parse(file);
+        } catch (const nlohmann::json::exception&) {
+            std::cerr << "Couldn't parse: " << result_paths[i].string() << "!" << std::endl;
+            return 1;
+        }
+    }
+
+    auto scenario_key = [](const nlohmann::json& scenario) {
+        std::string key;
+        for (auto parameter : { "description", "renderer", "scene", "width", "height",
+                                "distance", "strands", "samples", "expansion" })
+            key += scenario.value(parameter, nlohmann::json {}).dump() + ",";
+        return key;
     };
 
-    rasterizer.append_benchmark({ "Time (ms)", SCENE("ponytail.vkhr"), default_parameter.width, default_parameter.height, vkhr::Renderer::Rasterizer, 226, default_parameter.strand_reduction, default_parameter.raymarch_steps });
-
-    for (float distance { 200.0f }; distance < 2000.0f; distance += 1800.0f / 64.0f) {
-        rasterizer.append_benchmark({ "Time (ms) vs. Distance",
-                                      SCENE("ponytail.vkhr"),
-                                      default_parameter.width,
-                                      default_parameter.height,
-                                      vkhr::Renderer::Rasterizer,
-                                      distance,
-                                      default_parameter.strand_reduction,
-                                      default_parameter.raymarch_steps });
-    }
-
-    for (float strands { 1.0f }; strands > 0.0f; strands -= 1.0f / 64.0f) {
-        rasterizer.append_benchmark({ "Time (ms) vs. Strands",
-                                      SCENE("ponytail.vkhr"),
-                                      default_parameter.width,
-                                      default_parameter.height,
-                                      vkhr::Renderer::Rasterizer,
-                                      226,
-                                      strands,
-                                      default_parameter.raymarch_steps });
-    }
-
-    rasterizer.append_benchmark({ "Time (ms)", SCENE("ponytail.vkhr"), default_parameter.width, default_parameter.height, vkhr::Renderer::Raymarcher, 226, default_parameter.strand_reduction, default_parameter.raymarch_steps });
-
-    for (float distance { 200.0f }; distance < 2000.0f; distance += 1800.0f / 64.0f) {
-        rasterizer.append_benchmark({ "Time (ms) vs. Distance",
-                                      SCENE("ponytail.vkhr"),
-                                      default_parameter.width,
-                                      default_parameter.height,
-                                      vkhr::Renderer::Raymarcher,
-                                      distance,
-                                      default_parameter.strand_reduction,
-                                      default_parameter.raymarch_steps });
-    }
-
-    for (int samples { 512 }; samples >= 64; samples -= 448 / 64) {
-        rasterizer.append_benchmark({ "Time (ms) vs. Samples",
-                                      SCENE("ponytail.vkhr"),
-                                      default_parameter.width,
-                                      default_parameter.height,
-                                      vkhr::Renderer::Raymarcher,
-                                      226,
-                                      default_parameter.strand_reduction,
-                                      samples });
-    }
-
-    for (float strands { 1.0f }; strands > 0.0f; strands -= 1.0f / 64.0f) {
-        rasterizer.append_benchmark({ "Time (ms) vs. Strands",
-                                      SCENE("ponytail.vkhr"),
-                                      default_parameter.width,
-                                      default_parameter.height,
-                                      vkhr::Renderer::Raymarcher,
-                                      226,
-                                      strands,
-                                      default_parameter.raymarch_steps });
-    }
-
-    rasterizer.append_benchmark({ "Time (ms)", SCENE("bear.vkhr"), default_parameter.width, default_parameter.height, vkhr::Renderer::Rasterizer, 385, default_parameter.strand_reduction, default_parameter.raymarch_steps });
-
-    for (float distance { 300.0f }; distance < 3000.0f; distance += 2700.0f / 64.0f) {
-        rasterizer.append_benchmark({ "Time (ms) vs. Distance",
-                                      SCENE("bear.vkhr"),
-                                      default_parameter.width,
-                                      default_parameter.height,
-                                      vkhr::Renderer::Rasterizer,
-                                      distance,
-                                      default_parameter.strand_reduction,
-                                      default_parameter.raymarch_steps });
-    }
-
-    for (float strands { 1.0f }; strands > 0.0f; strands -= 1.0f / 64.0f) {
-        rasterizer.append_benchmark({ "Time (ms) vs. Strands",
-                                      SCENE("bear.vkhr"),
-                                      default_parameter.width,
-                                      default_parameter.height,
-                                      vkhr::Renderer::Rasterizer,
-                                      385,
-                                      strands,
-                                      default_parameter.raymarch_steps });
-    }
-
-    rasterizer.append_benchmark({ "Time (ms)", SCENE("bear.vkhr"), default_parameter.width, default_parameter.height, vkhr::Renderer::Raymarcher, 385, default_parameter.strand_reduction, default_parameter.raymarch_steps });
-
-    for (float distance { 300.0f }; distance < 3000.0f; distance += 2700.0f / 64.0f) {
-        rasterizer.append_benchmark({ "Time (ms) vs. Distance",
-                                      SCENE("bear.vkhr"),
-                                      default_parameter.width,
-                                      default_parameter.height,
-                                      vkhr::Renderer::Raymarcher,
-                                      distance,
-                                      default_parameter.strand_reduction,
-                                      default_parameter.raymarch_steps });
-    }
-
-    for (int samples { 512 }; samples >= 64; samples -= 448 / 64) {
-        rasterizer.append_benchmark({ "Time (ms) vs. Samples",
-                                      SCENE("bear.vkhr"),
-                                      default_parameter.width,
-                                      default_parameter.height,
-                                      vkhr::Renderer::Raymarcher,
-                                      385,
-                                      default_parameter.strand_reduction,
-                                      samples });
-    }
-
-    for (float strands { 1.0f }; strands > 0.0f; strands -= 1.0f / 64.0f) {
-        rasterizer.append_benchmark({ "Time (ms) vs. Strands",
-                                      SCENE("bear.vkhr"),
-                                      default_parameter.width,
-                                      default_parameter.height,
-                                      vkhr::Renderer::Raymarcher,
-                                      385,
-                                      strands,
-                                      default_parameter.raymarch_steps });
+    std::unordered_map<std::string, const nlohmann::json*> baseline_scenarios;
+    for (const auto& scenario : results[0])
+        baseline_scenarios[scenario_key(scenario)] = &scenario;
+
+    auto threshold = argp["threshold"].value.floating,
+         max_rmse  = argp["max-rmse"].value.floating;
+
+    std::size_t regressions { 0 }, compared { 0 };
+
+    for (const auto& scenario : results[1]) {
+        auto baseline = baseline_scenarios.find(scenario_key(scenario));
+        if (baseline == baseline_scenarios.end())
+            continue; // new scenario.
+
+        const auto& baseline_scenario = *baseline->second;
+        auto name = scenario.value("description", std::string {}) + " ("
+                  + scenario.value("renderer", std::string {}) + ", "
+                  + std::filesystem::path(scenario.value("scene", std::string {})).stem().string() + ", "
+                  + std::to_string(static_cast<int>(scenario.value("distance", 0.0f))) + ")";
+
+        ++compared;
+
+        auto baseline_profiles = baseline_scenario.value("profiles", nlohmann::json::object()),
+             current_profiles  = scenario.value("profiles", nlohmann::json::object());
+        for (const auto& profile : current_profiles.items()) {
+            auto baseline_profile = baseline_profiles.find(profile.key());
+            if (baseline_profile == baseline_profiles.end())
+                continue;
+
+            auto baseline_time = baseline_profile->value("robustMean", 0.0f),
+                 current_time  = profile.value().value("robustMean", 0.0f),
+                 noise         = baseline_profile->value("standardDeviation", 0.0f);
+
+            if (current_time > baseline_time * (1.0f + threshold) && current_time - baseline_time > noise) {
+                std::cout << name << ": " << profile.key() << " regressed from " << baseline_time << " to "
+                          << current_time << " ms (+" << 100.0f * (current_time / baseline_time - 1.0f)
+                          << "%)" << std::endl;
+                ++regressions;
+            }
+        }
+
+        auto baseline_screenshot = result_paths[0].parent_path() / baseline_scenario.value("screenshot", std::string {}),
+             current_screenshot  = result_paths[1].parent_path() / scenario.value("screenshot", std::string {});
+
+        vkhr::Image baseline_image { baseline_screenshot.string() },
+                    current_image  { current_screenshot.string() },
+                    difference_image;
+
+        if (!baseline_image || !current_image)
+            continue; // e.g. the screenshots were never kept.
+
+        auto rmse = baseline_image.get_root_mean_square_error(current_image, &difference_image);
+        if (rmse > max_rmse) {
+            auto difference_path = current_screenshot;
+            difference_path.replace_extension(".diff.png");
+            difference_image.save(difference_path.string());
+
+            std::cout << name << ": the screenshot changed with an RMSE of " << rmse << " (PSNR "
+                      << -20.0f * std::log10(rmse) << " dB), see " << difference_path.string() << std::endl;
+            ++regressions;
+        }
     }
+
+    std::cout << regressions << " regressions in " << compared << " scenarios" << std::endl;
+
+    return regressions == 0 ? 0 : 1;
 }
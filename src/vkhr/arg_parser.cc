@@ -172,10 +172,50 @@ namespace vkhr {
     std::vector<Argument> arguments {
         { "width",      Argument::Type::Integer, Argument::make_integer(1280),  "" },
         { "height",     Argument::Type::Integer, Argument::make_integer(720),   "" },
-        { "cores",      Argument::Type::Integer, Argument::make_integer(8),     "" },
+        { "cores",      Argument::Type::Integer, Argument::make_integer(0),     "" },
+        { "jobs",       Argument::Type::Integer, Argument::make_integer(0),     "" }, // JobSystem workers.
         { "fullscreen", Argument::Type::Boolean, Argument::make_boolean(false), "" },
+        { "quantize",   Argument::Type::Boolean, Argument::make_boolean(false), "" }, // see SceneGraph::set_style_quantization.
         { "vsync",      Argument::Type::Boolean, Argument::make_boolean(true),  "" },
+        { "on-demand",  Argument::Type::Boolean, Argument::make_boolean(false), "" }, // see Rasterizer::redraw_needed.
         { "ui",         Argument::Type::Boolean, Argument::make_boolean(true),  "" },
         { "benchmark",  Argument::Type::Boolean, Argument::make_boolean(false), "" },
+        { "suite",      Argument::Type::String,  Argument::make_string(""),     "" },
+        { "offscreen",  Argument::Type::Boolean, Argument::make_boolean(false), "" }, // the benchmark without a display.
+        { "frames",     Argument::Type::Integer, Argument::make_integer(2),     "" },
+        { "headless",   Argument::Type::Boolean, Argument::make_boolean(false), "" },
+        { "samples",    Argument::Type::Integer, Argument::make_integer(256),   "" },
+        { "seconds",    Argument::Type::Floating, Argument::make_floating(0.0f), "" },
+        { "noise",      Argument::Type::Floating, Argument::make_floating(0.0f), "" },
+        { "raymarch",   Argument::Type::Boolean, Argument::make_boolean(false), "" }, // see Raytracer::set_raymarching.
+        { "output",     Argument::Type::String,  Argument::make_string("render.png"), "" },
+        { "seed",       Argument::Type::Integer, Argument::make_integer(0),     "" },
+        { "first-tile", Argument::Type::Integer, Argument::make_integer(0),     "" },
+        { "tiles",      Argument::Type::Integer, Argument::make_integer(0),     "" },
+        { "first-sample", Argument::Type::Integer, Argument::make_integer(0),   "" },
+        { "accumulation", Argument::Type::String, Argument::make_string(""),    "" },
+        { "merge",      Argument::Type::String,  Argument::make_string(""),     "" },
+        { "bake-ao",    Argument::Type::Boolean, Argument::make_boolean(false), "" },
+        { "bake-impostors", Argument::Type::Boolean, Argument::make_boolean(false), "" },
+        { "compress",   Argument::Type::Boolean, Argument::make_boolean(false), "" },
+        { "decimate",   Argument::Type::Integer, Argument::make_integer(0),     "" },
+        { "compare",    Argument::Type::String,  Argument::make_string(""),     "" },
+        { "threshold",  Argument::Type::Floating, Argument::make_floating(0.05f), "" },
+        { "max-rmse",   Argument::Type::Floating, Argument::make_floating(0.01f), "" },
+        { "trace",      Argument::Type::String,  Argument::make_string(""),     "" },
+        { "record-path", Argument::Type::String,  Argument::make_string(""),     "" },
+        { "capture",    Argument::Type::String,  Argument::make_string(""),     "" },
+        { "capture-rate", Argument::Type::Integer, Argument::make_integer(60),  "" },
+        { "capture-frames", Argument::Type::Integer, Argument::make_integer(0), "" },
+        { "capture-path", Argument::Type::String, Argument::make_string(""),    "" },
+        { "stereo",     Argument::Type::Floating, Argument::make_floating(0.0f), "" }, // eye separation.
+        { "gpu-resident", Argument::Type::Boolean, Argument::make_boolean(false), "" },
+        { "hot-reload", Argument::Type::Boolean, Argument::make_boolean(true),  "" }, // see SceneGraph::reload.
+        { "device-group", Argument::Type::Boolean, Argument::make_boolean(false), "" }, // see Rasterizer::peer_voxelization_enabled.
+        { "thumbnails", Argument::Type::String,  Argument::make_string(""),     "" }, // see render_thumbnails.
+        { "thumbnail-path", Argument::Type::String, Argument::make_string(""),  "" },
+        { "thumbnail-views", Argument::Type::Integer, Argument::make_integer(1), "" },
+        { "thumbnail-frames", Argument::Type::Integer, Argument::make_integer(16), "" },
+        { "thumbnail-samples", Argument::Type::Integer, Argument::make_integer(0), "" },
     };
 }
@@ -0,0 +1,132 @@
+#include <vkhr/compression.hh>
+#include <vkhr/job_system.hh>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace vkhr {
+    namespace compression {
+        static std::uint32_t float_to_ordered(std::uint32_t bits) {
+            return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+        }
+
+        static std::uint32_t ordered_to_float(std::uint32_t ordered) {
+            return (ordered & 0x80000000u) ? ordered & 0x7fffffffu : ~ordered;
+        }
+
+        static void compress_chunk(const std::uint32_t* words, std::size_t count, std::size_t stride,
+                                   std::vector<char>& chunk) {
+            chunk.clear();
+            chunk.reserve(count * 2);
+
+            for (std::size_t i { 0 }; i < count; ++i) {
+                std::uint32_t prediction { i >= stride ? words[i - stride] : 0u };
+                std::uint32_t residual { words[i] - prediction };
+                residual = (residual << 1) ^ (0u - (residual >> 31)); // ZigZag
+
+                while (residual >= 0x80u) {
+                    chunk.push_back(static_cast<char>((residual & 0x7fu) | 0x80u));
+                    residual >>= 7;
+                }
+
+                chunk.push_back(static_cast<char>(residual));
+            }
+        }
+
+        static bool decompress_chunk(const unsigned char* chunk, std::size_t chunk_size,
+                                     std::uint32_t* words, std::size_t count, std::size_t stride) {
+            const unsigned char* end { chunk + chunk_size };
+
+            for (std::size_t i { 0 }; i < count; ++i) {
+                std::uint32_t residual { 0 };
+
+                for (unsigned shift { 0 };; shift += 7) {
+                    if (chunk == end || shift > 28) return false;
+                    residual |= static_cast<std::uint32_t>(*chunk & 0x7fu) << shift;
+                    if (!(*chunk++ & 0x80u)) break;
+                }
+
+                residual = (residual >> 1) ^ (0u - (residual & 1u));
+                std::uint32_t prediction { i >= stride ? words[i - stride] : 0u };
+                words[i] = prediction + residual;
+            }
+
+            return chunk == end;
+        }
+
+        std::vector<char> compress(Span<std::uint32_t> words, std::size_t stride) {
+            std::size_t chunk_count { (words.size() + ChunkSize - 1) / ChunkSize };
+            std::vector<std::vector<char>> chunks(chunk_count);
+
+            JobSystem::get().parallel_for(0, static_cast<int>(chunk_count), 1, [&](int chunk) {
+                std::size_t first { chunk * ChunkSize };
+                compress_chunk(words.data() + first, std::min(ChunkSize, words.size() - first), stride, chunks[chunk]);
+            });
+
+            // The table holds the size of each chunk, so they can be found before any are decoded.
+            std::vector<char> stream(sizeof(std::uint64_t) * (chunk_count + 1));
+
+            std::uint64_t table_size { chunk_count };
+            std::memcpy(stream.data(), &table_size, sizeof(table_size));
+
+            for (std::size_t chunk { 0 }; chunk < chunk_count; ++chunk) {
+                std::uint64_t chunk_size { chunks[chunk].size() };
+                std::memcpy(stream.data() + sizeof(std::uint64_t) * (chunk + 1), &chunk_size, sizeof(chunk_size));
+                stream.insert(stream.end(), chunks[chunk].begin(), chunks[chunk].end());
+            }
+
+            return stream;
+        }
+
+        std::vector<char> compress(Span<float> floats, std::size_t stride) {
+            std::vector<std::uint32_t> words(floats.size());
+            std::memcpy(words.data(), floats.data(), floats.size_in_bytes());
+            for (auto& word : words) word = float_to_ordered(word);
+            return compress(Span<std::uint32_t> { words }, stride);
+        }
+
+        bool decompress(const char* stream, std::size_t stream_size, std::uint32_t* words, std::size_t count, std::size_t stride) {
+            std::uint64_t chunk_count;
+            if (stream_size < sizeof(chunk_count)) return false;
+            std::memcpy(&chunk_count, stream, sizeof(chunk_count));
+
+            if (chunk_count != (count + ChunkSize - 1) / ChunkSize) return false;
+            if (stream_size < sizeof(std::uint64_t) * (chunk_count + 1)) return false;
+
+            std::vector<std::size_t> chunk_offsets(chunk_count + 1);
+            chunk_offsets[0] = sizeof(std::uint64_t) * (chunk_count + 1);
+
+            for (std::size_t chunk { 0 }; chunk < chunk_count; ++chunk) {
+                std::uint64_t chunk_size;
+                std::memcpy(&chunk_size, stream + sizeof(std::uint64_t) * (chunk + 1), sizeof(chunk_size));
+                chunk_offsets[chunk + 1] = chunk_offsets[chunk] + chunk_size;
+                if (chunk_offsets[chunk + 1] > stream_size) return false;
+            }
+
+            if (chunk_offsets[chunk_count] != stream_size) return false;
+
+            std::atomic<bool> valid { true };
+
+            JobSystem::get().parallel_for(0, static_cast<int>(chunk_count), 1, [&](int chunk) {
+                std::size_t first { chunk * ChunkSize };
+                if (!decompress_chunk(reinterpret_cast<const unsigned char*>(stream) + chunk_offsets[chunk],
+                                      chunk_offsets[chunk + 1] - chunk_offsets[chunk],
+                                      words + first, std::min(ChunkSize, count - first), stride)) {
+                    valid = false;
+                }
+            });
+
+            return valid;
+        }
+
+        bool decompress(const char* stream, std::size_t stream_size, float* floats, std::size_t count, std::size_t stride) {
+            std::vector<std::uint32_t> words(count);
+            if (!decompress(stream, stream_size, words.data(), count, stride))
+                return false;
+            for (auto& word : words) word = ordered_to_float(word);
+            std::memcpy(floats, words.data(), count * sizeof(float));
+            return true;
+        }
+    }
+}
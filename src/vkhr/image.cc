@@ -6,7 +6,13 @@
 #include <stb_image_write.h>
 #include <stb_image.h>
 
+#include <emmintrin.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cmath>
 #include <ctime>
+#include <limits>
 #include <cstring>
 #include <cstdio>
 
@@ -88,16 +94,16 @@ namespace vkhr {
 
         if (extension == "png") error = stbi_write_png(file_path.c_str(), width, height,
                                                        Channels, image_data, 0);
-        if (extension == "bmp") error = stbi_write_bmp(file_path.c_str(), width, height,
-                                                       Channels, image_data);
-        if (extension == "tga") error = stbi_write_tga(file_path.c_str(), width, height,
-                                                       Channels, image_data);
-        if (extension == "jpg") error = stbi_write_jpg(file_path.c_str(), width, height,
-                                                       Channels, image_data,
-                                                       save_jpg_quality);
+        else if (extension == "bmp") error = stbi_write_bmp(file_path.c_str(), width, height,
+                                                            Channels, image_data);
+        else if (extension == "tga") error = stbi_write_tga(file_path.c_str(), width, height,
+                                                            Channels, image_data);
+        else if (extension == "jpg") error = stbi_write_jpg(file_path.c_str(), width, height,
+                                                            Channels, image_data,
+                                                            save_jpg_quality);
         else return false; // Specify file extension.
 
-        return !error;
+        return error != 0; // stb returns 0 on failure.
     }
 
     std::string Image::save_time() const {
@@ -105,6 +111,12 @@ namespace vkhr {
     }
 
     std::string Image::save_time(const std::string& path) const {
+        auto file = get_time_file_path(path);
+        save(file);
+        return file;
+    }
+
+    std::string Image::get_time_file_path(const std::string& path) {
         time_t current_time { time(0) };
         struct tm time_structure;
         char current_time_buffer[80];
@@ -123,8 +135,6 @@ namespace vkhr {
             file = path + "/" + date + ".png";
         }
 
-        save(file);
-
         return file;
     }
 
@@ -188,24 +198,30 @@ namespace vkhr {
     }
 
     void Image::clear(const Color& color) {
-        #pragma omp parallel for schedule(dynamic)
-        for (int j = 0; j < get_height(); ++j)
-        for (int i = 0; i < get_width();  ++i)
-            set_pixel(i, j, color);
-    }
-
-    void Image::copy(const std::vector<glm::dvec3>& buffer, double samples) {
-        #pragma omp parallel for schedule(dynamic)
-        for (int j = 0; j < get_height(); ++j)
-        for (int i = 0; i < get_width();  ++i) {
-            std::size_t pixel { i + j * get_width() };
-            set_pixel(get_width() - i - 1, j, {
-                static_cast<unsigned char>(glm::clamp(buffer[pixel].r / samples, 0.0, 1.0) * 255.0),
-                static_cast<unsigned char>(glm::clamp(buffer[pixel].g / samples, 0.0, 1.0) * 255.0),
-                static_cast<unsigned char>(glm::clamp(buffer[pixel].b / samples, 0.0, 1.0) * 255.0),
-                255
-            });
-        }
+        JobSystem::get().parallel_for(0, get_height(), 16, [&](int j) {
+            for (int i = 0; i < get_width();  ++i)
+                set_pixel(i, j, color);
+        });
+    }
+
+    void Image::copy(const glm::vec4* buffer) {
+        const __m128 scale { _mm_set1_ps(255.0f) };
+        const __m128 zero  { _mm_setzero_ps() };
+        const __m128 one   { _mm_set1_ps(255.0f) };
+
+        JobSystem::get().parallel_for(0, get_height(), 16, [&](int j) {
+            auto row = reinterpret_cast<std::uint32_t*>(get_pixels() + j * get_width());
+            for (int i = 0; i < get_width(); ++i) {
+                __m128 color = _mm_loadu_ps(&buffer[i + j * get_width()][0]);
+                __m128 count = _mm_shuffle_ps(color, color, _MM_SHUFFLE(3, 3, 3, 3));
+                color = _mm_div_ps(_mm_mul_ps(color, scale), count); // NaN without samples,
+                color = _mm_min_ps(_mm_max_ps(color, zero), one); // which max turns to 0.
+                __m128i channels = _mm_cvttps_epi32(color);
+                channels = _mm_packs_epi32(channels, channels);
+                channels = _mm_packus_epi16(channels, channels);
+                row[get_width() - i - 1] = static_cast<std::uint32_t>(_mm_cvtsi128_si32(channels)) | 0xff000000;
+            }
+        });
     }
 
     void Image::resize(const unsigned width, const unsigned height) {
@@ -217,28 +233,28 @@ namespace vkhr {
         const float x_ratio { width  / static_cast<float>(this->width) },
                     y_ratio { height / static_cast<float>(this->height) };
 
-        #pragma omp parallel for schedule(dynamic)
-        for (int j = 0; j < height; ++j)
-        for (int i { 0 }; i < width;  ++i) {
-            int nearest_i = static_cast<int>(i / y_ratio),
-                nearest_j = static_cast<int>(j / x_ratio);
-            auto nearest_pixel = get_pixel(nearest_i, nearest_j);
-            resized_image.set_pixel(i, j, nearest_pixel);
-        }
+        JobSystem::get().parallel_for(0, height, 16, [&](int j) {
+            for (int i { 0 }; i < width;  ++i) {
+                int nearest_i = static_cast<int>(i / y_ratio),
+                    nearest_j = static_cast<int>(j / x_ratio);
+                auto nearest_pixel = get_pixel(nearest_i, nearest_j);
+                resized_image.set_pixel(i, j, nearest_pixel);
+            }
+        });
 
         *this = resized_image;
     }
 
     void Image::horizontal_flip() {
         unsigned half_width { width >> 1  };
-        #pragma omp parallel for schedule(dynamic)
-        for (int j = 0; j < height; ++j)
-        for (int i { 0 }; i < half_width; ++i) {
-            auto left_color  = get_pixel(i, j);
-            auto right_color = get_pixel(width - i - 1, j);
-            set_pixel(width - i - 1, j, left_color);
-            set_pixel(i, j, right_color);
-        }
+        JobSystem::get().parallel_for(0, height, 16, [&](int j) {
+            for (int i { 0 }; i < half_width; ++i) {
+                auto left_color  = get_pixel(i, j);
+                auto right_color = get_pixel(width - i - 1, j);
+                set_pixel(width - i - 1, j, left_color);
+                set_pixel(i, j, right_color);
+            }
+        });
     }
 
     void Image::vertical_flip() {
@@ -246,30 +262,56 @@ namespace vkhr {
     }
 
     void Image::flip_channels() {
-        #pragma omp parallel for schedule(dynamic)
-        for (int j = 0; j < height; ++j)
-        for (int i { 0 }; i < width; ++i) {
-            auto color = get_pixel(i, j);
-            color.a = 255; // Alpha hack.
-            std::swap(color.r, color.b);
-            set_pixel(i, j, color);
-        }
+        JobSystem::get().parallel_for(0, height, 16, [&](int j) {
+            for (int i { 0 }; i < width; ++i) {
+                auto color = get_pixel(i, j);
+                color.a = 255; // Alpha hack.
+                std::swap(color.r, color.b);
+                set_pixel(i, j, color);
+            }
+        });
     }
 
     std::size_t Image::get_shaded_pixel_count(const Color& background_color) const {
-        std::size_t shaded_pixels { 0 };
-        #pragma omp parallel for schedule(dynamic)
-        for (int j = 0; j < height; ++j)
-        for (int i = 0; i < width;  ++i) {
-            if (get_pixel(i, j) != background_color) {
-                #pragma omp atomic
-                shaded_pixels += 1;
+        std::atomic<std::size_t> shaded_pixels { 0 };
+        JobSystem::get().parallel_for(0, height, 16, [&](int j) {
+            std::size_t shaded_row_pixels { 0 };
+            for (int i = 0; i < width;  ++i) {
+                if (get_pixel(i, j) != background_color)
+                    shaded_row_pixels += 1;
             }
-        }
+
+            shaded_pixels += shaded_row_pixels;
+        });
 
         return shaded_pixels;
     }
 
+    float Image::get_root_mean_square_error(const Image& image, Image* difference_image) const {
+        if (image.width != width || image.height != height || get_pixel_count() == 0)
+            return std::numeric_limits<float>::infinity();
+
+        if (difference_image != nullptr)
+            *difference_image = Image { width, height };
+
+        // Summed per row, and then those in order, so it's the same error every time it's computed.
+        std::vector<double> squared_row_errors(height, 0.0);
+        JobSystem::get().parallel_for(0, height, 16, [&](int j) {
+            for (int i = 0; i < width;  ++i) {
+                glm::ivec3 difference { glm::abs(glm::ivec3 { get_pixel(i, j) } - glm::ivec3 { image.get_pixel(i, j) }) };
+                squared_row_errors[j] += glm::dot(glm::dvec3 { difference } / 255.0, glm::dvec3 { difference } / 255.0);
+                if (difference_image != nullptr)
+                    difference_image->set_pixel(i, j, { difference, 0xFF });
+            }
+        });
+
+        double squared_error { 0.0 };
+        for (auto squared_row_error : squared_row_errors)
+            squared_error += squared_row_error;
+
+        return static_cast<float>(std::sqrt(squared_error / (3.0 * get_pixel_count())));
+    }
+
     void Image::free_image_buffers() {
         if (image_data != nullptr) {
             if (!is_stb_image) {
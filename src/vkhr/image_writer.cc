@@ -0,0 +1,63 @@
+#include <vkhr/image_writer.hh>
+
+#include <iostream>
+
+namespace vkhr {
+    ImageWriter::~ImageWriter() noexcept {
+        if (!write_thread.joinable())
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock { queue_mutex };
+            stopping = true;
+        }
+
+        queued.notify_one();
+        write_thread.join();
+    }
+
+    void ImageWriter::save(Image&& image, const std::string& file_path) {
+        {
+            std::lock_guard<std::mutex> lock { queue_mutex };
+            queue.emplace_back(std::move(image), file_path);
+        }
+
+        if (!write_thread.joinable())
+            write_thread = std::thread { &ImageWriter::write_loop, this };
+
+        queued.notify_one();
+    }
+
+    void ImageWriter::wait() {
+        std::unique_lock<std::mutex> lock { queue_mutex };
+        written.wait(lock, [&] { return queue.empty() && writing == 0; });
+    }
+
+    std::size_t ImageWriter::get_queued_count() const {
+        std::lock_guard<std::mutex> lock { queue_mutex };
+        return queue.size() + writing;
+    }
+
+    void ImageWriter::write_loop() {
+        std::unique_lock<std::mutex> lock { queue_mutex };
+
+        while (true) {
+            queued.wait(lock, [&] { return stopping || !queue.empty(); });
+
+            if (queue.empty())
+                break; // only stops once everything was written.
+
+            auto image = std::move(queue.front());
+            queue.pop_front();
+            ++writing;
+
+            lock.unlock();
+            if (!image.first.save(image.second))
+                std::cerr << "Couldn't save: " << image.second << "!" << std::endl;
+            lock.lock();
+
+            --writing;
+            written.notify_all();
+        }
+    }
+}
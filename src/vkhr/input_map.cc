@@ -8,6 +8,7 @@ namespace vkhr {
         glfwSetMouseButtonCallback(handle, &mouse_button_callback);
         glfwSetScrollCallback(handle, &scroll_callback);
         glfwSetCharCallback(handle, &char_callback);
+        glfwSetCursorPosCallback(handle, &cursor_callback);
     }
 
     std::unordered_map<GLFWwindow*, InputMap*> InputMap::callback_map;
@@ -16,6 +17,7 @@ namespace vkhr {
                                             int action, int mods) {
         InputMap* mapper { callback_map[window] };
         Input::MouseButton mouse_button { static_cast<Input::MouseButton>(button) };
+        mapper->record_event();
 
         auto mouse_state_iter = mapper->mouse_button_state.find(mouse_button);
         if (mouse_state_iter == mapper->mouse_button_state.end())
@@ -40,6 +42,7 @@ namespace vkhr {
     void InputMap::key_callback(GLFWwindow* window, int keyid, int scanid, int action, int mods) {
         InputMap* mapper { callback_map[window] };
         Input::Key key { static_cast<Input::Key>(keyid) };
+        mapper->record_event();
 
         auto key_state_iter = mapper->key_state_map.find(key);
         if (key_state_iter == mapper->key_state_map.end())
@@ -65,13 +68,25 @@ namespace vkhr {
         InputMap* mapper { callback_map[window] };
         mapper->scroll_offsets.x = scroll_x;
         mapper->scroll_offsets.y = scroll_y;
+        mapper->record_event();
         ImGui_ImplGlfw_ScrollCallback(window, scroll_x, scroll_y);
     }
 
     void InputMap::char_callback(GLFWwindow* window, unsigned int codepoint) {
+        callback_map[window]->record_event();
         ImGui_ImplGlfw_CharCallback(window, codepoint);
     }
 
+    void InputMap::cursor_callback(GLFWwindow* window, double, double) {
+        callback_map[window]->record_event(); // ImGui polls the cursor itself.
+    }
+
+    void InputMap::record_event() {
+        if (first_event_time == std::chrono::steady_clock::time_point { })
+            first_event_time = std::chrono::steady_clock::now();
+        ++event_count;
+    }
+
     void InputMap::unbind(const std::string& id) {
         mouse_button_map.erase(id);
         key_map.erase(id);
@@ -255,6 +270,16 @@ namespace vkhr {
         return position;
     }
 
+    std::size_t InputMap::get_event_count() const {
+        return event_count;
+    }
+
+    std::chrono::steady_clock::time_point InputMap::take_event_time() {
+        auto event_time = first_event_time;
+        first_event_time = std::chrono::steady_clock::time_point { };
+        return event_time;
+    }
+
     glm::vec2 InputMap::get_scroll_offset() const {
         return scroll_offsets;
     }
@@ -0,0 +1,283 @@
+#include <vkhr/job_system.hh>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <fstream>
+#include <string>
+
+namespace vkhr {
+    static std::atomic<unsigned> configured_worker_count { 0 };
+
+    static thread_local unsigned thread_index { 0 };
+    static thread_local unsigned numa_node { 0 };
+
+    // The cores of every NUMA node that has any, from e.g. "0-7,16-23" in the node's cpulist.
+    static std::vector<std::vector<int>> find_numa_nodes() {
+        std::vector<std::vector<int>> nodes;
+#ifdef __linux__
+        constexpr unsigned MaximumNodes { 64 }; // they don't have to be numbered contiguously.
+        for (unsigned node { 0 }; node < MaximumNodes; ++node) {
+            std::ifstream cpulist { "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist" };
+            if (!cpulist)
+                continue;
+
+            std::vector<int> cores;
+            std::string range;
+            while (std::getline(cpulist, range, ',')) {
+                try {
+                    auto dash = range.find('-');
+                    int first = std::stoi(range),
+                        last  = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+                    for (int core { first }; core <= last; ++core)
+                        cores.push_back(core);
+                } catch (...) {
+                    continue; // e.g. the empty line of the nodes that only have memory.
+                }
+            }
+
+            if (!cores.empty())
+                nodes.push_back(std::move(cores));
+        }
+#endif
+        return nodes;
+    }
+
+    JobSystem& JobSystem::get() {
+        static JobSystem job_system { configured_worker_count };
+        return job_system;
+    }
+
+    void JobSystem::set_thread_count(unsigned worker_count) {
+        configured_worker_count = worker_count;
+    }
+
+    unsigned JobSystem::get_thread_count() const {
+        return static_cast<unsigned>(workers.size()) + 1;
+    }
+
+    unsigned JobSystem::get_thread_index() {
+        return thread_index;
+    }
+
+    unsigned JobSystem::get_numa_node_count() const {
+        return numa_node_count;
+    }
+
+    unsigned JobSystem::get_numa_node() {
+        return numa_node;
+    }
+
+    JobSystem::Task::Task(Job job, Priority priority) : job { std::move(job) }, priority { priority } { }
+
+    JobSystem::JobSystem(unsigned worker_count) {
+        if (worker_count == 0) // the calling thread is the last core.
+            worker_count = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+        for (unsigned worker { 0 }; worker < worker_count; ++worker)
+            worker_queues.push_back(std::make_unique<WorkerQueue>());
+
+        worker_nodes.assign(worker_count, 0);
+        worker_cores.assign(worker_count, -1);
+
+        // Only pinned with more than one node, where not being so moves them away from their data.
+        auto nodes = find_numa_nodes();
+        if (nodes.size() > 1) {
+            numa_node_count = static_cast<unsigned>(nodes.size());
+            std::vector<unsigned> node_workers(nodes.size(), 0);
+            for (unsigned worker { 0 }; worker < worker_count; ++worker) {
+                auto node = static_cast<unsigned>(static_cast<std::size_t>(worker) * nodes.size() / worker_count);
+                worker_nodes[worker] = node;
+                worker_cores[worker] = nodes[node][node_workers[node]++ % nodes[node].size()];
+            }
+        }
+
+        for (unsigned worker { 0 }; worker < worker_count; ++worker)
+            workers.emplace_back(&JobSystem::worker_loop, this, worker);
+    }
+
+    JobSystem::~JobSystem() noexcept {
+        {
+            std::lock_guard<std::mutex> lock { sleep_mutex };
+            stopping = true;
+        }
+
+        sleep_condition.notify_all();
+
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+    JobSystem::Handle JobSystem::submit(Job job, const std::vector<Handle>& dependencies, Priority priority) {
+        auto task = std::make_shared<Task>(std::move(job), priority);
+
+        for (const auto& dependency : dependencies) {
+            if (!dependency)
+                continue;
+            std::lock_guard<std::mutex> lock { dependency->mutex };
+            if (!dependency->finished) {
+                ++task->unfinished_dependencies;
+                dependency->dependents.push_back(task);
+            }
+        }
+
+        if (--task->unfinished_dependencies == 0)
+            enqueue(task);
+
+        return task;
+    }
+
+    void JobSystem::wait(const Handle& task) {
+        if (!task)
+            return;
+
+        if (auto worker = get_thread_index()) {
+            while (!is_done(task))
+                if (!run_one(worker - 1))
+                    std::this_thread::yield();
+        }
+
+        std::unique_lock<std::mutex> lock { task->mutex };
+        task->finished_condition.wait(lock, [&] { return task->finished; });
+
+        if (task->exception)
+            std::rethrow_exception(task->exception);
+    }
+
+    void JobSystem::wait(const std::vector<Handle>& tasks) {
+        std::exception_ptr exception;
+
+        for (const auto& task : tasks) {
+            try {
+                wait(task);
+            } catch (...) {
+                if (!exception)
+                    exception = std::current_exception();
+            }
+        }
+
+        if (exception) // after all of them, since they might use what's on the caller's stack.
+            std::rethrow_exception(exception);
+    }
+
+    bool JobSystem::is_done(const Handle& task) {
+        if (!task)
+            return true;
+        std::lock_guard<std::mutex> lock { task->mutex };
+        return task->finished;
+    }
+
+    void JobSystem::worker_loop(unsigned worker) {
+        thread_index = worker + 1;
+        numa_node = worker_nodes[worker];
+
+#ifdef __linux__
+        if (worker_cores[worker] >= 0) {
+            cpu_set_t cores;
+            CPU_ZERO(&cores);
+            CPU_SET(worker_cores[worker], &cores);
+            pthread_setaffinity_np(pthread_self(), sizeof(cores), &cores); // it still runs if not.
+        }
+#endif
+
+        while (true) {
+            if (run_one(worker))
+                continue;
+
+            std::unique_lock<std::mutex> lock { sleep_mutex };
+            sleep_condition.wait(lock, [&] { return stopping || queued_tasks != 0; });
+            if (stopping)
+                return;
+        }
+    }
+
+    void JobSystem::enqueue(Handle task) {
+        {
+            std::lock_guard<std::mutex> lock { sleep_mutex };
+            ++queued_tasks; // before, so it never goes below 0 when it's dequeued.
+        }
+
+        if (task->priority == Low) {
+            std::lock_guard<std::mutex> lock { low_priority_queue.mutex };
+            low_priority_queue.tasks.push_back(std::move(task));
+        } else {
+            // The workers' own jobs stay on them (they're likely nested loops), the rest are spread.
+            auto worker = get_thread_index();
+            auto queue = worker ? worker - 1 : next_queue++ % worker_queues.size();
+            std::lock_guard<std::mutex> lock { worker_queues[queue]->mutex };
+            worker_queues[queue]->tasks.push_front(std::move(task));
+        }
+
+        sleep_condition.notify_one();
+    }
+
+    JobSystem::Handle JobSystem::dequeue(unsigned worker) {
+        Handle task;
+
+        if (queued_tasks == 0)
+            return task;
+
+        for (std::size_t i { 0 }; i < worker_queues.size() && !task; ++i) {
+            auto& queue = *worker_queues[(worker + i) % worker_queues.size()];
+            std::lock_guard<std::mutex> lock { queue.mutex };
+            if (queue.tasks.empty())
+                continue;
+            if (i == 0) {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            } else { // steals the oldest one, which is likely the largest.
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+        }
+
+        if (!task) {
+            std::lock_guard<std::mutex> lock { low_priority_queue.mutex };
+            if (!low_priority_queue.tasks.empty()) {
+                task = std::move(low_priority_queue.tasks.front());
+                low_priority_queue.tasks.pop_front();
+            }
+        }
+
+        if (task)
+            --queued_tasks;
+
+        return task;
+    }
+
+    bool JobSystem::run_one(unsigned worker) {
+        auto task = dequeue(worker);
+        if (!task)
+            return false;
+
+        try {
+            task->job();
+        } catch (...) {
+            task->exception = std::current_exception();
+        }
+
+        finish(task);
+
+        return true;
+    }
+
+    void JobSystem::finish(const Handle& task) {
+        std::vector<Handle> dependents;
+
+        {
+            std::lock_guard<std::mutex> lock { task->mutex };
+            task->finished = true;
+            task->job = nullptr; // and what it captured.
+            dependents.swap(task->dependents);
+        }
+
+        task->finished_condition.notify_all();
+
+        for (auto& dependent : dependents) {
+            if (--dependent->unfinished_dependencies == 0)
+                enqueue(dependent);
+        }
+    }
+}
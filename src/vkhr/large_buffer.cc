@@ -0,0 +1,34 @@
+#include <vkhr/large_buffer.hh>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#include <new>
+
+namespace vkhr {
+    namespace large_buffer {
+        // The same for the same size, so deallocate can tell which of them it was allocated with.
+        static std::size_t get_alignment(std::size_t size_in_bytes) {
+            return size_in_bytes >= HugePageSize ? HugePageSize : CacheLineSize;
+        }
+
+        void* allocate(std::size_t size_in_bytes) {
+            auto alignment = get_alignment(size_in_bytes);
+            auto size = (size_in_bytes + alignment - 1) / alignment * alignment;
+
+            void* memory = ::operator new(size, std::align_val_t { alignment });
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+            if (alignment == HugePageSize)
+                madvise(memory, size, MADV_HUGEPAGE); // before it's touched, and fine if it fails.
+#endif
+
+            return memory;
+        }
+
+        void deallocate(void* memory, std::size_t size_in_bytes) noexcept {
+            ::operator delete(memory, std::align_val_t { get_alignment(size_in_bytes) });
+        }
+    }
+}
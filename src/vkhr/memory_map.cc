@@ -0,0 +1,151 @@
+#include <vkhr/memory_map.hh>
+
+#ifndef   WINDOWS
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <windows.h>
+#endif
+
+#include <utility>
+
+namespace vkhr {
+    MemoryMap::MemoryMap(const std::string& file_path) {
+        open(file_path);
+    }
+
+    MemoryMap::~MemoryMap() noexcept {
+        close();
+    }
+
+    MemoryMap::MemoryMap(MemoryMap&& memory_map) noexcept {
+        swap(*this, memory_map);
+    }
+
+    MemoryMap& MemoryMap::operator=(MemoryMap&& memory_map) noexcept {
+        swap(*this, memory_map);
+        return *this;
+    }
+
+    void swap(MemoryMap& lhs, MemoryMap& rhs) {
+        using std::swap;
+
+        swap(lhs.data, rhs.data);
+        swap(lhs.size, rhs.size);
+
+#ifndef WINDOWS
+        swap(lhs.file_descriptor, rhs.file_descriptor);
+#else
+        swap(lhs.file_handle,    rhs.file_handle);
+        swap(lhs.mapping_handle, rhs.mapping_handle);
+#endif
+    }
+
+    MemoryMap::operator bool() const {
+        return data != nullptr;
+    }
+
+    bool MemoryMap::open(const std::string& file_path) {
+        close(); // Drops any previous mapping.
+
+#ifndef WINDOWS
+        file_descriptor = ::open(file_path.c_str(), O_RDONLY);
+        if (file_descriptor == -1) return false;
+
+        struct stat file_status;
+        if (fstat(file_descriptor, &file_status) == -1 || file_status.st_size == 0) {
+            close();
+            return false;
+        }
+
+        size = static_cast<std::size_t>(file_status.st_size);
+
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+
+        if (mapping == MAP_FAILED) {
+            close();
+            return false;
+        }
+
+        // We walk the arrays front-to-back when uploading them.
+        madvise(mapping, size, MADV_SEQUENTIAL);
+        madvise(mapping, size, MADV_WILLNEED);
+
+        data = static_cast<const char*>(mapping);
+#else
+        file_handle = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                                  nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN,
+                                  nullptr);
+        if (file_handle == INVALID_HANDLE_VALUE) {
+            file_handle = nullptr;
+            return false;
+        }
+
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file_handle, &file_size) || file_size.QuadPart == 0) {
+            close();
+            return false;
+        }
+
+        size = static_cast<std::size_t>(file_size.QuadPart);
+
+        mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        if (mapping_handle == nullptr) {
+            close();
+            return false;
+        }
+
+        data = static_cast<const char*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+
+        if (data == nullptr) {
+            close();
+            return false;
+        }
+#endif
+
+        return true;
+    }
+
+    void MemoryMap::close() {
+#ifndef WINDOWS
+        if (data != nullptr)
+            munmap(const_cast<char*>(data), size);
+        if (file_descriptor != -1)
+            ::close(file_descriptor);
+        file_descriptor = -1;
+#else
+        if (data != nullptr)
+            UnmapViewOfFile(data);
+        if (mapping_handle != nullptr)
+            CloseHandle(mapping_handle);
+        if (file_handle != nullptr)
+            CloseHandle(file_handle);
+        mapping_handle = nullptr;
+        file_handle    = nullptr;
+#endif
+
+        data = nullptr;
+        size = 0;
+    }
+
+    void MemoryMap::evict() const {
+        if (data == nullptr) return;
+#ifndef WINDOWS
+        madvise(const_cast<char*>(data), size, MADV_DONTNEED);
+#else
+        // Unlocking pages that aren't locked takes them out of the working set.
+        VirtualUnlock(const_cast<char*>(data), size);
+#endif
+    }
+
+    const char* MemoryMap::get_data() const {
+        return data;
+    }
+
+    std::size_t MemoryMap::get_size() const {
+        return size;
+    }
+}
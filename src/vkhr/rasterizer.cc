@@ -1,5 +1,8 @@
 #include <vkhr/rasterizer.hh>
+#include <vkhr/job_system.hh>
 
+#include <algorithm>
+#include <cmath>
 #include <ctime>
 #include <cstring>
 #include <filesystem>
@@ -7,9 +10,21 @@
 #include <iomanip>
 #include <cstdio>
 #include <cctype>
+#include <limits>
+#include <fstream>
+#include <type_traits>
 
 namespace vkhr {
-    Rasterizer::Rasterizer(Window& window, const SceneGraph& scene_graph) {
+    // FNV-1a, so the same state hashes the same in every run.
+    static std::size_t hash_bytes(std::size_t hash, const void* data, std::size_t size) {
+        auto bytes = static_cast<const unsigned char*>(data);
+        for (std::size_t i { 0 }; i < size; ++i)
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        return hash;
+    }
+
+    Rasterizer::Rasterizer(Window& window, const SceneGraph& scene_graph, std::uint32_t frames_in_flight, bool device_group)
+                          : frames_in_flight { std::clamp(frames_in_flight, 2u, 3u) } {
         vk::Version target_vulkan_loader { 1,1 };
         vk::Application application_information {
             "VKHR", { 1, 0, 0 },
@@ -29,8 +44,12 @@ namespace vkhr {
         #endif
         };
 
-        vk::append(window.get_vulkan_surface_extensions(),
-                   required_extensions); // VK_surface_KHR
+        // Off-screen there's no surface, so it runs without a display, e.g. in the CI benchmarks.
+        bool offscreen { window.is_offscreen() };
+
+        if (!offscreen)
+            vk::append(window.get_vulkan_surface_extensions(),
+                       required_extensions); // VK_surface_KHR
 
         instance = vk::Instance {
             application_information,
@@ -38,49 +57,334 @@ namespace vkhr {
             required_extensions
         };
 
-        window_surface = window.create_vulkan_surface_with(instance);
+        if (!offscreen)
+            window_surface = window.create_vulkan_surface_with(instance);
+        else
+            window_surface.set_glfw_window(window); // only for the UI.
 
         // Find physical devices that seem most promising of the lot.
         auto score = [&](const vk::PhysicalDevice& physical_device) {
             short gpu_suitable = 2*physical_device.is_discrete_gpu()+
                                  physical_device.is_integrated_gpu();
             return physical_device.has_every_queue() * gpu_suitable *
-                   physical_device.has_present_queue(window_surface);
+                   (offscreen || physical_device.has_present_queue(window_surface));
         };
 
         physical_device = instance.find_physical_devices_with(score);
         window.append_string(physical_device.get_name()); // our GPU.
-        physical_device.assign_present_queue_indices(window_surface);
 
+        if (!offscreen)
+            physical_device.assign_present_queue_indices(window_surface);
+        else
+            physical_device.assign_present_queue_indices();
+
+        // Off-screen too, since the passes still leave their images in the presentation layout.
         std::vector<vk::Extension> device_extensions {
             "VK_KHR_swapchain"
         };
 
+        // Only for showing the VRAM budget in the UI, see get_memory_budgets.
+        if (physical_device.has_memory_budget())
+            device_extensions.push_back("VK_EXT_memory_budget");
+
+#if defined(VK_GOOGLE_display_timing) && defined(__linux__)
+        // For the input-to-photon latency, since its actualPresentTime is of CLOCK_MONOTONIC, which
+        // is what the steady_clock is here. Elsewhere it's only measured until the GPU is done.
+        const auto& display_timing_extensions_available = physical_device.get_available_extensions();
+        display_timing = std::find(display_timing_extensions_available.begin(), display_timing_extensions_available.end(),
+                                   vk::Extension { "VK_GOOGLE_display_timing" }) != display_timing_extensions_available.end();
+        if (display_timing)
+            device_extensions.push_back("VK_GOOGLE_display_timing");
+#endif
+
         // Just enable every device feature we have right now.
         auto device_features = physical_device.get_features();
+        pipeline_statistics_supported = device_features.pipelineStatisticsQuery;
+        tessellated_curves = device_features.tessellationShader;
+        void* extension_features = nullptr;
+
+#ifdef VK_EXT_mesh_shader
+        // Mesh shaders replace the vertex pulling pipelines for the strands if the GPU has them.
+        std::vector<vk::Extension> mesh_shader_extensions {
+            "VK_EXT_mesh_shader",
+            "VK_KHR_spirv_1_4", // needed by the above on Vulkan 1.1.
+            "VK_KHR_shader_float_controls"
+        };
+
+        const auto& available_extensions = physical_device.get_available_extensions();
+        mesh_shading = std::all_of(mesh_shader_extensions.begin(), mesh_shader_extensions.end(), [&](const vk::Extension& extension) {
+            return std::find(available_extensions.begin(), available_extensions.end(), extension) != available_extensions.end();
+        });
+
+        VkPhysicalDeviceMeshShaderFeaturesEXT mesh_shader_features { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT };
+
+        if (mesh_shading) {
+            VkPhysicalDeviceFeatures2 features { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+            features.pNext = &mesh_shader_features;
+            vkGetPhysicalDeviceFeatures2(physical_device.get_handle(), &features);
+
+            mesh_shading = mesh_shader_features.taskShader && mesh_shader_features.meshShader;
+
+            // Only want the basic stages, and some of these need other extensions to be enabled.
+            mesh_shader_features.multiviewMeshShader = VK_FALSE;
+            mesh_shader_features.primitiveFragmentShadingRateMeshShader = VK_FALSE;
+            mesh_shader_features.meshShaderQueries = VK_FALSE;
+        }
+
+        if (mesh_shading) {
+            device_extensions.insert(device_extensions.end(), mesh_shader_extensions.begin(), mesh_shader_extensions.end());
+            extension_features = &mesh_shader_features;
+        }
+#endif
+
+#ifdef VK_KHR_timeline_semaphore
+        // Paces the frames in flight with one semaphore instead of a fence per frame.
+        const auto& device_extensions_available = physical_device.get_available_extensions();
+        timeline_pacing = std::find(device_extensions_available.begin(), device_extensions_available.end(),
+                                    vk::Extension { "VK_KHR_timeline_semaphore" }) != device_extensions_available.end();
+
+        VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timeline_semaphore_features { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR };
+
+        if (timeline_pacing) {
+            VkPhysicalDeviceFeatures2 features { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+            features.pNext = &timeline_semaphore_features;
+            vkGetPhysicalDeviceFeatures2(physical_device.get_handle(), &features);
+            timeline_pacing = timeline_semaphore_features.timelineSemaphore;
+        }
+
+        if (timeline_pacing) {
+            device_extensions.push_back("VK_KHR_timeline_semaphore");
+            timeline_semaphore_features.pNext = extension_features;
+            extension_features = &timeline_semaphore_features;
+        }
+#endif
+
+#ifdef VK_KHR_draw_indirect_count
+        // For drawing all of the hair styles in a shadow map with a single draw, see vulkan::HairBatch.
+        const auto& indirect_count_extensions_available = physical_device.get_available_extensions();
+        indirect_count = std::find(indirect_count_extensions_available.begin(), indirect_count_extensions_available.end(),
+                                   vk::Extension { "VK_KHR_draw_indirect_count" }) != indirect_count_extensions_available.end();
+
+        // The gl_DrawID of strand_batch_depth.vert, which is core in 1.1 but needs its feature.
+        VkPhysicalDeviceShaderDrawParametersFeatures draw_parameters_features { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_DRAW_PARAMETERS_FEATURES };
+
+        if (indirect_count) {
+            VkPhysicalDeviceFeatures2 features { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+            features.pNext = &draw_parameters_features;
+            vkGetPhysicalDeviceFeatures2(physical_device.get_handle(), &features);
+            indirect_count = draw_parameters_features.shaderDrawParameters &&
+                             device_features.multiDrawIndirect &&
+                             device_features.drawIndirectFirstInstance;
+        }
+
+        if (indirect_count) {
+            device_extensions.push_back("VK_KHR_draw_indirect_count");
+            draw_parameters_features.pNext = extension_features;
+            extension_features = &draw_parameters_features;
+        }
+#endif
+
+#ifdef VK_KHR_ray_query
+        // For tracing the hair on the GPU from a compute shader, see vulkan::Raytracer.
+        std::vector<vk::Extension> ray_query_extensions {
+            "VK_KHR_ray_query",
+            "VK_KHR_acceleration_structure",
+            "VK_KHR_deferred_host_operations", // needed by the above,
+            "VK_KHR_buffer_device_address",
+            "VK_EXT_descriptor_indexing",
+            "VK_KHR_spirv_1_4", // and these are on Vulkan 1.1.
+            "VK_KHR_shader_float_controls"
+        };
+
+        const auto& ray_query_extensions_available = physical_device.get_available_extensions();
+        ray_queries = std::all_of(ray_query_extensions.begin(), ray_query_extensions.end(), [&](const vk::Extension& extension) {
+            return std::find(ray_query_extensions_available.begin(), ray_query_extensions_available.end(), extension) != ray_query_extensions_available.end();
+        });
+
+        VkPhysicalDeviceRayQueryFeaturesKHR ray_query_features { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_QUERY_FEATURES_KHR };
+        VkPhysicalDeviceAccelerationStructureFeaturesKHR acceleration_structure_features { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_FEATURES_KHR };
+        VkPhysicalDeviceBufferDeviceAddressFeaturesKHR buffer_device_address_features { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES_KHR };
+
+        if (ray_queries) {
+            acceleration_structure_features.pNext = &buffer_device_address_features;
+            ray_query_features.pNext = &acceleration_structure_features;
+
+            VkPhysicalDeviceFeatures2 features { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+            features.pNext = &ray_query_features;
+            vkGetPhysicalDeviceFeatures2(physical_device.get_handle(), &features);
+
+            ray_queries = ray_query_features.rayQuery &&
+                          acceleration_structure_features.accelerationStructure &&
+                          buffer_device_address_features.bufferDeviceAddress;
+
+            // Only the basic ones, and not e.g. the capture replay, which needs more to be enabled.
+            acceleration_structure_features.accelerationStructureCaptureReplay = VK_FALSE;
+            acceleration_structure_features.accelerationStructureIndirectBuild = VK_FALSE;
+            acceleration_structure_features.accelerationStructureHostCommands = VK_FALSE;
+            buffer_device_address_features.bufferDeviceAddressCaptureReplay = VK_FALSE;
+            buffer_device_address_features.bufferDeviceAddressMultiDevice = VK_FALSE;
+        }
+
+        if (ray_queries) {
+            for (const auto& extension : ray_query_extensions) // some might be in there for the mesh shaders.
+                if (std::find(device_extensions.begin(), device_extensions.end(), extension) == device_extensions.end())
+                    device_extensions.push_back(extension);
+            buffer_device_address_features.pNext = extension_features;
+            extension_features = &ray_query_features;
+        }
+#endif
+
+#ifdef VK_NV_shading_rate_image
+        // For shading the dense interior of the hair coarsely, see vulkan::ShadingRateImage.
+        std::vector<vk::Extension> shading_rate_extensions {
+            "VK_NV_shading_rate_image",
+            "VK_EXT_post_depth_coverage" // for the coverage of the coarse fragments.
+        };
+
+        const auto& shading_rate_extensions_available = physical_device.get_available_extensions();
+        shading_rate_images = std::all_of(shading_rate_extensions.begin(), shading_rate_extensions.end(), [&](const vk::Extension& extension) {
+            return std::find(shading_rate_extensions_available.begin(), shading_rate_extensions_available.end(), extension) != shading_rate_extensions_available.end();
+        });
+
+        VkPhysicalDeviceShadingRateImageFeaturesNV shading_rate_image_features { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADING_RATE_IMAGE_FEATURES_NV };
+        VkPhysicalDeviceShadingRateImagePropertiesNV shading_rate_image_properties { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADING_RATE_IMAGE_PROPERTIES_NV };
+
+        if (shading_rate_images) {
+            VkPhysicalDeviceFeatures2 features { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+            features.pNext = &shading_rate_image_features;
+            vkGetPhysicalDeviceFeatures2(physical_device.get_handle(), &features);
+
+            VkPhysicalDeviceProperties2 properties { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2 };
+            properties.pNext = &shading_rate_image_properties;
+            vkGetPhysicalDeviceProperties2(physical_device.get_handle(), &properties);
+
+            shading_rate_images = shading_rate_image_features.shadingRateImage &&
+                                  shading_rate_image_properties.shadingRatePaletteSize >= vulkan::ShadingRateImage::get_palette().size();
+            shading_rate_texel_size = shading_rate_image_properties.shadingRateTexelSize;
+
+            // The pixel-major order isn't a custom one, so it doesn't need it.
+            shading_rate_image_features.shadingRateCoarseSampleOrder = VK_FALSE;
+        }
+
+        if (shading_rate_images) {
+            device_extensions.insert(device_extensions.end(), shading_rate_extensions.begin(), shading_rate_extensions.end());
+            shading_rate_image_features.pNext = extension_features;
+            extension_features = &shading_rate_image_features;
+        }
+#endif
+
+        // Only the feature is needed since it's core, see draw_multiview_depth.
+        VkPhysicalDeviceMultiviewFeatures multiview_features { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES };
+        VkPhysicalDeviceMultiviewProperties multiview_properties { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_PROPERTIES };
+
+        VkPhysicalDeviceFeatures2 multiview_query { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+        multiview_query.pNext = &multiview_features;
+        vkGetPhysicalDeviceFeatures2(physical_device.get_handle(), &multiview_query);
+
+        VkPhysicalDeviceProperties2 multiview_limits { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2 };
+        multiview_limits.pNext = &multiview_properties;
+        vkGetPhysicalDeviceProperties2(physical_device.get_handle(), &multiview_limits);
+
+        multiview_supported = multiview_features.multiview;
+        max_multiview_views = multiview_properties.maxMultiviewViewCount;
+
+        stereo_rendering = scene_graph.get_camera().is_stereo() && multiview_supported &&
+                           max_multiview_views >= vulkan::StereoTarget::Eyes;
+
+        // Their stages would need the multiview features below, see use_stereo_paths.
+        if (stereo_rendering) {
+            mesh_shading = false;
+            tessellated_curves = false;
+        }
+
+        if (multiview_supported) {
+            // Only the vertex and fragment shaders read the view index, see the above.
+            multiview_features.multiviewGeometryShader = VK_FALSE;
+            multiview_features.multiviewTessellationShader = VK_FALSE;
+            multiview_features.pNext = extension_features;
+            extension_features = &multiview_features;
+        }
 
         device = vk::Device {
             physical_device,
             required_layers,
             device_extensions,
-            device_features
+            device_features,
+            extension_features,
+            device_group ? instance.find_device_group(physical_device) : std::vector<VkPhysicalDevice> { }
         };
 
+        // The peer writes the volumes into this GPU's memory, since it can't always read the peer's.
+        peer_voxelization_supported = device.get_device_count() > PeerDevice && device.has_async_compute_queue() &&
+                                      device.has_peer_copies(physical_device.get_device_memory_heap(), PeerDevice, 0);
+        if (peer_voxelization_supported)
+            window.append_string("+" + std::to_string(device.get_device_count() - 1) + " GPU"); // in the group.
+
+#ifdef VK_EXT_mesh_shader
+        if (mesh_shading)
+            vk::CommandBuffer::setup_function_pointers(device.get_handle());
+#endif
+
+#ifdef VK_KHR_timeline_semaphore
+        if (timeline_pacing)
+            vk::TimelineSemaphore::setup_function_pointers(device.get_handle());
+#endif
+
+#ifdef VK_NV_shading_rate_image
+        if (shading_rate_images)
+            vk::CommandBuffer::setup_shading_rate_function_pointers(device.get_handle());
+#endif
+
+#ifdef VK_KHR_draw_indirect_count
+        if (indirect_count)
+            vk::CommandBuffer::setup_indirect_count_function_pointers(device.get_handle());
+#endif
+
+#ifdef VK_GOOGLE_display_timing
+        if (display_timing)
+            vk::SwapChain::setup_display_timing_function_pointers(device.get_handle());
+#endif
+
+#ifdef VK_KHR_ray_query
+        if (ray_queries) {
+            vk::AddressableBuffer::setup_function_pointers(device.get_handle());
+            vk::AccelerationStructure::setup_function_pointers(device.get_handle());
+        }
+#endif
+
+        std::filesystem::create_directories(CACHE(""));
+        pipeline_cache = vk::PipelineCache { device, CACHE("") };
+        device.set_pipeline_cache(pipeline_cache.get_handle());
+
         command_pool = vk::CommandPool { device, device.get_graphics_queue() };
+        staging_ring = vk::StagingRing { device, command_pool };
 
         auto presentation_mode = vk::SwapChain::mode(window.vsync_requested());
 
-        swap_chain = vk::SwapChain {
-            device,
-            window_surface,
-            command_pool,
-            {
-                VK_FORMAT_B8G8R8A8_UNORM,
-                VK_COLOR_SPACE_SRGB_NONLINEAR_KHR
-            },
-            presentation_mode,
-            window.get_extent()
-        };
+        if (offscreen) {
+            swap_chain = vk::SwapChain {
+                device,
+                command_pool,
+                {
+                    VK_FORMAT_B8G8R8A8_UNORM,
+                    VK_COLOR_SPACE_SRGB_NONLINEAR_KHR
+                },
+                window.get_extent(),
+                this->frames_in_flight // it's never waited for, so this is enough.
+            };
+        } else {
+            swap_chain = vk::SwapChain {
+                device,
+                window_surface,
+                command_pool,
+                {
+                    VK_FORMAT_B8G8R8A8_UNORM,
+                    VK_COLOR_SPACE_SRGB_NONLINEAR_KHR
+                },
+                presentation_mode,
+                window.get_extent()
+            };
+        }
 
         depth_sampler = vk::Sampler {
             device, // for sampling depth buffer.
@@ -89,33 +393,101 @@ namespace vkhr {
             VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE
         };
 
+        std::vector<VkDescriptorPoolSize> descriptor_pool_sizes {
+            { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,        128 },
+            { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 96 },
+            { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 128 },
+            { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,        256 },
+            { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,  8 },
+            { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,          64 },
+            { VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,       64 }
+        };
+
+#ifdef VK_KHR_ray_query
+        if (ray_queries) // it's an invalid type without the extension.
+            descriptor_pool_sizes.push_back({ VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, 8 });
+#endif
+
         descriptor_pool = vkpp::DescriptorPool {
+            device,
+            descriptor_pool_sizes
+        };
+
+        // For the copies of the sets with the per-draw resources, e.g. a hair style's volume.
+        descriptor_cache = vkpp::DescriptorCache {
             device,
             {
-                { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,         64 },
-                { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 64 },
-                { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         64 },
-                { VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,       64 }
+                { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,        512 },
+                { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 256 },
+                { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 512 },
+                { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,        1024 },
+                { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,  32 },
+                { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,          128 },
+                { VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,        64 }
             }
         };
 
+        descriptor_pool.set_descriptor_cache(&descriptor_cache);
+
         build_render_passes();
 
         framebuffers = swap_chain.create_framebuffers(color_pass);
 
-        image_available = vk::Semaphore::create(device, swap_chain.size(), "Image Available Semaphore");
+        if (stereo_rendering)
+            stereo_target = vulkan::StereoTarget { *this };
+
+        weighted_blended = vulkan::WeightedBlended { *this };
+        temporal_anti_aliasing = vulkan::TemporalAntiAliasing { *this };
+        hair_target = vulkan::HairTarget { *this };
+#ifdef VK_NV_shading_rate_image
+        if (shading_rate_images)
+            shading_rate_image = vulkan::ShadingRateImage { *this };
+#endif
+
+        create_volume_targets();
+        create_volume_history();
+        create_strand_tiles();
+
+        light_tiles = vulkan::LightTiles { *this, get_color_extent().width, get_color_extent().height,
+                                           stereo_rendering ? vulkan::StereoTarget::Eyes : 1 };
+
+        model_depth_pyramid = vulkan::DepthPyramid { *this, get_color_extent().width, get_color_extent().height };
+
+        scattering_lut = vulkan::ScatteringLut { *this };
+
+        image_available = vk::Semaphore::create(device, frames_in_flight, "Image Available Semaphore");
         render_complete = vk::Semaphore::create(device, swap_chain.size(), "Render Complete Semaphore");
-        command_buffer_finished = vk::Fence::create(device, swap_chain.size(), "Buffer Finished Fence");
 
-        camera = vk::UniformBuffer::create(device, sizeof(vkhr::ViewProjection),  swap_chain.size(), "Camera Matrix Data");
-        params = vk::UniformBuffer::create(device, sizeof(Interface::Parameters), swap_chain.size(), "Rendering Settings");
+#ifdef VK_KHR_timeline_semaphore
+        if (timeline_pacing)
+            frame_timeline = vk::TimelineSemaphore::create(device, "Frame Timeline Semaphore");
+        else
+#endif
+        command_buffer_finished = vk::Fence::create(device, frames_in_flight, "Buffer Finished Fence");
+
+        frame_timeline_values.assign(frames_in_flight, 0); // i.e. nothing to wait for.
+        frame_submit_times.assign(frames_in_flight, std::chrono::steady_clock::time_point { });
+        frame_input_times.assign(frames_in_flight, std::chrono::steady_clock::time_point { });
+        screenshot_readbacks.resize(frames_in_flight);
+
+        for (std::uint32_t i { 0 }; i < frames_in_flight; ++i) {
+            frame_constants.emplace_back(device);
+            vk::DebugMarker::object_name(device, frame_constants.back().get_buffer(), VK_OBJECT_TYPE_BUFFER, "Frame Constants Ring", i);
+        }
+
+        camera.resize(frames_in_flight);
+        lights.resize(frames_in_flight);
+        light_revisions.resize(frames_in_flight);
+        params.resize(frames_in_flight);
 
         ppll = vulkan::LinkedList {
             *this,
             swap_chain.get_width(), swap_chain.get_height(),
             vulkan::LinkedList::NodeSize,
             vulkan::LinkedList::AverageFragmentsPerPixel * swap_chain.get_width() *
-                                                           swap_chain.get_height()
+                                                           swap_chain.get_height(),
+            static_cast<bool>(imgui.parameters.deferred_shading),
+            static_cast<bool>(imgui.parameters.packed_ppll)
         };
 
         fullscreen_billboard = vulkan::Billboard {
@@ -128,275 +500,2876 @@ namespace vkhr {
 
         load(scene_graph);
 
-        query_pools = vk::QueryPool::create(framebuffers.size(), device, VK_QUERY_TYPE_TIMESTAMP, 128);
+        query_pools = vk::QueryPool::create(frames_in_flight, device, VK_QUERY_TYPE_TIMESTAMP, 128);
+
+        if (pipeline_statistics_supported) {
+            statistics_pools = vk::QueryPool::create(frames_in_flight, device, VK_QUERY_TYPE_PIPELINE_STATISTICS, 32,
+                                                     VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT   |
+                                                     VK_QUERY_PIPELINE_STATISTIC_GEOMETRY_SHADER_INVOCATIONS_BIT |
+                                                     VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT         |
+                                                     VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+                                                     VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT);
+        }
+
+        command_buffers = command_pool.allocate(frames_in_flight);
+
+        recording_threads.resize(frames_in_flight);
+        for (auto& frame_recording_threads : recording_threads) {
+            for (unsigned thread { 0 }; thread < JobSystem::get().get_thread_count(); ++thread) {
+                frame_recording_threads.push_back(RecordingThread {
+                    vk::CommandPool { device, device.get_graphics_queue() }
+                });
+            }
+        }
+
+        static_batches.resize(frames_in_flight);
+
+        for (auto& overlay_command_buffer : command_pool.allocate(frames_in_flight, VK_COMMAND_BUFFER_LEVEL_SECONDARY))
+            overlay_batches.push_back(OverlayBatch { std::move(overlay_command_buffer) });
+
+        if (device.has_async_compute_queue()) {
+            compute_command_pool = vk::CommandPool { device, device.get_compute_queue() };
+            compute_command_buffers = compute_command_pool.allocate(frames_in_flight);
+            compute_query_pools = vk::QueryPool::create(frames_in_flight, device, VK_QUERY_TYPE_TIMESTAMP, 16);
+            voxelization_complete = vk::Semaphore::create(device, frames_in_flight, "Voxelization Complete Semaphore");
+            volumes_released = vk::Semaphore::create(device, frames_in_flight, "Volumes Released Semaphore");
+        }
+    }
+
+    void Rasterizer::load(const SceneGraph& scene_graph) {
+        load(scene_graph, { }, { });
+    }
+
+    void Rasterizer::reload(const SceneGraph& scene_graph, const SceneGraph::Changes& changes) {
+        if (changes.hair_styles.empty() && changes.models.empty() && !changes.nodes && !changes.lights)
+            return; // the moved nodes and lights are picked up when they're drawn anyway.
+
+        device.wait_idle(); // before they're moved.
+
+        std::unordered_map<const HairStyle*, vulkan::HairStyle> loaded_styles;
+        std::unordered_map<const Model*, vulkan::Model> loaded_models;
+
+        for (auto& hair_style : hair_styles) {
+            if (std::find(changes.hair_styles.begin(), changes.hair_styles.end(), hair_style.first) == changes.hair_styles.end())
+                loaded_styles[hair_style.first] = std::move(hair_style.second);
+        }
+
+        for (auto& model : models) {
+            if (std::find(changes.models.begin(), changes.models.end(), model.first) == changes.models.end())
+                loaded_models[model.first] = std::move(model.second);
+        }
+
+        load(scene_graph, std::move(loaded_styles), std::move(loaded_models));
+    }
+
+    void Rasterizer::load(const SceneGraph& scene_graph,
+                          std::unordered_map<const HairStyle*, vulkan::HairStyle> loaded_styles,
+                          std::unordered_map<const Model*, vulkan::Model> loaded_models) {
+        device.wait_idle();
+
+#ifdef VK_KHR_ray_query
+        gpu_raytracer = {}; // built from the new styles on the next trace.
+#endif
+        hair_styles.clear();
+        models.clear();
+        shadow_maps.clear();
+        opacity_maps.clear();
+        filtered_shadow_maps.clear();
+
+        staging_ring.begin();
+
+        for (const auto& model : scene_graph.get_models()) {
+            if (auto loaded = loaded_models.find(&model.second); loaded != loaded_models.end())
+                models[&model.second] = std::move(loaded->second);
+            else models[&model.second] = vulkan::Model {
+                model.second, *this
+            };
+        }
+
+        auto previous_quantization = strand_quantization;
+
+        strand_quantization = HairStyle::Quantization::Packed;
+
+        for (const auto& hair_style : scene_graph.get_hair_styles())
+            if (hair_style.second.get_quantization() != HairStyle::Quantization::Packed)
+                strand_quantization = HairStyle::Quantization::None;
+
+        if (scene_graph.get_hair_styles().empty())
+            strand_quantization = HairStyle::Quantization::None;
+
+        // Their vertices are in the old format, and every style in the batch has to be in the same one.
+        if (strand_quantization != previous_quantization)
+            loaded_styles.clear();
+
+        // Every slot has to start at a valid dynamic offset for the uniform buffer, and as a
+        // storage buffer too, since bounds.comp writes the simulated volume_bounds into them.
+        auto offset_alignment = std::max(physical_device.get_properties().limits.minUniformBufferOffsetAlignment,
+                                         physical_device.get_properties().limits.minStorageBufferOffsetAlignment);
+        strand_parameters_stride = sizeof(vulkan::HairStyle::Parameters);
+        strand_parameters_stride = (strand_parameters_stride + offset_alignment - 1) / offset_alignment * offset_alignment;
+
+        auto parameter_slots = std::max<std::size_t>(scene_graph.get_hair_styles().size(), 1);
+        strand_parameters = vk::UniformBuffer { device, parameter_slots * strand_parameters_stride, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT };
+        vk::DebugMarker::object_name(device, strand_parameters, VK_OBJECT_TYPE_BUFFER, "Hair Parameters Buffer");
+
+        std::uint32_t parameter_slot { 0 };
+
+        for (const auto& hair_style : scene_graph.get_hair_styles()) {
+            if (auto loaded = loaded_styles.find(&hair_style.second); loaded != loaded_styles.end()) {
+                hair_styles[&hair_style.second] = std::move(loaded->second);
+                hair_styles[&hair_style.second].set_parameter_slot(parameter_slot++, *this);
+            } else hair_styles[&hair_style.second] = vulkan::HairStyle {
+                hair_style.second, *this, parameter_slot++
+            };
+        }
+
+        // Before the submit, since they're transitioned to the layout they are sampled in.
+        for (std::size_t i { 0 }; i < scene_graph.get_light_sources().size(); ++i)
+            filtered_shadow_maps.emplace_back(1024, *this);
+
+        staging_ring.submit(); // and waits for all of the uploads above.
+
+        calibrate_timestamps();
+
+        VkDeviceSize voxel_count { 1 }; // Don't create an empty buffer.
+        for (const auto& hair_style : hair_styles) {
+            const auto& resolution = hair_style.second.parameters.volume_resolution;
+            voxel_count = std::max(voxel_count, static_cast<VkDeviceSize>(resolution.x * resolution.y * resolution.z));
+        }
+
+        strand_voxels = vk::StorageBuffer { device, voxel_count * 2 * sizeof(std::uint32_t) };
+        vk::DebugMarker::object_name(device, strand_voxels, VK_OBJECT_TYPE_BUFFER, "Strand Voxel Buffer");
+        voxel_statistics = vk::StorageBuffer { device, sizeof(std::uint32_t) };
+        vk::DebugMarker::object_name(device, voxel_statistics, VK_OBJECT_TYPE_BUFFER, "Voxel Statistics Buffer");
+
+        if (peer_voxelization_supported) {
+            VkDeviceSize peer_volume_size { 4 }; // Don't create an empty buffer.
+            for (auto& hair_style : hair_styles)
+                peer_volume_size += hair_style.second.get_volume_transfer_size();
+            peer_volumes = vk::DeviceBuffer { device, peer_volume_size, 0, 0 };
+            vk::DebugMarker::object_name(device, peer_volumes, VK_OBJECT_TYPE_BUFFER, "Peer Volume Buffer");
+        }
+
+        // The ring is only reset here, since the pipelines' descriptors are re-written below.
+        for (std::uint32_t i { 0 }; i < frames_in_flight; ++i) {
+            frame_constants[i].reset();
+            camera[i] = frame_constants[i].allocate(sizeof(vkhr::ViewProjection));
+            lights[i] = frame_constants[i].allocate(scene_graph.get_light_sources().size() * sizeof(LightSource::Buffer)); // e.g.: position, intensity.
+            light_revisions[i] = std::numeric_limits<std::size_t>::max(); // i.e. upload them again.
+            params[i] = frame_constants[i].allocate(sizeof(Interface::Parameters));
+        }
+
+        // One pass for all lights if there's more than one, and the views fit into the pass' view mask.
+        auto light_count = static_cast<std::uint32_t>(scene_graph.get_light_sources().size());
+        if (multiview_supported && light_count > 1 && light_count <= std::min(max_multiview_views, 32u)) {
+            vk::RenderPass::create_multiview_depth_pass(multiview_depth_pass, device, light_count);
+            shadow_map_array = vulkan::DepthMapArray { 1024, light_count, *this };
+        } else {
+            shadow_map_array = vulkan::DepthMapArray { };
+        }
+
+        for (auto& light_source : scene_graph.get_light_sources()) {
+            if (shadow_map_array.get_layer_count() != 0)
+                shadow_maps.emplace_back(shadow_map_array, static_cast<std::uint32_t>(shadow_maps.size()), *this, light_source);
+            else
+                shadow_maps.emplace_back(1024, *this, light_source);
+            opacity_maps.emplace_back(1024, *this);
+        }
+
+        std::size_t instance_count { 0 };
+        for (const auto& hair_node : scene_graph.get_nodes_with_hair_styles())
+            instance_count += hair_node->get_hair_styles().size();
+
+        resize_hair_instances(instance_count * (2 + shadow_maps.size())); // for every view (and multiview).
+
+        hair_batch = vulkan::HairBatch { *this, static_cast<std::uint32_t>(1 + shadow_maps.size()) };
+
+        build_pipelines();
+    }
+
+    void Rasterizer::update_hair_levels_of_detail(const SceneGraph& scene_graph) {
+        const auto& camera = scene_graph.get_camera();
+        const auto& projection = camera.get_projection_matrix();
+        const auto& view_projection = camera.get_view_projection();
+        auto culling_view_projection = camera.get_culling_view_projection(); // of both eyes.
+
+        hair_node_lods.clear();
+
+        nearest_level_of_detail  = 1.0f;
+        farthest_level_of_detail = 0.0f;
+
+        for (const auto& hair_node : scene_graph.get_nodes_with_hair_styles()) {
+            // The bounding sphere of the node's (world space) bounds.
+            const auto& bounds = hair_node->get_bounds();
+            glm::vec3 center = bounds.origin + bounds.size / 2.0f;
+            float radius = bounds.radius / 2.0f;
+
+            NodeLevelOfDetail node_lod;
+
+            float node_distance = glm::distance(center, camera.get_position());
+
+            node_lod.level_of_detail = glm::smoothstep(imgui.parameters.lod_magnified_distance,
+                                                       imgui.parameters.lod_minified_distance,
+                                                       node_distance);
+
+            // If all of its styles have been baked, otherwise it's raymarched like the rest.
+            node_lod.impostor = imgui.impostors_enabled(node_distance);
+            for (const auto& hair_style : hair_node->get_hair_styles())
+                node_lod.impostor = node_lod.impostor && hair_styles[hair_style].has_impostor();
+
+            // With the camera inside of the sphere it always covers some of the screen.
+            float view_depth = (view_projection * glm::vec4 { center, 1.0f }).w;
+            float pixel_radius = radius * std::abs(projection[1][1]) / std::max(view_depth, radius) * camera.get_height() / 2.0f;
+
+            node_lod.on_screen = hair_node->in_frustum(culling_view_projection) && pixel_radius >= 0.5f;
+            node_lod.screen_area = glm::pi<float>() * pixel_radius * pixel_radius;
+
+            // Off-screen nodes might still cast shadows on the others.
+            nearest_level_of_detail = std::min(nearest_level_of_detail, node_lod.level_of_detail);
+            if (node_lod.on_screen && !node_lod.impostor)
+                farthest_level_of_detail = std::max(farthest_level_of_detail, node_lod.level_of_detail);
+
+            hair_node_lods.push_back(node_lod);
+        }
+    }
+
+    void Rasterizer::update_shadow_map_resolutions(const SceneGraph& scene_graph) {
+        const auto& hair_nodes = scene_graph.get_nodes_with_hair_styles();
+        const auto& camera = scene_graph.get_camera();
+
+        for (std::size_t i { 0 }; i < shadow_maps.size(); ++i) {
+            auto& shadow_map = shadow_maps[i];
+            auto width = shadow_map.get_width();
+            auto resolution = width;
+
+            // The multiview pass draws every layer with the same viewport, and the unscaled matrices.
+            if (imgui.parameters.adaptive_shadows && !multiview_shadows_enabled()) {
+                const auto& view_projection = shadow_map.light->get_view_projection();
+
+                float texels { 0.0f };
+
+                // For as many texels over the node's bounds as it has pixels, from how much of the light's
+                // view their corners cover, and the diameter of the node's bounding sphere on the screen.
+                auto fit_node = [&](const SceneGraph::Node& node, float pixel_diameter) {
+                    const auto& bounds = node.get_bounds();
+                    glm::vec2 lower { +1.0f }, upper { -1.0f };
+                    for (int corner { 0 }; corner < 8; ++corner) {
+                        glm::vec3 offset(corner & 1, (corner >> 1) & 1, (corner >> 2) & 1);
+                        auto position = view_projection * glm::vec4 { bounds.origin + bounds.size * offset, 1.0f };
+                        if (position.w <= 0.0f) { // behind a point light, so it covers all of its view.
+                            lower = glm::vec2 { -1.0f };
+                            upper = glm::vec2 { +1.0f };
+                            break;
+                        }
+
+                        glm::vec2 projected { position.x / position.w, position.y / position.w };
+                        lower = glm::min(lower, projected);
+                        upper = glm::max(upper, projected);
+                    }
+
+                    auto light_extent = glm::clamp(glm::max(upper.x - lower.x, upper.y - lower.y) / 2.0f, 1.0f / width, 1.0f);
+                    texels = std::max(texels, pixel_diameter * ShadowTexelsPerPixel / light_extent);
+                };
+
+                for (std::size_t node { 0 }; node < hair_nodes.size() && node < hair_node_lods.size(); ++node) {
+                    const auto& node_lod = hair_node_lods[node];
+                    if (node_lod.on_screen && !node_lod.impostor && hair_nodes[node]->in_frustum(view_projection))
+                        fit_node(*hair_nodes[node], 2.0f * std::sqrt(node_lod.screen_area / glm::pi<float>()));
+                }
+
+                // The models' shadows aren't from the hair, but they're in the same shadow map.
+                if (imgui.parameters.ctsm_on) {
+                    for (const auto& model_node : scene_graph.get_nodes_with_models()) {
+                        if (!model_node->in_frustum(camera.get_culling_view_projection()) || !model_node->in_frustum(view_projection))
+                            continue;
+                        const auto& bounds = model_node->get_bounds();
+                        auto center = bounds.origin + bounds.size / 2.0f;
+                        float view_depth = (camera.get_view_projection() * glm::vec4 { center, 1.0f }).w;
+                        float pixel_radius = bounds.radius / 2.0f * std::abs(camera.get_projection_matrix()[1][1]) /
+                                             std::max(view_depth, bounds.radius / 2.0f) * camera.get_height() / 2.0f;
+                        fit_node(*model_node, 2.0f * pixel_radius);
+                    }
+                }
+
+                resolution = MinShadowMapResolution;
+                while (resolution < width && resolution < texels)
+                    resolution *= 2;
+                resolution = std::min(resolution, width);
+
+                // Kept until it's less than half as large, instead of flip-flopping between the two.
+                auto current_resolution = shadow_map.get_resolution();
+                if (resolution < current_resolution && texels > current_resolution / 2.0f)
+                    resolution = current_resolution;
+            }
+
+            if (resolution == shadow_map.get_resolution())
+                continue;
+
+            shadow_map.set_resolution(resolution);
+            if (i < opacity_maps.size())
+                opacity_maps[i].set_resolution(resolution);
+
+            ++shadow_resolution_revision;
+        }
+    }
+
+    void Rasterizer::update_model_visibility(const SceneGraph& scene_graph) {
+        const auto& model_nodes = scene_graph.get_nodes_with_models();
+
+        model_visibility.assign(1 + shadow_maps.size(), std::vector<bool>(model_nodes.size(), false));
+
+        auto culling_view_projection = scene_graph.get_camera().get_culling_view_projection();
+
+        for (std::size_t node { 0 }; node < model_nodes.size(); ++node) {
+            model_visibility[0][node] = model_nodes[node]->in_frustum(culling_view_projection);
+            for (std::size_t i { 0 }; i < shadow_maps.size(); ++i)
+                model_visibility[1 + i][node] = model_nodes[node]->in_frustum(shadow_maps[i].light->get_view_projection());
+        }
+    }
+
+    void Rasterizer::reduce_strands(const SceneGraph& scene_graph) {
+        std::unordered_map<const HairStyle*, float> style_areas;
+
+        const auto& hair_nodes = scene_graph.get_nodes_with_hair_styles();
+        for (std::size_t node { 0 }; node < hair_nodes.size(); ++node) {
+            const auto& node_lod = hair_node_lods[node];
+            if (!node_lod.on_screen || !imgui.rasterizer_enabled(node_lod.level_of_detail))
+                continue;
+            for (const auto& hair_style : hair_nodes[node]->get_hair_styles())
+                style_areas[hair_style] = std::max(style_areas[hair_style], node_lod.screen_area);
+        }
+
+        for (const auto& style_area : style_areas) {
+            auto& vulkan_hair_style = hair_styles[style_area.first];
+
+            float strand_density = style_area.first->get_strand_count() / std::max(style_area.second, 1.0f);
+            float strand_ratio = glm::clamp(imgui.parameters.strands_per_pixel / strand_density, 0.05f, 1.0f);
+
+            bool merged = imgui.parameters.strand_merging && vulkan_hair_style.is_mergeable();
+            if (merged)
+                strand_ratio = vulkan_hair_style.get_merged_ratio(strand_ratio);
+
+            // Not every frame, since it's uploaded again, and the ratio changes slowly anyway.
+            if (std::abs(strand_ratio - vulkan_hair_style.parameters.strand_ratio) > 0.01f ||
+                (strand_ratio == 1.0f && vulkan_hair_style.parameters.strand_ratio != 1.0f) ||
+                merged != vulkan_hair_style.is_merged()) {
+                if (merged) vulkan_hair_style.merge(strand_ratio);
+                else        vulkan_hair_style.reduce(strand_ratio);
+                vulkan_hair_style.update_parameters();
+            }
+        }
+    }
+
+    void Rasterizer::update_hair_instances(const SceneGraph& scene_graph) {
+        hair_instances.assign(1 + shadow_maps.size() + multiview_shadows_enabled(), {});
+        hair_instance_data.clear();
+
+        const auto& hair_nodes = scene_graph.get_nodes_with_hair_styles();
+
+        for (std::uint32_t view { 0 }; view < hair_instances.size(); ++view) {
+            auto& view_instances = hair_instances[view];
+
+            // In the order the styles are first found, so the draws don't change between frames.
+            std::unordered_map<const HairStyle*, std::vector<vulkan::HairStyle::Instance>> style_instances;
+
+            for (std::size_t node { 0 }; node < hair_nodes.size(); ++node) {
+                const auto& node_lod = hair_node_lods[node];
+                if (!imgui.rasterizer_enabled(node_lod.level_of_detail))
+                    continue; // only raymarched, see strand_dvr.
+
+                bool visible;
+                if (view == 0) {
+                    visible = node_lod.on_screen;
+                } else if (view <= shadow_maps.size()) {
+                    visible = hair_nodes[node]->in_frustum(shadow_maps[view - 1].light->get_view_projection());
+                } else { // in any of the lights, see draw_multiview_depth.
+                    visible = std::any_of(shadow_maps.begin(), shadow_maps.end(), [&](const vulkan::DepthMap& shadow_map) {
+                        return hair_nodes[node]->in_frustum(shadow_map.light->get_view_projection());
+                    });
+                }
+
+                if (!visible)
+                    continue;
+
+                for (const auto& hair_style : hair_nodes[node]->get_hair_styles()) {
+                    if (style_instances.count(hair_style) == 0)
+                        view_instances.push_back({ hair_style, 0, 0 });
+                    style_instances[hair_style].push_back({ hair_nodes[node]->get_model_matrix(), node_lod.level_of_detail });
+                }
+            }
+
+            for (auto& hair_instance : view_instances) {
+                const auto& instances = style_instances[hair_instance.hair_style];
+                hair_instance.first_instance = static_cast<std::uint32_t>(hair_instance_data.size());
+                hair_instance.instance_count = static_cast<std::uint32_t>(instances.size());
+                hair_instance_data.insert(hair_instance_data.end(), instances.begin(), instances.end());
+            }
+        }
+
+        impostor_instances.clear();
+
+        std::unordered_map<const HairStyle*, std::vector<vulkan::HairStyle::Instance>> style_impostors;
+
+        for (std::size_t node { 0 }; node < hair_nodes.size(); ++node) {
+            const auto& node_lod = hair_node_lods[node];
+            if (!node_lod.on_screen || !node_lod.impostor)
+                continue;
+
+            for (const auto& hair_style : hair_nodes[node]->get_hair_styles()) {
+                if (style_impostors.count(hair_style) == 0)
+                    impostor_instances.push_back({ hair_style, 0, 0 });
+                style_impostors[hair_style].push_back({ hair_nodes[node]->get_model_matrix(), node_lod.level_of_detail });
+            }
+        }
+
+        for (auto& impostor_instance : impostor_instances) {
+            const auto& instances = style_impostors[impostor_instance.hair_style];
+            impostor_instance.first_instance = static_cast<std::uint32_t>(hair_instance_data.size());
+            impostor_instance.instance_count = static_cast<std::uint32_t>(instances.size());
+            hair_instance_data.insert(hair_instance_data.end(), instances.begin(), instances.end());
+        }
+
+        if (hair_instance_data.empty())
+            return;
+
+        // Only if nodes were added to the scene graph without loading it.
+        if (hair_instance_data.size() * sizeof(vulkan::HairStyle::Instance) > hair_instance_buffers[frame].get_size()) {
+            resize_hair_instances(hair_instance_data.size());
+            build_pipelines(); // for the descriptor sets with the instances.
+        }
+
+        hair_instance_buffers[frame].get_device_memory().copy(hair_instance_data.size() * sizeof(vulkan::HairStyle::Instance),
+                                                              hair_instance_data.data());
+    }
+
+    void Rasterizer::resize_hair_instances(std::size_t instance_count) {
+        device.wait_idle(); // The matrices might still be in use.
+
+        hair_instance_buffers.clear();
+
+        for (std::uint32_t i { 0 }; i < frames_in_flight; ++i) {
+            hair_instance_buffers.emplace_back(device, std::max<std::size_t>(instance_count, 1) * sizeof(vulkan::HairStyle::Instance),
+                                               VK_BUFFER_USAGE_STORAGE_BUFFER_BIT); // Don't create an empty buffer.
+            vk::DebugMarker::object_name(device, hair_instance_buffers[i], VK_OBJECT_TYPE_BUFFER, "Hair Instance Buffer", i);
+        }
+    }
+
+    void Rasterizer::update(const SceneGraph& scene_graph) {
+        TraceRecorder::Scope trace_scope { "Update Buffers" };
+
+        ViewProjection view_projection { scene_graph.get_camera().get_transform() };
+        view_projection.previous_view_projection = previous_view_projection;
+        view_projection.frame_number = frame_number++; // for jittering.
+
+        const auto& scene_camera = scene_graph.get_camera();
+        view_projection.view_count = stereo_rendering ? vulkan::StereoTarget::Eyes : 1;
+        for (std::uint32_t eye { 0 }; eye < vulkan::StereoTarget::Eyes; ++eye) { // or both are the camera.
+            view_projection.eye_views[eye]     = stereo_rendering ? scene_camera.get_eye_view_matrix(eye) : view_projection.view;
+            view_projection.eye_positions[eye] = glm::vec4 { stereo_rendering ? scene_camera.get_eye_position(eye)
+                                                                              : view_projection.position, 1.0f };
+        }
+
+        // The history is reprojected without the jitter, so it's the projection before that's kept.
+        auto unjittered_view_projection = view_projection.projection * view_projection.view;
+
+        camera_jitter = glm::vec2 { 0.0f };
+        if (temporal_anti_aliasing_enabled()) {
+            camera_jitter = Camera::get_jitter(view_projection.frame_number);
+            view_projection.projection = scene_camera.get_jittered_projection_matrix(camera_jitter);
+        }
+
+        // Hair passes work in the pixels of the hair_target, they're the same as the camera's if it isn't scaled.
+        hair_target.set_render_scale(imgui.parameters.render_scale);
+        view_projection.hair_resolution = glm::vec2 { get_hair_extent().width, get_hair_extent().height };
+
+        frame_constants[frame].update(camera[frame], view_projection);
+        previous_view_projection = unjittered_view_projection;
+
+        update_hair_levels_of_detail(scene_graph);
+        update_shadow_map_resolutions(scene_graph);
+
+        auto light_revision = scene_graph.get_light_source_revision() + shadow_resolution_revision;
+        if (light_revisions[frame] != light_revision) {
+            auto light_buffers = scene_graph.fetch_light_source_buffers();
+            for (std::size_t i { 0 }; i < light_buffers.size() && i < shadow_maps.size(); ++i) {
+                auto scale = shadow_maps[i].get_resolution_scale();
+                glm::mat4 shadow_map_square { 1.0f };
+                shadow_map_square[0][0] = shadow_map_square[1][1] = scale;
+                light_buffers[i].view_projection = shadow_map_square * light_buffers[i].view_projection;
+                light_buffers[i].shadow_map_scale = scale;
+            }
+
+            frame_constants[frame].update(lights[frame], light_buffers);
+            light_revisions[frame] = light_revision;
+        }
+        update_hair_instances(scene_graph);
+        update_model_visibility(scene_graph);
+
+        if (imgui.parameters.strand_reduction)
+            reduce_strands(scene_graph);
+
+        // Same LoD scheme as above, but per hair style, for the resolution that we raymarch at, and
+        // if the strands are in the band between where they are rasterized and where they're raymarched,
+        // where they're mostly thinner than a pixel, they can be rasterized in a compute shader instead.
+        for (auto& hair_node : scene_graph.get_nodes_with_hair_styles()) {
+            for (auto& hair_style : hair_node->get_hair_styles()) {
+                auto& vulkan_hair_style = hair_styles[hair_style];
+                const auto& bounds = vulkan_hair_style.parameters.volume_bounds;
+
+                glm::vec3 center = hair_node->get_model_matrix() * glm::vec4 { bounds.origin + bounds.size / 2.0f, 1.0f };
+                float style_distance = glm::distance(center, scene_graph.get_camera().get_position());
+
+                vulkan_hair_style.software_rasterized = imgui.parameters.software_rasterizer &&
+                                                        style_distance > imgui.parameters.lod_magnified_distance &&
+                                                        style_distance < imgui.parameters.lod_minified_distance;
+                vulkan_hair_style.native_width = temporal_anti_aliasing_enabled();
+
+                // The hair_target is scaled already, so there's no need for the volume_targets.
+                if (!imgui.parameters.scaled_raymarch || scaled_hair_enabled()) {
+                    vulkan_hair_style.raymarch_scale = 1;
+                    continue;
+                }
+
+                float style_level_of_detail = glm::smoothstep(imgui.parameters.lod_magnified_distance,
+                                                              imgui.parameters.lod_minified_distance,
+                                                              style_distance);
+
+                if (style_level_of_detail < 1.0f / 3.0f)
+                    vulkan_hair_style.raymarch_scale = 1;
+                else if (style_level_of_detail < 2.0f / 3.0f)
+                    vulkan_hair_style.raymarch_scale = 2;
+                else vulkan_hair_style.raymarch_scale = 4;
+            }
+        }
+
+        frame_constants[frame].update(params[frame], imgui.parameters); // Rendering parameter.
+    }
+
+    void Rasterizer::draw(const SceneGraph& scene_graph) {
+        wait_for_frame();
+        // Of the last time this frame was drawn, frames_in_flight ago, so the profiler never stalls.
+        auto timestamps = query_pools[frame].request_timestamp_queries();
+        // The voxelization of that frame was done before it, since the frame waited for it.
+        if (device.has_async_compute_queue()) {
+            for (const auto& timestamp : compute_query_pools[frame].request_timestamp_queries())
+                timestamps[timestamp.first] = timestamp.second;
+        }
+        imgui.record_performance(timestamps);
+        quality_controller.update(timestamps, imgui.parameters);
+        if (stereo_rendering)
+            use_stereo_paths(imgui.parameters);
+        if (TraceRecorder::is_recording()) {
+            record_trace(query_pools[frame]);
+            if (device.has_async_compute_queue())
+                record_trace(compute_query_pools[frame]);
+        }
+        if (pipeline_statistics_enabled())
+            imgui.record_statistics(statistics_pools[frame].request_statistics_queries(),
+                                    ppll.get_statistics().fragments);
+        reset_recording_threads();
+
+        ppll.fetch_node_counter(frame); // from the last time this frame was drawn.
+        std::size_t node_count { imgui.parameters.adaptive_ppll ? ppll.get_recommended_node_count() : ppll.get_node_count() };
+        resize_ppll(node_count, imgui.parameters.deferred_shading, imgui.parameters.packed_ppll);
+        set_strip_topology(imgui.parameters.line_strips);
+        specialize_shaders();
+        rebuild_recompiled_pipelines();
+
+        update(scene_graph); // updates descriptor sets.
+
+        frame_image = swap_chain.acquire_next_image(image_available[frame]);
+
+        if (swap_chain.out_of_date()) {
+            swapchain_dirty = true;
+            return;
+        }
+
+        bool async_voxelization = device.has_async_compute_queue();
+
+        update_volume_states(scene_graph);
+
+        if (async_voxelization)
+            submit_voxelization(scene_graph);
+
+        auto recording_time = TraceRecorder::get_time();
+
+        // The screenshots are taken without the GUI, but it's still there in the other frames.
+        bool capturing_screenshot { !screenshot_requests.empty() };
+        bool gui_visibility { capturing_screenshot ? imgui.hide() : false };
+
+        command_buffers[frame].begin();
+
+        command_buffers[frame].reset_query_pool(query_pools[frame], 0, // performance.
+                                                query_pools[frame].get_query_count());
+        if (pipeline_statistics_enabled())
+            command_buffers[frame].reset_query_pool(statistics_pools[frame], 0,
+                                                    statistics_pools[frame].get_query_count());
+
+        vk::DebugMarker::begin(command_buffers[frame], "Total Frame Time", query_pools[frame]);
+
+        if (!async_voxelization)
+            simulate(scene_graph, command_buffers[frame], &query_pools[frame]);
+
+        draw_depth(scene_graph, command_buffers[frame]);
+
+        if (!async_voxelization) {
+            voxelize(scene_graph, command_buffers[frame]);
+        } else if (peer_voxelization_enabled()) {
+            vk::DebugMarker::begin(command_buffers[frame], "Receive Peer Volumes", query_pools[frame]);
+            VkDeviceSize peer_volume_offset { 0 };
+            for (auto& hair_style : hair_styles) {
+                if (hair_style.second.dirty_volumes)
+                    hair_style.second.receive_volumes(peer_volumes, peer_volume_offset, command_buffers[frame]);
+                peer_volume_offset += hair_style.second.get_volume_transfer_size();
+            }
+            vk::DebugMarker::close(command_buffers[frame], "Receive Peer Volumes", query_pools[frame]);
+        } else {
+            for (auto& hair_style : hair_styles)
+                if (hair_style.second.dirty_volumes)
+                    hair_style.second.acquire_volumes(device.get_compute_queue().get_family_index(),
+                                                      device.get_graphics_queue().get_family_index(),
+                                                      command_buffers[frame]);
+        }
+
+        // With mesh shaders the pulled strands are culled in strand.task.
+        // The depth sorted strands are always vertex inputs, see draw_sorted_hairs.
+        bool task_culling = mesh_shading && !depth_sorting_enabled() &&
+                            (imgui.parameters.strand_expansion == static_cast<int>(vulkan::HairStyle::Expansion::PulledLines) ||
+                             imgui.parameters.strand_expansion == static_cast<int>(vulkan::HairStyle::Expansion::PulledQuads));
+
+        if (imgui.rasterizer_enabled(nearest_level_of_detail) && !task_culling) {
+            auto culling_view_projection = scene_graph.get_camera().get_culling_view_projection();
+
+            bool model_occlusion = model_occlusion_enabled(scene_graph);
+            if (model_occlusion) {
+                vk::DebugMarker::begin(command_buffers[frame], "Model Depth Pre-Pass", query_pools[frame], get_statistics_pool());
+                draw_model_depth(scene_graph, culling_view_projection, command_buffers[frame]);
+                vk::DebugMarker::close(command_buffers[frame], "Model Depth Pre-Pass", query_pools[frame], get_statistics_pool());
+            }
+
+            vk::DebugMarker::begin(command_buffers[frame], "Cull Hair Strands", query_pools[frame], get_statistics_pool());
+            cull_strands(scene_graph, 0, culling_view_projection,
+                         imgui.parameters.isosurface, command_buffers[frame], model_occlusion);
+            vk::DebugMarker::close(command_buffers[frame], "Cull Hair Strands", query_pools[frame], get_statistics_pool());
+        }
+
+        if (imgui.rasterizer_enabled(nearest_level_of_detail) && depth_sorting_enabled()) {
+            vk::DebugMarker::begin(command_buffers[frame], "Sort Hair Segments", query_pools[frame], get_statistics_pool());
+            sort_segments(scene_graph, command_buffers[frame]);
+            vk::DebugMarker::close(command_buffers[frame], "Sort Hair Segments", query_pools[frame], get_statistics_pool());
+        }
+
+        draw_color(scene_graph, command_buffers[frame]);
+
+        vk::DebugMarker::close(command_buffers[frame], "Total Frame Time", query_pools[frame]);
+
+        if (capturing_screenshot) {
+            read_back_screenshot(command_buffers[frame]);
+            imgui.set_visibility(gui_visibility);
+        }
+
+        command_buffers[frame].end();
+
+        TraceRecorder::record_cpu_span("Record Commands", recording_time, TraceRecorder::get_time());
+
+        if (async_voxelization) {
+            // The depth pass already reads the vertices, if they were simulated along with the voxelization.
+            // The volumes from the peer are copied at the start of the frame, so it has to wait there too.
+            submit_frame({ &image_available[frame], &voxelization_complete[frame] },
+                         { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                           simulation.enabled || peer_voxelization_enabled() ? VK_PIPELINE_STAGE_ALL_COMMANDS_BIT
+                                                                             : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT },
+                         { &render_complete[frame_image], &volumes_released[frame] });
+            volumes_in_use = true;
+        } else {
+            submit_frame({ &image_available[frame] },
+                         { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT },
+                         { &render_complete[frame_image] });
+        }
+        present_frame();
+
+        if (swap_chain.out_of_date())
+            swapchain_dirty = true;
+
+        latest_drawn_frame = frame;
+        latest_drawn_image = frame_image;
+        frame = fetch_next_frame();
+    }
+
+    std::uint32_t Rasterizer::fetch_next_frame() {
+        return (frame + 1) % frames_in_flight;
+    }
+
+    void Rasterizer::wait_for_frame() {
+        if (frame_waited)
+            return; // e.g. already by the low-latency mode, or it wasn't submitted after it.
+
+        TraceRecorder::Scope trace_scope { "Wait for Frame" };
+
+        auto wait_start = std::chrono::steady_clock::now();
+
+#ifdef VK_KHR_timeline_semaphore
+        if (timeline_pacing)
+            frame_timeline.wait(frame_timeline_values[frame]);
+        else
+#endif
+        command_buffer_finished[frame].wait_and_reset();
+
+        auto wait_end = std::chrono::steady_clock::now();
+
+        frame_waited = true;
+
+        // Exponential moving average, so the numbers are still readable in the UI.
+        auto average = [](float& average, float sample) {
+            average += (sample - average) * 0.05f;
+        };
+
+        harvest_screenshot(frame); // if one was taken the last time this frame was drawn.
+
+        std::chrono::duration<float, std::milli> cpu_wait { wait_end - wait_start };
+        average(frame_latency.cpu_wait, cpu_wait.count());
+
+        if (last_wait_end != std::chrono::steady_clock::time_point {}) {
+            frame_latency.cpu_time       = std::chrono::duration<float, std::milli> { wait_start - last_wait_end   }.count();
+            frame_latency.frame_interval = std::chrono::duration<float, std::milli> { wait_start - last_wait_start }.count();
+        }
+
+        last_wait_start = wait_start;
+        last_wait_end   = wait_end;
+
+        if (frame_timeline_values[frame] != 0) {
+            std::chrono::duration<float, std::milli> latency { wait_end - frame_submit_times[frame] };
+            average(frame_latency.latency, latency.count());
+            frame_latency.peak_latency = std::max(frame_latency.peak_latency * 0.99f, latency.count());
+        }
+
+        // Any that's still here wasn't presented with an id, so the GPU being done is all there is.
+        if (frame_input_times[frame] != std::chrono::steady_clock::time_point {}) {
+            measure_input_latency(frame_input_times[frame], wait_end, false);
+            frame_input_times[frame] = std::chrono::steady_clock::time_point {};
+        }
+
+        fetch_presentation_timing();
+    }
+
+    void Rasterizer::record_input_time(std::chrono::steady_clock::time_point input_time) {
+        if (next_input_time == std::chrono::steady_clock::time_point {})
+            next_input_time = input_time; // or the older one the last frames weren't drawn with.
+    }
+
+    void Rasterizer::measure_input_latency(std::chrono::steady_clock::time_point input_time,
+                                           std::chrono::steady_clock::time_point shown_time,
+                                           bool displayed) {
+        std::chrono::duration<float, std::milli> latency { shown_time - input_time };
+        frame_latency.input_latency += (latency.count() - frame_latency.input_latency) * 0.05f;
+        frame_latency.peak_input_latency = std::max(frame_latency.peak_input_latency * 0.99f, latency.count());
+        frame_latency.input_to_display = displayed;
+    }
+
+    void Rasterizer::fetch_presentation_timing() {
+#ifdef VK_GOOGLE_display_timing
+        if (!display_timing || pending_presents.empty())
+            return;
+
+        for (const auto& timing : swap_chain.get_past_presentation_timing()) {
+            auto present = std::find_if(pending_presents.begin(), pending_presents.end(), [&](const auto& pending) {
+                return pending.first == timing.presentID;
+            });
+
+            if (present == pending_presents.end())
+                continue; // of a present that was given up on.
+
+            // In the order they were presented, so the ones before it had been replaced (mailbox).
+            std::chrono::nanoseconds actual_present_time { timing.actualPresentTime };
+            measure_input_latency(present->second, std::chrono::steady_clock::time_point {
+                                  std::chrono::duration_cast<std::chrono::steady_clock::duration>(actual_present_time) }, true);
+            pending_presents.erase(pending_presents.begin(), present + 1);
+        }
+#endif
+    }
+
+    void Rasterizer::submit_frame(const std::vector<vk::Semaphore*>& wait,
+                                  const std::vector<VkPipelineStageFlags>& wait_stages,
+                                  const std::vector<vk::Semaphore*>& signal) {
+        frame_timeline_values[frame] = ++frames_submitted;
+
+        auto waits = wait;
+        auto stages = wait_stages;
+        auto signals = signal;
+
+        // Off-screen the image isn't acquired or presented, so nothing signals or waits for these.
+        if (swap_chain.is_offscreen()) {
+            for (std::size_t i { waits.size() }; i-- > 0;) {
+                if (waits[i] == &image_available[frame]) {
+                    waits.erase(waits.begin() + i);
+                    stages.erase(stages.begin() + i);
+                }
+            }
+
+            signals.erase(std::remove(signals.begin(), signals.end(), &render_complete[frame_image]), signals.end());
+        }
+
+#ifdef VK_KHR_timeline_semaphore
+        if (timeline_pacing)
+            device.get_graphics_queue().submit(command_buffers[frame], waits, stages, signals,
+                                               frame_timeline, frame_timeline_values[frame], get_frame_device());
+        else
+#endif
+        device.get_graphics_queue().submit(command_buffers[frame], waits, stages, signals,
+                                           command_buffer_finished[frame], get_frame_device());
+
+        frame_submit_times[frame] = std::chrono::steady_clock::now();
+
+        frame_input_times[frame] = next_input_time;
+        next_input_time = std::chrono::steady_clock::time_point {};
+        frame_waited = false;
+    }
+
+    void Rasterizer::present_frame() {
+        if (swap_chain.is_offscreen())
+            return; // it stays in the image, for the screenshots.
+        TraceRecorder::Scope trace_scope { "Present Frame" };
+
+#ifdef VK_GOOGLE_display_timing
+        if (display_timing && frame_input_times[frame] != std::chrono::steady_clock::time_point {}) {
+            pending_presents.emplace_back(++present_ids, frame_input_times[frame]);
+            frame_input_times[frame] = std::chrono::steady_clock::time_point {};
+            if (pending_presents.size() > 2 * swap_chain.size())
+                pending_presents.pop_front(); // it's not coming, e.g. the swapchain was recreated.
+            device.get_present_queue().present(swap_chain, frame_image, render_complete[frame_image], present_ids);
+            return;
+        }
+#endif
+
+        device.get_present_queue().present(swap_chain, frame_image, render_complete[frame_image]);
+    }
+
+    void Rasterizer::request_screenshot(std::function<void(Image&&)> screenshot_ready) {
+        screenshot_requests.push_back(std::move(screenshot_ready));
+    }
+
+    void Rasterizer::save_screenshot(const std::string& file_path) {
+        auto screenshot_path = file_path.empty() ? Image::get_time_file_path() : file_path;
+        request_screenshot([this, screenshot_path](Image&& screenshot) {
+            image_writer.save(std::move(screenshot), screenshot_path);
+        });
+    }
+
+    void Rasterizer::read_back_screenshot(vk::CommandBuffer& command_buffer) {
+        TraceRecorder::Scope trace_scope { "Read Back Screenshot" };
+
+        auto& readback = screenshot_readbacks[frame];
+        auto& swapchain_image = swap_chain.get_images()[frame_image];
+
+        readback.width  = swap_chain.get_width();
+        readback.height = swap_chain.get_height();
+
+        VkDeviceSize size { static_cast<VkDeviceSize>(readback.width) * readback.height * 4 };
+
+        // It's only re-created if the swapchain was resized, since it was last used.
+        if (readback.size != size) {
+            readback.buffer = vk::HostBuffer { device, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT };
+            vk::DebugMarker::object_name(device, readback.buffer, VK_OBJECT_TYPE_BUFFER, "Screenshot Readback", frame);
+            readback.size = size;
+        }
+
+        swapchain_image.transition(command_buffer, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                                   VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                   VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+        command_buffer.copy_image_buffer(swapchain_image, readback.buffer);
+        swapchain_image.transition(command_buffer, VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_MEMORY_READ_BIT,
+                                   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                                   VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+        VkMemoryBarrier memory_barrier;
+        memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        memory_barrier.pNext = nullptr;
+        memory_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        memory_barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+        command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                        VK_PIPELINE_STAGE_HOST_BIT,
+                                        memory_barrier);
+
+        readback.screenshots_ready = std::move(screenshot_requests);
+        screenshot_requests.clear();
+    }
+
+    void Rasterizer::finish_screenshots() {
+        device.wait_idle();
+        // Oldest first, i.e. the frame after the one that was submitted last.
+        for (std::uint32_t i { 1 }; i <= frames_in_flight; ++i)
+            harvest_screenshot((frame + i) % frames_in_flight);
+    }
+
+    void Rasterizer::set_fixed_time_step(float seconds) {
+        fixed_time_step = seconds;
+    }
+
+    void Rasterizer::harvest_screenshot(std::uint32_t frame_index) {
+        auto& readback = screenshot_readbacks[frame_index];
+        if (readback.screenshots_ready.empty())
+            return;
+
+        vkhr::Image screenshot { readback.width, readback.height };
+
+        const char* buffer { nullptr };
+        auto& readback_memory = readback.buffer.get_device_memory();
+        readback_memory.map(0, screenshot.get_size_in_bytes(), (void**) &buffer);
+        std::memcpy(screenshot.get_data(), buffer, screenshot.get_size_in_bytes());
+        readback_memory.unmap();
+
+        screenshot.flip_channels(); // Swaps between; R <---> B
+
+        auto screenshots_ready = std::move(readback.screenshots_ready);
+        readback.screenshots_ready.clear();
+
+        for (std::size_t i { 0 }; i + 1 < screenshots_ready.size(); ++i)
+            screenshots_ready[i](Image { screenshot });
+        screenshots_ready.back()(std::move(screenshot));
+    }
+
+    void Rasterizer::calibrate_timestamps() {
+        vk::QueryPool calibration_query { device, VK_QUERY_TYPE_TIMESTAMP, 1 };
+
+        staging_ring.begin();
+        auto& command_buffer = staging_ring.get_command_buffer();
+        command_buffer.reset_query_pool(calibration_query, 0, 1);
+        command_buffer.write_timestamp(calibration_query, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0);
+
+        auto submit_time = TraceRecorder::get_time();
+        staging_ring.submit(); // and waits for it.
+        auto complete_time = TraceRecorder::get_time();
+
+        std::uint64_t timestamp { 0 };
+        calibration_query.get_results(0, 1, sizeof(timestamp), &timestamp,
+                                      VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT,
+                                      sizeof(timestamp));
+
+        // It was written somewhere in between, so it's off by at most half of the round trip.
+        gpu_calibration_time = timestamp * static_cast<double>(calibration_query.get_ns_per_unit());
+        cpu_calibration_time = (submit_time + complete_time) / 2.0;
+    }
+
+    void Rasterizer::record_trace(const vk::QueryPool& query_pool) {
+        const auto& spans = query_pool.get_timestamp_spans();
+
+        auto to_cpu_time = [&](double gpu_time) {
+            return cpu_calibration_time + (gpu_time - gpu_calibration_time) / 1000.0;
+        };
+
+        // The passes that weren't recorded in this frame still have their old timestamps.
+        auto frame_span = spans.find("Total Frame Time");
+
+        for (const auto& span : spans) {
+            if (span.second.end <= span.second.begin)
+                continue;
+            if (frame_span != spans.end() && (span.second.begin < frame_span->second.begin ||
+                                              span.second.end   > frame_span->second.end))
+                continue;
+            TraceRecorder::record_gpu_span(span.first, to_cpu_time(span.second.begin),
+                                                       to_cpu_time(span.second.end));
+        }
+    }
+
+    const Rasterizer::FrameLatency& Rasterizer::get_frame_latency() const {
+        return frame_latency;
+    }
+
+    std::uint32_t Rasterizer::get_frames_in_flight() const {
+        return frames_in_flight;
+    }
+
+    Rasterizer::MemoryUsage Rasterizer::get_memory_usage() {
+        MemoryUsage memory_usage;
+
+        for (const auto& hair_style : hair_styles) {
+            memory_usage.geometry += hair_style.second.get_geometry_size();
+            memory_usage.volumes  += hair_style.second.get_volume_size();
+        }
+
+        memory_usage.ppll = ppll.get_heads_size_in_bytes() +
+                            ppll.get_nodes_size_in_bytes();
+
+        memory_usage.shadow_maps += shadow_map_array.get_size_in_bytes();
+        for (const auto& shadow_map : shadow_maps)
+            memory_usage.shadow_maps += shadow_map.get_size_in_bytes();
+        for (const auto& opacity_map : opacity_maps)
+            memory_usage.shadow_maps += opacity_map.get_size_in_bytes();
+        for (const auto& filtered_shadow_map : filtered_shadow_maps)
+            memory_usage.shadow_maps += filtered_shadow_map.get_size_in_bytes();
+
+        auto depth_buffer_size = swap_chain.get_depth_buffer_image().get_memory_requirements().size;
+
+        const auto& extent = swap_chain.get_extent();
+        memory_usage.swapchain = static_cast<VkDeviceSize>(extent.width) * extent.height * 4 * swap_chain.size() +
+                                 depth_buffer_size;
+
+        // Everything but the swapchain images is in the allocator, e.g. the raymarching targets.
+        auto allocated = memory_usage.geometry + memory_usage.volumes + memory_usage.ppll +
+                         memory_usage.shadow_maps + depth_buffer_size;
+        auto used = device.get_memory_statistics().used;
+        memory_usage.other = used > allocated ? used - allocated : 0;
+
+        return memory_usage;
+    }
+
+    std::vector<vk::PhysicalDevice::MemoryBudget> Rasterizer::get_memory_budgets() const {
+        return physical_device.get_memory_budgets();
+    }
+
+    std::uint32_t Rasterizer::get_device_memory_heap() const {
+        return physical_device.get_device_memory_heap();
+    }
+
+    void Rasterizer::voxelize(const SceneGraph& scene_graph, vk::CommandBuffer& command_buffer) {
+        vk::DebugMarker::begin(command_buffer, "Voxelize Strands", query_pools[frame], get_statistics_pool());
+
+        // Styles might be shared between nodes, but we only need to voxelize them once.
+        for (auto& hair_style : hair_styles) {
+            if (!hair_style.second.dirty_volumes)
+                continue;
+            hair_style.second.voxelize(hair_voxel_pipeline,
+                                       hair_voxel_resolve_pipeline,
+                                       hair_volume_mip_pipeline,
+                                       hair_transmittance_pipeline,
+                                       hair_ambient_occlusion_pipeline,
+                                       hair_distance_field_pipeline,
+                                       frame,
+                                       strand_voxels,
+                                       voxel_statistics,
+                                       command_buffer);
+        }
+
+        vk::DebugMarker::close(command_buffer, "Voxelize Strands", query_pools[frame], get_statistics_pool());
+    }
+
+    void Rasterizer::simulate(const SceneGraph& scene_graph, vk::CommandBuffer& command_buffer, vk::QueryPool* query_pool) {
+        auto now = std::chrono::steady_clock::now();
+        std::chrono::duration<float> time_step { now - last_simulation_step };
+        last_simulation_step = now;
+
+        if (!simulation.enabled)
+            return;
+
+        float step = fixed_time_step > 0.0f ? fixed_time_step : std::min(time_step.count(), simulation.max_time_step);
+        simulation_time += step;
+
+        if (query_pool != nullptr)
+            vk::DebugMarker::begin(command_buffer, "Simulate Strands", *query_pool);
+        else
+            vk::DebugMarker::begin(command_buffer, "Simulate Strands");
+
+        // Shared styles are simulated once, so all of their nodes get the same strands.
+        std::unordered_map<const HairStyle*, const SceneGraph::Node*> hair_style_nodes;
+        for (auto& hair_node : scene_graph.get_nodes_with_hair_styles())
+            for (auto& hair_style : hair_node->get_hair_styles())
+                hair_style_nodes.emplace(hair_style, hair_node);
+
+        for (auto& hair_style : hair_styles) {
+            vulkan::Model* collider { nullptr };
+            glm::mat4 hair_to_collider { 1.0f };
+
+            auto hair_node = hair_style_nodes.find(hair_style.first);
+
+            if (hair_node != hair_style_nodes.end()) {
+                const auto& hair_bounds = hair_node->second->get_bounds();
+                glm::vec3 hair_center { hair_bounds.origin + hair_bounds.size / 2.0f };
+
+                float closest_distance { std::numeric_limits<float>::max() };
+
+                for (auto& model_node : scene_graph.get_nodes_with_models()) {
+                    const auto& model_bounds = model_node->get_bounds();
+                    glm::vec3 model_center { model_bounds.origin + model_bounds.size / 2.0f };
+
+                    float model_distance { glm::distance(hair_center, model_center) };
+                    if (model_distance >= closest_distance)
+                        continue;
+
+                    for (auto& model : model_node->get_models()) {
+                        auto vulkan_model = models.find(model);
+                        if (vulkan_model == models.end() || !vulkan_model->second.has_distance_field())
+                            continue;
+
+                        collider = &vulkan_model->second;
+                        hair_to_collider = glm::inverse(model_node->get_model_matrix()) * hair_node->second->get_model_matrix();
+                        closest_distance = model_distance;
+                        break;
+                    }
+                }
+            }
+
+            hair_style.second.simulate(hair_simulation_pipeline,
+                                       hair_interpolation_pipeline,
+                                       hair_bounds_pipeline,
+                                       frame,
+                                       simulation,
+                                       step,
+                                       simulation_time,
+                                       command_buffer,
+                                       collider,
+                                       hair_to_collider);
+        }
+
+        if (query_pool != nullptr)
+            vk::DebugMarker::close(command_buffer, "Simulate Strands", *query_pool);
+        else
+            vk::DebugMarker::close(command_buffer);
+    }
+
+    void Rasterizer::simulate(const SceneGraph& scene_graph, Raytracer& raytracer) {
+        if (!simulation.enabled)
+            return;
+
+        wait_for_frame(); // since it's stepped with the descriptor sets of this frame.
+
+        auto command_buffer = command_pool.allocate_and_begin();
+
+        simulate(scene_graph, command_buffer, nullptr); // the queries are only reset in a frame.
+
+        for (auto& hair_style : hair_styles)
+            hair_style.second.read_back_vertices(device, command_buffer);
+
+        command_buffer.end();
+
+        command_pool.get_queue().submit(command_buffer).wait_idle();
+
+        std::unordered_map<const HairStyle*, Raytracer::MovedStrands> moved_strands;
+        for (auto& hair_style : hair_styles) {
+            Raytracer::MovedStrands moved_style;
+            hair_style.second.fetch_vertices(*hair_style.first, moved_style.position_thickness, moved_style.tangents);
+            if (!moved_style.position_thickness.empty())
+                moved_strands.emplace(hair_style.first, std::move(moved_style));
+        }
+
+        raytracer.update_hair_styles(scene_graph, moved_strands);
+    }
+
+    void Rasterizer::submit_voxelization(const SceneGraph& scene_graph) {
+        auto& command_buffer = compute_command_buffers[frame];
+
+        // Then the volumes stay on the compute queue (of the peer), where they're copied from.
+        bool peer_voxelization { peer_voxelization_enabled() };
+        auto graphics_queue_family = peer_voxelization ? device.get_compute_queue().get_family_index()
+                                                       : device.get_graphics_queue().get_family_index();
+
+        auto& query_pool = compute_query_pools[frame];
+
+        command_buffer.begin();
+
+        command_buffer.reset_query_pool(query_pool, 0, query_pool.get_query_count());
+
+        simulate(scene_graph, command_buffer, &query_pool);
+
+        vk::DebugMarker::begin(command_buffer, "Voxelize Strands", query_pool);
+
+        VkDeviceSize peer_volume_offset { 0 };
+
+        // The clean ones are left with the graphics queue (and in peer_volumes), until a voxelize takes
+        // them back, which discards their contents, so they don't need to be released to compute.
+        for (auto& hair_style : hair_styles) {
+            if (!hair_style.second.dirty_volumes) {
+                peer_volume_offset += hair_style.second.get_volume_transfer_size();
+                continue;
+            }
+
+            hair_style.second.voxelize(hair_voxel_pipeline,
+                                       hair_voxel_resolve_pipeline,
+                                       hair_volume_mip_pipeline,
+                                       hair_transmittance_pipeline,
+                                       hair_ambient_occlusion_pipeline,
+                                       hair_distance_field_pipeline,
+                                       frame,
+                                       strand_voxels,
+                                       voxel_statistics,
+                                       command_buffer,
+                                       device.get_compute_queue().get_family_index(),
+                                       graphics_queue_family);
+
+            if (peer_voxelization) {
+                hair_style.second.transfer_volumes(peer_volumes, peer_volume_offset, command_buffer);
+                peer_volume_offset += hair_style.second.get_volume_transfer_size();
+            }
+        }
+
+        vk::DebugMarker::close(command_buffer, "Voxelize Strands", query_pool);
+
+        command_buffer.end();
+
+        std::vector<vk::Semaphore*> wait_semaphores;
+        std::vector<VkPipelineStageFlags> wait_stages;
+
+        // Last frame must be done sampling the volumes before we overwrite them.
+        if (volumes_in_use) {
+            wait_semaphores.push_back(&volumes_released[latest_drawn_frame]);
+            wait_stages.push_back(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        }
+
+        // The semaphores are on the peer too, and the frame then waits for it on the first GPU.
+        device.get_compute_queue().submit(command_buffer,
+                                          wait_semaphores, wait_stages,
+                                          { &voxelization_complete[frame] },
+                                          peer_voxelization ? PeerDevice : get_frame_device());
+
+        volumes_in_use = false;
+    }
+
+    void Rasterizer::update_volume_states(const SceneGraph& scene_graph) {
+        for (auto& hair_style : hair_styles) {
+            auto volume_state = get_volume_state(scene_graph, hair_style.first);
+            hair_style.second.dirty_volumes = simulation.enabled || volume_state != hair_style.second.voxelized_state;
+            hair_style.second.voxelized_state = volume_state;
+        }
+    }
+
+    std::size_t Rasterizer::get_volume_state(const SceneGraph& scene_graph, const HairStyle* hair_style) const {
+        std::size_t state { 14695981039346656037ull };
+
+        // Only the settings that the passes of HairStyle::voxelize read: the raycast_steps are in the
+        // transmittance, and the occlusion_radius and ao_clamp in the AO, so the others don't redo it.
+        const auto& settings = imgui.parameters;
+        state = hash_bytes(state, &settings.raycast_steps, sizeof(settings.raycast_steps));
+        state = hash_bytes(state, &settings.occlusion_radius, sizeof(settings.occlusion_radius));
+        state = hash_bytes(state, &settings.ao_clamp, sizeof(settings.ao_clamp));
+
+        // Not the strand_ratio, since every strand is voxelized, and it's changed when zooming anyway.
+        // The hair_opacity is the hair_alpha of the transmittance.
+        const auto& parameters = hair_styles.at(hair_style).parameters;
+        state = hash_bytes(state, &parameters.volume_bounds, sizeof(parameters.volume_bounds));
+        state = hash_bytes(state, &parameters.volume_resolution, sizeof(parameters.volume_resolution));
+        state = hash_bytes(state, &parameters.strand_radius, sizeof(parameters.strand_radius));
+        state = hash_bytes(state, &parameters.hair_opacity, sizeof(parameters.hair_opacity));
+
+        auto light_revision = scene_graph.get_light_source_revision();
+        state = hash_bytes(state, &light_revision, sizeof(light_revision));
+        state = hash_bytes(state, &volume_pipeline_revision, sizeof(volume_pipeline_revision));
+
+        // Once more when the simulation stops, or when they move between the GPUs of the group.
+        bool peer_voxelization = peer_voxelization_enabled();
+        state = hash_bytes(state, &simulation.enabled, sizeof(simulation.enabled));
+        state = hash_bytes(state, &peer_voxelization, sizeof(peer_voxelization));
+
+        for (const auto& hair_node : scene_graph.get_nodes_with_hair_styles()) {
+            const auto& node_styles = hair_node->get_hair_styles();
+            if (std::find(node_styles.begin(), node_styles.end(), hair_style) == node_styles.end())
+                continue;
+            const auto& model = hair_node->get_model_matrix();
+            state = hash_bytes(state, &model, sizeof(model));
+        }
+
+        return state;
+    }
+
+    bool Rasterizer::peer_voxelization_enabled() const {
+        return peer_voxelization_supported && !simulation.enabled;
+    }
+
+    std::uint32_t Rasterizer::get_frame_device() const {
+        return device.get_device_count() > 1 ? 0 : vk::Queue::AllDevices;
+    }
+
+    void Rasterizer::draw_color(const SceneGraph& scene_graph, vk::CommandBuffer& command_buffer) {
+        vk::DebugMarker::begin(command_buffers[frame], "Color Pass");
+
+#ifdef VK_NV_shading_rate_image
+        if (variable_rate_shading_enabled()) {
+            vk::DebugMarker::begin(command_buffers[frame], "Generate Shading Rate Image", query_pools[frame]);
+            shading_rate_image.generate(ppll, frame, shading_rate_pipeline, command_buffers[frame]);
+            vk::DebugMarker::close(command_buffers[frame], "Generate Shading Rate Image", query_pools[frame]);
+        }
+#endif
+
+        vk::DebugMarker::begin(command_buffers[frame], "Clear PPLL Nodes", query_pools[frame]);
+        ppll.clear(command_buffers[frame]);
+        vk::DebugMarker::close(command_buffers[frame], "Clear PPLL Nodes", query_pools[frame]);
+
+        vk::DebugMarker::begin(command_buffers[frame], "Cull Light Tiles", query_pools[frame]);
+        light_tiles.cull(light_culling_pipeline, frame, command_buffers[frame]);
+        vk::DebugMarker::close(command_buffers[frame], "Cull Light Tiles", query_pools[frame]);
+
+        bake_scattering_lut(command_buffers[frame]);
+
+        if (imgui.raymarcher_enabled(farthest_level_of_detail) && imgui.parameters.temporal_accumulation)
+            prepare_volume_history(command_buffers[frame]);
+
+        // The hair passes are drawn after the color pass instead, into the hair_target, see draw_scaled_hairs.
+        bool scaled_hair = scaled_hair_enabled();
+
+        bool scaled_raymarch = imgui.raymarcher_enabled(farthest_level_of_detail) && scaled_strand_dvr_enabled() && !scaled_hair;
+
+        if (scaled_raymarch) {
+            vk::DebugMarker::begin(command_buffers[frame], "Scaled Raymarch", query_pools[frame], get_statistics_pool());
+            scaled_strand_dvr(scene_graph, scaled_dvr_pipeline, command_buffers[frame]);
+            vk::DebugMarker::close(command_buffers[frame], "Scaled Raymarch", query_pools[frame], get_statistics_pool());
+        }
+
+        bool weighted_blended_oit = imgui.parameters.transparency == 1;
+        bool depth_sorted = depth_sorting_enabled();
+        bool rasterize_hairs = imgui.rasterizer_enabled(nearest_level_of_detail) && !weighted_blended_oit && !depth_sorted;
+        bool sorted_hairs = imgui.rasterizer_enabled(nearest_level_of_detail) && depth_sorted; // blended in the color pass.
+        bool raymarch_hairs = imgui.raymarcher_enabled(farthest_level_of_detail);
+        bool opaque_depth = opaque_depth_enabled(); // before the strands, in the same subpass.
+
+        auto expansion = static_cast<vulkan::HairStyle::Expansion>(imgui.parameters.strand_expansion);
+        if (expansion == vulkan::HairStyle::Expansion::TessellatedCurves && !tessellated_curves)
+            expansion = vulkan::HairStyle::Expansion::PulledLines;
+        auto& hair_pipeline = expansion == vulkan::HairStyle::Expansion::PulledLines       ? hair_pulled_lines_pipeline :
+                              expansion == vulkan::HairStyle::Expansion::PulledQuads       ? hair_pulled_quads_pipeline :
+                              expansion == vulkan::HairStyle::Expansion::TessellatedCurves ? hair_curves_pipeline :
+                                                                                             hair_style_pipeline;
+
+        // With stereo, it's drawn into the eyes' layers, which are copied into the swapchain below.
+        auto& color_framebuffer = stereo_rendering ? stereo_target.get_framebuffer() : framebuffers[frame_image];
+
+        if (parallel_recording_enabled()) {
+            command_buffers[frame].begin_render_pass(color_pass, color_framebuffer,
+                                                     { 1.00f, 1.00f, 1.00f, 1.00f },
+                                                     VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+            std::vector<RecordingBatch> batches;
+
+            append_batches(batches, scene_graph.get_nodes_with_models().size(), color_pass, 0, color_framebuffer,
+                           [&](std::size_t first_node, std::size_t node_count, vk::CommandBuffer& secondary) {
+                               draw_model(scene_graph, model_mesh_pipeline, secondary, glm::mat4 { 1.0f }, 0, first_node, node_count);
+                           }, "Draw Mesh Models", get_model_draw_state(scene_graph));
+
+            append_batches(batches, impostor_instances.size(), color_pass, 0, color_framebuffer,
+                           [&](std::size_t first_style, std::size_t style_count, vk::CommandBuffer& secondary) {
+                               draw_impostors(scene_graph, hair_impostor_pipeline, secondary, first_style, style_count);
+                           }, "Draw Hair Impostors");
+
+            if (rasterize_hairs && opaque_depth) {
+                append_batches(batches, scene_graph.get_nodes_with_hair_styles().size(), color_pass, 0, color_framebuffer,
+                               [&](std::size_t first_node, std::size_t node_count, vk::CommandBuffer& secondary) {
+                                   draw_opaque_depth(scene_graph, hair_opaque_depth_pipeline, secondary, first_node, node_count);
+                               }, "Draw Opaque Depth");
+            }
+
+            if (rasterize_hairs && !scaled_hair) {
+                append_batches(batches, hair_instances[0].size(), color_pass, 0, color_framebuffer,
+                               [&](std::size_t first_style, std::size_t style_count, vk::CommandBuffer& secondary) {
+                                   set_hair_viewport(secondary); // it isn't inherited.
+                                   draw_hairs(scene_graph, hair_pipeline, secondary, glm::mat4 { 1.0f }, 0, expansion, first_style, style_count);
+                               }, "Draw Hair Styles", get_hair_draw_state(hair_pipeline, expansion));
+            }
+
+            // The batches are executed in order, so the styles are still blended farthest first. It's
+            // recorded every frame, since that order (and the sorted_hair_instances) changes with it.
+            if (sorted_hairs) {
+                append_batches(batches, sorted_hair_instances.size(), color_pass, 0, color_framebuffer,
+                               [&](std::size_t first_style, std::size_t style_count, vk::CommandBuffer& secondary) {
+                                   set_hair_viewport(secondary); // it isn't inherited.
+                                   draw_sorted_hairs(scene_graph, hair_sorted_pipeline, secondary, first_style, style_count);
+                               }, "Draw Sorted Hair Styles");
+            }
+
+            record_in_parallel(batches);
+            execute_batches(batches, 0, batches.size(), command_buffers[frame]);
+        } else {
+            command_buffers[frame].begin_render_pass(color_pass, color_framebuffer,
+                                                     { 1.00f, 1.00f, 1.00f, 1.00f });
+
+            vk::DebugMarker::begin(command_buffers[frame], "Draw Mesh Models", query_pools[frame], get_statistics_pool());
+            draw_model(scene_graph, model_mesh_pipeline, command_buffers[frame]);
+            vk::DebugMarker::close(command_buffers[frame], "Draw Mesh Models", query_pools[frame], get_statistics_pool());
+
+            if (!impostor_instances.empty()) {
+                vk::DebugMarker::begin(command_buffers[frame], "Draw Hair Impostors", query_pools[frame], get_statistics_pool());
+                draw_impostors(scene_graph, hair_impostor_pipeline, command_buffers[frame]);
+                vk::DebugMarker::close(command_buffers[frame], "Draw Hair Impostors", query_pools[frame], get_statistics_pool());
+            }
+
+            if (rasterize_hairs && opaque_depth) {
+                vk::DebugMarker::begin(command_buffers[frame], "Draw Opaque Depth", query_pools[frame], get_statistics_pool());
+                draw_opaque_depth(scene_graph, hair_opaque_depth_pipeline, command_buffers[frame]);
+                vk::DebugMarker::close(command_buffers[frame], "Draw Opaque Depth", query_pools[frame], get_statistics_pool());
+            }
+
+            if (rasterize_hairs && !scaled_hair) {
+                vk::DebugMarker::begin(command_buffers[frame], "Draw Hair Styles", query_pools[frame], get_statistics_pool());
+                set_hair_viewport(command_buffers[frame]);
+                draw_hairs(scene_graph, hair_pipeline, command_buffers[frame], glm::mat4 { 1.0f }, 0, expansion);
+                vk::DebugMarker::close(command_buffers[frame], "Draw Hair Styles", query_pools[frame], get_statistics_pool());
+            }
+
+            if (sorted_hairs) {
+                vk::DebugMarker::begin(command_buffers[frame], "Draw Sorted Hair Styles", query_pools[frame], get_statistics_pool());
+                set_hair_viewport(command_buffers[frame]);
+                draw_sorted_hairs(scene_graph, hair_sorted_pipeline, command_buffers[frame]);
+                vk::DebugMarker::close(command_buffers[frame], "Draw Sorted Hair Styles", query_pools[frame], get_statistics_pool());
+            }
+        }
+
+        command_buffers[frame].next_subpass(); // Next subpass which will read depth buffer values.
+
+        if (raymarch_hairs && !scaled_hair) {
+            vk::DebugMarker::begin(command_buffers[frame], "Raymarch Strands", query_pools[frame], get_statistics_pool());
+            set_hair_viewport(command_buffers[frame]);
+            strand_dvr(scene_graph, strand_dvr_pipeline, get_depth_buffer_view(), command_buffers[frame]);
+            vk::DebugMarker::close(command_buffers[frame], "Raymarch Strands", query_pools[frame], get_statistics_pool());
+        }
+
+        if (scaled_raymarch) {
+            vk::DebugMarker::begin(command_buffers[frame], "Upsample Raymarch", query_pools[frame], get_statistics_pool());
+            command_buffers[frame].bind_pipeline(dvr_upsample_pipeline);
+            command_buffers[frame].bind_descriptor_set(dvr_upsample_pipeline.descriptor_sets[frame], dvr_upsample_pipeline);
+            command_buffers[frame].draw(3); // covers the screen.
+            vk::DebugMarker::close(command_buffers[frame], "Upsample Raymarch", query_pools[frame], get_statistics_pool());
+        }
+
+        command_buffers[frame].end_render_pass();
+
+        // The passes after the color pass only say what they use, and the graph puts the barriers in.
+        vulkan::RenderGraph render_graph;
+
+        vulkan::RenderGraph::State color_pass_output { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                                       VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                                                       VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+
+        // With stereo, it has only been acquired, and the eyes are copied into it before anything else.
+        auto color_image = render_graph.import_image(swap_chain.get_images()[frame_image],
+                                                     stereo_rendering ? vulkan::RenderGraph::State { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0 }
+                                                                      : color_pass_output);
+        auto depth_image = render_graph.import_image(swap_chain.get_depth_buffer_image(),
+                                                     { VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                                                       VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                                                       swap_chain.get_depth_attachment_layout() });
+        auto linked_list = render_graph.import_buffer({ VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                                        VK_ACCESS_SHADER_WRITE_BIT }); // the PPLL buffers.
+
+        const vulkan::RenderGraph::State compute_read_write { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                                              VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                                                              VK_IMAGE_LAYOUT_GENERAL };
+
+        if (stereo_rendering) {
+            auto eyes_image = render_graph.import_image(stereo_target.get_color_image(), color_pass_output);
+
+            render_graph.add_pass({ { eyes_image,  { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                                                     VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL }, false },
+                                    { color_image, { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                                     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL }, true } },
+                                  [&](vk::CommandBuffer& pass_commands) {
+                vk::DebugMarker::begin(pass_commands, "Copy Stereo Eyes", query_pools[frame]);
+                stereo_target.copy(swap_chain.get_images()[frame_image], pass_commands);
+                vk::DebugMarker::close(pass_commands, "Copy Stereo Eyes", query_pools[frame]);
+            });
+
+            render_graph.release(eyes_image, color_pass_output); // next frame's color pass overwrites them.
+        }
+
+        // Left in these by the hair pass, or by its transitions at creation, so the same for every frame.
+        vulkan::RenderGraph::State hair_color_state { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                                      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                                                      VK_IMAGE_LAYOUT_GENERAL };
+        vulkan::RenderGraph::State hair_depth_state { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                                      VK_ACCESS_SHADER_READ_BIT,
+                                                      swap_chain.get_shader_read_only_layout() };
+
+        auto hair_color = render_graph.import_image(hair_target.get_color_image(), hair_color_state);
+        auto hair_depth = render_graph.import_image(hair_target.get_depth_image(), hair_depth_state);
+
+        // The same passes as in the color pass, but on top of its models, which are downsampled first.
+        if (scaled_hair) {
+            const vulkan::RenderGraph::State hair_pass_depth { VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                                                               VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                                                               swap_chain.get_shader_read_only_layout() };
+
+            render_graph.add_pass({ { color_image, { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                                                     VK_IMAGE_LAYOUT_GENERAL }, false },
+                                    { depth_image, { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                                                     swap_chain.get_shader_read_only_layout() }, false },
+                                    { hair_color,  { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                                     VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                                                     VK_IMAGE_LAYOUT_GENERAL }, true },
+                                    { hair_depth,  hair_pass_depth, true },
+                                    { linked_list, { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                                     VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT }, true } },
+                                  [&](vk::CommandBuffer& pass_commands) {
+                draw_scaled_hairs(scene_graph, hair_pipeline, expansion, pass_commands);
+            });
+        }
+
+        // What the strands are tested against, which is also what the PPLL is resolved into.
+        auto  hair_depth_image = scaled_hair ? hair_depth : depth_image;
+        auto  hair_color_image = scaled_hair ? hair_color : color_image;
+        auto& hair_depth_view  = scaled_hair ? hair_target.get_depth_view() : swap_chain.get_depth_buffer_view();
+
+        // Only with vertex inputs, since it's meant as the cheap path.
+        if (imgui.rasterizer_enabled(nearest_level_of_detail) && weighted_blended_oit) {
+            render_graph.add_pass({ }, [&](vk::CommandBuffer& pass_commands) {
+                VkClearValue accumulation_clear {  }, revealage_clear {  }, depth_clear {  };
+                accumulation_clear.color = { 0.0f, 0.0f, 0.0f, 0.0f };
+                revealage_clear.color    = { 1.0f, 0.0f, 0.0f, 0.0f };
+
+                pass_commands.begin_render_pass(weighted_blended_pass, weighted_blended.get_framebuffer(),
+                                                 { accumulation_clear, revealage_clear, depth_clear });
+                vk::DebugMarker::begin(pass_commands, "Draw Hair Styles", query_pools[frame], get_statistics_pool());
+                draw_hairs(scene_graph, hair_wboit_pipeline, pass_commands);
+                vk::DebugMarker::close(pass_commands, "Draw Hair Styles", query_pools[frame], get_statistics_pool());
+                pass_commands.end_render_pass();
+            });
+
+            render_graph.add_pass({ { color_image, compute_read_write, true } }, [&](vk::CommandBuffer& pass_commands) {
+                vk::DebugMarker::begin(pass_commands, "Composite WBOIT", query_pools[frame], get_statistics_pool());
+                weighted_blended.composite(swap_chain,
+                                           frame, frame_image,
+                                           wboit_composite_pipeline,
+                                           pass_commands);
+                vk::DebugMarker::close(pass_commands, "Composite WBOIT", query_pools[frame], get_statistics_pool());
+            });
+        }
+
+        if (imgui.rasterizer_enabled(nearest_level_of_detail) && software_rasterizer_enabled()) {
+            // Strands behind the models are discarded against the depth buffer.
+            render_graph.add_pass({ { hair_depth_image, { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                                                          swap_chain.get_shader_read_only_layout() }, false },
+                                    { linked_list, compute_read_write, true } },
+                                  [&](vk::CommandBuffer& pass_commands) {
+                vk::DebugMarker::begin(pass_commands, "Software Raster Strands", query_pools[frame], get_statistics_pool());
+                rasterize_strands(scene_graph, hair_depth_view, pass_commands);
+                vk::DebugMarker::close(pass_commands, "Software Raster Strands", query_pools[frame], get_statistics_pool());
+            });
+        }
+
+        render_graph.add_pass({ { linked_list, { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT }, false },
+                                { hair_color_image, compute_read_write, true } },
+                              [&](vk::CommandBuffer& pass_commands) {
+            vk::DebugMarker::begin(pass_commands, "Resolve the PPLL", query_pools[frame], get_statistics_pool());
+            if (scaled_hair) {
+                ppll.resolve(hair_target.get_color_view(), hair_target.get_extent(),
+                             frame,
+                             ppll_blend_pipeline,
+                             pass_commands);
+            } else {
+                ppll.resolve(swap_chain,
+                             frame, frame_image,
+                             ppll_blend_pipeline,
+                             pass_commands);
+            }
+            vk::DebugMarker::close(pass_commands, "Resolve the PPLL", query_pools[frame], get_statistics_pool());
+        });
+
+        if (scaled_hair) {
+            render_graph.add_pass({ { hair_color,  { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                                                     VK_IMAGE_LAYOUT_GENERAL }, false },
+                                    { color_image, compute_read_write, true } },
+                                  [&](vk::CommandBuffer& pass_commands) {
+                vk::DebugMarker::begin(pass_commands, "Upscale Hair", query_pools[frame], get_statistics_pool());
+                hair_target.upscale(swap_chain,
+                                    frame, frame_image,
+                                    hair_upscale_pipeline,
+                                    pass_commands);
+                vk::DebugMarker::close(pass_commands, "Upscale Hair", query_pools[frame], get_statistics_pool());
+            });
+        }
+
+        render_graph.add_pass({ { linked_list, { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT }, false } },
+                              [&](vk::CommandBuffer& pass_commands) {
+            ppll.read_back_node_counter(frame, pass_commands); // for the adaptive resizing.
+        });
+
+        if (temporal_anti_aliasing_enabled()) {
+            // After everything that's drawn into the color image, but before the GUI.
+            render_graph.add_pass({ { depth_image, { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                                                     swap_chain.get_shader_read_only_layout() }, false },
+                                    { color_image, compute_read_write, true } },
+                                  [&](vk::CommandBuffer& pass_commands) {
+                vk::DebugMarker::begin(pass_commands, "Resolve TAA", query_pools[frame], get_statistics_pool());
+                temporal_anti_aliasing.resolve(swap_chain,
+                                               frame, latest_drawn_frame, frame_image,
+                                               camera_jitter,
+                                               taa_resolve_pipeline,
+                                               pass_commands);
+                vk::DebugMarker::close(pass_commands, "Resolve TAA", query_pools[frame], get_statistics_pool());
+            });
+        } else temporal_anti_aliasing.invalidate();
+
+        // The cached overlay (see draw_overlay) skips the pass when there's nothing to draw, so then
+        // it's only left in the layout that it would have been presented in, as if it had been drawn.
+        bool overlay_pass = !imgui.overlay_cached() || imgui.is_visible();
+
+        // For the ImGui pass, which draws on top of the swapchain image and loads the depth buffer.
+        if (overlay_pass) {
+            render_graph.release(color_image, { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                                VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                                                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
+        } else {
+            render_graph.release(color_image, { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                                                swap_chain.get_khr_presentation_layout() });
+        }
+        render_graph.release(depth_image, { VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                                            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                                            swap_chain.get_depth_attachment_layout() });
+        // And for the next frame, which imports them the same.
+        render_graph.release(hair_color, hair_color_state);
+        render_graph.release(hair_depth, hair_depth_state);
+
+        render_graph.execute(command_buffers[frame]);
+
+        vk::DebugMarker::close(command_buffers[frame]);
+
+        vk::DebugMarker::begin(command_buffers[frame], "ImGui Pass");
+
+        if (overlay_pass)
+            draw_overlay(command_buffers[frame]);
+
+        vk::DebugMarker::close(command_buffers[frame]);
+    }
+
+    void Rasterizer::draw_model(const SceneGraph& scene_graph, Pipeline& pipeline, vk::CommandBuffer& command_buffer, glm::mat4 projection,
+                                std::uint32_t view, std::size_t first_node, std::size_t node_count) {
+        const auto& model_nodes = scene_graph.get_nodes_with_models();
+        auto last_node = first_node + std::min(node_count, model_nodes.size() - std::min(first_node, model_nodes.size()));
+
+        command_buffer.bind_pipeline(pipeline); // Color / Depth Pass.
+        for (auto node = first_node; node < last_node; ++node) {
+            if (view < model_visibility.size() && !model_visibility[view][node])
+                continue; // outside of the view's frustum.
+            auto& model_node = model_nodes[node];
+            command_buffer.push_constant(pipeline, 0, projection * model_node->get_model_matrix());
+            for (auto& model_mesh : model_node->get_models()) // at, since it may be called from many threads.
+                models.at(model_mesh).draw(pipeline, pipeline.descriptor_sets[frame], command_buffer);
+        }
+    }
+
+    void Rasterizer::draw_depth(const SceneGraph& scene_graph, vk::CommandBuffer& command_buffer) {
+        if (!imgui.rasterizer_enabled(nearest_level_of_detail) &&
+             imgui.raymarcher_enabled(farthest_level_of_detail)) {
+            return; // no need to bake shadow for volume.
+        }
+
+        vk::DebugMarker::begin(command_buffers[frame], "Depth Pass");
+
+        // The shadow maps are kept from the last frame if none of the lights or nodes in them moved.
+        std::vector<bool> dirty_shadow_maps(shadow_maps.size());
+        for (std::uint32_t i { 0 }; i < shadow_maps.size(); ++i) {
+            auto shadow_map_state = get_shadow_map_state(scene_graph, i);
+            dirty_shadow_maps[i] = simulation.enabled || shadow_map_state != shadow_maps[i].baked_state;
+            shadow_maps[i].baked_state = shadow_map_state;
+        }
+
+        bool multiview = multiview_shadows_enabled();
+        bool batched = !multiview && hair_batch_enabled();
+
+        if (batched && imgui.parameters.adsm_on) {
+            if (simulation.enabled)
+                hair_batch.refresh(command_buffer);
+            hair_batch.update(frame);
+        }
+
+        // Volumes aren't voxelized yet, so only frustum cull. With multiview it's the same draw for every light.
+        if (imgui.parameters.adsm_on && !multiview && !batched) {
+            for (std::uint32_t i { 0 }; i < shadow_maps.size(); ++i)
+                if (dirty_shadow_maps[i])
+                    cull_strands(scene_graph, 1 + i, shadow_maps[i].light->get_view_projection(), 0.0f, command_buffer);
+        }
+
+        vk::DebugMarker::begin(command_buffers[frame], "Bake Shadow Maps", query_pools[frame], get_statistics_pool());
+        if (parallel_recording_enabled()) {
+            // Every shadow map is recorded at the same time, and then executed one after the other.
+            std::vector<RecordingBatch> batches;
+            std::vector<std::size_t> shadow_map_batches;
+            std::vector<std::size_t> opacity_map_batches;
+
+            for (std::uint32_t i { 0 }; i < shadow_maps.size(); ++i) {
+                auto& shadow_map = shadow_maps[i];
+                glm::mat4 vp = shadow_map.light->get_view_projection();
+
+                shadow_map_batches.push_back(batches.size());
+
+                if (!dirty_shadow_maps[i] || multiview)
+                    continue;
+
+                // The dynamic state isn't inherited from the primary command buffer.
+                if (imgui.parameters.adsm_on && batched) {
+                    append_batches(batches, 1, depth_pass, 0, shadow_map.get_framebuffer(),
+                                   [&, i, vp](std::size_t, std::size_t, vk::CommandBuffer& secondary) {
+                                       shadow_maps[i].update_dynamic_viewport_scissor_depth(secondary);
+                                       hair_batch.draw(hair_batch_depth_pipeline, frame, 1 + i, vp, secondary);
+                                   });
+                } else if (imgui.parameters.adsm_on) {
+                    append_batches(batches, hair_instances[1 + i].size(), depth_pass, 0, shadow_map.get_framebuffer(),
+                                   [&, i, vp](std::size_t first_style, std::size_t style_count, vk::CommandBuffer& secondary) {
+                                       shadow_maps[i].update_dynamic_viewport_scissor_depth(secondary);
+                                       draw_hairs(scene_graph, hair_depth_pipeline, secondary, vp, 1 + i,
+                                                  vulkan::HairStyle::Expansion::VertexInputs, first_style, style_count);
+                                   });
+                }
+
+                if (imgui.parameters.ctsm_on) {
+                    append_batches(batches, scene_graph.get_nodes_with_models().size(), depth_pass, 0, shadow_map.get_framebuffer(),
+                                   [&, i, vp](std::size_t first_node, std::size_t node_count, vk::CommandBuffer& secondary) {
+                                       shadow_maps[i].update_dynamic_viewport_scissor_depth(secondary);
+                                       draw_model(scene_graph, mesh_depth_pipeline, secondary, vp, 1 + i, first_node, node_count);
+                                   });
+                }
+            }
+
+            shadow_map_batches.push_back(batches.size());
+
+            if (deep_opacity_maps_enabled()) {
+                for (std::uint32_t i { 0 }; i < opacity_maps.size(); ++i) {
+                    glm::mat4 vp = shadow_maps[i].light->get_view_projection();
+                    opacity_map_batches.push_back(batches.size());
+                    if (!dirty_shadow_maps[i])
+                        continue;
+                    append_batches(batches, hair_instances[1 + i].size(), opacity_pass, 0, opacity_maps[i].get_framebuffer(),
+                                   [&, i, vp](std::size_t first_style, std::size_t style_count, vk::CommandBuffer& secondary) {
+                                       draw_opacity(scene_graph, i, vp, secondary, first_style, style_count);
+                                   });
+                }
+
+                opacity_map_batches.push_back(batches.size());
+            }
+
+            record_in_parallel(batches);
+
+            if (multiview)
+                draw_multiview_depth(scene_graph, dirty_shadow_maps, command_buffer);
+
+            for (std::uint32_t i { 0 }; i < shadow_maps.size(); ++i) {
+                if (!dirty_shadow_maps[i] || multiview)
+                    continue;
+                command_buffer.begin_render_pass(depth_pass, shadow_maps[i], VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+                execute_batches(batches, shadow_map_batches[i], shadow_map_batches[i + 1], command_buffer);
+                command_buffer.end_render_pass();
+            }
+
+            // The opacity maps are still cleared when they're off, so they're always in their read layout.
+            for (std::uint32_t i { 0 }; i < opacity_maps.size(); ++i) {
+                if (!dirty_shadow_maps[i])
+                    continue;
+                if (deep_opacity_maps_enabled()) {
+                    command_buffer.begin_render_pass(opacity_pass, opacity_maps[i].get_framebuffer(), { 0.00f, 0.00f, 0.00f, 0.00f },
+                                                     VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+                    execute_batches(batches, opacity_map_batches[i], opacity_map_batches[i + 1], command_buffer);
+                } else {
+                    command_buffer.begin_render_pass(opacity_pass, opacity_maps[i].get_framebuffer(), { 0.00f, 0.00f, 0.00f, 0.00f });
+                }
+
+                command_buffer.end_render_pass();
+            }
+        } else {
+            if (multiview)
+                draw_multiview_depth(scene_graph, dirty_shadow_maps, command_buffer);
+
+            for (std::uint32_t i { 0 }; i < shadow_maps.size(); ++i) {
+                if (!dirty_shadow_maps[i] || multiview)
+                    continue;
+                auto& shadow_map = shadow_maps[i];
+                auto& vp = shadow_map.light->get_view_projection();
+                command_buffer.begin_render_pass(depth_pass, shadow_map);
+                shadow_map.update_dynamic_viewport_scissor_depth(command_buffer);
+
+                if (imgui.parameters.adsm_on && batched) hair_batch.draw(hair_batch_depth_pipeline, frame, 1 + i, vp, command_buffer);
+                else if (imgui.parameters.adsm_on) draw_hairs(scene_graph, hair_depth_pipeline, command_buffer, vp, 1 + i);
+                if (imgui.parameters.ctsm_on) draw_model(scene_graph, mesh_depth_pipeline, command_buffer, vp, 1 + i);
+
+                command_buffer.end_render_pass();
+            }
+
+            // After all of the depth maps, since the opacity layers start at them.
+            for (std::uint32_t i { 0 }; i < opacity_maps.size(); ++i) {
+                if (!dirty_shadow_maps[i])
+                    continue;
+                command_buffer.begin_render_pass(opacity_pass, opacity_maps[i].get_framebuffer(), { 0.00f, 0.00f, 0.00f, 0.00f });
+                if (deep_opacity_maps_enabled())
+                    draw_opacity(scene_graph, i, shadow_maps[i].light->get_view_projection(), command_buffer);
+                command_buffer.end_render_pass();
+            }
+        }
+
+        if (prefiltered_shadows_enabled())
+            filter_shadow_maps(dirty_shadow_maps, command_buffer);
+        else if (linear_shadow_maps_enabled())
+            linearize_shadow_maps(dirty_shadow_maps, command_buffer);
+        vk::DebugMarker::close(command_buffers[frame], "Bake Shadow Maps", query_pools[frame], get_statistics_pool());
+
+        vk::DebugMarker::close(command_buffers[frame]);
+    }
+
+    void Rasterizer::draw_multiview_depth(const SceneGraph& scene_graph, const std::vector<bool>& dirty_shadow_maps, vk::CommandBuffer& command_buffer) {
+        // Every layer is drawn again if any of them are, since the pass has the same views every time.
+        if (std::none_of(dirty_shadow_maps.begin(), dirty_shadow_maps.end(), [](bool dirty) { return dirty; }))
+            return;
+
+        VkClearValue depth_clear {  };
+        depth_clear.depthStencil = { 1.000f, 0u };
+
+        command_buffer.begin_render_pass(multiview_depth_pass, shadow_map_array.get_framebuffer(), depth_clear);
+        shadow_map_array.update_dynamic_viewport_scissor_depth(command_buffer);
+
+        // The lights' transforms are applied in the shaders, and the view after the lights' has them all.
+        std::uint32_t every_light = 1 + static_cast<std::uint32_t>(shadow_maps.size());
+        if (imgui.parameters.adsm_on) draw_hairs(scene_graph, hair_multiview_depth_pipeline, command_buffer, glm::mat4 { 1.0f }, every_light);
+        if (imgui.parameters.ctsm_on) draw_model(scene_graph, mesh_multiview_depth_pipeline, command_buffer, glm::mat4 { 1.0f }, every_light);
+
+        command_buffer.end_render_pass();
+    }
+
+    bool Rasterizer::multiview_shadows_enabled() const {
+        return imgui.parameters.multiview_shadows && shadow_map_array.get_layer_count() != 0;
+    }
+
+    bool Rasterizer::hair_batch_enabled() const {
+        return imgui.parameters.batched_depth && hair_batch.is_drawable();
+    }
+
+    VkExtent2D Rasterizer::get_color_extent() const {
+        auto extent = swap_chain.get_extent();
+        if (stereo_rendering)
+            extent.width = std::max(extent.width / vulkan::StereoTarget::Eyes, 1u);
+        return extent;
+    }
+
+    bool Rasterizer::stereo_enabled() const {
+        return stereo_rendering;
+    }
+
+    vk::ImageView& Rasterizer::get_depth_buffer_view() {
+        if (stereo_rendering)
+            return stereo_target.get_depth_view();
+        return swap_chain.get_depth_buffer_view();
+    }
+
+    void Rasterizer::use_stereo_paths(Interface::Parameters& parameters) const {
+        // These are shaded with just the one camera, or with another pass that isn't multiview.
+        parameters.strand_expansion = static_cast<int>(vulkan::HairStyle::Expansion::VertexInputs);
+        parameters.transparency = 0; // i.e. the PPLL.
+        parameters.software_rasterizer = false;
+        parameters.deferred_shading = false;
+        parameters.scaled_raymarch = false;
+        parameters.temporal_accumulation = false;
+        parameters.impostors = false;
+        parameters.temporal_anti_aliasing = false; // it only reprojects the one camera.
+        parameters.render_scale = 1.0f; // the eyes are layers of the color pass' target.
+        parameters.variable_rate_shading = false; // the pipelines are built without it.
+    }
+
+    void Rasterizer::draw_hairs(const SceneGraph& scene_graph, Pipeline& pipeline, vk::CommandBuffer& command_buffer, glm::mat4 projection,
+                                std::uint32_t view, vulkan::HairStyle::Expansion expansion, std::size_t first_style, std::size_t style_count) {
+        if (view >= hair_instances.size())
+            return; // before the first update.
+
+        const auto& view_instances = hair_instances[view];
+        auto last_style = first_style + std::min(style_count, view_instances.size() - std::min(first_style, view_instances.size()));
+
+        command_buffer.bind_pipeline(pipeline); // Color / Depth / Voxels.
+        for (auto style = first_style; style < last_style; ++style) {
+            const auto& hair_instance = view_instances[style];
+            auto& vulkan_hair_style = hair_styles.at(hair_instance.hair_style); // at, since it may be called from many threads.
+            if (view == 0 && vulkan_hair_style.software_rasterized)
+                continue; // see rasterize_strands.
+            command_buffer.push_constant(pipeline, 0, vulkan::HairStyle::Instances { projection, hair_instance.first_instance });
+            vulkan_hair_style.draw(pipeline, pipeline.descriptor_sets[frame], command_buffer, view, expansion,
+                                   hair_instance.instance_count);
+        }
+    }
+
+    void Rasterizer::sort_segments(const SceneGraph& scene_graph, vk::CommandBuffer& command_buffer) {
+        sorted_hair_instances.clear();
+
+        if (hair_instances.empty())
+            return; // before the first update.
+
+        const auto& view = scene_graph.get_camera().get_view_matrix();
+
+        std::vector<std::pair<float, HairInstances>> style_depths;
+        for (const auto& hair_instance : hair_instances[0]) {
+            const auto& vulkan_hair_style = hair_styles[hair_instance.hair_style];
+            if (vulkan_hair_style.software_rasterized)
+                continue; // see rasterize_strands.
+            const auto& bounds = vulkan_hair_style.parameters.volume_bounds;
+            const auto& model = hair_instance_data[hair_instance.first_instance].model;
+            glm::vec4 center = view * model * glm::vec4 { bounds.origin + bounds.size * 0.5f, 1.0f };
+            style_depths.emplace_back(-center.z, hair_instance);
+        }
+
+        std::stable_sort(style_depths.begin(), style_depths.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.first > rhs.first; // farthest first.
+        });
+
+        for (const auto& style_depth : style_depths) {
+            const auto& hair_instance = style_depth.second;
+            const auto& model = hair_instance_data[hair_instance.first_instance].model;
+            hair_styles[hair_instance.hair_style].sort(hair_sort_keys_pipeline, hair_sort_histogram_pipeline,
+                                                       hair_sort_scan_pipeline, hair_sort_scatter_pipeline,
+                                                       frame, view * model, hair_instance.instance_count,
+                                                       command_buffer);
+            sorted_hair_instances.push_back(hair_instance);
+        }
+    }
+
+    void Rasterizer::draw_sorted_hairs(const SceneGraph&, Pipeline& pipeline, vk::CommandBuffer& command_buffer,
+                                       std::size_t first_style, std::size_t style_count) {
+        auto last_style = first_style + std::min(style_count, sorted_hair_instances.size() - std::min(first_style, sorted_hair_instances.size()));
+
+        command_buffer.bind_pipeline(pipeline);
+        for (auto style = first_style; style < last_style; ++style) {
+            const auto& hair_instance = sorted_hair_instances[style];
+            auto& vulkan_hair_style = hair_styles.at(hair_instance.hair_style); // at, since it may be called from many threads.
+            command_buffer.push_constant(pipeline, 0, vulkan::HairStyle::Instances { glm::mat4 { 1.0f }, hair_instance.first_instance });
+            vulkan_hair_style.draw_sorted(pipeline, pipeline.descriptor_sets[frame], command_buffer,
+                                          hair_instance.instance_count);
+        }
+    }
+
+    // Never with stereo, see use_stereo_paths, and the scaled hair pass is only for the PPLL.
+    bool Rasterizer::depth_sorting_enabled() const {
+        return imgui.parameters.transparency == 2 && imgui.parameters.renderer != Renderer::Ray_Tracer;
+    }
+
+    void Rasterizer::draw_impostors(const SceneGraph&, Pipeline& pipeline, vk::CommandBuffer& command_buffer,
+                                    std::size_t first_style, std::size_t style_count) {
+        auto last_style = first_style + std::min(style_count, impostor_instances.size() - std::min(first_style, impostor_instances.size()));
+
+        command_buffer.bind_pipeline(pipeline);
+        for (auto style = first_style; style < last_style; ++style) {
+            const auto& impostor_instance = impostor_instances[style];
+            auto& vulkan_hair_style = hair_styles.at(impostor_instance.hair_style);
+            command_buffer.push_constant(pipeline, 0, vulkan::HairStyle::Instances { glm::mat4 { 1.0f }, impostor_instance.first_instance });
+            vulkan_hair_style.draw_impostor(pipeline, pipeline.descriptor_sets[frame], command_buffer,
+                                            impostor_instance.instance_count);
+        }
+    }
+
+    std::size_t Rasterizer::get_shadow_map_state(const SceneGraph& scene_graph, std::uint32_t light) const {
+        std::size_t state { 14695981039346656037ull };
+
+        // Any setting could change how it's drawn, and they're rarely changed anyway.
+        state = hash_bytes(state, &imgui.parameters, sizeof(imgui.parameters));
+
+        const auto& view_projection = shadow_maps[light].light->get_view_projection();
+        state = hash_bytes(state, &view_projection, sizeof(view_projection));
+
+        auto resolution = shadow_maps[light].get_resolution();
+        state = hash_bytes(state, &resolution, sizeof(resolution));
+
+        // The hair that's in the light's frustum, and how much of it is drawn.
+        if (1 + light < hair_instances.size()) {
+            for (const auto& hair_instance : hair_instances[1 + light]) {
+                state = hash_bytes(state, &hair_instance.hair_style, sizeof(hair_instance.hair_style));
+                const auto& strand_ratio = hair_styles.at(hair_instance.hair_style).parameters.strand_ratio;
+                state = hash_bytes(state, &strand_ratio, sizeof(strand_ratio));
+                for (std::uint32_t i { 0 }; i < hair_instance.instance_count; ++i) {
+                    const auto& model = hair_instance_data[hair_instance.first_instance + i].model;
+                    state = hash_bytes(state, &model, sizeof(model));
+                }
+            }
+        }
+
+        // And the same for the models.
+        const auto& model_nodes = scene_graph.get_nodes_with_models();
+        for (std::size_t node { 0 }; node < model_nodes.size(); ++node) {
+            if (1 + light < model_visibility.size() && !model_visibility[1 + light][node])
+                continue;
+            const auto& model = model_nodes[node]->get_model_matrix();
+            state = hash_bytes(state, &model, sizeof(model));
+        }
+
+        return state;
+    }
+
+    void Rasterizer::draw_opacity(const SceneGraph& scene_graph, std::uint32_t light, const glm::mat4& projection, vk::CommandBuffer& command_buffer,
+                                  std::size_t first_style, std::size_t style_count) {
+        opacity_maps[light].update_dynamic_viewport_scissor_depth(command_buffer);
+        // The depth map it reads is picked after the transforms, see deep_opacity_map.frag.
+        command_buffer.push_constant(hair_opacity_pipeline, sizeof(vulkan::HairStyle::Instances), light);
+        draw_hairs(scene_graph, hair_opacity_pipeline, command_buffer, projection, 1 + light,
+                   vulkan::HairStyle::Expansion::VertexInputs, first_style, style_count);
+    }
+
+    bool Rasterizer::deep_opacity_maps_enabled() const {
+        return imgui.parameters.adsm_on && imgui.parameters.shadow_technique == Interface::DeepOpacityMaps;
+    }
+
+    void Rasterizer::filter_shadow_maps(const std::vector<bool>& dirty_shadow_maps, vk::CommandBuffer& command_buffer) {
+        for (std::size_t i { 0 }; i < filtered_shadow_maps.size(); ++i)
+            if (dirty_shadow_maps[i])
+                filtered_shadow_maps[i].filter(shadow_filter_pipeline, shadow_maps[i], frame, command_buffer);
+    }
+
+    bool Rasterizer::prefiltered_shadows_enabled() const {
+        return imgui.parameters.adsm_on && imgui.parameters.adsm_prefiltered && !deep_opacity_maps_enabled();
+    }
+
+    void Rasterizer::linearize_shadow_maps(const std::vector<bool>& dirty_shadow_maps, vk::CommandBuffer& command_buffer) {
+        for (std::size_t i { 0 }; i < filtered_shadow_maps.size(); ++i) {
+            if (!dirty_shadow_maps[i])
+                continue;
+            const auto& light_buffer = shadow_maps[i].light->get_buffer();
+            filtered_shadow_maps[i].linearize(shadow_filter_pipeline, shadow_maps[i], light_buffer.near, light_buffer.far,
+                                              frame, command_buffer);
+        }
+    }
+
+    bool Rasterizer::linear_shadow_maps_enabled() const {
+        return imgui.parameters.adsm_on && imgui.parameters.linear_shadow_maps && !prefiltered_shadows_enabled() && !deep_opacity_maps_enabled();
+    }
+
+    bool Rasterizer::parallel_recording_enabled() const {
+        // The statistics queries are in the primary command buffer, so they would need inherited queries.
+        return imgui.parameters.parallel_recording && JobSystem::get().get_thread_count() > 1 && !pipeline_statistics_enabled();
+    }
+
+    bool Rasterizer::static_batches_enabled() const {
+        return imgui.parameters.static_batches;
+    }
+
+    std::size_t Rasterizer::get_model_draw_state(const SceneGraph& scene_graph) const {
+        std::size_t state { 14695981039346656037ull };
+
+        // The visible nodes and their pushed matrices, but not the camera, since it's read from its
+        // buffer, so they're only recorded again when a node moves or goes in or out of the frustum.
+        const auto& model_nodes = scene_graph.get_nodes_with_models();
+        for (std::size_t node { 0 }; node < model_nodes.size(); ++node) {
+            bool visible = model_visibility.empty() || model_visibility[0][node];
+            state = hash_bytes(state, &visible, sizeof(visible));
+            if (!visible)
+                continue;
+            const auto& model = model_nodes[node]->get_model_matrix();
+            state = hash_bytes(state, &model, sizeof(model));
+            for (const auto& model_mesh : model_nodes[node]->get_models())
+                state = hash_bytes(state, &model_mesh, sizeof(model_mesh));
+        }
+
+        // The bound copies of the pipeline's set are re-written when it is, see DescriptorCache::get.
+        auto descriptor_set_version = model_mesh_pipeline.descriptor_sets[frame].get_version();
+        state = hash_bytes(state, &descriptor_set_version, sizeof(descriptor_set_version));
+
+        return state;
+    }
+
+    std::size_t Rasterizer::get_hair_draw_state(const Pipeline& pipeline, vulkan::HairStyle::Expansion expansion) const {
+        std::size_t state { 14695981039346656037ull };
+
+        // Same as for the shadow maps, e.g. the variable rate shading is bound in set_hair_viewport.
+        state = hash_bytes(state, &imgui.parameters, sizeof(imgui.parameters));
+
+        auto pipeline_address = &pipeline;
+        state = hash_bytes(state, &pipeline_address, sizeof(pipeline_address));
+        state = hash_bytes(state, &expansion, sizeof(expansion));
+
+        auto extent = get_hair_extent();
+        state = hash_bytes(state, &extent, sizeof(extent));
+
+        // The styles on the screen, their instances, and how much of them is drawn (or culled).
+        if (!hair_instances.empty()) {
+            for (const auto& hair_instance : hair_instances[0]) {
+                state = hash_bytes(state, &hair_instance, sizeof(hair_instance));
+                auto draw_state = hair_styles.at(hair_instance.hair_style).get_draw_state(0);
+                state = hash_bytes(state, &draw_state, sizeof(draw_state));
+            }
+        }
+
+        auto descriptor_set_version = pipeline.descriptor_sets[frame].get_version();
+        state = hash_bytes(state, &descriptor_set_version, sizeof(descriptor_set_version));
+
+        return state;
+    }
+
+    bool Rasterizer::pipeline_statistics_enabled() const {
+        return pipeline_statistics_supported && imgui.parameters.pipeline_statistics;
+    }
+
+    vk::QueryPool* Rasterizer::get_statistics_pool() {
+        return pipeline_statistics_enabled() ? &statistics_pools[frame] : nullptr;
+    }
+
+    void Rasterizer::reset_recording_threads() {
+        for (auto& recording_thread : recording_threads[frame]) {
+            if (recording_thread.recorded != 0)
+                recording_thread.command_pool.reset();
+            recording_thread.recorded = 0;
+        }
+    }
+
+    void Rasterizer::append_batches(std::vector<RecordingBatch>& batches, std::size_t node_count,
+                                    vk::RenderPass& render_pass, std::uint32_t subpass, vk::Framebuffer& framebuffer,
+                                    const std::function<void(std::size_t, std::size_t, vk::CommandBuffer&)>& record,
+                                    const char* timestamp, std::size_t state) {
+        std::size_t thread_count = recording_threads[frame].size();
+        std::size_t batch_size   = std::max<std::size_t>((node_count + thread_count - 1) / thread_count, 1);
+        std::size_t first_batch  = batches.size();
+
+        // Still recorded when there aren't any nodes, since it binds the pipeline (and the timestamps).
+        for (std::size_t first_node { 0 }; first_node < std::max<std::size_t>(node_count, 1); first_node += batch_size) {
+            batches.push_back(RecordingBatch {
+                &render_pass, subpass, &framebuffer,
+                [record, first_node, batch_size](vk::CommandBuffer& command_buffer) {
+                    record(first_node, batch_size, command_buffer);
+                }
+            });
+        }
+
+        std::uint32_t begin_query { 0 }, end_query { 0 };
+
+        // Timestamps can't be written in the primary command buffer inside this subpass, so
+        // the first batch writes the one at the beginning, and the last batch the one at end.
+        if (timestamp != nullptr) {
+            auto& query_pool = query_pools[frame];
+
+            begin_query = query_pool.query++;
+            end_query   = query_pool.query++;
+
+            query_pool.set_begin_timestamp(timestamp, begin_query);
+            query_pool.set_end_timestamp(timestamp, end_query);
+
+            auto first_record = std::move(batches[first_batch].record);
+            batches[first_batch].record = [first_record, &query_pool, begin_query](vk::CommandBuffer& command_buffer) {
+                command_buffer.write_timestamp(query_pool, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, begin_query);
+                first_record(command_buffer);
+            };
+
+            auto last_record = std::move(batches.back().record);
+            batches.back().record = [last_record, &query_pool, end_query](vk::CommandBuffer& command_buffer) {
+                last_record(command_buffer);
+                command_buffer.write_timestamp(query_pool, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, end_query);
+            };
+        }
+
+        // The nodes of each batch only change with their count, and the queries with the sections
+        // before them, which is why they're in the state, along with the resources being re-created.
+        if (state != 0 && timestamp != nullptr && static_batches_enabled()) {
+            std::size_t key = hash_bytes(14695981039346656037ull, timestamp, std::strlen(timestamp));
+
+            auto render_pass_handle = render_pass.get_handle();
+            state = hash_bytes(state, &render_pass_handle, sizeof(render_pass_handle));
+            state = hash_bytes(state, &subpass, sizeof(subpass));
+            state = hash_bytes(state, &node_count, sizeof(node_count));
+            state = hash_bytes(state, &begin_query, sizeof(begin_query));
+            state = hash_bytes(state, &end_query, sizeof(end_query));
+            state = hash_bytes(state, &static_batch_revision, sizeof(static_batch_revision));
+
+            for (auto batch = first_batch; batch < batches.size(); ++batch) {
+                auto batch_index = batch - first_batch;
+                batches[batch].key   = hash_bytes(key, &batch_index, sizeof(batch_index));
+                batches[batch].state = state;
+            }
+        }
+    }
+
+    void Rasterizer::record_in_parallel(std::vector<RecordingBatch>& batches) {
+        // Looked up (or added) before, since the map can't be modified from more than one thread.
+        std::vector<StaticBatch*> batch_caches(batches.size(), nullptr);
+        for (std::size_t i { 0 }; i < batches.size(); ++i) {
+            if (batches[i].key == 0)
+                continue;
+            auto& static_batch = static_batches[frame][batches[i].key];
+            if (static_batch.command_pool.get_handle() == VK_NULL_HANDLE) {
+                static_batch.command_pool = vk::CommandPool { device, device.get_graphics_queue() };
+                static_batch.command_buffer = static_batch.command_pool.allocate(VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+            }
+
+            batch_caches[i] = &static_batch;
+        }
+
+        JobSystem::get().parallel_for(0, static_cast<int>(batches.size()), 1, [&](int i) {
+            auto& batch = batches[i];
+            auto static_batch = batch_caches[i];
+
+            if (static_batch != nullptr) {
+                batch.command_buffer = &static_batch->command_buffer;
+                if (static_batch->recorded_state == batch.state)
+                    return; // it's the same as the last time that this frame was drawn.
+            } else {
+                auto& recording_thread = recording_threads[frame][JobSystem::get_thread_index()];
+
+                if (recording_thread.recorded == recording_thread.command_buffers.size())
+                    recording_thread.command_buffers.push_back(recording_thread.command_pool.allocate(VK_COMMAND_BUFFER_LEVEL_SECONDARY));
+
+                batch.command_buffer = &recording_thread.command_buffers[recording_thread.recorded++];
+            }
+
+            TraceRecorder::Scope trace_scope { "Record Batch" };
+
+            if (static_batch != nullptr) {
+                static_batch->recorded_state = 0; // until it's been recorded.
+                batch.command_buffer->begin(*batch.render_pass, batch.subpass);
+            } else {
+                batch.command_buffer->begin(*batch.render_pass, batch.subpass, *batch.framebuffer);
+            }
+
+            batch.record(*batch.command_buffer);
+            batch.command_buffer->end();
+
+            if (static_batch != nullptr)
+                static_batch->recorded_state = batch.state;
+        });
+    }
+
+    void Rasterizer::execute_batches(std::vector<RecordingBatch>& batches, std::size_t first, std::size_t last,
+                                     vk::CommandBuffer& command_buffer) {
+        std::vector<vk::CommandBuffer*> secondary_command_buffers;
+        for (std::size_t i { first }; i < last; ++i)
+            secondary_command_buffers.push_back(batches[i].command_buffer);
+        command_buffer.execute_commands(secondary_command_buffers);
+    }
+
+    void Rasterizer::draw_overlay(vk::CommandBuffer& command_buffer) {
+        // Any of them that this frame executed the last time is done, since its fence was waited on.
+        for (auto& overlay_batch : overlay_batches)
+            overlay_batch.pending_frames &= ~(1u << frame);
+
+        // Outside of it, since the timestamps can't be written in the subpass with the overlay batch.
+        vk::DebugMarker::begin(command_buffer, "Draw GUI Overlay", query_pools[frame]);
+
+        if (!imgui.overlay_cached()) {
+            command_buffer.begin_render_pass(imgui_pass, framebuffers[frame_image],
+                                             { 1.00f, 1.00f, 1.00f, 1.00f });
+            imgui.draw(command_buffer);
+        } else {
+            command_buffer.begin_render_pass(imgui_pass, framebuffers[frame_image],
+                                             { 1.00f, 1.00f, 1.00f, 1.00f },
+                                             VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+            // Only uploaded and recorded when it was built again, and the other frames keep drawing it.
+            // It's not when it's hidden for the screenshots, since it isn't built again after those.
+            if (imgui.is_visible()) {
+                if (latest_overlay == nullptr || overlay_revision != imgui.get_overlay_revision()) {
+                    latest_overlay = &*std::find_if(overlay_batches.begin(), overlay_batches.end(), [](const auto& overlay_batch) {
+                        return overlay_batch.pending_frames == 0;
+                    });
+
+                    latest_overlay->command_buffer.begin(imgui_pass, 0, vk::CommandBuffer::Simultaneous);
+                    imgui.draw(latest_overlay->command_buffer);
+                    latest_overlay->command_buffer.end();
+
+                    overlay_revision = imgui.get_overlay_revision();
+                }
+
+                command_buffer.execute_commands({ &latest_overlay->command_buffer });
+                latest_overlay->pending_frames |= 1u << frame;
+            }
+        }
+
+        command_buffer.next_subpass(); // Empty subpass just to make them compatible...
+        command_buffer.end_render_pass();
+
+        vk::DebugMarker::close(command_buffer, "Draw GUI Overlay", query_pools[frame]);
+    }
+
+    void Rasterizer::rasterize_strands(const SceneGraph& scene_graph, vk::ImageView& depth_view, vk::CommandBuffer& command_buffer) {
+        VkExtent2D tiles {
+            (get_hair_extent().width  + vulkan::HairStyle::TileSize - 1) / vulkan::HairStyle::TileSize,
+            (get_hair_extent().height + vulkan::HairStyle::TileSize - 1) / vulkan::HairStyle::TileSize
+        };
+
+        const auto& hair_nodes = scene_graph.get_nodes_with_hair_styles();
+        for (std::size_t node { 0 }; node < hair_nodes.size(); ++node) {
+            const auto& node_lod = hair_node_lods[node];
+            if (!node_lod.on_screen || !imgui.rasterizer_enabled(node_lod.level_of_detail))
+                continue;
+            for (auto& hair_style : hair_nodes[node]->get_hair_styles()) {
+                auto& vulkan_hair_style = hair_styles[hair_style];
+                if (!vulkan_hair_style.software_rasterized)
+                    continue;
+                vulkan_hair_style.rasterize(hair_bin_pipeline, hair_tile_pipeline, frame, hair_nodes[node]->get_model_matrix(),
+                                            node_lod.level_of_detail, strand_tile_counts, tiles, depth_view, depth_sampler, command_buffer);
+            }
+        }
+    }
+
+    bool Rasterizer::software_rasterizer_enabled() const {
+        return std::any_of(hair_styles.begin(), hair_styles.end(),
+                           [](const auto& hair_style) { return hair_style.second.software_rasterized; });
+    }
+
+    bool Rasterizer::temporal_anti_aliasing_enabled() const {
+        return imgui.parameters.temporal_anti_aliasing && imgui.parameters.renderer != Renderer::Ray_Tracer;
+    }
+
+    // The eyes are layers of the stereo_target, and WBOIT has its own targets at the full resolution.
+    bool Rasterizer::scaled_hair_enabled() const {
+        return imgui.parameters.render_scale < 1.0f && !stereo_rendering &&
+               imgui.parameters.transparency == 0 && imgui.parameters.renderer != Renderer::Ray_Tracer;
+    }
+
+    void Rasterizer::draw_scaled_hairs(const SceneGraph& scene_graph, Pipeline& hair_pipeline, vulkan::HairStyle::Expansion expansion,
+                                       vk::CommandBuffer& command_buffer) {
+        command_buffer.begin_render_pass(hair_pass, hair_target.get_framebuffer(),
+                                         { 1.00f, 1.00f, 1.00f, 1.00f }); // not cleared.
+
+        vk::DebugMarker::begin(command_buffer, "Downsample Hair Target", query_pools[frame], get_statistics_pool());
+        hair_target.downsample(swap_chain, frame, frame_image, hair_downsample_pipeline, command_buffer);
+        vk::DebugMarker::close(command_buffer, "Downsample Hair Target", query_pools[frame], get_statistics_pool());
+
+        if (imgui.rasterizer_enabled(nearest_level_of_detail)) {
+            vk::DebugMarker::begin(command_buffer, "Draw Hair Styles", query_pools[frame], get_statistics_pool());
+            set_hair_viewport(command_buffer);
+            draw_hairs(scene_graph, hair_pipeline, command_buffer, glm::mat4 { 1.0f }, 0, expansion);
+            vk::DebugMarker::close(command_buffer, "Draw Hair Styles", query_pools[frame], get_statistics_pool());
+        }
+
+        command_buffer.next_subpass(); // reads the downsampled depth.
+
+        if (imgui.raymarcher_enabled(farthest_level_of_detail)) {
+            vk::DebugMarker::begin(command_buffer, "Raymarch Strands", query_pools[frame], get_statistics_pool());
+            set_hair_viewport(command_buffer);
+            strand_dvr(scene_graph, strand_dvr_pipeline, hair_target.get_depth_view(), command_buffer);
+            vk::DebugMarker::close(command_buffer, "Raymarch Strands", query_pools[frame], get_statistics_pool());
+        }
+
+        command_buffer.end_render_pass();
+    }
+
+    VkExtent2D Rasterizer::get_hair_extent() const {
+        return scaled_hair_enabled() ? hair_target.get_extent() : get_color_extent();
+    }
+
+    void Rasterizer::set_hair_viewport(vk::CommandBuffer& command_buffer) {
+        VkRect2D scissor { { 0, 0 }, get_hair_extent() };
+        VkViewport viewport {
+            0.0f, 0.0f,
+            static_cast<float>(scissor.extent.width),
+            static_cast<float>(scissor.extent.height),
+            0.0f, 1.0f
+        };
+
+        command_buffer.set_viewport(viewport);
+        command_buffer.set_scissor(scissor);
+
+        set_hair_shading_rate(command_buffer);
+    }
+
+    bool Rasterizer::shading_rate_pipelines() const {
+        return shading_rate_images && !stereo_rendering;
+    }
+
+    bool Rasterizer::variable_rate_shading_enabled() const {
+        return shading_rate_pipelines() && imgui.parameters.variable_rate_shading;
+    }
+
+    // The shading rate image isn't inherited by the secondaries either, so it's bound with the viewport.
+    void Rasterizer::set_hair_shading_rate(vk::CommandBuffer& command_buffer) {
+#ifdef VK_NV_shading_rate_image
+        if (!shading_rate_pipelines())
+            return;
+        if (variable_rate_shading_enabled())
+            shading_rate_image.bind(command_buffer);
+        else command_buffer.unbind_shading_rate_image();
+#endif
+    }
+
+    void Rasterizer::cull_strands(const SceneGraph& scene_graph, std::uint32_t view, const glm::mat4& view_projection,
+                                  float occlusion_threshold, vk::CommandBuffer& command_buffer, bool model_occlusion) {
+        auto model_depth_levels = model_occlusion ? model_depth_pyramid.get_mip_levels() : 0;
+
+        // The culled indices are per style, so styles shared between nodes are drawn in full.
+        std::unordered_map<const HairStyle*, std::size_t> style_instances;
+        for (auto& hair_node : scene_graph.get_nodes_with_hair_styles())
+            for (auto& hair_style : hair_node->get_hair_styles())
+                ++style_instances[hair_style];
+
+        for (auto& hair_node : scene_graph.get_nodes_with_hair_styles()) {
+            glm::mat4 model = hair_node->get_model_matrix();
+            glm::vec3 eye = glm::inverse(model) * glm::vec4 { scene_graph.get_camera().get_position(), 1.0f };
+
+            for (auto& hair_style : hair_node->get_hair_styles()) {
+                auto& vulkan_hair_style = hair_styles[hair_style];
+
+                // The clusters' bounds are of the rest pose, so the simulated strands can leave them.
+                if (!imgui.parameters.strand_culling || style_instances[hair_style] > 1 || simulation.enabled || strip_topology) {
+                    vulkan_hair_style.disable_culling(view);
+                    continue;
+                }
+
+                vulkan_hair_style.cull(hair_cull_pipeline, view, view_projection * model, eye,
+                                       occlusion_threshold, command_buffer, model_depth_levels);
+            }
+        }
+    }
+
+    bool Rasterizer::model_occlusion_enabled(const SceneGraph& scene_graph) const {
+        return imgui.parameters.strand_culling && !stereo_rendering && !scene_graph.get_nodes_with_models().empty();
+    }
+
+    // The same pipeline as the models' shadow maps, but from the camera that the strands are culled in.
+    void Rasterizer::draw_model_depth(const SceneGraph& scene_graph, const glm::mat4& view_projection, vk::CommandBuffer& command_buffer) {
+        auto& depth_map = model_depth_pyramid.get_depth_map();
+
+        command_buffer.begin_render_pass(depth_pass, depth_map);
+        depth_map.update_dynamic_viewport_scissor_depth(command_buffer);
+        draw_model(scene_graph, mesh_depth_pipeline, command_buffer, view_projection, 0);
+        command_buffer.end_render_pass();
+
+        model_depth_pyramid.build(depth_pyramid_pipeline, frame, command_buffer);
+    }
+
+    void Rasterizer::strand_dvr(const SceneGraph& scene_graph, Pipeline& pipeline, vk::ImageView& depth_view, vk::CommandBuffer& command_buffer) {
+        pipeline.descriptor_sets[frame].write(9, depth_view); // of either the color pass or the hair pass.
+        command_buffer.bind_pipeline(pipeline);
+        const auto& hair_nodes = scene_graph.get_nodes_with_hair_styles();
+        for (std::size_t node { 0 }; node < hair_nodes.size(); ++node) {
+            const auto& node_lod = hair_node_lods[node];
+            if (!node_lod.on_screen || node_lod.impostor || !imgui.raymarcher_enabled(node_lod.level_of_detail))
+                continue; // only rasterized.
+            command_buffer.push_constant(pipeline, 0, vulkan::Volume::Object { hair_nodes[node]->get_model_matrix(), node_lod.level_of_detail });
+            for (auto& hair_style : hair_nodes[node]->get_hair_styles()) {
+                if (hair_styles[hair_style].raymarch_scale == 1)
+                    hair_styles[hair_style].draw_volume(pipeline, pipeline.descriptor_sets[frame], command_buffer);
+            }
+        }
+    }
+
+    void Rasterizer::draw_opaque_depth(const SceneGraph& scene_graph, Pipeline& pipeline, vk::CommandBuffer& command_buffer,
+                                       std::size_t first_node, std::size_t node_count) {
+        command_buffer.bind_pipeline(pipeline);
+        const auto& hair_nodes = scene_graph.get_nodes_with_hair_styles();
+        auto last_node = first_node + std::min(node_count, hair_nodes.size() - std::min(first_node, hair_nodes.size()));
+        for (std::size_t node { first_node }; node < last_node; ++node) {
+            const auto& node_lod = hair_node_lods[node];
+            if (!node_lod.on_screen || node_lod.impostor || !imgui.rasterizer_enabled(node_lod.level_of_detail))
+                continue; // no strands to reject.
+            command_buffer.push_constant(pipeline, 0, vulkan::Volume::Object { hair_nodes[node]->get_model_matrix(), node_lod.level_of_detail });
+            for (auto& hair_style : hair_nodes[node]->get_hair_styles()) // at, since it may be called from many threads.
+                hair_styles.at(hair_style).draw_volume(pipeline, pipeline.descriptor_sets[frame], command_buffer);
+        }
+    }
+
+    bool Rasterizer::opaque_depth_enabled() const {
+        return imgui.parameters.opaque_depth && imgui.parameters.transparency == 0 &&
+               !stereo_rendering && !scaled_hair_enabled();
+    }
+
+    void Rasterizer::scaled_strand_dvr(const SceneGraph& scene_graph, Pipeline& pipeline, vk::CommandBuffer& command_buffer) {
+        for (auto& volume_target : volume_targets) {
+            // Cleared even if no style uses it, since it's always upsampled.
+            command_buffer.begin_render_pass(scaled_volume_pass, volume_target.get_framebuffer(),
+                                             { 0.00f, 0.00f, 0.00f, 0.00f });
+            command_buffer.bind_pipeline(pipeline);
+            volume_target.update_dynamic_viewport_scissor_depth(command_buffer);
+
+            const auto& hair_nodes = scene_graph.get_nodes_with_hair_styles();
+            for (std::size_t node { 0 }; node < hair_nodes.size(); ++node) {
+                const auto& node_lod = hair_node_lods[node];
+                if (!node_lod.on_screen || node_lod.impostor || !imgui.raymarcher_enabled(node_lod.level_of_detail))
+                    continue;
+                command_buffer.push_constant(pipeline, 0, vulkan::Volume::Object { hair_nodes[node]->get_model_matrix(), node_lod.level_of_detail });
+                for (auto& hair_style : hair_nodes[node]->get_hair_styles()) {
+                    if (hair_styles[hair_style].raymarch_scale == volume_target.get_scale())
+                        hair_styles[hair_style].draw_volume(pipeline, pipeline.descriptor_sets[frame], command_buffer);
+                }
+            }
+
+            command_buffer.end_render_pass();
+        }
+    }
+
+    bool Rasterizer::scaled_strand_dvr_enabled() const {
+        return imgui.parameters.scaled_raymarch;
+    }
+
+    void Rasterizer::create_volume_targets() {
+        volume_targets.clear();
+        volume_targets.emplace_back(2, *this);
+        volume_targets.emplace_back(4, *this);
+    }
+
+    void Rasterizer::create_strand_tiles() {
+        VkDeviceSize tile_count = ((swap_chain.get_width()  + vulkan::HairStyle::TileSize - 1) / vulkan::HairStyle::TileSize) *
+                                  ((swap_chain.get_height() + vulkan::HairStyle::TileSize - 1) / vulkan::HairStyle::TileSize);
+
+        strand_tile_counts = vk::StorageBuffer { device, tile_count * sizeof(std::uint32_t) };
+        vk::DebugMarker::object_name(device, strand_tile_counts, VK_OBJECT_TYPE_BUFFER, "Strand Tile Count Buffer");
+        strand_tile_segments = vk::StorageBuffer { device, tile_count * vulkan::HairStyle::TileSegments * sizeof(std::uint32_t) };
+        vk::DebugMarker::object_name(device, strand_tile_segments, VK_OBJECT_TYPE_BUFFER, "Strand Tile Segment Buffer");
+    }
+
+    void Rasterizer::create_volume_history() {
+        volume_history_views.clear();
+        volume_history.clear();
+        volume_history_memory.clear();
+
+        auto command_buffer = command_pool.allocate_and_begin();
+
+        for (std::size_t i { 0 }; i < frames_in_flight; ++i) {
+            volume_history.emplace_back(device,
+                                        swap_chain.get_width(),
+                                        swap_chain.get_height(),
+                                        VK_FORMAT_R32G32B32A32_SFLOAT,
+                                        VK_IMAGE_USAGE_STORAGE_BIT |
+                                        VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+
+            vk::DebugMarker::object_name(device, volume_history[i], VK_OBJECT_TYPE_IMAGE, "Volume History Image", i);
 
-        command_buffers = command_pool.allocate(framebuffers.size());
-    }
+            volume_history_memory.emplace_back(device,
+                                               volume_history[i].get_memory_requirements(),
+                                               vk::DeviceMemory::Type::DeviceLocal);
 
-    void Rasterizer::load(const SceneGraph& scene_graph) {
-        device.wait_idle();
+            volume_history[i].bind(volume_history_memory[i]);
 
-        hair_styles.clear();
-        models.clear();
-        shadow_maps.clear();
+            vk::DebugMarker::object_name(device, volume_history_memory[i], VK_OBJECT_TYPE_DEVICE_MEMORY, "Volume History Device Memory", i);
 
-        for (const auto& model : scene_graph.get_models())
-            models[&model.second] = vulkan::Model {
-                model.second, *this
-            };
+            volume_history_views.emplace_back(device, volume_history[i], VK_IMAGE_LAYOUT_GENERAL);
 
-        for (const auto& hair_style : scene_graph.get_hair_styles())
-            hair_styles[&hair_style.second] = vulkan::HairStyle {
-                hair_style.second, *this
-            };
+            vk::DebugMarker::object_name(device, volume_history_views[i], VK_OBJECT_TYPE_IMAGE_VIEW, "Volume History Image View", i);
 
-        lights = vk::UniformBuffer::create(device, scene_graph.get_light_sources().size() * sizeof(LightSource::Buffer),
-                                           swap_chain.size(), "Light Source Buffer Data"); // e.g.: position, intensity.
+            volume_history[i].transition(command_buffer, 0, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                         VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+            command_buffer.clear_color_image(volume_history[i], { { 0.0f, 0.0f, 0.0f, 1.0f } });
+            volume_history[i].transition(command_buffer, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                                         VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+                                         VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        }
 
-        for (auto& light_source : scene_graph.get_light_sources())
-            shadow_maps.emplace_back(1024, *this, light_source);
+        command_buffer.end();
+        device.get_graphics_queue().submit(command_buffer)
+                                   .wait_idle();
+    }
 
-        build_pipelines();
+    void Rasterizer::prepare_volume_history(vk::CommandBuffer& command_buffer) {
+        auto& current_history = volume_history[frame];
+
+        // Depth of 1 means there's nothing to reproject to here.
+        current_history.transition(command_buffer, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                   VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+                                   VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+        command_buffer.clear_color_image(current_history, { { 0.0f, 0.0f, 0.0f, 1.0f } });
+        current_history.transition(command_buffer, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                                   VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+                                   VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+        // Written by the previous frame's raymarch, which was submitted before this.
+        volume_history[latest_drawn_frame].transition(command_buffer, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                                                      VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+                                                      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
     }
 
-    void Rasterizer::update(const SceneGraph& scene_graph) {
-        camera[frame].update(scene_graph.get_camera().get_transform());
-        lights[frame].update(scene_graph.fetch_light_source_buffers());
-        level_of_detail = glm::smoothstep(imgui.parameters.lod_magnified_distance,
-                                          imgui.parameters.lod_minified_distance,
-                                          scene_graph.get_camera().get_distance());
-        params[frame].update(imgui.parameters); // Rendering parameter.
+    void Rasterizer::draw(Image& fullscreen_image) {
+        draw(fullscreen_image, {}, 0); // all of it.
     }
 
-    void Rasterizer::draw(const SceneGraph& scene_graph) {
-        command_buffer_finished[frame].wait_and_reset();
+    void Rasterizer::draw(Image& fullscreen_image, const std::vector<glm::uvec2>& updated_tiles, std::uint32_t tile_size) {
+        wait_for_frame();
         imgui.record_performance(query_pools[frame].request_timestamp_queries());
-        update(scene_graph); // updates descriptor sets.
+        if (TraceRecorder::is_recording())
+            record_trace(query_pools[frame]);
+        rebuild_recompiled_pipelines();
 
-        auto frame_image = swap_chain.acquire_next_image(image_available[frame]);
+        frame_image = swap_chain.acquire_next_image(image_available[frame]);
 
         if (swap_chain.out_of_date()) {
             swapchain_dirty = true;
             return;
         }
 
+        bool capturing_screenshot { !screenshot_requests.empty() };
+        bool gui_visibility { capturing_screenshot ? imgui.hide() : false };
+
         command_buffers[frame].begin();
 
         command_buffers[frame].reset_query_pool(query_pools[frame], 0, // performance.
                                                 query_pools[frame].get_query_count());
 
-        vk::DebugMarker::begin(command_buffers[frame], "Total Frame Time", query_pools[frame]);
+        vk::DebugMarker::begin(command_buffers[frame], "Stream Framebuffer Tiles", query_pools[frame]);
+        fullscreen_billboard.stream_tiles(fullscreen_image, updated_tiles, tile_size, frame, command_buffers[frame]);
+        vk::DebugMarker::close(command_buffers[frame], "Stream Framebuffer Tiles", query_pools[frame]);
 
-        draw_depth(scene_graph, command_buffers[frame]);
+        vk::DebugMarker::begin(command_buffers[frame], "Blit Framebuffer", query_pools[frame]);
+        command_buffers[frame].begin_render_pass(imgui_pass, framebuffers[frame_image],
+                                                 { 1.00f, 1.00f, 1.00f, 1.00f });
 
-        voxelize(scene_graph, command_buffers[frame]);
+        command_buffers[frame].bind_pipeline(billboards_pipeline);
+        frame_constants[frame].update(camera[frame], Camera::IdentityVPMatrix);
+        command_buffers[frame].push_constant(billboards_pipeline, 0, Identity);
+        fullscreen_billboard.draw(billboards_pipeline, billboards_pipeline.descriptor_sets[frame],
+                                  command_buffers[frame]);
 
-        draw_color(scene_graph, command_buffers[frame]);
+        imgui.draw(command_buffers[frame]);
 
-        vk::DebugMarker::close(command_buffers[frame], "Total Frame Time", query_pools[frame]);
+        command_buffers[frame].next_subpass(); // Just an empty subpass to make them compatible...
+
+        command_buffers[frame].end_render_pass();
+        vk::DebugMarker::close(command_buffers[frame], "Blit Framebuffer", query_pools[frame]);
+
+        if (capturing_screenshot) {
+            read_back_screenshot(command_buffers[frame]);
+            imgui.set_visibility(gui_visibility);
+        }
 
         command_buffers[frame].end();
 
-        device.get_graphics_queue().submit(command_buffers[frame], image_available[frame],
-                                           VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                                           render_complete[frame], command_buffer_finished[frame]);
-        device.get_present_queue().present(swap_chain, frame_image, render_complete[frame]);
+        submit_frame({ &image_available[frame] },
+                     { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT },
+                     { &render_complete[frame_image] });
+        present_frame();
 
         if (swap_chain.out_of_date())
             swapchain_dirty = true;
 
         latest_drawn_frame = frame;
+        latest_drawn_image = frame_image;
         frame = fetch_next_frame();
     }
 
-    std::uint32_t Rasterizer::fetch_next_frame() {
-        return (frame + 1) % swap_chain.size();
-    }
+    void Rasterizer::draw(const SceneGraph& scene_graph, const Raytracer& raytracer) {
+#ifdef VK_KHR_ray_query
+        wait_for_frame();
+        imgui.record_performance(query_pools[frame].request_timestamp_queries());
+        if (TraceRecorder::is_recording())
+            record_trace(query_pools[frame]);
+        rebuild_recompiled_pipelines();
 
-    void Rasterizer::voxelize(const SceneGraph& scene_graph, vk::CommandBuffer& command_buffer) {
-        vk::DebugMarker::begin(command_buffers[frame], "Voxelize Strands", query_pools[frame]);
+        update(scene_graph); // for the camera and lights.
 
-        command_buffer.bind_pipeline(hair_voxel_pipeline);
+        frame_image = swap_chain.acquire_next_image(image_available[frame]);
 
-        for (auto& hair_node : scene_graph.get_nodes_with_hair_styles()) {
-            for (auto& hair : hair_node->get_hair_styles()) {
-                hair_styles[hair].voxelize(hair_voxel_pipeline,
-                                           hair_voxel_pipeline.descriptor_sets[frame],
-                                           command_buffer);
-            }
+        if (swap_chain.out_of_date()) {
+            swapchain_dirty = true;
+            return;
         }
 
-        vk::DebugMarker::close(command_buffers[frame], "Voxelize Strands", query_pools[frame]);
-    }
-
-    void Rasterizer::draw_color(const SceneGraph& scene_graph, vk::CommandBuffer& command_buffer) {
-        vk::DebugMarker::begin(command_buffers[frame], "Color Pass");
+        if (!gpu_raytracer.is_built())
+            gpu_raytracer = vulkan::Raytracer { *this, scene_graph };
 
-        vk::DebugMarker::begin(command_buffers[frame], "Clear PPLL Nodes", query_pools[frame]);
-        ppll.clear(command_buffers[frame]);
-        vk::DebugMarker::close(command_buffers[frame], "Clear PPLL Nodes", query_pools[frame]);
+        // The samples are accumulated until any of these change, like the CPU raytracer's now_dirty.
+        std::size_t state { 14695981039346656037ull };
 
-        command_buffers[frame].begin_render_pass(color_pass, framebuffers[frame],
-                                                 { 1.00f, 1.00f, 1.00f, 1.00f });
+        const auto& view = scene_graph.get_camera().get_view_matrix();
+        const auto& projection = scene_graph.get_camera().get_projection_matrix();
+        state = hash_bytes(state, &view, sizeof(view));
+        state = hash_bytes(state, &projection, sizeof(projection));
 
-        vk::DebugMarker::begin(command_buffers[frame], "Draw Mesh Models", query_pools[frame]);
-        draw_model(scene_graph, model_mesh_pipeline, command_buffers[frame]);
-        vk::DebugMarker::close(command_buffers[frame], "Draw Mesh Models", query_pools[frame]);
+        auto light_revision = scene_graph.get_light_source_revision();
+        state = hash_bytes(state, &light_revision, sizeof(light_revision));
 
-        if (imgui.rasterizer_enabled(level_of_detail)) {
-            vk::DebugMarker::begin(command_buffers[frame], "Draw Hair Styles", query_pools[frame]);
-            draw_hairs(scene_graph, hair_style_pipeline, command_buffers[frame]);
-            vk::DebugMarker::close(command_buffers[frame], "Draw Hair Styles", query_pools[frame]);
+        for (auto node : scene_graph.get_nodes_with_hair_styles()) {
+            const auto& model = node->get_model_matrix();
+            state = hash_bytes(state, &model, sizeof(model));
         }
 
-        command_buffers[frame].next_subpass(); // Next subpass which will read depth buffer values.
+        auto visualization_method = raytracer.get_visualization_method();
+        auto shadows_on = raytracer.shadows_enabled();
+        auto ao_radius = raytracer.get_ao_radius();
+        auto marschner_shading = raytracer.marschner_enabled();
+        auto hair_fiber = imgui.get_hair_fiber();
+        state = hash_bytes(state, &visualization_method, sizeof(visualization_method));
+        state = hash_bytes(state, &shadows_on, sizeof(shadows_on));
+        state = hash_bytes(state, &ao_radius, sizeof(ao_radius));
+        state = hash_bytes(state, &marschner_shading, sizeof(marschner_shading));
+        state = hash_bytes(state, &hair_fiber, sizeof(hair_fiber));
 
-        if (imgui.raymarcher_enabled(level_of_detail)) {
-            vk::DebugMarker::begin(command_buffers[frame], "Raymarch Strands", query_pools[frame]);
-            strand_dvr(scene_graph, strand_dvr_pipeline, command_buffers[frame]);
-            vk::DebugMarker::close(command_buffers[frame], "Raymarch Strands", query_pools[frame]);
-        }
+        bool capturing_screenshot { !screenshot_requests.empty() };
+        bool gui_visibility { capturing_screenshot ? imgui.hide() : false };
 
-        command_buffers[frame].end_render_pass();
+        command_buffers[frame].begin();
 
-        vk::DebugMarker::begin(command_buffers[frame], "Resolve the PPLL", query_pools[frame]);
-        ppll.resolve(swap_chain,
-                     frame,
-                     ppll_blend_pipeline,
-                     command_buffers[frame]);
-        vk::DebugMarker::close(command_buffers[frame], "Resolve the PPLL", query_pools[frame]);
+        command_buffers[frame].reset_query_pool(query_pools[frame], 0, // performance.
+                                                query_pools[frame].get_query_count());
 
-        vk::DebugMarker::close(command_buffers[frame]);
+        bake_scattering_lut(command_buffers[frame]);
 
-        vk::DebugMarker::begin(command_buffers[frame], "ImGui Pass");
+        vulkan::RenderGraph render_graph;
 
-        command_buffers[frame].begin_render_pass(imgui_pass, framebuffers[frame],
-                                                 { 1.00f, 1.00f, 1.00f, 1.00f });
-        vk::DebugMarker::begin(command_buffers[frame], "Draw GUI Overlay", query_pools[frame]);
-        imgui.draw(command_buffers[frame]);
-        vk::DebugMarker::close(command_buffers[frame], "Draw GUI Overlay", query_pools[frame]);
-        command_buffers[frame].next_subpass(); // Empty subpass just to make them compatible...
-        command_buffers[frame].end_render_pass();
+        // It has only been acquired, so it doesn't matter what was in it.
+        auto color_image = render_graph.import_image(swap_chain.get_images()[frame_image],
+                                                     { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0 });
 
-        vk::DebugMarker::close(command_buffers[frame]);
-    }
+        render_graph.add_pass({ { color_image, { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                                 VK_ACCESS_SHADER_WRITE_BIT,
+                                                 VK_IMAGE_LAYOUT_GENERAL }, true } },
+                              [&](vk::CommandBuffer& pass_commands) {
+            vk::DebugMarker::begin(pass_commands, "Trace Ray Queries", query_pools[frame]);
+            gpu_raytracer.trace(scene_graph, raytracer, state,
+                                ray_tracing_pipeline, frame,
+                                swap_chain.get_general_image_views()[frame_image],
+                                pass_commands);
+            vk::DebugMarker::close(pass_commands, "Trace Ray Queries", query_pools[frame]);
+        });
 
-    void Rasterizer::draw_model(const SceneGraph& scene_graph, Pipeline& pipeline, vk::CommandBuffer& command_buffer, glm::mat4 projection) {
-        command_buffer.bind_pipeline(pipeline); // Color / Depth Pass.
-        for (auto& model_node : scene_graph.get_nodes_with_models()) {
-            command_buffer.push_constant(pipeline, 0, projection * model_node->get_model_matrix());
-            for (auto& model_mesh : model_node->get_models())
-                models[model_mesh].draw(pipeline, pipeline.descriptor_sets[frame], command_buffer);
-        }
-    }
+        render_graph.release(color_image, { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                            VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                                            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
 
-    void Rasterizer::draw_depth(const SceneGraph& scene_graph, vk::CommandBuffer& command_buffer) {
-        if (!imgui.rasterizer_enabled(level_of_detail) &&
-             imgui.raymarcher_enabled(level_of_detail)) {
-            return; // no need to bake shadow for volume.
-        }
+        render_graph.execute(command_buffers[frame]);
 
-        vk::DebugMarker::begin(command_buffers[frame], "Depth Pass");
+        draw_overlay(command_buffers[frame]);
 
-        vk::DebugMarker::begin(command_buffers[frame], "Bake Shadow Maps", query_pools[frame]);
-        for (auto& shadow_map : shadow_maps) {
-            auto& vp = shadow_map.light->get_view_projection();
-            command_buffer.begin_render_pass(depth_pass, shadow_map);
-            shadow_map.update_dynamic_viewport_scissor_depth(command_buffer);
+        if (capturing_screenshot) {
+            read_back_screenshot(command_buffers[frame]);
+            imgui.set_visibility(gui_visibility);
+        }
 
-            if (imgui.parameters.adsm_on) draw_hairs(scene_graph, hair_depth_pipeline, command_buffer, vp);
-            if (imgui.parameters.ctsm_on) draw_model(scene_graph, mesh_depth_pipeline, command_buffer, vp);
+        command_buffers[frame].end();
 
-            command_buffer.end_render_pass();
-        }
-        vk::DebugMarker::close(command_buffers[frame], "Bake Shadow Maps", query_pools[frame]);
+        submit_frame({ &image_available[frame] },
+                     { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT },
+                     { &render_complete[frame_image] });
+        present_frame();
 
-        vk::DebugMarker::close(command_buffers[frame]);
+        if (swap_chain.out_of_date())
+            swapchain_dirty = true;
+
+        latest_drawn_frame = frame;
+        latest_drawn_image = frame_image;
+        frame = fetch_next_frame();
+#endif
     }
 
-    void Rasterizer::draw_hairs(const SceneGraph& scene_graph, Pipeline& pipeline, vk::CommandBuffer& command_buffer, glm::mat4 projection) {
-        command_buffer.bind_pipeline(pipeline); // Color / Depth / Voxels.
-        for (auto& hair_node : scene_graph.get_nodes_with_hair_styles()) {
-            command_buffer.push_constant(pipeline, 0, projection * hair_node->get_model_matrix());
-            for (auto& hair_style : hair_node->get_hair_styles())
-                hair_styles[hair_style].draw(pipeline, pipeline.descriptor_sets[frame], command_buffer);
-        }
+    void Rasterizer::bake_scattering_lut(vk::CommandBuffer& command_buffer) {
+        auto hair_fiber = imgui.get_hair_fiber();
+        if (!scattering_lut.needs_baking(hair_fiber))
+            return;
+
+        vk::DebugMarker::begin(command_buffer, "Bake Scattering LUT", query_pools[frame]);
+        scattering_lut.bake(scattering_lut_pipeline, hair_fiber, command_buffer);
+        vk::DebugMarker::close(command_buffer, "Bake Scattering LUT", query_pools[frame]);
     }
 
-    void Rasterizer::strand_dvr(const SceneGraph& scene_graph, Pipeline& pipeline, vk::CommandBuffer& command_buffer) {
-        command_buffer.bind_pipeline(pipeline);
-        for (auto& hair_node : scene_graph.get_nodes_with_hair_styles()) {
-            command_buffer.push_constant(pipeline, 0, hair_node->get_model_matrix());
-            for (auto& hair_style : hair_node->get_hair_styles())
-                hair_styles[hair_style].draw_volume(pipeline, pipeline.descriptor_sets[frame], command_buffer);
-        }
+    bool Rasterizer::gpu_raytracing_enabled() const {
+        return ray_queries && !stereo_rendering && imgui.parameters.gpu_raytracing;
     }
 
-    void Rasterizer::draw(Image& fullscreen_image) {
-        command_buffer_finished[frame].wait_and_reset();
-        imgui.record_performance(query_pools[frame].request_timestamp_queries());
+    void Rasterizer::resize_ppll(std::size_t node_count, bool deferred_shading, bool packed_nodes) {
+        if (node_count == ppll.get_node_count() && deferred_shading == ppll.is_deferred() &&
+            (deferred_shading && packed_nodes) == ppll.is_packed())
+            return;
 
-        auto frame_image = swap_chain.acquire_next_image(image_available[frame]);
+        device.wait_idle(); // The nodes might still be in use.
 
-        if (swap_chain.out_of_date()) {
-            swapchain_dirty = true;
-            return;
-        }
+        ppll = vulkan::LinkedList {
+            *this,
+            swap_chain.get_width(), swap_chain.get_height(),
+            vulkan::LinkedList::NodeSize,
+            node_count,
+            deferred_shading,
+            packed_nodes
+        };
 
-        command_buffers[frame].begin();
+        build_pipelines(); // for the descriptor sets with the PPLL.
+    }
 
-        command_buffers[frame].reset_query_pool(query_pools[frame], 0, // performance.
-                                                query_pools[frame].get_query_count());
+    void Rasterizer::set_strip_topology(bool line_strips) {
+        if (line_strips == strip_topology)
+            return;
 
-        fullscreen_billboard.send_img(billboards_pipeline.descriptor_sets[frame],
-                                      fullscreen_image, command_buffers[frame]);
+        device.wait_idle(); // The pipelines might still be in use.
 
-        vk::DebugMarker::begin(command_buffers[frame], "Blit Framebuffer", query_pools[frame]);
-        command_buffers[frame].begin_render_pass(imgui_pass, framebuffers[frame],
-                                                 { 1.00f, 1.00f, 1.00f, 1.00f });
+        strip_topology = line_strips;
 
-        command_buffers[frame].bind_pipeline(billboards_pipeline);
-        camera[frame].update(Camera::IdentityVPMatrix);
-        command_buffers[frame].push_constant(billboards_pipeline, 0, Identity);
-        fullscreen_billboard.draw(billboards_pipeline, billboards_pipeline.descriptor_sets[frame],
-                                  command_buffers[frame]);
+        build_pipelines();
+    }
 
-        imgui.draw(command_buffers[frame]);
+    void Rasterizer::specialize_shaders() {
+        ShaderParameters parameters { };
+
+        if (imgui.parameters.specialized_shaders) {
+            parameters = {
+                VK_TRUE,
+                imgui.parameters.shading_model,
+                imgui.parameters.adsm_kernel_size,
+                imgui.parameters.adsm_sampling_type,
+                imgui.parameters.adsm_stride_size,
+                imgui.parameters.adsm_on,
+                imgui.parameters.adsm_prefiltered,
+                imgui.parameters.ctsm_kernel_size,
+                imgui.parameters.ctsm_sampling_type,
+                imgui.parameters.ctsm_on,
+                imgui.parameters.shadow_technique
+            };
+        }
 
-        command_buffers[frame].next_subpass(); // Just an empty subpass to make them compatible...
+        if (std::memcmp(&parameters, &shader_parameters, sizeof(ShaderParameters)) == 0)
+            return;
 
-        command_buffers[frame].end_render_pass();
-        vk::DebugMarker::close(command_buffers[frame], "Blit Framebuffer", query_pools[frame]);
+        device.wait_idle(); // The pipelines might still be in use.
 
-        command_buffers[frame].end();
+        shader_parameters = parameters;
 
-        device.get_graphics_queue().submit(command_buffers[frame], image_available[frame],
-                                           VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                                           render_complete[frame], command_buffer_finished[frame]);
-        device.get_present_queue().present(swap_chain, frame_image, render_complete[frame]);
+        build_pipelines();
+    }
 
-        if (swap_chain.out_of_date())
-            swapchain_dirty = true;
+    void Rasterizer::add_shader_parameters(std::vector<VkSpecializationMapEntry>& constants, std::size_t offset) {
+        for (std::uint32_t i { 0 }; i < sizeof(ShaderParameters) / sizeof(std::uint32_t); ++i) {
+            constants.push_back({ ParamsConstantId + i,
+                                  static_cast<std::uint32_t>(offset + i * sizeof(std::uint32_t)),
+                                  sizeof(std::uint32_t) });
+        }
+    }
 
-        latest_drawn_frame = frame;
-        frame = fetch_next_frame();
+    void Rasterizer::build_ppll_resolve_pipeline() {
+        if (ppll.is_deferred())
+            vulkan::LinkedList::build_deferred_pipeline(ppll_blend_pipeline, *this);
+        else
+            vulkan::LinkedList::build_pipeline(ppll_blend_pipeline, *this);
     }
 
     void Rasterizer::build_pipelines() {
+        descriptor_cache.reset(); // the sets they were copied from are gone.
+        ++static_batch_revision; // and so are the pipelines that they've bound.
+
         vulkan::HairStyle::depth_pipeline(hair_depth_pipeline, *this);
+        vulkan::HairBatch::depth_pipeline(hair_batch_depth_pipeline, *this);
+        vulkan::HairStyle::opacity_pipeline(hair_opacity_pipeline, *this);
+        vulkan::FilteredShadowMap::build_pipeline(shadow_filter_pipeline, *this);
+        vulkan::LightTiles::build_pipeline(light_culling_pipeline, *this);
+        vulkan::DepthPyramid::build_pipeline(depth_pyramid_pipeline, *this);
+        vulkan::ScatteringLut::build_pipeline(scattering_lut_pipeline, *this);
         vulkan::Model::depth_pipeline(mesh_depth_pipeline, *this);
+        if (shadow_map_array.get_layer_count() != 0) {
+            vulkan::HairStyle::depth_pipeline(hair_multiview_depth_pipeline, *this, true);
+            vulkan::Model::depth_pipeline(mesh_multiview_depth_pipeline, *this, true);
+        }
         vulkan::HairStyle::voxel_pipeline(hair_voxel_pipeline, *this);
+        vulkan::HairStyle::voxel_resolve_pipeline(hair_voxel_resolve_pipeline, *this);
+        vulkan::HairStyle::volume_mip_pipeline(hair_volume_mip_pipeline, *this);
+        vulkan::HairStyle::transmittance_pipeline(hair_transmittance_pipeline, *this);
+        vulkan::HairStyle::ambient_occlusion_pipeline(hair_ambient_occlusion_pipeline, *this);
+        vulkan::HairStyle::distance_field_pipeline(hair_distance_field_pipeline, *this);
+        vulkan::HairStyle::simulation_pipeline(hair_simulation_pipeline, *this);
+        vulkan::HairStyle::interpolation_pipeline(hair_interpolation_pipeline, *this);
+        vulkan::HairStyle::bounds_pipeline(hair_bounds_pipeline, *this);
+        vulkan::HairStyle::cull_pipeline(hair_cull_pipeline, *this);
+        vulkan::HairStyle::bin_pipeline(hair_bin_pipeline, *this);
+        vulkan::HairStyle::tile_pipeline(hair_tile_pipeline, *this);
+        vulkan::HairStyle::sort_keys_pipeline(hair_sort_keys_pipeline, *this);
+        vulkan::HairStyle::sort_histogram_pipeline(hair_sort_histogram_pipeline, *this);
+        vulkan::HairStyle::sort_scan_pipeline(hair_sort_scan_pipeline, *this);
+        vulkan::HairStyle::sort_scatter_pipeline(hair_sort_scatter_pipeline, *this); // after the cull pipeline's buffers.
         vulkan::Volume::build_pipeline(strand_dvr_pipeline, *this);
-        vulkan::LinkedList::build_pipeline(ppll_blend_pipeline, *this);
+        vulkan::Volume::build_opaque_depth_pipeline(hair_opaque_depth_pipeline, *this);
+        build_ppll_resolve_pipeline();
+        vulkan::WeightedBlended::build_pipeline(wboit_composite_pipeline, *this);
+        vulkan::TemporalAntiAliasing::build_pipeline(taa_resolve_pipeline, *this);
+        vulkan::HairTarget::build_downsample_pipeline(hair_downsample_pipeline, *this);
+        vulkan::HairTarget::build_upscale_pipeline(hair_upscale_pipeline, *this);
+        vulkan::Volume::build_scaled_pipeline(scaled_dvr_pipeline, *this);
+        vulkan::Volume::build_upsample_pipeline(dvr_upsample_pipeline, *this);
         vulkan::HairStyle::build_pipeline(hair_style_pipeline, *this);
+        vulkan::HairStyle::build_pipeline(hair_pulled_lines_pipeline, *this, vulkan::HairStyle::Expansion::PulledLines);
+        vulkan::HairStyle::build_pipeline(hair_pulled_quads_pipeline, *this, vulkan::HairStyle::Expansion::PulledQuads);
+        if (tessellated_curves)
+            vulkan::HairStyle::build_pipeline(hair_curves_pipeline, *this, vulkan::HairStyle::Expansion::TessellatedCurves);
+        vulkan::HairStyle::build_pipeline(hair_wboit_pipeline, *this, vulkan::HairStyle::Expansion::VertexInputs,
+                                          vulkan::HairStyle::Transparency::WeightedBlended);
+        vulkan::HairStyle::build_pipeline(hair_sorted_pipeline, *this, vulkan::HairStyle::Expansion::VertexInputs,
+                                          vulkan::HairStyle::Transparency::DepthSorted);
         vulkan::Model::build_pipeline(model_mesh_pipeline, *this);
         vulkan::Billboard::build_pipeline(billboards_pipeline, *this);
+        vulkan::HairStyle::impostor_pipeline(hair_impostor_pipeline, *this);
+#ifdef VK_KHR_ray_query
+        if (ray_queries)
+            vulkan::Raytracer::build_pipeline(ray_tracing_pipeline, *this);
+#endif
+#ifdef VK_NV_shading_rate_image
+        if (shading_rate_images)
+            vulkan::ShadingRateImage::build_pipeline(shading_rate_pipeline, *this);
+#endif
+
+        pipeline_cache.save();
     }
 
     void Rasterizer::build_render_passes() {
-        vk::RenderPass::create_modified_color_pass(color_pass, device, swap_chain);
+        vk::RenderPass::create_modified_color_pass(color_pass, device, swap_chain, stereo_rendering ? 0b11 : 0); // both eyes.
         vk::RenderPass::create_standard_depth_pass(depth_pass, device);
+        vk::RenderPass::create_opacity_layer_pass(opacity_pass, device);
         vk::RenderPass::create_standard_imgui_pass(imgui_pass, device, swap_chain);
+        vk::RenderPass::create_scaled_volume_pass(scaled_volume_pass, device);
+        vk::RenderPass::create_weighted_blended_pass(weighted_blended_pass, device, swap_chain);
+        vk::RenderPass::create_hair_pass(hair_pass, device, swap_chain);
     }
 
     void Rasterizer::recreate_swapchain(Window& window, SceneGraph& scene_graph) {
@@ -406,57 +3379,96 @@ namespace vkhr {
         framebuffers.clear();
         command_buffers.clear();
 
-        destroy_pipelines();
-        destroy_render_passes();
+        weighted_blended = {}; // it has the old depth buffer.
+        temporal_anti_aliasing = {}; // and this the old size.
+        hair_target = {};
+        model_depth_pyramid = {};
+        stereo_target = {};
+#ifdef VK_KHR_ray_query
+        gpu_raytracer = {}; // and the old size, so it's built again.
+#endif
 
-        // Updates any new surface capabilities (e.g. format/mode).
-        physical_device.query_surface_capabilities(window_surface);
+        destroy_pipelines();
 
-        auto presentation_mode = vk::SwapChain::mode(window.vsync_requested());
+        auto color_format = swap_chain.get_color_attachment_format();
+        auto depth_format = swap_chain.get_depth_attachment_format();
 
         auto& camera = scene_graph.get_camera(); // for FoV update.
 
-        swap_chain = vk::SwapChain {
-            device,
-            window_surface,
-            command_pool,
-            {
-                VK_FORMAT_B8G8R8A8_UNORM,
-                VK_COLOR_SPACE_SRGB_NONLINEAR_KHR
-            },
-            presentation_mode, window.get_extent(),
-            swap_chain.get_handle()
-        };
-
-        camera.set_resolution(window.get_width(), window.get_height());
-
-        build_render_passes();
-        build_pipelines();
+        if (swap_chain.is_offscreen()) {
+            auto format = swap_chain.get_surface_format();
+            swap_chain = vk::SwapChain {}; // before the new images are allocated.
+            swap_chain = vk::SwapChain {
+                device,
+                command_pool,
+                format,
+                window.get_extent(),
+                frames_in_flight
+            };
+        } else {
+            // Updates any new surface capabilities (e.g. format/mode).
+            physical_device.query_surface_capabilities(window_surface);
+
+            auto presentation_mode = vk::SwapChain::mode(window.vsync_requested());
+
+            swap_chain = vk::SwapChain {
+                device,
+                window_surface,
+                command_pool,
+                {
+                    VK_FORMAT_B8G8R8A8_UNORM,
+                    VK_COLOR_SPACE_SRGB_NONLINEAR_KHR
+                },
+                presentation_mode, window.get_extent(),
+                swap_chain.get_handle()
+            };
+        }
 
-        ppll = vulkan::LinkedList {
-            *this,
-            swap_chain.get_width(), swap_chain.get_height(),
-            vulkan::LinkedList::NodeSize,
-            vulkan::LinkedList::AverageFragmentsPerPixel * swap_chain.get_width() *
-                                                           swap_chain.get_height()
-        };
+        camera.set_resolution(get_color_extent().width, get_color_extent().height);
 
-        // Update PPLL descriptor sets for the strand-based hair renderer.
-        for (auto& descriptor_set : hair_style_pipeline.descriptor_sets) {
-            descriptor_set.write(5, ppll.get_heads_view());
-            descriptor_set.write(6, ppll.get_nodes());
-            descriptor_set.write(7, ppll.get_parameters());
-            descriptor_set.write(8, ppll.get_node_counter());
+        // They only depend on the formats, and not on the size, so they're usually kept.
+        if (color_format != swap_chain.get_color_attachment_format() ||
+            depth_format != swap_chain.get_depth_attachment_format()) {
+            destroy_render_passes();
+            build_render_passes();
         }
 
-        // Also update these descriptor sets for the volume-based drawing.
-        for (auto& descriptor_set : strand_dvr_pipeline.descriptor_sets) {
-            descriptor_set.write(5, ppll.get_heads_view());
-            descriptor_set.write(6, ppll.get_nodes());
-            descriptor_set.write(7, ppll.get_parameters());
-            descriptor_set.write(8, ppll.get_node_counter());
+        if (stereo_rendering)
+            stereo_target = vulkan::StereoTarget { *this };
+        weighted_blended = vulkan::WeightedBlended { *this };
+        temporal_anti_aliasing = vulkan::TemporalAntiAliasing { *this };
+        hair_target = vulkan::HairTarget { *this };
+#ifdef VK_NV_shading_rate_image
+        if (shading_rate_images)
+            shading_rate_image = vulkan::ShadingRateImage { *this };
+#endif
+        create_volume_targets();
+        create_volume_history();
+        create_strand_tiles();
+
+        light_tiles = vulkan::LightTiles { *this, get_color_extent().width, get_color_extent().height,
+                                           stereo_rendering ? vulkan::StereoTarget::Eyes : 1 };
+
+        model_depth_pyramid = vulkan::DepthPyramid { *this, get_color_extent().width, get_color_extent().height };
+
+        // Before the pipelines, so their descriptor sets are written with the new PPLL. It's kept
+        // with its nodes while the swapchain fits into its heads, which is what most resizes do.
+        if (ppll.fits(swap_chain.get_width(), swap_chain.get_height())) {
+            ppll.update_resolution(swap_chain.get_width(), swap_chain.get_height());
+        } else {
+            ppll = vulkan::LinkedList {
+                *this,
+                swap_chain.get_width(), swap_chain.get_height(),
+                vulkan::LinkedList::NodeSize,
+                vulkan::LinkedList::AverageFragmentsPerPixel * swap_chain.get_width() *
+                                                               swap_chain.get_height(),
+                static_cast<bool>(imgui.parameters.deferred_shading),
+                static_cast<bool>(imgui.parameters.packed_ppll)
+            };
         }
 
+        build_pipelines();
+
         fullscreen_billboard = vulkan::Billboard {
             swap_chain.get_width(),
             swap_chain.get_height(),
@@ -464,13 +3476,55 @@ namespace vkhr {
         };
 
         framebuffers    = swap_chain.create_framebuffers(color_pass);
-        command_buffers = command_pool.allocate(framebuffers.size());
+        command_buffers = command_pool.allocate(frames_in_flight);
+
+        // The new swapchain might not have as many images as before.
+        render_complete = vk::Semaphore::create(device, swap_chain.size(), "Render Complete Semaphore");
     }
 
     Interface& Rasterizer::get_imgui() {
         return imgui;
     }
 
+    bool Rasterizer::redraw_needed(const SceneGraph& scene_graph) {
+        const auto& scene_camera = scene_graph.get_camera();
+
+        // The parameters are only ints and floats (see params.glsl), so there's no padding in them.
+        bool changed = scene_camera.get_view_matrix() != drawn_state.view_matrix ||
+                       scene_camera.get_projection_matrix() != drawn_state.projection_matrix ||
+                       scene_graph.get_light_source_revision() != drawn_state.light_source_revision ||
+                       scene_graph.get_node_revision() != drawn_state.node_revision ||
+                       std::memcmp(&imgui.parameters, &drawn_state.parameters, sizeof(imgui.parameters)) != 0;
+
+        if (changed) {
+            drawn_state.view_matrix = scene_camera.get_view_matrix();
+            drawn_state.projection_matrix = scene_camera.get_projection_matrix();
+            drawn_state.light_source_revision = scene_graph.get_light_source_revision();
+            drawn_state.node_revision = scene_graph.get_node_revision();
+            drawn_state.parameters = imgui.parameters;
+        }
+
+        bool screenshots_pending = !screenshot_requests.empty() ||
+                                   std::any_of(screenshot_readbacks.begin(), screenshot_readbacks.end(), [](const ScreenshotReadback& readback) {
+                                       return !readback.screenshots_ready.empty();
+                                   });
+
+        if (changed || simulation.enabled || screenshots_pending || imgui.parameters.benchmarking ||
+            fixed_time_step > 0.0f || recompiling() || swapchain_dirty)
+            request_redraw();
+
+        if (settle_frames == 0)
+            return false;
+
+        --settle_frames;
+
+        return true;
+    }
+
+    void Rasterizer::request_redraw() {
+        settle_frames = SettleFrames;
+    }
+
     bool Rasterizer::swapchain_is_dirty() const {
         if (swapchain_dirty) {
             swapchain_dirty = false;
@@ -503,20 +3557,20 @@ namespace vkhr {
         screenshot_image.transition(command_buffer, 0, VK_ACCESS_TRANSFER_WRITE_BIT,
                                     VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                                     VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
-        swap_chain.get_images()[latest_drawn_frame].transition(command_buffer, VK_ACCESS_MEMORY_READ_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+        swap_chain.get_images()[latest_drawn_image].transition(command_buffer, VK_ACCESS_MEMORY_READ_BIT, VK_ACCESS_TRANSFER_READ_BIT,
                                                                VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
                                                                VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
 
-        command_buffer.copy_image(swap_chain.get_images()[latest_drawn_frame], screenshot_image);
+        command_buffer.copy_image(swap_chain.get_images()[latest_drawn_image], screenshot_image);
 
-        swap_chain.get_images()[latest_drawn_frame].transition(command_buffer, VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_MEMORY_READ_BIT,
+        swap_chain.get_images()[latest_drawn_image].transition(command_buffer, VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_MEMORY_READ_BIT,
                                                                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
                                                                VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
         screenshot_image.transition(command_buffer, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_MEMORY_READ_BIT,
                                     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL,
                                     VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
         command_buffer.end();
-        device.get_graphics_queue().submit(command_buffer)
+        device.get_graphics_queue().submit(command_buffer, { }, { }, { }, get_frame_device())
                                    .wait_idle();
 
         vkhr::Image screenshot { swap_chain.get_width(), swap_chain.get_height() };
@@ -543,7 +3597,9 @@ namespace vkhr {
     Image Rasterizer::get_screenshot(const SceneGraph& scene_graph, Raytracer& ray_tracer) {
         bool previous_visibility { imgui.hide() };
 
-        if (imgui.raytracing_enabled())
+        if (imgui.raytracing_enabled() && gpu_raytracing_enabled())
+            draw(scene_graph, ray_tracer);
+        else if (imgui.raytracing_enabled())
             draw(ray_tracer.get_framebuffer());
         else draw(scene_graph);
 
@@ -552,18 +3608,131 @@ namespace vkhr {
     }
 
     void Rasterizer::recompile() {
+        if (recompiling())
+            return;
+
+        auto sources = vk::ShaderModule::get_sources(get_shader_modules());
+
+        shader_compilation = std::async(std::launch::async, [sources]() mutable {
+            vk::ShaderModule::compile(sources); // in parallel, only the ones that changed.
+            return sources;
+        });
+    }
+
+    bool Rasterizer::recompiling() const {
+        return shader_compilation.valid();
+    }
+
+    std::vector<vk::ShaderModule*> Rasterizer::get_shader_modules() {
+        std::vector<vk::ShaderModule*> shader_modules;
+
+        for (auto pipeline : { &hair_depth_pipeline, &hair_batch_depth_pipeline, &hair_opacity_pipeline, &shadow_filter_pipeline, &light_culling_pipeline, &depth_pyramid_pipeline, &scattering_lut_pipeline, &mesh_depth_pipeline,
+                               &hair_multiview_depth_pipeline, &mesh_multiview_depth_pipeline, &hair_voxel_pipeline,
+                               &hair_voxel_resolve_pipeline, &hair_volume_mip_pipeline, &hair_transmittance_pipeline, &hair_ambient_occlusion_pipeline, &hair_distance_field_pipeline,
+                               &hair_simulation_pipeline, &hair_interpolation_pipeline, &hair_bounds_pipeline, &hair_cull_pipeline, &hair_bin_pipeline, &hair_tile_pipeline,
+                               &hair_sort_keys_pipeline, &hair_sort_histogram_pipeline, &hair_sort_scan_pipeline, &hair_sort_scatter_pipeline,
+                               &strand_dvr_pipeline, &hair_opaque_depth_pipeline, &ppll_blend_pipeline, &wboit_composite_pipeline, &taa_resolve_pipeline, &scaled_dvr_pipeline, &dvr_upsample_pipeline,
+                               &hair_downsample_pipeline, &hair_upscale_pipeline,
+                               &hair_style_pipeline, &hair_pulled_lines_pipeline, &hair_pulled_quads_pipeline, &hair_curves_pipeline,
+                               &hair_wboit_pipeline, &hair_sorted_pipeline, &model_mesh_pipeline, &billboards_pipeline, &hair_impostor_pipeline }) {
+            for (auto& shader_module : pipeline->shader_stages)
+                shader_modules.push_back(&shader_module);
+        }
+
+#ifdef VK_KHR_ray_query
+        for (auto& shader_module : ray_tracing_pipeline.shader_stages)
+            shader_modules.push_back(&shader_module);
+#endif
+#ifdef VK_NV_shading_rate_image
+        for (auto& shader_module : shading_rate_pipeline.shader_stages)
+            shader_modules.push_back(&shader_module);
+#endif
+
+        return shader_modules;
+    }
+
+    void Rasterizer::rebuild_recompiled_pipelines() {
+        if (!recompiling() || shader_compilation.wait_for(std::chrono::seconds { 0 }) != std::future_status::ready)
+            return;
+
+        auto shader_modules = get_shader_modules();
+        auto sources = vk::ShaderModule::get_sources(shader_modules);
+        auto compiled_sources = shader_compilation.get();
+
+        // Nothing changed, or the pipelines have been rebuilt with it since (e.g. by build_pipelines).
+        if (sources == compiled_sources)
+            return; // so there's no need to stall.
+
+        vk::ShaderModule::update_sources(shader_modules, compiled_sources);
+
         device.wait_idle(); // If any pipeline is still in use we need to wait until execution is complete to recompile it.
 
+        descriptor_cache.reset(); // since some of the pipelines' sets are re-allocated.
+
+        ++volume_pipeline_revision; // in case it was one of the voxelization's shaders.
+        ++static_batch_revision;
+
         if (recompile_pipeline_shaders(hair_depth_pipeline)) vulkan::HairStyle::depth_pipeline(hair_depth_pipeline, *this);
+        if (recompile_pipeline_shaders(hair_batch_depth_pipeline)) vulkan::HairBatch::depth_pipeline(hair_batch_depth_pipeline, *this);
+        if (recompile_pipeline_shaders(hair_opacity_pipeline)) vulkan::HairStyle::opacity_pipeline(hair_opacity_pipeline, *this);
+        if (recompile_pipeline_shaders(shadow_filter_pipeline)) vulkan::FilteredShadowMap::build_pipeline(shadow_filter_pipeline, *this);
+        if (recompile_pipeline_shaders(light_culling_pipeline)) vulkan::LightTiles::build_pipeline(light_culling_pipeline, *this);
+        if (recompile_pipeline_shaders(depth_pyramid_pipeline)) vulkan::DepthPyramid::build_pipeline(depth_pyramid_pipeline, *this);
+        if (recompile_pipeline_shaders(scattering_lut_pipeline)) vulkan::ScatteringLut::build_pipeline(scattering_lut_pipeline, *this);
         if (recompile_pipeline_shaders(mesh_depth_pipeline)) vulkan::Model::depth_pipeline(mesh_depth_pipeline, *this);
+        if (recompile_pipeline_shaders(hair_multiview_depth_pipeline)) vulkan::HairStyle::depth_pipeline(hair_multiview_depth_pipeline, *this, true);
+        if (recompile_pipeline_shaders(mesh_multiview_depth_pipeline)) vulkan::Model::depth_pipeline(mesh_multiview_depth_pipeline, *this, true);
         if (recompile_pipeline_shaders(hair_voxel_pipeline)) vulkan::HairStyle::voxel_pipeline(hair_voxel_pipeline, *this);
+        if (recompile_pipeline_shaders(hair_voxel_resolve_pipeline)) vulkan::HairStyle::voxel_resolve_pipeline(hair_voxel_resolve_pipeline, *this);
+        if (recompile_pipeline_shaders(hair_volume_mip_pipeline)) vulkan::HairStyle::volume_mip_pipeline(hair_volume_mip_pipeline, *this);
+        if (recompile_pipeline_shaders(hair_transmittance_pipeline)) vulkan::HairStyle::transmittance_pipeline(hair_transmittance_pipeline, *this);
+        if (recompile_pipeline_shaders(hair_ambient_occlusion_pipeline)) vulkan::HairStyle::ambient_occlusion_pipeline(hair_ambient_occlusion_pipeline, *this);
+        if (recompile_pipeline_shaders(hair_distance_field_pipeline)) vulkan::HairStyle::distance_field_pipeline(hair_distance_field_pipeline, *this);
+        if (recompile_pipeline_shaders(hair_simulation_pipeline)) vulkan::HairStyle::simulation_pipeline(hair_simulation_pipeline, *this);
+        if (recompile_pipeline_shaders(hair_interpolation_pipeline)) vulkan::HairStyle::interpolation_pipeline(hair_interpolation_pipeline, *this);
+        if (recompile_pipeline_shaders(hair_bounds_pipeline)) vulkan::HairStyle::bounds_pipeline(hair_bounds_pipeline, *this);
+        if (recompile_pipeline_shaders(hair_cull_pipeline)) vulkan::HairStyle::cull_pipeline(hair_cull_pipeline, *this);
+        if (recompile_pipeline_shaders(hair_bin_pipeline)) vulkan::HairStyle::bin_pipeline(hair_bin_pipeline, *this);
+        if (recompile_pipeline_shaders(hair_tile_pipeline)) vulkan::HairStyle::tile_pipeline(hair_tile_pipeline, *this);
+        if (recompile_pipeline_shaders(hair_sort_keys_pipeline)) vulkan::HairStyle::sort_keys_pipeline(hair_sort_keys_pipeline, *this);
+        if (recompile_pipeline_shaders(hair_sort_histogram_pipeline)) vulkan::HairStyle::sort_histogram_pipeline(hair_sort_histogram_pipeline, *this);
+        if (recompile_pipeline_shaders(hair_sort_scan_pipeline)) vulkan::HairStyle::sort_scan_pipeline(hair_sort_scan_pipeline, *this);
+        if (recompile_pipeline_shaders(hair_sort_scatter_pipeline)) vulkan::HairStyle::sort_scatter_pipeline(hair_sort_scatter_pipeline, *this);
 
         if (recompile_pipeline_shaders(strand_dvr_pipeline)) vulkan::Volume::build_pipeline(strand_dvr_pipeline,     *this);
-        if (recompile_pipeline_shaders(ppll_blend_pipeline)) vulkan::LinkedList::build_pipeline(ppll_blend_pipeline, *this);
+        if (recompile_pipeline_shaders(hair_opaque_depth_pipeline)) vulkan::Volume::build_opaque_depth_pipeline(hair_opaque_depth_pipeline, *this);
+        if (recompile_pipeline_shaders(ppll_blend_pipeline)) build_ppll_resolve_pipeline();
+        if (recompile_pipeline_shaders(wboit_composite_pipeline)) vulkan::WeightedBlended::build_pipeline(wboit_composite_pipeline, *this);
+        if (recompile_pipeline_shaders(taa_resolve_pipeline)) vulkan::TemporalAntiAliasing::build_pipeline(taa_resolve_pipeline, *this);
+        if (recompile_pipeline_shaders(hair_downsample_pipeline)) vulkan::HairTarget::build_downsample_pipeline(hair_downsample_pipeline, *this);
+        if (recompile_pipeline_shaders(hair_upscale_pipeline)) vulkan::HairTarget::build_upscale_pipeline(hair_upscale_pipeline, *this);
+        if (recompile_pipeline_shaders(scaled_dvr_pipeline)) vulkan::Volume::build_scaled_pipeline(scaled_dvr_pipeline, *this);
+        if (recompile_pipeline_shaders(dvr_upsample_pipeline)) vulkan::Volume::build_upsample_pipeline(dvr_upsample_pipeline, *this);
 
         if (recompile_pipeline_shaders(hair_style_pipeline)) vulkan::HairStyle::build_pipeline(hair_style_pipeline, *this);
+        if (recompile_pipeline_shaders(hair_pulled_lines_pipeline))
+            vulkan::HairStyle::build_pipeline(hair_pulled_lines_pipeline, *this, vulkan::HairStyle::Expansion::PulledLines);
+        if (recompile_pipeline_shaders(hair_pulled_quads_pipeline))
+            vulkan::HairStyle::build_pipeline(hair_pulled_quads_pipeline, *this, vulkan::HairStyle::Expansion::PulledQuads);
+        if (tessellated_curves && recompile_pipeline_shaders(hair_curves_pipeline))
+            vulkan::HairStyle::build_pipeline(hair_curves_pipeline, *this, vulkan::HairStyle::Expansion::TessellatedCurves);
+        if (recompile_pipeline_shaders(hair_wboit_pipeline))
+            vulkan::HairStyle::build_pipeline(hair_wboit_pipeline, *this, vulkan::HairStyle::Expansion::VertexInputs,
+                                              vulkan::HairStyle::Transparency::WeightedBlended);
+        if (recompile_pipeline_shaders(hair_sorted_pipeline))
+            vulkan::HairStyle::build_pipeline(hair_sorted_pipeline, *this, vulkan::HairStyle::Expansion::VertexInputs,
+                                              vulkan::HairStyle::Transparency::DepthSorted);
         if (recompile_pipeline_shaders(model_mesh_pipeline)) vulkan::Model::build_pipeline(model_mesh_pipeline, *this);
         if (recompile_pipeline_shaders(billboards_pipeline)) vulkan::Billboard::build_pipeline(billboards_pipeline, *this);
+        if (recompile_pipeline_shaders(hair_impostor_pipeline)) vulkan::HairStyle::impostor_pipeline(hair_impostor_pipeline, *this);
+#ifdef VK_KHR_ray_query
+        if (ray_queries && recompile_pipeline_shaders(ray_tracing_pipeline)) vulkan::Raytracer::build_pipeline(ray_tracing_pipeline, *this);
+#endif
+#ifdef VK_NV_shading_rate_image
+        if (shading_rate_images && recompile_pipeline_shaders(shading_rate_pipeline)) vulkan::ShadingRateImage::build_pipeline(shading_rate_pipeline, *this);
+#endif
+
+        pipeline_cache.save(); // with the new shaders.
     }
 
     bool Rasterizer::recompile_pipeline_shaders(Pipeline& pipeline) {
@@ -574,20 +3743,70 @@ namespace vkhr {
     }
 
     void Rasterizer::destroy_pipelines() { 
+        descriptor_cache.reset();
+        ++static_batch_revision;
+        latest_overlay = nullptr; // e.g. when the ImGui pass is re-created with the swapchain.
+
         hair_depth_pipeline = {};
+        hair_batch_depth_pipeline = {};
+        hair_opacity_pipeline = {};
+        shadow_filter_pipeline = {};
+        light_culling_pipeline = {};
+        depth_pyramid_pipeline = {};
+        scattering_lut_pipeline = {};
         mesh_depth_pipeline = {};
+        hair_multiview_depth_pipeline = {};
+        mesh_multiview_depth_pipeline = {};
         hair_voxel_pipeline = {};
+        hair_voxel_resolve_pipeline = {};
+        hair_volume_mip_pipeline = {};
+        hair_transmittance_pipeline = {};
+        hair_ambient_occlusion_pipeline = {};
+        hair_distance_field_pipeline = {};
+        hair_simulation_pipeline = {};
+        hair_interpolation_pipeline = {};
+        hair_bounds_pipeline = {};
+        hair_cull_pipeline = {};
+        hair_bin_pipeline = {};
+        hair_tile_pipeline = {};
+        hair_sort_keys_pipeline = {};
+        hair_sort_histogram_pipeline = {};
+        hair_sort_scan_pipeline = {};
+        hair_sort_scatter_pipeline = {};
         strand_dvr_pipeline = {};
+        hair_opaque_depth_pipeline = {};
         ppll_blend_pipeline = {};
+        wboit_composite_pipeline = {};
+        taa_resolve_pipeline = {};
+        hair_downsample_pipeline = {};
+        hair_upscale_pipeline = {};
+        scaled_dvr_pipeline = {};
+        dvr_upsample_pipeline = {};
         hair_style_pipeline = {};
+        hair_pulled_lines_pipeline = {};
+        hair_pulled_quads_pipeline = {};
+        hair_curves_pipeline = {};
+        hair_wboit_pipeline = {};
+        hair_sorted_pipeline = {};
         model_mesh_pipeline = {};
         billboards_pipeline = {};
+        hair_impostor_pipeline = {};
+#ifdef VK_KHR_ray_query
+        ray_tracing_pipeline = {};
+#endif
+#ifdef VK_NV_shading_rate_image
+        shading_rate_pipeline = {};
+#endif
     }
 
     void Rasterizer::destroy_render_passes() { 
         depth_pass = {};
+        opacity_pass = {};
         color_pass = {};
         imgui_pass = {};
+        scaled_volume_pass = {};
+        weighted_blended_pass = {};
+        hair_pass = {};
     }
 
     void Rasterizer::append_benchmarks(const std::vector<Benchmark>& benchmarks) {
@@ -600,6 +3819,144 @@ namespace vkhr {
         benchmark_queue.push(benchmark);
     }
 
+    // A benchmark parameter is either a value, a list of them, or a "from", "to" and "steps" sweep (excluding "to").
+    template<typename T>
+    static std::vector<T> parse_benchmark_sweep(const nlohmann::json& parser, const std::string& name, T default_value) {
+        auto parameter = parser.find(name);
+        if (parameter == parser.end())
+            return { default_value };
+
+        if (parameter->is_array())
+            return parameter->get<std::vector<T>>();
+
+        if constexpr (std::is_arithmetic_v<T>) {
+            if (parameter->is_object()) {
+                std::vector<T> sweep;
+                auto from  = parameter->at("from").get<float>(),
+                     to    = parameter->at("to").get<float>();
+                auto steps = parameter->value("steps", 1);
+                for (int step { 0 }; step < steps; ++step)
+                    sweep.push_back(static_cast<T>(from + (to - from) * step / steps));
+                return sweep;
+            }
+        }
+
+        return { parameter->get<T>() };
+    }
+
+    static bool parse_benchmark_renderer(const std::string& name, Renderer::Type& renderer) {
+        if (name == "Rasterizer")      renderer = Renderer::Rasterizer;
+        else if (name == "Raymarcher") renderer = Renderer::Raymarcher;
+        else if (name == "Ray Tracer") renderer = Renderer::Ray_Tracer;
+        else if (name == "Hybrid LoD") renderer = Renderer::Hybrid_LoD;
+        else return false;
+        return true;
+    }
+
+    static bool parse_benchmark_expansion(const std::string& name, vulkan::HairStyle::Expansion& expansion) {
+        if (name == "Vertex Inputs")     expansion = vulkan::HairStyle::Expansion::VertexInputs;
+        else if (name == "Pulled Lines") expansion = vulkan::HairStyle::Expansion::PulledLines;
+        else if (name == "Pulled Quads") expansion = vulkan::HairStyle::Expansion::PulledQuads;
+        else if (name == "Tessellated Curves") expansion = vulkan::HairStyle::Expansion::TessellatedCurves;
+        else return false;
+        return true;
+    }
+
+    static bool parse_benchmark_anti_aliasing(const std::string& name, bool& temporal_anti_aliasing) {
+        if (name == "GPAA")     temporal_anti_aliasing = false;
+        else if (name == "TAA") temporal_anti_aliasing = true;
+        else return false;
+        return true;
+    }
+
+    bool Rasterizer::append_benchmarks(const std::string& suite_file) {
+        std::ifstream file { suite_file };
+
+        if (!file) return false;
+
+        // The scenes are relative to the suite, just like the assets in the scene files.
+        auto suite_path = std::filesystem::path(suite_file).parent_path();
+
+        std::vector<Benchmark> queued_benchmarks;
+
+        try {
+            auto suite = nlohmann::json::parse(file);
+
+            auto benchmarks = suite.find("benchmarks");
+            if (benchmarks == suite.end())
+                return false;
+
+            for (auto& parser : *benchmarks) {
+                Benchmark benchmark;
+
+                benchmark.description = parser.value("description", std::string { "Benchmark Scenario" });
+                benchmark.warmup_frames = parser.value("warmupFrames", suite.value("warmupFrames", benchmark.warmup_frames));
+                benchmark.measured_frames = parser.value("measuredFrames", suite.value("measuredFrames", benchmark.measured_frames));
+                benchmark.pipeline_statistics = parser.value("pipelineStatistics", suite.value("pipelineStatistics", benchmark.pipeline_statistics));
+
+                // Either the keyframes, or a keyframe file (relative to the suite) e.g. from --record-path.
+                if (auto camera_path = parser.find("cameraPath"); camera_path != parser.end()) {
+                    if (camera_path->is_string()) {
+                        auto path_file = (suite_path / camera_path->get<std::string>()).lexically_normal();
+                        if (!benchmark.camera_path.load(path_file.generic_string()))
+                            return false;
+                    } else if (!benchmark.camera_path.parse(*camera_path)) {
+                        return false;
+                    }
+                }
+
+                auto scenes = parse_benchmark_sweep<std::string>(parser, "scenes", "../scenes/ponytail.vkhr");
+                auto renderers = parse_benchmark_sweep<std::string>(parser, "renderers", "Rasterizer");
+                auto expansions = parse_benchmark_sweep<std::string>(parser, "expansions", "Vertex Inputs");
+                auto anti_aliasings = parse_benchmark_sweep<std::string>(parser, "antiAliasing", "GPAA");
+
+                // [width, height] pairs, and zero keeps the distance of the scene's camera.
+                auto resolutions = parse_benchmark_sweep<std::vector<int>>(parser, "resolutions", suite.value("resolution", std::vector<int> { 1280, 720 }));
+                auto distances = parse_benchmark_sweep<float>(parser, "distances", 0.0f);
+                auto strand_ratios = parse_benchmark_sweep<float>(parser, "strandRatios", 1.0f);
+                auto raymarch_steps = parse_benchmark_sweep<int>(parser, "raymarchSteps", 512);
+
+                for (auto& scene : scenes) {
+                    benchmark.scene = (suite_path / scene).lexically_normal().generic_string();
+                    for (auto& renderer : renderers) {
+                        if (!parse_benchmark_renderer(renderer, benchmark.renderer))
+                            return false;
+                        for (auto& expansion : expansions) {
+                            if (!parse_benchmark_expansion(expansion, benchmark.strand_expansion))
+                                return false;
+                            for (auto& anti_aliasing : anti_aliasings) {
+                                if (!parse_benchmark_anti_aliasing(anti_aliasing, benchmark.temporal_anti_aliasing))
+                                    return false;
+                                for (auto& resolution : resolutions) {
+                                    if (resolution.size() != 2)
+                                        return false;
+                                    benchmark.width  = resolution[0];
+                                    benchmark.height = resolution[1];
+                                    for (auto distance : distances) {
+                                        benchmark.viewing_distance = distance;
+                                        for (auto strand_ratio : strand_ratios) {
+                                            benchmark.strand_reduction = strand_ratio;
+                                            for (auto steps : raymarch_steps) {
+                                                benchmark.raymarch_steps = steps;
+                                                queued_benchmarks.push_back(benchmark);
+                                            }
+                                        }
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        } catch (const nlohmann::json::exception&) {
+            return false; // e.g. a syntax error or a string where a number was expected.
+        }
+
+        append_benchmarks(queued_benchmarks);
+
+        return true;
+    }
+
     void Rasterizer::start_benchmark(SceneGraph& scene_graph) {
         if (!imgui.parameters.benchmarking && !benchmark_queue.empty()) {
             time_t current_time = time(0);
@@ -619,6 +3976,7 @@ namespace vkhr {
             set_benchmark_configurations(benchmark_queue.front(), scene_graph);
             benchmark_queue.pop(); // Only runs through it once.
             final_benchmark_csv = ""; // Clean up the final CSV.
+            final_benchmark_json = nlohmann::json::array();
 
             benchmark_counter = 0; // Reset the benchmark count.
             imgui.parameters.benchmarking = true; // let's a go!
@@ -631,18 +3989,43 @@ namespace vkhr {
 
         frames_benchmarked++;
 
-        if (frames_benchmarked > 2*imgui.get_profile_limit()) {
-            Image screenshot { get_screenshot(scene_graph) };
-            std::string benchmark_number { std::to_string(benchmark_counter) };
-            screenshot.save(benchmark_directory + std::to_string(benchmark_counter) + ".png");
+        follow_benchmark_camera_path(loaded_benchmark, scene_graph);
+
+        auto last_measured_frame = loaded_benchmark.warmup_frames + loaded_benchmark.measured_frames;
+
+        if (frames_benchmarked > loaded_benchmark.warmup_frames && frames_benchmarked <= last_measured_frame)
+            record_benchmark_frame();
+
+        // It's read back in the next frame, and then waits in flight, so the measured ones aren't stalled.
+        if (frames_benchmarked == last_measured_frame) {
+            benchmark_captured = false;
+            request_screenshot([this](Image&& screenshot) {
+                benchmark_screenshot = std::move(screenshot);
+                benchmark_captured = true;
+            });
+        }
+
+        if (frames_benchmarked > last_measured_frame && benchmark_captured) {
+            const Image& screenshot { benchmark_screenshot };
             std::string benchmark_parameters { get_benchmark_results(loaded_benchmark, scene_graph, screenshot) };
             std::string benchmark_results { imgui.get_performance(benchmark_parameters) };
             final_benchmark_csv += benchmark_results;
+            final_benchmark_json.push_back(get_benchmark_json(loaded_benchmark, scene_graph, screenshot));
+
+            std::ofstream frame_csv { benchmark_directory + std::to_string(benchmark_counter) + ".csv" };
+            frame_csv << "Frame, Path Time, Frame Interval, CPU Time, GPU Time, Input Latency\n"
+                      << benchmark_frame_csv;
+            benchmark_frame_csv = "";
+
+            image_writer.save(std::move(benchmark_screenshot), benchmark_directory + std::to_string(benchmark_counter) + ".png");
+            benchmark_captured = false;
 
             if (benchmark_queue.empty()) {
                 std::ofstream benchmark_csv { "benchmarks/" + benchmark_start_time + ".csv" };
                 benchmark_csv << get_benchmark_header() << imgui.get_performance_header() << "\n"
                               << final_benchmark_csv;
+                std::ofstream benchmark_json { "benchmarks/" + benchmark_start_time + ".json" };
+                benchmark_json << final_benchmark_json.dump(4) << "\n";
                 imgui.parameters.benchmarking = false;
                 return false;
             }
@@ -659,9 +4042,11 @@ namespace vkhr {
     }
 
     void Rasterizer::set_benchmark_configurations(const Benchmark& benchmark, SceneGraph& scene_graph) {
+        // Off-screen this only re-creates the images at the new size, there's nothing on the screen.
         auto& window = window_surface.get_glfw_window();
         window.resize(benchmark.width,benchmark.height);
-        window.center();
+        if (!window.is_offscreen())
+            window.center();
         window.append_string("Benchmark " + std::to_string(benchmark_counter) + " / " + std::to_string(queued_benchmarks));
 
         auto& camera = scene_graph.get_camera();
@@ -669,8 +4054,11 @@ namespace vkhr {
         imgui.make_current_renderer(benchmark.renderer);
         imgui.switch_scene(benchmark.scene, scene_graph,
                            *this);
-        camera.set_distance(benchmark.viewing_distance);
         imgui.set_sample_size(benchmark.raymarch_steps);
+        imgui.set_profile_limit(benchmark.measured_frames);
+        imgui.parameters.pipeline_statistics = benchmark.pipeline_statistics;
+        imgui.parameters.strand_expansion = static_cast<int>(benchmark.strand_expansion);
+        imgui.parameters.temporal_anti_aliasing = benchmark.temporal_anti_aliasing;
 
         for (auto& hair_node : scene_graph.get_nodes_with_hair_styles()) {
             for (auto& hair_style : hair_node->get_hair_styles()) {
@@ -679,6 +4067,41 @@ namespace vkhr {
         }
 
         loaded_benchmark = benchmark;
+        benchmark_frame_csv = "";
+
+        if (!benchmark.camera_path.empty()) {
+            frames_benchmarked = 0; // i.e. start at the first keyframe.
+            follow_benchmark_camera_path(benchmark, scene_graph);
+        } else if (benchmark.viewing_distance > 0.0f) {
+            camera.set_distance(benchmark.viewing_distance);
+        }
+
+        loaded_benchmark.viewing_distance = camera.get_distance();
+    }
+
+    static float get_benchmark_path_time(const Rasterizer::Benchmark& benchmark, int frame) {
+        auto frames = std::max(benchmark.warmup_frames + benchmark.measured_frames, 1);
+        return std::min(static_cast<float>(frame) / frames, 1.0f) * benchmark.camera_path.get_duration();
+    }
+
+    void Rasterizer::follow_benchmark_camera_path(const Benchmark& benchmark, SceneGraph& scene_graph) {
+        if (benchmark.camera_path.empty())
+            return;
+        benchmark.camera_path.sample(get_benchmark_path_time(benchmark, frames_benchmarked),
+                                     scene_graph.get_camera());
+    }
+
+    void Rasterizer::record_benchmark_frame() {
+        // The GPU time is of the latest frame with its timestamps, i.e. frames_in_flight behind.
+        char row[128];
+        std::snprintf(row, sizeof(row), "%d, %.4f, %.4f, %.4f, %.4f, %.4f\n",
+                      frames_benchmarked - loaded_benchmark.warmup_frames,
+                      get_benchmark_path_time(loaded_benchmark, frames_benchmarked),
+                      frame_latency.frame_interval,
+                      frame_latency.cpu_time,
+                      imgui.get_latest_timestamp("Total Frame Time"),
+                      frame_latency.input_latency);
+        benchmark_frame_csv += row;
     }
 
     std::string Rasterizer::get_benchmark_header() {
@@ -696,6 +4119,8 @@ namespace vkhr {
         header << std::setw(9)  << "Pixels,";
         header << std::setw(9)  << "Strands,";
         header << std::setw(9)  << "Samples,";
+        header << std::setw(14) << "Expansion,";
+        header << std::setw(15) << "Anti-Aliasing,";
         header << std::setw(25) << "GPU,";
         header << std::setw(18) << "Total Memory Use,";
         header << std::setw(18) << "PPLL,";
@@ -705,6 +4130,30 @@ namespace vkhr {
         return header.str();
     }
 
+    nlohmann::json Rasterizer::get_benchmark_json(const Benchmark& benchmark, const SceneGraph& scene_graph, const Image& screenshot) {
+        static const char* renderers[]  { "Rasterizer", "Ray Tracer", "Raymarcher", "Hybrid LoD" };
+        static const char* expansions[] { "Vertex Inputs", "Pulled Lines", "Pulled Quads", "Tessellated Curves" };
+
+        return {
+            { "screenshot", benchmark_start_time + "/" + std::to_string(benchmark_counter) + ".png" },
+            { "description", benchmark.description },
+            { "renderer", renderers[benchmark.renderer] },
+            { "scene", benchmark.scene },
+            { "width", benchmark.width },
+            { "height", benchmark.height },
+            { "distance", benchmark.viewing_distance },
+            { "pixels", screenshot.get_shaded_pixel_count({ 0xFF, 0xFF, 0xFF, 0xFF }) },
+            { "strands", static_cast<std::size_t>(scene_graph.get_strand_count() * benchmark.strand_reduction) },
+            { "samples", benchmark.raymarch_steps },
+            { "expansion", expansions[static_cast<std::size_t>(benchmark.strand_expansion)] },
+            { "antiAliasing", benchmark.temporal_anti_aliasing ? "TAA" : "GPAA" },
+            { "gpu", physical_device.get_name() },
+            { "warmupFrames", benchmark.warmup_frames },
+            { "measuredFrames", benchmark.measured_frames },
+            { "profiles", imgui.get_performance_json() }
+        };
+    }
+
     std::string Rasterizer::get_benchmark_results(const Benchmark& benchmark, const SceneGraph& scene_graph, const Image& screenshot) {
         std::stringstream results;
 
@@ -741,6 +4190,27 @@ namespace vkhr {
         results << std::setw(9) << std::to_string(screenshot.get_shaded_pixel_count({ 0xFF, 0xFF, 0xFF, 0xFF })) + ",";
         results << std::setw(9) << std::to_string(static_cast<std::size_t>(scene_graph.get_strand_count() * benchmark.strand_reduction)) + ",";
         results << std::setw(9) << std::to_string(benchmark.raymarch_steps) + ",";
+
+        results << std::setw(14);
+
+        switch (benchmark.strand_expansion) {
+        case vulkan::HairStyle::Expansion::VertexInputs:
+            results << "Vertex Input,";
+            break;
+        case vulkan::HairStyle::Expansion::PulledLines:
+            results << (mesh_shading ? "Meshed Lines," : "Pulled Lines,");
+            break;
+        case vulkan::HairStyle::Expansion::PulledQuads:
+            results << (mesh_shading ? "Meshed Quads," : "Pulled Quads,");
+            break;
+        case vulkan::HairStyle::Expansion::TessellatedCurves:
+            results << "Tessellated,";
+            break;
+        default: break;
+        }
+
+        results << std::setw(15) << (benchmark.temporal_anti_aliasing ? "TAA," : "GPAA,");
+
         results << std::setw(25) << physical_device.get_name() + ",";
 
         std::size_t volume_memory_usage { 0 }, strand_memory_usage { 0 },
@@ -5,6 +5,9 @@
 #include <vkhr/scene_graph/camera.hh>
 #include <vkhr/scene_graph/light_source.hh>
 
+#include <algorithm>
+#include <cstring>
+
 namespace vkhr {
     namespace vulkan {
         Billboard::Billboard(const vkhr::Billboard& billboards,
@@ -34,6 +37,17 @@ namespace vkhr {
 
             vk::DebugMarker::object_name(vulkan_renderer.device, billboard_sampler, VK_OBJECT_TYPE_SAMPLER, "Billboard Sampler", id);
 
+            upload_buffer = vk::HostBuffer {
+                vulkan_renderer.device,
+                vkhr::Image::get_expected_size(width, height) * vulkan_renderer.frames_in_flight,
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, upload_buffer, VK_OBJECT_TYPE_BUFFER, "Billboard Upload Buffer", id);
+
+            // It's host coherent, so it can stay mapped.
+            upload_buffer.get_device_memory().map(0, upload_buffer.get_size(), reinterpret_cast<void**>(&upload_data));
+
             ++id;
         }
 
@@ -65,9 +79,75 @@ namespace vkhr {
             billboard_image.staged_copy(img, command_buffer);
         }
 
+        void Billboard::stream_tiles(Image& image, const std::vector<glm::uvec2>& tiles, std::uint32_t tile_size,
+                                     std::uint32_t frame, vk::CommandBuffer& command_buffer) {
+            auto extent = billboard_image.get_extent();
+            // It's the previous frame's size for a frame, until the raytracer is recreated.
+            std::uint32_t width  = std::min(extent.width,  image.get_width()),
+                          height = std::min(extent.height, image.get_height());
+
+            bool everything = !uploaded || tile_size == 0;
+            if (!everything && tiles.empty())
+                return;
+
+            std::vector<VkBufferImageCopy> regions;
+
+            VkDeviceSize frame_offset = static_cast<VkDeviceSize>(vkhr::Image::get_expected_size(extent.width, extent.height)) * frame;
+
+            auto stream_tile = [&](glm::uvec2 tile, glm::uvec2 size) {
+                if (tile.x >= width || tile.y >= height)
+                    return;
+
+                size = glm::min(size, glm::uvec2 { width, height } - tile);
+
+                // At the same place as in the billboard, so the rows don't have to be packed.
+                for (std::uint32_t y { tile.y }; y < tile.y + size.y; ++y) {
+                    std::memcpy(upload_data + frame_offset + (y * extent.width + tile.x) * vkhr::Image::BytesPerPixel,
+                                image.get_data() + (y * image.get_width() + tile.x) * vkhr::Image::BytesPerPixel,
+                                size.x * vkhr::Image::BytesPerPixel);
+                }
+
+                VkBufferImageCopy region;
+
+                region.bufferOffset = frame_offset + (tile.y * extent.width + tile.x) * vkhr::Image::BytesPerPixel;
+                region.bufferRowLength = extent.width;
+                region.bufferImageHeight = extent.height;
+
+                region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                region.imageSubresource.mipLevel = 0;
+                region.imageSubresource.baseArrayLayer = 0;
+                region.imageSubresource.layerCount = 1;
+
+                region.imageOffset = { static_cast<std::int32_t>(tile.x), static_cast<std::int32_t>(tile.y), 0 };
+                region.imageExtent = { size.x, size.y, 1 };
+
+                regions.push_back(region);
+            };
+
+            if (everything) {
+                stream_tile({ 0, 0 }, { width, height });
+            } else {
+                for (auto& tile : tiles)
+                    stream_tile(tile, glm::uvec2 { tile_size });
+            }
+
+            // The rest of it is kept, unless it hasn't been uploaded yet.
+            billboard_image.transition(command_buffer, VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                       uploaded ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED,
+                                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                       VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+            command_buffer.copy_buffer_image(upload_buffer, billboard_image, regions);
+
+            billboard_image.transition(command_buffer, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                       VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+            uploaded = true;
+        }
+
         void Billboard::draw(Pipeline& pipeline, vk::DescriptorSet& descriptor_set, vk::CommandBuffer& command_buffer) {
-            descriptor_set.write(1, billboard_view, billboard_sampler);
-            command_buffer.bind_descriptor_set(descriptor_set, pipeline);
+            command_buffer.bind_descriptor_set(descriptor_set.with({ { 1, billboard_view, billboard_sampler } }), pipeline);
             command_buffer.draw(6, 1);
         }
 
@@ -99,12 +179,12 @@ namespace vkhr {
 
             vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Billboard Descriptor Set Layout");
 
-            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.swap_chain.size(),
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
                                                                                 pipeline.descriptor_set_layout,
                                                                                 "Billboard Descriptor Set");
 
             for (std::size_t i { 0 }; i < pipeline.descriptor_sets.size(); ++i) {
-                pipeline.descriptor_sets[i].write(0, vulkan_renderer.camera[i]);
+                pipeline.descriptor_sets[i].write(0, vulkan_renderer.frame_constants[i], vulkan_renderer.camera[i]);
                 // the combined image sampler descriptor can only written later.
             }
 
@@ -123,7 +203,7 @@ namespace vkhr {
                 pipeline.shader_stages,
                 pipeline.fixed_stages,
                 pipeline.pipeline_layout,
-                vulkan_renderer.color_pass
+                vulkan_renderer.imgui_pass // what it's drawn in, and not multiview.
             };
 
             vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline, VK_OBJECT_TYPE_PIPELINE, "Billboard Graphics Pipeline");
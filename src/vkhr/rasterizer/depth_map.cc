@@ -6,6 +6,8 @@
 
 #include <vkpp/debug_marker.hh>
 
+#include <algorithm>
+
 namespace vkhr {
     namespace vulkan {
         DepthMap::DepthMap(const std::uint32_t width, const std::uint32_t height,
@@ -49,6 +51,45 @@ namespace vkhr {
 
             vk::DebugMarker::object_name(vulkan_renderer.device, framebuffer, VK_OBJECT_TYPE_FRAMEBUFFER, "Depth Map Framebuffer", id);
 
+            create_sampler_and_viewport(width, height, vulkan_renderer);
+
+            ++id;
+        }
+
+        DepthMap::DepthMap(DepthMapArray& depth_map_array, std::uint32_t layer,
+                           Rasterizer& vulkan_renderer, const LightSource& light_source)
+                          : light { &light_source },
+                            array_layer { true } {
+            auto& layered_image = depth_map_array.get_image();
+            auto width  = layered_image.get_extent().width,
+                 height = layered_image.get_extent().height;
+
+            image_view = vk::ImageView {
+                vulkan_renderer.device,
+                layered_image,
+                get_read_depth_layout(),
+                0, 1, layer
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, image_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Depth Map Layer View", id);
+
+            // Still drawn into on its own if multiview isn't used, see Rasterizer::multiview_shadows_enabled.
+            framebuffer = vk::Framebuffer {
+                vulkan_renderer.device,
+                vulkan_renderer.depth_pass,
+                image_view, VkExtent2D {
+                    width, height
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, framebuffer, VK_OBJECT_TYPE_FRAMEBUFFER, "Depth Map Layer Framebuffer", id);
+
+            create_sampler_and_viewport(width, height, vulkan_renderer);
+
+            ++id;
+        }
+
+        void DepthMap::create_sampler_and_viewport(std::uint32_t width, std::uint32_t height, Rasterizer& vulkan_renderer) {
             sampler = vk::Sampler {
                 vulkan_renderer.device,
                 VK_FILTER_LINEAR,
@@ -71,7 +112,7 @@ namespace vkhr {
                 { width, height }
             };
 
-            ++id;
+            extent = VkExtent2D { width, height };
         }
 
         DepthMap::DepthMap(const std::uint32_t width, Rasterizer& vulkan_renderer,
@@ -94,6 +135,25 @@ namespace vkhr {
             command_list.set_scissor(scissor);
         }
 
+        void DepthMap::set_resolution(std::uint32_t resolution) {
+            resolution = std::min({ resolution, extent.width, extent.height });
+            viewport.width  = static_cast<float>(resolution);
+            viewport.height = static_cast<float>(resolution);
+            scissor.extent  = { resolution, resolution };
+        }
+
+        std::uint32_t DepthMap::get_resolution() const {
+            return scissor.extent.width;
+        }
+
+        std::uint32_t DepthMap::get_width() const {
+            return extent.width;
+        }
+
+        float DepthMap::get_resolution_scale() const {
+            return extent.width != 0 ? static_cast<float>(scissor.extent.width) / extent.width : 1.0f;
+        }
+
         vk::Framebuffer& DepthMap::get_framebuffer() {
             return framebuffer;
         }
@@ -106,6 +166,12 @@ namespace vkhr {
             return image_view;
         }
 
+        VkDeviceSize DepthMap::get_size_in_bytes() const {
+            if (array_layer)
+                return 0; // see DepthMapArray.
+            return memory.get_size();
+        }
+
         VkImageLayout DepthMap::get_read_depth_layout() {
             return VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
         }
@@ -123,5 +189,90 @@ namespace vkhr {
         }
 
         int DepthMap::id { 0 };
+
+        DepthMapArray::DepthMapArray(const std::uint32_t width, const std::uint32_t layers, Rasterizer& vulkan_renderer)
+                                    : layer_count { layers } {
+            image = vk::Image {
+                vulkan_renderer.device,
+                width, width, 1,
+                DepthMap::get_attachment_format(),
+                VK_IMAGE_USAGE_SAMPLED_BIT |
+                DepthMap::get_image_usage_flags(),
+                1, VK_SAMPLE_COUNT_1_BIT,
+                VK_IMAGE_TILING_OPTIMAL,
+                layers
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, image, VK_OBJECT_TYPE_IMAGE, "Depth Map Array Image", id);
+
+            memory = vk::DeviceMemory {
+                vulkan_renderer.device,
+                image.get_memory_requirements(),
+                vk::DeviceMemory::Type::DeviceLocal
+            };
+
+            image.bind(memory);
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, memory, VK_OBJECT_TYPE_DEVICE_MEMORY, "Depth Map Array Device Memory", id);
+
+            image_view = vk::ImageView {
+                vulkan_renderer.device,
+                image,
+                DepthMap::get_read_depth_layout(),
+                0, 1, 0, layers
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, image_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Depth Map Array Image View", id);
+
+            // With multiview it has a single layer, and the views go into the layers of the attachment.
+            framebuffer = vk::Framebuffer {
+                vulkan_renderer.device,
+                vulkan_renderer.multiview_depth_pass,
+                image_view, VkExtent2D {
+                    width, width
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, framebuffer, VK_OBJECT_TYPE_FRAMEBUFFER, "Depth Map Array Framebuffer", id);
+
+            viewport = VkViewport {
+                0.0f, 0.0f,
+                static_cast<float>(width),
+                static_cast<float>(width),
+                0.0f, 1.0f
+            };
+
+            scissor = VkRect2D {
+                { 0, 0 },
+                { width, width }
+            };
+
+            ++id;
+        }
+
+        void DepthMapArray::update_dynamic_viewport_scissor_depth(vk::CommandBuffer& command_list) {
+            command_list.set_viewport(viewport);
+            command_list.set_scissor(scissor);
+        }
+
+        vk::Image& DepthMapArray::get_image() {
+            return image;
+        }
+
+        vk::Framebuffer& DepthMapArray::get_framebuffer() {
+            return framebuffer;
+        }
+
+        std::uint32_t DepthMapArray::get_layer_count() const {
+            return layer_count;
+        }
+
+        VkDeviceSize DepthMapArray::get_size_in_bytes() const {
+            if (layer_count == 0)
+                return 0;
+            return memory.get_size();
+        }
+
+        int DepthMapArray::id { 0 };
     }
 }
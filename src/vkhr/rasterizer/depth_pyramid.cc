@@ -0,0 +1,194 @@
+#include <vkhr/rasterizer/depth_pyramid.hh>
+
+#include <vkhr/rasterizer.hh>
+
+#include <vkpp/debug_marker.hh>
+
+#include <algorithm>
+
+namespace vkhr {
+    namespace vulkan {
+        DepthPyramid::DepthPyramid(Rasterizer& vulkan_renderer, std::uint32_t width, std::uint32_t height)
+                                  : depth_map { (width + 1) & ~1u, (height + 1) & ~1u, vulkan_renderer } {
+            auto pyramid_width  = std::max(((width  + 1) & ~1u) / 2, 1u),
+                 pyramid_height = std::max(((height + 1) & ~1u) / 2, 1u);
+
+            mip_levels = vk::DeviceImage::get_mip_chain_length(pyramid_width, pyramid_height);
+
+            image = vk::Image {
+                vulkan_renderer.device,
+                pyramid_width, pyramid_height,
+                VK_FORMAT_R32_SFLOAT,
+                VK_IMAGE_USAGE_STORAGE_BIT |
+                VK_IMAGE_USAGE_SAMPLED_BIT,
+                mip_levels
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, image, VK_OBJECT_TYPE_IMAGE, "Depth Pyramid Image", id);
+
+            memory = vk::DeviceMemory {
+                vulkan_renderer.device,
+                image.get_memory_requirements(),
+                vk::DeviceMemory::Type::DeviceLocal
+            };
+
+            image.bind(memory);
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, memory, VK_OBJECT_TYPE_DEVICE_MEMORY, "Depth Pyramid Device Memory", id);
+
+            image_view = vk::ImageView {
+                vulkan_renderer.device,
+                image,
+                VK_IMAGE_LAYOUT_GENERAL,
+                0, mip_levels
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, image_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Depth Pyramid Image View", id);
+
+            // One for each level, since they're written by depth_pyramid.comp one at a time.
+            for (std::uint32_t level { 0 }; level < mip_levels; ++level) {
+                storage_views.emplace_back(vulkan_renderer.device, image, VK_IMAGE_LAYOUT_GENERAL, level);
+                vk::DebugMarker::object_name(vulkan_renderer.device, storage_views.back(), VK_OBJECT_TYPE_IMAGE_VIEW,
+                                             "Depth Pyramid Storage View", id);
+            }
+
+            // Only ever fetched from, so the filters don't matter.
+            sampler = vk::Sampler {
+                vulkan_renderer.device,
+                VK_FILTER_NEAREST,
+                VK_FILTER_NEAREST,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, sampler, VK_OBJECT_TYPE_SAMPLER, "Depth Pyramid Sampler", id);
+
+            ++id;
+        }
+
+        DepthMap& DepthPyramid::get_depth_map() {
+            return depth_map;
+        }
+
+        void DepthPyramid::build(Pipeline& pipeline, std::uint32_t frame, vk::CommandBuffer& command_buffer) {
+            VkMemoryBarrier memory_barrier;
+            memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            memory_barrier.pNext = nullptr;
+
+            // The depth pass only makes the depth map visible to the fragment shaders.
+            memory_barrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            memory_barrier);
+
+            // Every level is overwritten, once the last frame's culling is done reading them.
+            image.transition(command_buffer,
+                             VK_ACCESS_SHADER_READ_BIT,
+                             VK_ACCESS_SHADER_WRITE_BIT,
+                             VK_IMAGE_LAYOUT_UNDEFINED,
+                             VK_IMAGE_LAYOUT_GENERAL,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+            command_buffer.bind_pipeline(pipeline);
+
+            for (std::uint32_t level { 0 }; level < mip_levels; ++level) {
+                if (level != 0) {
+                    memory_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+                    memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+                    command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                                    memory_barrier);
+                }
+
+                std::uint32_t previous_level = level != 0 ? level - 1 : 0; // not read for the first level.
+
+                auto& descriptor_set = pipeline.descriptor_sets[frame].with({
+                    { 0, depth_map.get_image_view(), depth_map.get_sampler() },
+                    { 1, storage_views[previous_level] },
+                    { 2, storage_views[level] }
+                });
+
+                command_buffer.bind_descriptor_set(descriptor_set, pipeline);
+                command_buffer.push_constant(pipeline, 0, level);
+
+                auto extent = image.get_extent();
+
+                std::uint32_t level_width  = std::max(extent.width  >> level, 1u),
+                              level_height = std::max(extent.height >> level, 1u);
+
+                command_buffer.dispatch((level_width  + GroupSize - 1) / GroupSize,
+                                        (level_height + GroupSize - 1) / GroupSize);
+            }
+
+            memory_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            memory_barrier);
+        }
+
+        void DepthPyramid::build_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("models/depth_pyramid.comp"));
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0],
+                                         VK_OBJECT_TYPE_SHADER_MODULE, "Depth Pyramid Shader");
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                vulkan_renderer.device,
+                {
+                    { 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                    { 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE },
+                    { 2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE }
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout,
+                                         VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Depth Pyramid Descriptor Set Layout");
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
+                                                                                pipeline.descriptor_set_layout,
+                                                                                "Depth Pyramid Descriptor Set");
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout,
+                {
+                    { VK_SHADER_STAGE_ALL, 0, sizeof(std::uint32_t) } // mip level
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout,
+                                         VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                                         "Depth Pyramid Pipeline Layout");
+
+            pipeline.compute_pipeline = vk::ComputePipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages[0],
+                pipeline.pipeline_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.compute_pipeline,
+                                         VK_OBJECT_TYPE_PIPELINE, "Depth Pyramid Pipeline");
+        }
+
+        vk::Sampler& DepthPyramid::get_sampler() {
+            return sampler;
+        }
+
+        vk::ImageView& DepthPyramid::get_image_view() {
+            return image_view;
+        }
+
+        std::uint32_t DepthPyramid::get_mip_levels() const {
+            return mip_levels;
+        }
+
+        int DepthPyramid::id { 0 };
+    }
+}
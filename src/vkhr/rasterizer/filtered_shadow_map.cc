@@ -0,0 +1,279 @@
+#include <vkhr/rasterizer/filtered_shadow_map.hh>
+
+#include <vkhr/rasterizer.hh>
+
+#include <vkpp/debug_marker.hh>
+
+namespace vkhr {
+    namespace vulkan {
+        FilteredShadowMap::FilteredShadowMap(const std::uint32_t width, Rasterizer& vulkan_renderer)
+                                            : width { width } {
+            rows_image = vk::Image {
+                vulkan_renderer.device,
+                width, width,
+                get_format(),
+                VK_IMAGE_USAGE_STORAGE_BIT
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, rows_image, VK_OBJECT_TYPE_IMAGE, "Filtered Shadow Map Rows Image", id);
+
+            rows_memory = vk::DeviceMemory {
+                vulkan_renderer.device,
+                rows_image.get_memory_requirements(),
+                vk::DeviceMemory::Type::DeviceLocal
+            };
+
+            rows_image.bind(rows_memory);
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, rows_memory, VK_OBJECT_TYPE_DEVICE_MEMORY, "Filtered Shadow Map Rows Device Memory", id);
+
+            rows_view = vk::ImageView {
+                vulkan_renderer.device,
+                rows_image,
+                VK_IMAGE_LAYOUT_GENERAL
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, rows_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Filtered Shadow Map Rows Image View", id);
+
+            image = vk::Image {
+                vulkan_renderer.device,
+                width, width,
+                get_format(),
+                VK_IMAGE_USAGE_STORAGE_BIT |
+                VK_IMAGE_USAGE_SAMPLED_BIT
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, image, VK_OBJECT_TYPE_IMAGE, "Filtered Shadow Map Image", id);
+
+            memory = vk::DeviceMemory {
+                vulkan_renderer.device,
+                image.get_memory_requirements(),
+                vk::DeviceMemory::Type::DeviceLocal
+            };
+
+            image.bind(memory);
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, memory, VK_OBJECT_TYPE_DEVICE_MEMORY, "Filtered Shadow Map Device Memory", id);
+
+            image_view = vk::ImageView {
+                vulkan_renderer.device,
+                image
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, image_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Filtered Shadow Map Image View", id);
+
+            storage_view = vk::ImageView {
+                vulkan_renderer.device,
+                image,
+                VK_IMAGE_LAYOUT_GENERAL
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, storage_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Filtered Shadow Map Storage View", id);
+
+            sampler = vk::Sampler {
+                vulkan_renderer.device,
+                VK_FILTER_LINEAR,
+                VK_FILTER_LINEAR,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, sampler, VK_OBJECT_TYPE_SAMPLER, "Filtered Shadow Map Sampler", id);
+
+            // It's sampled by the strands even if it's never filtered, so it needs to be in that layout.
+            image.transition(vulkan_renderer.staging_ring.get_command_buffer(),
+                             0, VK_ACCESS_SHADER_READ_BIT,
+                             VK_IMAGE_LAYOUT_UNDEFINED,
+                             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                             VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+            ++id;
+        }
+
+        void FilteredShadowMap::filter(Pipeline& pipeline, DepthMap& depth_map, std::uint32_t frame, vk::CommandBuffer& command_buffer) {
+            VkMemoryBarrier memory_barrier;
+            memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            memory_barrier.pNext = nullptr;
+
+            // The depth pass only makes the depth map visible to the fragment shaders.
+            memory_barrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            memory_barrier);
+
+            // Both of them are overwritten, so the old contents can go.
+            rows_image.transition(command_buffer,
+                                  VK_ACCESS_SHADER_READ_BIT,
+                                  VK_ACCESS_SHADER_WRITE_BIT,
+                                  VK_IMAGE_LAYOUT_UNDEFINED,
+                                  VK_IMAGE_LAYOUT_GENERAL,
+                                  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+            image.transition(command_buffer,
+                             VK_ACCESS_SHADER_READ_BIT,
+                             VK_ACCESS_SHADER_WRITE_BIT,
+                             VK_IMAGE_LAYOUT_UNDEFINED,
+                             VK_IMAGE_LAYOUT_GENERAL,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+            auto& descriptor_set = pipeline.descriptor_sets[frame].with({
+                { 0, depth_map.get_image_view(), depth_map.get_sampler() },
+                { 1, rows_view },
+                { 2, storage_view }
+            });
+
+            command_buffer.bind_pipeline(pipeline);
+            command_buffer.bind_descriptor_set(descriptor_set, pipeline);
+
+            std::uint32_t group_count = (width + GroupSize - 1) / GroupSize;
+
+            command_buffer.push_constant(pipeline, 0, 0u); // rows.
+            command_buffer.dispatch(group_count, width);
+
+            memory_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            memory_barrier);
+
+            command_buffer.push_constant(pipeline, 0, 1u); // columns.
+            command_buffer.dispatch(group_count, width);
+
+            image.transition(command_buffer,
+                             VK_ACCESS_SHADER_WRITE_BIT,
+                             VK_ACCESS_SHADER_READ_BIT,
+                             VK_IMAGE_LAYOUT_GENERAL,
+                             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        }
+
+        void FilteredShadowMap::linearize(Pipeline& pipeline, DepthMap& depth_map, float near, float far,
+                                          std::uint32_t frame, vk::CommandBuffer& command_buffer) {
+            VkMemoryBarrier memory_barrier;
+            memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            memory_barrier.pNext = nullptr;
+
+            memory_barrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            memory_barrier);
+
+            image.transition(command_buffer,
+                             VK_ACCESS_SHADER_READ_BIT,
+                             VK_ACCESS_SHADER_WRITE_BIT,
+                             VK_IMAGE_LAYOUT_UNDEFINED,
+                             VK_IMAGE_LAYOUT_GENERAL,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+            auto& descriptor_set = pipeline.descriptor_sets[frame].with({
+                { 0, depth_map.get_image_view(), depth_map.get_sampler() },
+                { 1, rows_view },
+                { 2, storage_view }
+            });
+
+            command_buffer.bind_pipeline(pipeline);
+            command_buffer.bind_descriptor_set(descriptor_set, pipeline);
+
+            struct LinearizePass {
+                std::uint32_t filter_pass { 2 };
+                float near, far;
+            } linearize_pass;
+
+            linearize_pass.near = near;
+            linearize_pass.far  = far;
+
+            command_buffer.push_constant(pipeline, 0, linearize_pass);
+            command_buffer.dispatch((width + GroupSize - 1) / GroupSize, width);
+
+            image.transition(command_buffer,
+                             VK_ACCESS_SHADER_WRITE_BIT,
+                             VK_ACCESS_SHADER_READ_BIT,
+                             VK_IMAGE_LAYOUT_GENERAL,
+                             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        }
+
+        void FilteredShadowMap::build_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("self-shadowing/filter_deep_shadows.comp"));
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0],
+                                         VK_OBJECT_TYPE_SHADER_MODULE, "Shadow Filter Shader");
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                vulkan_renderer.device,
+                {
+                    { 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                    { 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE },
+                    { 2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE },
+                    { 4, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER } // kernel size.
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout,
+                                         VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Shadow Filter Descriptor Set Layout");
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
+                                                                                pipeline.descriptor_set_layout,
+                                                                                "Shadow Filter Descriptor Set");
+
+            for (std::size_t i { 0 }; i < pipeline.descriptor_sets.size(); ++i)
+                pipeline.descriptor_sets[i].write(4, vulkan_renderer.frame_constants[i], vulkan_renderer.params[i]);
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout,
+                {
+                    { VK_SHADER_STAGE_ALL, 0, sizeof(std::uint32_t) + 2 * sizeof(float) } // filter pass, near and far.
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout,
+                                         VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                                         "Shadow Filter Pipeline Layout");
+
+            pipeline.compute_pipeline = vk::ComputePipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages[0],
+                pipeline.pipeline_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.compute_pipeline,
+                                         VK_OBJECT_TYPE_PIPELINE, "Shadow Filter Pipeline");
+        }
+
+        VkFormat FilteredShadowMap::get_format() {
+            return VK_FORMAT_R32_SFLOAT;
+        }
+
+        vk::Sampler& FilteredShadowMap::get_sampler() {
+            return sampler;
+        }
+
+        vk::ImageView& FilteredShadowMap::get_image_view() {
+            return image_view;
+        }
+
+        VkDeviceSize FilteredShadowMap::get_size_in_bytes() const {
+            return memory.get_size() + rows_memory.get_size();
+        }
+
+        int FilteredShadowMap::id { 0 };
+    }
+}
@@ -0,0 +1,289 @@
+#include <vkhr/rasterizer/hair_batch.hh>
+
+#include <vkhr/rasterizer.hh>
+
+#include <algorithm>
+#include <cstddef>
+
+namespace vkhr {
+    namespace vulkan {
+        HairBatch::HairBatch(Rasterizer& vulkan_renderer, std::uint32_t views)
+                            : views { views }, vulkan_renderer { &vulkan_renderer } {
+            VkDeviceSize vertex_stride = vulkan_renderer.strand_quantization == vkhr::HairStyle::Quantization::Packed
+                                       ? sizeof(vkhr::HairStyle::QuantizedVertex) : sizeof(glm::vec3);
+
+            VkDeviceSize vertex_bytes { 0 };
+            std::uint32_t index_count { 0 };
+
+            for (auto& hair_style : vulkan_renderer.hair_styles) {
+                auto& range = ranges[hair_style.first];
+                range.vertex_bytes  = vertex_bytes;
+                range.vertex_offset = static_cast<std::int32_t>(vertex_bytes / vertex_stride);
+                range.first_index   = index_count;
+                range.index_count   = hair_style.second.segments.count();
+
+                vertex_bytes += hair_style.second.vertices.get_size();
+                index_count  += range.index_count;
+            }
+
+            // Don't create an empty buffer.
+            vertices = vk::DeviceBuffer {
+                vulkan_renderer.device,
+                std::max<VkDeviceSize>(vertex_bytes, vertex_stride),
+                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, vertices, VK_OBJECT_TYPE_BUFFER, "Hair Batch Vertex Buffer", id);
+            vk::DebugMarker::object_name(vulkan_renderer.device, vertices.get_device_memory(), VK_OBJECT_TYPE_DEVICE_MEMORY,
+                                         "Hair Batch Vertex Device Memory", id);
+
+            indices = vk::DeviceBuffer {
+                vulkan_renderer.device,
+                std::max<VkDeviceSize>(index_count, 1) * sizeof(std::uint32_t),
+                VK_BUFFER_USAGE_INDEX_BUFFER_BIT
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, indices, VK_OBJECT_TYPE_BUFFER, "Hair Batch Index Buffer", id);
+            vk::DebugMarker::object_name(vulkan_renderer.device, indices.get_device_memory(), VK_OBJECT_TYPE_DEVICE_MEMORY,
+                                         "Hair Batch Index Device Memory", id);
+
+            // The segments aren't rebased, each command's vertexOffset is the style's first vertex.
+            auto command_buffer = vulkan_renderer.command_pool.allocate_and_begin();
+
+            for (auto& hair_style : vulkan_renderer.hair_styles) {
+                const auto& range = ranges[hair_style.first];
+                command_buffer.copy_buffer(hair_style.second.vertices, vertices, 0, static_cast<std::uint32_t>(range.vertex_bytes));
+                command_buffer.copy_buffer(hair_style.second.segments, indices,  0, range.first_index * sizeof(std::uint32_t));
+            }
+
+            command_buffer.end();
+
+            vulkan_renderer.command_pool.get_queue().submit(command_buffer)
+                                                    .wait_idle();
+
+            auto max_draws = std::max<std::size_t>(ranges.size(), 1) * views;
+
+            for (std::uint32_t i { 0 }; i < vulkan_renderer.frames_in_flight; ++i) {
+                draw_commands.emplace_back(vulkan_renderer.device, max_draws * sizeof(VkDrawIndexedIndirectCommand),
+                                           VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+                vk::DebugMarker::object_name(vulkan_renderer.device, draw_commands[i], VK_OBJECT_TYPE_BUFFER, "Hair Batch Draw Buffer", i);
+                draw_counts.emplace_back(vulkan_renderer.device, std::max<std::uint32_t>(views, 1) * sizeof(std::uint32_t),
+                                         VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+                vk::DebugMarker::object_name(vulkan_renderer.device, draw_counts[i], VK_OBJECT_TYPE_BUFFER, "Hair Batch Count Buffer", i);
+                draw_bounds.emplace_back(vulkan_renderer.device, max_draws * sizeof(AABB),
+                                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+                vk::DebugMarker::object_name(vulkan_renderer.device, draw_bounds[i], VK_OBJECT_TYPE_BUFFER, "Hair Batch Bounds Buffer", i);
+            }
+
+            draw_count.assign(views, 0);
+
+            ++id;
+        }
+
+        void HairBatch::refresh(vk::CommandBuffer& command_buffer) {
+            VkMemoryBarrier memory_barrier;
+            memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            memory_barrier.pNext = nullptr;
+
+            // After the simulation has written them, and the last frame is done drawing the copies.
+            memory_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+                                            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                                            VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                            memory_barrier);
+
+            for (auto& range : ranges) {
+                auto& hair_style = vulkan_renderer->hair_styles.at(range.first);
+                command_buffer.copy_buffer(hair_style.vertices, vertices, 0, static_cast<std::uint32_t>(range.second.vertex_bytes));
+            }
+
+            memory_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                                            memory_barrier);
+        }
+
+        void HairBatch::update(std::uint32_t frame) {
+            const auto& hair_instances = vulkan_renderer->hair_instances;
+
+            std::vector<VkDrawIndexedIndirectCommand> commands;
+            std::vector<AABB> bounds;
+
+            auto max_draws = std::max<std::size_t>(ranges.size(), 1);
+
+            for (std::uint32_t view { 0 }; view < views; ++view) {
+                commands.clear();
+                bounds.clear();
+
+                if (view < hair_instances.size()) {
+                    for (const auto& hair_instance : hair_instances[view]) {
+                        auto range = ranges.find(hair_instance.hair_style);
+                        if (range == ranges.end())
+                            continue;
+
+                        const auto& hair_style = vulkan_renderer->hair_styles.at(hair_instance.hair_style);
+
+                        VkDrawIndexedIndirectCommand command;
+                        command.indexCount = static_cast<std::uint32_t>(range->second.index_count * hair_style.parameters.strand_ratio);
+                        command.instanceCount = hair_instance.instance_count;
+                        command.firstIndex = range->second.first_index;
+                        command.vertexOffset = range->second.vertex_offset;
+                        command.firstInstance = hair_instance.first_instance;
+
+                        commands.push_back(command);
+                        bounds.push_back(hair_style.parameters.volume_bounds);
+                    }
+                }
+
+                draw_count[view] = static_cast<std::uint32_t>(commands.size());
+
+                if (commands.empty())
+                    continue;
+
+                draw_commands[frame].get_device_memory().copy(commands.size() * sizeof(VkDrawIndexedIndirectCommand), commands.data(),
+                                                              view * max_draws * sizeof(VkDrawIndexedIndirectCommand));
+                draw_bounds[frame].get_device_memory().copy(bounds.size() * sizeof(AABB), bounds.data(),
+                                                            view * max_draws * sizeof(AABB));
+            }
+
+            draw_counts[frame].get_device_memory().copy(draw_count.size() * sizeof(std::uint32_t), draw_count.data());
+        }
+
+        void HairBatch::draw(Pipeline& pipeline, std::uint32_t frame, std::uint32_t view,
+                             const glm::mat4& projection, vk::CommandBuffer& command_buffer) {
+            if (view >= views || draw_count[view] == 0)
+                return;
+
+            auto first_draw = static_cast<std::uint32_t>(view * std::max<std::size_t>(ranges.size(), 1));
+
+            // They're all the same, see is_drawable.
+            const auto& hair_style = vulkan_renderer->hair_styles.begin()->second;
+
+            command_buffer.bind_pipeline(pipeline);
+            command_buffer.set_line_width(hair_style.native_width ? 1.0f : hair_style.parameters.strand_radius);
+            command_buffer.push_constant(pipeline, 0, HairStyle::Instances { projection, first_draw });
+            command_buffer.bind_descriptor_set(pipeline.descriptor_sets[frame], pipeline, { 0 });
+
+            command_buffer.bind_vertex_buffer(0, 1, vertices);
+            command_buffer.bind_index_buffer(indices, VK_INDEX_TYPE_UINT32);
+
+#ifdef VK_KHR_draw_indirect_count
+            if (vulkan_renderer->indirect_count) {
+                command_buffer.draw_indexed_indirect_count(draw_commands[frame], first_draw * sizeof(VkDrawIndexedIndirectCommand),
+                                                           draw_counts[frame], view * sizeof(std::uint32_t),
+                                                           static_cast<std::uint32_t>(std::max<std::size_t>(ranges.size(), 1)));
+                return;
+            }
+#endif
+
+            command_buffer.draw_indexed_indirect(draw_commands[frame], first_draw * sizeof(VkDrawIndexedIndirectCommand),
+                                                 draw_count[view]);
+        }
+
+        bool HairBatch::is_drawable() const {
+            if (ranges.empty())
+                return false;
+
+            auto line_width = [](const HairStyle& hair_style) {
+                return hair_style.native_width ? 1.0f : hair_style.parameters.strand_radius;
+            };
+
+            const auto& hair_styles = vulkan_renderer->hair_styles;
+            auto first_width = line_width(hair_styles.begin()->second);
+
+            return std::all_of(hair_styles.begin(), hair_styles.end(), [&](const auto& hair_style) {
+                return line_width(hair_style.second) == first_width;
+            });
+        }
+
+        void HairBatch::depth_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+
+            if (vulkan_renderer.strand_quantization == vkhr::HairStyle::Quantization::Packed) {
+                pipeline.fixed_stages.add_vertex_binding(vk::VertexBinding { 0, sizeof(vkhr::HairStyle::QuantizedVertex), VK_VERTEX_INPUT_RATE_VERTEX });
+                pipeline.fixed_stages.add_vertex_attribute(vk::VertexAttribute { 0, 0, VK_FORMAT_R16G16B16A16_UNORM, 0 });
+            } else {
+                pipeline.fixed_stages.add_vertex_binding({ 0, 0, VK_FORMAT_R32G32B32_SFLOAT, sizeof(glm::vec3) });
+            }
+
+            pipeline.fixed_stages.set_scissor({ 0, 0, vulkan_renderer.swap_chain.get_extent() });
+            pipeline.fixed_stages.set_viewport({ 0.0, 0.0,
+                                                 static_cast<float>(vulkan_renderer.swap_chain.get_width()),
+                                                 static_cast<float>(vulkan_renderer.swap_chain.get_height()),
+                                                 0.0, 1.0 });
+
+            // The segments of every style, even with strip_topology, since the strips aren't batched.
+            pipeline.fixed_stages.set_topology(VK_PRIMITIVE_TOPOLOGY_LINE_LIST);
+
+            pipeline.fixed_stages.add_dynamic_state(VK_DYNAMIC_STATE_VIEWPORT);
+            pipeline.fixed_stages.add_dynamic_state(VK_DYNAMIC_STATE_LINE_WIDTH);
+            pipeline.fixed_stages.add_dynamic_state(VK_DYNAMIC_STATE_SCISSOR);
+
+            pipeline.fixed_stages.set_culling_mode(VK_CULL_MODE_BACK_BIT);
+
+            pipeline.fixed_stages.set_line_width(1.0);
+            pipeline.fixed_stages.enable_depth_test();
+
+            struct Constants {
+                std::uint32_t vertex_format;
+            } constant_data {
+                static_cast<std::uint32_t>(vulkan_renderer.strand_quantization)
+            };
+
+            std::vector<VkSpecializationMapEntry> constants {
+                { 0, offsetof(Constants, vertex_format), sizeof(std::uint32_t) }
+            };
+
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("strands/strand_batch_depth.vert"), constants, &constant_data, sizeof(constant_data));
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0], VK_OBJECT_TYPE_SHADER_MODULE, "Hair Batch Depth Shader");
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                vulkan_renderer.device,
+                {
+                    { 2,  VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC }, // unused, but in strand.glsl.
+                    { 28, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 33, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER }
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Hair Batch Depth Descriptor Set Layout");
+
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
+                                                                                pipeline.descriptor_set_layout,
+                                                                                "Hair Batch Depth Descriptor Set");
+
+            for (std::size_t i { 0 }; i < pipeline.descriptor_sets.size(); ++i) {
+                pipeline.descriptor_sets[i].write(2, vulkan_renderer.strand_parameters, 0, sizeof(HairStyle::Parameters));
+                pipeline.descriptor_sets[i].write(28, vulkan_renderer.hair_instance_buffers[i]);
+                pipeline.descriptor_sets[i].write(33, vulkan_renderer.hair_batch.draw_bounds[i]);
+            }
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout,
+                {
+                    { VK_SHADER_STAGE_ALL, 0, sizeof(HairStyle::Instances) } // the first draw.
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Hair Batch Depth Pipeline Layout");
+
+            pipeline.pipeline = vk::GraphicsPipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages,
+                pipeline.fixed_stages,
+                pipeline.pipeline_layout,
+                vulkan_renderer.depth_pass
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline, VK_OBJECT_TYPE_PIPELINE, "Hair Batch Depth Graphics Pipeline");
+        }
+
+        int HairBatch::id { 0 };
+    }
+}
@@ -1,80 +1,254 @@
 #include <vkhr/rasterizer/hair_style.hh>
 
 #include <vkhr/rasterizer.hh>
+#include <vkhr/job_system.hh>
 
 #include <vkhr/scene_graph/camera.hh>
 #include <vkhr/scene_graph/light_source.hh>
 
 #include <vkpp/debug_marker.hh>
 
+#include <algorithm>
+#include <cstddef>
+#include <cmath>
+#include <limits>
+
 namespace vkhr {
     namespace vulkan {
         HairStyle::HairStyle(const vkhr::HairStyle& hair_style,
-                             vkhr::Rasterizer& vulkan_renderer) {
+                             vkhr::Rasterizer& vulkan_renderer,
+                             std::uint32_t parameter_slot)
+                            : parameter_offset { static_cast<std::uint32_t>(parameter_slot * vulkan_renderer.strand_parameters_stride) } {
             load(hair_style, vulkan_renderer);
         }
 
         void HairStyle::load(const vkhr::HairStyle& hair_style,
                              vkhr::Rasterizer& vulkan_renderer) {
-            vertices = vk::VertexBuffer {
+            quantization = vulkan_renderer.strand_quantization;
+            mesh_shading = vulkan_renderer.mesh_shading;
+
+            vertex_readback = vk::HostBuffer { }; // they're of the old vertices.
+            tangent_readback = vk::HostBuffer { };
+
+            if (quantization == vkhr::HairStyle::Quantization::Packed) {
+                vertices = vk::VertexBuffer {
+                    vulkan_renderer.device,
+                    vulkan_renderer.command_pool,
+                    hair_style.create_quantized_data()
+                };
+
+                vk::DebugMarker::object_name(vulkan_renderer.device, vertices, VK_OBJECT_TYPE_BUFFER, "Hair Packed Vertex Buffer", id);
+                vk::DebugMarker::object_name(vulkan_renderer.device, vertices.get_device_memory(), VK_OBJECT_TYPE_DEVICE_MEMORY,
+                                             "Hair Packed Device Memory", id);
+            } else {
+                vertices = vk::VertexBuffer {
+                    vulkan_renderer.device,
+                    vulkan_renderer.command_pool,
+                    hair_style.get_vertex_span()
+                };
+
+                vk::DebugMarker::object_name(vulkan_renderer.device, vertices, VK_OBJECT_TYPE_BUFFER, "Hair Position Vertex Buffer", id);
+                vk::DebugMarker::object_name(vulkan_renderer.device, vertices.get_device_memory(), VK_OBJECT_TYPE_DEVICE_MEMORY,
+                                             "Hair Position Device Memory", id);
+
+                tangents = vk::VertexBuffer {
+                    vulkan_renderer.device,
+                    vulkan_renderer.command_pool,
+                    hair_style.get_tangent_span()
+                };
+
+                vk::DebugMarker::object_name(vulkan_renderer.device, tangents, VK_OBJECT_TYPE_BUFFER, "Hair Tangent Vertex Buffer", id);
+                vk::DebugMarker::object_name(vulkan_renderer.device, tangents.get_device_memory(), VK_OBJECT_TYPE_DEVICE_MEMORY,
+                                             "Hair Tangent Device Memory", id);
+
+                thickness = vk::VertexBuffer {
+                    vulkan_renderer.device,
+                    vulkan_renderer.command_pool,
+                    hair_style.get_thickness_span()
+                };
+
+                vk::DebugMarker::object_name(vulkan_renderer.device, thickness, VK_OBJECT_TYPE_BUFFER, "Hair Thickness Vertex Buffer", id);
+                vk::DebugMarker::object_name(vulkan_renderer.device, thickness.get_device_memory(), VK_OBJECT_TYPE_DEVICE_MEMORY,
+                                             "Hair Thickness Device Memory", id);
+
+                merged_thickness.clear();
+
+                if (hair_style.has_clusters()) {
+                    auto strand_offsets = hair_style.create_strand_offsets();
+                    auto strand_thickness = hair_style.get_thickness_span();
+
+                    for (unsigned level { 1 }; level <= vkhr::HairStyle::ClusterLevels; ++level) {
+                        auto weights = hair_style.create_cluster_weights(level);
+                        float cut_ratio = std::exp2(-static_cast<float>(level)); // so it's 1 on average.
+
+                        std::vector<float> cut_thickness(hair_style.get_vertex_count(), 0.0f);
+                        for (std::size_t strand { 0 }; strand < weights.size(); ++strand) {
+                            for (auto vertex = strand_offsets[strand]; vertex < strand_offsets[strand + 1]; ++vertex)
+                                cut_thickness[vertex] = strand_thickness[vertex] * weights[strand] * cut_ratio;
+                        }
+
+                        merged_thickness.emplace_back(vulkan_renderer.device,
+                                                      vulkan_renderer.command_pool,
+                                                      cut_thickness);
+
+                        vk::DebugMarker::object_name(vulkan_renderer.device, merged_thickness.back(), VK_OBJECT_TYPE_BUFFER, "Hair Merged Thickness Vertex Buffer", id);
+                        vk::DebugMarker::object_name(vulkan_renderer.device, merged_thickness.back().get_device_memory(), VK_OBJECT_TYPE_DEVICE_MEMORY,
+                                                     "Hair Merged Thickness Device Memory", id);
+                    }
+                }
+            }
+
+            segments = vk::IndexBuffer {
+                vulkan_renderer.device,
+                vulkan_renderer.command_pool,
+                hair_style.get_index_span()
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, segments, VK_OBJECT_TYPE_BUFFER, "Hair Index Buffer", id);
+            vk::DebugMarker::object_name(vulkan_renderer.device, segments.get_device_memory(), VK_OBJECT_TYPE_DEVICE_MEMORY,
+                                         "Hair Index Device Memory", id);
+
+            auto strip_indices = hair_style.create_strip_indices();
+
+            // The restart index is all ones for either index type.
+            if (hair_style.get_vertex_count() < 0xFFFF) {
+                std::vector<unsigned short> short_strip_indices(strip_indices.begin(), strip_indices.end());
+                strips = vk::IndexBuffer {
+                    vulkan_renderer.device,
+                    vulkan_renderer.command_pool,
+                    short_strip_indices
+                };
+            } else {
+                strips = vk::IndexBuffer {
+                    vulkan_renderer.device,
+                    vulkan_renderer.command_pool,
+                    strip_indices
+                };
+            }
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, strips, VK_OBJECT_TYPE_BUFFER, "Hair Strip Index Buffer", id);
+            vk::DebugMarker::object_name(vulkan_renderer.device, strips.get_device_memory(), VK_OBJECT_TYPE_DEVICE_MEMORY,
+                                         "Hair Strip Index Device Memory", id);
+
+            curve_patches = vk::IndexBuffer {
                 vulkan_renderer.device,
                 vulkan_renderer.command_pool,
-                hair_style.get_vertices()
+                hair_style.create_curve_patches()
             };
 
-            vk::DebugMarker::object_name(vulkan_renderer.device, vertices, VK_OBJECT_TYPE_BUFFER, "Hair Position Vertex Buffer", id);
-            vk::DebugMarker::object_name(vulkan_renderer.device, vertices.get_device_memory(), VK_OBJECT_TYPE_DEVICE_MEMORY,
-                                         "Hair Position Device Memory", id);
+            vk::DebugMarker::object_name(vulkan_renderer.device, curve_patches, VK_OBJECT_TYPE_BUFFER, "Hair Curve Patch Buffer", id);
+            vk::DebugMarker::object_name(vulkan_renderer.device, curve_patches.get_device_memory(), VK_OBJECT_TYPE_DEVICE_MEMORY,
+                                         "Hair Curve Patch Device Memory", id);
+
+            std::vector<glm::vec4>  rest_vertices;
+            std::vector<glm::uvec2> strand_vertices;
+
+            rest_vertices.reserve(hair_style.get_vertex_count());
+            for (const auto& vertex : hair_style.get_vertex_span())
+                rest_vertices.emplace_back(vertex, 0.0f);
+
+            auto strand_segments = hair_style.get_segment_span();
 
-            tangents = vk::VertexBuffer {
+            std::uint32_t first_vertex { 0 };
+            for (std::size_t strand { 0 }; strand < hair_style.get_strand_count(); ++strand) {
+                unsigned segment_count { hair_style.get_default_segment_count() };
+                if (hair_style.has_segments()) segment_count = strand_segments[strand];
+                strand_vertices.emplace_back(first_vertex, segment_count + 1);
+                first_vertex += segment_count + 1;
+            }
+
+            strand_count = static_cast<std::uint32_t>(strand_vertices.size());
+
+            rest_positions = vk::StorageBuffer {
                 vulkan_renderer.device,
                 vulkan_renderer.command_pool,
-                hair_style.get_tangents()
+                rest_vertices
             };
 
-            vk::DebugMarker::object_name(vulkan_renderer.device, tangents, VK_OBJECT_TYPE_BUFFER, "Hair Tangent Vertex Buffer", id);
-            vk::DebugMarker::object_name(vulkan_renderer.device, tangents.get_device_memory(), VK_OBJECT_TYPE_DEVICE_MEMORY,
-                                         "Hair Tangent Device Memory", id);
+            vk::DebugMarker::object_name(vulkan_renderer.device, rest_positions, VK_OBJECT_TYPE_BUFFER, "Hair Rest Position Buffer", id);
 
-            thickness = vk::VertexBuffer {
+            // Starts at rest.
+            previous_positions = vk::StorageBuffer {
                 vulkan_renderer.device,
                 vulkan_renderer.command_pool,
-                hair_style.get_thickness()
+                rest_vertices
             };
 
-            vk::DebugMarker::object_name(vulkan_renderer.device, thickness, VK_OBJECT_TYPE_BUFFER, "Hair Thickness Vertex Buffer", id);
-            vk::DebugMarker::object_name(vulkan_renderer.device, thickness.get_device_memory(), VK_OBJECT_TYPE_DEVICE_MEMORY,
-                                         "Hair Thickness Device Memory", id);
+            vk::DebugMarker::object_name(vulkan_renderer.device, previous_positions, VK_OBJECT_TYPE_BUFFER, "Hair Previous Position Buffer", id);
 
-            segments = vk::IndexBuffer {
+            strands = vk::StorageBuffer {
                 vulkan_renderer.device,
                 vulkan_renderer.command_pool,
-                hair_style.get_indices()
+                strand_vertices
             };
 
-            vk::DebugMarker::object_name(vulkan_renderer.device, segments, VK_OBJECT_TYPE_BUFFER, "Hair Index Buffer", id);
-            vk::DebugMarker::object_name(vulkan_renderer.device, segments.get_device_memory(), VK_OBJECT_TYPE_DEVICE_MEMORY,
-                                         "Hair Index Device Memory", id);
+            vk::DebugMarker::object_name(vulkan_renderer.device, strands, VK_OBJECT_TYPE_BUFFER, "Hair Strand Buffer", id);
+
+            if (hair_style.has_guides()) {
+                auto guide_span = hair_style.get_guide_span();
+                std::vector<std::uint32_t> strand_guides(guide_span.begin(), guide_span.end());
+
+                guides = vk::StorageBuffer {
+                    vulkan_renderer.device,
+                    vulkan_renderer.command_pool,
+                    strand_guides
+                };
+
+                vk::DebugMarker::object_name(vulkan_renderer.device, guides, VK_OBJECT_TYPE_BUFFER, "Hair Guide Buffer", id);
+
+                guide_count = hair_style.get_guide_count();
+            }
 
-            parameters.hair_shininess = 80.0f; // Using Kajiya-Kay.
+            auto segment_clusters = hair_style.create_segment_clusters(ClusterSize);
+            cluster_count = static_cast<std::uint32_t>(segment_clusters.size());
+
+            clusters = vk::StorageBuffer {
+                vulkan_renderer.device,
+                vulkan_renderer.command_pool,
+                segment_clusters
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, clusters, VK_OBJECT_TYPE_BUFFER, "Hair Cluster Buffer", id);
+
+            // Empty, as the lower and upper corners of ordered floats, see bounds.comp.
+            std::vector<std::uint32_t> empty_bounds { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0, 0, 0, 0 };
+
+            simulated_bounds = vk::StorageBuffer {
+                vulkan_renderer.device,
+                vulkan_renderer.command_pool,
+                empty_bounds
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, simulated_bounds, VK_OBJECT_TYPE_BUFFER, "Hair Simulated Bounds Buffer", id);
+
+            parameters.hair_shininess = Shininess; // Using Kajiya-Kay.
             parameters.strand_radius = hair_style.get_default_thickness();
             parameters.hair_opacity = hair_style.get_default_transparency();
             parameters.strand_ratio = 1.00f; // i.e. don't reduce strands.
+            parameters.dual_scattering = false;
+            parameters.quantized_thickness = hair_style.get_quantized_thickness();
             parameters.hair_color = hair_style.get_default_color();
 
             parameters.volume_resolution = glm::vec3 { 256,256,256 };
             parameters.volume_bounds = hair_style.get_bounding_box();
 
-            parameter_buffer = vk::UniformBuffer {
-                vulkan_renderer.device,
-                parameters
-            };
+            parameter_buffer = &vulkan_renderer.strand_parameters;
 
-            vk::DebugMarker::object_name(vulkan_renderer.device, parameter_buffer, VK_OBJECT_TYPE_BUFFER, "Hair Parameters Buffer", id);
+            update_parameters();
 
-            auto strand_volume = hair_style.voxelize_segments(256, 256, 256);
+            vkhr::HairStyle::Volume strand_volume;
+            strand_volume.resolution = parameters.volume_resolution;
+            strand_volume.bounds = hair_style.get_bounding_box();
 
-            strand_volume.normalize();
+            auto volume_cache_path = hair_style.get_volume_cache_path();
+
+            // Voxelizing and normalizing it is most of the load time, so it's cached.
+            if (!vkhr::HairStyle::cache_is_current(volume_cache_path, hair_style.get_file_path()) ||
+                !strand_volume.load(volume_cache_path) || strand_volume.tangents.empty()) {
+                strand_volume = hair_style.voxelize_segments(256, 256, 256, vkhr::HairStyle::Volume::Layout::Bricked);
+                strand_volume.normalize();
+                strand_volume.save(volume_cache_path);
+            }
 
             density_sampler = vk::Sampler {
                 vulkan_renderer.device,
@@ -86,18 +260,19 @@ namespace vkhr {
 
             vk::DebugMarker::object_name(vulkan_renderer.device, density_sampler, VK_OBJECT_TYPE_SAMPLER, "Hair Density Sampler", id);
 
-            VkDeviceSize density_length = parameters.volume_resolution.x *
-                                          parameters.volume_resolution.y * 
-                                          parameters.volume_resolution.z *
-                                          sizeof(unsigned char); // bytes.
+            LargeBuffer<unsigned char> density_pool;
+            LargeBuffer<glm::i8vec2>   tangent_pool;
+
+            // Only the bricks near strands are kept, see sample_volume.glsl.
+            auto pool_resolution = create_brick_pool(strand_volume, density_pool, tangent_pool, vulkan_renderer);
 
             density_volume = vk::DeviceImage {
                 vulkan_renderer.device,
-                static_cast<std::uint32_t>(parameters.volume_resolution.x),
-                static_cast<std::uint32_t>(parameters.volume_resolution.y),
-                static_cast<std::uint32_t>(parameters.volume_resolution.z),
+                pool_resolution.x,
+                pool_resolution.y,
+                pool_resolution.z,
                 vulkan_renderer.command_pool,
-                strand_volume.densities
+                density_pool
             };
 
             vk::DebugMarker::object_name(vulkan_renderer.device, density_volume, VK_OBJECT_TYPE_IMAGE, "Hair Density Volume", id);
@@ -109,6 +284,14 @@ namespace vkhr {
 
             vk::DebugMarker::object_name(vulkan_renderer.device, density_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Hair Density View", id);
 
+            density_storage_view = vk::ImageView {
+                vulkan_renderer.device,
+                density_volume,
+                VK_IMAGE_LAYOUT_GENERAL
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, density_storage_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Hair Density Storage View", id);
+
             tangent_sampler = vk::Sampler {
                 vulkan_renderer.device,
                 VK_FILTER_LINEAR,      VK_FILTER_LINEAR,
@@ -121,11 +304,11 @@ namespace vkhr {
 
             tangent_volume = vk::DeviceImage {
                 vulkan_renderer.device,
-                static_cast<std::uint32_t>(parameters.volume_resolution.x),
-                static_cast<std::uint32_t>(parameters.volume_resolution.y),
-                static_cast<std::uint32_t>(parameters.volume_resolution.z),
+                pool_resolution.x,
+                pool_resolution.y,
+                pool_resolution.z,
                 vulkan_renderer.command_pool,
-                strand_volume.tangents
+                tangent_pool
             };
 
             vk::DebugMarker::object_name(vulkan_renderer.device, tangent_volume, VK_OBJECT_TYPE_IMAGE, "Hair Tangent Volume", id);
@@ -137,283 +320,2936 @@ namespace vkhr {
 
             vk::DebugMarker::object_name(vulkan_renderer.device, tangent_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Hair Tangent View", id);
 
-            volume = Volume {
-                *this,
-                vulkan_renderer
+            tangent_storage_view = vk::ImageView {
+                vulkan_renderer.device,
+                tangent_volume,
+                VK_IMAGE_LAYOUT_GENERAL
             };
 
-            ++id;
-        }
+            vk::DebugMarker::object_name(vulkan_renderer.device, tangent_storage_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Hair Tangent Storage View", id);
 
-        void HairStyle::voxelize(Pipeline& voxel_pipeline, vk::DescriptorSet& descriptor_set, vk::CommandBuffer& command_buffer) {
-            density_volume.transition(command_buffer,
-                                      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
-                                      VK_ACCESS_TRANSFER_WRITE_BIT,
-                                      VK_IMAGE_LAYOUT_GENERAL,
-                                      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-                                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+            glm::uvec3 mip_resolution { glm::uvec3 { parameters.volume_resolution } / MipScale };
+            std::uint32_t mip_levels = static_cast<std::uint32_t>(std::log2(std::max({ mip_resolution.x, mip_resolution.y, mip_resolution.z }))) + 1;
 
-            // command_buffer.clear_color_image(density_volume, { /* 0 */ });
+            // Filled in by the voxelization, like the pools.
+            LargeBuffer<unsigned char> mip_densities(mip_resolution.x * mip_resolution.y * mip_resolution.z, 0);
+            LargeBuffer<glm::i8vec2>   mip_tangents(mip_densities.size(), glm::i8vec2 { 0, 0 });
 
-            density_volume.transition(command_buffer,
-                                      VK_ACCESS_TRANSFER_WRITE_BIT,
-                                      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
-                                      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                      VK_IMAGE_LAYOUT_GENERAL,
-                                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-                                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+            mip_sampler = vk::Sampler {
+                vulkan_renderer.device,
+                VK_FILTER_LINEAR,      VK_FILTER_LINEAR,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                true, false,
+                static_cast<float>(mip_levels)
+            };
 
-            descriptor_set.write(0, vertices);
-            descriptor_set.write(2, parameter_buffer);
-            descriptor_set.write(3, density_view);
+            vk::DebugMarker::object_name(vulkan_renderer.device, mip_sampler, VK_OBJECT_TYPE_SAMPLER, "Hair Volume Mip Sampler", id);
 
-            command_buffer.bind_descriptor_set(descriptor_set, voxel_pipeline);
-            command_buffer.dispatch((vertices.count()*parameters.strand_ratio) / 512);
-        }
+            density_mips = vk::DeviceImage {
+                vulkan_renderer.device,
+                mip_resolution.x,
+                mip_resolution.y,
+                mip_resolution.z,
+                vulkan_renderer.command_pool,
+                mip_densities,
+                mip_levels
+            };
 
-        void HairStyle::draw_volume(Pipeline& pipeline, vk::DescriptorSet& descriptor_set, vk::CommandBuffer& command_buffer) {
-            volume.set_current_volume(density_view, tangent_view);
-            volume.set_volume_parameters(parameter_buffer);
-            volume.set_volume_sampler(density_sampler, tangent_sampler);
-            volume.draw(pipeline, descriptor_set, command_buffer);
-        }
+            vk::DebugMarker::object_name(vulkan_renderer.device, density_mips, VK_OBJECT_TYPE_IMAGE, "Hair Density Mips", id);
 
-        void HairStyle::draw(Pipeline& pipeline, vk::DescriptorSet& descriptor_set, vk::CommandBuffer& command_buffer) {
-            if (descriptor_set.get_layout().get_bindings().size()) {
-                descriptor_set.write(2, parameter_buffer);
-                descriptor_set.write(3, density_view, density_sampler);
+            density_mips_view = vk::ImageView {
+                vulkan_renderer.device,
+                density_mips,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                0, mip_levels
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, density_mips_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Hair Density Mips View", id);
+
+            tangent_mips = vk::DeviceImage {
+                vulkan_renderer.device,
+                mip_resolution.x,
+                mip_resolution.y,
+                mip_resolution.z,
+                vulkan_renderer.command_pool,
+                mip_tangents,
+                mip_levels
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, tangent_mips, VK_OBJECT_TYPE_IMAGE, "Hair Tangent Mips", id);
+
+            tangent_mips_view = vk::ImageView {
+                vulkan_renderer.device,
+                tangent_mips,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                0, mip_levels
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, tangent_mips_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Hair Tangent Mips View", id);
+
+            density_mip_storage_views.clear();
+            tangent_mip_storage_views.clear();
+
+            // One for each level, since they're written by downsample_volume.comp one at a time.
+            for (std::uint32_t level { 0 }; level < mip_levels; ++level) {
+                density_mip_storage_views.emplace_back(vulkan_renderer.device, density_mips, VK_IMAGE_LAYOUT_GENERAL, level);
+                vk::DebugMarker::object_name(vulkan_renderer.device, density_mip_storage_views.back(), VK_OBJECT_TYPE_IMAGE_VIEW,
+                                             "Hair Density Mip Storage View", id);
+                tangent_mip_storage_views.emplace_back(vulkan_renderer.device, tangent_mips, VK_IMAGE_LAYOUT_GENERAL, level);
+                vk::DebugMarker::object_name(vulkan_renderer.device, tangent_mip_storage_views.back(), VK_OBJECT_TYPE_IMAGE_VIEW,
+                                             "Hair Tangent Mip Storage View", id);
             }
 
-            command_buffer.set_line_width(parameters.strand_radius);
+            // Fully lit until the first voxelization, since it's sampled whenever it's the shadow technique.
+            LargeBuffer<unsigned char> transmittances(mip_densities.size(), 255);
+
+            transmittance_volume = vk::DeviceImage {
+                vulkan_renderer.device,
+                mip_resolution.x,
+                mip_resolution.y,
+                mip_resolution.z,
+                vulkan_renderer.command_pool,
+                transmittances
+            };
 
-            command_buffer.bind_descriptor_set(descriptor_set, pipeline);
+            vk::DebugMarker::object_name(vulkan_renderer.device, transmittance_volume, VK_OBJECT_TYPE_IMAGE, "Hair Transmittance Volume", id);
 
-            command_buffer.bind_vertex_buffer(0, vertices,  0);
-            command_buffer.bind_vertex_buffer(1, tangents,  0);
-            command_buffer.bind_vertex_buffer(2, thickness, 0);
+            transmittance_view = vk::ImageView {
+                vulkan_renderer.device,
+                transmittance_volume,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+            };
 
-            command_buffer.bind_index_buffer(segments);
+            vk::DebugMarker::object_name(vulkan_renderer.device, transmittance_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Hair Transmittance View", id);
 
-            command_buffer.draw_indexed(segments.count() * parameters.strand_ratio);
-        }
+            transmittance_storage_view = vk::ImageView {
+                vulkan_renderer.device,
+                transmittance_volume,
+                VK_IMAGE_LAYOUT_GENERAL
+            };
 
-        void HairStyle::update_parameters() {
-            parameter_buffer.update(parameters);
-        }
+            vk::DebugMarker::object_name(vulkan_renderer.device, transmittance_storage_view, VK_OBJECT_TYPE_IMAGE_VIEW,
+                                         "Hair Transmittance Storage View", id);
 
-        void HairStyle::build_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
-            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+            LargeBuffer<unsigned char> ambient_occlusions(mip_densities.size(), 255); // unoccluded, as above.
 
-            pipeline.fixed_stages.add_vertex_binding({ 0, 0, VK_FORMAT_R32G32B32_SFLOAT, sizeof(glm::vec3) });
-            pipeline.fixed_stages.add_vertex_binding({ 1, 1, VK_FORMAT_R32G32B32_SFLOAT, sizeof(glm::vec3) });
-            pipeline.fixed_stages.add_vertex_binding({ 2, 2, VK_FORMAT_R32_SFLOAT,       sizeof(float)     });
+            ambient_occlusion_volume = vk::DeviceImage {
+                vulkan_renderer.device,
+                mip_resolution.x,
+                mip_resolution.y,
+                mip_resolution.z,
+                vulkan_renderer.command_pool,
+                ambient_occlusions
+            };
 
-            pipeline.fixed_stages.set_topology(VK_PRIMITIVE_TOPOLOGY_LINE_LIST);
+            vk::DebugMarker::object_name(vulkan_renderer.device, ambient_occlusion_volume, VK_OBJECT_TYPE_IMAGE, "Hair AO Volume", id);
 
-            pipeline.fixed_stages.set_scissor({ 0, 0, vulkan_renderer.swap_chain.get_extent() });
-            pipeline.fixed_stages.set_viewport({ 0.0, 0.0,
-                                                 static_cast<float>(vulkan_renderer.swap_chain.get_width()),
-                                                 static_cast<float>(vulkan_renderer.swap_chain.get_height()),
-                                                 0.0, 1.0 });
+            ambient_occlusion_view = vk::ImageView {
+                vulkan_renderer.device,
+                ambient_occlusion_volume,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+            };
 
-            pipeline.fixed_stages.add_dynamic_state(VK_DYNAMIC_STATE_LINE_WIDTH);
+            vk::DebugMarker::object_name(vulkan_renderer.device, ambient_occlusion_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Hair AO View", id);
 
-            pipeline.fixed_stages.set_line_width(1.0);
-            pipeline.fixed_stages.enable_alpha_blending_for(0);
-            pipeline.fixed_stages.enable_depth_test(false);
+            ambient_occlusion_storage_view = vk::ImageView {
+                vulkan_renderer.device,
+                ambient_occlusion_volume,
+                VK_IMAGE_LAYOUT_GENERAL
+            };
 
-            std::uint32_t light_count = vulkan_renderer.shadow_maps.size();
+            vk::DebugMarker::object_name(vulkan_renderer.device, ambient_occlusion_storage_view, VK_OBJECT_TYPE_IMAGE_VIEW,
+                                         "Hair AO Storage View", id);
 
-            struct Constants {
-                std::uint32_t light_size;
-            } constant_data {
-                light_count
+            // Nothing is skipped until the first voxelization, as if every cell had strands in it.
+            LargeBuffer<unsigned char> distances(mip_densities.size(), 0);
+
+            distance_field = vk::DeviceImage {
+                vulkan_renderer.device,
+                mip_resolution.x,
+                mip_resolution.y,
+                mip_resolution.z,
+                vulkan_renderer.command_pool,
+                distances
             };
 
-            std::vector<VkSpecializationMapEntry> constants {
-                { 0, 0, sizeof(std::uint32_t) } // light size
+            vk::DebugMarker::object_name(vulkan_renderer.device, distance_field, VK_OBJECT_TYPE_IMAGE, "Hair Distance Field", id);
+
+            distance_field_view = vk::ImageView {
+                vulkan_renderer.device,
+                distance_field,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
             };
 
-            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("strands/strand.vert"));
-            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0], VK_OBJECT_TYPE_SHADER_MODULE, "Hair Vertex Shader");
-            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("strands/strand.frag"), constants, &constant_data, sizeof(constant_data));
-            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[1], VK_OBJECT_TYPE_SHADER_MODULE, "Hair Fragment Shader");
+            vk::DebugMarker::object_name(vulkan_renderer.device, distance_field_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Hair Distance Field View", id);
 
-            std::vector<vk::DescriptorSet::Binding> descriptor_bindings {
-                { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
-                { 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
-                { 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
-                { 3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
-                { 4, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
-                { 5, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE },
-                { 6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
-                { 7, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
-                { 8, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER }
+            distance_field_storage_view = vk::ImageView {
+                vulkan_renderer.device,
+                distance_field,
+                VK_IMAGE_LAYOUT_GENERAL
             };
 
-            for (std::uint32_t i { 0 }; i < light_count; ++i)
-                descriptor_bindings.push_back({ 9 + i, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER });
+            vk::DebugMarker::object_name(vulkan_renderer.device, distance_field_storage_view, VK_OBJECT_TYPE_IMAGE_VIEW,
+                                         "Hair Distance Field Storage View", id);
 
-            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
-                vulkan_renderer.device, descriptor_bindings
+            occupancy_sampler = vk::Sampler {
+                vulkan_renderer.device,
+                VK_FILTER_NEAREST,     VK_FILTER_NEAREST,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE
             };
 
-            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Hair Descriptor Set Layout");
+            vk::DebugMarker::object_name(vulkan_renderer.device, occupancy_sampler, VK_OBJECT_TYPE_SAMPLER, "Hair Occupancy Sampler", id);
 
-            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.swap_chain.size(),
-                                                                                pipeline.descriptor_set_layout,
-                                                                                "Hair Descriptor Set");
+            glm::uvec3 occupancy_resolution { (glm::uvec3 { parameters.volume_resolution } + BrickSize - 1u) / BrickSize };
 
-            for (std::size_t i { 0 }; i < pipeline.descriptor_sets.size(); ++i) {
-                pipeline.descriptor_sets[i].write(0, vulkan_renderer.camera[i]);
-                pipeline.descriptor_sets[i].write(1, vulkan_renderer.lights[i]);
-                pipeline.descriptor_sets[i].write(4, vulkan_renderer.params[i]);
+            // Filled in by the voxelization, which runs before anyone samples it.
+            occupancy_volume = vk::DeviceImage {
+                vulkan_renderer.device,
+                occupancy_resolution.x,
+                occupancy_resolution.y,
+                occupancy_resolution.z,
+                occupancy_resolution.x * occupancy_resolution.y * occupancy_resolution.z * sizeof(std::uint32_t),
+                vulkan_renderer.command_pool,
+                VK_FORMAT_R32_UINT
+            };
 
-                pipeline.descriptor_sets[i].write(5, vulkan_renderer.ppll.get_heads_view());
-                pipeline.descriptor_sets[i].write(6, vulkan_renderer.ppll.get_nodes());
-                pipeline.descriptor_sets[i].write(7, vulkan_renderer.ppll.get_parameters());
-                pipeline.descriptor_sets[i].write(8, vulkan_renderer.ppll.get_node_counter());
+            vk::DebugMarker::object_name(vulkan_renderer.device, occupancy_volume, VK_OBJECT_TYPE_IMAGE, "Hair Occupancy Volume", id);
 
-                for (std::uint32_t j { 0 }; j < light_count; ++j)
-                    pipeline.descriptor_sets[i].write(9 + j, vulkan_renderer.shadow_maps[j].get_image_view(),
-                                                      vulkan_renderer.shadow_maps[j].get_sampler());
+            occupancy_view = vk::ImageView {
+                vulkan_renderer.device,
+                occupancy_volume,
+                VK_IMAGE_LAYOUT_GENERAL
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, occupancy_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Hair Occupancy View", id);
+
+            vkhr::HairStyle::Volume occlusion {
+                glm::vec3 { vkhr::HairStyle::BakedResolution },
+                parameters.volume_bounds
+            };
+
+            // The shaders fall back to the LAO when they see it's only a voxel.
+            if (!occlusion.load(hair_style.get_ambient_occlusion_path())) {
+                occlusion.resolution = glm::vec3 { 1, 1, 1 };
+                occlusion.densities  = { 255 };
             }
 
-            pipeline.pipeline_layout = vk::Pipeline::Layout {
+            occlusion_sampler = vk::Sampler {
                 vulkan_renderer.device,
-                pipeline.descriptor_set_layout,
-                {
-                    { VK_SHADER_STAGE_ALL, 0, sizeof(glm::mat4) } // model.
-                }
+                VK_FILTER_LINEAR,      VK_FILTER_LINEAR,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE
             };
 
-            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Hair Pipeline Layout");
+            vk::DebugMarker::object_name(vulkan_renderer.device, occlusion_sampler, VK_OBJECT_TYPE_SAMPLER, "Hair Occlusion Sampler", id);
 
-            pipeline.pipeline = vk::GraphicsPipeline {
+            occlusion_volume = vk::DeviceImage {
                 vulkan_renderer.device,
-                pipeline.shader_stages,
-                pipeline.fixed_stages,
-                pipeline.pipeline_layout,
-                vulkan_renderer.color_pass
+                static_cast<std::uint32_t>(occlusion.resolution.x),
+                static_cast<std::uint32_t>(occlusion.resolution.y),
+                static_cast<std::uint32_t>(occlusion.resolution.z),
+                vulkan_renderer.command_pool,
+                occlusion.densities
             };
 
-            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline, VK_OBJECT_TYPE_PIPELINE, "Hair Graphics Pipeline");
-        }
+            vk::DebugMarker::object_name(vulkan_renderer.device, occlusion_volume, VK_OBJECT_TYPE_IMAGE, "Hair Occlusion Volume", id);
 
-        void HairStyle::depth_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
-            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+            occlusion_view = vk::ImageView {
+                vulkan_renderer.device,
+                occlusion_volume
+            };
 
-            pipeline.fixed_stages.add_vertex_binding({ 0, 0, VK_FORMAT_R32G32B32_SFLOAT, sizeof(glm::vec3) });
+            vk::DebugMarker::object_name(vulkan_renderer.device, occlusion_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Hair Occlusion View", id);
 
-            pipeline.fixed_stages.set_scissor({ 0, 0, vulkan_renderer.swap_chain.get_extent() });
-            pipeline.fixed_stages.set_viewport({ 0.0, 0.0,
-                                                 static_cast<float>(vulkan_renderer.swap_chain.get_width()),
-                                                 static_cast<float>(vulkan_renderer.swap_chain.get_height()),
-                                                 0.0, 1.0 });
+            vkhr::HairStyle::Impostor impostor;
 
-            pipeline.fixed_stages.set_topology(VK_PRIMITIVE_TOPOLOGY_LINE_LIST);
+            // Otherwise the farthest nodes are raymarched like the others.
+            impostor_loaded = impostor.load(hair_style.get_impostor_path());
 
-            pipeline.fixed_stages.add_dynamic_state(VK_DYNAMIC_STATE_VIEWPORT);
-            pipeline.fixed_stages.add_dynamic_state(VK_DYNAMIC_STATE_LINE_WIDTH);
-            pipeline.fixed_stages.add_dynamic_state(VK_DYNAMIC_STATE_SCISSOR);
+            if (impostor_loaded) {
+                impostor_occlusion = vk::DeviceImage {
+                    vulkan_renderer.device,
+                    vulkan_renderer.command_pool,
+                    impostor.occlusion
+                };
 
-            pipeline.fixed_stages.set_culling_mode(VK_CULL_MODE_BACK_BIT);
+                vk::DebugMarker::object_name(vulkan_renderer.device, impostor_occlusion, VK_OBJECT_TYPE_IMAGE, "Hair Impostor Occlusion", id);
 
-            pipeline.fixed_stages.set_line_width(1.0);
-            pipeline.fixed_stages.enable_depth_test();
+                impostor_occlusion_view = vk::ImageView {
+                    vulkan_renderer.device,
+                    impostor_occlusion
+                };
 
-            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("self-shadowing/depth_map.vert"));
+                vk::DebugMarker::object_name(vulkan_renderer.device, impostor_occlusion_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Hair Impostor Occlusion View", id);
 
-            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0], VK_OBJECT_TYPE_SHADER_MODULE, "Hair Depth Shader");
+                impostor_tangents = vk::DeviceImage {
+                    vulkan_renderer.device,
+                    vulkan_renderer.command_pool,
+                    impostor.tangents
+                };
 
-            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
-                vulkan_renderer.device
-            };
+                vk::DebugMarker::object_name(vulkan_renderer.device, impostor_tangents, VK_OBJECT_TYPE_IMAGE, "Hair Impostor Tangents", id);
 
-            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Hair Depth Descriptor Set Layout");
+                impostor_tangents_view = vk::ImageView {
+                    vulkan_renderer.device,
+                    impostor_tangents
+                };
 
-            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.swap_chain.size(),
-                                                                                pipeline.descriptor_set_layout,
-                                                                                "Hair Depth Descriptor Set");
+                vk::DebugMarker::object_name(vulkan_renderer.device, impostor_tangents_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Hair Impostor Tangents View", id);
 
-            pipeline.pipeline_layout = vk::Pipeline::Layout {
-                vulkan_renderer.device,
-                pipeline.descriptor_set_layout,
-                {
-                    { VK_SHADER_STAGE_ALL, 0, sizeof(glm::mat4) } // transforms.
-                }
-            };
+                impostor_sampler = vk::Sampler {
+                    vulkan_renderer.device,
+                    VK_FILTER_LINEAR,      VK_FILTER_LINEAR,
+                    VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                    VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                    VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE
+                };
 
-            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Hair Depth Pipeline Layout");
+                vk::DebugMarker::object_name(vulkan_renderer.device, impostor_sampler, VK_OBJECT_TYPE_SAMPLER, "Hair Impostor Sampler", id);
+            }
 
-            pipeline.pipeline = vk::GraphicsPipeline {
-                vulkan_renderer.device,
-                pipeline.shader_stages,
-                pipeline.fixed_stages,
-                pipeline.pipeline_layout,
-                vulkan_renderer.depth_pass
+            volume = Volume {
+                *this,
+                vulkan_renderer
             };
 
-            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline, VK_OBJECT_TYPE_PIPELINE, "Hair Depth Graphics Pipeline");
+            ++id;
         }
 
-        void HairStyle::voxel_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
-            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+        glm::uvec3 HairStyle::create_brick_pool(const vkhr::HairStyle::Volume& strand_volume,
+                                                LargeBuffer<unsigned char>& density_pool,
+                                                LargeBuffer<glm::i8vec2>& tangent_pool,
+                                                Rasterizer& vulkan_renderer) {
+            glm::ivec3 resolution { strand_volume.resolution };
+            glm::ivec3 bricks { (resolution + static_cast<int>(BrickSize) - 1) / static_cast<int>(BrickSize) };
 
-            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("volumes/voxelize.comp"));
+            std::size_t brick_count = bricks.x * bricks.y * bricks.z;
 
-            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0],
-                                         VK_OBJECT_TYPE_SHADER_MODULE, "Hair Voxelization Shader");
+            std::vector<unsigned char> occupied(brick_count, 0);
 
-            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
-                vulkan_renderer.device,
-                {
-                    { 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
-                    { 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
-                    { 3, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE  }
+            for (int z { 0 }; z < resolution.z; ++z)
+            for (int y { 0 }; y < resolution.y; ++y)
+            for (int x { 0 }; x < resolution.x; ++x) {
+                if (strand_volume.densities[strand_volume.get_index(glm::uvec3(x, y, z))] != 0) {
+                    glm::ivec3 brick { glm::ivec3 { x, y, z } / static_cast<int>(BrickSize) };
+                    occupied[brick.x + brick.y*bricks.x + brick.z*bricks.x*bricks.y] = 1;
                 }
-            };
+            }
 
-            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout,
-                                         VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Hair Voxel Descriptor Set Layout");
-            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.swap_chain.size(),
-                                                                                pipeline.descriptor_set_layout,
-                                                                                "Hair Voxel Descriptor Set");
+            // Slot + 1 of each brick, and then the brick of each of the slots.
+            std::vector<std::uint32_t> brick_slots(brick_count, 0);
+            std::vector<std::uint32_t> slot_bricks;
+
+            // Dilated by a brick, so the strands can move around a bit with the simulation.
+            for (int z { 0 }; z < bricks.z; ++z)
+            for (int y { 0 }; y < bricks.y; ++y)
+            for (int x { 0 }; x < bricks.x; ++x) {
+                bool near_strands { false };
+
+                for (int k { std::max(z - 1, 0) }; k <= std::min(z + 1, bricks.z - 1); ++k)
+                for (int j { std::max(y - 1, 0) }; j <= std::min(y + 1, bricks.y - 1); ++j)
+                for (int i { std::max(x - 1, 0) }; i <= std::min(x + 1, bricks.x - 1); ++i)
+                    near_strands |= occupied[i + j*bricks.x + k*bricks.x*bricks.y] != 0;
+
+                if (near_strands) {
+                    std::uint32_t brick = x + y*bricks.x + z*bricks.x*bricks.y;
+                    slot_bricks.push_back(brick);
+                    brick_slots[brick] = static_cast<std::uint32_t>(slot_bricks.size());
+                }
+            }
 
-            pipeline.pipeline_layout = vk::Pipeline::Layout {
-                vulkan_renderer.device,
-                pipeline.descriptor_set_layout
-            };
+            brick_slot_count = static_cast<std::uint32_t>(slot_bricks.size());
 
-            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout,
-                                         VK_OBJECT_TYPE_PIPELINE_LAYOUT,
-                                         "Hair Voxel Pipeline Layout");
+            const int pool_brick = BrickSize + 2 * BrickApron;
+            const int pool_width = BrickPoolWidth;
 
-            pipeline.compute_pipeline = vk::ComputePipeline {
-                vulkan_renderer.device,
-                pipeline.shader_stages[0],
-                pipeline.pipeline_layout
-            };
+            std::uint32_t pool_layers = std::max((brick_slot_count + BrickPoolWidth*BrickPoolWidth - 1) / (BrickPoolWidth*BrickPoolWidth), 1u);
+            glm::uvec3 pool_resolution { BrickPoolWidth * pool_brick, BrickPoolWidth * pool_brick, pool_layers * pool_brick };
 
-            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.compute_pipeline,
-                                         VK_OBJECT_TYPE_PIPELINE, "Hair Voxel Pipeline");
-        }
+            density_pool.assign(pool_resolution.x * pool_resolution.y * pool_resolution.z, 0);
+            tangent_pool.assign(pool_resolution.x * pool_resolution.y * pool_resolution.z, glm::i8vec2 { 0, 0 });
 
-        void HairStyle::reduce(float ratio) {
-            parameters.strand_ratio = ratio;
-        }
+            JobSystem::get().parallel_for(0, static_cast<int>(brick_slot_count), 1, [&](int slot) {
+                int brick_index = slot_bricks[slot];
+                glm::ivec3 brick { brick_index % bricks.x, (brick_index / bricks.x) % bricks.y, brick_index / (bricks.x * bricks.y) };
+                glm::ivec3 pool_offset { slot % pool_width, (slot / pool_width) % pool_width, slot / (pool_width * pool_width) };
+
+                pool_offset *= pool_brick;
+
+                for (int z { 0 }; z < pool_brick; ++z)
+                for (int y { 0 }; y < pool_brick; ++y)
+                for (int x { 0 }; x < pool_brick; ++x) {
+                    glm::ivec3 voxel { brick * static_cast<int>(BrickSize) + glm::ivec3 { x, y, z } - static_cast<int>(BrickApron) };
+
+                    if (glm::any(glm::lessThan(voxel, glm::ivec3 { 0 })) || glm::any(glm::greaterThanEqual(voxel, resolution)))
+                        continue; // the apron outside of the volume is empty.
+
+                    std::size_t voxel_index = strand_volume.get_index(glm::uvec3 { voxel });
+
+                    glm::ivec3 texel { pool_offset + glm::ivec3 { x, y, z } };
+                    std::size_t texel_index = texel.x + texel.y*pool_resolution.x + texel.z*pool_resolution.x*pool_resolution.y;
+
+                    density_pool[texel_index] = strand_volume.densities[voxel_index];
+                    tangent_pool[texel_index] = strand_volume.tangents[voxel_index];
+                }
+            });
+
+            brick_slots.insert(brick_slots.end(), slot_bricks.begin(), slot_bricks.end());
+
+            volume_bricks = vk::StorageBuffer {
+                vulkan_renderer.device,
+                vulkan_renderer.command_pool,
+                brick_slots
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, volume_bricks, VK_OBJECT_TYPE_BUFFER, "Hair Volume Brick Buffer", id);
+
+            return pool_resolution;
+        }
+
+        void HairStyle::voxelize(Pipeline& voxel_pipeline, Pipeline& resolve_pipeline, Pipeline& mip_pipeline,
+                                 Pipeline& transmittance_pipeline, Pipeline& ambient_occlusion_pipeline,
+                                 Pipeline& distance_field_pipeline, std::uint32_t frame, vk::StorageBuffer& voxels, vk::StorageBuffer& voxel_statistics, vk::CommandBuffer& command_buffer,
+                                 std::uint32_t compute_queue_family, std::uint32_t graphics_queue_family) {
+            VkMemoryBarrier memory_barrier;
+            memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            memory_barrier.pNext = nullptr;
+
+            // The previous hair style might still be reading the counters.
+            memory_barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                            memory_barrier);
+
+            command_buffer.fill_buffer(voxels, 0, voxels.get_size(), 0);
+            command_buffer.fill_buffer(voxel_statistics, 0, sizeof(std::uint32_t), 0);
+
+            memory_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            memory_barrier);
+
+            auto& voxel_descriptor_set = voxel_pipeline.descriptor_sets[frame].with({
+                { 0, vertices },
+                { 1, quantization == vkhr::HairStyle::Quantization::Packed ? vertices : tangents }, // tangents can be packed.
+                { 4, segments },
+                { 5, voxels },
+                { 6, voxel_statistics }
+            });
+
+            command_buffer.bind_pipeline(voxel_pipeline);
+            command_buffer.bind_descriptor_set(voxel_descriptor_set, voxel_pipeline, { parameter_offset });
+
+            // Every strand, since the strand_ratio only reduces the ones that are rasterized.
+            std::uint32_t segment_count = segments.count() / 2;
+
+            command_buffer.dispatch((segment_count + 511) / 512); // one thread per segment.
+
+            memory_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            memory_barrier);
+
+            // The async compute queue can't wait on the fragment shader stage, the renderer
+            // makes sure the previous frame's reads are done with a semaphore in that case.
+            // Reads are from the raymarcher and strand shading, and the strand occlusion culling.
+            VkPipelineStageFlags reader_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+            VkAccessFlags reader_access = VK_ACCESS_SHADER_READ_BIT;
+
+            if (compute_queue_family == graphics_queue_family) {
+                if (compute_queue_family != VK_QUEUE_FAMILY_IGNORED) // the last transfer_volumes.
+                    reader_stage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+                compute_queue_family  = VK_QUEUE_FAMILY_IGNORED;
+                graphics_queue_family = VK_QUEUE_FAMILY_IGNORED;
+            } else {
+                reader_stage  = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+                reader_access = 0;
+            }
+
+            // The resolve overwrites every slot in the pools, so the old contents can be discarded.
+            density_volume.transition(command_buffer,
+                                      reader_access,
+                                      VK_ACCESS_SHADER_WRITE_BIT,
+                                      VK_IMAGE_LAYOUT_UNDEFINED,
+                                      VK_IMAGE_LAYOUT_GENERAL,
+                                      reader_stage,
+                                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+            tangent_volume.transition(command_buffer,
+                                      reader_access,
+                                      VK_ACCESS_SHADER_WRITE_BIT,
+                                      VK_IMAGE_LAYOUT_UNDEFINED,
+                                      VK_IMAGE_LAYOUT_GENERAL,
+                                      reader_stage,
+                                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+            occupancy_volume.transition(command_buffer,
+                                        reader_access,
+                                        VK_ACCESS_TRANSFER_WRITE_BIT,
+                                        VK_IMAGE_LAYOUT_UNDEFINED,
+                                        VK_IMAGE_LAYOUT_GENERAL,
+                                        reader_stage,
+                                        VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+            command_buffer.clear_color_image(occupancy_volume, { /* 0 */ });
+
+            occupancy_volume.transition(command_buffer,
+                                        VK_ACCESS_TRANSFER_WRITE_BIT,
+                                        VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                                        VK_IMAGE_LAYOUT_GENERAL,
+                                        VK_IMAGE_LAYOUT_GENERAL,
+                                        VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+            auto& resolve_descriptor_set = resolve_pipeline.descriptor_sets[frame].with({
+                { 3, density_storage_view },
+                { 5, voxels },
+                { 6, voxel_statistics },
+                { 7, tangent_storage_view },
+                { 8, occupancy_view },
+                { 29, volume_bricks }
+            });
+
+            command_buffer.bind_pipeline(resolve_pipeline);
+            command_buffer.bind_descriptor_set(resolve_descriptor_set, resolve_pipeline, { parameter_offset });
+
+            command_buffer.dispatch(brick_slot_count); // one group per allocated brick.
+
+            // The mip chains are built from the counters too, since the bricks don't cover all of the volume.
+            density_mips.transition(command_buffer,
+                                    reader_access,
+                                    VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                                    VK_IMAGE_LAYOUT_UNDEFINED,
+                                    VK_IMAGE_LAYOUT_GENERAL,
+                                    reader_stage,
+                                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+            tangent_mips.transition(command_buffer,
+                                    reader_access,
+                                    VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                                    VK_IMAGE_LAYOUT_UNDEFINED,
+                                    VK_IMAGE_LAYOUT_GENERAL,
+                                    reader_stage,
+                                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+            command_buffer.bind_pipeline(mip_pipeline);
+
+            for (std::uint32_t level { 0 }; level < density_mips.get_mip_levels(); ++level) {
+                if (level != 0) {
+                    memory_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+                    memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+                    command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                                    memory_barrier);
+                }
+
+                std::uint32_t previous_level = level != 0 ? level - 1 : 0; // not read for the first level.
+
+                auto& mip_descriptor_set = mip_pipeline.descriptor_sets[frame].with({
+                    { 3, density_mip_storage_views[level] },
+                    { 5, voxels },
+                    { 6, voxel_statistics },
+                    { 7, tangent_mip_storage_views[level] },
+                    { 8, density_mip_storage_views[previous_level] },
+                    { 9, tangent_mip_storage_views[previous_level] }
+                });
+
+                command_buffer.bind_descriptor_set(mip_descriptor_set, mip_pipeline, { parameter_offset });
+                command_buffer.push_constant(mip_pipeline, 0, level);
+
+                auto extent = density_mips.get_extent();
+
+                glm::uvec3 mip_extent { std::max(extent.width  >> level, 1u),
+                                        std::max(extent.height >> level, 1u),
+                                        std::max(extent.depth  >> level, 1u) };
+
+                command_buffer.dispatch((mip_extent.x + 3) / 4, // see downsample_volume.comp.
+                                        (mip_extent.y + 3) / 4,
+                                        (mip_extent.z + 3) / 4);
+            }
+
+            // The transmittance is integrated once per voxel from the light, rather than per fragment,
+            // and the AO is estimated once per voxel too. They read the first mip level, because it's
+            // dense, so we don't go through the bricks here (and the sampling is still in the layout).
+            memory_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            memory_barrier);
+
+            transmittance_volume.transition(command_buffer,
+                                            reader_access,
+                                            VK_ACCESS_SHADER_WRITE_BIT,
+                                            VK_IMAGE_LAYOUT_UNDEFINED,
+                                            VK_IMAGE_LAYOUT_GENERAL,
+                                            reader_stage,
+                                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+            ambient_occlusion_volume.transition(command_buffer,
+                                                reader_access,
+                                                VK_ACCESS_SHADER_WRITE_BIT,
+                                                VK_IMAGE_LAYOUT_UNDEFINED,
+                                                VK_IMAGE_LAYOUT_GENERAL,
+                                                reader_stage,
+                                                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+            auto& transmittance_descriptor_set = transmittance_pipeline.descriptor_sets[frame].with({
+                { 3, density_mip_storage_views[0] },
+                { 7, transmittance_storage_view }
+            });
+
+            command_buffer.bind_pipeline(transmittance_pipeline);
+            command_buffer.bind_descriptor_set(transmittance_descriptor_set, transmittance_pipeline, { parameter_offset });
+
+            auto transmittance_extent = transmittance_volume.get_extent();
+
+            command_buffer.dispatch((transmittance_extent.width  + 3) / 4, // see transmittance.comp.
+                                    (transmittance_extent.height + 3) / 4,
+                                    (transmittance_extent.depth  + 3) / 4);
+
+            auto& ambient_occlusion_descriptor_set = ambient_occlusion_pipeline.descriptor_sets[frame].with({
+                { 3, density_mip_storage_views[0], mip_sampler },
+                { 7, ambient_occlusion_storage_view }
+            });
+
+            command_buffer.bind_pipeline(ambient_occlusion_pipeline);
+            command_buffer.bind_descriptor_set(ambient_occlusion_descriptor_set, ambient_occlusion_pipeline, { parameter_offset });
+
+            auto ambient_occlusion_extent = ambient_occlusion_volume.get_extent();
+
+            command_buffer.dispatch((ambient_occlusion_extent.width  + 3) / 4, // see ambient_occlusion.comp.
+                                    (ambient_occlusion_extent.height + 3) / 4,
+                                    (ambient_occlusion_extent.depth  + 3) / 4);
+
+            // The distance field only needs the voxel counters, which are still there from the mips.
+            distance_field.transition(command_buffer,
+                                      reader_access,
+                                      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                                      VK_IMAGE_LAYOUT_UNDEFINED,
+                                      VK_IMAGE_LAYOUT_GENERAL,
+                                      reader_stage,
+                                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+            auto& distance_field_descriptor_set = distance_field_pipeline.descriptor_sets[frame].with({
+                { 5, voxels },
+                { 7, distance_field_storage_view }
+            });
+
+            command_buffer.bind_pipeline(distance_field_pipeline);
+            command_buffer.bind_descriptor_set(distance_field_descriptor_set, distance_field_pipeline, { parameter_offset });
+
+            auto distance_field_extent = distance_field.get_extent();
+
+            std::uint32_t distance_field_size[] { distance_field_extent.width,
+                                                  distance_field_extent.height,
+                                                  distance_field_extent.depth };
+
+            // One axis after the other, and each of them reads what the last one wrote along its lines.
+            for (std::uint32_t axis { 0 }; axis < 3; ++axis) {
+                if (axis != 0) {
+                    memory_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+                    memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+                    command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                                    memory_barrier);
+                }
+
+                command_buffer.push_constant(distance_field_pipeline, 0, axis);
+
+                auto lines_x = distance_field_size[axis == 0 ? 1 : 0];
+                auto lines_y = distance_field_size[axis == 2 ? 1 : 2];
+
+                command_buffer.dispatch((lines_x + 7) / 8, // see distance_field.comp.
+                                        (lines_y + 7) / 8);
+            }
+
+            density_volume.transition(command_buffer,
+                                      VK_ACCESS_SHADER_WRITE_BIT,
+                                      reader_access,
+                                      VK_IMAGE_LAYOUT_GENERAL,
+                                      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                      reader_stage,
+                                      compute_queue_family,
+                                      graphics_queue_family);
+
+            tangent_volume.transition(command_buffer,
+                                      VK_ACCESS_SHADER_WRITE_BIT,
+                                      reader_access,
+                                      VK_IMAGE_LAYOUT_GENERAL,
+                                      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                      reader_stage,
+                                      compute_queue_family,
+                                      graphics_queue_family);
+
+            occupancy_volume.transition(command_buffer,
+                                        VK_ACCESS_SHADER_WRITE_BIT,
+                                        reader_access,
+                                        VK_IMAGE_LAYOUT_GENERAL,
+                                        VK_IMAGE_LAYOUT_GENERAL,
+                                        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                        reader_stage,
+                                        compute_queue_family,
+                                        graphics_queue_family);
+
+            density_mips.transition(command_buffer,
+                                    VK_ACCESS_SHADER_WRITE_BIT,
+                                    reader_access,
+                                    VK_IMAGE_LAYOUT_GENERAL,
+                                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                    reader_stage,
+                                    compute_queue_family,
+                                    graphics_queue_family);
+
+            tangent_mips.transition(command_buffer,
+                                    VK_ACCESS_SHADER_WRITE_BIT,
+                                    reader_access,
+                                    VK_IMAGE_LAYOUT_GENERAL,
+                                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                    reader_stage,
+                                    compute_queue_family,
+                                    graphics_queue_family);
+
+            transmittance_volume.transition(command_buffer,
+                                            VK_ACCESS_SHADER_WRITE_BIT,
+                                            reader_access,
+                                            VK_IMAGE_LAYOUT_GENERAL,
+                                            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            reader_stage,
+                                            compute_queue_family,
+                                            graphics_queue_family);
+
+            ambient_occlusion_volume.transition(command_buffer,
+                                                VK_ACCESS_SHADER_WRITE_BIT,
+                                                reader_access,
+                                                VK_IMAGE_LAYOUT_GENERAL,
+                                                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                                reader_stage,
+                                                compute_queue_family,
+                                                graphics_queue_family);
+
+            distance_field.transition(command_buffer,
+                                      VK_ACCESS_SHADER_WRITE_BIT,
+                                      reader_access,
+                                      VK_IMAGE_LAYOUT_GENERAL,
+                                      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                      reader_stage,
+                                      compute_queue_family,
+                                      graphics_queue_family);
+        }
+
+        void HairStyle::acquire_volumes(std::uint32_t compute_queue_family, std::uint32_t graphics_queue_family,
+                                        vk::CommandBuffer& command_buffer) {
+            // Has to match the release barrier at the end of voxelize.
+            density_volume.transition(command_buffer,
+                                      0,
+                                      VK_ACCESS_SHADER_READ_BIT,
+                                      VK_IMAGE_LAYOUT_GENERAL,
+                                      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                      VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                      compute_queue_family,
+                                      graphics_queue_family);
+
+            tangent_volume.transition(command_buffer,
+                                      0,
+                                      VK_ACCESS_SHADER_READ_BIT,
+                                      VK_IMAGE_LAYOUT_GENERAL,
+                                      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                      VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                      compute_queue_family,
+                                      graphics_queue_family);
+
+            occupancy_volume.transition(command_buffer,
+                                        0,
+                                        VK_ACCESS_SHADER_READ_BIT,
+                                        VK_IMAGE_LAYOUT_GENERAL,
+                                        VK_IMAGE_LAYOUT_GENERAL,
+                                        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                        compute_queue_family,
+                                        graphics_queue_family);
+
+            density_mips.transition(command_buffer,
+                                    0,
+                                    VK_ACCESS_SHADER_READ_BIT,
+                                    VK_IMAGE_LAYOUT_GENERAL,
+                                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                    compute_queue_family,
+                                    graphics_queue_family);
+
+            tangent_mips.transition(command_buffer,
+                                    0,
+                                    VK_ACCESS_SHADER_READ_BIT,
+                                    VK_IMAGE_LAYOUT_GENERAL,
+                                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                    compute_queue_family,
+                                    graphics_queue_family);
+
+            transmittance_volume.transition(command_buffer,
+                                            0,
+                                            VK_ACCESS_SHADER_READ_BIT,
+                                            VK_IMAGE_LAYOUT_GENERAL,
+                                            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                            compute_queue_family,
+                                            graphics_queue_family);
+
+            ambient_occlusion_volume.transition(command_buffer,
+                                                0,
+                                                VK_ACCESS_SHADER_READ_BIT,
+                                                VK_IMAGE_LAYOUT_GENERAL,
+                                                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                                compute_queue_family,
+                                                graphics_queue_family);
+
+            distance_field.transition(command_buffer,
+                                      0,
+                                      VK_ACCESS_SHADER_READ_BIT,
+                                      VK_IMAGE_LAYOUT_GENERAL,
+                                      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                      VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                      compute_queue_family,
+                                      graphics_queue_family);
+        }
+
+        std::vector<vk::DeviceImage*> HairStyle::get_voxelized_volumes() {
+            return {
+                &density_volume,
+                &tangent_volume,
+                &occupancy_volume,
+                &density_mips,
+                &tangent_mips,
+                &transmittance_volume,
+                &ambient_occlusion_volume,
+                &distance_field
+            };
+        }
+
+        VkDeviceSize HairStyle::get_volume_transfer_size() {
+            VkDeviceSize size { 0 };
+            for (auto volume : get_voxelized_volumes())
+                volume->get_buffer_regions(size);
+            return size;
+        }
+
+        void HairStyle::transfer_volumes(vk::Buffer& peer_buffer, VkDeviceSize offset, vk::CommandBuffer& command_buffer) {
+            // After voxelize, which left them as if they were to be sampled, and read by nothing else.
+            for (auto volume : get_voxelized_volumes()) {
+                volume->transition(command_buffer,
+                                   VK_ACCESS_SHADER_WRITE_BIT,
+                                   VK_ACCESS_TRANSFER_READ_BIT,
+                                   volume->get_layout(),
+                                   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                   VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                   VK_PIPELINE_STAGE_TRANSFER_BIT);
+                command_buffer.copy_image_buffer(*volume, peer_buffer, volume->get_buffer_regions(offset));
+            }
+        }
+
+        void HairStyle::receive_volumes(vk::Buffer& peer_buffer, VkDeviceSize offset, vk::CommandBuffer& command_buffer) {
+            // The copies overwrite all of them, after the last frame's reads of them on this GPU.
+            for (auto volume : get_voxelized_volumes()) {
+                VkImageLayout sampled_layout { volume == &occupancy_volume ? VK_IMAGE_LAYOUT_GENERAL
+                                                                           : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+
+                volume->transition(command_buffer,
+                                   0,
+                                   VK_ACCESS_TRANSFER_WRITE_BIT,
+                                   VK_IMAGE_LAYOUT_UNDEFINED,
+                                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                   VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                   VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+                command_buffer.copy_buffer_image(peer_buffer, *volume, volume->get_buffer_regions(offset));
+
+                volume->transition(command_buffer,
+                                   VK_ACCESS_TRANSFER_WRITE_BIT,
+                                   VK_ACCESS_SHADER_READ_BIT,
+                                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                   sampled_layout,
+                                   VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                   VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+            }
+        }
+
+        void HairStyle::simulate(Pipeline& simulation_pipeline, Pipeline& interpolation_pipeline, Pipeline& bounds_pipeline,
+                                 std::uint32_t frame, const Simulation& simulation,
+                                 float time_step, float time, vk::CommandBuffer& command_buffer,
+                                 Model* collider, const glm::mat4& hair_to_collider) {
+            VkMemoryBarrier memory_barrier;
+            memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            memory_barrier.pNext = nullptr;
+
+            // The last frame might still be drawing (or voxelizing) the vertices.
+            memory_barrier.srcAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            memory_barrier);
+
+            bool collisions { simulation.collisions && collider && collider->has_distance_field() };
+
+            // The guides come first, so simulating them is just simulating fewer strands.
+            bool follow_hair { simulation.follow_hair && guide_count != 0 && guide_count < strand_count };
+            std::uint32_t simulated_strands { follow_hair ? guide_count : strand_count };
+
+            auto& simulation_descriptor_set = simulation_pipeline.descriptor_sets[frame].with({
+                { 0, vertices },
+                { 1, quantization == vkhr::HairStyle::Quantization::Packed ? vertices : tangents }, // tangents can be packed.
+                { 3, rest_positions },
+                { 4, previous_positions },
+                { 5, strands },
+                { 6, collisions ? collider->get_distance_field() : rest_positions } // unread without collisions.
+            });
+
+            command_buffer.bind_pipeline(simulation_pipeline);
+            command_buffer.bind_descriptor_set(simulation_descriptor_set, simulation_pipeline, { parameter_offset });
+
+            command_buffer.push_constant(simulation_pipeline, 0, SimulationConstants {
+                glm::vec4 { simulation.gravity, time_step },
+                glm::vec4 { simulation.wind_direction * simulation.wind_strength, time },
+                hair_to_collider,
+                simulation.damping,
+                simulation.global_stiffness,
+                simulation.global_range,
+                simulation.local_stiffness,
+                simulation.local_iterations,
+                simulated_strands,
+                simulation.collision_margin,
+                collisions
+            });
+
+            command_buffer.dispatch((simulated_strands + 63) / 64); // one thread per strand.
+
+            if (follow_hair) {
+                memory_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+                memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+                command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                                memory_barrier);
+
+                auto& interpolation_descriptor_set = interpolation_pipeline.descriptor_sets[frame].with({
+                    { 0, vertices },
+                    { 1, quantization == vkhr::HairStyle::Quantization::Packed ? vertices : tangents },
+                    { 3, rest_positions },
+                    { 5, strands },
+                    { 6, guides }
+                });
+
+                command_buffer.bind_pipeline(interpolation_pipeline);
+                command_buffer.bind_descriptor_set(interpolation_descriptor_set, interpolation_pipeline, { parameter_offset });
+
+                command_buffer.push_constant(interpolation_pipeline, 0, InterpolationConstants {
+                    guide_count,
+                    strand_count
+                });
+
+                command_buffer.dispatch((strand_count - guide_count + 63) / 64); // one per follower.
+            }
+
+            memory_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            memory_barrier);
+
+            // The clusters are culled with the bounds of the strands in their current pose, not at rest.
+            auto& bounds_descriptor_set = bounds_pipeline.descriptor_sets[frame].with({
+                { 0, vertices },
+                { 1, quantization == vkhr::HairStyle::Quantization::Packed ? vertices : tangents },
+                { 3, rest_positions },
+                { 4, segments },
+                { 5, strands },
+                { 6, clusters },
+                { 7, simulated_bounds }
+            });
+
+            command_buffer.bind_pipeline(bounds_pipeline);
+            command_buffer.bind_descriptor_set(bounds_descriptor_set, bounds_pipeline, { parameter_offset, parameter_offset });
+
+            command_buffer.push_constant(bounds_pipeline, 0, BoundsConstants { 0 });
+            command_buffer.dispatch(cluster_count); // one work group per cluster.
+
+            // The packed vertices are quantized in the volume_bounds, so they can't grow. Otherwise the
+            // voxelization, raymarcher and shading all follow the strands, without reading them back.
+            if (quantization != vkhr::HairStyle::Quantization::Packed) {
+                command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                                memory_barrier);
+
+                command_buffer.push_constant(bounds_pipeline, 0, BoundsConstants { 1 });
+                command_buffer.dispatch(1);
+            }
+
+            memory_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_SHADER_READ_BIT |
+                                           VK_ACCESS_UNIFORM_READ_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                            memory_barrier);
+        }
+
+        void HairStyle::read_back_vertices(vk::Device& device, vk::CommandBuffer& command_buffer) {
+            if (vertex_readback.get_handle() == VK_NULL_HANDLE) {
+                vertex_readback = vk::HostBuffer { device, vertices.get_size(), VK_BUFFER_USAGE_TRANSFER_DST_BIT };
+                vk::DebugMarker::object_name(device, vertex_readback, VK_OBJECT_TYPE_BUFFER, "Hair Vertex Readback", id);
+
+                if (quantization != vkhr::HairStyle::Quantization::Packed) {
+                    tangent_readback = vk::HostBuffer { device, tangents.get_size(), VK_BUFFER_USAGE_TRANSFER_DST_BIT };
+                    vk::DebugMarker::object_name(device, tangent_readback, VK_OBJECT_TYPE_BUFFER, "Hair Tangent Readback", id);
+                }
+            }
+
+            command_buffer.copy_buffer(vertices, vertex_readback);
+
+            if (quantization != vkhr::HairStyle::Quantization::Packed)
+                command_buffer.copy_buffer(tangents, tangent_readback);
+
+            VkMemoryBarrier memory_barrier;
+            memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            memory_barrier.pNext = nullptr;
+            memory_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                            VK_PIPELINE_STAGE_HOST_BIT,
+                                            memory_barrier);
+        }
+
+        void HairStyle::fetch_vertices(const vkhr::HairStyle& hair_style, std::vector<glm::vec4>& position_thickness,
+                                       std::vector<glm::vec3>& tangents) {
+            if (vertex_readback.get_handle() == VK_NULL_HANDLE)
+                return; // it hasn't been read back.
+
+            auto vertex_count = vertex_readback.get_size() / (3 * sizeof(std::uint32_t)); // in both formats.
+            if (vertex_count != hair_style.get_vertex_count())
+                return; // from another style, which it's been loaded with since.
+
+            position_thickness.resize(vertex_count);
+            tangents.resize(vertex_count);
+
+            auto thickness = hair_style.get_thickness_span();
+            auto get_thickness = [&](std::size_t i) {
+                return hair_style.has_thickness() ? thickness[i] : 0.042f; // see create_position_thickness_data.
+            };
+
+            if (quantization == vkhr::HairStyle::Quantization::Packed) {
+                vkhr::HairStyle::QuantizedVertex* packed_vertices;
+                auto& vertex_memory = vertex_readback.get_device_memory();
+                vertex_memory.map(0, vertex_readback.get_size(), (void**) &packed_vertices);
+
+                // Decoded like decode_strand_position and decode_strand_tangent.
+                for (std::size_t i { 0 }; i < vertex_count; ++i) {
+                    glm::vec3 unorm { glm::vec3 { packed_vertices[i].position_thickness } / 65535.0f };
+                    position_thickness[i] = glm::vec4 { parameters.volume_bounds.origin + unorm * parameters.volume_bounds.size,
+                                                        get_thickness(i) };
+
+                    glm::vec2 octahedron { glm::max(glm::vec2 { packed_vertices[i].tangent } / 32767.0f, -1.0f) };
+                    glm::vec3 tangent { octahedron, 1.0f - std::abs(octahedron.x) - std::abs(octahedron.y) };
+                    if (tangent.z < 0.0f) {
+                        tangent.x = (1.0f - std::abs(octahedron.y)) * (octahedron.x >= 0.0f ? 1.0f : -1.0f);
+                        tangent.y = (1.0f - std::abs(octahedron.x)) * (octahedron.y >= 0.0f ? 1.0f : -1.0f);
+                    }
+
+                    tangents[i] = glm::normalize(tangent);
+                }
+
+                vertex_memory.unmap();
+            } else {
+                glm::vec3* positions;
+                glm::vec3* strand_tangents;
+
+                auto& vertex_memory = vertex_readback.get_device_memory();
+                auto& tangent_memory = tangent_readback.get_device_memory();
+
+                vertex_memory.map(0, vertex_readback.get_size(), (void**) &positions);
+                tangent_memory.map(0, tangent_readback.get_size(), (void**) &strand_tangents);
+
+                for (std::size_t i { 0 }; i < vertex_count; ++i) {
+                    position_thickness[i] = glm::vec4 { positions[i], get_thickness(i) };
+                    tangents[i] = strand_tangents[i];
+                }
+
+                vertex_memory.unmap();
+                tangent_memory.unmap();
+            }
+        }
+
+        void HairStyle::draw_volume(Pipeline& pipeline, vk::DescriptorSet& descriptor_set, vk::CommandBuffer& command_buffer) {
+            volume.set_current_volume(density_view, tangent_view, occupancy_view, occlusion_view, volume_bricks);
+            volume.set_volume_parameters(parameter_offset);
+            volume.set_volume_sampler(density_sampler, tangent_sampler, occupancy_sampler, occlusion_sampler);
+            volume.set_volume_mips(density_mips_view, tangent_mips_view, mip_sampler);
+            volume.set_volume_transmittance(transmittance_view, ambient_occlusion_view, mip_sampler);
+            volume.set_volume_distance_field(distance_field_view, occupancy_sampler);
+            volume.draw(pipeline, descriptor_set, command_buffer);
+        }
+
+        void HairStyle::draw_impostor(Pipeline& pipeline, vk::DescriptorSet& descriptor_set, vk::CommandBuffer& command_buffer,
+                                      std::uint32_t instance_count) {
+            command_buffer.bind_descriptor_set(descriptor_set.with({ { 57, impostor_occlusion_view, impostor_sampler },
+                                                                     { 58, impostor_tangents_view,  impostor_sampler } }),
+                                               pipeline, { parameter_offset });
+            command_buffer.draw(6, instance_count); // see billboard.glsl.
+        }
+
+        bool HairStyle::has_impostor() const {
+            return impostor_loaded;
+        }
+
+        void HairStyle::draw(Pipeline& pipeline, vk::DescriptorSet& descriptor_set, vk::CommandBuffer& command_buffer) {
+            bind(pipeline, descriptor_set, command_buffer);
+
+            auto& indices = pipeline.fixed_stages.get_topology() == VK_PRIMITIVE_TOPOLOGY_LINE_STRIP ? strips : segments;
+
+            command_buffer.bind_index_buffer(indices);
+
+            command_buffer.draw_indexed(indices.count() * parameters.strand_ratio);
+        }
+
+        void HairStyle::draw(Pipeline& pipeline, vk::DescriptorSet& descriptor_set, vk::CommandBuffer& command_buffer, std::uint32_t view,
+                             Expansion expansion, std::uint32_t instance_count) {
+            // The culled segments are only valid for the single node that they were culled for.
+            bool culled = instance_count == 1 && view < culled_views.size() && culled_views[view];
+
+            std::vector<vk::DescriptorSet::Write> pulled_writes;
+
+            if (expansion != Expansion::VertexInputs) {
+                pulled_writes.emplace_back(20, vertices);
+
+                if (quantization == vkhr::HairStyle::Quantization::Packed) {
+                    pulled_writes.emplace_back(21, vertices); // tangents are packed.
+                    pulled_writes.emplace_back(22, vertices); // and the thickness.
+                } else {
+                    pulled_writes.emplace_back(21, tangents);
+                    pulled_writes.emplace_back(22, get_thickness());
+                }
+
+                // Only quads read these, lines are drawn indexed as before.
+                if (expansion == Expansion::PulledQuads && culled && !mesh_shading)
+                    pulled_writes.emplace_back(23, culled_segments[view]);
+                else pulled_writes.emplace_back(23, segments);
+            }
+
+            if (expansion == Expansion::TessellatedCurves) {
+                bind(pipeline, descriptor_set, command_buffer, false, pulled_writes);
+
+                // Every segment is a patch, so the strand_ratio reduces them the same way.
+                std::uint32_t patch_count = (curve_patches.count() / 4) * parameters.strand_ratio;
+
+                command_buffer.bind_index_buffer(curve_patches);
+                command_buffer.draw_indexed(patch_count * 4, instance_count);
+
+                return;
+            }
+
+#ifdef VK_EXT_mesh_shader
+            if (expansion != Expansion::VertexInputs && mesh_shading) {
+                pulled_writes.emplace_back(24, clusters);
+
+                bind(pipeline, descriptor_set, command_buffer, false, pulled_writes);
+
+                // Culled in strand.task instead, for every instance.
+                command_buffer.draw_mesh_tasks((cluster_count + MeshTaskSize - 1) / MeshTaskSize, instance_count);
+
+                return;
+            }
+#endif
+
+            if (expansion == Expansion::PulledQuads) {
+                bind(pipeline, descriptor_set, command_buffer, false, pulled_writes);
+
+                if (culled) {
+                    command_buffer.draw_indirect(culled_draws[view], sizeof(VkDrawIndexedIndirectCommand));
+                } else {
+                    std::uint32_t segment_count = (segments.count() / 2) * parameters.strand_ratio;
+                    command_buffer.draw(segment_count * 6, instance_count); // two triangles per segment.
+                }
+
+                return;
+            }
+
+            bind(pipeline, descriptor_set, command_buffer, expansion == Expansion::VertexInputs, pulled_writes);
+
+            if (pipeline.fixed_stages.get_topology() == VK_PRIMITIVE_TOPOLOGY_LINE_STRIP) {
+                // Never culled, see Rasterizer::cull_strands. A partial strip is still a valid prefix.
+                command_buffer.bind_index_buffer(strips);
+                command_buffer.draw_indexed(strips.count() * parameters.strand_ratio, instance_count);
+            } else if (culled) {
+                command_buffer.bind_index_buffer(culled_segments[view], segments.get_type());
+                command_buffer.draw_indexed_indirect(culled_draws[view]);
+            } else {
+                command_buffer.bind_index_buffer(segments);
+                command_buffer.draw_indexed(segments.count() * parameters.strand_ratio, instance_count);
+            }
+        }
+
+        HairStyle::DrawState HairStyle::get_draw_state(std::uint32_t view) const {
+            bool culled = view < culled_views.size() && culled_views[view];
+            return DrawState {
+                parameters.strand_ratio,
+                parameters.strand_radius,
+                merged ? merged_level : 0,
+                (native_width        ? 1u : 0u) |
+                (software_rasterized ? 2u : 0u) |
+                (culled              ? 4u : 0u) |
+                (mesh_shading        ? 8u : 0u)
+            };
+        }
+
+        void HairStyle::bind(Pipeline& pipeline, vk::DescriptorSet& descriptor_set, vk::CommandBuffer& command_buffer,
+                             bool vertex_inputs, std::vector<vk::DescriptorSet::Write> writes) {
+            const auto& bindings = descriptor_set.get_layout().get_bindings();
+
+            // The depth pipeline doesn't sample the density (or occlusion) volume.
+            if (std::any_of(bindings.begin(), bindings.end(), [](const auto& binding) { return binding.id == 3; })) {
+                writes.emplace_back(3, density_view, density_sampler);
+                writes.emplace_back(29, volume_bricks);
+            }
+            if (std::any_of(bindings.begin(), bindings.end(), [](const auto& binding) { return binding.id == 16; }))
+                writes.emplace_back(16, occlusion_view, occlusion_sampler);
+            if (std::any_of(bindings.begin(), bindings.end(), [](const auto& binding) { return binding.id == 19; })) {
+                writes.emplace_back(14, ambient_occlusion_view, mip_sampler);
+                writes.emplace_back(19, transmittance_view, mip_sampler);
+            }
+
+            command_buffer.set_line_width(native_width ? 1.0f : parameters.strand_radius);
+
+            command_buffer.bind_descriptor_set(descriptor_set.with(writes), pipeline, { parameter_offset });
+
+            if (!vertex_inputs)
+                return; // pulled in strand_pulled.vert or strand_mesh.glsl.
+
+            command_buffer.bind_vertex_buffer(0, vertices,  0);
+
+            if (quantization == vkhr::HairStyle::Quantization::None) {
+                command_buffer.bind_vertex_buffer(1, tangents,  0);
+                command_buffer.bind_vertex_buffer(2, get_thickness(), 0);
+            }
+        }
+
+        void HairStyle::cull(Pipeline& pipeline, std::uint32_t view, const glm::mat4& clip, const glm::vec3& eye,
+                             float occlusion_threshold, vk::CommandBuffer& command_buffer,
+                             std::uint32_t model_depth_levels) {
+            VkMemoryBarrier memory_barrier;
+            memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            memory_barrier.pNext = nullptr;
+
+            // The previous frame might still be drawing the culled segments.
+            memory_barrier.srcAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                                            VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            memory_barrier);
+
+            // Everything is zero except for the instance counts, the non-indexed one is for quads.
+            command_buffer.fill_buffer(culled_draws[view], 0, culled_draws[view].get_size(), 0);
+            command_buffer.fill_buffer(culled_draws[view], offsetof(VkDrawIndexedIndirectCommand, instanceCount),
+                                       sizeof(std::uint32_t), 1);
+            command_buffer.fill_buffer(culled_draws[view], sizeof(VkDrawIndexedIndirectCommand) +
+                                                           offsetof(VkDrawIndirectCommand, instanceCount),
+                                       sizeof(std::uint32_t), 1);
+
+            memory_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            memory_barrier);
+
+            command_buffer.bind_pipeline(pipeline);
+            command_buffer.bind_descriptor_set(cull_descriptor_sets[view], pipeline, { parameter_offset });
+
+            struct Culling {
+                glm::mat4 clip;
+                glm::vec3 eye;
+                float occlusion_threshold;
+                std::uint32_t model_depth_levels;
+            } culling {
+                clip,
+                eye,
+                occlusion_threshold,
+                model_depth_levels
+            };
+
+            command_buffer.push_constant(pipeline, 0, culling);
+
+            command_buffer.dispatch(cluster_count); // one group per cluster.
+
+            memory_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                                            memory_barrier);
+
+            culled_views[view] = true;
+        }
+
+        void HairStyle::rasterize(Pipeline& bin_pipeline, Pipeline& tile_pipeline, std::uint32_t frame, const glm::mat4& model,
+                                  float level_of_detail, vk::StorageBuffer& tile_counts, VkExtent2D tiles,
+                                  vk::ImageView& depth_view, vk::Sampler& depth_sampler, vk::CommandBuffer& command_buffer) {
+            VkMemoryBarrier memory_barrier;
+            memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            memory_barrier.pNext = nullptr;
+
+            // The previous hair style might still be reading the tiles.
+            memory_barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                            memory_barrier);
+
+            command_buffer.fill_buffer(tile_counts, 0, tile_counts.get_size(), 0);
+
+            memory_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            memory_barrier);
+
+            auto& descriptor_set = tile_descriptor_sets[frame];
+
+            // The color pass' or the hair target's, see Rasterizer::scaled_hair_enabled.
+            descriptor_set.write(27, depth_view, depth_sampler);
+
+            struct Object {
+                glm::mat4 model;
+                float level_of_detail;
+            } object {
+                model,
+                level_of_detail
+            };
+
+            command_buffer.bind_pipeline(bin_pipeline);
+            command_buffer.bind_descriptor_set(descriptor_set, bin_pipeline, { parameter_offset });
+            command_buffer.push_constant(bin_pipeline, 0, object);
+
+            std::uint32_t segment_count = (segments.count() / 2) * parameters.strand_ratio;
+            command_buffer.dispatch((segment_count + 511) / 512); // see bin_segments.comp.
+
+            memory_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            memory_barrier);
+
+            command_buffer.bind_pipeline(tile_pipeline);
+            command_buffer.bind_descriptor_set(descriptor_set, tile_pipeline, { parameter_offset });
+            command_buffer.push_constant(tile_pipeline, 0, object);
+
+            command_buffer.dispatch(tiles.width, tiles.height); // one group per tile.
+        }
+
+        void HairStyle::sort(Pipeline& key_pipeline, Pipeline& histogram_pipeline, Pipeline& scan_pipeline, Pipeline& scatter_pipeline,
+                             std::uint32_t frame, const glm::mat4& model_view, std::uint32_t instance_count,
+                             vk::CommandBuffer& command_buffer) {
+            VkMemoryBarrier memory_barrier;
+            memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            memory_barrier.pNext = nullptr;
+
+            // The previous frame might still be drawing the sorted segments.
+            memory_barrier.srcAccessMask = VK_ACCESS_INDEX_READ_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            memory_barrier);
+
+            // Same as in draw, the culled segments are only for the single node they were culled for.
+            sorted_culled = instance_count == 1 && !culled_views.empty() && culled_views[0];
+
+            // The keys are only spread over the depths of the bounds, which is enough to order the
+            // segments of one style, since the styles themselves are drawn back-to-front too.
+            float nearest_depth  = std::numeric_limits<float>::max();
+            float farthest_depth = std::numeric_limits<float>::lowest();
+
+            for (int corner { 0 }; corner < 8; ++corner) {
+                glm::vec3 position = parameters.volume_bounds.origin + parameters.volume_bounds.size *
+                                     glm::vec3((corner >> 0) & 1, (corner >> 1) & 1, (corner >> 2) & 1);
+                float depth = -(model_view * glm::vec4 { position, 1.0f }).z;
+                nearest_depth  = std::min(nearest_depth,  depth);
+                farthest_depth = std::max(farthest_depth, depth);
+            }
+
+            SortConstants sorting {
+                model_view,
+                nearest_depth,
+                std::max(farthest_depth - nearest_depth, 1e-6f),
+                static_cast<std::uint32_t>((segments.count() / 2) * parameters.strand_ratio),
+                sorted_culled,
+                0,
+                get_sort_block_count()
+            };
+
+            auto& descriptor_set = sort_descriptor_sets[frame];
+
+            descriptor_set.write(23, sorted_culled ? static_cast<vk::Buffer&>(culled_segments[0]) : segments);
+
+            auto sort_pass = [&](Pipeline& pipeline, std::uint32_t group_count) {
+                command_buffer.bind_pipeline(pipeline);
+                command_buffer.bind_descriptor_set(descriptor_set, pipeline, { parameter_offset });
+                command_buffer.push_constant(pipeline, 0, sorting);
+
+                command_buffer.dispatch(group_count);
+
+                memory_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+                memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+                command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                                memory_barrier);
+            };
+
+            // Dispatched for all of the segments, since the culled count is only known on the GPU.
+            sort_pass(key_pipeline, (segments.count() / 2 + SortRadix - 1) / SortRadix); // see sort_keys.comp.
+
+            for (sorting.pass = 0; sorting.pass < 2; ++sorting.pass) {
+                sort_pass(histogram_pipeline, sorting.block_count);
+                sort_pass(scan_pipeline, 1);
+                sort_pass(scatter_pipeline, sorting.block_count);
+            }
+
+            memory_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_INDEX_READ_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                                            memory_barrier);
+        }
+
+        void HairStyle::draw_sorted(Pipeline& pipeline, vk::DescriptorSet& descriptor_set, vk::CommandBuffer& command_buffer,
+                                    std::uint32_t instance_count) {
+            bind(pipeline, descriptor_set, command_buffer);
+
+            command_buffer.bind_index_buffer(sorted_segments, segments.get_type());
+
+            if (sorted_culled) {
+                command_buffer.draw_indexed_indirect(culled_draws[0]);
+            } else {
+                // The same count as was sorted, since only those indices were written.
+                std::uint32_t segment_count = (segments.count() / 2) * parameters.strand_ratio;
+                command_buffer.draw_indexed(segment_count * 2, instance_count);
+            }
+        }
+
+        std::uint32_t HairStyle::get_sort_block_count() const {
+            return std::max<std::uint32_t>((segments.count() / 2 + SortBlockSize - 1) / SortBlockSize, 1);
+        }
+
+        void HairStyle::disable_culling(std::uint32_t view) {
+            if (view < culled_views.size())
+                culled_views[view] = false;
+        }
+
+        void HairStyle::create_culling_buffers(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            std::size_t view_count = 1 + vulkan_renderer.shadow_maps.size();
+
+            if (culled_segments.size() != view_count) {
+                culled_segments.clear();
+                culled_draws.clear();
+
+                for (std::size_t i { 0 }; i < view_count; ++i) {
+                    culled_segments.emplace_back(vulkan_renderer.device, segments.get_size(),
+                                                 VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+                    vk::DebugMarker::object_name(vulkan_renderer.device, culled_segments.back(), VK_OBJECT_TYPE_BUFFER,
+                                                 "Hair Culled Index Buffer", id);
+                    culled_draws.emplace_back(vulkan_renderer.device, sizeof(VkDrawIndexedIndirectCommand) + sizeof(VkDrawIndirectCommand),
+                                              VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+                    vk::DebugMarker::object_name(vulkan_renderer.device, culled_draws.back(), VK_OBJECT_TYPE_BUFFER,
+                                                 "Hair Culled Draw Buffer", id);
+                }
+            }
+
+            culled_views.assign(view_count, false);
+
+            cull_descriptor_sets = vulkan_renderer.descriptor_pool.allocate(view_count,
+                                                                            pipeline.descriptor_set_layout,
+                                                                            "Hair Cull Descriptor Set");
+
+            for (std::size_t i { 0 }; i < cull_descriptor_sets.size(); ++i) {
+                cull_descriptor_sets[i].write(0, clusters);
+                cull_descriptor_sets[i].write(1, segments);
+                cull_descriptor_sets[i].write(2, *parameter_buffer, 0, sizeof(Parameters));
+                cull_descriptor_sets[i].write(3, density_view,   density_sampler);
+                cull_descriptor_sets[i].write(4, occupancy_view, occupancy_sampler);
+                cull_descriptor_sets[i].write(5, culled_segments[i]);
+                cull_descriptor_sets[i].write(6, culled_draws[i]);
+                cull_descriptor_sets[i].write(7, vulkan_renderer.model_depth_pyramid.get_image_view(),
+                                              vulkan_renderer.model_depth_pyramid.get_sampler());
+                cull_descriptor_sets[i].write(29, volume_bricks);
+            }
+        }
+
+        void HairStyle::create_tile_descriptor_sets(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            tile_descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
+                                                                            pipeline.descriptor_set_layout,
+                                                                            "Hair Tile Descriptor Set");
+
+            std::uint32_t light_count = vulkan_renderer.shadow_maps.size();
+
+            for (std::size_t i { 0 }; i < tile_descriptor_sets.size(); ++i) {
+                tile_descriptor_sets[i].write(0, vulkan_renderer.frame_constants[i], vulkan_renderer.camera[i]);
+                tile_descriptor_sets[i].write(1, vulkan_renderer.frame_constants[i], vulkan_renderer.lights[i]);
+                tile_descriptor_sets[i].write(2, *parameter_buffer, 0, sizeof(Parameters));
+                tile_descriptor_sets[i].write(3, density_view, density_sampler);
+                tile_descriptor_sets[i].write(16, occlusion_view, occlusion_sampler);
+                tile_descriptor_sets[i].write(29, volume_bricks);
+                tile_descriptor_sets[i].write(4, vulkan_renderer.frame_constants[i], vulkan_renderer.params[i]);
+
+                tile_descriptor_sets[i].write(5, vulkan_renderer.ppll.get_heads_view());
+                tile_descriptor_sets[i].write(6, vulkan_renderer.ppll.get_nodes());
+                tile_descriptor_sets[i].write(7, vulkan_renderer.ppll.get_parameters());
+                tile_descriptor_sets[i].write(8, vulkan_renderer.ppll.get_node_counter());
+                tile_descriptor_sets[i].write(17, vulkan_renderer.ppll.get_shading());
+
+                for (std::uint32_t j { 0 }; j < light_count; ++j) {
+                    tile_descriptor_sets[i].write(9 + j, vulkan_renderer.shadow_maps[j].get_image_view(),
+                                                  vulkan_renderer.shadow_maps[j].get_sampler());
+                    tile_descriptor_sets[i].write(32 + j, vulkan_renderer.opacity_maps[j].get_image_view(),
+                                                  vulkan_renderer.opacity_maps[j].get_sampler());
+                    tile_descriptor_sets[i].write(40 + j, vulkan_renderer.filtered_shadow_maps[j].get_image_view(),
+                                                  vulkan_renderer.filtered_shadow_maps[j].get_sampler());
+                }
+
+                tile_descriptor_sets[i].write(20, vertices);
+
+                if (quantization == vkhr::HairStyle::Quantization::Packed) {
+                    tile_descriptor_sets[i].write(21, vertices); // tangents are packed.
+                    tile_descriptor_sets[i].write(22, vertices); // and the thickness.
+                } else {
+                    tile_descriptor_sets[i].write(21, tangents);
+                    tile_descriptor_sets[i].write(22, thickness);
+                }
+
+                tile_descriptor_sets[i].write(23, segments);
+
+                tile_descriptor_sets[i].write(25, vulkan_renderer.strand_tile_counts);
+                tile_descriptor_sets[i].write(26, vulkan_renderer.strand_tile_segments);
+                tile_descriptor_sets[i].write(27, vulkan_renderer.swap_chain.get_depth_buffer_view(),
+                                              vulkan_renderer.depth_sampler);
+            }
+        }
+
+        void HairStyle::create_sort_buffers(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            VkDeviceSize key_buffer_size = std::max<VkDeviceSize>(segments.count() / 2, 1) * sizeof(glm::uvec2);
+
+            sort_keys = vk::DeviceBuffer { vulkan_renderer.device, key_buffer_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT };
+            vk::DebugMarker::object_name(vulkan_renderer.device, sort_keys, VK_OBJECT_TYPE_BUFFER, "Hair Sort Key Buffer", id);
+            sorted_keys = vk::DeviceBuffer { vulkan_renderer.device, key_buffer_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT };
+            vk::DebugMarker::object_name(vulkan_renderer.device, sorted_keys, VK_OBJECT_TYPE_BUFFER, "Hair Sorted Key Buffer", id);
+
+            sort_histograms = vk::DeviceBuffer { vulkan_renderer.device, SortRadix * get_sort_block_count() * sizeof(std::uint32_t),
+                                                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT };
+            vk::DebugMarker::object_name(vulkan_renderer.device, sort_histograms, VK_OBJECT_TYPE_BUFFER, "Hair Sort Histogram Buffer", id);
+
+            sorted_segments = vk::DeviceBuffer { vulkan_renderer.device, segments.get_size(),
+                                                 VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT };
+            vk::DebugMarker::object_name(vulkan_renderer.device, sorted_segments, VK_OBJECT_TYPE_BUFFER, "Hair Sorted Index Buffer", id);
+
+            sort_descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
+                                                                            pipeline.descriptor_set_layout,
+                                                                            "Hair Sort Descriptor Set");
+
+            for (std::size_t i { 0 }; i < sort_descriptor_sets.size(); ++i) {
+                sort_descriptor_sets[i].write(2, *parameter_buffer, 0, sizeof(Parameters));
+                sort_descriptor_sets[i].write(20, vertices);
+
+                if (quantization == vkhr::HairStyle::Quantization::Packed) {
+                    sort_descriptor_sets[i].write(21, vertices); // tangents are packed.
+                    sort_descriptor_sets[i].write(22, vertices); // and the thickness.
+                } else {
+                    sort_descriptor_sets[i].write(21, tangents);
+                    sort_descriptor_sets[i].write(22, thickness);
+                }
+
+                sort_descriptor_sets[i].write(23, segments); // or the culled ones, see sort.
+
+                sort_descriptor_sets[i].write(57, culled_draws[0]);
+                sort_descriptor_sets[i].write(58, sort_keys);
+                sort_descriptor_sets[i].write(59, sorted_keys);
+                sort_descriptor_sets[i].write(60, sort_histograms);
+                sort_descriptor_sets[i].write(61, sorted_segments);
+            }
+        }
+
+        void HairStyle::update_parameters() {
+            parameter_buffer->update(parameters, parameter_offset);
+        }
+
+        void HairStyle::set_parameter_slot(std::uint32_t parameter_slot, vkhr::Rasterizer& vulkan_renderer) {
+            parameter_offset = static_cast<std::uint32_t>(parameter_slot * vulkan_renderer.strand_parameters_stride);
+            parameter_buffer = &vulkan_renderer.strand_parameters;
+            update_parameters();
+        }
+
+        void HairStyle::build_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer, Expansion expansion, Transparency transparency) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+
+            bool weighted_blended = transparency == Transparency::WeightedBlended;
+            bool depth_sorted = transparency == Transparency::DepthSorted;
+
+            if (expansion == Expansion::VertexInputs)
+                add_vertex_inputs(pipeline, vulkan_renderer.strand_quantization);
+
+            if (expansion == Expansion::PulledQuads)
+                pipeline.fixed_stages.set_topology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+            else if (expansion == Expansion::TessellatedCurves)
+                pipeline.fixed_stages.set_topology(VK_PRIMITIVE_TOPOLOGY_PATCH_LIST);
+            else if (depth_sorted)
+                pipeline.fixed_stages.set_topology(VK_PRIMITIVE_TOPOLOGY_LINE_LIST); // the strips aren't sorted.
+            else
+                set_line_topology(pipeline, vulkan_renderer);
+
+            if (expansion == Expansion::TessellatedCurves)
+                pipeline.fixed_stages.set_patch_vertices(4);
+
+            pipeline.fixed_stages.set_scissor({ 0, 0, vulkan_renderer.get_color_extent() });
+            pipeline.fixed_stages.set_viewport({ 0.0, 0.0,
+                                                 static_cast<float>(vulkan_renderer.get_color_extent().width),
+                                                 static_cast<float>(vulkan_renderer.get_color_extent().height),
+                                                 0.0, 1.0 });
+
+            pipeline.fixed_stages.add_dynamic_state(VK_DYNAMIC_STATE_LINE_WIDTH);
+
+            // Since it's drawn in the color pass and the hair pass, see Rasterizer::set_hair_viewport.
+            if (!weighted_blended) {
+                pipeline.fixed_stages.add_dynamic_state(VK_DYNAMIC_STATE_VIEWPORT);
+                pipeline.fixed_stages.add_dynamic_state(VK_DYNAMIC_STATE_SCISSOR);
+            }
+
+            pipeline.fixed_stages.set_line_width(1.0);
+
+            // Whether it's coarse or not is up to the shading rate image, see Rasterizer::set_hair_shading_rate.
+            bool coarse_shading = vulkan_renderer.shading_rate_pipelines() && transparency == Transparency::LinkedLists;
+#ifdef VK_NV_shading_rate_image
+            if (coarse_shading)
+                pipeline.fixed_stages.enable_shading_rate_image(ShadingRateImage::get_palette());
+#endif
+
+            if (weighted_blended) {
+                pipeline.fixed_stages.enable_accumulation_blending_for(0);
+                pipeline.fixed_stages.enable_revealage_blending_for(1);
+            } else {
+                pipeline.fixed_stages.enable_alpha_blending_for(0);
+            }
+
+            pipeline.fixed_stages.enable_depth_test(false);
+
+            std::uint32_t light_count = vulkan_renderer.shadow_maps.size();
+
+            struct Constants {
+                std::uint32_t light_size;
+                Rasterizer::ShaderParameters parameters;
+            } constant_data {
+                light_count,
+                vulkan_renderer.shader_parameters
+            };
+
+            std::vector<VkSpecializationMapEntry> constants {
+                { 0, 0, sizeof(std::uint32_t) } // light size
+            };
+
+            Rasterizer::add_shader_parameters(constants, offsetof(Constants, parameters));
+
+            struct VertexConstants {
+                std::uint32_t vertex_format;
+                std::uint32_t expansion;
+            } vertex_constant_data {
+                static_cast<std::uint32_t>(vulkan_renderer.strand_quantization),
+                static_cast<std::uint32_t>(expansion)
+            };
+
+            std::vector<VkSpecializationMapEntry> vertex_constants {
+                { 0, 0,                     sizeof(std::uint32_t) }, // vertex format
+                { 1, sizeof(std::uint32_t), sizeof(std::uint32_t) }  // expansion
+            };
+
+            bool mesh_shaders = (expansion == Expansion::PulledLines || expansion == Expansion::PulledQuads) && vulkan_renderer.mesh_shading;
+            bool stereo = vulkan_renderer.stereo_rendering && transparency == Transparency::LinkedLists; // into both eyes at once.
+
+            if (expansion == Expansion::TessellatedCurves) {
+                pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("strands/strand_curve.vert"), vertex_constants,
+                                                    &vertex_constant_data, sizeof(vertex_constant_data));
+                vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0], VK_OBJECT_TYPE_SHADER_MODULE, "Hair Curve Vertex Shader");
+                pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("strands/strand_curve.tesc"));
+                vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[1], VK_OBJECT_TYPE_SHADER_MODULE, "Hair Curve Control Shader");
+                pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("strands/strand_curve.tese"));
+                vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[2], VK_OBJECT_TYPE_SHADER_MODULE, "Hair Curve Evaluation Shader");
+            } else if (expansion == Expansion::VertexInputs && stereo) {
+                pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("strands/strand_stereo.vert"), vertex_constants,
+                                                    &vertex_constant_data, sizeof(vertex_constant_data));
+                vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0], VK_OBJECT_TYPE_SHADER_MODULE, "Hair Stereo Vertex Shader");
+            } else if (expansion == Expansion::VertexInputs) {
+                pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("strands/strand.vert"), vertex_constants,
+                                                    &vertex_constant_data, sizeof(vertex_constant_data));
+                vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0], VK_OBJECT_TYPE_SHADER_MODULE, "Hair Vertex Shader");
+            } else if (!mesh_shaders) {
+                pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("strands/strand_pulled.vert"), vertex_constants,
+                                                    &vertex_constant_data, sizeof(vertex_constant_data));
+                vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0], VK_OBJECT_TYPE_SHADER_MODULE, "Hair Pulled Vertex Shader");
+            }
+
+#ifdef VK_EXT_mesh_shader
+            if (mesh_shaders) {
+                pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("strands/strand.task"), vertex_constants,
+                                                    &vertex_constant_data, sizeof(vertex_constant_data));
+                vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0], VK_OBJECT_TYPE_SHADER_MODULE, "Hair Task Shader");
+
+                if (expansion == Expansion::PulledQuads)
+                    pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("strands/strand_quads.mesh"), vertex_constants,
+                                                        &vertex_constant_data, sizeof(vertex_constant_data));
+                else
+                    pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("strands/strand_lines.mesh"), vertex_constants,
+                                                        &vertex_constant_data, sizeof(vertex_constant_data));
+                vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[1], VK_OBJECT_TYPE_SHADER_MODULE, "Hair Mesh Shader");
+            }
+#endif
+
+            if (weighted_blended)
+                pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("strands/strand_wboit.frag"), constants, &constant_data, sizeof(constant_data));
+            else if (depth_sorted)
+                pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("strands/strand_sorted.frag"), constants, &constant_data, sizeof(constant_data));
+            else if (stereo)
+                pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("strands/strand_stereo.frag"), constants, &constant_data, sizeof(constant_data));
+            else if (coarse_shading)
+                pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("strands/strand_coarse.frag"), constants, &constant_data, sizeof(constant_data));
+            else
+                pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("strands/strand.frag"), constants, &constant_data, sizeof(constant_data));
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages.back(), VK_OBJECT_TYPE_SHADER_MODULE, "Hair Fragment Shader");
+
+            std::vector<vk::DescriptorSet::Binding> descriptor_bindings {
+                { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                { 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                { 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC },
+                { 3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 4, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                { 5, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE },
+                { 6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                { 7, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                { 8, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                { 17, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER }
+            };
+
+            for (std::uint32_t i { 0 }; i < light_count; ++i) {
+                descriptor_bindings.push_back({ 9 + i, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER });
+                descriptor_bindings.push_back({ 32 + i, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER }); // opacity maps.
+                descriptor_bindings.push_back({ 40 + i, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER }); // and filtered.
+            }
+
+            descriptor_bindings.push_back({ 16, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER }); // baked AO.
+            descriptor_bindings.push_back({ 14, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER }); // AO volume.
+            descriptor_bindings.push_back({ 19, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER }); // transmittance.
+            descriptor_bindings.push_back({ 29, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER }); // volume bricks.
+
+            // Vertices, tangents, thickness and segments for strand_pulled.vert.
+            if (expansion != Expansion::VertexInputs) {
+                for (std::uint32_t i { 20 }; i <= 23; ++i)
+                    descriptor_bindings.push_back({ i, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER });
+            }
+
+            // And the clusters for strand.task.
+            if (mesh_shaders)
+                descriptor_bindings.push_back({ 24, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER });
+
+            // The model matrices of the nodes, see instances.glsl.
+            descriptor_bindings.push_back({ 28, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER });
+
+            descriptor_bindings.push_back({ 56, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER }); // light tiles.
+            descriptor_bindings.push_back({ 65, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER }); // Marschner.
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                vulkan_renderer.device, descriptor_bindings
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Hair Descriptor Set Layout");
+
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
+                                                                                pipeline.descriptor_set_layout,
+                                                                                "Hair Descriptor Set");
+
+            for (std::size_t i { 0 }; i < pipeline.descriptor_sets.size(); ++i) {
+                pipeline.descriptor_sets[i].write(0, vulkan_renderer.frame_constants[i], vulkan_renderer.camera[i]);
+                pipeline.descriptor_sets[i].write(1, vulkan_renderer.frame_constants[i], vulkan_renderer.lights[i]);
+                pipeline.descriptor_sets[i].write(2, vulkan_renderer.strand_parameters, 0, sizeof(Parameters));
+                pipeline.descriptor_sets[i].write(4, vulkan_renderer.frame_constants[i], vulkan_renderer.params[i]);
+
+                pipeline.descriptor_sets[i].write(5, vulkan_renderer.ppll.get_heads_view());
+                pipeline.descriptor_sets[i].write(6, vulkan_renderer.ppll.get_nodes());
+                pipeline.descriptor_sets[i].write(7, vulkan_renderer.ppll.get_parameters());
+                pipeline.descriptor_sets[i].write(8, vulkan_renderer.ppll.get_node_counter());
+                pipeline.descriptor_sets[i].write(17, vulkan_renderer.ppll.get_shading());
+
+                pipeline.descriptor_sets[i].write(28, vulkan_renderer.hair_instance_buffers[i]);
+                pipeline.descriptor_sets[i].write(56, vulkan_renderer.light_tiles.get_buffer());
+                pipeline.descriptor_sets[i].write(65, vulkan_renderer.scattering_lut.get_image_view(),
+                                                  vulkan_renderer.scattering_lut.get_sampler());
+
+                for (std::uint32_t j { 0 }; j < light_count; ++j) {
+                    pipeline.descriptor_sets[i].write(9 + j, vulkan_renderer.shadow_maps[j].get_image_view(),
+                                                      vulkan_renderer.shadow_maps[j].get_sampler());
+                    pipeline.descriptor_sets[i].write(32 + j, vulkan_renderer.opacity_maps[j].get_image_view(),
+                                                      vulkan_renderer.opacity_maps[j].get_sampler());
+                    pipeline.descriptor_sets[i].write(40 + j, vulkan_renderer.filtered_shadow_maps[j].get_image_view(),
+                                                      vulkan_renderer.filtered_shadow_maps[j].get_sampler());
+                }
+            }
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout,
+                {
+                    { VK_SHADER_STAGE_ALL, 0, sizeof(Instances) } // model and first instance.
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Hair Pipeline Layout");
+
+            pipeline.pipeline = vk::GraphicsPipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages,
+                pipeline.fixed_stages,
+                pipeline.pipeline_layout,
+                weighted_blended ? vulkan_renderer.weighted_blended_pass :
+                                   vulkan_renderer.color_pass
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline, VK_OBJECT_TYPE_PIPELINE, "Hair Graphics Pipeline");
+        }
+
+        void HairStyle::depth_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer, bool multiview) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+
+            if (vulkan_renderer.strand_quantization == vkhr::HairStyle::Quantization::Packed) {
+                pipeline.fixed_stages.add_vertex_binding(vk::VertexBinding { 0, sizeof(vkhr::HairStyle::QuantizedVertex), VK_VERTEX_INPUT_RATE_VERTEX });
+                pipeline.fixed_stages.add_vertex_attribute(vk::VertexAttribute { 0, 0, VK_FORMAT_R16G16B16A16_UNORM, 0 });
+            } else {
+                pipeline.fixed_stages.add_vertex_binding({ 0, 0, VK_FORMAT_R32G32B32_SFLOAT, sizeof(glm::vec3) });
+            }
+
+            pipeline.fixed_stages.set_scissor({ 0, 0, vulkan_renderer.swap_chain.get_extent() });
+            pipeline.fixed_stages.set_viewport({ 0.0, 0.0,
+                                                 static_cast<float>(vulkan_renderer.swap_chain.get_width()),
+                                                 static_cast<float>(vulkan_renderer.swap_chain.get_height()),
+                                                 0.0, 1.0 });
+
+            set_line_topology(pipeline, vulkan_renderer);
+
+            pipeline.fixed_stages.add_dynamic_state(VK_DYNAMIC_STATE_VIEWPORT);
+            pipeline.fixed_stages.add_dynamic_state(VK_DYNAMIC_STATE_LINE_WIDTH);
+            pipeline.fixed_stages.add_dynamic_state(VK_DYNAMIC_STATE_SCISSOR);
+
+            pipeline.fixed_stages.set_culling_mode(VK_CULL_MODE_BACK_BIT);
+
+            pipeline.fixed_stages.set_line_width(1.0);
+            pipeline.fixed_stages.enable_depth_test();
+
+            struct Constants {
+                std::uint32_t vertex_format;
+                std::uint32_t light_count;
+            } constant_data {
+                static_cast<std::uint32_t>(vulkan_renderer.strand_quantization),
+                static_cast<std::uint32_t>(vulkan_renderer.shadow_maps.size())
+            };
+
+            std::vector<VkSpecializationMapEntry> constants {
+                { 0, offsetof(Constants, vertex_format), sizeof(std::uint32_t) },
+                { 1, offsetof(Constants, light_count),   sizeof(std::uint32_t) } // only for multiview.
+            };
+
+            if (multiview)
+                pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("strands/strand_multiview_depth.vert"), constants, &constant_data, sizeof(constant_data));
+            else
+                pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("strands/strand_depth.vert"), constants, &constant_data, sizeof(constant_data));
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0], VK_OBJECT_TYPE_SHADER_MODULE, "Hair Depth Shader");
+
+            std::vector<vk::DescriptorSet::Binding> descriptor_bindings {
+                { 2,  VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC }, // for dequantizing.
+                { 28, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER }          // and instancing.
+            };
+
+            // The light transforms, since it's the same draw for every light.
+            if (multiview)
+                descriptor_bindings.push_back({ 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER });
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                vulkan_renderer.device, descriptor_bindings
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Hair Depth Descriptor Set Layout");
+
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
+                                                                                pipeline.descriptor_set_layout,
+                                                                                "Hair Depth Descriptor Set");
+
+            for (std::size_t i { 0 }; i < pipeline.descriptor_sets.size(); ++i) {
+                pipeline.descriptor_sets[i].write(2, vulkan_renderer.strand_parameters, 0, sizeof(Parameters));
+                pipeline.descriptor_sets[i].write(28, vulkan_renderer.hair_instance_buffers[i]);
+                if (multiview)
+                    pipeline.descriptor_sets[i].write(1, vulkan_renderer.frame_constants[i], vulkan_renderer.lights[i]);
+            }
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout,
+                {
+                    { VK_SHADER_STAGE_ALL, 0, sizeof(Instances) } // transforms.
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Hair Depth Pipeline Layout");
+
+            pipeline.pipeline = vk::GraphicsPipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages,
+                pipeline.fixed_stages,
+                pipeline.pipeline_layout,
+                multiview ? vulkan_renderer.multiview_depth_pass :
+                            vulkan_renderer.depth_pass
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline, VK_OBJECT_TYPE_PIPELINE, "Hair Depth Graphics Pipeline");
+        }
+
+        void HairStyle::impostor_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+
+            pipeline.fixed_stages.set_topology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+
+            pipeline.fixed_stages.set_scissor({ 0, 0, vulkan_renderer.get_color_extent() });
+            pipeline.fixed_stages.set_viewport({ 0.0, 0.0,
+                                                 static_cast<float>(vulkan_renderer.get_color_extent().width),
+                                                 static_cast<float>(vulkan_renderer.get_color_extent().height),
+                                                 0.0, 1.0 });
+
+            pipeline.fixed_stages.set_culling_mode(VK_CULL_MODE_NONE); // it's facing the eye anyway.
+            pipeline.fixed_stages.enable_depth_test(); // with the depth of the baked strands.
+            pipeline.fixed_stages.enable_alpha_blending_for(0);
+
+            std::uint32_t light_count = vulkan_renderer.shadow_maps.size();
+
+            struct Constants {
+                std::uint32_t light_size;
+                std::uint32_t impostor_views;
+            } constant_data {
+                light_count,
+                vkhr::HairStyle::ImpostorViews
+            };
+
+            std::vector<VkSpecializationMapEntry> constants {
+                { 0, 0,                     sizeof(std::uint32_t) }, // light size
+                { 1, sizeof(std::uint32_t), sizeof(std::uint32_t) }  // impostor views
+            };
+
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("billboards/impostor.vert"), constants, &constant_data, sizeof(constant_data));
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0], VK_OBJECT_TYPE_SHADER_MODULE, "Hair Impostor Vertex Shader");
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("billboards/impostor.frag"), constants, &constant_data, sizeof(constant_data));
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[1], VK_OBJECT_TYPE_SHADER_MODULE, "Hair Impostor Fragment Shader");
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                vulkan_renderer.device,
+                {
+                    { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                    { 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                    { 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC },
+                    { 4, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                    { 28, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 57, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                    { 58, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER }
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Hair Impostor Descriptor Set Layout");
+
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
+                                                                                pipeline.descriptor_set_layout,
+                                                                                "Hair Impostor Descriptor Set");
+
+            for (std::size_t i { 0 }; i < pipeline.descriptor_sets.size(); ++i) {
+                pipeline.descriptor_sets[i].write(0, vulkan_renderer.frame_constants[i], vulkan_renderer.camera[i]);
+                pipeline.descriptor_sets[i].write(1, vulkan_renderer.frame_constants[i], vulkan_renderer.lights[i]);
+                pipeline.descriptor_sets[i].write(2, vulkan_renderer.strand_parameters, 0, sizeof(Parameters));
+                pipeline.descriptor_sets[i].write(4, vulkan_renderer.frame_constants[i], vulkan_renderer.params[i]);
+                pipeline.descriptor_sets[i].write(28, vulkan_renderer.hair_instance_buffers[i]);
+            }
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout,
+                {
+                    { VK_SHADER_STAGE_ALL, 0, sizeof(Instances) } // model and first instance.
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Hair Impostor Pipeline Layout");
+
+            pipeline.pipeline = vk::GraphicsPipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages,
+                pipeline.fixed_stages,
+                pipeline.pipeline_layout,
+                vulkan_renderer.color_pass
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline, VK_OBJECT_TYPE_PIPELINE, "Hair Impostor Graphics Pipeline");
+        }
+
+        void HairStyle::opacity_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+
+            if (vulkan_renderer.strand_quantization == vkhr::HairStyle::Quantization::Packed) {
+                pipeline.fixed_stages.add_vertex_binding(vk::VertexBinding { 0, sizeof(vkhr::HairStyle::QuantizedVertex), VK_VERTEX_INPUT_RATE_VERTEX });
+                pipeline.fixed_stages.add_vertex_attribute(vk::VertexAttribute { 0, 0, VK_FORMAT_R16G16B16A16_UNORM, 0 });
+            } else {
+                pipeline.fixed_stages.add_vertex_binding({ 0, 0, VK_FORMAT_R32G32B32_SFLOAT, sizeof(glm::vec3) });
+            }
+
+            pipeline.fixed_stages.set_scissor({ 0, 0, vulkan_renderer.swap_chain.get_extent() });
+            pipeline.fixed_stages.set_viewport({ 0.0, 0.0,
+                                                 static_cast<float>(vulkan_renderer.swap_chain.get_width()),
+                                                 static_cast<float>(vulkan_renderer.swap_chain.get_height()),
+                                                 0.0, 1.0 });
+
+            set_line_topology(pipeline, vulkan_renderer);
+
+            pipeline.fixed_stages.add_dynamic_state(VK_DYNAMIC_STATE_VIEWPORT);
+            pipeline.fixed_stages.add_dynamic_state(VK_DYNAMIC_STATE_LINE_WIDTH);
+            pipeline.fixed_stages.add_dynamic_state(VK_DYNAMIC_STATE_SCISSOR);
+
+            pipeline.fixed_stages.set_culling_mode(VK_CULL_MODE_BACK_BIT);
+
+            pipeline.fixed_stages.set_line_width(1.0);
+
+            // Every strand is counted in the layers, but not the depth test.
+            pipeline.fixed_stages.enable_depth_test(false);
+            pipeline.fixed_stages.enable_accumulation_blending_for(0);
+
+            struct VertexConstants {
+                std::uint32_t vertex_format;
+            } vertex_constant_data {
+                static_cast<std::uint32_t>(vulkan_renderer.strand_quantization)
+            };
+
+            std::vector<VkSpecializationMapEntry> vertex_constants {
+                { 0, 0, sizeof(std::uint32_t) } // vertex format
+            };
+
+            std::uint32_t light_count = vulkan_renderer.shadow_maps.size();
+
+            struct Constants {
+                std::uint32_t light_size;
+            } constant_data {
+                light_count
+            };
+
+            std::vector<VkSpecializationMapEntry> constants {
+                { 0, 0, sizeof(std::uint32_t) } // light size
+            };
+
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("strands/strand_depth.vert"), vertex_constants,
+                                                &vertex_constant_data, sizeof(vertex_constant_data));
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0], VK_OBJECT_TYPE_SHADER_MODULE, "Hair Opacity Vertex Shader");
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("self-shadowing/deep_opacity_map.frag"), constants,
+                                                &constant_data, sizeof(constant_data));
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[1], VK_OBJECT_TYPE_SHADER_MODULE, "Hair Opacity Fragment Shader");
+
+            std::vector<vk::DescriptorSet::Binding> descriptor_bindings {
+                { 2,  VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC }, // for dequantizing.
+                { 28, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER }          // and instancing.
+            };
+
+            // Where the first layer starts.
+            for (std::uint32_t i { 0 }; i < light_count; ++i)
+                descriptor_bindings.push_back({ 9 + i, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER });
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                vulkan_renderer.device, descriptor_bindings
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Hair Opacity Descriptor Set Layout");
+
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
+                                                                                pipeline.descriptor_set_layout,
+                                                                                "Hair Opacity Descriptor Set");
+
+            for (std::size_t i { 0 }; i < pipeline.descriptor_sets.size(); ++i) {
+                pipeline.descriptor_sets[i].write(2, vulkan_renderer.strand_parameters, 0, sizeof(Parameters));
+                pipeline.descriptor_sets[i].write(28, vulkan_renderer.hair_instance_buffers[i]);
+
+                for (std::uint32_t j { 0 }; j < light_count; ++j)
+                    pipeline.descriptor_sets[i].write(9 + j, vulkan_renderer.shadow_maps[j].get_image_view(),
+                                                      vulkan_renderer.shadow_maps[j].get_sampler());
+            }
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout,
+                {
+                    { VK_SHADER_STAGE_ALL, 0, sizeof(Instances) + sizeof(std::uint32_t) } // transforms and light.
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Hair Opacity Pipeline Layout");
+
+            pipeline.pipeline = vk::GraphicsPipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages,
+                pipeline.fixed_stages,
+                pipeline.pipeline_layout,
+                vulkan_renderer.opacity_pass
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline, VK_OBJECT_TYPE_PIPELINE, "Hair Opacity Graphics Pipeline");
+        }
+
+        void HairStyle::voxel_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+
+            struct Constants {
+                std::uint32_t vertex_format;
+            } constant_data {
+                static_cast<std::uint32_t>(vulkan_renderer.strand_quantization)
+            };
+
+            std::vector<VkSpecializationMapEntry> constants {
+                { 0, 0, sizeof(std::uint32_t) } // vertex format
+            };
+
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("volumes/voxelize.comp"), constants, &constant_data, sizeof(constant_data));
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0],
+                                         VK_OBJECT_TYPE_SHADER_MODULE, "Hair Voxelization Shader");
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                vulkan_renderer.device,
+                {
+                    { 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC },
+                    { 4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER }
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout,
+                                         VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Hair Voxel Descriptor Set Layout");
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
+                                                                                pipeline.descriptor_set_layout,
+                                                                                "Hair Voxel Descriptor Set");
+
+            for (auto& descriptor_set : pipeline.descriptor_sets)
+                descriptor_set.write(2, vulkan_renderer.strand_parameters, 0, sizeof(Parameters));
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout,
+                                         VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                                         "Hair Voxel Pipeline Layout");
+
+            pipeline.compute_pipeline = vk::ComputePipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages[0],
+                pipeline.pipeline_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.compute_pipeline,
+                                         VK_OBJECT_TYPE_PIPELINE, "Hair Voxel Pipeline");
+        }
+
+        void HairStyle::simulation_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+
+            struct Constants {
+                std::uint32_t vertex_format;
+            } constant_data {
+                static_cast<std::uint32_t>(vulkan_renderer.strand_quantization)
+            };
+
+            std::vector<VkSpecializationMapEntry> constants {
+                { 0, 0, sizeof(std::uint32_t) } // vertex format
+            };
+
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("strands/simulate.comp"), constants, &constant_data, sizeof(constant_data));
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0],
+                                         VK_OBJECT_TYPE_SHADER_MODULE, "Hair Simulation Shader");
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                vulkan_renderer.device,
+                {
+                    { 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC },
+                    { 3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER }
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout,
+                                         VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Hair Simulation Descriptor Set Layout");
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
+                                                                                pipeline.descriptor_set_layout,
+                                                                                "Hair Simulation Descriptor Set");
+
+            for (auto& descriptor_set : pipeline.descriptor_sets)
+                descriptor_set.write(2, vulkan_renderer.strand_parameters, 0, sizeof(Parameters));
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout,
+                {
+                    { VK_SHADER_STAGE_ALL, 0, sizeof(SimulationConstants) }
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout,
+                                         VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                                         "Hair Simulation Pipeline Layout");
+
+            pipeline.compute_pipeline = vk::ComputePipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages[0],
+                pipeline.pipeline_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.compute_pipeline,
+                                         VK_OBJECT_TYPE_PIPELINE, "Hair Simulation Pipeline");
+        }
+
+        void HairStyle::bounds_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+
+            struct Constants {
+                std::uint32_t vertex_format;
+            } constant_data {
+                static_cast<std::uint32_t>(vulkan_renderer.strand_quantization)
+            };
+
+            std::vector<VkSpecializationMapEntry> constants {
+                { 0, 0, sizeof(std::uint32_t) } // vertex format
+            };
+
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("strands/bounds.comp"), constants, &constant_data, sizeof(constant_data));
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0],
+                                         VK_OBJECT_TYPE_SHADER_MODULE, "Hair Bounds Shader");
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                vulkan_renderer.device,
+                {
+                    { 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC },
+                    { 3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 7, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 8, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC } // the same parameters, written.
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout,
+                                         VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Hair Bounds Descriptor Set Layout");
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
+                                                                                pipeline.descriptor_set_layout,
+                                                                                "Hair Bounds Descriptor Set");
+
+            for (auto& descriptor_set : pipeline.descriptor_sets) {
+                descriptor_set.write(2, vulkan_renderer.strand_parameters, 0, sizeof(Parameters));
+                descriptor_set.write(8, vulkan_renderer.strand_parameters, 0, sizeof(Parameters));
+            }
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout,
+                {
+                    { VK_SHADER_STAGE_ALL, 0, sizeof(BoundsConstants) }
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout,
+                                         VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                                         "Hair Bounds Pipeline Layout");
+
+            pipeline.compute_pipeline = vk::ComputePipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages[0],
+                pipeline.pipeline_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.compute_pipeline,
+                                         VK_OBJECT_TYPE_PIPELINE, "Hair Bounds Pipeline");
+        }
+
+        void HairStyle::interpolation_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+
+            struct Constants {
+                std::uint32_t vertex_format;
+            } constant_data {
+                static_cast<std::uint32_t>(vulkan_renderer.strand_quantization)
+            };
+
+            std::vector<VkSpecializationMapEntry> constants {
+                { 0, 0, sizeof(std::uint32_t) } // vertex format
+            };
+
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("strands/interpolate.comp"), constants, &constant_data, sizeof(constant_data));
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0],
+                                         VK_OBJECT_TYPE_SHADER_MODULE, "Hair Interpolation Shader");
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                vulkan_renderer.device,
+                {
+                    { 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC },
+                    { 3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER }
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout,
+                                         VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Hair Interpolation Descriptor Set Layout");
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
+                                                                                pipeline.descriptor_set_layout,
+                                                                                "Hair Interpolation Descriptor Set");
+
+            for (auto& descriptor_set : pipeline.descriptor_sets)
+                descriptor_set.write(2, vulkan_renderer.strand_parameters, 0, sizeof(Parameters));
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout,
+                {
+                    { VK_SHADER_STAGE_ALL, 0, sizeof(InterpolationConstants) }
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout,
+                                         VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                                         "Hair Interpolation Pipeline Layout");
+
+            pipeline.compute_pipeline = vk::ComputePipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages[0],
+                pipeline.pipeline_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.compute_pipeline,
+                                         VK_OBJECT_TYPE_PIPELINE, "Hair Interpolation Pipeline");
+        }
+
+        void HairStyle::volume_mip_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("volumes/downsample_volume.comp"));
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0],
+                                         VK_OBJECT_TYPE_SHADER_MODULE, "Hair Volume Mip Shader");
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                vulkan_renderer.device,
+                {
+                    { 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC },
+                    { 3, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE  },
+                    { 5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 7, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE  },
+                    { 8, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE  },
+                    { 9, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE  }
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout,
+                                         VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Hair Volume Mip Descriptor Set Layout");
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
+                                                                                pipeline.descriptor_set_layout,
+                                                                                "Hair Volume Mip Descriptor Set");
+
+            for (auto& descriptor_set : pipeline.descriptor_sets)
+                descriptor_set.write(2, vulkan_renderer.strand_parameters, 0, sizeof(Parameters));
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout,
+                {
+                    { VK_SHADER_STAGE_ALL, 0, sizeof(std::uint32_t) } // mip level
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout,
+                                         VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                                         "Hair Volume Mip Pipeline Layout");
+
+            pipeline.compute_pipeline = vk::ComputePipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages[0],
+                pipeline.pipeline_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.compute_pipeline,
+                                         VK_OBJECT_TYPE_PIPELINE, "Hair Volume Mip Pipeline");
+        }
+
+        void HairStyle::transmittance_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+
+            std::uint32_t light_count = vulkan_renderer.shadow_maps.size();
+
+            std::vector<VkSpecializationMapEntry> constants {
+                { 0, 0, sizeof(std::uint32_t) } // light size
+            };
+
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("volumes/transmittance.comp"),
+                                                constants, &light_count, sizeof(light_count));
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0],
+                                         VK_OBJECT_TYPE_SHADER_MODULE, "Hair Transmittance Shader");
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                vulkan_renderer.device,
+                {
+                    { 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                    { 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC },
+                    { 3, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE  },
+                    { 4, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                    { 7, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE  }
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout,
+                                         VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Hair Transmittance Descriptor Set Layout");
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
+                                                                                pipeline.descriptor_set_layout,
+                                                                                "Hair Transmittance Descriptor Set");
+
+            for (std::size_t i { 0 }; i < pipeline.descriptor_sets.size(); ++i) {
+                pipeline.descriptor_sets[i].write(1, vulkan_renderer.frame_constants[i], vulkan_renderer.lights[i]);
+                pipeline.descriptor_sets[i].write(2, vulkan_renderer.strand_parameters, 0, sizeof(Parameters));
+                pipeline.descriptor_sets[i].write(4, vulkan_renderer.frame_constants[i], vulkan_renderer.params[i]);
+            }
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout,
+                                         VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                                         "Hair Transmittance Pipeline Layout");
+
+            pipeline.compute_pipeline = vk::ComputePipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages[0],
+                pipeline.pipeline_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.compute_pipeline,
+                                         VK_OBJECT_TYPE_PIPELINE, "Hair Transmittance Pipeline");
+        }
+
+        void HairStyle::ambient_occlusion_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("volumes/ambient_occlusion.comp"));
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0],
+                                         VK_OBJECT_TYPE_SHADER_MODULE, "Hair AO Volume Shader");
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                vulkan_renderer.device,
+                {
+                    { 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC },
+                    { 3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                    { 4, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                    { 7, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE }
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout,
+                                         VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Hair AO Volume Descriptor Set Layout");
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
+                                                                                pipeline.descriptor_set_layout,
+                                                                                "Hair AO Volume Descriptor Set");
+
+            for (std::size_t i { 0 }; i < pipeline.descriptor_sets.size(); ++i) {
+                pipeline.descriptor_sets[i].write(2, vulkan_renderer.strand_parameters, 0, sizeof(Parameters));
+                pipeline.descriptor_sets[i].write(4, vulkan_renderer.frame_constants[i], vulkan_renderer.params[i]);
+            }
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout,
+                                         VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                                         "Hair AO Volume Pipeline Layout");
+
+            pipeline.compute_pipeline = vk::ComputePipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages[0],
+                pipeline.pipeline_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.compute_pipeline,
+                                         VK_OBJECT_TYPE_PIPELINE, "Hair AO Volume Pipeline");
+        }
+
+        void HairStyle::distance_field_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("volumes/distance_field.comp"));
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0],
+                                         VK_OBJECT_TYPE_SHADER_MODULE, "Hair Distance Field Shader");
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                vulkan_renderer.device,
+                {
+                    { 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC },
+                    { 5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 7, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE  }
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout,
+                                         VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Hair Distance Field Descriptor Set Layout");
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
+                                                                                pipeline.descriptor_set_layout,
+                                                                                "Hair Distance Field Descriptor Set");
+
+            for (auto& descriptor_set : pipeline.descriptor_sets)
+                descriptor_set.write(2, vulkan_renderer.strand_parameters, 0, sizeof(Parameters));
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout,
+                {
+                    { VK_SHADER_STAGE_ALL, 0, sizeof(std::uint32_t) } // axis
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout,
+                                         VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                                         "Hair Distance Field Pipeline Layout");
+
+            pipeline.compute_pipeline = vk::ComputePipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages[0],
+                pipeline.pipeline_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.compute_pipeline,
+                                         VK_OBJECT_TYPE_PIPELINE, "Hair Distance Field Pipeline");
+        }
+
+        void HairStyle::voxel_resolve_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("volumes/resolve_voxels.comp"));
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0],
+                                         VK_OBJECT_TYPE_SHADER_MODULE, "Hair Voxel Resolve Shader");
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                vulkan_renderer.device,
+                {
+                    { 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC },
+                    { 3, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE  },
+                    { 5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 7, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE  },
+                    { 8, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE  },
+                    { 29, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER }
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout,
+                                         VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Hair Voxel Resolve Descriptor Set Layout");
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
+                                                                                pipeline.descriptor_set_layout,
+                                                                                "Hair Voxel Resolve Descriptor Set");
+
+            for (auto& descriptor_set : pipeline.descriptor_sets)
+                descriptor_set.write(2, vulkan_renderer.strand_parameters, 0, sizeof(Parameters));
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout,
+                                         VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                                         "Hair Voxel Resolve Pipeline Layout");
+
+            pipeline.compute_pipeline = vk::ComputePipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages[0],
+                pipeline.pipeline_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.compute_pipeline,
+                                         VK_OBJECT_TYPE_PIPELINE, "Hair Voxel Resolve Pipeline");
+        }
+
+        void HairStyle::cull_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("strands/cull.comp"));
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0],
+                                         VK_OBJECT_TYPE_SHADER_MODULE, "Hair Cull Shader");
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                vulkan_renderer.device,
+                {
+                    { 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC },
+                    { 3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                    { 4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                    { 5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 7, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                    { 29, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER }
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout,
+                                         VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Hair Cull Descriptor Set Layout");
+
+            // Every hair style has its own set per view instead, see create_culling_buffers.
+            for (auto& hair_style : vulkan_renderer.hair_styles)
+                hair_style.second.create_culling_buffers(pipeline, vulkan_renderer);
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout,
+                {
+                    { VK_SHADER_STAGE_ALL, 0, sizeof(glm::mat4) + sizeof(glm::vec4) + sizeof(std::uint32_t) } // clip, eye, threshold and levels.
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout,
+                                         VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                                         "Hair Cull Pipeline Layout");
+
+            pipeline.compute_pipeline = vk::ComputePipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages[0],
+                pipeline.pipeline_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.compute_pipeline,
+                                         VK_OBJECT_TYPE_PIPELINE, "Hair Cull Pipeline");
+        }
+
+        void HairStyle::bin_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            build_tile_pipeline(pipeline, vulkan_renderer, SHADER("strands/bin_segments.comp"), "Hair Bin");
+        }
+
+        void HairStyle::tile_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            build_tile_pipeline(pipeline, vulkan_renderer, SHADER("strands/tile_raster.comp"), "Hair Tile");
+
+            // Every hair style has its own set per frame instead, see create_tile_descriptor_sets.
+            for (auto& hair_style : vulkan_renderer.hair_styles)
+                hair_style.second.create_tile_descriptor_sets(pipeline, vulkan_renderer);
+        }
+
+        void HairStyle::sort_keys_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            build_sort_pipeline(pipeline, vulkan_renderer, SHADER("strands/sort_keys.comp"), "Hair Sort Keys");
+        }
+
+        void HairStyle::sort_histogram_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            build_sort_pipeline(pipeline, vulkan_renderer, SHADER("strands/sort_histogram.comp"), "Hair Sort Histogram");
+        }
+
+        void HairStyle::sort_scan_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            build_sort_pipeline(pipeline, vulkan_renderer, SHADER("strands/sort_scan.comp"), "Hair Sort Scan");
+        }
+
+        void HairStyle::sort_scatter_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            build_sort_pipeline(pipeline, vulkan_renderer, SHADER("strands/sort_scatter.comp"), "Hair Sort Scatter");
+
+            // Every hair style has its own buffers and set per frame instead, see create_sort_buffers.
+            for (auto& hair_style : vulkan_renderer.hair_styles)
+                hair_style.second.create_sort_buffers(pipeline, vulkan_renderer);
+        }
+
+        void HairStyle::build_sort_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer, const std::string& shader, const std::string& name) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+
+            std::uint32_t vertex_format = static_cast<std::uint32_t>(vulkan_renderer.strand_quantization);
+
+            std::vector<VkSpecializationMapEntry> constants {
+                { 0, 0, sizeof(std::uint32_t) } // vertex format
+            };
+
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, shader, constants, &vertex_format, sizeof(vertex_format));
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0],
+                                         VK_OBJECT_TYPE_SHADER_MODULE, (name + " Shader").c_str());
+
+            std::vector<vk::DescriptorSet::Binding> descriptor_bindings {
+                { 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC }
+            };
+
+            // Vertices, tangents, thickness and segments, like in strand_pulled.vert.
+            for (std::uint32_t i { 20 }; i <= 23; ++i)
+                descriptor_bindings.push_back({ i, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER });
+
+            // The culled draw, both of the keys, the histograms and the sorted segments.
+            for (std::uint32_t i { 57 }; i <= 61; ++i)
+                descriptor_bindings.push_back({ i, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER });
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                vulkan_renderer.device,
+                descriptor_bindings
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout,
+                                         VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, (name + " Descriptor Set Layout").c_str());
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout,
+                {
+                    { VK_SHADER_STAGE_ALL, 0, sizeof(SortConstants) }
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout,
+                                         VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                                         (name + " Pipeline Layout").c_str());
+
+            pipeline.compute_pipeline = vk::ComputePipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages[0],
+                pipeline.pipeline_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.compute_pipeline,
+                                         VK_OBJECT_TYPE_PIPELINE, (name + " Pipeline").c_str());
+        }
+
+        std::vector<vk::DescriptorSet::Binding> HairStyle::tile_descriptor_bindings(Rasterizer& vulkan_renderer) {
+            std::vector<vk::DescriptorSet::Binding> descriptor_bindings {
+                { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                { 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                { 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC },
+                { 3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 4, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                { 5, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE },
+                { 6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                { 7, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                { 8, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                { 17, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER }
+            };
+
+            for (std::uint32_t i { 0 }; i < vulkan_renderer.shadow_maps.size(); ++i) {
+                descriptor_bindings.push_back({ 9 + i, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER });
+                descriptor_bindings.push_back({ 32 + i, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER }); // opacity maps.
+                descriptor_bindings.push_back({ 40 + i, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER }); // and filtered.
+            }
+
+            descriptor_bindings.push_back({ 16, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER }); // baked AO.
+            descriptor_bindings.push_back({ 29, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER }); // volume bricks.
+
+            // Vertices, tangents, thickness and segments, like in strand_pulled.vert.
+            for (std::uint32_t i { 20 }; i <= 23; ++i)
+                descriptor_bindings.push_back({ i, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER });
+
+            descriptor_bindings.push_back({ 25, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER }); // tile counts.
+            descriptor_bindings.push_back({ 26, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER }); // tile segments.
+            descriptor_bindings.push_back({ 27, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER }); // depth.
+
+            return descriptor_bindings;
+        }
+
+        void HairStyle::build_tile_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer, const std::string& shader, const std::string& name) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+
+            struct Constants {
+                std::uint32_t light_size;
+                std::uint32_t vertex_format;
+                Rasterizer::ShaderParameters parameters;
+            } constant_data {
+                static_cast<std::uint32_t>(vulkan_renderer.shadow_maps.size()),
+                static_cast<std::uint32_t>(vulkan_renderer.strand_quantization),
+                vulkan_renderer.shader_parameters
+            };
+
+            std::vector<VkSpecializationMapEntry> constants {
+                { 0, 0,                     sizeof(std::uint32_t) }, // light size
+                { 1, sizeof(std::uint32_t), sizeof(std::uint32_t) }  // vertex format
+            };
+
+            Rasterizer::add_shader_parameters(constants, offsetof(Constants, parameters));
+
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, shader, constants, &constant_data, sizeof(constant_data));
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0],
+                                         VK_OBJECT_TYPE_SHADER_MODULE, (name + " Shader").c_str());
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                vulkan_renderer.device,
+                tile_descriptor_bindings(vulkan_renderer)
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout,
+                                         VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, (name + " Descriptor Set Layout").c_str());
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout,
+                {
+                    { VK_SHADER_STAGE_ALL, 0, sizeof(glm::mat4) + sizeof(float) } // model and LoD.
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout,
+                                         VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                                         (name + " Pipeline Layout").c_str());
+
+            pipeline.compute_pipeline = vk::ComputePipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages[0],
+                pipeline.pipeline_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.compute_pipeline,
+                                         VK_OBJECT_TYPE_PIPELINE, (name + " Pipeline").c_str());
+        }
+
+        void HairStyle::set_line_topology(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            if (vulkan_renderer.strip_topology) {
+                pipeline.fixed_stages.set_topology(VK_PRIMITIVE_TOPOLOGY_LINE_STRIP);
+                pipeline.fixed_stages.enable_primitive_restart();
+            } else {
+                pipeline.fixed_stages.set_topology(VK_PRIMITIVE_TOPOLOGY_LINE_LIST);
+            }
+        }
+
+        void HairStyle::add_vertex_inputs(Pipeline& pipeline, vkhr::HairStyle::Quantization quantization) {
+            if (quantization == vkhr::HairStyle::Quantization::Packed) {
+                // Everything is interleaved in one binding, thickness lives in the position's w.
+                pipeline.fixed_stages.add_vertex_binding(vk::VertexBinding { 0, sizeof(vkhr::HairStyle::QuantizedVertex), VK_VERTEX_INPUT_RATE_VERTEX });
+                pipeline.fixed_stages.add_vertex_attribute(vk::VertexAttribute { 0, 0, VK_FORMAT_R16G16B16A16_UNORM, 0 });
+                pipeline.fixed_stages.add_vertex_attribute(vk::VertexAttribute { 1, 0, VK_FORMAT_R16G16_SNORM,       8 });
+                pipeline.fixed_stages.add_vertex_attribute(vk::VertexAttribute { 2, 0, VK_FORMAT_R16_UNORM,          6 });
+            } else {
+                pipeline.fixed_stages.add_vertex_binding({ 0, 0, VK_FORMAT_R32G32B32_SFLOAT, sizeof(glm::vec3) });
+                pipeline.fixed_stages.add_vertex_binding({ 1, 1, VK_FORMAT_R32G32B32_SFLOAT, sizeof(glm::vec3) });
+                pipeline.fixed_stages.add_vertex_binding({ 2, 2, VK_FORMAT_R32_SFLOAT,       sizeof(float)     });
+            }
+        }
+
+        void HairStyle::reduce(float ratio) {
+            parameters.strand_ratio = ratio;
+            merged = false;
+        }
+
+        void HairStyle::merge(float ratio) {
+            auto level = std::lround(-std::log2(std::max(ratio, 1e-6f)));
+            merged_level = static_cast<unsigned>(std::clamp(level, 0l, static_cast<long>(merged_thickness.size())));
+            parameters.strand_ratio = get_merged_ratio(ratio);
+            merged = true;
+        }
+
+        float HairStyle::get_merged_ratio(float ratio) const {
+            auto level = std::lround(-std::log2(std::max(ratio, 1e-6f)));
+            return std::exp2(-static_cast<float>(std::clamp(level, 0l, static_cast<long>(merged_thickness.size()))));
+        }
+
+        bool HairStyle::is_mergeable() const {
+            return !merged_thickness.empty();
+        }
+
+        bool HairStyle::is_merged() const {
+            return merged;
+        }
+
+        vk::VertexBuffer& HairStyle::get_thickness() {
+            if (merged && merged_level != 0)
+                return merged_thickness[merged_level - 1];
+            return thickness;
+        }
+
+        std::size_t HairStyle::get_geometry_size() const {
+            if (quantization == vkhr::HairStyle::Quantization::Packed)
+                return segments.get_size() + strips.get_size() + curve_patches.get_size() + vertices.get_size();
 
-        std::size_t HairStyle::get_geometry_size() const {
             return segments.get_size() +
+                   strips.get_size() +
+                   curve_patches.get_size() +
                    vertices.get_size() +
                    tangents.get_size() +
-                   thickness.get_size();
+                   thickness.get_size() +
+                   merged_thickness.size() * thickness.get_size();
         }
 
         std::size_t HairStyle::get_volume_size() const {
             return density_volume.get_memory_requirements().size +
-                   tangent_volume.get_memory_requirements().size;
+                   tangent_volume.get_memory_requirements().size +
+                   density_mips.get_memory_requirements().size +
+                   tangent_mips.get_memory_requirements().size +
+                   transmittance_volume.get_memory_requirements().size +
+                   ambient_occlusion_volume.get_memory_requirements().size +
+                   distance_field.get_memory_requirements().size +
+                   occupancy_volume.get_memory_requirements().size +
+                   volume_bricks.get_size() +
+                   (impostor_loaded ? impostor_occlusion.get_memory_requirements().size +
+                                      impostor_tangents.get_memory_requirements().size : 0);
         }
 
         int HairStyle::id { 0 };
@@ -0,0 +1,305 @@
+#include <vkhr/rasterizer/hair_target.hh>
+
+#include <vkhr/rasterizer.hh>
+
+#include <vkpp/debug_marker.hh>
+
+#include <algorithm>
+#include <cmath>
+
+namespace vkhr {
+    namespace vulkan {
+        HairTarget::HairTarget(Rasterizer& vulkan_renderer)
+                              : width  { vulkan_renderer.swap_chain.get_width()  },
+                                height { vulkan_renderer.swap_chain.get_height() },
+                                vulkan_renderer { &vulkan_renderer } {
+            color_image = vk::Image {
+                vulkan_renderer.device,
+                width, height,
+                vulkan_renderer.swap_chain.get_color_attachment_format(),
+                get_color_usage_flags()
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, color_image, VK_OBJECT_TYPE_IMAGE, "Hair Target Color Image", id);
+
+            color_memory = vk::DeviceMemory {
+                vulkan_renderer.device,
+                color_image.get_memory_requirements(),
+                vk::DeviceMemory::Type::DeviceLocal
+            };
+
+            color_image.bind(color_memory);
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, color_memory, VK_OBJECT_TYPE_DEVICE_MEMORY, "Hair Target Color Device Memory", id);
+
+            // Resolved into and upscaled from in compute shaders, and the hair pass leaves it in it as well.
+            color_view = vk::ImageView {
+                vulkan_renderer.device,
+                color_image,
+                VK_IMAGE_LAYOUT_GENERAL
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, color_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Hair Target Color Image View", id);
+
+            depth_image = vk::Image {
+                vulkan_renderer.device,
+                width, height,
+                vulkan_renderer.swap_chain.get_depth_attachment_format(),
+                get_depth_usage_flags()
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, depth_image, VK_OBJECT_TYPE_IMAGE, "Hair Target Depth Image", id);
+
+            depth_memory = vk::DeviceMemory {
+                vulkan_renderer.device,
+                depth_image.get_memory_requirements(),
+                vk::DeviceMemory::Type::DeviceLocal
+            };
+
+            depth_image.bind(depth_memory);
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, depth_memory, VK_OBJECT_TYPE_DEVICE_MEMORY, "Hair Target Depth Device Memory", id);
+
+            // Same as the swapchain's, since it's the input attachment of the raymarcher and read by the software rasterizer.
+            depth_view = vk::ImageView {
+                vulkan_renderer.device,
+                depth_image,
+                vulkan_renderer.swap_chain.get_shader_read_only_layout()
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, depth_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Hair Target Depth Image View", id);
+
+            // They're in the layouts the hair pass leaves them in, so the render graph can import them the same each frame.
+            auto command_buffer = vulkan_renderer.command_pool.allocate_and_begin();
+
+            color_image.transition(command_buffer, 0, VK_ACCESS_SHADER_READ_BIT,
+                                   VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                                   VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+            depth_image.transition(command_buffer, 0, VK_ACCESS_SHADER_READ_BIT,
+                                   VK_IMAGE_LAYOUT_UNDEFINED, vulkan_renderer.swap_chain.get_shader_read_only_layout(),
+                                   VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+            command_buffer.end();
+            vulkan_renderer.command_pool.get_queue().submit(command_buffer).wait_idle();
+
+            framebuffer = vk::Framebuffer {
+                vulkan_renderer.device.get_handle(),
+                vulkan_renderer.hair_pass,
+                color_view, depth_view,
+                VkExtent2D {
+                    width, height
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, framebuffer, VK_OBJECT_TYPE_FRAMEBUFFER, "Hair Target Framebuffer", id);
+
+            // The upscale does its own filtering of only the taps with hair.
+            sampler = vk::Sampler {
+                vulkan_renderer.device,
+                VK_FILTER_NEAREST,
+                VK_FILTER_NEAREST,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, sampler, VK_OBJECT_TYPE_SAMPLER, "Hair Target Sampler", id);
+
+            set_render_scale(render_scale);
+
+            ++id;
+        }
+
+        void HairTarget::set_render_scale(float scale) {
+            render_scale = std::clamp(scale, MinimumScale, 1.0f);
+
+            std::uint32_t scaled_width  = std::max(static_cast<std::uint32_t>(std::floor(width  * render_scale + 0.5f)), 1u);
+            std::uint32_t scaled_height = std::max(static_cast<std::uint32_t>(std::floor(height * render_scale + 0.5f)), 1u);
+
+            viewport = VkViewport {
+                0.0f, 0.0f,
+                static_cast<float>(scaled_width),
+                static_cast<float>(scaled_height),
+                0.0f, 1.0f
+            };
+
+            scissor = VkRect2D {
+                { 0, 0 },
+                { scaled_width, scaled_height }
+            };
+        }
+
+        float HairTarget::get_render_scale() const {
+            return render_scale;
+        }
+
+        VkExtent2D HairTarget::get_extent() const {
+            return scissor.extent;
+        }
+
+        void HairTarget::update_dynamic_viewport_scissor_depth(vk::CommandBuffer& command_list) {
+            command_list.set_viewport(viewport);
+            command_list.set_scissor(scissor);
+        }
+
+        void HairTarget::downsample(vk::SwapChain& swap_chain, std::uint32_t frame, std::uint32_t image,
+                                    Pipeline& pipeline, vk::CommandBuffer& command_buffer) {
+            command_buffer.bind_pipeline(pipeline);
+
+            pipeline.descriptor_sets[frame].write(9,  swap_chain.get_depth_buffer_view(), vulkan_renderer->depth_sampler);
+            pipeline.descriptor_sets[frame].write(10, swap_chain.get_general_image_views()[image]);
+
+            command_buffer.bind_descriptor_set(pipeline.descriptor_sets[frame], pipeline);
+
+            update_dynamic_viewport_scissor_depth(command_buffer);
+
+            command_buffer.draw(3); // covers the target.
+        }
+
+        void HairTarget::upscale(vk::SwapChain& swap_chain, std::uint32_t frame, std::uint32_t image,
+                                 Pipeline& pipeline, vk::CommandBuffer& command_buffer) {
+            command_buffer.bind_pipeline(pipeline);
+
+            pipeline.descriptor_sets[frame].write(9,  swap_chain.get_general_image_views()[image]);
+            pipeline.descriptor_sets[frame].write(10, color_view, sampler);
+
+            command_buffer.bind_descriptor_set(pipeline.descriptor_sets[frame], pipeline);
+
+            command_buffer.dispatch(std::ceil(width / 8.0), std::ceil(height / 8.0));
+        }
+
+        void HairTarget::build_downsample_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+
+            pipeline.fixed_stages.set_topology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+
+            pipeline.fixed_stages.set_scissor({ 0, 0, vulkan_renderer.swap_chain.get_extent() });
+            pipeline.fixed_stages.set_viewport({ 0.0, 0.0,
+                                                 static_cast<float>(vulkan_renderer.swap_chain.get_width()),
+                                                 static_cast<float>(vulkan_renderer.swap_chain.get_height()),
+                                                 0.0, 1.0 });
+
+            pipeline.fixed_stages.add_dynamic_state(VK_DYNAMIC_STATE_VIEWPORT);
+            pipeline.fixed_stages.add_dynamic_state(VK_DYNAMIC_STATE_SCISSOR);
+
+            // Depth writes need the test enabled, but it's what clears the target.
+            pipeline.fixed_stages.enable_depth_test();
+            pipeline.fixed_stages.set_depth_test_compare(VK_COMPARE_OP_ALWAYS);
+            pipeline.fixed_stages.set_culling_mode(VK_CULL_MODE_NONE);
+            pipeline.fixed_stages.disable_blending_for(0);
+
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("volumes/upsample.vert"));
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0], VK_OBJECT_TYPE_SHADER_MODULE, "Hair Downsample Vertex Shader");
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("dynamic_resolution/downsample.frag"));
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[1], VK_OBJECT_TYPE_SHADER_MODULE, "Hair Downsample Fragment Shader");
+
+            std::vector<vk::DescriptorSet::Binding> descriptor_bindings {
+                { 9,  VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 10, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE }
+            };
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout { vulkan_renderer.device, descriptor_bindings };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Hair Downsample Descriptor Set Layout");
+
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
+                                                                                pipeline.descriptor_set_layout,
+                                                                                "Hair Downsample Descriptor Set");
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Hair Downsample Pipeline Layout");
+
+            pipeline.pipeline = vk::GraphicsPipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages,
+                pipeline.fixed_stages,
+                pipeline.pipeline_layout,
+                vulkan_renderer.hair_pass
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline, VK_OBJECT_TYPE_PIPELINE, "Hair Downsample Graphics Pipeline");
+        }
+
+        void HairTarget::build_upscale_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline */ };
+
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("dynamic_resolution/upscale.comp"));
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0],
+                                         VK_OBJECT_TYPE_SHADER_MODULE, "Hair Upscale");
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                vulkan_renderer.device,
+                {
+                    { 0,  VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                    { 9,  VK_DESCRIPTOR_TYPE_STORAGE_IMAGE },
+                    { 10, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER }
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout,
+                                         VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Hair Upscale Descriptor Set Layout");
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
+                                                                                pipeline.descriptor_set_layout,
+                                                                                "Hair Upscale Descriptor Set");
+
+            for (std::size_t i { 0 }; i < pipeline.descriptor_sets.size(); ++i) {
+                pipeline.descriptor_sets[i].write(0, vulkan_renderer.frame_constants[i], vulkan_renderer.camera[i]);
+            }
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout,
+                                         VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                                         "Hair Upscale Pipeline Layout");
+
+            pipeline.compute_pipeline = vk::ComputePipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages[0],
+                pipeline.pipeline_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.compute_pipeline,
+                                         VK_OBJECT_TYPE_PIPELINE, "Hair Upscale Pipeline");
+        }
+
+        VkImageUsageFlags HairTarget::get_color_usage_flags() {
+            return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                   VK_IMAGE_USAGE_STORAGE_BIT |
+                   VK_IMAGE_USAGE_SAMPLED_BIT;
+        }
+
+        VkImageUsageFlags HairTarget::get_depth_usage_flags() {
+            return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT |
+                   VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT |
+                   VK_IMAGE_USAGE_SAMPLED_BIT;
+        }
+
+        vk::Framebuffer& HairTarget::get_framebuffer() {
+            return framebuffer;
+        }
+
+        vk::Image& HairTarget::get_color_image() {
+            return color_image;
+        }
+
+        vk::ImageView& HairTarget::get_color_view() {
+            return color_view;
+        }
+
+        vk::Image& HairTarget::get_depth_image() {
+            return depth_image;
+        }
+
+        vk::ImageView& HairTarget::get_depth_view() {
+            return depth_view;
+        }
+
+        int HairTarget::id { 0 };
+    }
+}
@@ -12,7 +12,10 @@
 #include <iostream>
 #include <iomanip>
 #include <utility>
+#include <algorithm>
+#include <numeric>
 
+#include <cmath>
 #include <ctime>
 #include <cstring>
 #include <cstdio>
@@ -67,6 +70,14 @@ namespace vkhr {
         ImGui_ImplVulkan_InvalidateFontUploadObjects();
 
         default_parameters();
+
+        if (vulkan_renderer.mesh_shading) {
+            strand_expansions[1] = "Mesh Shaded Lines";
+            strand_expansions[2] = "Mesh Shaded Quads";
+        }
+
+        if (!vulkan_renderer.tessellated_curves)
+            strand_expansions.pop_back();
     }
 
     void Interface::default_parameters() {
@@ -74,6 +85,9 @@ namespace vkhr {
         simulations.clear();
         scene_files.clear();
         shaders.clear();
+        strand_expansions.clear();
+        transparencies.clear();
+        cost_views.clear();
 
         renderers.push_back("Rasterizer");
         renderers.push_back("Ray Tracer");
@@ -84,14 +98,32 @@ namespace vkhr {
         scene_files.push_back(SCENE("bear.vkhr"));
 
         simulations.push_back("No Effects");
+        simulations.push_back("Strand Simulation");
+        simulations.push_back("Strands with Wind");
 
         shaders.push_back("Kajiya-Kay and Blinn-Phong");
         shaders.push_back("Combined Shadow Map and AO");
         shaders.push_back("Local Shadow Map Occlusion");
         shaders.push_back("Ambient Occlusion (Volume)");
 
+        cost_views.push_back("No Cost Heatmap");
+        cost_views.push_back("PPLL Fragments");
+        cost_views.push_back("Raymarch Steps");
+        cost_views.push_back("Ray Tracer Time (us)");
+
         shadow_maps.push_back("Conventional Shadow Maps");
         shadow_maps.push_back("Approximate Deep Shadows");
+        shadow_maps.push_back("Deep Opacity Maps");
+        shadow_maps.push_back("Transmittance Volume");
+
+        strand_expansions.push_back("Vertex Input Lines");
+        strand_expansions.push_back("Vertex Pulled Lines");
+        strand_expansions.push_back("Vertex Pulled Quads");
+        strand_expansions.push_back("Tessellated Curves");
+
+        transparencies.push_back("Per-Pixel Linked Lists");
+        transparencies.push_back("Weighted Blended OIT");
+        transparencies.push_back("Depth Sorted Segments");
 
         shadow_samplers.push_back("  Uniform");
         shadow_samplers.push_back("  Poisson");
@@ -100,9 +132,16 @@ namespace vkhr {
     }
 
     void Interface::transform(SceneGraph& scene_graph, Rasterizer& rasterizer, Raytracer& ray_tracer) {
-        ImGui_ImplVulkan_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
+        ImGui_ImplGlfw_NewFrame(); // the input, which is all overlay_changed needs.
+
+        bool build_overlay = !overlay_cached() || overlay_changed();
+
+        if (build_overlay) {
+            ImGui_ImplVulkan_NewFrame();
+            ImGui::NewFrame();
+        }
+
+        record_frame_times(rasterizer);
 
         if (light_rotation) {
             auto direction = scene_graph.light_sources.front().get_direction();
@@ -110,7 +149,32 @@ namespace vkhr {
             scene_graph.light_sources.front().set_direction(direction);
         }
 
-        if (gui_visible) {
+        // Here instead of where they're changed, since the parameters can be set from elsewhere too.
+        if (ray_tracer.marschner_shading != static_cast<bool>(parameters.marschner_shading) ||
+            (parameters.marschner_shading && ray_tracer.scattering_lut.needs_baking(get_hair_fiber()))) {
+            ray_tracer.stop_background(); // it restarts next frame.
+            ray_tracer.marschner_shading = parameters.marschner_shading;
+            if (parameters.marschner_shading)
+                ray_tracer.scattering_lut.bake(get_hair_fiber());
+            ray_tracer.now_dirty = true;
+        }
+
+        // The raymarched volumes on the CPU are found and shaded like the ones on the GPU.
+        embree::Volume::Settings raymarch_settings {
+            parameters.isosurface, static_cast<unsigned>(std::max(parameters.raycast_steps, 1.0f)),
+            parameters.occlusion_radius, parameters.ao_exponent, parameters.ao_clamp
+        };
+
+        if (ray_tracer.raymarch_settings != raymarch_settings) {
+            if (ray_tracer.raymarching) {
+                ray_tracer.stop_background(); // it restarts next frame.
+                ray_tracer.now_dirty = true;
+            }
+
+            ray_tracer.raymarch_settings = raymarch_settings;
+        }
+
+        if (gui_visible && build_overlay) {
             auto& window = rasterizer.window_surface.get_glfw_window();
 
             ImGui::Begin(" Real-Time Hybrid Hair Renderer in Vulkan",
@@ -130,8 +194,7 @@ namespace vkhr {
             ImGui::SameLine(0.0f, 10.0f);
 
             if (ImGui::Button("Take Screenshot"))
-                rasterizer.get_screenshot(scene_graph, ray_tracer)
-                          .save_time();
+                rasterizer.save_screenshot(); // of the next frame, by date/time.
 
             ImGui::SameLine();
 
@@ -164,6 +227,13 @@ namespace vkhr {
                 ImGui::SameLine(0.0, 8.0);
                 ImGui::DragFloat("Minified", &parameters.lod_minified_distance);
                 ImGui::PopItemWidth();
+                ImGui::SameLine();
+                ImGui::Checkbox("Dithered", reinterpret_cast<bool*>(&parameters.lod_dithering));
+                ImGui::PushItemWidth(94);
+                ImGui::DragFloat("Impostor", &parameters.lod_impostor_distance);
+                ImGui::PopItemWidth();
+                ImGui::SameLine();
+                ImGui::Checkbox("Impostors", reinterpret_cast<bool*>(&parameters.impostors));
             }
 
             ImGui::Spacing();
@@ -179,6 +249,25 @@ namespace vkhr {
                 ray_tracer.now_dirty = true;
             }
 
+            ImGui::PushItemWidth(171);
+            if (ImGui::Combo("##Cost View",
+                             &parameters.cost_view,
+                             get_string_from_vector,
+                             static_cast<void*>(&cost_views),
+                             cost_views.size())) {
+                ray_tracer.trace_cost = parameters.cost_view == TraceCost;
+                ray_tracer.now_dirty = true;
+            }
+            ImGui::PopItemWidth();
+            ImGui::SameLine();
+            ImGui::PushItemWidth(80);
+            if (ImGui::DragFloat("Range", &parameters.cost_view_range, 1.0f, 1.0f, 4096.0f, "%.0f")) {
+                ray_tracer.trace_cost_range = parameters.cost_view_range;
+                if (ray_tracer.trace_cost)
+                    ray_tracer.now_dirty = true;
+            }
+            ImGui::PopItemWidth();
+
             ImGui::Spacing();
             ImGui::Separator();
             ImGui::Spacing();
@@ -195,14 +284,15 @@ namespace vkhr {
 
                     ImGui::SameLine();
 
-                    if (parameters.shadow_technique == ApproximateDeepShadows) {
+                    // The deep opacity maps are filtered (and toggled) like the approximate deep shadows.
+                    if (parameters.shadow_technique != ConventionalShadowMaps) {
                         ImGui::Checkbox("Shadow Maps", reinterpret_cast<bool*>(&parameters.adsm_on));
                     } else if (parameters.shadow_technique == ConventionalShadowMaps) {
                         ImGui::Checkbox("Shadow Maps", reinterpret_cast<bool*>(&parameters.ctsm_on));
                     }
 
                     ImGui::PushItemWidth(171);
-                    if (parameters.shadow_technique == ApproximateDeepShadows) {
+                    if (parameters.shadow_technique != ConventionalShadowMaps) {
                         ImGui::SliderInt("PCF", &parameters.adsm_kernel_size, 1, 5);
                     } else if (parameters.shadow_technique == ConventionalShadowMaps) {
                         ImGui::SliderInt("PCF", &parameters.ctsm_kernel_size, 1, 5);
@@ -212,7 +302,7 @@ namespace vkhr {
                     ImGui::SameLine();
 
                     ImGui::PushItemWidth(99);
-                    if (parameters.shadow_technique == ApproximateDeepShadows) {
+                    if (parameters.shadow_technique != ConventionalShadowMaps) {
                         ImGui::Combo("##Shadow Sampler",
                                      reinterpret_cast<int*>(&parameters.adsm_sampling_type),
                                      get_string_from_vector,
@@ -228,7 +318,7 @@ namespace vkhr {
                     ImGui::PopItemWidth();
 
                     ImGui::PushItemWidth(171);
-                    if (parameters.shadow_technique == ApproximateDeepShadows) {
+                    if (parameters.shadow_technique != ConventionalShadowMaps) {
                         ImGui::SliderInt("ADSM Sample Jitter", &parameters.adsm_stride_size, 1, 15, "%.1f");
                     } else if (parameters.shadow_technique == ConventionalShadowMaps) {
                         if (ImGui::DragFloat("Shadow Bias Values", &parameters.ctsm_bias, 0.0000001f, 0.0f, 0.0f, "%.7f"))
@@ -241,6 +331,132 @@ namespace vkhr {
 
                     ImGui::PopItemWidth();
 
+                    ImGui::Checkbox("Precomputed AO Volume", reinterpret_cast<bool*>(&parameters.ao_volume));
+                    ImGui::SameLine();
+                    ImGui::Checkbox("Multiview Shadows", reinterpret_cast<bool*>(&parameters.multiview_shadows));
+                    ImGui::Checkbox("Light Culling", reinterpret_cast<bool*>(&parameters.light_culling));
+                    ImGui::SameLine();
+                    ImGui::Checkbox("Batched Shadows", reinterpret_cast<bool*>(&parameters.batched_depth));
+                    ImGui::Checkbox("Adaptive Shadow Maps", reinterpret_cast<bool*>(&parameters.adaptive_shadows));
+                    ImGui::Checkbox("Opaque Depth", reinterpret_cast<bool*>(&parameters.opaque_depth));
+
+                    if (parameters.shadow_technique == ApproximateDeepShadows) {
+                        ImGui::Checkbox("Prefiltered Deep Shadows", reinterpret_cast<bool*>(&parameters.adsm_prefiltered));
+                        if (!parameters.adsm_prefiltered) {
+                            ImGui::SameLine();
+                            ImGui::Checkbox("Linear Depths", reinterpret_cast<bool*>(&parameters.linear_shadow_maps));
+                        }
+                    }
+
+                    ImGui::Checkbox("Strand Culling", reinterpret_cast<bool*>(&parameters.strand_culling));
+                    ImGui::SameLine();
+                    ImGui::PushItemWidth(143);
+                    ImGui::Combo("##Strand Expansion",
+                                 &parameters.strand_expansion,
+                                 get_string_from_vector,
+                                 static_cast<void*>(&strand_expansions),
+                                 strand_expansions.size());
+                    ImGui::PopItemWidth();
+
+                    ImGui::Checkbox("Line Strip Indices", reinterpret_cast<bool*>(&parameters.line_strips));
+                    ImGui::SameLine();
+                    ImGui::Checkbox("Specialized Shaders", reinterpret_cast<bool*>(&parameters.specialized_shaders));
+
+                    ImGui::Checkbox("Compute Rasterize Thin Strands", reinterpret_cast<bool*>(&parameters.software_rasterizer));
+                    ImGui::Checkbox("Temporal Anti-Aliasing", reinterpret_cast<bool*>(&parameters.temporal_anti_aliasing));
+
+                    ImGui::PushItemWidth(171);
+                    ImGui::SliderFloat("Hair Render Scale", &parameters.render_scale, vulkan::HairTarget::MinimumScale, 1.0f, "%.2f");
+                    ImGui::PopItemWidth();
+
+                    if (rasterizer.shading_rate_images)
+                        ImGui::Checkbox("Variable Rate Shading", reinterpret_cast<bool*>(&parameters.variable_rate_shading));
+
+                    if (ImGui::Checkbox("Reduce Strands", reinterpret_cast<bool*>(&parameters.strand_reduction)) && !parameters.strand_reduction) {
+                        for (auto& hair_style : rasterizer.hair_styles) {
+                            hair_style.second.reduce(1.0f); // back to all of them.
+                            hair_style.second.update_parameters();
+                        }
+                    }
+
+                    ImGui::SameLine();
+                    ImGui::PushItemWidth(100);
+                    ImGui::DragFloat("Strands/Pixel", &parameters.strands_per_pixel, 0.05f, 0.05f, 16.0f, "%.2f");
+                    ImGui::PopItemWidth();
+                    ImGui::SameLine();
+                    ImGui::Checkbox("Merge", reinterpret_cast<bool*>(&parameters.strand_merging));
+                    ImGui::Checkbox("Parallel Command Recording", reinterpret_cast<bool*>(&parameters.parallel_recording));
+                    ImGui::SameLine();
+                    ImGui::Checkbox("Static Batches", reinterpret_cast<bool*>(&parameters.static_batches));
+                    ImGui::Checkbox("On-Demand Rendering", reinterpret_cast<bool*>(&parameters.on_demand));
+                    ImGui::SameLine();
+                    ImGui::Checkbox("Low-Latency Input", reinterpret_cast<bool*>(&parameters.low_latency));
+
+                    auto& quality_controller = rasterizer.quality_controller;
+                    bool dynamic_quality { quality_controller.is_enabled() };
+                    if (ImGui::Checkbox("Dynamic Quality", &dynamic_quality)) {
+                        if (dynamic_quality) quality_controller.enable(parameters);
+                        else quality_controller.disable(parameters);
+                    }
+
+                    ImGui::SameLine();
+                    ImGui::PushItemWidth(100);
+                    ImGui::DragFloat("Hair Budget", &quality_controller.budget, 0.1f, 0.5f, 100.0f, "%.1f ms");
+                    ImGui::PopItemWidth();
+
+                    if (quality_controller.is_enabled()) {
+                        ImGui::Text("Level %d/%d at %.2f ms", quality_controller.get_level(),
+                                                              QualityController::Levels - 1,
+                                                              quality_controller.get_hair_time());
+                    }
+
+                    ImGui::PushItemWidth(171);
+                    ImGui::Combo("Transparency",
+                                 &parameters.transparency,
+                                 get_string_from_vector,
+                                 static_cast<void*>(&transparencies),
+                                 transparencies.size());
+                    ImGui::PopItemWidth();
+
+                    ImGui::Checkbox("Deferred Shading", reinterpret_cast<bool*>(&parameters.deferred_shading));
+                    ImGui::SameLine();
+                    ImGui::Checkbox("Packed Nodes", reinterpret_cast<bool*>(&parameters.packed_ppll));
+
+                    ImGui::Checkbox("Adaptive PPLL", reinterpret_cast<bool*>(&parameters.adaptive_ppll));
+                    ImGui::SameLine();
+                    ImGui::PushItemWidth(116);
+                    ImGui::DragInt("Tile Budget", &parameters.ppll_tile_budget, 16.0f, 0, 16384);
+                    ImGui::PopItemWidth();
+
+                    const auto& ppll_statistics = rasterizer.ppll.get_statistics();
+                    auto ppll_node_count = rasterizer.ppll.get_node_count();
+                    ImGui::Text("PPLL: %.0f MB, %.1f%% used, %u lost",
+                                rasterizer.ppll.get_nodes_size_in_bytes() / static_cast<float>(1 << 20),
+                                100.0f * std::min<std::size_t>(ppll_statistics.fragments, ppll_node_count) / ppll_node_count,
+                                ppll_statistics.overflow);
+
+                    auto memory_statistics = rasterizer.device.get_memory_statistics();
+                    ImGui::Text("GPU: %.0f/%.0f MB, %u blocks, %u dedicated",
+                                memory_statistics.used     / static_cast<float>(1 << 20),
+                                memory_statistics.reserved / static_cast<float>(1 << 20),
+                                memory_statistics.blocks,
+                                memory_statistics.dedicated_allocations);
+
+                    const auto& frame_latency = rasterizer.get_frame_latency();
+                    ImGui::Text("Frames: %u in flight, %.1f ms wait, %.1f ms latency (%.1f peak)",
+                                rasterizer.get_frames_in_flight(),
+                                frame_latency.cpu_wait,
+                                frame_latency.latency,
+                                frame_latency.peak_latency);
+                    ImGui::Text("Input: %.1f ms to %s (%.1f peak)",
+                                frame_latency.input_latency,
+                                frame_latency.input_to_display ? "display" : "GPU done",
+                                frame_latency.peak_input_latency);
+
+                    ImGui::Checkbox("Frame and Memory HUD", &hud_visible);
+                    ImGui::SameLine();
+                    ImGui::Checkbox("Cached Overlay", reinterpret_cast<bool*>(&parameters.cached_overlay));
+
                     ImGui::TreePop();
                 }
 
@@ -252,6 +468,11 @@ namespace vkhr {
                     ImGui::SameLine();
                     if (ImGui::Checkbox("Shadow Rays", &ray_tracer.shadows_on))
                         ray_tracer.now_dirty = true;
+                    bool raymarching { ray_tracer.raymarching };
+                    if (ImGui::Checkbox("CPU Raymarcher", &raymarching))
+                        ray_tracer.set_raymarching(raymarching);
+                    if (rasterizer.ray_queries)
+                        ImGui::Checkbox("GPU Ray Queries", reinterpret_cast<bool*>(&parameters.gpu_raytracing));
                     ImGui::TreePop();
                 }
 
@@ -260,6 +481,24 @@ namespace vkhr {
                     ImGui::SliderFloat("Isosurface Density", &parameters.isosurface,    0.0f, 0.2f);
                     ImGui::SliderFloat("Raycasting Samples", &parameters.raycast_steps, 0.0, 1024, "%.0f");
                     ImGui::PopItemWidth();
+                    ImGui::Checkbox("Scaled Resolution", reinterpret_cast<bool*>(&parameters.scaled_raymarch));
+                    ImGui::SameLine();
+                    ImGui::Checkbox("Temporal Accumulation", reinterpret_cast<bool*>(&parameters.temporal_accumulation));
+                    ImGui::Checkbox("Mip Levels From Afar", reinterpret_cast<bool*>(&parameters.raymarch_mips));
+                    ImGui::SameLine();
+                    ImGui::Checkbox("Sphere Tracing", reinterpret_cast<bool*>(&parameters.sphere_tracing));
+                    ImGui::Checkbox("Adaptive Step Sizes", reinterpret_cast<bool*>(&parameters.adaptive_steps));
+                    ImGui::TreePop();
+                }
+
+                if (ImGui::TreeNodeEx("Hair Fiber")) {
+                    ImGui::PushItemWidth(171);
+                    ImGui::SliderFloat("Cuticle Tilt", &parameters.marschner_shift, -15.0f, 0.0f, "%.1f");
+                    ImGui::SliderFloat("Longitudinal Width", &parameters.marschner_width, 1.0f, 20.0f, "%.1f");
+                    ImGui::SliderFloat("Azimuthal Width", &parameters.marschner_azimuthal_width, 1.0f, 90.0f, "%.1f");
+                    ImGui::SliderFloat("Refraction Index", &parameters.marschner_eta, 1.0f, 2.0f, "%.2f");
+                    ImGui::PopItemWidth();
+                    ImGui::Checkbox("Marschner Instead of Kajiya-Kay", reinterpret_cast<bool*>(&parameters.marschner_shading));
                     ImGui::TreePop();
                 }
             }
@@ -296,8 +535,15 @@ namespace vkhr {
                 if (ImGui::TreeNode("Lights")) {
                     for (auto& light : scene_graph.light_sources) {
                         if (ImGui::TreeNode(light.get_type_name().c_str())) {
-                            if (ImGui::ColorEdit3("Highlights", glm::value_ptr(light.buffer.intensity), ImGuiColorEditFlags_Float))
+                            if (ImGui::ColorEdit3("Highlights", glm::value_ptr(light.buffer.intensity), ImGuiColorEditFlags_Float)) {
+                                light.buffer_dirty = true;
                                 ray_tracer.now_dirty = true;
+                            }
+                            if (light.get_type() == LightSource::Type::Point &&
+                                ImGui::DragFloat("Range", &light.buffer.range, 1.0f, 0.0f, 10000.0f)) {
+                                light.buffer_dirty = true;
+                                ray_tracer.now_dirty = true;
+                            }
                             ImGui::TreePop();
                         }
                     }
@@ -330,6 +576,35 @@ namespace vkhr {
                          static_cast<void*>(&simulations),
                          simulations.size());
 
+            auto& simulation = rasterizer.simulation;
+
+            simulation.enabled = simulation_effect != 0;
+
+            if (simulation_effect == 2) {
+                ImGui::PushItemWidth(171);
+                ImGui::SliderFloat("Wind Strength", &simulation.wind_strength, 0.0f, 32.0f, "%.1f");
+                ImGui::PopItemWidth();
+            } else {
+                simulation.wind_strength = 0.0f;
+            }
+
+            if (simulation.enabled) {
+                ImGui::PushItemWidth(171);
+                ImGui::SliderFloat("Velocity Damping", &simulation.damping,          0.0f, 1.0f);
+                ImGui::SliderFloat("Global Stiffness", &simulation.global_stiffness, 0.0f, 1.0f);
+                ImGui::SliderFloat("Global Range",     &simulation.global_range,     0.0f, 1.0f);
+                ImGui::SliderFloat("Local Stiffness",  &simulation.local_stiffness,  0.0f, 1.0f);
+                ImGui::PopItemWidth();
+
+                ImGui::Checkbox("Only Simulate Guide Strands", &simulation.follow_hair);
+
+                ImGui::Checkbox("Model Collisions", &simulation.collisions);
+                ImGui::SameLine();
+                ImGui::PushItemWidth(87);
+                ImGui::DragFloat("Margin", &simulation.collision_margin, 0.001f, 0.0f, 0.5f, "%.3f");
+                ImGui::PopItemWidth();
+            }
+
             ImGui::Spacing();
             ImGui::Separator();
             ImGui::Spacing();
@@ -341,15 +616,87 @@ namespace vkhr {
                                      profile.second.timestamps.size(),
                                      profile.second.offset,
                                      profile.second.output.c_str());
+
+                ImGui::Checkbox("Pipeline Statistics", reinterpret_cast<bool*>(&parameters.pipeline_statistics));
+
+                if (parameters.pipeline_statistics) {
+                    for (auto& section : pipeline_statistics) {
+                        if (ImGui::TreeNode(section.first.c_str())) {
+                            ImGui::Text("Vertex Invocations:   %llu", static_cast<unsigned long long>(section.second.vertex_invocations));
+                            ImGui::Text("Geometry Invocations: %llu", static_cast<unsigned long long>(section.second.geometry_invocations));
+                            ImGui::Text("Clipped Primitives:   %llu", static_cast<unsigned long long>(section.second.clipping_primitives));
+                            ImGui::Text("Fragment Invocations: %llu", static_cast<unsigned long long>(section.second.fragment_invocations));
+                            ImGui::Text("Compute Invocations:  %llu", static_cast<unsigned long long>(section.second.compute_invocations));
+                            ImGui::TreePop();
+                        }
+                    }
+
+                    ImGui::Text("PPLL Fragments: %zu", ppll_fragments);
+                }
             }
 
             ImGui::End();
+
+            if (hud_visible)
+                draw_hud(rasterizer);
         }
 
         if (scene_graph.camera.viewing_plane_dirty)
             ray_tracer.now_dirty = true;
 
-        ImGui::Render();
+        // The simulated strands are refit into the BVHs every step (see Rasterizer::simulate), and
+        // the ones at rest are built properly again, since they're traced far more times than built.
+        auto scene_flags = rasterizer.simulation.enabled ? RTC_SCENE_FLAG_DYNAMIC : RTC_SCENE_FLAG_NONE;
+        if (ray_tracer.scene_flags != scene_flags) {
+            if (rasterizer.simulation.enabled)
+                ray_tracer.set_build_quality(RTC_BUILD_QUALITY_REFIT, RTC_BUILD_QUALITY_REFIT, scene_flags);
+            else
+                ray_tracer.set_build_quality(RTC_BUILD_QUALITY_MEDIUM, RTC_BUILD_QUALITY_MEDIUM, scene_flags);
+            if (ray_tracer.is_loaded())
+                ray_tracer.load(scene_graph);
+        }
+
+        if (build_overlay) {
+            ImGui::Render();
+
+            overlay_time = std::chrono::steady_clock::now();
+            overlay_display_size = ImGui::GetIO().DisplaySize;
+            overlay_mouse_position = ImGui::GetIO().MousePos;
+            overlay_gui_visible = gui_visible;
+            overlay_hud_visible = hud_visible;
+            overlay_parameters = parameters;
+            ++overlay_revision;
+        }
+    }
+
+    bool Interface::overlay_changed() {
+        const auto& io = ImGui::GetIO();
+
+        // Anything ImGui reacts to, with the widgets that are being dragged or typed into, which
+        // might not be getting any input in this frame, and the frame after the input stopped.
+        bool input = io.MouseWheel != 0.0f || ImGui::IsAnyItemActive() || io.WantTextInput ||
+                     std::any_of(std::begin(io.MouseDown), std::end(io.MouseDown), [](bool down) { return down; }) ||
+                     std::any_of(std::begin(io.KeysDown),  std::end(io.KeysDown),  [](bool down) { return down; });
+
+        bool changed = input || overlay_input;
+        overlay_input = input;
+
+        // Or what's shown, e.g. after the shortcuts, resizing, a moved cursor, or the newer timings.
+        changed |= io.DisplaySize.x != overlay_display_size.x || io.DisplaySize.y != overlay_display_size.y;
+        changed |= io.MousePos.x != overlay_mouse_position.x || io.MousePos.y != overlay_mouse_position.y;
+        changed |= gui_visible != overlay_gui_visible || hud_visible != overlay_hud_visible;
+        changed |= std::memcmp(&parameters, &overlay_parameters, sizeof(parameters)) != 0;
+        changed |= std::chrono::steady_clock::now() - overlay_time >= OverlayRefresh;
+
+        return changed;
+    }
+
+    bool Interface::overlay_cached() const {
+        return parameters.cached_overlay || parameters.benchmarking;
+    }
+
+    std::size_t Interface::get_overlay_revision() const {
+        return overlay_revision;
     }
 
     void Interface::traverse(SceneGraph& scene_graph, Rasterizer& rasterizer, Raytracer& ray_tracer) {
@@ -393,9 +740,12 @@ namespace vkhr {
                         if (ImGui::SliderFloat("Ratio", &hair.parameters.strand_ratio,   0.0f, 1.0f))
                             parameters_dirty = true;
                         ImGui::PopItemWidth();
+                        if (ImGui::Checkbox("Dual Scattering", reinterpret_cast<bool*>(&hair.parameters.dual_scattering)))
+                            parameters_dirty = true;
 
                         if (parameters_dirty) {
                             hair.update_parameters(); // update rasterizer hairs.
+                            ray_tracer.stop_background(); // it restarts next frame.
                             for (auto& raytracer_hair : ray_tracer.hair_styles) {
                                 if (raytracer_hair.get_pointer() == hair_style)
                                     raytracer_hair.update_parameters(hair);
@@ -449,6 +799,10 @@ namespace vkhr {
         gui_visible = visible;
     }
 
+    bool Interface::is_visible() const {
+        return gui_visible;
+    }
+
     bool Interface::hide() {
         auto previous_visibility = gui_visible;
         gui_visible = false;
@@ -459,6 +813,122 @@ namespace vkhr {
         gui_visible = !gui_visible;
     }
 
+    void Interface::toggle_hud() {
+        hud_visible = !hud_visible;
+    }
+
+    void Interface::record_frame_times(Rasterizer& rasterizer) {
+        if (frame_intervals.empty()) {
+            cpu_frame_times.resize(HudFrames, 0.0f);
+            gpu_frame_times.resize(HudFrames, 0.0f);
+            frame_intervals.resize(HudFrames, 0.0f);
+        }
+
+        const auto& frame_latency = rasterizer.get_frame_latency();
+        cpu_frame_times[hud_offset] = frame_latency.cpu_time;
+        frame_intervals[hud_offset] = frame_latency.frame_interval;
+
+        // The latest timestamps of the GPU, which are from a frame or two behind the CPU one.
+        gpu_frame_times[hud_offset] = get_latest_timestamp("Total Frame Time");
+
+        hud_offset = (hud_offset + 1) % HudFrames;
+    }
+
+    void Interface::draw_hud(Rasterizer& rasterizer) {
+        ImGui::Begin("Frame and Memory HUD", &hud_visible, ImGuiWindowFlags_AlwaysAutoResize |
+                                                           ImGuiWindowFlags_NoCollapse);
+
+        auto latest = (hud_offset + HudFrames - 1) % HudFrames;
+        ImGui::Text("CPU: %5.2f ms, GPU: %5.2f ms, Frame: %5.2f ms",
+                    cpu_frame_times[latest],
+                    gpu_frame_times[latest],
+                    frame_intervals[latest]);
+
+        std::vector<float> sorted_intervals { frame_intervals };
+        std::nth_element(sorted_intervals.begin(), sorted_intervals.begin() + HudFrames / 2, sorted_intervals.end());
+        auto hitch_interval = sorted_intervals[HudFrames / 2] * HitchFactor;
+
+        auto maximum_interval = *std::max_element(frame_intervals.begin(), frame_intervals.end());
+
+        const ImVec2 graph_size { 320, 80 };
+        ImGui::PlotLines("Frame Time", frame_intervals.data(), HudFrames, hud_offset,
+                         nullptr, 0.0f, std::max(maximum_interval, 1.0f), graph_size);
+
+        // Marks the frames that took much longer than the ones around them, e.g. the paging.
+        // The item's rectangle has the label after the graph too, so only the graph_size is.
+        auto graph_min = ImGui::GetItemRectMin(),
+             graph_max = ImGui::GetItemRectMax();
+        auto graph_width = graph_size.x;
+        auto draw_list = ImGui::GetWindowDrawList();
+
+        std::size_t hitches { 0 };
+        for (int i { 0 }; i < HudFrames; ++i) {
+            auto interval = frame_intervals[(hud_offset + i) % HudFrames];
+            if (hitch_interval <= 0.0f || interval <= hitch_interval)
+                continue;
+
+            auto x = graph_min.x + graph_width * i / (HudFrames - 1);
+            draw_list->AddLine({ x, graph_min.y }, { x, graph_max.y }, IM_COL32(255, 64, 64, 255));
+            ++hitches;
+        }
+
+        ImGui::Text("%zu hitches (over %.2f ms) in the last %d frames", hitches, hitch_interval, HudFrames);
+
+        const auto& frame_latency = rasterizer.get_frame_latency();
+        ImGui::Text("Input to %s: %5.2f ms (%.2f peak)%s",
+                    frame_latency.input_to_display ? "photon" : "GPU",
+                    frame_latency.input_latency,
+                    frame_latency.peak_input_latency,
+                    parameters.low_latency ? ", low-latency" : "");
+
+        ImGui::Separator();
+
+        auto memory_usage = rasterizer.get_memory_usage();
+        auto memory_budgets = rasterizer.get_memory_budgets();
+
+        auto heap = rasterizer.get_device_memory_heap();
+        auto budget = heap < memory_budgets.size() ? memory_budgets[heap] : vkpp::PhysicalDevice::MemoryBudget {};
+
+        std::vector<std::pair<const char*, VkDeviceSize>> categories {
+            { "Geometry",    memory_usage.geometry    },
+            { "Volumes",     memory_usage.volumes     },
+            { "PPLL",        memory_usage.ppll        },
+            { "Shadow Maps", memory_usage.shadow_maps },
+            { "Swapchain",   memory_usage.swapchain   },
+            { "Other",       memory_usage.other       }
+        };
+
+        VkDeviceSize total { 0 };
+        for (const auto& category : categories) {
+            char overlay[32];
+            std::snprintf(overlay, sizeof(overlay), "%.1f MB", category.second / static_cast<float>(1 << 20));
+            ImGui::ProgressBar(budget.budget ? category.second / static_cast<float>(budget.budget) : 0.0f,
+                               ImVec2 { 200, 0 }, overlay);
+            ImGui::SameLine();
+            ImGui::Text("%s", category.first);
+            total += category.second;
+        }
+
+        // The usage is of the whole process (and others), so it's more than the total above.
+        auto usage = std::max(budget.usage, total);
+
+        char overlay[48];
+        std::snprintf(overlay, sizeof(overlay), "%.0f/%.0f MB",
+                      usage / static_cast<float>(1 << 20),
+                      budget.budget / static_cast<float>(1 << 20));
+        ImGui::ProgressBar(budget.budget ? std::min(usage / static_cast<float>(budget.budget), 1.0f) : 0.0f,
+                           ImVec2 { 200, 0 }, overlay);
+        ImGui::SameLine();
+        ImGui::Text("VRAM Budget%s", budget.usage ? "" : " (estimated)");
+
+        if (usage > budget.budget)
+            ImGui::TextColored({ 1.0f, 0.25f, 0.25f, 1.0f }, "Over the budget, will page!");
+        else if (usage > budget.budget * 0.9f)
+            ImGui::TextColored({ 1.0f, 0.75f, 0.25f, 1.0f }, "Close to the budget.");
+
+        ImGui::End();
+    }
+
     void Interface::toggle_renderer() {
         auto tmp = current_renderer;
         current_renderer = previous_renderer;
@@ -486,6 +956,20 @@ namespace vkhr {
         return current_renderer == Renderer::Raymarcher || (current_renderer == Renderer::Hybrid_LoD && level_of_detail != 0.0);
     }
 
+    bool Interface::impostors_enabled(float distance) {
+        return current_renderer == Renderer::Hybrid_LoD && parameters.impostors &&
+               distance >= std::max(parameters.lod_impostor_distance, parameters.lod_minified_distance);
+    }
+
+    vulkan::ScatteringLut::Fiber Interface::get_hair_fiber() const {
+        return {
+            glm::radians(parameters.marschner_shift),
+            glm::radians(parameters.marschner_width),
+            glm::radians(parameters.marschner_azimuthal_width),
+            parameters.marschner_eta
+        };
+    }
+
     bool Interface::raytracing_enabled() {
         return current_renderer == Renderer::Ray_Tracer;
     }
@@ -519,10 +1003,15 @@ namespace vkhr {
         swap(lhs.shaders, rhs.shaders);
         swap(lhs.shadow_maps, rhs.shadow_maps);
         swap(lhs.shadow_samplers, rhs.shadow_samplers);
+        swap(lhs.cost_views, rhs.cost_views);
 
         swap(lhs.profiles, rhs.profiles);
+        swap(lhs.pipeline_statistics, rhs.pipeline_statistics);
+        swap(lhs.ppll_fragments, rhs.ppll_fragments);
 
         swap(lhs.light_debugger, rhs.light_debugger);
+
+        swap(lhs.overlay_revision, rhs.overlay_revision);
     }
 
     void Interface::make_custom_style(ImGuiStyle& style) {
@@ -541,9 +1030,18 @@ namespace vkhr {
 
         header << std::left;
 
-        for (std::size_t i { 0 }; i < export_profiles.size() - 1; ++i)
-            header << std::setw(18) << export_profiles[i] + ",";
-        header << export_profiles[export_profiles.size() - 1];
+        std::vector<std::string> columns { export_profiles };
+        for (const auto& profile : export_profiles)
+            for (const auto& statistic : export_statistics)
+                columns.push_back(profile + " " + statistic);
+        for (const auto& profile : export_profiles)
+            for (const auto& invocations : export_invocations)
+                columns.push_back(profile + " " + invocations);
+        columns.push_back("PPLL Fragments");
+
+        for (std::size_t i { 0 }; i < columns.size() - 1; ++i)
+            header << std::setw(18) << columns[i] + ",";
+        header << columns[columns.size() - 1];
 
         return header.str();
     }
@@ -555,34 +1053,124 @@ namespace vkhr {
 
         if (parameters != "") performance << parameters; // append!
 
-        for (std::size_t i { 0 }; i < export_profiles.size() - 1; ++i) {
-            auto profile = profiles.find(export_profiles[i]);
-            if (profile != profiles.end()) {
-                auto sum = std::accumulate(profile->second.timestamps.begin(),
-                                           profile->second.timestamps.end(), 0.0f);
-                auto average = sum / profile->second.timestamps.size();
-                performance << std::setw(18) << std::to_string(average) + ",";
-            } else {
-                performance << std::setw(18) << +"0,"; // i.e. no measurement.
-            }
+        // The means come first, so the columns of the older CSVs are still in the same place.
+        std::vector<std::string> columns;
+        std::vector<ProfileStatistics> statistics;
+        for (const auto& profile : export_profiles) {
+            statistics.push_back(get_profile_statistics(profile));
+            columns.push_back(std::to_string(statistics.back().mean));
         }
 
-        auto profile = profiles.find(export_profiles[export_profiles.size() - 1]);
+        for (const auto& profile : statistics) {
+            for (auto statistic : { profile.min, profile.p50, profile.p95, profile.p99,
+                                    profile.max, profile.standard_deviation, profile.robust_mean })
+                columns.push_back(std::to_string(statistic));
+        }
 
-        if (profile != profiles.end()) {
-            auto sum = std::accumulate(profile->second.timestamps.begin(),
-                                       profile->second.timestamps.end(), 0.0f);
-            auto average = sum / profile->second.timestamps.size();
-            performance << std::to_string(average);
-        } else {
-            performance << "0";
+        // These are all zero if the pipeline statistics weren't enabled.
+        for (const auto& profile : export_profiles) {
+            vkpp::QueryPool::PipelineStatistics invocations;
+            if (auto section = pipeline_statistics.find(profile); section != pipeline_statistics.end())
+                invocations = section->second;
+            for (auto count : { invocations.vertex_invocations, invocations.geometry_invocations,
+                                invocations.clipping_primitives, invocations.fragment_invocations,
+                                invocations.compute_invocations })
+                columns.push_back(std::to_string(count));
         }
 
+        columns.push_back(std::to_string(ppll_fragments));
+
+        for (std::size_t i { 0 }; i < columns.size() - 1; ++i)
+            performance << std::setw(18) << columns[i] + ",";
+        performance << columns[columns.size() - 1];
+
         performance << "\n";
 
         return performance.str();
     }
 
+    Interface::ProfileStatistics Interface::get_profile_statistics(const std::string& profile_name) const {
+        ProfileStatistics statistics;
+
+        auto profile = profiles.find(profile_name);
+        if (profile == profiles.end() || profile->second.timestamps.empty())
+            return statistics; // i.e. no measurement.
+
+        auto timestamps = profile->second.timestamps;
+        std::sort(timestamps.begin(), timestamps.end());
+
+        auto count = timestamps.size();
+
+        // Nearest-rank, so that they're all actual frames.
+        auto percentile = [&](float p) {
+            auto rank = static_cast<std::size_t>(std::ceil(p / 100.0f * count));
+            return timestamps[std::clamp(rank, std::size_t { 1 }, count) - 1];
+        };
+
+        statistics.min = timestamps.front();
+        statistics.p50 = percentile(50.0f);
+        statistics.p95 = percentile(95.0f);
+        statistics.p99 = percentile(99.0f);
+        statistics.max = timestamps.back();
+
+        statistics.mean = std::accumulate(timestamps.begin(), timestamps.end(), 0.0f) / count;
+
+        float variance { 0.0f };
+        for (auto timestamp : timestamps)
+            variance += (timestamp - statistics.mean) * (timestamp - statistics.mean);
+        statistics.standard_deviation = std::sqrt(variance / count);
+
+        std::vector<float> deviations;
+        for (auto timestamp : timestamps)
+            deviations.push_back(std::abs(timestamp - statistics.p50));
+        std::nth_element(deviations.begin(), deviations.begin() + count / 2, deviations.end());
+
+        // 1.4826 scales it to the standard deviation for normally distributed frame times.
+        auto outlier_distance = 3.0f * 1.4826f * deviations[count / 2];
+
+        float robust_sum { 0.0f };
+        for (auto timestamp : timestamps) {
+            if (outlier_distance > 0.0f && std::abs(timestamp - statistics.p50) > outlier_distance)
+                statistics.outliers++;
+            else robust_sum += timestamp;
+        }
+
+        statistics.robust_mean = robust_sum / (count - statistics.outliers);
+
+        return statistics;
+    }
+
+    nlohmann::json Interface::get_performance_json() const {
+        auto performance = nlohmann::json::object();
+
+        for (const auto& profile : export_profiles) {
+            auto statistics = get_profile_statistics(profile);
+            performance[profile] = {
+                { "mean", statistics.mean },
+                { "min",  statistics.min  },
+                { "p50",  statistics.p50  },
+                { "p95",  statistics.p95  },
+                { "p99",  statistics.p99  },
+                { "max",  statistics.max  },
+                { "standardDeviation", statistics.standard_deviation },
+                { "robustMean", statistics.robust_mean },
+                { "outliers",   statistics.outliers }
+            };
+
+            if (auto section = pipeline_statistics.find(profile); section != pipeline_statistics.end()) {
+                performance[profile]["invocations"] = {
+                    { "vertex",   section->second.vertex_invocations   },
+                    { "geometry", section->second.geometry_invocations },
+                    { "clipped",  section->second.clipping_primitives  },
+                    { "fragment", section->second.fragment_invocations },
+                    { "compute",  section->second.compute_invocations  }
+                };
+            }
+        }
+
+        return performance;
+    }
+
     void Interface::export_performance() {
         time_t current_time { time(0) };
         struct tm time_structure;
@@ -637,15 +1225,34 @@ namespace vkhr {
         }
     }
 
+    float Interface::get_latest_timestamp(const std::string& profile) const {
+        auto timestamps = profiles.find(profile);
+        if (timestamps == profiles.end())
+            return 0.0f;
+        auto latest = (timestamps->second.offset + profile_limit - 1) % profile_limit;
+        return timestamps->second.timestamps[latest];
+    }
+
+    void Interface::record_statistics(const std::unordered_map<std::string, vkpp::QueryPool::PipelineStatistics>& statistics,
+                                      std::size_t fragments) {
+        pipeline_statistics = statistics;
+        ppll_fragments = fragments;
+    }
+
     int Interface::get_profile_limit() const {
         return profile_limit;
     }
 
+    void Interface::set_profile_limit(int frames) {
+        profile_limit = std::max(frames, 1);
+        profiles.clear(); // re-sized on the next record.
+    }
+
     void Interface::switch_scene(const std::string& scene_name, SceneGraph& scene_graph, Rasterizer& rasterizer) {
-        for (int i { 0 }; i < scene_files.size(); ++i) {
-            if (scene_files[i] == scene_name)
-                scene_file = i;
-        }
+        auto scene = std::find(scene_files.begin(), scene_files.end(), scene_name);
+        if (scene == scene_files.end()) // e.g. from a benchmark suite.
+            scene = scene_files.insert(scene_files.end(), scene_name);
+        scene_file = static_cast<int>(scene - scene_files.begin());
 
         if (scene_file != previous_scene_file) {
             scene_graph.load(scene_files[scene_file]);
@@ -664,7 +1271,10 @@ namespace vkhr {
         if (scene_file != previous_scene_file) {
             scene_graph.load(scene_files[scene_file]);
             rasterizer.load(scene_graph);
-            ray_tracer.load(scene_graph);
+            if (ray_tracer.is_loaded())
+                ray_tracer.load(scene_graph);
+            else
+                ray_tracer.defer_load(scene_graph);
             previous_scene_file = scene_file;
 
             if (scene_file == 1) { // Bear hair.
@@ -0,0 +1,128 @@
+#include <vkhr/rasterizer/light_tiles.hh>
+
+#include <vkhr/rasterizer.hh>
+
+#include <cstddef>
+
+namespace vkhr {
+    namespace vulkan {
+        LightTiles::LightTiles(Rasterizer& vulkan_renderer, std::uint32_t width, std::uint32_t height,
+                               std::uint32_t views) : views { views } {
+            tiles_x = (width  + TileSize - 1) / TileSize;
+            tiles_y = (height + TileSize - 1) / TileSize;
+
+            masks = vk::StorageBuffer {
+                vulkan_renderer.device,
+                tiles_x * tiles_y * views * sizeof(std::uint32_t)
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, masks, VK_OBJECT_TYPE_BUFFER, "Light Tiles", id);
+            vk::DebugMarker::object_name(vulkan_renderer.device, masks.get_device_memory(), VK_OBJECT_TYPE_DEVICE_MEMORY,
+                                         "Light Tiles Device Memory", id);
+
+            ++id;
+        }
+
+        void LightTiles::cull(Pipeline& pipeline, std::uint32_t frame, vk::CommandBuffer& command_buffer) {
+            VkMemoryBarrier memory_barrier;
+            memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            memory_barrier.pNext = nullptr;
+
+            // Last frame's shading has to be done reading the masks.
+            memory_barrier.srcAccessMask = 0;
+            memory_barrier.dstAccessMask = 0;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            memory_barrier);
+
+            command_buffer.bind_pipeline(pipeline);
+            command_buffer.bind_descriptor_set(pipeline.descriptor_sets[frame], pipeline);
+            command_buffer.dispatch((tiles_x + GroupSize - 1) / GroupSize,
+                                    (tiles_y + GroupSize - 1) / GroupSize,
+                                    views);
+
+            memory_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            memory_barrier);
+        }
+
+        void LightTiles::build_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+
+            std::uint32_t light_count = vulkan_renderer.shadow_maps.size();
+
+            struct Constants {
+                std::uint32_t light_size;
+                Rasterizer::ShaderParameters parameters;
+            } constant_data {
+                light_count,
+                vulkan_renderer.shader_parameters
+            };
+
+            std::vector<VkSpecializationMapEntry> constants {
+                { 0, offsetof(Constants, light_size), sizeof(std::uint32_t) }
+            };
+
+            Rasterizer::add_shader_parameters(constants, offsetof(Constants, parameters));
+
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("shading/cull_lights.comp"),
+                                                constants, &constant_data, sizeof(constant_data));
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0],
+                                         VK_OBJECT_TYPE_SHADER_MODULE, "Light Culling Shader");
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                vulkan_renderer.device,
+                {
+                    { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                    { 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                    { 4, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                    { 56, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER }
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout,
+                                         VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Light Culling Descriptor Set Layout");
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
+                                                                                pipeline.descriptor_set_layout,
+                                                                                "Light Culling Descriptor Set");
+
+            for (std::size_t i { 0 }; i < pipeline.descriptor_sets.size(); ++i) {
+                pipeline.descriptor_sets[i].write(0, vulkan_renderer.frame_constants[i], vulkan_renderer.camera[i]);
+                pipeline.descriptor_sets[i].write(1, vulkan_renderer.frame_constants[i], vulkan_renderer.lights[i]);
+                pipeline.descriptor_sets[i].write(4, vulkan_renderer.frame_constants[i], vulkan_renderer.params[i]);
+                pipeline.descriptor_sets[i].write(56, vulkan_renderer.light_tiles.get_buffer());
+            }
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout,
+                                         VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                                         "Light Culling Pipeline Layout");
+
+            pipeline.compute_pipeline = vk::ComputePipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages[0],
+                pipeline.pipeline_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.compute_pipeline,
+                                         VK_OBJECT_TYPE_PIPELINE, "Light Culling Pipeline");
+        }
+
+        vk::StorageBuffer& LightTiles::get_buffer() {
+            return masks;
+        }
+
+        int LightTiles::id { 0 };
+    }
+}
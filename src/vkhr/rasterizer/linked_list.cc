@@ -2,22 +2,34 @@
 
 #include <vkhr/rasterizer.hh>
 
+#include <algorithm>
+#include <cstddef>
+
 namespace vkhr {
     namespace vulkan {
-        LinkedList::LinkedList(vkhr::Rasterizer& rasterizer, std::uint32_t width, std::uint32_t height, std::size_t node_size, std::size_t node_count) {
-            create(rasterizer, width, height, node_size, node_count);
+        LinkedList::LinkedList(vkhr::Rasterizer& rasterizer, std::uint32_t width, std::uint32_t height, std::size_t node_size, std::size_t node_count,
+                               bool deferred_shading, bool packed_nodes) {
+            create(rasterizer, width, height, node_size, node_count, deferred_shading, packed_nodes);
         }
 
-        void LinkedList::create(vkhr::Rasterizer& rasterizer, std::uint32_t width, std::uint32_t height, std::size_t node_size, std::size_t node_count) {
+        void LinkedList::create(vkhr::Rasterizer& rasterizer, std::uint32_t width, std::uint32_t height, std::size_t node_size, std::size_t node_count,
+                                bool deferred_shading, bool packed_nodes) {
+            node_count = std::min(node_count, MaximumNodeCount); // or the index would overflow into the tag.
+
+            heads_width  = (width  + ResolutionSlack - 1) / ResolutionSlack * ResolutionSlack;
+            heads_height = (height + ResolutionSlack - 1) / ResolutionSlack * ResolutionSlack;
+
             heads = vk::DeviceImage {
                 rasterizer.device,
-                width, height,
-                width * height * sizeof(std::uint32_t), VK_FORMAT_R32_UINT,
+                heads_width, heads_height,
+                heads_width * heads_height * sizeof(std::uint32_t), VK_FORMAT_R32_UINT,
                 VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT
             };
 
             this->width  = width;
             parameters_buffer.node_count = node_count;
+            parameters_buffer.deferred_shading = deferred_shading;
+            parameters_buffer.packed_nodes = deferred_shading && packed_nodes;
             this->height = height;
 
             auto command_buffer = rasterizer.command_pool.allocate_and_begin();
@@ -44,6 +56,9 @@ namespace vkhr {
 
             vk::DebugMarker::object_name(rasterizer.device, heads_view, VK_OBJECT_TYPE_IMAGE, "PPLL Heads View", id);
 
+            if (parameters_buffer.packed_nodes)
+                node_size = PackedNodeSize;
+
             nodes = vk::StorageBuffer {
                 rasterizer.device,
                 node_count * node_size
@@ -55,6 +70,13 @@ namespace vkhr {
             vk::DebugMarker::object_name(rasterizer.device, nodes.get_device_memory(), VK_OBJECT_TYPE_DEVICE_MEMORY,
                                          "PPLL Nodes Device Memory", id);
 
+            shading = vk::StorageBuffer {
+                rasterizer.device,
+                deferred_shading ? node_count * ShadingSize : ShadingSize
+            };
+
+            vk::DebugMarker::object_name(rasterizer.device, shading, VK_OBJECT_TYPE_BUFFER, "PPLL Shading", id);
+
             parameters = vk::UniformBuffer {
                 rasterizer.device,
                 parameters_buffer
@@ -62,69 +84,153 @@ namespace vkhr {
 
             vk::DebugMarker::object_name(rasterizer.device, parameters, VK_OBJECT_TYPE_BUFFER, "PPLL Parameters", id);
 
+            // Of all the heads, since ppll.glsl finds the tile from their size.
+            std::size_t tile_count = ((heads_width  + TileSize - 1) / TileSize) *
+                                     ((heads_height + TileSize - 1) / TileSize);
+
+            // Followed by the heads' tag and the per-tile counters for the tile budget.
             node_counter = vk::StorageBuffer {
                 rasterizer.device,
-                sizeof(std::uint32_t)
+                (2 + tile_count) * sizeof(std::uint32_t)
             };
 
             vk::DebugMarker::object_name(rasterizer.device, node_counter, VK_OBJECT_TYPE_BUFFER, "PPLL Counter", id);
 
+            node_counter_readbacks.clear();
+
+            std::uint32_t no_nodes { 0 }; // until the first frame is read back.
+
+            for (std::size_t i { 0 }; i < rasterizer.frames_in_flight; ++i) {
+                node_counter_readbacks.emplace_back(rasterizer.device, &no_nodes, sizeof(std::uint32_t), VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+                vk::DebugMarker::object_name(rasterizer.device, node_counter_readbacks.back(), VK_OBJECT_TYPE_BUFFER,
+                                             "PPLL Counter Readback", id);
+            }
+
+            statistics = Statistics { };
+
             null_value.uint32[0] = Null;
+
+            tag = TagCount - 1; // so the heads are cleared before they're first used.
         }
 
         void LinkedList::clear(vk::CommandBuffer& command_buffer) {
-            heads.transition(command_buffer,
-                             VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
-                             VK_ACCESS_TRANSFER_WRITE_BIT,
-                             VK_IMAGE_LAYOUT_GENERAL,
-                             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-                             VK_PIPELINE_STAGE_TRANSFER_BIT);
+            if (++tag == TagCount) {
+                heads.transition(command_buffer,
+                                 VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                                 VK_ACCESS_TRANSFER_WRITE_BIT,
+                                 VK_IMAGE_LAYOUT_GENERAL,
+                                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+                command_buffer.clear_color_image(heads, null_value);
+
+                heads.transition(command_buffer,
+                                 VK_ACCESS_TRANSFER_WRITE_BIT,
+                                 VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                 VK_IMAGE_LAYOUT_GENERAL,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+                tag = 0;
+            }
+
+            command_buffer.fill_buffer(node_counter, 0, sizeof(std::uint32_t), 0);
+            command_buffer.fill_buffer(node_counter, sizeof(std::uint32_t), sizeof(std::uint32_t), tag);
+            command_buffer.fill_buffer(node_counter,
+                                       2 * sizeof(std::uint32_t),
+                                       node_counter.get_size() - 2 * sizeof(std::uint32_t),
+                                       0);
 
-            command_buffer.clear_color_image(heads, null_value);
+            // The counters (and the heads, if not cleared) were last used by the previous frame's resolve.
+            VkMemoryBarrier memory_barrier;
+            memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            memory_barrier.pNext = nullptr;
+            memory_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
 
-            heads.transition(command_buffer,
-                             VK_ACCESS_TRANSFER_WRITE_BIT,
-                             VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
-                             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                             VK_IMAGE_LAYOUT_GENERAL,
-                             VK_PIPELINE_STAGE_TRANSFER_BIT,
-                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            memory_barrier);
+        }
 
-            command_buffer.fill_buffer(node_counter,
-                                       0,
-                                       sizeof(std::uint32_t),
-                                       0);
+        void LinkedList::read_back_node_counter(std::uint32_t frame, vk::CommandBuffer& command_buffer) {
+            command_buffer.copy_buffer(node_counter, node_counter_readbacks[frame]); // only the node counter.
+
+            VkMemoryBarrier memory_barrier;
+            memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            memory_barrier.pNext = nullptr;
+            memory_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                            VK_PIPELINE_STAGE_HOST_BIT,
+                                            memory_barrier);
+        }
+
+        void LinkedList::fetch_node_counter(std::uint32_t frame) {
+            std::uint32_t* node_count;
+            auto& readback_memory = node_counter_readbacks[frame].get_device_memory();
+            readback_memory.map(0, sizeof(std::uint32_t), (void**) &node_count);
+            statistics.fragments = *node_count;
+            readback_memory.unmap();
+
+            if (statistics.frames++ == ShrinkInterval) {
+                statistics.high_water_mark = 0;
+                statistics.frames = 1;
+            }
+
+            statistics.high_water_mark = std::max(statistics.high_water_mark, statistics.fragments);
+
+            if (statistics.fragments > parameters_buffer.node_count)
+                statistics.overflow = statistics.fragments - parameters_buffer.node_count;
+            else statistics.overflow = 0;
         }
 
-        void LinkedList::resolve(vk::SwapChain& swap_chain, std::uint32_t frame, Pipeline& pipeline, vk::CommandBuffer& command_buffer) {
-            swap_chain.get_images()[frame].transition(command_buffer,
-                                                      VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                                                      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
-                                                      VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                                                      VK_IMAGE_LAYOUT_GENERAL,
-                                                      VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                                                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        std::size_t LinkedList::get_recommended_node_count() const {
+            std::size_t node_count = parameters_buffer.node_count;
+            std::size_t minimum_node_count = MinimumFragmentsPerPixel * width * height;
+            std::size_t maximum_node_count = std::min(MaximumFragmentsPerPixel * width * height, MaximumNodeCount);
+
+            // Half again as many as needed, so that we don't keep on resizing it.
+            std::size_t high_water_mark = statistics.high_water_mark + statistics.high_water_mark / 2;
+
+            if (statistics.overflow != 0)
+                return std::min(high_water_mark, maximum_node_count);
+
+            // Only after a whole interval, since the high-water mark is reset after it.
+            if (statistics.frames == ShrinkInterval && high_water_mark < node_count / 4)
+                return std::min(std::max(high_water_mark, minimum_node_count), maximum_node_count);
 
+            return node_count;
+        }
+
+        const LinkedList::Statistics& LinkedList::get_statistics() const {
+            return statistics;
+        }
+
+        void LinkedList::resolve(vk::SwapChain& swap_chain, std::uint32_t frame, std::uint32_t image, Pipeline& pipeline, vk::CommandBuffer& command_buffer) {
+            resolve(swap_chain.get_general_image_views()[image],
+                    VkExtent2D { static_cast<std::uint32_t>(width), static_cast<std::uint32_t>(height) },
+                    frame, pipeline, command_buffer);
+        }
+
+        void LinkedList::resolve(vk::ImageView& color_view, VkExtent2D extent, std::uint32_t frame, Pipeline& pipeline, vk::CommandBuffer& command_buffer) {
             command_buffer.bind_pipeline(pipeline);
 
             pipeline.descriptor_sets[frame].write(5, heads_view);
             pipeline.descriptor_sets[frame].write(6, nodes);
             pipeline.descriptor_sets[frame].write(7, parameters);
             pipeline.descriptor_sets[frame].write(8, node_counter);
-            pipeline.descriptor_sets[frame].write(9, swap_chain.get_general_image_views()[frame]);
+            pipeline.descriptor_sets[frame].write(17, shading);
 
-            command_buffer.bind_descriptor_set(pipeline.descriptor_sets[frame], pipeline);
+            // Since the shadow maps are at 9 and up for the deferred shading.
+            pipeline.descriptor_sets[frame].write(is_deferred() ? 18 : 9, color_view);
 
-            command_buffer.dispatch(std::ceil(width / 8.0), std::ceil(height / 8.0));
+            command_buffer.bind_descriptor_set(pipeline.descriptor_sets[frame], pipeline);
 
-            swap_chain.get_images()[frame].transition(command_buffer,
-                                                      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
-                                                      VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                                                      VK_IMAGE_LAYOUT_GENERAL,
-                                                      VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                                                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-                                                      VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+            command_buffer.dispatch(std::ceil(extent.width / 8.0), std::ceil(extent.height / 8.0));
         }
 
         std::size_t LinkedList::get_width() const {
@@ -140,7 +246,7 @@ namespace vkhr {
         }
 
         std::size_t LinkedList::get_heads_size_in_bytes() const {
-            return width * height * sizeof(std::uint32_t);
+            return heads_width * heads_height * sizeof(std::uint32_t);
         }
 
         vk::UniformBuffer& LinkedList::get_parameters() {
@@ -148,13 +254,25 @@ namespace vkhr {
         }
 
         std::size_t LinkedList::get_nodes_size_in_bytes() const {
-            return parameters_buffer.node_count * node_size;
+            return parameters_buffer.node_count * (node_size + (is_deferred() ? ShadingSize : 0));
+        }
+
+        bool LinkedList::is_deferred() const {
+            return parameters_buffer.deferred_shading;
+        }
+
+        bool LinkedList::is_packed() const {
+            return parameters_buffer.packed_nodes;
         }
 
         std::size_t LinkedList::get_height() const {
             return height;
         }
 
+        bool LinkedList::fits(std::size_t width, std::size_t height) const {
+            return width <= heads_width && height <= heads_height;
+        }
+
         void LinkedList::update_resolution(std::size_t width, std::size_t height) {
             this->width  = width;
             this->height = height;
@@ -172,6 +290,10 @@ namespace vkhr {
             return nodes;
         }
 
+        vk::StorageBuffer& LinkedList::get_shading() {
+            return shading;
+        }
+
         vk::StorageBuffer& LinkedList::get_node_counter() {
             return node_counter;
         }
@@ -179,27 +301,44 @@ namespace vkhr {
         void LinkedList::build_pipeline(Pipeline& pipeline, Rasterizer& rasterizer) {
             pipeline = Pipeline { /* In the case we are re-creating the pipeline */ };
 
-            pipeline.shader_stages.emplace_back(rasterizer.device, SHADER("transparency/resolve.comp"));
+            struct Constants {
+                std::uint32_t k_buffer_size;
+            } constant_data {
+                KBufferSize
+            };
+
+            std::vector<VkSpecializationMapEntry> constants {
+                { 0, 0, sizeof(std::uint32_t) } // k-buffer size
+            };
+
+            // Keeps the k-buffer in shared memory, see resolve.comp for the original one.
+            pipeline.shader_stages.emplace_back(rasterizer.device, SHADER("transparency/resolve_tiled.comp"),
+                                                constants, &constant_data, sizeof(constant_data));
             vk::DebugMarker::object_name(rasterizer.device, pipeline.shader_stages[0],
                                          VK_OBJECT_TYPE_SHADER_MODULE, "PPLL Resolve");
 
             pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
                 rasterizer.device,
                 {
+                    { 4, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
                     { 5, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE  },
                     { 6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
                     { 7, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
                     { 8, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
-                    { 9, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE  }
+                    { 9, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE  },
+                    { 17, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER }
                 }
             };
 
             vk::DebugMarker::object_name(rasterizer.device, pipeline.descriptor_set_layout,
                                          VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "PPLL Descriptor Set Layout");
-            pipeline.descriptor_sets = rasterizer.descriptor_pool.allocate(rasterizer.swap_chain.size(),
+            pipeline.descriptor_sets = rasterizer.descriptor_pool.allocate(rasterizer.frames_in_flight,
                                                                            pipeline.descriptor_set_layout,
                                                                            "PPLL Descriptor Set");
 
+            for (std::size_t i { 0 }; i < pipeline.descriptor_sets.size(); ++i)
+                pipeline.descriptor_sets[i].write(4, rasterizer.frame_constants[i], rasterizer.params[i]); // for the cost_view.
+
             pipeline.pipeline_layout = vk::Pipeline::Layout {
                 rasterizer.device,
                 pipeline.descriptor_set_layout
@@ -219,6 +358,103 @@ namespace vkhr {
                                          VK_OBJECT_TYPE_PIPELINE, "PPLL Pipeline");
         }
 
+        void LinkedList::build_deferred_pipeline(Pipeline& pipeline, Rasterizer& rasterizer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline */ };
+
+            std::uint32_t light_count = rasterizer.shadow_maps.size();
+
+            struct Constants {
+                std::uint32_t light_size;
+                std::uint32_t k_buffer_size;
+                float hair_shininess;
+                Rasterizer::ShaderParameters parameters;
+            } constant_data {
+                light_count,
+                KBufferSize,
+                HairStyle::Shininess, // same for every style.
+                rasterizer.shader_parameters
+            };
+
+            std::vector<VkSpecializationMapEntry> constants {
+                { 0, offsetof(Constants, light_size),     sizeof(std::uint32_t) },
+                { 1, offsetof(Constants, k_buffer_size),  sizeof(std::uint32_t) },
+                { 2, offsetof(Constants, hair_shininess), sizeof(float) }
+            };
+
+            Rasterizer::add_shader_parameters(constants, offsetof(Constants, parameters));
+
+            pipeline.shader_stages.emplace_back(rasterizer.device, SHADER("transparency/resolve_deferred.comp"),
+                                                constants, &constant_data, sizeof(constant_data));
+            vk::DebugMarker::object_name(rasterizer.device, pipeline.shader_stages[0],
+                                         VK_OBJECT_TYPE_SHADER_MODULE, "PPLL Deferred Resolve");
+
+            std::vector<vk::DescriptorSet::Binding> descriptor_bindings {
+                { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                { 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                { 4, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                { 5, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE  },
+                { 6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                { 7, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                { 8, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                { 17, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                { 18, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE },
+                { 56, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER }, // light tiles.
+                { 65, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER } // Marschner.
+            };
+
+            for (std::uint32_t i { 0 }; i < light_count; ++i) {
+                descriptor_bindings.push_back({ 9 + i, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER });
+                descriptor_bindings.push_back({ 32 + i, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER }); // opacity maps.
+                descriptor_bindings.push_back({ 40 + i, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER }); // and filtered.
+            }
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                rasterizer.device, descriptor_bindings
+            };
+
+            vk::DebugMarker::object_name(rasterizer.device, pipeline.descriptor_set_layout,
+                                         VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "PPLL Deferred Descriptor Set Layout");
+            pipeline.descriptor_sets = rasterizer.descriptor_pool.allocate(rasterizer.frames_in_flight,
+                                                                           pipeline.descriptor_set_layout,
+                                                                           "PPLL Deferred Descriptor Set");
+
+            for (std::size_t i { 0 }; i < pipeline.descriptor_sets.size(); ++i) {
+                pipeline.descriptor_sets[i].write(0, rasterizer.frame_constants[i], rasterizer.camera[i]);
+                pipeline.descriptor_sets[i].write(1, rasterizer.frame_constants[i], rasterizer.lights[i]);
+                pipeline.descriptor_sets[i].write(4, rasterizer.frame_constants[i], rasterizer.params[i]);
+                pipeline.descriptor_sets[i].write(56, rasterizer.light_tiles.get_buffer());
+                pipeline.descriptor_sets[i].write(65, rasterizer.scattering_lut.get_image_view(),
+                                                  rasterizer.scattering_lut.get_sampler());
+
+                for (std::uint32_t j { 0 }; j < light_count; ++j) {
+                    pipeline.descriptor_sets[i].write(9 + j, rasterizer.shadow_maps[j].get_image_view(),
+                                                      rasterizer.shadow_maps[j].get_sampler());
+                    pipeline.descriptor_sets[i].write(32 + j, rasterizer.opacity_maps[j].get_image_view(),
+                                                      rasterizer.opacity_maps[j].get_sampler());
+                    pipeline.descriptor_sets[i].write(40 + j, rasterizer.filtered_shadow_maps[j].get_image_view(),
+                                                      rasterizer.filtered_shadow_maps[j].get_sampler());
+                }
+            }
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                rasterizer.device,
+                pipeline.descriptor_set_layout
+            };
+
+            vk::DebugMarker::object_name(rasterizer.device, pipeline.pipeline_layout,
+                                         VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                                         "PPLL Deferred Pipeline Layout");
+
+            pipeline.compute_pipeline = vk::ComputePipeline {
+                rasterizer.device,
+                pipeline.shader_stages[0],
+                pipeline.pipeline_layout
+            };
+
+            vk::DebugMarker::object_name(rasterizer.device, pipeline.compute_pipeline,
+                                         VK_OBJECT_TYPE_PIPELINE, "PPLL Deferred Pipeline");
+        }
+
         int LinkedList::id { 0 };
     }
 }
\ No newline at end of file
@@ -19,37 +19,90 @@ namespace vkhr {
             vertices = vk::VertexBuffer {
                 vulkan_renderer.device,
                 vulkan_renderer.command_pool,
-                wavefront_model.get_vertices()
+                wavefront_model.get_vertex_span()
             };
 
             vk::DebugMarker::object_name(vulkan_renderer.device, vertices, VK_OBJECT_TYPE_BUFFER, "Model Vertex Buffer", id);
             vk::DebugMarker::object_name(vulkan_renderer.device, vertices.get_device_memory(), VK_OBJECT_TYPE_DEVICE_MEMORY,
                                          "Model Vertex Device Memory", id);
 
-            elements = vk::IndexBuffer {
-                vulkan_renderer.device,
-                vulkan_renderer.command_pool,
-                wavefront_model.get_elements()
-            };
+            // The 16-bit ones whenever the vertices fit, see vkhr::Model::load.
+            if (auto short_elements = wavefront_model.get_short_element_span(); !short_elements.empty()) {
+                elements = vk::IndexBuffer {
+                    vulkan_renderer.device,
+                    vulkan_renderer.command_pool,
+                    short_elements
+                };
+            } else {
+                elements = vk::IndexBuffer {
+                    vulkan_renderer.device,
+                    vulkan_renderer.command_pool,
+                    wavefront_model.get_element_span()
+                };
+            }
 
             vk::DebugMarker::object_name(vulkan_renderer.device, elements, VK_OBJECT_TYPE_BUFFER, "Model Index Buffer", id);
             vk::DebugMarker::object_name(vulkan_renderer.device, elements.get_device_memory(), VK_OBJECT_TYPE_DEVICE_MEMORY,
                                          "Model Index Device Memory", id);
 
+            if (wavefront_model.has_distance_field()) {
+                const auto& field = wavefront_model.get_distance_field();
+
+                std::vector<float> distance_field_data;
+                distance_field_data.reserve(8 + field.distances.size());
+                distance_field_data.insert(distance_field_data.end(), { field.origin.x, field.origin.y, field.origin.z,
+                                                                        static_cast<float>(field.resolution.x) });
+                distance_field_data.insert(distance_field_data.end(), { field.size.x, field.size.y, field.size.z, 0.0f });
+                distance_field_data.insert(distance_field_data.end(), field.distances.begin(), field.distances.end());
+
+                distance_field = vk::StorageBuffer {
+                    vulkan_renderer.device,
+                    vulkan_renderer.command_pool,
+                    distance_field_data
+                };
+
+                vk::DebugMarker::object_name(vulkan_renderer.device, distance_field, VK_OBJECT_TYPE_BUFFER, "Model Distance Field Buffer", id);
+                vk::DebugMarker::object_name(vulkan_renderer.device, distance_field.get_device_memory(), VK_OBJECT_TYPE_DEVICE_MEMORY,
+                                             "Model Distance Field Device Memory", id);
+
+                distance_field_loaded = true;
+            }
+
 			// load texture
 #ifdef USE_MODEL_TEXTURE
-			model_image = vk::DeviceImage{
-				vulkan_renderer.device,
-				vulkan_renderer.command_pool,
-				wavefront_model.get_image()
-			};
+			// The compressed one has its mips already, otherwise they're blitted from the .png.
+			if (const auto& texture = wavefront_model.get_texture()) {
+				model_image = vk::DeviceImage{
+					vulkan_renderer.device,
+					vulkan_renderer.command_pool,
+					texture
+				};
+			} else {
+				auto image = wavefront_model.get_image();
+				model_image = vk::DeviceImage{
+					vulkan_renderer.device,
+					vulkan_renderer.command_pool,
+					image,
+					vk::DeviceImage::get_mip_chain_length(image.get_width(), image.get_height())
+				};
+			}
 
 			model_view = vk::ImageView{
 				vulkan_renderer.device,
-				model_image
+				model_image,
+				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				0, model_image.get_mip_levels()
 			};
 
-			model_sampler = vk::Sampler{ vulkan_renderer.device };
+			model_sampler = vk::Sampler{
+				vulkan_renderer.device,
+				VK_FILTER_LINEAR, VK_FILTER_LINEAR,
+				VK_SAMPLER_ADDRESS_MODE_REPEAT,
+				VK_SAMPLER_ADDRESS_MODE_REPEAT,
+				VK_SAMPLER_ADDRESS_MODE_REPEAT,
+				true, false,
+				static_cast<float>(model_image.get_mip_levels())
+			};
 #endif
 
             ++id;
@@ -57,14 +110,23 @@ namespace vkhr {
 
         void Model::draw(Pipeline& pipeline, vk::DescriptorSet& descriptor_set, vk::CommandBuffer& command_buffer) {
 #ifdef USE_MODEL_TEXTURE
-			descriptor_set.write(15, model_view, model_sampler);
-#endif
+			command_buffer.bind_descriptor_set(descriptor_set.with({ { 15, model_view, model_sampler } }), pipeline);
+#else
             command_buffer.bind_descriptor_set(descriptor_set, pipeline);
+#endif
             command_buffer.bind_vertex_buffer(0, vertices);
             command_buffer.bind_index_buffer(elements, 0);
             command_buffer.draw_indexed(elements.count());
         }
 
+        vk::StorageBuffer& Model::get_distance_field() {
+            return distance_field;
+        }
+
+        bool Model::has_distance_field() const {
+            return distance_field_loaded;
+        }
+
         void Model::build_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
             pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
 
@@ -76,10 +138,10 @@ namespace vkhr {
 
             pipeline.fixed_stages.set_topology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
 
-            pipeline.fixed_stages.set_scissor({ 0, 0, vulkan_renderer.swap_chain.get_extent() });
+            pipeline.fixed_stages.set_scissor({ 0, 0, vulkan_renderer.get_color_extent() });
             pipeline.fixed_stages.set_viewport({ 0.0, 0.0,
-                                                 static_cast<float>(vulkan_renderer.swap_chain.get_width()),
-                                                 static_cast<float>(vulkan_renderer.swap_chain.get_height()),
+                                                 static_cast<float>(vulkan_renderer.get_color_extent().width),
+                                                 static_cast<float>(vulkan_renderer.get_color_extent().height),
                                                  0.0, 1.0 });
 
             pipeline.fixed_stages.enable_depth_test();
@@ -98,12 +160,14 @@ namespace vkhr {
             };
 
 #ifdef USE_MODEL_TEXTURE
-			pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("models/modelTextured.vert"));
+			pipeline.shader_stages.emplace_back(vulkan_renderer.device, vulkan_renderer.stereo_rendering ? SHADER("models/model_stereo.vert") :
+			                                                                                               SHADER("models/modelTextured.vert"));
 			vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0], VK_OBJECT_TYPE_SHADER_MODULE, "Model Vertex Shader");
 			pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("models/modelTextured.frag"), constants, &constant_data, sizeof(constant_data));
 			vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[1], VK_OBJECT_TYPE_SHADER_MODULE, "Model Fragment Shader");
 #else
-            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("models/model.vert"));
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, vulkan_renderer.stereo_rendering ? SHADER("models/model_stereo.vert") :
+                                                                                                           SHADER("models/model.vert"));
             vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0], VK_OBJECT_TYPE_SHADER_MODULE, "Model Vertex Shader");
             pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("models/model.frag"), constants, &constant_data, sizeof(constant_data));
             vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[1], VK_OBJECT_TYPE_SHADER_MODULE, "Model Fragment Shader");
@@ -129,15 +193,15 @@ namespace vkhr {
 
             vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Model Descriptor Set Layout");
 
-            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.swap_chain.size(),
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
                                                                                 pipeline.descriptor_set_layout,
                                                                                 "Model Descriptor Set");
 
             for (std::size_t i { 0 }; i < pipeline.descriptor_sets.size(); ++i) 
 			{
-                pipeline.descriptor_sets[i].write(0, vulkan_renderer.camera[i]);
-                pipeline.descriptor_sets[i].write(1, vulkan_renderer.lights[i]);
-                pipeline.descriptor_sets[i].write(4, vulkan_renderer.params[i]);
+                pipeline.descriptor_sets[i].write(0, vulkan_renderer.frame_constants[i], vulkan_renderer.camera[i]);
+                pipeline.descriptor_sets[i].write(1, vulkan_renderer.frame_constants[i], vulkan_renderer.lights[i]);
+                pipeline.descriptor_sets[i].write(4, vulkan_renderer.frame_constants[i], vulkan_renderer.params[i]);
 
                 for (std::uint32_t j { 0 }; j < light_count; ++j)
                     pipeline.descriptor_sets[i].write(9 + j, vulkan_renderer.shadow_maps[j].get_image_view(),
@@ -165,7 +229,7 @@ namespace vkhr {
             vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline, VK_OBJECT_TYPE_PIPELINE, "Model Graphics Pipeline");
         }
 
-        void Model::depth_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+        void Model::depth_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer, bool multiview) {
             pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
 
             pipeline.fixed_stages.add_vertex_binding({ 0, sizeof(vkhr::Model::Vertex), VK_VERTEX_INPUT_RATE_VERTEX });
@@ -187,26 +251,44 @@ namespace vkhr {
 
             pipeline.fixed_stages.enable_depth_test();
 
-            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("self-shadowing/depth_map.vert"));
+            std::uint32_t light_count = vulkan_renderer.shadow_maps.size();
+
+            std::vector<VkSpecializationMapEntry> constants {
+                { 0, 0, sizeof(std::uint32_t) } // light count.
+            };
+
+            if (multiview)
+                pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("self-shadowing/multiview_depth_map.vert"), constants, &light_count, sizeof(light_count));
+            else
+                pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("self-shadowing/depth_map.vert"));
 
             vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0], VK_OBJECT_TYPE_SHADER_MODULE, "Model Depth Shader");
 
-            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
-                vulkan_renderer.device
+            std::vector<vk::DescriptorSet::Binding> descriptor_bindings;
+
 #ifdef USE_MODEL_TEXTURE
-				,
-				{
-					{ 15, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER }
-				}
+            descriptor_bindings.push_back({ 15, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER });
 #endif
+
+            // The light transforms, which are picked by the view with multiview.
+            if (multiview)
+                descriptor_bindings.push_back({ 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER });
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                vulkan_renderer.device, descriptor_bindings
             };
 
             vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Model Depth Descriptor Set Layout");
 
-            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.swap_chain.size(),
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
                                                                                 pipeline.descriptor_set_layout,
                                                                                 "Model Depth Descriptor Set");
 
+            if (multiview) {
+                for (std::size_t i { 0 }; i < pipeline.descriptor_sets.size(); ++i)
+                    pipeline.descriptor_sets[i].write(1, vulkan_renderer.frame_constants[i], vulkan_renderer.lights[i]);
+            }
+
             pipeline.pipeline_layout = vk::Pipeline::Layout {
                 vulkan_renderer.device,
                 pipeline.descriptor_set_layout,
@@ -222,7 +304,8 @@ namespace vkhr {
                 pipeline.shader_stages,
                 pipeline.fixed_stages,
                 pipeline.pipeline_layout,
-                vulkan_renderer.depth_pass
+                multiview ? vulkan_renderer.multiview_depth_pass :
+                            vulkan_renderer.depth_pass
             };
 
             vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline, VK_OBJECT_TYPE_PIPELINE, "Model Depth Graphics Pipeline");
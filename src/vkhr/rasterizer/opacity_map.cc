@@ -0,0 +1,119 @@
+#include <vkhr/rasterizer/opacity_map.hh>
+
+#include <vkhr/rasterizer.hh>
+
+#include <vkpp/debug_marker.hh>
+
+#include <algorithm>
+
+namespace vkhr {
+    namespace vulkan {
+        OpacityMap::OpacityMap(const std::uint32_t width, Rasterizer& vulkan_renderer)
+                              : width { width } {
+            image = vk::Image {
+                vulkan_renderer.device,
+                width, width,
+                get_layer_format(),
+                get_layer_usage_flags()
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, image, VK_OBJECT_TYPE_IMAGE, "Opacity Map Image", id);
+
+            memory = vk::DeviceMemory {
+                vulkan_renderer.device,
+                image.get_memory_requirements(),
+                vk::DeviceMemory::Type::DeviceLocal
+            };
+
+            image.bind(memory);
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, memory, VK_OBJECT_TYPE_DEVICE_MEMORY, "Opacity Map Device Memory", id);
+
+            image_view = vk::ImageView {
+                vulkan_renderer.device,
+                image,
+                get_read_layer_layout()
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, image_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Opacity Map Image View", id);
+
+            framebuffer = vk::Framebuffer {
+                vulkan_renderer.device,
+                vulkan_renderer.opacity_pass,
+                image_view, VkExtent2D {
+                    width, width
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, framebuffer, VK_OBJECT_TYPE_FRAMEBUFFER, "Opacity Map Framebuffer", id);
+
+            // The layers are interpolated between the texels like the depth maps.
+            sampler = vk::Sampler {
+                vulkan_renderer.device,
+                VK_FILTER_LINEAR,
+                VK_FILTER_LINEAR,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, sampler, VK_OBJECT_TYPE_SAMPLER, "Opacity Map Sampler", id);
+
+            viewport = VkViewport {
+                0.0f, 0.0f,
+                static_cast<float>(width),
+                static_cast<float>(width),
+                0.0f, 1.0f
+            };
+
+            scissor = VkRect2D {
+                { 0, 0 },
+                { width, width }
+            };
+
+            ++id;
+        }
+
+        void OpacityMap::update_dynamic_viewport_scissor_depth(vk::CommandBuffer& command_list) {
+            command_list.set_viewport(viewport);
+            command_list.set_scissor(scissor);
+        }
+
+        void OpacityMap::set_resolution(std::uint32_t resolution) {
+            resolution = std::min(resolution, width);
+            viewport.width  = static_cast<float>(resolution);
+            viewport.height = static_cast<float>(resolution);
+            scissor.extent  = { resolution, resolution };
+        }
+
+        vk::Framebuffer& OpacityMap::get_framebuffer() {
+            return framebuffer;
+        }
+
+        vk::Sampler& OpacityMap::get_sampler() {
+            return sampler;
+        }
+
+        vk::ImageView& OpacityMap::get_image_view() {
+            return image_view;
+        }
+
+        VkDeviceSize OpacityMap::get_size_in_bytes() const {
+            return memory.get_size();
+        }
+
+        VkFormat OpacityMap::get_layer_format() {
+            return VK_FORMAT_R16G16B16A16_SFLOAT;
+        }
+
+        VkImageLayout OpacityMap::get_read_layer_layout() {
+            return VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        }
+
+        VkImageUsageFlags OpacityMap::get_layer_usage_flags() {
+            return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                   VK_IMAGE_USAGE_SAMPLED_BIT;
+        }
+
+        int OpacityMap::id { 0 };
+    }
+}
@@ -0,0 +1,119 @@
+#include <vkhr/rasterizer/quality_controller.hh>
+
+#include <vkhr/rasterizer/hair_target.hh>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace vkhr {
+    const std::vector<std::string> QualityController::HairProfiles {
+        "Bake Shadow Maps",
+        "Voxelize Strands",
+        "Simulate Strands",
+        "Cull Hair Strands",
+        "Clear PPLL Nodes",
+        "Draw Hair Styles",
+        "Software Raster Strands",
+        "Raymarch Strands",
+        "Resolve the PPLL",
+        "Downsample Hair Target",
+        "Upscale Hair"
+    };
+
+    void QualityController::enable(const Interface::Parameters& parameters) {
+        if (enabled)
+            return;
+
+        baseline = parameters;
+        enabled = true;
+
+        level = 0;
+        hair_time = 0.0f;
+        frames_over = frames_under = 0;
+        settle_frames = SettleFrames;
+    }
+
+    void QualityController::disable(Interface::Parameters& parameters) {
+        if (!enabled)
+            return;
+
+        level = 0;
+        apply(parameters);
+        enabled = false;
+    }
+
+    bool QualityController::is_enabled() const {
+        return enabled;
+    }
+
+    void QualityController::update(const std::unordered_map<std::string, float>& timestamps,
+                                   Interface::Parameters& parameters) {
+        if (!enabled)
+            return;
+
+        float frame_hair_time { 0.0f };
+        for (const auto& profile : HairProfiles) {
+            auto timestamp = timestamps.find(profile);
+            if (timestamp != timestamps.end())
+                frame_hair_time += timestamp->second;
+        }
+
+        if (frame_hair_time == 0.0f)
+            return; // e.g. the timestamps weren't ready.
+
+        if (hair_time == 0.0f) hair_time = frame_hair_time;
+        else hair_time += (frame_hair_time - hair_time) * 0.1f;
+
+        // The timestamps lag behind by the frames in flight, and the average behind them.
+        if (settle_frames > 0) {
+            --settle_frames;
+            return;
+        }
+
+        frames_over  = hair_time > budget                      ? frames_over  + 1 : 0;
+        frames_under = hair_time < budget * (1.0f - Headroom)  ? frames_under + 1 : 0;
+
+        int next_level { level };
+
+        if (frames_over >= DegradeFrames)
+            next_level = std::min(level + 1, Levels - 1);
+        else if (frames_under >= ImproveFrames)
+            next_level = std::max(level - 1, 0);
+
+        if (next_level != level) {
+            level = next_level;
+            apply(parameters);
+            frames_over = frames_under = 0;
+            settle_frames = SettleFrames;
+        }
+    }
+
+    float QualityController::get_hair_time() const {
+        return hair_time;
+    }
+
+    int QualityController::get_level() const {
+        return level;
+    }
+
+    void QualityController::apply(Interface::Parameters& parameters) const {
+        float t = level / static_cast<float>(Levels - 1);
+
+        // Down to a quarter of the strands and samples, and half of the LoD transition distances,
+        // so the (cheaper) raymarcher takes over sooner, at the lowest level.
+        parameters.strands_per_pixel = baseline.strands_per_pixel * glm::mix(1.0f, 0.25f, t);
+        parameters.raycast_steps = std::max(baseline.raycast_steps * glm::mix(1.0f, 0.25f, t), std::min(baseline.raycast_steps, 16.0f));
+
+        int kernel_size_reduction = static_cast<int>(std::round(t * (baseline.adsm_kernel_size - 1)));
+        parameters.adsm_kernel_size = std::max(baseline.adsm_kernel_size - kernel_size_reduction, 1);
+
+        parameters.lod_magnified_distance = baseline.lod_magnified_distance * glm::mix(1.0f, 0.5f, t);
+        parameters.lod_minified_distance  = baseline.lod_minified_distance  * glm::mix(1.0f, 0.5f, t);
+        parameters.lod_impostor_distance  = baseline.lod_impostor_distance  * glm::mix(1.0f, 0.5f, t);
+
+        // And the hair is drawn at down to half of the resolution, i.e. a quarter of the fragments.
+        parameters.render_scale = std::max(baseline.render_scale * glm::mix(1.0f, 0.5f, t), vulkan::HairTarget::MinimumScale);
+    }
+}
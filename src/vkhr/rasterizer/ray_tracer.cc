@@ -0,0 +1,332 @@
+#include <vkhr/rasterizer/ray_tracer.hh>
+
+#include <vkhr/rasterizer.hh>
+#include <vkhr/ray_tracer.hh>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace vkhr {
+    namespace vulkan {
+#ifdef VK_KHR_ray_query
+        static VkAccelerationStructureGeometryKHR get_aabb_geometry(vk::AddressableBuffer& segment_bounds) {
+            VkAccelerationStructureGeometryKHR geometry { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR };
+            geometry.geometryType = VK_GEOMETRY_TYPE_AABBS_KHR;
+            geometry.geometry.aabbs.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_AABBS_DATA_KHR;
+            geometry.geometry.aabbs.pNext = nullptr;
+            geometry.geometry.aabbs.data.deviceAddress = segment_bounds.get_device_address();
+            geometry.geometry.aabbs.stride = sizeof(VkAabbPositionsKHR);
+            geometry.flags = VK_GEOMETRY_OPAQUE_BIT_KHR; // the hits are generated in trace.comp.
+            return geometry;
+        }
+
+        static VkAccelerationStructureGeometryKHR get_instance_geometry(vk::AddressableBuffer& instances) {
+            VkAccelerationStructureGeometryKHR geometry { VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR };
+            geometry.geometryType = VK_GEOMETRY_TYPE_INSTANCES_KHR;
+            geometry.geometry.instances.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR;
+            geometry.geometry.instances.pNext = nullptr;
+            geometry.geometry.instances.arrayOfPointers = VK_FALSE;
+            geometry.geometry.instances.data.deviceAddress = instances.get_device_address();
+            geometry.flags = VK_GEOMETRY_OPAQUE_BIT_KHR;
+            return geometry;
+        }
+
+        Raytracer::Raytracer(Rasterizer& vulkan_renderer, const SceneGraph& scene_graph)
+                            : width  { vulkan_renderer.swap_chain.get_width()  },
+                              height { vulkan_renderer.swap_chain.get_height() } {
+            std::vector<glm::vec4> segment_data;
+            std::vector<Style> style_data;
+            std::vector<std::uint32_t> segment_counts;
+
+            for (const auto& hair_style : scene_graph.get_hair_styles()) {
+                std::vector<glm::vec4> packed_position_thickness;
+                auto position_thickness = hair_style.second.get_position_thickness_span();
+                if (position_thickness.empty()) {
+                    packed_position_thickness = hair_style.second.create_position_thickness_data();
+                    position_thickness = packed_position_thickness;
+                }
+
+                auto indices = hair_style.second.get_index_span();
+
+                if (indices.size() < 2)
+                    continue; // an empty acceleration structure can't be built.
+
+                const auto& parameters = vulkan_renderer.hair_styles.at(&hair_style.second).parameters;
+
+                Style style;
+                style.diffuse = parameters.hair_color;
+                style.exponent = parameters.hair_shininess;
+                style.first_segment = segment_data.size() / 2;
+
+                std::vector<VkAabbPositionsKHR> bounds;
+                bounds.reserve(indices.size() / 2);
+
+                for (std::size_t i { 0 }; i + 1 < indices.size(); i += 2) {
+                    const auto& a = position_thickness[indices[i + 0]];
+                    const auto& b = position_thickness[indices[i + 1]];
+
+                    segment_data.push_back(a);
+                    segment_data.push_back(b);
+
+                    auto lower = glm::min(glm::vec3 { a } - a.w, glm::vec3 { b } - b.w);
+                    auto upper = glm::max(glm::vec3 { a } + a.w, glm::vec3 { b } + b.w);
+
+                    bounds.push_back({ lower.x, lower.y, lower.z,
+                                       upper.x, upper.y, upper.z });
+                }
+
+                style_indices[&hair_style.second] = style_data.size();
+                style_data.push_back(style);
+                segment_counts.push_back(bounds.size());
+
+                segment_bounds.emplace_back(vulkan_renderer.device,
+                                            vulkan_renderer.command_pool,
+                                            bounds.data(), bounds.size() * sizeof(bounds[0]),
+                                            VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR);
+
+                vk::DebugMarker::object_name(vulkan_renderer.device, segment_bounds.back(), VK_OBJECT_TYPE_BUFFER,
+                                             "Ray Tracer Segment Bounds", id);
+
+                bottom_levels.emplace_back(vulkan_renderer.device,
+                                           VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR,
+                                           get_aabb_geometry(segment_bounds.back()),
+                                           segment_counts.back());
+            }
+
+            if (segment_data.empty()) {
+                segment_data.resize(2); // so the buffers aren't empty.
+                style_data.resize(1);
+            }
+
+            segments = vk::StorageBuffer { vulkan_renderer.device, vulkan_renderer.command_pool, segment_data };
+            styles   = vk::StorageBuffer { vulkan_renderer.device, vulkan_renderer.command_pool, style_data };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, segments, VK_OBJECT_TYPE_BUFFER, "Ray Tracer Segments", id);
+            vk::DebugMarker::object_name(vulkan_renderer.device, styles, VK_OBJECT_TYPE_BUFFER, "Ray Tracer Styles", id);
+
+            for (auto node : scene_graph.get_nodes_with_hair_styles())
+                max_instances += node->get_hair_styles().size();
+            max_instances = std::max(max_instances, 1u);
+
+            for (std::size_t i { 0 }; i < vulkan_renderer.frames_in_flight; ++i) {
+                instances.emplace_back(vulkan_renderer.device,
+                                       max_instances * sizeof(VkAccelerationStructureInstanceKHR),
+                                       VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR,
+                                       vk::DeviceMemory::Type::HostVisible);
+
+                vk::DebugMarker::object_name(vulkan_renderer.device, instances[i], VK_OBJECT_TYPE_BUFFER,
+                                             "Ray Tracer Instances", i);
+
+                // Built every frame, since the nodes can move.
+                top_levels.emplace_back(vulkan_renderer.device,
+                                        VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR,
+                                        get_instance_geometry(instances[i]),
+                                        max_instances,
+                                        VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_BUILD_BIT_KHR);
+            }
+
+            accumulation = vk::Image {
+                vulkan_renderer.device,
+                width, height,
+                VK_FORMAT_R32G32B32A32_SFLOAT,
+                VK_IMAGE_USAGE_STORAGE_BIT
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, accumulation, VK_OBJECT_TYPE_IMAGE, "Ray Tracer Accumulation", id);
+
+            accumulation_memory = vk::DeviceMemory {
+                vulkan_renderer.device,
+                accumulation.get_memory_requirements(),
+                vk::DeviceMemory::Type::DeviceLocal
+            };
+
+            accumulation.bind(accumulation_memory);
+
+            accumulation_view = vk::ImageView { vulkan_renderer.device, accumulation, VK_IMAGE_LAYOUT_GENERAL };
+
+            // The bottom levels are only built once, and the accumulation's first sample overwrites it.
+            auto command_buffer = vulkan_renderer.command_pool.allocate_and_begin();
+
+            for (std::size_t i { 0 }; i < bottom_levels.size(); ++i)
+                bottom_levels[i].build(command_buffer, get_aabb_geometry(segment_bounds[i]), segment_counts[i]);
+
+            accumulation.transition(command_buffer, 0, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                                    VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                                    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+            command_buffer.end();
+            vulkan_renderer.device.get_graphics_queue().submit(command_buffer)
+                                                       .wait_idle();
+
+            ++id;
+        }
+
+        void Raytracer::trace(const SceneGraph& scene_graph, const vkhr::Raytracer& settings, std::size_t state,
+                              Pipeline& pipeline, std::uint32_t frame, vk::ImageView& framebuffer,
+                              vk::CommandBuffer& command_buffer) {
+            if (state != accumulated_state)
+                samples = 0;
+            accumulated_state = state;
+
+            std::vector<VkAccelerationStructureInstanceKHR> instance_data;
+
+            for (auto node : scene_graph.get_nodes_with_hair_styles()) {
+                // Its rows, since the instance's transform is a row-major 3x4 matrix.
+                auto model = glm::transpose(node->get_model_matrix());
+                for (auto hair_style : node->get_hair_styles()) {
+                    auto style = style_indices.find(hair_style);
+                    if (style == style_indices.end() || instance_data.size() == max_instances)
+                        continue;
+
+                    VkAccelerationStructureInstanceKHR instance;
+                    std::memcpy(&instance.transform, &model, sizeof(instance.transform));
+                    instance.instanceCustomIndex = style->second; // into styles.
+                    instance.mask = 0xFF;
+                    instance.instanceShaderBindingTableRecordOffset = 0;
+                    instance.flags = 0;
+                    instance.accelerationStructureReference = bottom_levels[style->second].get_device_address();
+                    instance_data.push_back(instance);
+                }
+            }
+
+            if (!instance_data.empty())
+                instances[frame].get_device_memory().copy(instance_data.size() * sizeof(instance_data[0]),
+                                                          instance_data.data());
+
+            top_levels[frame].build(command_buffer, get_instance_geometry(instances[frame]),
+                                    instance_data.size());
+
+            VkMemoryBarrier memory_barrier;
+            memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            memory_barrier.pNext = nullptr;
+
+            // And the last trace has to be done with the accumulation.
+            memory_barrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR | VK_ACCESS_SHADER_WRITE_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_SHADER_READ_BIT |
+                                           VK_ACCESS_SHADER_WRITE_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR |
+                                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                            memory_barrier);
+
+            pipeline.descriptor_sets[frame].write(60, top_levels[frame]);
+            pipeline.descriptor_sets[frame].write(61, segments);
+            pipeline.descriptor_sets[frame].write(62, styles);
+            pipeline.descriptor_sets[frame].write(63, accumulation_view);
+            pipeline.descriptor_sets[frame].write(64, framebuffer);
+
+            struct Trace {
+                std::uint32_t sample;
+                std::int32_t visualization_method;
+                std::int32_t shadows_on;
+                float ao_radius;
+                std::int32_t marschner_shading;
+            } trace_constants {
+                samples,
+                settings.get_visualization_method(),
+                settings.shadows_enabled(),
+                settings.get_ao_radius(),
+                settings.marschner_enabled()
+            };
+
+            command_buffer.bind_pipeline(pipeline);
+            command_buffer.bind_descriptor_set(pipeline.descriptor_sets[frame], pipeline);
+            command_buffer.push_constant(pipeline, 0, trace_constants);
+            command_buffer.dispatch((width  + GroupSize - 1) / GroupSize,
+                                    (height + GroupSize - 1) / GroupSize);
+
+            ++samples;
+        }
+
+        void Raytracer::clear() {
+            samples = 0;
+        }
+
+        bool Raytracer::is_built() const {
+            return width != 0;
+        }
+
+        std::uint32_t Raytracer::get_width() const {
+            return width;
+        }
+
+        std::uint32_t Raytracer::get_height() const {
+            return height;
+        }
+
+        void Raytracer::build_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+
+            std::uint32_t light_count = vulkan_renderer.shadow_maps.size();
+
+            struct Constants {
+                std::uint32_t light_size;
+            } constant_data {
+                light_count
+            };
+
+            std::vector<VkSpecializationMapEntry> constants {
+                { 0, offsetof(Constants, light_size), sizeof(std::uint32_t) }
+            };
+
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("ray_tracing/trace.comp"),
+                                                constants, &constant_data, sizeof(constant_data));
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0],
+                                         VK_OBJECT_TYPE_SHADER_MODULE, "Ray Tracer Shader");
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                vulkan_renderer.device,
+                {
+                    { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                    { 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                    { 60, VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR },
+                    { 61, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 62, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 63, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE },
+                    { 64, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE },
+                    { 65, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER } // Marschner.
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout,
+                                         VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Ray Tracer Descriptor Set Layout");
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
+                                                                                pipeline.descriptor_set_layout,
+                                                                                "Ray Tracer Descriptor Set");
+
+            for (std::size_t i { 0 }; i < pipeline.descriptor_sets.size(); ++i) {
+                pipeline.descriptor_sets[i].write(0, vulkan_renderer.frame_constants[i], vulkan_renderer.camera[i]);
+                pipeline.descriptor_sets[i].write(1, vulkan_renderer.frame_constants[i], vulkan_renderer.lights[i]);
+                pipeline.descriptor_sets[i].write(65, vulkan_renderer.scattering_lut.get_image_view(),
+                                                  vulkan_renderer.scattering_lut.get_sampler());
+            }
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout,
+                {
+                    { VK_SHADER_STAGE_ALL, 0, sizeof(std::uint32_t) * 5 } // sample and settings.
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout,
+                                         VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                                         "Ray Tracer Pipeline Layout");
+
+            pipeline.compute_pipeline = vk::ComputePipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages[0],
+                pipeline.pipeline_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.compute_pipeline,
+                                         VK_OBJECT_TYPE_PIPELINE, "Ray Tracer Pipeline");
+        }
+
+        int Raytracer::id { 0 };
+#endif
+    }
+}
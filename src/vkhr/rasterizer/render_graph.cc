@@ -0,0 +1,126 @@
+#include <vkhr/rasterizer/render_graph.hh>
+
+namespace vkhr {
+    namespace vulkan {
+        RenderGraph::Resource RenderGraph::import_image(vk::Image& image, const State& state) {
+            resources.push_back({ &image, state.layout, state, { 0, 0 }, false });
+            return resources.size() - 1;
+        }
+
+        RenderGraph::Resource RenderGraph::import_buffer(const State& state) {
+            resources.push_back({ nullptr, VK_IMAGE_LAYOUT_UNDEFINED, state, { 0, 0 }, false });
+            return resources.size() - 1;
+        }
+
+        void RenderGraph::add_pass(const std::vector<Access>& accesses, Record record) {
+            passes.push_back({ accesses, record });
+        }
+
+        void RenderGraph::release(Resource resource, const State& state) {
+            releases.push_back({ resource, state, true });
+        }
+
+        void RenderGraph::execute(vk::CommandBuffer& command_buffer) {
+            for (auto& pass : passes) {
+                barrier(pass.accesses, command_buffer);
+                pass.record(command_buffer);
+            }
+
+            std::vector<Access> final_states;
+            for (const auto& release : releases) {
+                const auto& resource = resources[release.resource];
+                if (resource.accessed || (resource.image && resource.layout != release.state.layout))
+                    final_states.push_back(release);
+            }
+
+            barrier(final_states, command_buffer);
+
+            passes.clear();
+            releases.clear();
+        }
+
+        void RenderGraph::barrier(const std::vector<Access>& accesses, vk::CommandBuffer& command_buffer) {
+            VkPipelineStageFlags src_stages { 0 }, dst_stages { 0 };
+
+            VkMemoryBarrier memory_barrier;
+            memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            memory_barrier.pNext = nullptr;
+            memory_barrier.srcAccessMask = 0;
+            memory_barrier.dstAccessMask = 0;
+
+            std::vector<VkImageMemoryBarrier> image_barriers;
+
+            for (const auto& access : accesses) {
+                auto& resource = resources[access.resource];
+                resource.accessed = true;
+
+                bool layout_change = resource.image && resource.layout != access.state.layout;
+
+                // Reads that the last write has been made visible to don't need to wait for anything.
+                if (!access.write && !layout_change && (access.state.stage  & ~resource.read.stage)  == 0
+                                                    && (access.state.access & ~resource.read.access) == 0)
+                    continue;
+
+                src_stages |= resource.written.stage;
+                dst_stages |= access.state.stage;
+
+                // Writes (and layout transitions) also have to wait on the reads of the last write,
+                // but that's only an execution dependency since there's nothing to make visible.
+                if (access.write || layout_change)
+                    src_stages |= resource.read.stage;
+
+                if (layout_change) {
+                    VkImageMemoryBarrier image_barrier;
+                    image_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+                    image_barrier.pNext = nullptr;
+
+                    image_barrier.oldLayout = resource.layout;
+                    image_barrier.newLayout = access.state.layout;
+
+                    image_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                    image_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+
+                    image_barrier.image = resource.image->get_handle();
+
+                    image_barrier.subresourceRange.aspectMask = resource.image->get_aspect_mask();
+
+                    image_barrier.subresourceRange.baseMipLevel = 0;
+                    image_barrier.subresourceRange.levelCount = resource.image->get_mip_levels();
+                    image_barrier.subresourceRange.baseArrayLayer = 0;
+                    image_barrier.subresourceRange.layerCount = resource.image->get_array_layers();
+
+                    image_barrier.srcAccessMask = resource.written.access;
+                    image_barrier.dstAccessMask = access.state.access;
+
+                    image_barriers.push_back(image_barrier);
+
+                    resource.image->set_layout(access.state.layout);
+                    resource.layout = access.state.layout;
+                } else {
+                    memory_barrier.srcAccessMask |= resource.written.access;
+                    memory_barrier.dstAccessMask |= access.state.access;
+                }
+
+                if (access.write || layout_change) {
+                    // A transition is a write too, but it's already visible to the stages it waited on.
+                    resource.written = { access.state.stage, access.write ? access.state.access : 0 };
+                    resource.read    = access.write ? State { 0, 0 } : access.state;
+                } else {
+                    resource.read.stage  |= access.state.stage;
+                    resource.read.access |= access.state.access;
+                }
+            }
+
+            if (dst_stages == 0)
+                return; // nothing to wait on.
+
+            std::vector<VkMemoryBarrier> memory_barriers;
+            if (memory_barrier.srcAccessMask != 0 || memory_barrier.dstAccessMask != 0)
+                memory_barriers.push_back(memory_barrier);
+
+            command_buffer.pipeline_barrier(src_stages, dst_stages,
+                                            memory_barriers, { },
+                                            image_barriers);
+        }
+    }
+}
@@ -0,0 +1,162 @@
+#include <vkhr/rasterizer/scattering_lut.hh>
+
+#include <vkhr/rasterizer.hh>
+
+namespace vkhr {
+    namespace vulkan {
+        bool ScatteringLut::Fiber::operator==(const Fiber& fiber) const {
+            return longitudinal_shift == fiber.longitudinal_shift &&
+                   longitudinal_width == fiber.longitudinal_width &&
+                   azimuthal_width    == fiber.azimuthal_width    &&
+                   refraction_index   == fiber.refraction_index;
+        }
+
+        bool ScatteringLut::Fiber::operator!=(const Fiber& fiber) const {
+            return !(*this == fiber);
+        }
+
+        ScatteringLut::ScatteringLut(Rasterizer& vulkan_renderer) {
+            lut = vk::Image {
+                vulkan_renderer.device,
+                Resolution, Resolution, 1,
+                VK_FORMAT_R16G16B16A16_SFLOAT,
+                VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                1, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_TILING_OPTIMAL,
+                Layers
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, lut, VK_OBJECT_TYPE_IMAGE, "Scattering LUT", id);
+
+            lut_memory = vk::DeviceMemory {
+                vulkan_renderer.device,
+                lut.get_memory_requirements(),
+                vk::DeviceMemory::Type::DeviceLocal
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, lut_memory, VK_OBJECT_TYPE_DEVICE_MEMORY, "Scattering LUT Device Memory", id);
+
+            lut.bind(lut_memory);
+
+            lut_view = vk::ImageView {
+                vulkan_renderer.device, lut,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                0, 1, 0, Layers
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, lut_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Scattering LUT View", id);
+
+            lut_storage_view = vk::ImageView {
+                vulkan_renderer.device, lut,
+                VK_IMAGE_LAYOUT_GENERAL,
+                0, 1, 0, Layers
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, lut_storage_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Scattering LUT Storage View", id);
+
+            // The terms are smooth enough to be interpolated, and the edges are the ends of the angles.
+            lut_sampler = vk::Sampler {
+                vulkan_renderer.device,
+                VK_FILTER_LINEAR, VK_FILTER_LINEAR,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                false
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, lut_sampler, VK_OBJECT_TYPE_SAMPLER, "Scattering LUT Sampler", id);
+
+            // It's sampled by the pipelines before the first bake too, just with the other models.
+            auto command_buffer = vulkan_renderer.command_pool.allocate_and_begin();
+
+            lut.transition(command_buffer, 0, VK_ACCESS_SHADER_READ_BIT,
+                           VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                           VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                           VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+            command_buffer.end();
+            vulkan_renderer.command_pool.get_queue().submit(command_buffer)
+                                                    .wait_idle();
+
+            ++id;
+        }
+
+        bool ScatteringLut::needs_baking(const Fiber& fiber) const {
+            return !baked || fiber != baked_fiber;
+        }
+
+        void ScatteringLut::bake(Pipeline& pipeline, const Fiber& fiber, vk::CommandBuffer& command_buffer) {
+            // The frames submitted before this one have to be done shading with the old terms.
+            lut.transition(command_buffer, VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL,
+                           VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                           VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+            command_buffer.bind_pipeline(pipeline);
+            command_buffer.bind_descriptor_set(pipeline.descriptor_sets[0], pipeline);
+            command_buffer.push_constant(pipeline, 0, fiber);
+            command_buffer.dispatch(1, Resolution); // a row each.
+
+            lut.transition(command_buffer, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                           VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                           VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                           VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+            baked_fiber = fiber;
+            baked = true;
+        }
+
+        void ScatteringLut::build_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("shading/scattering_lut.comp"));
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0],
+                                         VK_OBJECT_TYPE_SHADER_MODULE, "Scattering LUT Shader");
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                vulkan_renderer.device,
+                {
+                    { 0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE }
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout,
+                                         VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Scattering LUT Descriptor Set Layout");
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(1, pipeline.descriptor_set_layout,
+                                                                                "Scattering LUT Descriptor Set");
+
+            pipeline.descriptor_sets[0].write(0, vulkan_renderer.scattering_lut.lut_storage_view);
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout,
+                {
+                    { VK_SHADER_STAGE_ALL, 0, sizeof(Fiber) }
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout,
+                                         VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                                         "Scattering LUT Pipeline Layout");
+
+            pipeline.compute_pipeline = vk::ComputePipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages[0],
+                pipeline.pipeline_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.compute_pipeline,
+                                         VK_OBJECT_TYPE_PIPELINE, "Scattering LUT Pipeline");
+        }
+
+        vk::ImageView& ScatteringLut::get_image_view() {
+            return lut_view;
+        }
+
+        vk::Sampler& ScatteringLut::get_sampler() {
+            return lut_sampler;
+        }
+
+        int ScatteringLut::id { 0 };
+    }
+}
@@ -0,0 +1,145 @@
+#include <vkhr/rasterizer/shading_rate_image.hh>
+
+#include <vkhr/rasterizer.hh>
+
+#include <vkpp/debug_marker.hh>
+
+namespace vkhr {
+    namespace vulkan {
+#ifdef VK_NV_shading_rate_image
+        ShadingRateImage::ShadingRateImage(Rasterizer& vulkan_renderer)
+                                          : texel_size { vulkan_renderer.shading_rate_texel_size } {
+            width  = (vulkan_renderer.swap_chain.get_width()  + texel_size.width  - 1) / texel_size.width;
+            height = (vulkan_renderer.swap_chain.get_height() + texel_size.height - 1) / texel_size.height;
+
+            image = vk::Image {
+                vulkan_renderer.device,
+                width, height,
+                VK_FORMAT_R8_UINT,
+                VK_IMAGE_USAGE_STORAGE_BIT |
+                VK_IMAGE_USAGE_SHADING_RATE_IMAGE_BIT_NV
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, image, VK_OBJECT_TYPE_IMAGE, "Shading Rate Image", id);
+
+            memory = vk::DeviceMemory {
+                vulkan_renderer.device,
+                image.get_memory_requirements(),
+                vk::DeviceMemory::Type::DeviceLocal
+            };
+
+            image.bind(memory);
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, memory, VK_OBJECT_TYPE_DEVICE_MEMORY, "Shading Rate Image Device Memory", id);
+
+            // For shading_rate.comp, the binds pass the shading rate layout themselves.
+            view = vk::ImageView {
+                vulkan_renderer.device,
+                image,
+                VK_IMAGE_LAYOUT_GENERAL
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, view, VK_OBJECT_TYPE_IMAGE_VIEW, "Shading Rate Image View", id);
+
+            ++id;
+        }
+
+        void ShadingRateImage::generate(LinkedList& ppll, std::uint32_t frame, Pipeline& pipeline, vk::CommandBuffer& command_buffer) {
+            // Every texel is written, so what the last frame's passes shaded with can be thrown away.
+            image.transition(command_buffer, 0, VK_ACCESS_SHADER_WRITE_BIT,
+                             VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                             VK_PIPELINE_STAGE_SHADING_RATE_IMAGE_BIT_NV, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+            command_buffer.bind_pipeline(pipeline);
+
+            pipeline.descriptor_sets[frame].write(5, ppll.get_heads_view());
+            pipeline.descriptor_sets[frame].write(6, ppll.get_nodes());
+            pipeline.descriptor_sets[frame].write(7, ppll.get_parameters());
+            pipeline.descriptor_sets[frame].write(8, ppll.get_node_counter());
+            pipeline.descriptor_sets[frame].write(9, view);
+
+            command_buffer.bind_descriptor_set(pipeline.descriptor_sets[frame], pipeline);
+
+            struct Parameters {
+                std::int32_t texel_width;
+                std::int32_t texel_height;
+                std::uint32_t interior_fragments;
+            } parameters {
+                static_cast<std::int32_t>(texel_size.width),
+                static_cast<std::int32_t>(texel_size.height),
+                InteriorFragments
+            };
+
+            command_buffer.push_constant(pipeline, 0, parameters);
+            command_buffer.dispatch(width, height); // a texel each.
+
+            // The clear of the PPLL right after this overwrites what was read, so it waits on it too.
+            image.transition(command_buffer, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADING_RATE_IMAGE_READ_BIT_NV,
+                             VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADING_RATE_OPTIMAL_NV,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_SHADING_RATE_IMAGE_BIT_NV | VK_PIPELINE_STAGE_TRANSFER_BIT);
+        }
+
+        void ShadingRateImage::bind(vk::CommandBuffer& command_buffer) {
+            command_buffer.bind_shading_rate_image(view);
+        }
+
+        void ShadingRateImage::build_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline */ };
+
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("variable_rate_shading/shading_rate.comp"));
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0],
+                                         VK_OBJECT_TYPE_SHADER_MODULE, "Shading Rate Image Generation");
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                vulkan_renderer.device,
+                {
+                    { 5, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE  },
+                    { 6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 7, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                    { 8, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                    { 9, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE  }
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout,
+                                         VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Shading Rate Image Descriptor Set Layout");
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
+                                                                                pipeline.descriptor_set_layout,
+                                                                                "Shading Rate Image Descriptor Set");
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout,
+                {
+                    { VK_SHADER_STAGE_ALL, 0, 3 * sizeof(std::uint32_t) }
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout,
+                                         VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                                         "Shading Rate Image Pipeline Layout");
+
+            pipeline.compute_pipeline = vk::ComputePipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages[0],
+                pipeline.pipeline_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.compute_pipeline,
+                                         VK_OBJECT_TYPE_PIPELINE, "Shading Rate Image Pipeline");
+        }
+
+        const std::vector<VkShadingRatePaletteEntryNV>& ShadingRateImage::get_palette() {
+            static const std::vector<VkShadingRatePaletteEntryNV> palette {
+                VK_SHADING_RATE_PALETTE_ENTRY_1_INVOCATION_PER_PIXEL_NV,
+                VK_SHADING_RATE_PALETTE_ENTRY_1_INVOCATION_PER_2X2_PIXELS_NV
+            };
+
+            return palette;
+        }
+
+        int ShadingRateImage::id { 0 };
+#endif
+    }
+}
@@ -0,0 +1,116 @@
+#include <vkhr/rasterizer/stereo_target.hh>
+
+#include <vkhr/rasterizer.hh>
+
+#include <vkpp/debug_marker.hh>
+
+namespace vkhr {
+    namespace vulkan {
+        StereoTarget::StereoTarget(Rasterizer& vulkan_renderer) {
+            auto extent = vulkan_renderer.get_color_extent(); // of one eye.
+
+            color_image = vk::Image {
+                vulkan_renderer.device,
+                extent.width, extent.height, 1,
+                vulkan_renderer.swap_chain.get_color_attachment_format(),
+                VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                1, VK_SAMPLE_COUNT_1_BIT,
+                VK_IMAGE_TILING_OPTIMAL,
+                Eyes
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, color_image, VK_OBJECT_TYPE_IMAGE, "Stereo Target Color Image", id);
+
+            color_memory = vk::DeviceMemory {
+                vulkan_renderer.device,
+                color_image.get_memory_requirements(),
+                vk::DeviceMemory::Type::DeviceLocal
+            };
+
+            color_image.bind(color_memory);
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, color_memory, VK_OBJECT_TYPE_DEVICE_MEMORY, "Stereo Target Color Device Memory", id);
+
+            color_view = vk::ImageView {
+                vulkan_renderer.device,
+                color_image,
+                vulkan_renderer.swap_chain.get_color_attachment_layout(),
+                0, 1, 0, Eyes
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, color_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Stereo Target Color Image View", id);
+
+            depth_image = vk::Image {
+                vulkan_renderer.device,
+                extent.width, extent.height, 1,
+                vulkan_renderer.swap_chain.get_depth_attachment_format(),
+                VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT |
+                VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT,
+                1, VK_SAMPLE_COUNT_1_BIT,
+                VK_IMAGE_TILING_OPTIMAL,
+                Eyes
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, depth_image, VK_OBJECT_TYPE_IMAGE, "Stereo Target Depth Image", id);
+
+            depth_memory = vk::DeviceMemory {
+                vulkan_renderer.device,
+                depth_image.get_memory_requirements(),
+                vk::DeviceMemory::Type::DeviceLocal
+            };
+
+            depth_image.bind(depth_memory);
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, depth_memory, VK_OBJECT_TYPE_DEVICE_MEMORY, "Stereo Target Depth Device Memory", id);
+
+            // Read as the input attachment of the raymarcher's subpass, which sees its own eye's layer.
+            depth_view = vk::ImageView {
+                vulkan_renderer.device,
+                depth_image,
+                vulkan_renderer.swap_chain.get_shader_read_only_layout(),
+                0, 1, 0, Eyes
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, depth_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Stereo Target Depth Image View", id);
+
+            // With multiview it has a single layer, and the views go into the layers of the attachments.
+            framebuffer = vk::Framebuffer {
+                vulkan_renderer.device.get_handle(),
+                vulkan_renderer.color_pass,
+                color_view, depth_view,
+                extent
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, framebuffer, VK_OBJECT_TYPE_FRAMEBUFFER, "Stereo Target Framebuffer", id);
+
+            ++id;
+        }
+
+        void StereoTarget::copy(vk::Image& destination, vk::CommandBuffer& command_buffer) {
+            auto extent = color_image.get_extent();
+            for (std::uint32_t eye { 0 }; eye < Eyes; ++eye) {
+                command_buffer.copy_image(color_image, destination, eye,
+                                          { static_cast<std::int32_t>(eye * extent.width), 0, 0 });
+            }
+        }
+
+        vk::Image& StereoTarget::get_color_image() {
+            return color_image;
+        }
+
+        vk::Framebuffer& StereoTarget::get_framebuffer() {
+            return framebuffer;
+        }
+
+        vk::ImageView& StereoTarget::get_depth_view() {
+            return depth_view;
+        }
+
+        VkDeviceSize StereoTarget::get_size_in_bytes() const {
+            return color_memory.get_size() + depth_memory.get_size();
+        }
+
+        int StereoTarget::id { 0 };
+    }
+}
@@ -0,0 +1,147 @@
+#include <vkhr/rasterizer/temporal_anti_aliasing.hh>
+
+#include <vkhr/rasterizer.hh>
+
+#include <vkpp/debug_marker.hh>
+
+#include <cmath>
+
+namespace vkhr {
+    namespace vulkan {
+        TemporalAntiAliasing::TemporalAntiAliasing(Rasterizer& vulkan_renderer)
+                                                  : width  { vulkan_renderer.swap_chain.get_width()  },
+                                                    height { vulkan_renderer.swap_chain.get_height() },
+                                                    vulkan_renderer { &vulkan_renderer } {
+            auto command_buffer = vulkan_renderer.command_pool.allocate_and_begin();
+
+            for (std::uint32_t i { 0 }; i < vulkan_renderer.frames_in_flight; ++i) {
+                history_images.emplace_back(vulkan_renderer.device,
+                                            width, height,
+                                            get_history_format(),
+                                            VK_IMAGE_USAGE_STORAGE_BIT |
+                                            VK_IMAGE_USAGE_SAMPLED_BIT);
+
+                vk::DebugMarker::object_name(vulkan_renderer.device, history_images[i], VK_OBJECT_TYPE_IMAGE, "TAA History Image", id);
+
+                history_memory.emplace_back(vulkan_renderer.device,
+                                            history_images[i].get_memory_requirements(),
+                                            vk::DeviceMemory::Type::DeviceLocal);
+
+                history_images[i].bind(history_memory[i]);
+
+                vk::DebugMarker::object_name(vulkan_renderer.device, history_memory[i], VK_OBJECT_TYPE_DEVICE_MEMORY, "TAA History Device Memory", id);
+
+                history_views.emplace_back(vulkan_renderer.device, history_images[i], VK_IMAGE_LAYOUT_GENERAL);
+
+                vk::DebugMarker::object_name(vulkan_renderer.device, history_views[i], VK_OBJECT_TYPE_IMAGE_VIEW, "TAA History Image View", id);
+
+                // Not cleared, since it isn't read before a resolve has written it (see history_valid).
+                history_images[i].transition(command_buffer, 0, VK_ACCESS_SHADER_WRITE_BIT,
+                                             VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                                             VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+            }
+
+            command_buffer.end();
+            vulkan_renderer.command_pool.get_queue().submit(command_buffer).wait_idle();
+
+            // Bilinear, since the history is reprojected in between its pixels.
+            sampler = vk::Sampler {
+                vulkan_renderer.device,
+                VK_FILTER_LINEAR,
+                VK_FILTER_LINEAR,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, sampler, VK_OBJECT_TYPE_SAMPLER, "TAA Sampler", id);
+
+            ++id;
+        }
+
+        void TemporalAntiAliasing::resolve(vk::SwapChain& swap_chain, std::uint32_t frame, std::uint32_t previous_frame, std::uint32_t image,
+                                           const glm::vec2& jitter, Pipeline& pipeline, vk::CommandBuffer& command_buffer) {
+            // Written by the previous frame's resolve, which was submitted before this.
+            history_images[previous_frame].transition(command_buffer, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                                                      VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+                                                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+            history_images[frame].transition(command_buffer, VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                                             VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+                                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+            command_buffer.bind_pipeline(pipeline);
+
+            pipeline.descriptor_sets[frame].write(9,  swap_chain.get_general_image_views()[image]);
+            pipeline.descriptor_sets[frame].write(10, swap_chain.get_depth_buffer_view(), vulkan_renderer->depth_sampler);
+            pipeline.descriptor_sets[frame].write(11, history_views[previous_frame], sampler);
+            pipeline.descriptor_sets[frame].write(12, history_views[frame]);
+
+            command_buffer.bind_descriptor_set(pipeline.descriptor_sets[frame], pipeline);
+
+            command_buffer.push_constant(pipeline, 0, Resolve { jitter, history_valid && previous_frame != frame });
+
+            command_buffer.dispatch(std::ceil(width / 8.0), std::ceil(height / 8.0));
+
+            history_valid = true;
+        }
+
+        void TemporalAntiAliasing::invalidate() {
+            history_valid = false;
+        }
+
+        void TemporalAntiAliasing::build_pipeline(Pipeline& pipeline, Rasterizer& rasterizer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline */ };
+
+            pipeline.shader_stages.emplace_back(rasterizer.device, SHADER("anti-aliasing/temporal_anti_aliasing.comp"));
+            vk::DebugMarker::object_name(rasterizer.device, pipeline.shader_stages[0],
+                                         VK_OBJECT_TYPE_SHADER_MODULE, "TAA Resolve");
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                rasterizer.device,
+                {
+                    { 0,  VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                    { 9,  VK_DESCRIPTOR_TYPE_STORAGE_IMAGE },
+                    { 10, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                    { 11, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                    { 12, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE }
+                }
+            };
+
+            vk::DebugMarker::object_name(rasterizer.device, pipeline.descriptor_set_layout,
+                                         VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "TAA Descriptor Set Layout");
+            pipeline.descriptor_sets = rasterizer.descriptor_pool.allocate(rasterizer.frames_in_flight,
+                                                                           pipeline.descriptor_set_layout,
+                                                                           "TAA Descriptor Set");
+
+            for (std::size_t i { 0 }; i < pipeline.descriptor_sets.size(); ++i) {
+                pipeline.descriptor_sets[i].write(0, rasterizer.frame_constants[i], rasterizer.camera[i]);
+            }
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                rasterizer.device,
+                pipeline.descriptor_set_layout,
+                {
+                    { VK_SHADER_STAGE_ALL, 0, sizeof(Resolve) }
+                }
+            };
+
+            vk::DebugMarker::object_name(rasterizer.device, pipeline.pipeline_layout,
+                                         VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                                         "TAA Pipeline Layout");
+
+            pipeline.compute_pipeline = vk::ComputePipeline {
+                rasterizer.device,
+                pipeline.shader_stages[0],
+                pipeline.pipeline_layout
+            };
+
+            vk::DebugMarker::object_name(rasterizer.device, pipeline.compute_pipeline,
+                                         VK_OBJECT_TYPE_PIPELINE, "TAA Pipeline");
+        }
+
+        VkFormat TemporalAntiAliasing::get_history_format() {
+            return VK_FORMAT_R16G16B16A16_SFLOAT;
+        }
+
+        int TemporalAntiAliasing::id { 0 };
+    }
+}
@@ -8,6 +8,8 @@
 
 #include <vkpp/debug_marker.hh>
 
+#include <cstddef>
+
 namespace vkhr {
     namespace vulkan {
         Volume::Volume(HairStyle& hair_style, vkhr::Rasterizer& vulkan_renderer) {
@@ -43,18 +45,41 @@ namespace vkhr {
             ++id;
         }
 
-        void Volume::set_current_volume(vk::ImageView& density_view, vk::ImageView& tangent_view) {
+        void Volume::set_current_volume(vk::ImageView& density_view, vk::ImageView& tangent_view, vk::ImageView& occupancy_view, vk::ImageView& occlusion_view,
+                                        vk::StorageBuffer& volume_bricks) {
             this->density_view = &density_view;
             this->tangent_view = &tangent_view;
+            this->occupancy_view = &occupancy_view;
+            this->occlusion_view = &occlusion_view;
+            this->volume_bricks = &volume_bricks;
         }
 
-        void Volume::set_volume_parameters(vk::UniformBuffer& buffer) {
-            this->parameter_buffer = &buffer;
+        void Volume::set_volume_parameters(std::uint32_t offset) {
+            this->parameter_offset = offset;
         }
 
-        void Volume::set_volume_sampler(vk::Sampler& density_sampler, vk::Sampler& tangent_sampler) {
+        void Volume::set_volume_sampler(vk::Sampler& density_sampler, vk::Sampler& tangent_sampler, vk::Sampler& occupancy_sampler, vk::Sampler& occlusion_sampler) {
             this->density_sampler = &density_sampler;
             this->tangent_sampler = &tangent_sampler;
+            this->occupancy_sampler = &occupancy_sampler;
+            this->occlusion_sampler = &occlusion_sampler;
+        }
+
+        void Volume::set_volume_mips(vk::ImageView& density_mips, vk::ImageView& tangent_mips, vk::Sampler& mip_sampler) {
+            this->density_mips = &density_mips;
+            this->tangent_mips = &tangent_mips;
+            this->mip_sampler = &mip_sampler;
+        }
+
+        void Volume::set_volume_transmittance(vk::ImageView& transmittance_view, vk::ImageView& ambient_occlusion_view, vk::Sampler& sampler) {
+            this->transmittance_view = &transmittance_view;
+            this->ambient_occlusion_view = &ambient_occlusion_view;
+            this->transmittance_sampler = &sampler;
+        }
+
+        void Volume::set_volume_distance_field(vk::ImageView& distance_field_view, vk::Sampler& sampler) {
+            this->distance_field_view = &distance_field_view;
+            this->distance_field_sampler = &sampler;
         }
 
         std::vector<glm::vec3> Volume::generate_aabb_vertices(const AABB& aabb) const {
@@ -102,10 +127,18 @@ namespace vkhr {
         }
 
         void Volume::draw(Pipeline& pipeline, vk::DescriptorSet& descriptor_set, vk::CommandBuffer& command_buffer) {
-            descriptor_set.write(2, *parameter_buffer);
-            descriptor_set.write(3, *density_view, *density_sampler);
-            descriptor_set.write(10, *tangent_view, *tangent_sampler);
-            command_buffer.bind_descriptor_set(descriptor_set, pipeline);
+            command_buffer.bind_descriptor_set(descriptor_set.with({
+                { 3,  *density_view,   *density_sampler },
+                { 10, *tangent_view,   *tangent_sampler },
+                { 11, *occupancy_view, *occupancy_sampler },
+                { 16, *occlusion_view, *occlusion_sampler },
+                { 14, *ambient_occlusion_view, *transmittance_sampler },
+                { 19, *transmittance_view, *transmittance_sampler },
+                { 29, *volume_bricks },
+                { 30, *density_mips, *mip_sampler },
+                { 31, *tangent_mips, *mip_sampler },
+                { 34, *distance_field_view, *distance_field_sampler }
+            }), pipeline, { parameter_offset });
             command_buffer.bind_vertex_buffer(0, vertices, 0);
             command_buffer.bind_index_buffer(elements);
             command_buffer.draw_indexed(elements.count());
@@ -118,12 +151,23 @@ namespace vkhr {
 
             pipeline.fixed_stages.set_topology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
 
-            pipeline.fixed_stages.set_scissor({ 0, 0, vulkan_renderer.swap_chain.get_extent() });
+            pipeline.fixed_stages.set_scissor({ 0, 0, vulkan_renderer.get_color_extent() });
             pipeline.fixed_stages.set_viewport({ 0.0, 0.0,
-                                                 static_cast<float>(vulkan_renderer.swap_chain.get_width()),
-                                                 static_cast<float>(vulkan_renderer.swap_chain.get_height()),
+                                                 static_cast<float>(vulkan_renderer.get_color_extent().width),
+                                                 static_cast<float>(vulkan_renderer.get_color_extent().height),
                                                  0.0, 1.0 });
 
+            // Since it's drawn in the color pass and the hair pass, see Rasterizer::set_hair_viewport.
+            pipeline.fixed_stages.add_dynamic_state(VK_DYNAMIC_STATE_VIEWPORT);
+            pipeline.fixed_stages.add_dynamic_state(VK_DYNAMIC_STATE_SCISSOR);
+
+            // Like the strands, see Rasterizer::set_hair_shading_rate.
+            bool coarse_shading = vulkan_renderer.shading_rate_pipelines();
+#ifdef VK_NV_shading_rate_image
+            if (coarse_shading)
+                pipeline.fixed_stages.enable_shading_rate_image(ShadingRateImage::get_palette());
+#endif
+
             pipeline.fixed_stages.disable_depth_test();
             pipeline.fixed_stages.set_front_face(VK_FRONT_FACE_CLOCKWISE);
             pipeline.fixed_stages.enable_alpha_blending_for(0);
@@ -132,59 +176,96 @@ namespace vkhr {
 
             struct Constants {
                 std::uint32_t light_size;
+                Rasterizer::ShaderParameters parameters;
             } constant_data {
-                light_count
+                light_count,
+                vulkan_renderer.shader_parameters
             };
 
             std::vector<VkSpecializationMapEntry> constants {
                 { 0, 0, sizeof(std::uint32_t) } // light size
             };
 
-            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("volumes/volume.vert"));
-            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0], VK_OBJECT_TYPE_SHADER_MODULE, "Volume Vertex Shader");
-            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("volumes/volume.frag"), constants, &constant_data, sizeof(constant_data));
+            Rasterizer::add_shader_parameters(constants, offsetof(Constants, parameters));
+
+            if (vulkan_renderer.stereo_rendering) {
+                pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("volumes/volume_stereo.vert"));
+                vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0], VK_OBJECT_TYPE_SHADER_MODULE, "Volume Stereo Vertex Shader");
+                pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("volumes/volume_stereo.frag"), constants, &constant_data, sizeof(constant_data));
+            } else {
+                pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("volumes/volume.vert"));
+                vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0], VK_OBJECT_TYPE_SHADER_MODULE, "Volume Vertex Shader");
+                if (coarse_shading)
+                    pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("volumes/volume_coarse.frag"), constants, &constant_data, sizeof(constant_data));
+                else
+                    pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("volumes/volume.frag"), constants, &constant_data, sizeof(constant_data));
+            }
             vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[1], VK_OBJECT_TYPE_SHADER_MODULE, "Volume Fragment Shader");
 
             std::vector<vk::DescriptorSet::Binding> descriptor_bindings {
                 { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
                 { 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
-                { 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                { 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC },
                 { 3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
                 { 4, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
                 { 5, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE },
                 { 6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
                 { 7, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
                 { 8, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                { 17, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
                 { 9, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT },
-                { 10, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER }
+                { 10, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 11, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 12, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE },
+                { 13, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE },
+                { 16, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 14, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 19, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 29, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                { 30, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 31, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 34, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 56, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER }, // light tiles.
+                { 65, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER } // Marschner.
             };
 
             pipeline.descriptor_set_layout = vk::DescriptorSet::Layout { vulkan_renderer.device, descriptor_bindings };
 
             vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Volume Descriptor Set Layout");
 
-            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.swap_chain.size(),
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
                                                                                 pipeline.descriptor_set_layout,
                                                                                 "Volume Descriptor Set");
 
             for (std::size_t i { 0 }; i < pipeline.descriptor_sets.size(); ++i) {
-                pipeline.descriptor_sets[i].write(0, vulkan_renderer.camera[i]);
-                pipeline.descriptor_sets[i].write(1, vulkan_renderer.lights[i]);
-                pipeline.descriptor_sets[i].write(4, vulkan_renderer.params[i]);
+                pipeline.descriptor_sets[i].write(0, vulkan_renderer.frame_constants[i], vulkan_renderer.camera[i]);
+                pipeline.descriptor_sets[i].write(1, vulkan_renderer.frame_constants[i], vulkan_renderer.lights[i]);
+                pipeline.descriptor_sets[i].write(2, vulkan_renderer.strand_parameters, 0, sizeof(HairStyle::Parameters));
+                pipeline.descriptor_sets[i].write(4, vulkan_renderer.frame_constants[i], vulkan_renderer.params[i]);
 
                 pipeline.descriptor_sets[i].write(5, vulkan_renderer.ppll.get_heads_view());
                 pipeline.descriptor_sets[i].write(6, vulkan_renderer.ppll.get_nodes());
                 pipeline.descriptor_sets[i].write(7, vulkan_renderer.ppll.get_parameters());
                 pipeline.descriptor_sets[i].write(8, vulkan_renderer.ppll.get_node_counter());
+                pipeline.descriptor_sets[i].write(17, vulkan_renderer.ppll.get_shading());
+
+                pipeline.descriptor_sets[i].write(9, vulkan_renderer.get_depth_buffer_view());
+                pipeline.descriptor_sets[i].write(56, vulkan_renderer.light_tiles.get_buffer());
+                pipeline.descriptor_sets[i].write(65, vulkan_renderer.scattering_lut.get_image_view(),
+                                                  vulkan_renderer.scattering_lut.get_sampler());
 
-                pipeline.descriptor_sets[i].write(9, vulkan_renderer.swap_chain.get_depth_buffer_view());
+                // Frames are drawn in order, so i - 1 was the one before.
+                auto previous = (i + pipeline.descriptor_sets.size() - 1) % pipeline.descriptor_sets.size();
+
+                pipeline.descriptor_sets[i].write(12, vulkan_renderer.volume_history_views[previous]);
+                pipeline.descriptor_sets[i].write(13, vulkan_renderer.volume_history_views[i]);
             }
 
             pipeline.pipeline_layout = vk::Pipeline::Layout {
                 vulkan_renderer.device,
                 pipeline.descriptor_set_layout,
                 {
-                    { VK_SHADER_STAGE_ALL, 0, sizeof(glm::mat4) } // model.
+                    { VK_SHADER_STAGE_ALL, 0, sizeof(Object) } // model and LoD.
                 }
             };
 
@@ -202,6 +283,274 @@ namespace vkhr {
             vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline, VK_OBJECT_TYPE_PIPELINE, "Volume Graphics Pipeline");
         }
 
+        void Volume::build_scaled_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+
+            pipeline.fixed_stages.add_vertex_binding({ 0, 0, VK_FORMAT_R32G32B32_SFLOAT, sizeof(glm::vec3) });
+
+            pipeline.fixed_stages.set_topology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+
+            pipeline.fixed_stages.set_scissor({ 0, 0, vulkan_renderer.swap_chain.get_extent() });
+            pipeline.fixed_stages.set_viewport({ 0.0, 0.0,
+                                                 static_cast<float>(vulkan_renderer.swap_chain.get_width()),
+                                                 static_cast<float>(vulkan_renderer.swap_chain.get_height()),
+                                                 0.0, 1.0 });
+
+            pipeline.fixed_stages.add_dynamic_state(VK_DYNAMIC_STATE_VIEWPORT);
+            pipeline.fixed_stages.add_dynamic_state(VK_DYNAMIC_STATE_SCISSOR);
+
+            pipeline.fixed_stages.enable_depth_test(); // closest surface wins.
+            pipeline.fixed_stages.set_front_face(VK_FRONT_FACE_CLOCKWISE);
+            pipeline.fixed_stages.disable_blending_for(0);
+
+            std::uint32_t light_count = vulkan_renderer.shadow_maps.size();
+
+            struct Constants {
+                std::uint32_t light_size;
+                Rasterizer::ShaderParameters parameters;
+            } constant_data {
+                light_count,
+                vulkan_renderer.shader_parameters
+            };
+
+            std::vector<VkSpecializationMapEntry> constants {
+                { 0, 0, sizeof(std::uint32_t) } // light size
+            };
+
+            Rasterizer::add_shader_parameters(constants, offsetof(Constants, parameters));
+
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("volumes/volume.vert"));
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0], VK_OBJECT_TYPE_SHADER_MODULE, "Scaled Volume Vertex Shader");
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("volumes/volume_scaled.frag"), constants, &constant_data, sizeof(constant_data));
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[1], VK_OBJECT_TYPE_SHADER_MODULE, "Scaled Volume Fragment Shader");
+
+            std::vector<vk::DescriptorSet::Binding> descriptor_bindings {
+                { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                { 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                { 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC },
+                { 3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 4, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                { 10, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 11, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 16, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 14, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 19, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 29, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                { 30, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 31, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 34, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 65, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER } // Marschner.
+            };
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout { vulkan_renderer.device, descriptor_bindings };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Scaled Volume Descriptor Set Layout");
+
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
+                                                                                pipeline.descriptor_set_layout,
+                                                                                "Scaled Volume Descriptor Set");
+
+            for (std::size_t i { 0 }; i < pipeline.descriptor_sets.size(); ++i) {
+                pipeline.descriptor_sets[i].write(0, vulkan_renderer.frame_constants[i], vulkan_renderer.camera[i]);
+                pipeline.descriptor_sets[i].write(1, vulkan_renderer.frame_constants[i], vulkan_renderer.lights[i]);
+                pipeline.descriptor_sets[i].write(2, vulkan_renderer.strand_parameters, 0, sizeof(HairStyle::Parameters));
+                pipeline.descriptor_sets[i].write(4, vulkan_renderer.frame_constants[i], vulkan_renderer.params[i]);
+                pipeline.descriptor_sets[i].write(65, vulkan_renderer.scattering_lut.get_image_view(),
+                                                  vulkan_renderer.scattering_lut.get_sampler());
+            }
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout,
+                {
+                    { VK_SHADER_STAGE_ALL, 0, sizeof(Object) } // model and LoD.
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Scaled Volume Pipeline Layout");
+
+            pipeline.pipeline = vk::GraphicsPipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages,
+                pipeline.fixed_stages,
+                pipeline.pipeline_layout,
+                vulkan_renderer.scaled_volume_pass
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline, VK_OBJECT_TYPE_PIPELINE, "Scaled Volume Graphics Pipeline");
+        }
+
+        void Volume::build_opaque_depth_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+
+            pipeline.fixed_stages.add_vertex_binding({ 0, 0, VK_FORMAT_R32G32B32_SFLOAT, sizeof(glm::vec3) });
+
+            pipeline.fixed_stages.set_topology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+
+            pipeline.fixed_stages.set_scissor({ 0, 0, vulkan_renderer.get_color_extent() });
+            pipeline.fixed_stages.set_viewport({ 0.0, 0.0,
+                                                 static_cast<float>(vulkan_renderer.get_color_extent().width),
+                                                 static_cast<float>(vulkan_renderer.get_color_extent().height),
+                                                 0.0, 1.0 });
+
+            pipeline.fixed_stages.enable_depth_test(); // behind the models it's already hidden.
+            pipeline.fixed_stages.set_front_face(VK_FRONT_FACE_CLOCKWISE);
+            pipeline.fixed_stages.disable_color_writes_for(0);
+
+            std::uint32_t light_count = vulkan_renderer.shadow_maps.size();
+
+            struct Constants {
+                std::uint32_t light_size;
+                Rasterizer::ShaderParameters parameters;
+            } constant_data {
+                light_count,
+                vulkan_renderer.shader_parameters
+            };
+
+            std::vector<VkSpecializationMapEntry> constants {
+                { 0, 0, sizeof(std::uint32_t) } // light size
+            };
+
+            Rasterizer::add_shader_parameters(constants, offsetof(Constants, parameters));
+
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("volumes/volume.vert"));
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0], VK_OBJECT_TYPE_SHADER_MODULE, "Opaque Depth Vertex Shader");
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("volumes/opaque_depth.frag"), constants, &constant_data, sizeof(constant_data));
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[1], VK_OBJECT_TYPE_SHADER_MODULE, "Opaque Depth Fragment Shader");
+
+            // Everything Volume::draw binds, even if only the density, occupancy and distance field are read.
+            std::vector<vk::DescriptorSet::Binding> descriptor_bindings {
+                { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                { 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC },
+                { 3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 4, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                { 10, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 11, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 16, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 14, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 19, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 29, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                { 30, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 31, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 34, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER }
+            };
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout { vulkan_renderer.device, descriptor_bindings };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Opaque Depth Descriptor Set Layout");
+
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
+                                                                                pipeline.descriptor_set_layout,
+                                                                                "Opaque Depth Descriptor Set");
+
+            for (std::size_t i { 0 }; i < pipeline.descriptor_sets.size(); ++i) {
+                pipeline.descriptor_sets[i].write(0, vulkan_renderer.frame_constants[i], vulkan_renderer.camera[i]);
+                pipeline.descriptor_sets[i].write(2, vulkan_renderer.strand_parameters, 0, sizeof(HairStyle::Parameters));
+                pipeline.descriptor_sets[i].write(4, vulkan_renderer.frame_constants[i], vulkan_renderer.params[i]);
+            }
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout,
+                {
+                    { VK_SHADER_STAGE_ALL, 0, sizeof(Object) } // model and LoD.
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Opaque Depth Pipeline Layout");
+
+            pipeline.pipeline = vk::GraphicsPipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages,
+                pipeline.fixed_stages,
+                pipeline.pipeline_layout,
+                vulkan_renderer.color_pass
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline, VK_OBJECT_TYPE_PIPELINE, "Opaque Depth Graphics Pipeline");
+        }
+
+        void Volume::build_upsample_pipeline(Pipeline& pipeline, Rasterizer& vulkan_renderer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline. */ };
+
+            pipeline.fixed_stages.set_topology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+
+            pipeline.fixed_stages.set_scissor({ 0, 0, vulkan_renderer.get_color_extent() });
+            pipeline.fixed_stages.set_viewport({ 0.0, 0.0,
+                                                 static_cast<float>(vulkan_renderer.get_color_extent().width),
+                                                 static_cast<float>(vulkan_renderer.get_color_extent().height),
+                                                 0.0, 1.0 });
+
+            pipeline.fixed_stages.disable_depth_test();
+            pipeline.fixed_stages.set_culling_mode(VK_CULL_MODE_NONE);
+            pipeline.fixed_stages.enable_alpha_blending_for(0);
+
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("volumes/upsample.vert"));
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[0], VK_OBJECT_TYPE_SHADER_MODULE, "Volume Upsample Vertex Shader");
+            pipeline.shader_stages.emplace_back(vulkan_renderer.device, SHADER("volumes/upsample.frag"));
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.shader_stages[1], VK_OBJECT_TYPE_SHADER_MODULE, "Volume Upsample Fragment Shader");
+
+            std::vector<vk::DescriptorSet::Binding> descriptor_bindings {
+                { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                { 5, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE },
+                { 6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                { 7, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER },
+                { 8, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                { 17, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER },
+                { 9, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT },
+                { 12, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 13, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 14, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                { 15, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER }
+            };
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout { vulkan_renderer.device, descriptor_bindings };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.descriptor_set_layout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "Volume Upsample Descriptor Set Layout");
+
+            pipeline.descriptor_sets = vulkan_renderer.descriptor_pool.allocate(vulkan_renderer.frames_in_flight,
+                                                                                pipeline.descriptor_set_layout,
+                                                                                "Volume Upsample Descriptor Set");
+
+            auto& half_target    = vulkan_renderer.volume_targets[0];
+            auto& quarter_target = vulkan_renderer.volume_targets[1];
+
+            for (std::size_t i { 0 }; i < pipeline.descriptor_sets.size(); ++i) {
+                pipeline.descriptor_sets[i].write(0, vulkan_renderer.frame_constants[i], vulkan_renderer.camera[i]);
+
+                pipeline.descriptor_sets[i].write(5, vulkan_renderer.ppll.get_heads_view());
+                pipeline.descriptor_sets[i].write(6, vulkan_renderer.ppll.get_nodes());
+                pipeline.descriptor_sets[i].write(7, vulkan_renderer.ppll.get_parameters());
+                pipeline.descriptor_sets[i].write(8, vulkan_renderer.ppll.get_node_counter());
+                pipeline.descriptor_sets[i].write(17, vulkan_renderer.ppll.get_shading());
+
+                pipeline.descriptor_sets[i].write(9, vulkan_renderer.get_depth_buffer_view());
+
+                pipeline.descriptor_sets[i].write(12, half_target.get_color_view(),    half_target.get_sampler());
+                pipeline.descriptor_sets[i].write(13, half_target.get_depth_view(),    half_target.get_sampler());
+                pipeline.descriptor_sets[i].write(14, quarter_target.get_color_view(), quarter_target.get_sampler());
+                pipeline.descriptor_sets[i].write(15, quarter_target.get_depth_view(), quarter_target.get_sampler());
+            }
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                vulkan_renderer.device,
+                pipeline.descriptor_set_layout
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline_layout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, "Volume Upsample Pipeline Layout");
+
+            pipeline.pipeline = vk::GraphicsPipeline {
+                vulkan_renderer.device,
+                pipeline.shader_stages,
+                pipeline.fixed_stages,
+                pipeline.pipeline_layout,
+                vulkan_renderer.color_pass,
+                1 // second color sub-pass.
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, pipeline.pipeline, VK_OBJECT_TYPE_PIPELINE, "Volume Upsample Graphics Pipeline");
+        }
+
         int Volume::id { 0 };
     }
 }
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include <vkhr/rasterizer/volume_target.hh>
+
+#include <vkhr/rasterizer.hh>
+#include <vkhr/rasterizer/depth_map.hh>
+
+#include <vkpp/debug_marker.hh>
+
+#include <algorithm>
+
+namespace vkhr {
+    namespace vulkan {
+        VolumeTarget::VolumeTarget(const std::uint32_t scale, Rasterizer& vulkan_renderer)
+                                  : scale { scale } {
+            std::uint32_t width  = std::max(vulkan_renderer.swap_chain.get_width()  / scale, 1u);
+            std::uint32_t height = std::max(vulkan_renderer.swap_chain.get_height() / scale, 1u);
+
+            color_image = vk::Image {
+                vulkan_renderer.device,
+                width, height,
+                get_color_format(),
+                get_color_usage_flags()
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, color_image, VK_OBJECT_TYPE_IMAGE, "Volume Target Color Image", id);
+
+            color_memory = vk::DeviceMemory {
+                vulkan_renderer.device,
+                color_image.get_memory_requirements(),
+                vk::DeviceMemory::Type::DeviceLocal
+            };
+
+            color_image.bind(color_memory);
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, color_memory, VK_OBJECT_TYPE_DEVICE_MEMORY, "Volume Target Color Device Memory", id);
+
+            color_view = vk::ImageView {
+                vulkan_renderer.device,
+                color_image,
+                get_read_color_layout()
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, color_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Volume Target Color Image View", id);
+
+            depth_image = vk::Image {
+                vulkan_renderer.device,
+                width, height,
+                DepthMap::get_attachment_format(),
+                VK_IMAGE_USAGE_SAMPLED_BIT |
+                DepthMap::get_image_usage_flags()
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, depth_image, VK_OBJECT_TYPE_IMAGE, "Volume Target Depth Image", id);
+
+            depth_memory = vk::DeviceMemory {
+                vulkan_renderer.device,
+                depth_image.get_memory_requirements(),
+                vk::DeviceMemory::Type::DeviceLocal
+            };
+
+            depth_image.bind(depth_memory);
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, depth_memory, VK_OBJECT_TYPE_DEVICE_MEMORY, "Volume Target Depth Device Memory", id);
+
+            depth_view = vk::ImageView {
+                vulkan_renderer.device,
+                depth_image,
+                DepthMap::get_read_depth_layout()
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, depth_view, VK_OBJECT_TYPE_IMAGE_VIEW, "Volume Target Depth Image View", id);
+
+            framebuffer = vk::Framebuffer {
+                vulkan_renderer.device.get_handle(),
+                vulkan_renderer.scaled_volume_pass,
+                color_view, depth_view,
+                VkExtent2D {
+                    width, height
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, framebuffer, VK_OBJECT_TYPE_FRAMEBUFFER, "Volume Target Framebuffer", id);
+
+            // Upsampling does its own depth-aware filtering of the taps.
+            sampler = vk::Sampler {
+                vulkan_renderer.device,
+                VK_FILTER_NEAREST,
+                VK_FILTER_NEAREST,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, sampler, VK_OBJECT_TYPE_SAMPLER, "Volume Target Sampler", id);
+
+            viewport = VkViewport {
+                0.0f, 0.0f,
+                static_cast<float>(width),
+                static_cast<float>(height),
+                0.0f, 1.0f
+            };
+
+            scissor = VkRect2D {
+                { 0, 0 },
+                { width, height }
+            };
+
+            ++id;
+        }
+
+        void VolumeTarget::update_dynamic_viewport_scissor_depth(vk::CommandBuffer& command_list) {
+            command_list.set_viewport(viewport);
+            command_list.set_scissor(scissor);
+        }
+
+        std::uint32_t VolumeTarget::get_scale() const {
+            return scale;
+        }
+
+        vk::Framebuffer& VolumeTarget::get_framebuffer() {
+            return framebuffer;
+        }
+
+        vk::Sampler& VolumeTarget::get_sampler() {
+            return sampler;
+        }
+
+        vk::ImageView& VolumeTarget::get_color_view() {
+            return color_view;
+        }
+
+        vk::ImageView& VolumeTarget::get_depth_view() {
+            return depth_view;
+        }
+
+        VkFormat VolumeTarget::get_color_format() {
+            return VK_FORMAT_R16G16B16A16_SFLOAT;
+        }
+
+        VkImageLayout VolumeTarget::get_read_color_layout() {
+            return VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        }
+
+        VkImageUsageFlags VolumeTarget::get_color_usage_flags() {
+            return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                   VK_IMAGE_USAGE_SAMPLED_BIT;
+        }
+
+        int VolumeTarget::id { 0 };
+    }
+}
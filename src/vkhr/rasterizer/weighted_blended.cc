@@ -0,0 +1,173 @@
+#include <vkhr/rasterizer/weighted_blended.hh>
+
+#include <vkhr/rasterizer.hh>
+
+#include <vkpp/debug_marker.hh>
+
+#include <cmath>
+
+namespace vkhr {
+    namespace vulkan {
+        WeightedBlended::WeightedBlended(Rasterizer& vulkan_renderer)
+                                        : width  { vulkan_renderer.swap_chain.get_width()  },
+                                          height { vulkan_renderer.swap_chain.get_height() } {
+            accumulation_image = vk::Image {
+                vulkan_renderer.device,
+                width, height,
+                get_accumulation_format(),
+                get_usage_flags()
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, accumulation_image, VK_OBJECT_TYPE_IMAGE, "WBOIT Accumulation Image", id);
+
+            accumulation_memory = vk::DeviceMemory {
+                vulkan_renderer.device,
+                accumulation_image.get_memory_requirements(),
+                vk::DeviceMemory::Type::DeviceLocal
+            };
+
+            accumulation_image.bind(accumulation_memory);
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, accumulation_memory, VK_OBJECT_TYPE_DEVICE_MEMORY, "WBOIT Accumulation Device Memory", id);
+
+            accumulation_view = vk::ImageView {
+                vulkan_renderer.device,
+                accumulation_image,
+                get_read_layout()
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, accumulation_view, VK_OBJECT_TYPE_IMAGE_VIEW, "WBOIT Accumulation Image View", id);
+
+            revealage_image = vk::Image {
+                vulkan_renderer.device,
+                width, height,
+                get_revealage_format(),
+                get_usage_flags()
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, revealage_image, VK_OBJECT_TYPE_IMAGE, "WBOIT Revealage Image", id);
+
+            revealage_memory = vk::DeviceMemory {
+                vulkan_renderer.device,
+                revealage_image.get_memory_requirements(),
+                vk::DeviceMemory::Type::DeviceLocal
+            };
+
+            revealage_image.bind(revealage_memory);
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, revealage_memory, VK_OBJECT_TYPE_DEVICE_MEMORY, "WBOIT Revealage Device Memory", id);
+
+            revealage_view = vk::ImageView {
+                vulkan_renderer.device,
+                revealage_image,
+                get_read_layout()
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, revealage_view, VK_OBJECT_TYPE_IMAGE_VIEW, "WBOIT Revealage Image View", id);
+
+            // Depth is owned by the swapchain, and only tested against here.
+            framebuffer = vk::Framebuffer {
+                vulkan_renderer.device.get_handle(),
+                vulkan_renderer.weighted_blended_pass,
+                {
+                    accumulation_view.get_handle(),
+                    revealage_view.get_handle(),
+                    vulkan_renderer.swap_chain.get_depth_buffer_view().get_handle()
+                },
+                VkExtent2D {
+                    width, height
+                }
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, framebuffer, VK_OBJECT_TYPE_FRAMEBUFFER, "WBOIT Framebuffer", id);
+
+            sampler = vk::Sampler {
+                vulkan_renderer.device,
+                VK_FILTER_NEAREST,
+                VK_FILTER_NEAREST,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE
+            };
+
+            vk::DebugMarker::object_name(vulkan_renderer.device, sampler, VK_OBJECT_TYPE_SAMPLER, "WBOIT Sampler", id);
+
+            ++id;
+        }
+
+        void WeightedBlended::composite(vk::SwapChain& swap_chain, std::uint32_t frame, std::uint32_t image, Pipeline& pipeline, vk::CommandBuffer& command_buffer) {
+            command_buffer.bind_pipeline(pipeline);
+
+            pipeline.descriptor_sets[frame].write(0, accumulation_view, sampler);
+            pipeline.descriptor_sets[frame].write(1, revealage_view,    sampler);
+            pipeline.descriptor_sets[frame].write(9, swap_chain.get_general_image_views()[image]);
+
+            command_buffer.bind_descriptor_set(pipeline.descriptor_sets[frame], pipeline);
+
+            command_buffer.dispatch(std::ceil(width / 8.0), std::ceil(height / 8.0));
+        }
+
+        void WeightedBlended::build_pipeline(Pipeline& pipeline, Rasterizer& rasterizer) {
+            pipeline = Pipeline { /* In the case we are re-creating the pipeline */ };
+
+            pipeline.shader_stages.emplace_back(rasterizer.device, SHADER("transparency/composite.comp"));
+            vk::DebugMarker::object_name(rasterizer.device, pipeline.shader_stages[0],
+                                         VK_OBJECT_TYPE_SHADER_MODULE, "WBOIT Composite");
+
+            pipeline.descriptor_set_layout = vk::DescriptorSet::Layout {
+                rasterizer.device,
+                {
+                    { 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                    { 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER },
+                    { 9, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE }
+                }
+            };
+
+            vk::DebugMarker::object_name(rasterizer.device, pipeline.descriptor_set_layout,
+                                         VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "WBOIT Descriptor Set Layout");
+            pipeline.descriptor_sets = rasterizer.descriptor_pool.allocate(rasterizer.frames_in_flight,
+                                                                           pipeline.descriptor_set_layout,
+                                                                           "WBOIT Descriptor Set");
+
+            pipeline.pipeline_layout = vk::Pipeline::Layout {
+                rasterizer.device,
+                pipeline.descriptor_set_layout
+            };
+
+            vk::DebugMarker::object_name(rasterizer.device, pipeline.pipeline_layout,
+                                         VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                                         "WBOIT Pipeline Layout");
+
+            pipeline.compute_pipeline = vk::ComputePipeline {
+                rasterizer.device,
+                pipeline.shader_stages[0],
+                pipeline.pipeline_layout
+            };
+
+            vk::DebugMarker::object_name(rasterizer.device, pipeline.compute_pipeline,
+                                         VK_OBJECT_TYPE_PIPELINE, "WBOIT Pipeline");
+        }
+
+        vk::Framebuffer& WeightedBlended::get_framebuffer() {
+            return framebuffer;
+        }
+
+        VkFormat WeightedBlended::get_accumulation_format() {
+            return VK_FORMAT_R16G16B16A16_SFLOAT;
+        }
+
+        VkFormat WeightedBlended::get_revealage_format() {
+            return VK_FORMAT_R16_SFLOAT;
+        }
+
+        VkImageLayout WeightedBlended::get_read_layout() {
+            return VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        }
+
+        VkImageUsageFlags WeightedBlended::get_usage_flags() {
+            return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                   VK_IMAGE_USAGE_SAMPLED_BIT;
+        }
+
+        int WeightedBlended::id { 0 };
+    }
+}
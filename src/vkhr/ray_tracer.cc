@@ -1,19 +1,33 @@
 #include <vkhr/ray_tracer.hh>
+#include <vkhr/trace_recorder.hh>
+#include <vkhr/job_system.hh>
 
 #include <utility>
 #include <iostream>
+#include <fstream>
 #include <string>
 
 #include <xmmintrin.h>
 #include <pmmintrin.h>
 
 #include <glm/gtx/rotate_vector.hpp>
+#include <glm/gtc/constants.hpp>
 
+#include <unordered_map>
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <limits>
 #include <vector>
 #include <cmath>
 
 namespace vkhr {
+    // Same as the one in heatmap.glsl, from dark blue (no cost) to dark red (the range and above).
+    static glm::vec3 heatmap(float cost, float range) {
+        float x = glm::clamp(cost / std::max(range, 1e-6f), 0.0f, 1.0f);
+        return glm::clamp(glm::vec3 { 1.5f } - glm::abs(4.0f * x - glm::vec3 { 3.0f, 2.0f, 1.0f }), 0.0f, 1.0f);
+    }
+
     static void embree_debug_callback(void*, const RTCError code,
                                              const char* message) {
         if (code == RTC_ERROR_UNKNOWN)
@@ -25,39 +39,146 @@ namespace vkhr {
         }
     }
 
-    Raytracer::Raytracer(const SceneGraph& scene_graph) {
+    Raytracer::Raytracer(const SceneGraph& scene_graph, bool deferred_load, unsigned thread_count)
+                        : thread_count { thread_count } {
         set_flush_to_zero();
         set_denormal_zero();
 
-        device = rtcNewDevice("verbose=1");
-
-        rtcSetDeviceErrorFunction(device, embree_debug_callback, nullptr);
-
         std::random_device rng; seed=rng(); 
 
-        load(scene_graph);
+        if (deferred_load)
+            defer_load(scene_graph);
+        else
+            load(scene_graph);
     }
 
     Raytracer::~Raytracer() noexcept {
-        rtcReleaseScene(scene);
-        rtcReleaseDevice(device);
+        stop_background();
+        release_scene();
+        if (device != nullptr)
+            rtcReleaseDevice(device);
     }
 
-    void Raytracer::load(const SceneGraph& scene_graph) {
+    void Raytracer::create_device() {
+        std::string config { "verbose=1" };
+        if (thread_count != 0)
+            config += ",threads=" + std::to_string(thread_count);
+
+        device = rtcNewDevice(config.c_str());
+
+        rtcSetDeviceErrorFunction(device, embree_debug_callback, nullptr);
+    }
+
+    void Raytracer::release_scene() {
         if (scene != nullptr) {
             rtcReleaseScene(scene);
             scene = nullptr;
         }
 
+        for (auto& hair_style : hair_styles)
+            rtcReleaseScene(hair_style.get_scene());
+
+        hair_styles.clear();
+        instance_styles.clear();
+        volumes.clear();
+    }
+
+    void Raytracer::defer_load(const SceneGraph& scene_graph) {
+        stop_background();
+        release_scene();
+        deferred_scene = &scene_graph;
+    }
+
+    bool Raytracer::is_loaded() const {
+        return scene != nullptr;
+    }
+
+    void Raytracer::reload(const SceneGraph& scene_graph, const SceneGraph::Changes& changes) {
+        if (changes.empty())
+            return;
+
+        stop_background();
+
+        if (!is_loaded())
+            return; // it'll be the reloaded scene when it's loaded.
+
+        if (changes.nodes)
+            return load(scene_graph);
+
+        std::vector<RTCScene> reloaded_scenes; // until the instances don't use them.
+
+        for (auto& hair_style : hair_styles) {
+            auto pointer = hair_style.get_pointer();
+            if (std::find(changes.hair_styles.begin(), changes.hair_styles.end(), pointer) != changes.hair_styles.end()) {
+                reloaded_scenes.push_back(hair_style.get_scene());
+                hair_style.load(*pointer, *this);
+            }
+        }
+
+        // They were attached in this order by load, so the instance IDs are the same as it had.
+        unsigned instance_id { 0 };
+        for (const auto& hair_style_node : scene_graph.get_nodes_with_hair_styles()) {
+            for (std::size_t i { 0 }; i < hair_style_node->get_hair_styles().size(); ++i) {
+                auto instance = rtcGetGeometry(scene, instance_id);
+                rtcSetGeometryInstancedScene(instance, hair_styles[instance_styles[instance_id++]].get_scene());
+                rtcSetGeometryTransform(instance, 0, RTC_FORMAT_FLOAT4X4_COLUMN_MAJOR,
+                                        &hair_style_node->get_model_matrix()[0][0]);
+                rtcCommitGeometry(instance);
+            }
+        }
+
+        rtcCommitScene(scene);
+
+        for (auto reloaded_scene : reloaded_scenes)
+            rtcReleaseScene(reloaded_scene);
+
+        volumes.clear(); // voxelized again when they're raymarched.
+        volumes_moved = true;
+
+        now_dirty = true;
+    }
+
+    void Raytracer::load_deferred() {
+        if (deferred_scene != nullptr)
+            load(*deferred_scene);
+    }
+
+    void Raytracer::load(const SceneGraph& scene_graph) {
+        stop_background();
+        release_scene();
+
+        deferred_scene = nullptr;
+
+        if (device == nullptr)
+            create_device();
+
         scene = rtcNewScene(device);
+        rtcSetSceneBuildQuality(scene, scene_build_quality);
+        rtcSetSceneFlags(scene, scene_flags);
 
-        // Load only the set of hair styles which are within the actual scene graph.
+        std::unordered_map<const HairStyle*, std::size_t> loaded_styles;
+
+        // Load only the set of hair styles which are within the actual scene graph, and only once,
+        // since nodes that share a style only need an instance of it with their own transform.
         for (const auto& hair_style_node : scene_graph.get_nodes_with_hair_styles()) {
             for (const auto hair_style : hair_style_node->get_hair_styles()) {
-                auto hair = embree::HairStyle { *hair_style, *this };
-                if (hair.get_geometry() >= hair_styles.size())
-                    hair_styles.resize(hair.get_geometry()+1);
-                hair_styles[hair.get_geometry()] = std::move(hair);
+                auto loaded_style = loaded_styles.find(hair_style);
+                if (loaded_style == loaded_styles.end()) {
+                    loaded_style = loaded_styles.emplace(hair_style, hair_styles.size()).first;
+                    hair_styles.emplace_back(*hair_style, *this);
+                }
+
+                auto instance = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_INSTANCE);
+                rtcSetGeometryInstancedScene(instance, hair_styles[loaded_style->second].get_scene());
+                rtcSetGeometryTransform(instance, 0, RTC_FORMAT_FLOAT4X4_COLUMN_MAJOR,
+                                        &hair_style_node->get_model_matrix()[0][0]);
+                rtcCommitGeometry(instance);
+                auto instance_id = rtcAttachGeometry(scene, instance);
+                rtcReleaseGeometry(instance);
+
+                if (instance_id >= instance_styles.size())
+                    instance_styles.resize(instance_id + 1);
+                instance_styles[instance_id] = loaded_style->second;
             }
         }
 
@@ -68,79 +189,327 @@ namespace vkhr {
             scene_graph.get_camera().get_height()
         };
 
-        back_buffer.resize(framebuffer.get_pixel_count(), glm::dvec3 { 0.0, 0.0, 0.0 });
+        finished_framebuffer = displayed_framebuffer = framebuffer;
+
+        back_buffer.resize(framebuffer.get_pixel_count());
+        luminance_squares.resize(framebuffer.get_pixel_count());
+
+        build_tiles();
 
         clear();
     }
 
     void Raytracer::draw(const SceneGraph& scene_graph) {
+        stop_background();
+        load_deferred();
+
+        if (raymarching)
+            load_volumes();
+
         if (now_dirty)
             clear();
 
-        auto& viewing_plane = scene_graph.get_camera().get_viewing_plane();
+        const auto& light_sources = scene_graph.get_light_sources();
+        trace(scene_graph.get_camera(), { light_sources.begin(), light_sources.end() });
+    }
+
+    void Raytracer::draw_in_background(const SceneGraph& scene_graph) {
+        load_deferred(); // i.e. when it's first switched to.
+
+        if (raymarching && volumes.size() != hair_styles.size()) {
+            stop_background(); // since it's marching them.
+            load_volumes();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock { background_mutex };
+
+            background_camera = scene_graph.get_camera();
+            background_lights.assign(scene_graph.get_light_sources().begin(),
+                                     scene_graph.get_light_sources().end());
+
+            if (now_dirty) {
+                background_restart = true;
+                cancel_trace = true;
+                now_dirty = false;
+            }
+        }
+
+        if (!background_thread.joinable()) {
+            update_all_tiles(); // the displayed_framebuffer is shown instead.
+            background_stop = false;
+            background_thread = std::thread { &Raytracer::background_loop, this };
+        }
+    }
+
+    void Raytracer::stop_background() {
+        if (!background_thread.joinable())
+            return;
+
+        background_stop = true;
+        cancel_trace = true;
+        background_thread.join();
+
+        // Since the pass that was cancelled was only partially accumulated.
+        now_dirty = true;
+
+        update_all_tiles(); // the framebuffer is displayed instead.
+    }
+
+    bool Raytracer::in_background() const {
+        return background_thread.joinable();
+    }
+
+    void Raytracer::background_loop() {
+        while (!background_stop) {
+            bool restart { false };
+
+            Camera camera;
+            std::vector<LightSource> lights;
+
+            {
+                std::lock_guard<std::mutex> lock { background_mutex };
+                camera = background_camera;
+                lights = background_lights;
+                restart = background_restart;
+                background_restart = false;
+                cancel_trace = false;
+            }
+
+            if (restart)
+                clear_samples();
+
+            trace(camera, lights);
+
+            if (cancel_trace)
+                continue; // a restart (or stop) clears the partial pass.
+
+            resolve();
+
+            std::lock_guard<std::mutex> lock { background_mutex };
+            using std::swap;
+            swap(framebuffer, finished_framebuffer);
+            finished_frame = true;
+
+            for (std::size_t tile { 0 }; tile < tiles.size(); ++tile)
+                finished_tiles[tile] |= traced_tiles[tile];
+            std::fill(traced_tiles.begin(), traced_tiles.end(), 0);
+        }
+    }
+
+    void Raytracer::trace(const Camera& camera, const std::vector<LightSource>& lights) {
+        auto& viewing_plane = camera.get_viewing_plane();
+
+        glm::uvec2 resolution { framebuffer.get_width(), framebuffer.get_height() };
+
+        std::atomic<std::size_t> converged { 0 }, pixels_traced { 0 };
+
+        int begin_tile = static_cast<int>(std::min(first_tile, tiles.size()));
+        int last_tile  = tile_count ? static_cast<int>(std::min(first_tile + tile_count, tiles.size())) :
+                                      static_cast<int>(tiles.size());
 
-        auto& camera = scene_graph.get_camera();
-        auto& light  = scene_graph.get_light_sources().front();
+        JobSystem::get().parallel_for_nodes(begin_tile, last_tile, [&](int tile) {
+            if (cancel_trace)
+                return; // the samples will be cleared.
 
-        #pragma omp parallel for schedule(dynamic)
-        for (int j = 0; j < static_cast<int>(framebuffer.get_height()); ++j)
-        for (int i = 0; i < static_cast<int>(framebuffer.get_width());  ++i) {
-            float x { static_cast<float>(i) },
-                  y { static_cast<float>(j) };
+            TraceRecorder::Scope trace_scope { "Trace Tile" };
 
-            glm::dvec3 sample_color { 1.000, 1.000, 1.000 };
+            auto tile_start = std::chrono::steady_clock::now();
+
+            auto tile_end = glm::min(tiles[tile] + TileSize, resolution);
+            pixels_traced += (tile_end.x - tiles[tile].x) * (tile_end.y - tiles[tile].y);
+
+            std::size_t converged_in_tile { 0 };
+
+            std::vector<Ray> primary_rays, shadow_rays, occlusion_rays;
+            primary_rays.reserve(TileSize * TileSize);
+            std::vector<unsigned> pixels; // of the primary rays.
+            pixels.reserve(TileSize * TileSize);
+            std::vector<std::size_t> hit_lights; // and the light sampled for each hit.
+            std::vector<float> hit_light_probabilities;
+
+            for (unsigned j = tiles[tile].y; j < tile_end.y; ++j)
+            for (unsigned i = tiles[tile].x; i < tile_end.x; ++i) {
+                float x { static_cast<float>(i) },
+                      y { static_cast<float>(j) };
+
+                unsigned pixel { i + j * framebuffer.get_width() };
+
+                if (pixel_converged(pixel)) {
+                    ++converged_in_tile;
+                    continue;
+                }
+
+                glm::vec2 jitter { sample(pixel, 0) };
+
+                auto direction = ((x + jitter.x) * viewing_plane.x +
+                                  (y + jitter.y) * viewing_plane.y +
+                                                   viewing_plane.z);
+
+                primary_rays.emplace_back(viewing_plane.point, direction, 0.0000f);
+                pixels.push_back(pixel);
+            }
+
+            converged += converged_in_tile;
+
+            if (!primary_rays.empty())
+                traced_tiles[tile] = 1;
+
+            // Everything before the accumulation, split evenly between the pixels that were traced.
+            auto pixel_time = [&]() {
+                std::chrono::duration<float, std::micro> tile_time { std::chrono::steady_clock::now() - tile_start };
+                return tile_time.count() / std::max(primary_rays.size(), std::size_t { 1 });
+            };
+
+            auto accumulate = [&](unsigned pixel, glm::vec3 sample_color, float time) {
+                if (trace_cost)
+                    sample_color = heatmap(time, trace_cost_range);
+
+                back_buffer[pixel] += glm::vec4 { sample_color, 1.0f };
+
+                float luminance = glm::dot(sample_color, glm::vec3 { 0.2126f, 0.7152f, 0.0722f });
+                luminance_squares[pixel] += luminance * luminance;
+            };
+
+            if (raymarching) {
+                std::vector<glm::vec3> sample_colors;
+                raymarch(primary_rays, pixels, camera, lights, sample_colors);
+
+                float time = pixel_time();
+                for (std::size_t ray { 0 }; ray < primary_rays.size(); ++ray)
+                    accumulate(pixels[ray], sample_colors[ray], time);
+
+                return;
+            }
 
             RTCIntersectContext      context;
             rtcInitIntersectContext(&context);
 
-            glm::vec2 jitter {
-                sample(0.0f, 1.0f),
-                sample(0.0f, 1.0f)
-            };
+            context.flags = RTC_INTERSECT_CONTEXT_FLAG_COHERENT; // tile.
+            Ray::intersect(primary_rays, scene, context);
+            context.flags = RTC_INTERSECT_CONTEXT_FLAG_INCOHERENT;
+
+            for (std::size_t ray { 0 }; ray < primary_rays.size(); ++ray) {
+                if (primary_rays[ray].hit_surface()) {
+                    // The visualizations of the shadows only show the first light, like the rasterizer.
+                    float probability { 1.0f };
+                    std::size_t light { 0 };
+                    if (visualization_method == Shaded)
+                        light = sample_light(lights, primary_rays[ray].get_intersection_point(),
+                                             sample_float(pixels[ray], 5), probability);
+                    hit_lights.push_back(light);
+                    hit_light_probabilities.push_back(probability);
+
+                    shadow_rays.push_back(shadow_ray(primary_rays[ray], lights[light], pixels[ray]));
+                    occlusion_rays.push_back(occlusion_ray(primary_rays[ray].get_intersection_point(), pixels[ray]));
+                }
+            }
+
+            // The untraced rays are never occluded.
+            if (shadows_on && visualization_method != AmbientOcclusion)
+                Ray::occluded(shadow_rays, scene, context);
+            if (visualization_method != DirectShadows)
+                Ray::occluded(occlusion_rays, scene, context);
+
+            std::size_t hit { 0 };
 
-            auto direction = ((x + jitter.x) * viewing_plane.x +
-                              (y + jitter.y) * viewing_plane.y +
-                                               viewing_plane.z);
+            float time = pixel_time();
 
-            Ray ray { viewing_plane.point, direction, 0.0000f };
+            for (std::size_t ray { 0 }; ray < primary_rays.size(); ++ray) {
+                glm::vec3 sample_color { 1.000, 1.000, 1.000 };
 
-            if (ray.intersects(scene, context)) {
-                glm::vec3 position { ray.get_intersection_point() };
+                if (primary_rays[ray].hit_surface()) {
+                    const auto& light = lights[hit_lights[hit]];
+                    sample_color = light_shading(primary_rays[ray], shadow_rays[hit], camera, light);
 
-                sample_color = light_shading(ray, camera, light, context);
+                    if (visualization_method == Shaded) {
+                        sample_color *= light.get_attenuation(primary_rays[ray].get_intersection_point()) /
+                                        hit_light_probabilities[hit];
+                    }
 
-                if (visualization_method != DirectShadows) {
-                    sample_color *= ambient_occlusion(position,  context);
+                    if (visualization_method != DirectShadows) {
+                        sample_color *= ambient_occlusion(occlusion_rays[hit]);
+                    }
+
+                    ++hit;
                 }
+
+                accumulate(pixels[ray], sample_color, time);
             }
+        }, thread_count);
 
-            back_buffer[i + j * framebuffer.get_width()] += sample_color;
-        }
+        converged_pixels = converged;
+        pixels_in_range  = pixels_traced;
 
         ++samples;
 
-        framebuffer.clear();
-        framebuffer.copy(back_buffer, samples);
+        resolve_needed = true;
+    }
+
+    void Raytracer::resolve() const {
+        if (resolve_needed && samples != 0)
+            framebuffer.copy(back_buffer.data());
+        resolve_needed = false;
+    }
+
+    std::size_t Raytracer::sample_light(const std::vector<LightSource>& lights, const glm::vec3& point,
+                                        float sample, float& probability) {
+        constexpr std::size_t MaximumLights { 32 }; // see SceneGraph's limit.
+        std::array<float, MaximumLights> importance;
+
+        std::size_t light_count = std::min(lights.size(), MaximumLights);
+
+        float total_importance { 0.0f };
+        for (std::size_t i { 0 }; i < light_count; ++i) {
+            importance[i] = glm::dot(lights[i].get_intensity(), glm::vec3 { 0.2126f, 0.7152f, 0.0722f }) *
+                            lights[i].get_attenuation(point);
+            total_importance += importance[i];
+        }
+
+        if (total_importance <= 0.0f) {
+            probability = 1.0f;
+            return 0; // none of them reach it, so it doesn't matter which.
+        }
+
+        float target = sample * total_importance;
+
+        std::size_t light { 0 };
+        for (; light + 1 < light_count; ++light) {
+            if (target < importance[light])
+                break;
+            target -= importance[light];
+        }
+
+        while (importance[light] == 0.0f)
+            --light; // if the rounding left it past the last one that's lit.
+
+        probability = importance[light] / total_importance;
+        return light;
     }
 
-    glm::vec3 Raytracer::light_shading(const Ray& ray, const Camera& camera, const LightSource& light, RTCIntersectContext& context) {
+    Ray Raytracer::shadow_ray(const Ray& ray, const LightSource& light, unsigned pixel) {
         glm::vec3 light_jitter {
-            sample(-16.0f, 16.0f),
-            sample(-16.0f, 16.0f),
-            sample(-16.0f, 16.0f)
+            sample(pixel, 1),
+            sample_float(pixel, 2)
         };
 
-        Ray shadow_ray {
+        light_jitter = light_jitter * 32.0f - 16.0f;
+
+        return Ray {
             ray.get_intersection_point(),
             light.get_spotlight_origin() + light_jitter,
             Ray::Epsilon
         };
+    }
 
+    glm::vec3 Raytracer::light_shading(const Ray& ray, const Ray& shadow_ray, const Camera& camera, const LightSource& light) {
         if (visualization_method == AmbientOcclusion) {
             return glm::vec3 { 1.0f };
-        } else if (!shadow_ray.occluded_by(scene, context) || !shadows_on) {
-            if (visualization_method == Shaded) {
-                return hair_styles[ray.get_geometry_id()].shade(ray, light, camera);
+        } else if (!shadow_ray.is_occluded() || !shadows_on) {
+            if (visualization_method == Shaded && marschner_shading) {
+                return hair_styles[instance_styles[ray.get_instance_id()]].shade(ray, light, camera, scattering_lut);
+            } else if (visualization_method == Shaded) {
+                return hair_styles[instance_styles[ray.get_instance_id()]].shade(ray, light, camera);
             } else {
                 return glm::vec3 { 1.0f };
             }
@@ -149,56 +518,620 @@ namespace vkhr {
         }
     }
 
-    float Raytracer::ambient_occlusion(const glm::vec3& position, RTCIntersectContext& context) {
+    Ray Raytracer::occlusion_ray(const glm::vec3& position, unsigned pixel) {
         auto random_direction = glm::vec3 {
-            sample(-1.0f, +1.0f),
-            sample(-1.0f, +1.0f),
-            sample(-1.0f, +1.0f)
+            sample(pixel, 3),
+            sample_float(pixel, 4)
         };
 
+        random_direction = random_direction * 2.0f - 1.0f;
+
         Ray random_ray {
             position,
             random_direction,
             Ray::Epsilon
         };
 
-        if (!random_ray.occluded_by(scene, context, ao_radius))
+        // Since the direction isn't normalized, and we only want what's inside the ao_radius.
+        random_ray.set_far_plane(ao_radius / std::max(glm::length(random_direction), Ray::Epsilon));
+
+        return random_ray;
+    }
+
+    float Raytracer::ambient_occlusion(const Ray& occlusion_ray) {
+        if (!occlusion_ray.is_occluded())
             return 2.0f;
         else
             return 0.0f;
     }
 
+    void Raytracer::load_volumes() {
+        if (volumes.size() == hair_styles.size())
+            return;
+
+        volumes.clear();
+        volumes.reserve(hair_styles.size());
+
+        // The cached ones are from before the strands moved, if they have.
+        for (const auto& hair_style : hair_styles)
+            volumes.emplace_back(*hair_style.get_pointer(), !volumes_moved);
+    }
+
+    void Raytracer::raymarch(const std::vector<Ray>& rays, const std::vector<unsigned>& pixels,
+                             const Camera& camera, const std::vector<LightSource>& lights,
+                             std::vector<glm::vec3>& sample_colors) {
+        sample_colors.assign(rays.size(), glm::vec3 { 1.0f });
+
+        if (volumes.size() != hair_styles.size())
+            return; // until the next draw has loaded them.
+
+        constexpr unsigned PacketSize { embree::Volume::PacketSize };
+
+        std::vector<glm::mat4> models(instance_styles.size()), inverse_models(instance_styles.size());
+        for (unsigned instance { 0 }; instance < instance_styles.size(); ++instance) {
+            rtcGetGeometryTransform(rtcGetGeometry(scene, instance), 0.0f,
+                                    RTC_FORMAT_FLOAT4X4_COLUMN_MAJOR, &models[instance][0][0]);
+            inverse_models[instance] = glm::inverse(models[instance]);
+        }
+
+        // The nearest surface of all of the instances, which isn't blended with the ones behind it.
+        std::vector<float> distances(rays.size(), std::numeric_limits<float>::max()), coverages(rays.size(), 0.0f);
+        std::vector<glm::vec3> surfaces(rays.size()); // in the model space of the instance.
+        std::vector<unsigned> surface_instances(rays.size());
+
+        for (unsigned instance { 0 }; instance < instance_styles.size(); ++instance) {
+            const auto& volume = volumes[instance_styles[instance]];
+            float hair_alpha = hair_styles[instance_styles[instance]].get_hair_alpha();
+
+            for (std::size_t first { 0 }; first < rays.size(); first += PacketSize) {
+                auto count = static_cast<unsigned>(std::min<std::size_t>(PacketSize, rays.size() - first));
+
+                std::array<glm::vec3, PacketSize> origins, directions;
+                std::array<embree::Volume::Surface, PacketSize> packet_surfaces;
+
+                for (unsigned lane { 0 }; lane < count; ++lane) {
+                    origins[lane] = glm::vec3 { inverse_models[instance] * glm::vec4 { rays[first + lane].get_origin(), 1.0f } };
+                    directions[lane] = glm::normalize(glm::vec3 { inverse_models[instance] * glm::vec4 { rays[first + lane].get_direction(), 0.0f } });
+                }
+
+                volume.find_surfaces(origins, directions, count, raymarch_settings, hair_alpha, packet_surfaces);
+
+                for (unsigned lane { 0 }; lane < count; ++lane) {
+                    if (packet_surfaces[lane].density == 0.0f)
+                        continue;
+
+                    auto ray = first + lane;
+                    glm::vec3 surface { models[instance] * glm::vec4 { packet_surfaces[lane].position, 1.0f } };
+                    float distance = glm::distance(surface, rays[ray].get_origin());
+                    if (distance < distances[ray]) {
+                        distances[ray] = distance;
+                        coverages[ray] = std::min(hair_alpha * packet_surfaces[lane].density, 1.0f);
+                        surfaces[ray] = packet_surfaces[lane].position;
+                        surface_instances[ray] = instance;
+                    }
+                }
+            }
+        }
+
+        // Shaded like shade_volume.glsl, but with one light per sample (see sample_light) like the strands.
+        for (std::size_t ray { 0 }; ray < rays.size(); ++ray) {
+            if (coverages[ray] == 0.0f)
+                continue;
+
+            auto instance = surface_instances[ray];
+            const auto& volume = volumes[instance_styles[instance]];
+            auto& hair_style = hair_styles[instance_styles[instance]];
+
+            glm::vec3 surface { models[instance] * glm::vec4 { surfaces[ray], 1.0f } };
+
+            float probability { 1.0f };
+            std::size_t light { 0 };
+            if (visualization_method == Shaded)
+                light = sample_light(lights, surface, sample_float(pixels[ray], 5), probability);
+
+            glm::vec3 shading { 1.0f };
+
+            if (visualization_method == Shaded) {
+                glm::vec3 tangent { models[instance] * glm::vec4 { volume.sample_tangent(surfaces[ray]), 0.0f } };
+                if (tangent != glm::vec3 { 0.0f })
+                    tangent = glm::normalize(tangent);
+
+                if (marschner_shading)
+                    shading = hair_style.shade(surface, tangent, lights[light], camera, scattering_lut);
+                else
+                    shading = hair_style.shade(surface, tangent, lights[light], camera);
+
+                shading *= lights[light].get_attenuation(surface) / probability;
+            }
+
+            if (shadows_on && visualization_method != AmbientOcclusion) {
+                glm::vec3 light_position { inverse_models[instance] * glm::vec4 { lights[light].get_spotlight_origin(), 1.0f } };
+                shading *= volume.deep_shadows(surfaces[ray], light_position, hair_style.get_hair_alpha(), raymarch_settings);
+            }
+
+            if (visualization_method != DirectShadows)
+                shading *= volume.local_ambient_occlusion(surfaces[ray], raymarch_settings);
+
+            sample_colors[ray] = glm::mix(glm::vec3 { 1.0f }, shading, coverages[ray]);
+        }
+    }
+
+    void Raytracer::set_raymarching(bool raymarching) {
+        stop_background();
+        this->raymarching = raymarching;
+        now_dirty = true;
+    }
+
+    bool Raytracer::raymarching_enabled() const {
+        return raymarching;
+    }
+
+    Raytracer::VisualizationMethod Raytracer::get_visualization_method() const {
+        return visualization_method;
+    }
+
+    bool Raytracer::shadows_enabled() const {
+        return shadows_on;
+    }
+
+    bool Raytracer::marschner_enabled() const {
+        return marschner_shading;
+    }
+
+    float Raytracer::get_ao_radius() const {
+        return ao_radius;
+    }
+
     Image& Raytracer::get_framebuffer() {
+        if (in_background()) {
+            std::lock_guard<std::mutex> lock { background_mutex };
+            if (finished_frame) {
+                using std::swap;
+                swap(finished_framebuffer, displayed_framebuffer);
+                finished_frame = false;
+
+                for (std::size_t tile { 0 }; tile < tiles.size(); ++tile)
+                    displayed_tiles[tile] |= finished_tiles[tile];
+                std::fill(finished_tiles.begin(), finished_tiles.end(), 0);
+            }
+
+            return displayed_framebuffer;
+        }
+
+        resolve();
         return framebuffer;
     }
 
     const Image& Raytracer::get_framebuffer() const {
+        if (in_background())
+            return displayed_framebuffer;
+        resolve();
         return framebuffer;
     }
 
     void Raytracer::set_framebuffer(const Image& framebuffer) {
         this->framebuffer = framebuffer;
+        resolve_needed = false;
+        update_all_tiles();
+    }
+
+    std::vector<glm::uvec2> Raytracer::get_updated_tiles() {
+        std::vector<glm::uvec2> updated_tiles;
+
+        auto take_tiles = [&](std::vector<unsigned char>& tile_updates) {
+            for (std::size_t tile { 0 }; tile < tiles.size(); ++tile) {
+                if (tile_updates[tile]) updated_tiles.push_back(tiles[tile]);
+            }
+
+            std::fill(tile_updates.begin(), tile_updates.end(), 0);
+        };
+
+        if (in_background()) {
+            std::lock_guard<std::mutex> lock { background_mutex };
+            take_tiles(displayed_tiles);
+        } else {
+            take_tiles(traced_tiles);
+        }
+
+        return updated_tiles;
+    }
+
+    void Raytracer::update_all_tiles() {
+        traced_tiles.assign(tiles.size(), 1);
+        finished_tiles.assign(tiles.size(), 1);
+        displayed_tiles.assign(tiles.size(), 1);
     }
 
     void Raytracer::clear() {
-        samples = 0;
-        std::fill(back_buffer.begin(),
-                  back_buffer.end(),
-                  glm::vec3 { 0.0 });
+        clear_samples();
         now_dirty = false;
     }
 
+    void Raytracer::clear_samples() {
+        samples = 0;
+
+        glm::uvec2 resolution { framebuffer.get_width(), framebuffer.get_height() };
+
+        // By tile, and on all of the threads, since this is where the pages are placed (see above).
+        JobSystem::get().parallel_for_nodes(0, static_cast<int>(tiles.size()), [&](int tile) {
+            auto tile_end = glm::min(tiles[tile] + TileSize, resolution);
+            for (unsigned j = tiles[tile].y; j < tile_end.y; ++j) {
+                unsigned row { tiles[tile].x + j * framebuffer.get_width() };
+                std::fill_n(back_buffer.begin() + row, tile_end.x - tiles[tile].x, glm::vec4 { 0.0f });
+                std::fill_n(luminance_squares.begin() + row, tile_end.x - tiles[tile].x, 0.0f);
+            }
+        }, thread_count);
+
+        converged_pixels = 0;
+    }
+
     void Raytracer::recreate(unsigned width, unsigned height) {
+        // e.g. when only the present mode changed, so the samples so far don't have to be thrown away.
+        if (width == framebuffer.get_width() && height == framebuffer.get_height())
+            return;
+
+        stop_background();
+
         framebuffer = Image {
             width,
             height
         };
 
-        back_buffer.resize(framebuffer.get_pixel_count(), glm::dvec3 { 0.0, 0.0, 0.0 });
+        finished_framebuffer = displayed_framebuffer = framebuffer;
+
+        back_buffer.resize(framebuffer.get_pixel_count());
+        luminance_squares.resize(framebuffer.get_pixel_count());
+
+        build_tiles();
 
         clear();
     }
 
+    // Spreads the lower 16 bits of x into the even bits, so that two of them can be interleaved.
+    static std::uint32_t part_by_one(std::uint32_t x) {
+        x &= 0x0000ffff;
+        x = (x ^ (x << 8)) & 0x00ff00ff;
+        x = (x ^ (x << 4)) & 0x0f0f0f0f;
+        x = (x ^ (x << 2)) & 0x33333333;
+        x = (x ^ (x << 1)) & 0x55555555;
+        return x;
+    }
+
+    void Raytracer::build_tiles() {
+        tiles.clear();
+
+        for (unsigned y { 0 }; y < framebuffer.get_height(); y += TileSize)
+        for (unsigned x { 0 }; x < framebuffer.get_width();  x += TileSize)
+            tiles.push_back({ x, y });
+
+        std::sort(tiles.begin(), tiles.end(), [](const glm::uvec2& a, const glm::uvec2& b) {
+            return (part_by_one(a.x / TileSize) | (part_by_one(a.y / TileSize) << 1)) <
+                   (part_by_one(b.x / TileSize) | (part_by_one(b.y / TileSize) << 1));
+        });
+
+        update_all_tiles();
+    }
+
+    void Raytracer::set_build_quality(RTCBuildQuality geometry_quality, RTCBuildQuality scene_quality, RTCSceneFlags scene_flags) {
+        geometry_build_quality = geometry_quality;
+        scene_build_quality    = scene_quality;
+        this->scene_flags      = scene_flags;
+    }
+
+    void Raytracer::update_hair_styles(const SceneGraph& scene_graph,
+                                       const std::unordered_map<const HairStyle*, MovedStrands>& moved_strands) {
+        stop_background();
+
+        if (!is_loaded())
+            return; // it'll have the new vertices when it's loaded.
+
+        for (auto& hair_style : hair_styles) {
+            auto moved_style = moved_strands.find(hair_style.get_pointer());
+            bool updated { moved_style != moved_strands.end() ? hair_style.update_vertices(moved_style->second.position_thickness,
+                                                                                            moved_style->second.tangents)
+                                                              : hair_style.update_vertices() };
+            if (!updated)
+                return load(scene_graph);
+        }
+
+        rtcCommitScene(scene); // since the instanced scenes changed.
+
+        volumes.clear(); // voxelized again when they're raymarched.
+        volumes_moved = true;
+
+        now_dirty = true;
+    }
+
+    HairStyle::Volume Raytracer::bake_ambient_occlusion(const HairStyle& hair_style, unsigned resolution, unsigned samples) {
+        stop_background();
+
+        HairStyle::Volume volume {
+            glm::vec3 { resolution },
+            hair_style.get_bounding_box()
+        };
+
+        volume.densities.resize(resolution * resolution * resolution, 255);
+
+        auto style = std::find_if(hair_styles.begin(), hair_styles.end(), [&](const embree::HairStyle& embree_style) {
+            return embree_style.get_pointer() == &hair_style;
+        });
+
+        if (style == hair_styles.end() || samples == 0)
+            return volume; // nothing to occlude it.
+
+        RTCScene style_scene = style->get_scene(); // in model space, like the bounds.
+
+        glm::vec3 voxel_size { volume.bounds.size / volume.resolution };
+
+        JobSystem::get().parallel_for(0, static_cast<int>(resolution), 1, [&](int k) {
+            std::vector<Ray> occlusion_rays;
+
+            RTCIntersectContext      context;
+            rtcInitIntersectContext(&context);
+
+            context.flags = RTC_INTERSECT_CONTEXT_FLAG_INCOHERENT;
+
+            for (unsigned j { 0 }; j < resolution; ++j)
+            for (unsigned i { 0 }; i < resolution; ++i) {
+                unsigned voxel = i + j * resolution + k * resolution * resolution;
+                glm::vec3 voxel_center = volume.bounds.origin + (glm::vec3 { i, j, k } + 0.5f) * voxel_size;
+
+                occlusion_rays.clear();
+
+                for (unsigned s { 0 }; s < samples; ++s) {
+                    auto round = s / (CMJWidth * CMJWidth);
+                    auto voxel_pattern = (voxel * 0x9e3779b9u) ^ (round * 0xc2b2ae35u) ^ seed;
+                    auto uv = cmj(static_cast<int>(s % (CMJWidth * CMJWidth)), CMJWidth, CMJWidth, voxel_pattern);
+
+                    // Uniformly on the sphere, since the voxel could be anywhere inside the hair.
+                    float z = 1.0f - 2.0f * uv.x, r = std::sqrt(std::max(1.0f - z * z, 0.0f));
+                    float phi = glm::two_pi<float>() * uv.y;
+
+                    occlusion_rays.emplace_back(voxel_center, glm::vec3 { r * std::cos(phi), r * std::sin(phi), z }, Ray::Epsilon);
+                    occlusion_rays.back().set_far_plane(ao_radius);
+                }
+
+                Ray::occluded(occlusion_rays, style_scene, context);
+
+                auto unoccluded = std::count_if(occlusion_rays.begin(), occlusion_rays.end(), [](const Ray& ray) {
+                    return !ray.is_occluded();
+                });
+
+                volume.densities[voxel] = static_cast<unsigned char>(255.0f * unoccluded / samples);
+            }
+        }, thread_count);
+
+        return volume;
+    }
+
+    HairStyle::Impostor Raytracer::bake_impostor(const HairStyle& hair_style, unsigned views, unsigned resolution, unsigned samples) {
+        stop_background();
+
+        HairStyle::Impostor impostor;
+
+        impostor.views = views;
+        impostor.occlusion = Image { views * resolution, views * resolution };
+        impostor.tangents  = Image { views * resolution, views * resolution };
+
+        impostor.occlusion.clear({ 0, 0, 0, 0 });
+        impostor.tangents.clear({ 127, 127, 127, 255 });
+
+        auto style = std::find_if(hair_styles.begin(), hair_styles.end(), [&](const embree::HairStyle& embree_style) {
+            return embree_style.get_pointer() == &hair_style;
+        });
+
+        if (style == hair_styles.end() || samples == 0)
+            return impostor; // nothing to see.
+
+        RTCScene style_scene = style->get_scene(); // in model space, like the bounds.
+
+        auto bounds = hair_style.get_bounding_box();
+        glm::vec3 center = bounds.origin + bounds.size / 2.0f;
+        float radius = glm::length(bounds.size) / 2.0f;
+
+        int texels = static_cast<int>(views * resolution);
+
+        JobSystem::get().parallel_for(0, texels, 1, [&](int y) {
+            std::vector<Ray> rays, occlusion_rays;
+
+            RTCIntersectContext      context;
+            rtcInitIntersectContext(&context);
+
+            unsigned view_y = y / resolution;
+
+            for (int x = 0; x < texels; ++x) {
+                unsigned view_x = x / resolution;
+
+                auto direction = HairStyle::Impostor::get_view_direction(view_x, view_y, views);
+                glm::vec3 right, up;
+                HairStyle::Impostor::get_view_axes(direction, right, up);
+
+                unsigned texel = x + y * texels;
+
+                rays.clear();
+
+                for (unsigned s { 0 }; s < samples; ++s) {
+                    auto round = s / (CMJWidth * CMJWidth);
+                    auto texel_pattern = (texel * 0x9e3779b9u) ^ (round * 0xc2b2ae35u) ^ seed;
+                    auto uv = cmj(static_cast<int>(s % (CMJWidth * CMJWidth)), CMJWidth, CMJWidth, texel_pattern);
+
+                    // From the image plane in front of the sphere, across the texel, into the style.
+                    glm::vec2 plane { (glm::vec2 { x % resolution, y % resolution } + uv) / static_cast<float>(resolution) * 2.0f - 1.0f };
+                    glm::vec3 origin = center + (direction + plane.x * right + plane.y * up) * radius;
+
+                    rays.emplace_back(origin, -direction, 0.0f);
+                    rays.back().set_far_plane(2.0f * radius);
+                }
+
+                context.flags = RTC_INTERSECT_CONTEXT_FLAG_COHERENT;
+                Ray::intersect(rays, style_scene, context);
+
+                occlusion_rays.clear();
+
+                glm::vec3 tangent { 0.0f };
+                float depth { 0.0f };
+
+                for (auto& ray : rays) {
+                    if (!ray.hit_surface())
+                        continue;
+
+                    // Lines don't have a direction, so they're all flipped towards the same side.
+                    glm::vec3 hit_tangent = style->get_model_tangent(ray);
+                    tangent += glm::dot(hit_tangent, up) < 0.0f ? -hit_tangent : hit_tangent;
+                    depth += ray.get_ray().tfar / (2.0f * radius);
+
+                    // Same rays as in bake_ambient_occlusion, but only the one.
+                    auto hit = occlusion_rays.size();
+                    auto ao_uv = cmj(static_cast<int>(hit % (CMJWidth * CMJWidth)), CMJWidth, CMJWidth, texel * 0x85ebca6bu ^ seed);
+                    float z = 1.0f - 2.0f * ao_uv.x, r = std::sqrt(std::max(1.0f - z * z, 0.0f));
+                    float phi = glm::two_pi<float>() * ao_uv.y;
+
+                    occlusion_rays.emplace_back(ray.get_intersection_point(), glm::vec3 { r * std::cos(phi), r * std::sin(phi), z }, Ray::Epsilon);
+                    occlusion_rays.back().set_far_plane(ao_radius);
+                }
+
+                if (occlusion_rays.empty())
+                    continue; // stays transparent.
+
+                context.flags = RTC_INTERSECT_CONTEXT_FLAG_INCOHERENT;
+                Ray::occluded(occlusion_rays, style_scene, context);
+
+                auto unoccluded = std::count_if(occlusion_rays.begin(), occlusion_rays.end(), [](const Ray& ray) {
+                    return !ray.is_occluded();
+                });
+
+                auto hits = static_cast<float>(occlusion_rays.size());
+
+                auto occlusion = static_cast<unsigned char>(255.0f * unoccluded / hits);
+                auto coverage  = static_cast<unsigned char>(255.0f * hits / samples);
+
+                tangent = glm::length(tangent) > 0.0f ? glm::normalize(tangent) : up;
+
+                impostor.occlusion.set_pixel(x, y, { occlusion, occlusion, occlusion, coverage });
+                impostor.tangents.set_pixel(x, y, { static_cast<unsigned char>(glm::round((tangent.x * 0.5f + 0.5f) * 255.0f)),
+                                                    static_cast<unsigned char>(glm::round((tangent.y * 0.5f + 0.5f) * 255.0f)),
+                                                    static_cast<unsigned char>(glm::round((tangent.z * 0.5f + 0.5f) * 255.0f)),
+                                                    static_cast<unsigned char>(glm::round(depth / hits * 255.0f)) });
+            }
+        }, thread_count);
+
+        return impostor;
+    }
+
+    void Raytracer::set_seed(std::uint32_t seed) {
+        this->seed = seed;
+    }
+
+    void Raytracer::set_tile_range(std::size_t first_tile, std::size_t tile_count) {
+        this->first_tile = first_tile;
+        this->tile_count = tile_count;
+    }
+
+    void Raytracer::set_sample_offset(std::size_t first_sample) {
+        sample_offset = first_sample;
+    }
+
+    // The header is the magic, the framebuffer size and the number of draws, and then
+    // the back buffer and luminance squares are as they are in memory, pixel by pixel.
+    static constexpr char AccumulationMagic[4] { 'V', 'K', 'H', 'A' };
+
+    bool Raytracer::save_accumulation(const std::string& file_path) const {
+        std::ofstream file { file_path, std::ios::binary };
+        if (!file) return false;
+
+        std::uint32_t header[3] {
+            framebuffer.get_width(),
+            framebuffer.get_height(),
+            static_cast<std::uint32_t>(samples)
+        };
+
+        file.write(AccumulationMagic, sizeof(AccumulationMagic));
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(back_buffer.data()), back_buffer.size() * sizeof(back_buffer[0]));
+        file.write(reinterpret_cast<const char*>(luminance_squares.data()), luminance_squares.size() * sizeof(luminance_squares[0]));
+
+        return static_cast<bool>(file);
+    }
+
+    bool Raytracer::merge_accumulation(const std::string& file_path) {
+        std::ifstream file { file_path, std::ios::binary };
+        if (!file) return false;
+
+        char magic[4];
+        std::uint32_t header[3];
+
+        file.read(magic, sizeof(magic));
+        file.read(reinterpret_cast<char*>(header), sizeof(header));
+
+        if (!file || !std::equal(magic, magic + 4, AccumulationMagic) ||
+            header[0] != framebuffer.get_width() || header[1] != framebuffer.get_height())
+            return false; // not the same render.
+
+        std::vector<glm::vec4> accumulated_samples(back_buffer.size());
+        std::vector<float> accumulated_squares(luminance_squares.size());
+
+        file.read(reinterpret_cast<char*>(accumulated_samples.data()), accumulated_samples.size() * sizeof(accumulated_samples[0]));
+        file.read(reinterpret_cast<char*>(accumulated_squares.data()), accumulated_squares.size() * sizeof(accumulated_squares[0]));
+
+        if (!file) return false;
+
+        for (std::size_t pixel { 0 }; pixel < back_buffer.size(); ++pixel) {
+            back_buffer[pixel]       += accumulated_samples[pixel];
+            luminance_squares[pixel] += accumulated_squares[pixel];
+        }
+
+        samples = std::max<std::size_t>(samples, header[2]);
+        resolve_needed = true;
+        update_all_tiles();
+
+        return true;
+    }
+
+    void Raytracer::set_noise_threshold(float noise_threshold) {
+        this->noise_threshold = noise_threshold;
+        converged_pixels = 0; // until the next draw.
+    }
+
+    bool Raytracer::converged() const {
+        return noise_threshold > 0.0f && pixels_in_range != 0 && converged_pixels == pixels_in_range;
+    }
+
+    bool Raytracer::pixel_converged(unsigned pixel) const {
+        auto sample_count = back_buffer[pixel].a;
+
+        if (noise_threshold <= 0.0f || sample_count < MinimumSamples)
+            return false;
+
+        float mean = glm::dot(glm::vec3 { back_buffer[pixel] }, glm::vec3 { 0.2126f, 0.7152f, 0.0722f }) / sample_count;
+        float variance = std::max(luminance_squares[pixel] / sample_count - mean * mean, 0.0f);
+
+        return std::sqrt(variance / sample_count) < noise_threshold;
+    }
+
+    std::size_t Raytracer::draw_until_converged(const SceneGraph& scene_graph, float noise_threshold,
+                                                std::size_t max_draws, float max_seconds) {
+        auto previous_threshold = this->noise_threshold;
+        set_noise_threshold(noise_threshold);
+
+        auto start_time = std::chrono::steady_clock::now();
+
+        std::size_t draws { 0 };
+        while (draws < max_draws) {
+            draw(scene_graph);
+            ++draws;
+            if (converged())
+                break;
+
+            std::chrono::duration<float> elapsed_time { std::chrono::steady_clock::now() - start_time };
+            if (max_seconds > 0.0f && elapsed_time.count() >= max_seconds)
+                break;
+        }
+
+        set_noise_threshold(previous_threshold);
+
+        return draws;
+    }
+
     void Raytracer::toggle_shadows() {
         shadows_on = !shadows_on;
     }
@@ -225,20 +1158,21 @@ namespace vkhr {
         _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
     }
 
-    std::uint32_t Raytracer::xorshift() {
-        std::uint32_t x = seed;
-        x ^= x << 13;
-        x ^= x >> 7;
-        x ^= x << 17;
-        seed = x;
-        return x;
+    unsigned Raytracer::pixel_samples(unsigned pixel) const {
+        return static_cast<unsigned>(back_buffer[pixel].a + sample_offset);
+    }
+
+    std::uint32_t Raytracer::pattern(unsigned pixel, unsigned dimension) const {
+        auto round = pixel_samples(pixel) / (CMJWidth * CMJWidth);
+        return (pixel * 0x9e3779b9u) ^ (dimension * 0x85ebca6bu) ^ (round * 0xc2b2ae35u) ^ seed;
+    }
+
+    glm::vec2 Raytracer::sample(unsigned pixel, unsigned dimension) {
+        return cmj(static_cast<int>(pixel_samples(pixel) % (CMJWidth * CMJWidth)), CMJWidth, CMJWidth, pattern(pixel, dimension));
     }
 
-    float Raytracer::sample(float min, float max) {
-        float random_number = xorshift();
-        float range = max - min;
-        float normalization = std::numeric_limits<std::uint32_t>::max();
-        return (random_number / normalization) * range + min;
+    float Raytracer::sample_float(unsigned pixel, unsigned dimension) {
+        return rand_float(pixel_samples(pixel), pattern(pixel, dimension));
     }
 
     // From: "Correlated Multi-Jitter Sampling" by Pixar:
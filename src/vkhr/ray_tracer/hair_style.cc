@@ -2,6 +2,8 @@
 
 #include <vkhr/ray_tracer.hh>
 
+#include <algorithm>
+
 namespace vkhr {
     namespace embree {
         HairStyle::HairStyle(const vkhr::HairStyle& hair_style,
@@ -11,46 +13,80 @@ namespace vkhr {
 
         void HairStyle::load(const vkhr::HairStyle& hair_style,
                              const vkhr::Raytracer& raytracer) {
-            const auto& indices = hair_style.get_indices();
+            auto tangents = hair_style.get_tangent_span();
+            auto indices  = hair_style.get_index_span();
+
+            // Shared from the style when it has them in this layout, otherwise we pack our own copy.
+            // A mapped one is aligned too, since the fields are saved at aligned offsets in the file.
+            auto vertices = hair_style.get_position_thickness_span();
+            if (vertices.empty()) {
+                position_thickness = hair_style.create_position_thickness_data();
+                vertices = position_thickness;
+            } else position_thickness.clear();
 
-            position_thickness = hair_style.create_position_thickness_data();
+            moved_tangents.clear();
+            vertex_count = vertices.size();
 
             auto hair_geometry = rtcNewGeometry(raytracer.device, RTC_GEOMETRY_TYPE_FLAT_LINEAR_CURVE);
 
+            rtcSetGeometryBuildQuality(hair_geometry, raytracer.geometry_build_quality);
+
             rtcSetSharedGeometryBuffer(hair_geometry, RTC_BUFFER_TYPE_VERTEX, 0, RTC_FORMAT_FLOAT4,
-                                       position_thickness.data(),
-                                       0, sizeof(position_thickness[0]),
-                                       position_thickness.size());
+                                       vertices.data(),
+                                       0, sizeof(vertices[0]),
+                                       vertices.size());
 
             rtcSetGeometryVertexAttributeCount(hair_geometry, 1);
 
             rtcSetSharedGeometryBuffer(hair_geometry, RTC_BUFFER_TYPE_VERTEX_ATTRIBUTE, 0, RTC_FORMAT_FLOAT3,
-                                       hair_style.tangents.data(),
-                                       0, sizeof(hair_style.tangents[0]),
-                                       hair_style.tangents.size());
+                                       tangents.data(),
+                                       0, sizeof(tangents[0]),
+                                       tangents.size());
 
             rtcSetSharedGeometryBuffer(hair_geometry, RTC_BUFFER_TYPE_INDEX, 0, RTC_FORMAT_UINT,
                                        indices.data(),
                                        0, sizeof(indices[0]) * 2,
                                        indices.size() / 2);
 
-            scene = raytracer.scene;
+            scene = rtcNewScene(raytracer.device);
+            rtcSetSceneBuildQuality(scene, raytracer.scene_build_quality);
+            rtcSetSceneFlags(scene, raytracer.scene_flags);
+            instances = raytracer.scene;
             pointer = &hair_style;
 
             hair_diffuse  = hair_style.get_default_color();
             hair_exponent = 50.0f;
+            hair_alpha    = hair_style.get_default_transparency();
 
             rtcCommitGeometry(hair_geometry);
-            geometry = rtcAttachGeometry(raytracer.scene, hair_geometry);
+            geometry = rtcAttachGeometry(scene, hair_geometry);
             rtcReleaseGeometry(hair_geometry);
+
+            rtcCommitScene(scene);
         }
 
         glm::vec3 HairStyle::shade(const Ray& surface_intersection,
                                    const LightSource& light_source,
                                    const Camera& projection_camera) {
-            auto surface_position = surface_intersection.get_intersection_point();
+            return shade(surface_intersection.get_intersection_point(),
+                         glm::vec3 { get_tangent(surface_intersection) },
+                         light_source, projection_camera);
+        }
 
-            auto strand_direction = get_tangent(surface_intersection);
+        glm::vec3 HairStyle::shade(const Ray& surface_intersection,
+                                   const LightSource& light_source,
+                                   const Camera& projection_camera,
+                                   const ScatteringLut& scattering_lut) const {
+            return shade(surface_intersection.get_intersection_point(),
+                         glm::vec3 { get_tangent(surface_intersection) },
+                         light_source, projection_camera,
+                         scattering_lut);
+        }
+
+        glm::vec3 HairStyle::shade(const glm::vec3& surface_position,
+                                   const glm::vec3& strand_direction,
+                                   const LightSource& light_source,
+                                   const Camera& projection_camera) {
             auto light_normal = glm::normalize(light_source.get_spotlight_origin() - surface_position);
             auto eye_normal = glm::normalize(surface_position - projection_camera.get_position());
 
@@ -62,23 +98,104 @@ namespace vkhr {
             return shading;
         }
 
+        glm::vec3 HairStyle::shade(const glm::vec3& surface_position,
+                                   const glm::vec3& strand_direction,
+                                   const LightSource& light_source,
+                                   const Camera& projection_camera,
+                                   const ScatteringLut& scattering_lut) const {
+            auto light_normal = glm::normalize(light_source.get_spotlight_origin() - surface_position);
+            auto eye_normal = glm::normalize(surface_position - projection_camera.get_position());
+
+            return scattering_lut.marschner(hair_diffuse,
+                                            light_source.get_intensity(),
+                                            strand_direction,
+                                            light_normal, eye_normal);
+        }
+
         glm::vec4 HairStyle::get_tangent(const Ray& position) const {
-            glm::vec4 tangent;
+            glm::vec4 tangent { get_model_tangent(position), 0.0f };
+
+            // The tangent is in model space, so it's transformed by the node that was hit.
+            glm::mat4 model;
+            rtcGetGeometryTransform(rtcGetGeometry(instances, position.get_instance_id()), 0.0f,
+                                    RTC_FORMAT_FLOAT4X4_COLUMN_MAJOR, &model[0][0]);
+            return glm::normalize(model * tangent);
+        }
+
+        bool HairStyle::update_vertices() {
+            if (pointer->get_vertex_count() != vertex_count)
+                return false;
+
+            // Shared with the style again if it has them in this layout (e.g. after a simulation).
+            auto vertices = pointer->get_position_thickness_span();
+            if (vertices.empty()) {
+                position_thickness = pointer->create_position_thickness_data();
+                vertices = position_thickness;
+            } else position_thickness.clear();
+
+            moved_tangents.clear();
+
+            update_buffers(vertices, pointer->get_tangent_span()); // might have been re-allocated.
+
+            return true;
+        }
+
+        bool HairStyle::update_vertices(const std::vector<glm::vec4>& moved_vertices,
+                                        const std::vector<glm::vec3>& moved_tangents) {
+            if (moved_vertices.size() != vertex_count || moved_tangents.size() != vertex_count)
+                return false;
+
+            // Only re-allocated the first time, after that they're the same size and stay put.
+            position_thickness = moved_vertices;
+            this->moved_tangents = moved_tangents;
+
+            update_buffers(position_thickness, this->moved_tangents);
+
+            return true;
+        }
+
+        void HairStyle::update_buffers(Span<glm::vec4> vertices, Span<glm::vec3> tangents) {
+            auto hair_geometry = rtcGetGeometry(scene, geometry);
+
+            rtcSetSharedGeometryBuffer(hair_geometry, RTC_BUFFER_TYPE_VERTEX, 0, RTC_FORMAT_FLOAT4,
+                                       vertices.data(),
+                                       0, sizeof(vertices[0]),
+                                       vertices.size());
+            rtcUpdateGeometryBuffer(hair_geometry, RTC_BUFFER_TYPE_VERTEX, 0);
+
+            rtcSetSharedGeometryBuffer(hair_geometry, RTC_BUFFER_TYPE_VERTEX_ATTRIBUTE, 0, RTC_FORMAT_FLOAT3,
+                                       tangents.data(),
+                                       0, sizeof(tangents[0]),
+                                       tangents.size());
+            rtcUpdateGeometryBuffer(hair_geometry, RTC_BUFFER_TYPE_VERTEX_ATTRIBUTE, 0);
+
+            rtcCommitGeometry(hair_geometry);
+            rtcCommitScene(scene); // refits it, if it was built with RTC_BUILD_QUALITY_REFIT.
+        }
+
+        glm::vec3 HairStyle::get_model_tangent(const Ray& position) const {
+            glm::vec3 tangent;
             auto uv = position.get_uv();
             rtcInterpolate0(rtcGetGeometry(scene, geometry),
                             position.get_primitive_id(),
                             uv.x, uv.y,
                             RTC_BUFFER_TYPE_VERTEX_ATTRIBUTE,
                             0, &tangent.x, 3);
-            tangent.w = 0;
-            return tangent;
-
+            return glm::normalize(tangent);
         }
 
         unsigned HairStyle::get_geometry() const {
             return geometry;
         }
 
+        RTCScene HairStyle::get_scene() const {
+            return scene;
+        }
+
+        float HairStyle::get_hair_alpha() const {
+            return hair_alpha;
+        }
+
         const vkhr::HairStyle* HairStyle::get_pointer() const {
             return pointer;
         }
@@ -110,6 +227,7 @@ namespace vkhr {
         void HairStyle::update_parameters(const vkhr::vulkan::HairStyle& hair_style) {
             hair_diffuse  = hair_style.parameters.hair_color;
             hair_exponent = hair_style.parameters.hair_shininess;
+            hair_alpha    = hair_style.parameters.hair_opacity;
         }
     }
 }
\ No newline at end of file
@@ -11,7 +11,25 @@ namespace vkhr {
         void Model::load(const vkhr::Model& model, const vkhr::Raytracer& raytracer) {
             auto model_geometry = rtcNewGeometry(raytracer.device, RTC_GEOMETRY_TYPE_TRIANGLE);
 
-            // Upload geometry here.
+            // The positions are shared straight from the model (the mapped cache, usually), with the
+            // rest of the vertex after them, so that there's always the padding Embree reads past it.
+            auto vertices = model.get_vertex_span();
+            rtcSetSharedGeometryBuffer(model_geometry, RTC_BUFFER_TYPE_VERTEX, 0, RTC_FORMAT_FLOAT3,
+                                       vertices.data(),
+                                       0, sizeof(vertices[0]),
+                                       vertices.size());
+
+            // Embree only has 32-bit indices, so the 16-bit ones get widened.
+            Span<std::uint32_t> indices = model.get_element_span();
+            if (auto short_elements = model.get_short_element_span(); !short_elements.empty()) {
+                elements.assign(short_elements.begin(), short_elements.end());
+                indices = elements;
+            }
+
+            rtcSetSharedGeometryBuffer(model_geometry, RTC_BUFFER_TYPE_INDEX, 0, RTC_FORMAT_UINT3,
+                                       indices.data(),
+                                       0, sizeof(indices[0]) * 3,
+                                       indices.size() / 3);
 
             scene = raytracer.scene;
 
@@ -3,6 +3,7 @@
 namespace vkhr {
     Ray::Ray(const glm::vec3& origin, const glm::vec3& direction, float tnear_plane) {
         ray_hit.hit.geomID = RTC_INVALID_GEOMETRY_ID;
+        ray_hit.hit.instID[0] = RTC_INVALID_GEOMETRY_ID;
 
         ray_hit.ray.org_x = origin.x;
         ray_hit.ray.org_y = origin.y;
@@ -16,6 +17,10 @@ namespace vkhr {
         ray_hit.ray.tfar  = std::numeric_limits<float>::infinity();
     }
 
+    void Ray::set_far_plane(float tfar_plane) {
+        ray_hit.ray.tfar = tfar_plane;
+    }
+
     RTCRay& Ray::get_ray() {
         return ray_hit.ray;
     }
@@ -78,6 +83,10 @@ namespace vkhr {
         return ray_hit.hit.geomID;
     }
 
+    unsigned Ray::get_instance_id() const {
+        return ray_hit.hit.instID[0];
+    }
+
     bool Ray::hit_geometry(unsigned  id) const {
         return ray_hit.hit.geomID == id;
     }
@@ -109,4 +118,17 @@ namespace vkhr {
             return false;
         }
     }
-}
\ No newline at end of file
+
+    // Since the ray_hit is all there is to a Ray, they can be passed as an array of RTCRayHits.
+    static_assert(sizeof(Ray) == sizeof(RTCRayHit), "Ray should only wrap a RTCRayHit!");
+
+    void Ray::intersect(std::vector<Ray>& rays, RTCScene& scene, RTCIntersectContext& context) {
+        if (rays.empty()) return;
+        rtcIntersect1M(scene, &context, &rays[0].ray_hit, static_cast<unsigned>(rays.size()), sizeof(Ray));
+    }
+
+    void Ray::occluded(std::vector<Ray>& rays, RTCScene& scene, RTCIntersectContext& context) {
+        if (rays.empty()) return;
+        rtcOccluded1M(scene, &context, &rays[0].ray_hit.ray, static_cast<unsigned>(rays.size()), sizeof(Ray));
+    }
+}
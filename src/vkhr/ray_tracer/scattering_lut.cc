@@ -0,0 +1,189 @@
+#include <vkhr/ray_tracer/scattering_lut.hh>
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace vkhr {
+    namespace embree {
+        static float gaussian(float width, float x) {
+            return std::exp(-x*x / (2.0f * width*width)) / (width * std::sqrt(2.0f * glm::pi<float>()));
+        }
+
+        static float wrapped_gaussian(float width, float x) {
+            x -= glm::two_pi<float>() * std::round(x / glm::two_pi<float>());
+            return gaussian(width, x - glm::two_pi<float>()) +
+                   gaussian(width, x) +
+                   gaussian(width, x + glm::two_pi<float>());
+        }
+
+        static float fresnel(float eta, float cos_gamma) {
+            float sin_t_squared = (1.0f - cos_gamma*cos_gamma) / (eta*eta);
+            if (sin_t_squared >= 1.0f) return 1.0f;
+            float cos_t = std::sqrt(1.0f - sin_t_squared);
+            float r_s = (cos_gamma - eta * cos_t) / (cos_gamma + eta * cos_t);
+            float r_p = (eta * cos_gamma - cos_t) / (eta * cos_gamma + cos_t);
+            return 0.5f * (r_s*r_s + r_p*r_p);
+        }
+
+        ScatteringLut::ScatteringLut(const Fiber& fiber) {
+            bake(fiber);
+        }
+
+        void ScatteringLut::bake(const Fiber& fiber) {
+            constexpr auto resolution = vulkan::ScatteringLut::Resolution;
+            texels.assign(resolution * resolution * vulkan::ScatteringLut::Layers, glm::vec4 { 0.0f });
+
+            auto alpha = fiber.longitudinal_shift;
+            auto beta  = fiber.longitudinal_width;
+            auto eta   = fiber.refraction_index;
+
+            for (std::uint32_t y { 0 }; y < resolution; ++y)
+            for (std::uint32_t x { 0 }; x < resolution; ++x) {
+                glm::vec2 uv { (x + 0.5f) / resolution, (y + 0.5f) / resolution };
+                auto texel = y * resolution + x;
+
+                auto theta_i = std::asin(uv.x * 2.0f - 1.0f);
+                auto theta_r = std::asin(uv.y * 2.0f - 1.0f);
+                auto theta_h = 0.5f * (theta_i + theta_r);
+                auto theta_d = 0.5f * (theta_r - theta_i);
+
+                glm::vec3 m {
+                    gaussian(beta,        theta_h - alpha),
+                    gaussian(beta / 2.0f, theta_h + alpha / 2.0f),
+                    gaussian(beta * 2.0f, theta_h + alpha * 3.0f / 2.0f)
+                };
+
+                texels[vulkan::ScatteringLut::Longitudinal * resolution * resolution + texel] = glm::vec4 { m * std::cos(theta_i), std::cos(theta_d) };
+
+                auto phi = uv.x * glm::pi<float>();
+                auto cos_theta_d = uv.y;
+                auto sin_theta_d = std::sqrt(std::max(1.0f - cos_theta_d*cos_theta_d, 0.0f));
+
+                auto eta_prime = std::sqrt(std::max(eta*eta - sin_theta_d*sin_theta_d, 0.0f)) / std::max(cos_theta_d, 1e-4f);
+                auto sin_theta_t = sin_theta_d / eta;
+                auto cos_theta_t = std::sqrt(std::max(1.0f - sin_theta_t*sin_theta_t, 0.0f));
+
+                glm::vec3 lobes { 0.0f };
+                glm::vec2 lobe_paths { 0.0f };
+
+                for (int i { 0 }; i < FiberSamples; ++i) {
+                    auto h = -1.0f + (i + 0.5f) * 2.0f / FiberSamples;
+
+                    auto gamma_i = std::asin(h);
+                    auto gamma_t = std::asin(h / eta_prime);
+
+                    auto f = fresnel(eta_prime, std::cos(gamma_i));
+                    auto path = std::cos(gamma_t) / cos_theta_t;
+
+                    glm::vec3 attenuation { f, (1.0f - f) * (1.0f - f), (1.0f - f) * (1.0f - f) * f };
+
+                    glm::vec3 distribution;
+                    for (int p { 0 }; p < 3; ++p) {
+                        auto exit_phi = 2.0f * p * gamma_t - 2.0f * gamma_i + p * glm::pi<float>();
+                        distribution[p] = wrapped_gaussian(fiber.azimuthal_width, phi - exit_phi);
+                    }
+
+                    auto scattering = attenuation * distribution;
+
+                    lobes += scattering;
+                    lobe_paths += glm::vec2 { scattering.y, scattering.z } * glm::vec2 { path / 2.0f, path };
+                }
+
+                lobes *= 1.0f / FiberSamples;
+
+                auto paths = lobe_paths / glm::max(glm::vec2 { lobes.y, lobes.z } * static_cast<float>(FiberSamples), glm::vec2 { 1e-8f });
+
+                texels[vulkan::ScatteringLut::Azimuthal  * resolution * resolution + texel] = glm::vec4 { lobes / std::max(cos_theta_d*cos_theta_d, 1e-2f), 1.0f };
+                texels[vulkan::ScatteringLut::Absorption * resolution * resolution + texel] = glm::vec4 { paths, 0.0f, 1.0f };
+            }
+
+            // Same as the reduction by the workgroups of scattering_lut.comp, from the N of the row.
+            for (std::uint32_t y { 0 }; y < resolution; ++y) {
+                auto cos_theta_d = (y + 0.5f) / resolution;
+
+                glm::vec3 forward { 0.0f }, backward { 0.0f };
+                glm::vec2 mean_paths { 0.0f }, path_lobes { 0.0f };
+
+                for (std::uint32_t x { 0 }; x < resolution; ++x) {
+                    auto texel = y * resolution + x;
+
+                    glm::vec3 lobes { texels[vulkan::ScatteringLut::Azimuthal * resolution * resolution + texel] };
+                    lobes *= std::max(cos_theta_d*cos_theta_d, 1e-2f);
+                    glm::vec2 paths { texels[vulkan::ScatteringLut::Absorption * resolution * resolution + texel] };
+
+                    if (x < resolution / 2) backward += lobes;
+                    else                    forward  += lobes;
+
+                    mean_paths += paths * glm::vec2 { lobes.y, lobes.z };
+                    path_lobes += glm::vec2 { lobes.y, lobes.z };
+                }
+
+                forward  *= 2.0f * glm::pi<float>() / resolution;
+                backward *= 2.0f * glm::pi<float>() / resolution;
+                mean_paths /= glm::max(path_lobes, glm::vec2 { 1e-8f });
+
+                for (std::uint32_t x { 0 }; x < resolution; ++x) {
+                    auto texel = y * resolution + x;
+                    texels[vulkan::ScatteringLut::Forward  * resolution * resolution + texel] = glm::vec4 { forward,  mean_paths.x };
+                    texels[vulkan::ScatteringLut::Backward * resolution * resolution + texel] = glm::vec4 { backward, mean_paths.y };
+                }
+            }
+
+            baked_fiber = fiber;
+        }
+
+        glm::vec3 ScatteringLut::marschner(const glm::vec3& color,
+                                           const glm::vec3& intensity,
+                                           const glm::vec3& tangent,
+                                           const glm::vec3& light,
+                                           const glm::vec3& eye) const {
+            auto sin_theta_i = glm::dot(tangent,  light);
+            auto sin_theta_r = glm::dot(tangent, -eye);
+
+            auto light_perpendicular =  light - tangent * sin_theta_i;
+            auto eye_perpendicular   = -eye   - tangent * sin_theta_r;
+
+            auto cos_phi = glm::dot(light_perpendicular, eye_perpendicular) /
+                           std::sqrt(glm::dot(light_perpendicular, light_perpendicular) *
+                                     glm::dot(eye_perpendicular, eye_perpendicular) + 1e-4f);
+
+            auto phi = std::acos(glm::clamp(cos_phi, -1.0f, 1.0f));
+
+            auto m = lookup(vulkan::ScatteringLut::Longitudinal, { sin_theta_i * 0.5f + 0.5f, sin_theta_r * 0.5f + 0.5f });
+            auto n = lookup(vulkan::ScatteringLut::Azimuthal,    { phi / glm::pi<float>(), m.a });
+            auto paths = lookup(vulkan::ScatteringLut::Absorption, { phi / glm::pi<float>(), m.a });
+
+            auto absorption = glm::max(color, glm::vec3 { 1e-3f });
+
+            auto scattering = m.r * n.r +
+                              m.g * n.g * glm::pow(absorption, glm::vec3 { paths.x }) +
+                              m.b * n.b * glm::pow(absorption, glm::vec3 { paths.y });
+
+            return intensity * scattering;
+        }
+
+        bool ScatteringLut::needs_baking(const Fiber& fiber) const {
+            return texels.empty() || fiber != baked_fiber;
+        }
+
+        // Between the texel centers, and clamped to the edge ones, which is how it's sampled on the GPU.
+        glm::vec4 ScatteringLut::lookup(vulkan::ScatteringLut::Layer layer, glm::vec2 uv) const {
+            constexpr auto resolution = vulkan::ScatteringLut::Resolution;
+
+            auto texel = glm::clamp(uv * static_cast<float>(resolution) - 0.5f, glm::vec2 { 0.0f }, glm::vec2 { resolution - 1.0f });
+            auto first = glm::min(glm::uvec2 { texel }, glm::uvec2 { resolution - 2 });
+            auto t = texel - glm::vec2 { first };
+
+            const auto* texels_in_layer = &texels[layer * resolution * resolution];
+
+            auto row = [&](std::uint32_t y) {
+                return glm::mix(texels_in_layer[y * resolution + first.x],
+                                texels_in_layer[y * resolution + first.x + 1], t.x);
+            };
+
+            return glm::mix(row(first.y), row(first.y + 1), t.y);
+        }
+    }
+}
@@ -0,0 +1,403 @@
+#include <vkhr/ray_tracer/volume.hh>
+
+#include <vkhr/job_system.hh>
+
+#include <xmmintrin.h>
+#include <emmintrin.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+
+namespace vkhr {
+    namespace embree {
+        // Same as the one vulkan::HairStyle voxelizes (and caches), so it's the same volume.
+        static constexpr unsigned VolumeResolution { 256 };
+
+        // How many strands a sample of the density is on the way to the light, see shade_volume.glsl.
+        static constexpr float StrandThickness { 11.0f };
+
+        // Where the ray from 'origin' along 'direction' enters and leaves the box, in units of it.
+        static bool intersect_box(const AABB& box, const glm::vec3& origin, const glm::vec3& direction,
+                                  float& t_near, float& t_far) {
+            glm::vec3 inverse_direction { 1.0f / direction }; // infinite along the parallel axes.
+            glm::vec3 t_min { (box.origin - origin) * inverse_direction },
+                      t_max { (box.origin + box.size - origin) * inverse_direction };
+            glm::vec3 t_first { glm::min(t_min, t_max) },
+                      t_last  { glm::max(t_min, t_max) };
+            t_near = std::max(std::max(t_first.x, t_first.y), t_first.z);
+            t_far  = std::min(std::min(t_last.x,  t_last.y),  t_last.z);
+            return t_near <= t_far;
+        }
+
+        Volume::Volume(const vkhr::HairStyle& hair_style, bool use_cache) {
+            load(hair_style, use_cache);
+        }
+
+        void Volume::load(const vkhr::HairStyle& hair_style, bool use_cache) {
+            volume = vkhr::HairStyle::Volume { };
+            volume.resolution = glm::vec3(VolumeResolution);
+            volume.bounds = hair_style.get_bounding_box();
+
+            auto volume_cache_path = hair_style.get_volume_cache_path();
+
+            // Not saved when it's voxelized here, since only the rasterizer's is in the cache.
+            if (!use_cache || !vkhr::HairStyle::cache_is_current(volume_cache_path, hair_style.get_file_path()) ||
+                !volume.load(volume_cache_path) || volume.tangents.empty()) {
+                volume = hair_style.voxelize_segments(VolumeResolution, VolumeResolution, VolumeResolution,
+                                                      vkhr::HairStyle::Volume::Layout::Bricked);
+                volume.normalize();
+            }
+
+            volume.set_layout(vkhr::HairStyle::Volume::Layout::Bricked);
+
+            resolution = glm::ivec3(volume.resolution);
+            bricks = (resolution + static_cast<int>(vkhr::HairStyle::Volume::BrickSize) - 1) / static_cast<int>(vkhr::HairStyle::Volume::BrickSize);
+
+            std::vector<unsigned char> occupied(bricks.x * bricks.y * bricks.z, 0);
+
+            JobSystem::get().parallel_for(0, bricks.z, 1, [&](int z) {
+                constexpr int BrickSize = vkhr::HairStyle::Volume::BrickSize;
+                for (int y { 0 }; y < bricks.y; ++y)
+                for (int x { 0 }; x < bricks.x; ++x) {
+                    glm::ivec3 first { glm::ivec3(x, y, z) * BrickSize },
+                               last  { glm::min(first + BrickSize, resolution) };
+                    unsigned char max_density { 0 };
+                    for (int k { first.z }; k < last.z; ++k)
+                    for (int j { first.y }; j < last.y; ++j)
+                    for (int i { first.x }; i < last.x; ++i)
+                        max_density = std::max(max_density, volume.densities[volume.get_index(glm::uvec3(i, j, k))]);
+                    occupied[x + y*bricks.x + z*bricks.x*bricks.y] = max_density;
+                }
+            });
+
+            occupancy.assign(occupied.size(), 0);
+
+            JobSystem::get().parallel_for(0, bricks.z, 1, [&](int z) {
+                for (int y { 0 }; y < bricks.y; ++y)
+                for (int x { 0 }; x < bricks.x; ++x) {
+                    unsigned char max_density { 0 };
+                    for (int k { std::max(z - 1, 0) }; k <= std::min(z + 1, bricks.z - 1); ++k)
+                    for (int j { std::max(y - 1, 0) }; j <= std::min(y + 1, bricks.y - 1); ++j)
+                    for (int i { std::max(x - 1, 0) }; i <= std::min(x + 1, bricks.x - 1); ++i)
+                        max_density = std::max(max_density, occupied[i + j*bricks.x + k*bricks.x*bricks.y]);
+                    occupancy[x + y*bricks.x + z*bricks.x*bricks.y] = max_density;
+                }
+            });
+        }
+
+        bool Volume::Settings::operator==(const Settings& settings) const {
+            return isosurface == settings.isosurface && raycast_steps == settings.raycast_steps &&
+                   occlusion_radius == settings.occlusion_radius && ao_exponent == settings.ao_exponent &&
+                   ao_max == settings.ao_max;
+        }
+
+        bool Volume::Settings::operator!=(const Settings& settings) const {
+            return !(*this == settings);
+        }
+
+        static __m128 select(__m128 mask, __m128 a, __m128 b) {
+            return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+        }
+
+        static __m128 lerp(__m128 a, __m128 b, __m128 t) {
+            return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+        }
+
+        static __m128 floor_ps(__m128 x) { // without SSE4.1, only correct within the ints.
+            __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+            return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, x), _mm_set1_ps(1.0f)));
+        }
+
+        void Volume::find_surfaces(const std::array<glm::vec3, PacketSize>& origins,
+                                   const std::array<glm::vec3, PacketSize>& directions,
+                                   unsigned count, const Settings& settings, float hair_alpha,
+                                   std::array<Surface, PacketSize>& surfaces) const {
+            alignas(16) float start[3][PacketSize], delta[3][PacketSize];
+            alignas(16) float t_exit[PacketSize];
+            alignas(16) std::int32_t enabled[PacketSize];
+
+            // The rays start where they enter the box (as the rasterized faces of it), and the rest
+            // of their march past where they leave it is skipped, since it's all zero out there.
+            for (unsigned lane { 0 }; lane < PacketSize; ++lane) {
+                float t_near, t_far;
+                enabled[lane] = 0;
+                t_exit[lane] = 0.0f;
+                glm::vec3 ray_start { 0.0f }, ray_delta { 0.0f };
+                if (lane < count && intersect_box(volume.bounds, origins[lane], directions[lane], t_near, t_far) && t_far >= 0.0f) {
+                    float entry = std::max(t_near, 0.0f);
+                    ray_start = origins[lane] + directions[lane] * entry;
+                    ray_delta = directions[lane] * volume.bounds.radius;
+                    t_exit[lane] = std::min((t_far - entry) / volume.bounds.radius, 1.0f);
+                    enabled[lane] = -1;
+                }
+
+                for (int axis { 0 }; axis < 3; ++axis) {
+                    start[axis][lane] = ray_start[axis];
+                    delta[axis][lane] = ray_delta[axis];
+                }
+            }
+
+            float step_size = 1.0f / settings.raycast_steps;
+            float saturated_density = settings.isosurface / std::max(hair_alpha, 1e-6f);
+
+            __m128 start_x = _mm_load_ps(start[0]), start_y = _mm_load_ps(start[1]), start_z = _mm_load_ps(start[2]);
+            __m128 delta_x = _mm_load_ps(delta[0]), delta_y = _mm_load_ps(delta[1]), delta_z = _mm_load_ps(delta[2]);
+            __m128 limit = _mm_load_ps(t_exit);
+
+            __m128 active = _mm_castsi128_ps(_mm_load_si128(reinterpret_cast<const __m128i*>(enabled)));
+
+            __m128 t = _mm_setzero_ps(), accumulated_density = _mm_setzero_ps();
+            __m128 surface_x = _mm_setzero_ps(), surface_y = _mm_setzero_ps(), surface_z = _mm_setzero_ps();
+            __m128 entry_x = _mm_setzero_ps(), entry_y = _mm_setzero_ps(), entry_z = _mm_setzero_ps();
+            __m128 surface_found = _mm_setzero_ps(), entry_found = _mm_setzero_ps();
+
+            __m128 surface_density = _mm_set1_ps(settings.isosurface);
+            __m128 saturated = _mm_set1_ps(saturated_density);
+            __m128 step = _mm_set1_ps(step_size);
+
+            // To voxels, with the sample at the center of them, like the texture filtering is.
+            glm::vec3 voxel_scale { volume.resolution / volume.bounds.size };
+            __m128 origin_x = _mm_set1_ps(volume.bounds.origin.x), scale_x = _mm_set1_ps(voxel_scale.x),
+                   origin_y = _mm_set1_ps(volume.bounds.origin.y), scale_y = _mm_set1_ps(voxel_scale.y),
+                   origin_z = _mm_set1_ps(volume.bounds.origin.z), scale_z = _mm_set1_ps(voxel_scale.z);
+            __m128 resolution_x = _mm_set1_ps(volume.resolution.x),
+                   resolution_y = _mm_set1_ps(volume.resolution.y),
+                   resolution_z = _mm_set1_ps(volume.resolution.z);
+            __m128 zero = _mm_setzero_ps(), half = _mm_set1_ps(0.5f);
+
+            while (int lanes = _mm_movemask_ps(active)) {
+                alignas(16) float ts[PacketSize];
+                alignas(16) std::int32_t sampled[PacketSize];
+                _mm_store_ps(ts, t);
+
+                for (unsigned lane { 0 }; lane < PacketSize; ++lane) {
+                    sampled[lane] = 0;
+                    if (!(lanes & (1 << lane)))
+                        continue;
+                    glm::vec3 ray_start { start[0][lane], start[1][lane], start[2][lane] },
+                              ray_end   { ray_start + glm::vec3 { delta[0][lane], delta[1][lane], delta[2][lane] } };
+                    if (!skip_empty_brick(ray_start, ray_end, ts[lane], step_size))
+                        sampled[lane] = -1;
+                }
+
+                t = _mm_load_ps(ts);
+
+                __m128 point_x = _mm_add_ps(start_x, _mm_mul_ps(delta_x, t)),
+                       point_y = _mm_add_ps(start_y, _mm_mul_ps(delta_y, t)),
+                       point_z = _mm_add_ps(start_z, _mm_mul_ps(delta_z, t));
+
+                __m128 voxel_x = _mm_mul_ps(_mm_sub_ps(point_x, origin_x), scale_x),
+                       voxel_y = _mm_mul_ps(_mm_sub_ps(point_y, origin_y), scale_y),
+                       voxel_z = _mm_mul_ps(_mm_sub_ps(point_z, origin_z), scale_z);
+
+                // Out of the bricks reads as zero, see sample_bricked_volume.
+                __m128 inside = _mm_castsi128_ps(_mm_load_si128(reinterpret_cast<const __m128i*>(sampled)));
+                inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmpge_ps(voxel_x, zero), _mm_cmplt_ps(voxel_x, resolution_x)));
+                inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmpge_ps(voxel_y, zero), _mm_cmplt_ps(voxel_y, resolution_y)));
+                inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmpge_ps(voxel_z, zero), _mm_cmplt_ps(voxel_z, resolution_z)));
+
+                voxel_x = _mm_sub_ps(voxel_x, half);
+                voxel_y = _mm_sub_ps(voxel_y, half);
+                voxel_z = _mm_sub_ps(voxel_z, half);
+
+                __m128 base_x = floor_ps(voxel_x), base_y = floor_ps(voxel_y), base_z = floor_ps(voxel_z);
+
+                alignas(16) std::int32_t corner_x[PacketSize], corner_y[PacketSize], corner_z[PacketSize];
+                _mm_store_si128(reinterpret_cast<__m128i*>(corner_x), _mm_cvttps_epi32(base_x));
+                _mm_store_si128(reinterpret_cast<__m128i*>(corner_y), _mm_cvttps_epi32(base_y));
+                _mm_store_si128(reinterpret_cast<__m128i*>(corner_z), _mm_cvttps_epi32(base_z));
+
+                // Gathered one lane at a time, and then filtered together.
+                alignas(16) float corners[8][PacketSize] { };
+                int inside_lanes = _mm_movemask_ps(inside);
+                for (unsigned lane { 0 }; lane < PacketSize; ++lane) {
+                    if (!(inside_lanes & (1 << lane)))
+                        continue;
+                    for (int corner { 0 }; corner < 8; ++corner) {
+                        corners[corner][lane] = fetch_density(corner_x[lane] + (corner & 1),
+                                                              corner_y[lane] + ((corner >> 1) & 1),
+                                                              corner_z[lane] + ((corner >> 2) & 1));
+                    }
+                }
+
+                __m128 fraction_x = _mm_sub_ps(voxel_x, base_x),
+                       fraction_y = _mm_sub_ps(voxel_y, base_y),
+                       fraction_z = _mm_sub_ps(voxel_z, base_z);
+
+                __m128 density_00 = lerp(_mm_load_ps(corners[0]), _mm_load_ps(corners[1]), fraction_x),
+                       density_10 = lerp(_mm_load_ps(corners[2]), _mm_load_ps(corners[3]), fraction_x),
+                       density_01 = lerp(_mm_load_ps(corners[4]), _mm_load_ps(corners[5]), fraction_x),
+                       density_11 = lerp(_mm_load_ps(corners[6]), _mm_load_ps(corners[7]), fraction_x);
+                __m128 density = lerp(lerp(density_00, density_10, fraction_y),
+                                      lerp(density_01, density_11, fraction_y), fraction_z);
+                density = _mm_and_ps(density, inside);
+
+                accumulated_density = _mm_add_ps(accumulated_density, density);
+
+                __m128 nonzero = _mm_cmpneq_ps(density, zero);
+
+                __m128 before_surface = _mm_and_ps(nonzero, _mm_cmple_ps(accumulated_density, surface_density));
+                surface_x = select(before_surface, point_x, surface_x);
+                surface_y = select(before_surface, point_y, surface_y);
+                surface_z = select(before_surface, point_z, surface_z);
+                surface_found = _mm_or_ps(surface_found, _mm_and_ps(nonzero, _mm_cmpge_ps(accumulated_density, surface_density)));
+
+                __m128 first_entry = _mm_andnot_ps(entry_found, nonzero);
+                entry_x = select(first_entry, point_x, entry_x);
+                entry_y = select(first_entry, point_y, entry_y);
+                entry_z = select(first_entry, point_z, entry_z);
+                entry_found = _mm_or_ps(entry_found, nonzero);
+
+                // Nothing after this changes the surface or its coverage.
+                __m128 saturated_lanes = _mm_and_ps(surface_found, _mm_cmpge_ps(accumulated_density, saturated));
+
+                t = _mm_add_ps(t, step);
+
+                active = _mm_andnot_ps(saturated_lanes, active);
+                active = _mm_and_ps(active, _mm_cmplt_ps(t, limit));
+            }
+
+            __m128 use_entry = _mm_andnot_ps(surface_found, entry_found);
+            surface_x = select(use_entry, entry_x, surface_x);
+            surface_y = select(use_entry, entry_y, surface_y);
+            surface_z = select(use_entry, entry_z, surface_z);
+
+            alignas(16) float result[4][PacketSize];
+            _mm_store_ps(result[0], surface_x);
+            _mm_store_ps(result[1], surface_y);
+            _mm_store_ps(result[2], surface_z);
+            _mm_store_ps(result[3], _mm_div_ps(accumulated_density, surface_density));
+
+            for (unsigned lane { 0 }; lane < std::min(count, PacketSize); ++lane) {
+                surfaces[lane].position = glm::vec3 { result[0][lane], result[1][lane], result[2][lane] };
+                surfaces[lane].density  = result[3][lane];
+            }
+        }
+
+        float Volume::fetch_density(int x, int y, int z) const {
+            if (x < 0 || y < 0 || z < 0 || x >= resolution.x || y >= resolution.y || z >= resolution.z)
+                return 0.0f;
+            return volume.densities[volume.get_index(glm::uvec3(x, y, z))] / 255.0f;
+        }
+
+        glm::vec2 Volume::fetch_tangent(int x, int y, int z) const {
+            if (x < 0 || y < 0 || z < 0 || x >= resolution.x || y >= resolution.y || z >= resolution.z)
+                return glm::vec2 { 0.0f };
+            return glm::max(glm::vec2 { volume.tangents[volume.get_index(glm::uvec3(x, y, z))] } / 127.0f, -1.0f);
+        }
+
+        float Volume::sample_density(const glm::vec3& position) const {
+            glm::vec3 voxel { (position - volume.bounds.origin) / volume.bounds.size * volume.resolution };
+            if (glm::any(glm::lessThan(voxel, glm::vec3 { 0.0f })) || glm::any(glm::greaterThanEqual(voxel, volume.resolution)))
+                return 0.0f;
+
+            voxel -= 0.5f;
+
+            glm::vec3 base { glm::floor(voxel) }, fraction { voxel - base };
+            glm::ivec3 corner { base };
+
+            float density_00 = glm::mix(fetch_density(corner.x, corner.y,     corner.z),     fetch_density(corner.x + 1, corner.y,     corner.z),     fraction.x),
+                  density_10 = glm::mix(fetch_density(corner.x, corner.y + 1, corner.z),     fetch_density(corner.x + 1, corner.y + 1, corner.z),     fraction.x),
+                  density_01 = glm::mix(fetch_density(corner.x, corner.y,     corner.z + 1), fetch_density(corner.x + 1, corner.y,     corner.z + 1), fraction.x),
+                  density_11 = glm::mix(fetch_density(corner.x, corner.y + 1, corner.z + 1), fetch_density(corner.x + 1, corner.y + 1, corner.z + 1), fraction.x);
+
+            return glm::mix(glm::mix(density_00, density_10, fraction.y),
+                            glm::mix(density_01, density_11, fraction.y), fraction.z);
+        }
+
+        glm::vec3 Volume::sample_tangent(const glm::vec3& position) const {
+            glm::vec3 voxel { (position - volume.bounds.origin) / volume.bounds.size * volume.resolution };
+            if (volume.tangents.empty() || glm::any(glm::lessThan(voxel, glm::vec3 { 0.0f })) ||
+                glm::any(glm::greaterThanEqual(voxel, volume.resolution)))
+                return glm::vec3 { 0.0f };
+
+            voxel -= 0.5f;
+
+            glm::vec3 base { glm::floor(voxel) }, fraction { voxel - base };
+            glm::ivec3 corner { base };
+
+            // Filtered before it's decoded, like the SNORM texture is.
+            glm::vec2 tangent_00 = glm::mix(fetch_tangent(corner.x, corner.y,     corner.z),     fetch_tangent(corner.x + 1, corner.y,     corner.z),     fraction.x),
+                      tangent_10 = glm::mix(fetch_tangent(corner.x, corner.y + 1, corner.z),     fetch_tangent(corner.x + 1, corner.y + 1, corner.z),     fraction.x),
+                      tangent_01 = glm::mix(fetch_tangent(corner.x, corner.y,     corner.z + 1), fetch_tangent(corner.x + 1, corner.y,     corner.z + 1), fraction.x),
+                      tangent_11 = glm::mix(fetch_tangent(corner.x, corner.y + 1, corner.z + 1), fetch_tangent(corner.x + 1, corner.y + 1, corner.z + 1), fraction.x);
+
+            glm::vec2 octahedron = glm::mix(glm::mix(tangent_00, tangent_10, fraction.y),
+                                            glm::mix(tangent_01, tangent_11, fraction.y), fraction.z);
+
+            if (octahedron == glm::vec2 { 0.0f })
+                return glm::vec3 { 0.0f }; // see decode_volume_tangent.
+
+            glm::vec3 tangent { octahedron, 1.0f - std::abs(octahedron.x) - std::abs(octahedron.y) };
+            if (tangent.z < 0.0f)
+                tangent = glm::vec3 { (1.0f - glm::abs(glm::vec2 { tangent.y, tangent.x })) * glm::sign(glm::vec2 { tangent }), tangent.z };
+            return glm::normalize(tangent);
+        }
+
+        bool Volume::skip_empty_brick(const glm::vec3& start, const glm::vec3& end, float& t, float step_size) const {
+            glm::vec3 brick_count { bricks };
+            glm::vec3 brick_position { (glm::mix(start, end, t) - volume.bounds.origin) / volume.bounds.size * brick_count };
+            glm::ivec3 brick { glm::floor(brick_position) };
+
+            if (glm::any(glm::lessThan(brick, glm::ivec3 { 0 })) || glm::any(glm::greaterThanEqual(brick, bricks)))
+                return false; // the outside is dealt with by the callers.
+
+            if (occupancy[brick.x + brick.y*bricks.x + brick.z*bricks.x*bricks.y] != 0)
+                return false;
+
+            glm::vec3 direction { (end - start) / volume.bounds.size * brick_count };
+            for (int axis { 0 }; axis < 3; ++axis)
+                if (direction[axis] == 0.0f) direction[axis] = 1e-6f;
+
+            glm::vec3 exit_plane { glm::vec3 { brick } + glm::step(glm::vec3 { 0.0f }, direction) };
+            glm::vec3 exit_distances { (exit_plane - brick_position) / direction };
+
+            float exit_distance = std::max(std::min(std::min(exit_distances.x, exit_distances.y), exit_distances.z), 0.0f);
+
+            t += std::floor(exit_distance / step_size) * step_size;
+
+            return true;
+        }
+
+        float Volume::deep_shadows(const glm::vec3& position, const glm::vec3& light_position,
+                                   float hair_alpha, const Settings& settings) const {
+            float t_near, t_far, t_exit { 0.0f }; // only sampled until it leaves the box.
+            if (intersect_box(volume.bounds, position, light_position - position, t_near, t_far))
+                t_exit = t_far;
+
+            float strands { 0.0f };
+            float step_size = 1.0f / settings.raycast_steps;
+            for (float t = 0.0f; t < 1.0f && t <= t_exit; t += step_size) {
+                if (skip_empty_brick(position, light_position, t, step_size))
+                    continue;
+                strands += sample_density(glm::mix(position, light_position, t)) * StrandThickness;
+            }
+
+            return std::pow(1.0f - hair_alpha, strands);
+        }
+
+        float Volume::local_ambient_occlusion(const glm::vec3& position, const Settings& settings) const {
+            constexpr float KernelSize { 2.0f }; // as with the rasterizer's.
+
+            float density { 0.0f };
+
+            float kernel_radius = (KernelSize - 1.0f) / 2.0f;
+            glm::vec3 voxel_space { volume.bounds.size / volume.resolution };
+            glm::vec3 voxel_sample_scaling { settings.occlusion_radius / kernel_radius * voxel_space };
+
+            for (float z = -kernel_radius; z <= +kernel_radius; z += 1.0f)
+            for (float y = -kernel_radius; y <= +kernel_radius; y += 1.0f)
+            for (float x = -kernel_radius; x <= +kernel_radius; x += 1.0f) {
+                glm::vec3 sample_position { position + glm::vec3 { x, y, z } * voxel_sample_scaling };
+                density += std::min(sample_density(sample_position), settings.ao_max);
+            }
+
+            return std::pow(1.0f - density / (KernelSize * KernelSize * KernelSize), settings.ao_exponent);
+        }
+
+        const vkhr::HairStyle::Volume& Volume::get_volume() const {
+            return volume;
+        }
+    }
+}
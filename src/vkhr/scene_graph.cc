@@ -1,33 +1,69 @@
 #include <vkhr/scene_graph.hh>
+#include <vkhr/trace_recorder.hh>
+#include <vkhr/job_system.hh>
 
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
 
 #include <fstream>
+#include <iostream>
+#include <limits>
+#include <array>
+#include <algorithm>
+#include <atomic>
+#include <unordered_set>
 
 #include <stdexcept>
 
 namespace vkhr {
+    static std::atomic<HairStyle::Quantization> style_quantization { HairStyle::Quantization::None };
+
     SceneGraph::SceneGraph(const std::string& file_path) {
         load(file_path);
     }
 
     void SceneGraph::traverse_nodes() {
-        destroy_previous_node_caches();
-        rebuild_lights_buffer_caches();
+        TraceRecorder::Scope trace_scope { "Traverse Nodes" };
+
+        if (rebuild_lights_buffer_caches())
+            ++light_source_revision;
+
+        if (root == nullptr || !root->subtree_dirty)
+            return; // nothing has moved.
+
+        ++node_revision;
+
+        bool rebuild_caches = node_caches_dirty || root->subtree_restructured;
+        if (rebuild_caches)
+            destroy_previous_node_caches();
+
         const glm::mat4 identity { 1 };
-        traverse(*root, identity); // I
+        traverse(*root, identity, false, rebuild_caches); // I
+        node_caches_dirty = false;
     }
 
-    void SceneGraph::traverse(Node& node, const glm::mat4& parent_matrix) {
-        node.set_model_matrix(node.get_local_transform() * parent_matrix);
+    void SceneGraph::traverse(Node& node, const glm::mat4& parent_matrix, bool parent_moved, bool rebuild_caches) {
+        bool moved = parent_moved || node.transform_dirty;
+
+        if (moved) {
+            node.set_model_matrix(node.get_local_transform() * parent_matrix);
+            node.compute_bounds();
+        }
 
         auto& model_matrix = node.get_model_matrix();
 
-        build_node_cache(node);
+        if (rebuild_caches)
+            build_node_cache(node);
 
-        for (auto& child_node : node.get_children())
-            traverse(*child_node, model_matrix);
+        // The clean subtrees can be skipped, unless the node caches are being rebuilt.
+        bool visit_children = moved || rebuild_caches || node.subtree_dirty;
+
+        node.transform_dirty = node.subtree_dirty = node.subtree_restructured = false;
+
+        if (visit_children) {
+            for (auto& child_node : node.get_children())
+                traverse(*child_node, model_matrix, moved, rebuild_caches);
+        }
     }
 
     bool SceneGraph::load(const std::string& file_path) {
@@ -39,8 +75,11 @@ namespace vkhr {
 
         auto parser = json::parse(file);
 
+        scene_file = file_path;
         scene_path = file_path.substr(0, file_path.find_last_of("\\/") + 1);
 
+        record_write_time(scene_file);
+
         if (!parse_camera(parser, camera)) return set_error_state(Error::ReadingCamera);
 
         if (auto lights = parser.find("lights"); lights != parser.end()) {
@@ -55,6 +94,16 @@ namespace vkhr {
         if (light_sources.size() >= 16) // Maximum count
             return set_error_state(Error::ReadingLight);
 
+        load_assets(parser);
+
+        if (!parse_nodes(parser)) return false;
+
+        scene_json = std::move(parser);
+
+        return true;
+    }
+
+    bool SceneGraph::parse_nodes(nlohmann::json& parser) {
         int i = 0;
         if (auto nodes = parser.find("nodes"); nodes != parser.end()) {
             this->nodes.reserve(nodes->size());
@@ -72,36 +121,257 @@ namespace vkhr {
         this->root = &nodes[root];
         this->root_index  = root;
 
+        node_caches_dirty = true;
         traverse_nodes(); // Build the tree.
 
         return true;
     }
 
+    void SceneGraph::record_write_time(const std::string& file_path) {
+        std::error_code error;
+        auto write_time = std::filesystem::last_write_time(file_path, error);
+        if (!error) write_times[file_path] = write_time;
+    }
+
+    bool SceneGraph::has_modified_files() const {
+        for (const auto& write_time : write_times) {
+            std::error_code error; // e.g. while it's being replaced, then it's found on the next poll.
+            auto last_write_time = std::filesystem::last_write_time(write_time.first, error);
+            if (!error && last_write_time != write_time.second)
+                return true;
+        }
+
+        return false;
+    }
+
+    bool SceneGraph::Changes::empty() const {
+        return hair_styles.empty() && models.empty() && !nodes && !lights && !moved;
+    }
+
+    SceneGraph::Changes SceneGraph::reload() {
+        Changes changes;
+
+        std::unordered_map<std::string, HairStyle> style_loads;
+        std::unordered_map<std::string, Model>     model_loads;
+
+        bool scene_modified { false };
+
+        for (const auto& write_time : write_times) {
+            std::error_code error;
+            auto last_write_time = std::filesystem::last_write_time(write_time.first, error);
+            if (error || last_write_time == write_time.second)
+                continue;
+            if (write_time.first == scene_file)
+                scene_modified = true;
+            else if (hair_styles.count(write_time.first))
+                style_loads[write_time.first];
+            else if (models.count(write_time.first))
+                model_loads[write_time.first];
+        }
+
+        load_files(style_loads, model_loads);
+
+        // Into the same elements, so the nodes (and the renderers, which are keyed by their address)
+        // still refer to them. A failed load, e.g. of a file that's still being written, keeps the
+        // last one, and is only tried again once it's been written to again (see the write times).
+        for (auto& style_load : style_loads) {
+            record_write_time(style_load.first);
+            if (!style_load.second) {
+                std::cerr << "Couldn't reload: " << style_load.first << "!" << std::endl;
+                continue;
+            }
+
+            auto& hair_style = hair_styles[style_load.first];
+            hair_style = std::move(style_load.second);
+            changes.hair_styles.push_back(&hair_style);
+        }
+
+        for (auto& model_load : model_loads) {
+            record_write_time(model_load.first);
+            if (!model_load.second) {
+                std::cerr << "Couldn't reload: " << model_load.first << "!" << std::endl;
+                continue;
+            }
+
+            auto& model = models[model_load.first];
+            model = std::move(model_load.second);
+            changes.models.push_back(&model);
+        }
+
+        mark_changed_nodes(changes);
+
+        if (scene_modified) {
+            record_write_time(scene_file);
+
+            std::ifstream file { scene_file };
+
+            try {
+                auto parser = json::parse(file);
+                reload_scene(parser, changes);
+            } catch (const json::exception& error) { // e.g. a half-written file, see above.
+                std::cerr << "Couldn't reload: " << scene_file << " (" << error.what() << ")!" << std::endl;
+            }
+        }
+
+        traverse_nodes();
+
+        return changes;
+    }
+
+    SceneGraph::Changes SceneGraph::replace(const HairStyle& hair_style, HairStyle&& replacement) {
+        Changes changes;
+
+        for (auto& style : hair_styles) {
+            if (&style.second != &hair_style)
+                continue;
+            style.second = std::move(replacement);
+            changes.hair_styles.push_back(&style.second);
+        }
+
+        mark_changed_nodes(changes);
+
+        traverse_nodes();
+
+        return changes;
+    }
+
+    void SceneGraph::mark_changed_nodes(const Changes& changes) {
+        // They've all moved inside of their nodes' bounds, which are found again by traverse_nodes.
+        for (auto& node : nodes) {
+            bool changed { false };
+            for (auto hair_style : node.get_hair_styles())
+                changed |= std::find(changes.hair_styles.begin(), changes.hair_styles.end(), hair_style) != changes.hair_styles.end();
+            for (auto model : node.get_models())
+                changed |= std::find(changes.models.begin(), changes.models.end(), model) != changes.models.end();
+            if (changed)
+                node.mark_dirty();
+        }
+    }
+
+    void SceneGraph::reload_scene(nlohmann::json& parser, Changes& changes) {
+        auto member = [](const json& object, const char* key) {
+            auto value = object.find(key);
+            return value != object.end() ? *value : json { };
+        };
+
+        bool camera_changed { member(parser, "camera") != member(scene_json, "camera") };
+        if (camera_changed) {
+            Camera reloaded_camera { camera };
+            if (parse_camera(parser, reloaded_camera)) {
+                camera = reloaded_camera;
+                changes.moved = true;
+            }
+        }
+
+        // They're (re-)parsed with the camera too, since their origins and projections depend on it.
+        auto lights = member(parser, "lights");
+        if ((camera_changed || lights != member(scene_json, "lights")) && lights.size() < 16) {
+            if (lights.size() != light_sources.size()) {
+                light_sources.clear();
+                light_sources.resize(lights.size());
+                changes.lights = true;
+            }
+
+            auto light_source = light_sources.begin();
+            for (auto& light : lights)
+                parse_light(light, *light_source++);
+
+            changes.moved = true;
+        }
+
+        // The nodes that have only been moved are moved in place, else they're all parsed again.
+        auto scene_nodes = member(parser, "nodes"), previous_nodes = member(scene_json, "nodes");
+
+        bool restructured { scene_nodes.size() != previous_nodes.size() ||
+                            parser.value("root", 0) != scene_json.value("root", 0) };
+
+        for (std::size_t i { 0 }; i < scene_nodes.size() && !restructured; ++i) {
+            for (auto key : { "name", "styles", "models", "children" })
+                restructured |= member(scene_nodes[i], key) != member(previous_nodes[i], key);
+        }
+
+        if (restructured) {
+            std::unordered_set<const void*> loaded_assets;
+            for (auto& hair_style : hair_styles) loaded_assets.insert(&hair_style.second);
+            for (auto& model : models) loaded_assets.insert(&model.second);
+
+            load_assets(parser);
+
+            // It'd throw in parse_node if any of them couldn't be loaded, and leave half of a scene.
+            for (auto& node : scene_nodes) {
+                for (const std::string& style_path : member(node, "styles")) {
+                    if (!hair_styles.count(scene_path + style_path)) {
+                        std::cerr << "Couldn't reload: " << scene_path + style_path << "!" << std::endl;
+                        return;
+                    }
+                }
+
+                for (const std::string& model_path : member(node, "models")) {
+                    if (!models.count(scene_path + model_path)) {
+                        std::cerr << "Couldn't reload: " << scene_path + model_path << "!" << std::endl;
+                        return;
+                    }
+                }
+            }
+
+            for (auto& hair_style : hair_styles) {
+                if (!loaded_assets.count(&hair_style.second))
+                    changes.hair_styles.push_back(&hair_style.second);
+            }
+
+            for (auto& model : models) {
+                if (!loaded_assets.count(&model.second))
+                    changes.models.push_back(&model.second);
+            }
+
+            clear_nodes();
+            parse_nodes(parser);
+
+            changes.nodes = true;
+        } else {
+            for (std::size_t i { 0 }; i < scene_nodes.size(); ++i) {
+                if (scene_nodes[i] != previous_nodes[i]) {
+                    parse_transform(scene_nodes[i], nodes[i]);
+                    changes.moved = true;
+                }
+            }
+        }
+
+        scene_json = std::move(parser);
+    }
+
     bool SceneGraph::parse_camera(nlohmann::json& parser, Camera& scene_camera) {
         if (auto camera = parser.find("camera"); camera != parser.end()) {
-            scene_camera.set_field_of_view(glm::radians(camera->value("fieldOfView", 45.0f)));
-            if (auto origin = camera->find("origin"); origin != camera->end()) {
-                scene_camera.set_position({ origin->at(0),
-                                            origin->at(1),
-                                            origin->at(2) });
-            } else return set_error_state(Error::ReadingCamera);
-
-            if (auto look_at = camera->find("lookAt"); look_at != camera->end()) {
-                scene_camera.set_look_at_point({ look_at->at(0),
-                                                 look_at->at(1),
-                                                 look_at->at(2) });
-            } else return set_error_state(Error::ReadingCamera);
-
-            if (auto upward = camera->find("upward"); upward != camera->end()) {
-                scene_camera.set_up_direction({ upward->at(0),
-                                                upward->at(1),
-                                                upward->at(2) });
-            } else scene_camera.set_up_direction({ 0, +1.0, 0 });
+            if (!parse_camera_object(*camera, scene_camera))
+                return set_error_state(Error::ReadingCamera);
         } else return set_error_state(Error::ReadingCamera);
 
         return true;
     }
 
+    bool SceneGraph::parse_camera_object(const nlohmann::json& camera, Camera& scene_camera) {
+        scene_camera.set_field_of_view(glm::radians(camera.value("fieldOfView", 45.0f)));
+        if (auto origin = camera.find("origin"); origin != camera.end()) {
+            scene_camera.set_position({ origin->at(0),
+                                        origin->at(1),
+                                        origin->at(2) });
+        } else return false;
+
+        if (auto look_at = camera.find("lookAt"); look_at != camera.end()) {
+            scene_camera.set_look_at_point({ look_at->at(0),
+                                             look_at->at(1),
+                                             look_at->at(2) });
+        } else return false;
+
+        if (auto upward = camera.find("upward"); upward != camera.end()) {
+            scene_camera.set_up_direction({ upward->at(0),
+                                            upward->at(1),
+                                            upward->at(2) });
+        } else scene_camera.set_up_direction({ 0, +1.0, 0 });
+
+        return true;
+    }
+
     bool SceneGraph::parse_light(nlohmann::json& parser, LightSource& light) {
         if (auto position = parser.find("position"); position != parser.end()) {
             light.set_position({ position->at(0),
@@ -120,6 +390,7 @@ namespace vkhr {
         } else return set_error_state(Error::ReadingLight);
 
         light.set_cutoff_factor(parser.value("cutoff", 0.0f));
+        light.set_range(parser.value("range", 0.0f));
 
         float distance = glm::distance(camera.get_look_at_point(),
                                        camera.get_position());
@@ -129,7 +400,7 @@ namespace vkhr {
         return true;
     }
 
-    bool SceneGraph::parse_node(nlohmann::json& parser, Node& node, int i) {
+    void SceneGraph::parse_transform(const nlohmann::json& parser, Node& node) {
         if (auto scale = parser.find("scale"); scale != parser.end()) {
             node.set_scale({ scale->at(0),
                              scale->at(1),
@@ -143,13 +414,20 @@ namespace vkhr {
                                          axis->at(2) });
             } else node.set_rotation_axis({0, 1, 0});
             node.set_rotation_angle(rotate->value("angle", 0.0f));
-        } else node.set_rotation({ 0, 1, 0 }, 0);
+        } else {
+            node.set_rotation_axis({ 0, 1, 0 });
+            node.set_rotation_angle(0);
+        }
 
         if (auto translate = parser.find("translate"); translate != parser.end()) {
             node.set_translation({ translate->at(0),
                                    translate->at(1),
                                    translate->at(2) });
         } else node.set_translation({ 0, 0, 0 });
+    }
+
+    bool SceneGraph::parse_node(nlohmann::json& parser, Node& node, int i) {
+        parse_transform(parser, node);
 
         auto node_name = parser.value("name", "");
 
@@ -207,6 +485,10 @@ namespace vkhr {
         return models[name];
     }
 
+    void SceneGraph::set_style_quantization(HairStyle::Quantization quantization) {
+        style_quantization = quantization;
+    }
+
     HairStyle& SceneGraph::add(const HairStyle& hair_style) {
         auto name = get_uuid();
         hair_styles[name] = hair_style;
@@ -225,25 +507,141 @@ namespace vkhr {
         if (hair_styles.find(path) != hair_styles.end())
             return hair_styles[path];
 
-        hair_styles[path] = HairStyle { path };
+        hair_styles[path] = load_style(path);
 
         // If you get this exception, it most likely means you haven't cloned using Git LFS.
         if (!hair_styles[path]) throw std::runtime_error { "Couldn't find: " + path + "!" };
 
-        hair_styles[path].shuffle();
-
-        if (!hair_styles[path].has_tangents())
-            hair_styles[path].generate_tangents();
-        if (!hair_styles[path].has_thickness())
-            hair_styles[path].generate_thickness(0.042f);
-        if (!hair_styles[path].has_indices())
-            hair_styles[path].generate_indices();
-        if (!hair_styles[path].has_bounding_box())
-            hair_styles[path].generate_bounding_box();
+        record_write_time(path);
 
         return hair_styles[path];
     }
 
+    void SceneGraph::prepare_style(HairStyle& hair_style) {
+        if (!hair_style.has_guides()) {
+            hair_style.shuffle(); // or it'd scramble the saved guides.
+            hair_style.sort_strands(StrandClusterSize);
+            hair_style.generate_guides(1.0f / 16.0f);
+        }
+
+        if (!hair_style.has_clusters())
+            hair_style.generate_clusters(); // after the sort, so the cuts are the LoD bands.
+
+        if (!hair_style.has_tangents())
+            hair_style.generate_tangents();
+        if (!hair_style.has_thickness())
+            hair_style.generate_thickness(0.042f);
+        if (!hair_style.has_indices())
+            hair_style.generate_indices();
+        if (!hair_style.has_bounding_box())
+            hair_style.generate_bounding_box();
+        if (!hair_style.has_position_thickness())
+            hair_style.generate_position_thickness(); // for the ray tracer to share.
+    }
+
+    HairStyle SceneGraph::load_style(const std::string& file_path) {
+        auto cache_path = HairStyle::get_cache_path(file_path);
+
+        if (HairStyle::cache_is_current(cache_path, file_path)) {
+            HairStyle hair_style;
+            if (hair_style.map(cache_path)) {
+                hair_style.set_file_path(file_path); // for its other caches.
+                prepare_style(hair_style); // shouldn't have anything left to do.
+                if (style_quantization == HairStyle::Quantization::Packed)
+                    hair_style.set_quantization(style_quantization);
+                return hair_style;
+            }
+        }
+
+        HairStyle hair_style { file_path };
+
+        if (hair_style) {
+            prepare_style(hair_style);
+            if (!hair_style.save(cache_path))
+                hair_style.reset_error_state(); // read-only? Then it's just not cached.
+            if (style_quantization == HairStyle::Quantization::Packed)
+                hair_style.set_quantization(style_quantization); // but not in its cache.
+        }
+
+        return hair_style;
+    }
+
+    void SceneGraph::prepare_model(Model& model) {
+        model.generate_distance_field(64); // for the strand collisions.
+    }
+
+    void SceneGraph::load_assets(nlohmann::json& parser) {
+        std::unordered_map<std::string, HairStyle> style_loads;
+        std::unordered_map<std::string, Model>     model_loads;
+
+        if (auto nodes = parser.find("nodes"); nodes != parser.end()) {
+            for (auto& node : *nodes) {
+                if (auto styles = node.find("styles"); styles != node.end()) {
+                    for (const std::string& style_path : *styles) {
+                        auto path = scene_path + style_path;
+                        if (this->hair_styles.count(path) || style_loads.count(path))
+                            continue; // shared by many nodes.
+                        style_loads[path];
+                    }
+                }
+
+                if (auto models = node.find("models"); models != node.end()) {
+                    for (const std::string& model_path : *models) {
+                        auto path = scene_path + model_path;
+                        if (this->models.count(path) || model_loads.count(path))
+                            continue;
+                        model_loads[path];
+                    }
+                }
+            }
+        }
+
+        load_files(style_loads, model_loads);
+
+        // The failed ones are loaded again in add_style and add_model, which reports the error.
+        for (auto& style_load : style_loads) {
+            if (style_load.second) {
+                hair_styles[style_load.first] = std::move(style_load.second);
+                record_write_time(style_load.first);
+            }
+        }
+
+        for (auto& model_load : model_loads) {
+            if (model_load.second) {
+                models[model_load.first] = std::move(model_load.second);
+                record_write_time(model_load.first);
+            }
+        }
+    }
+
+    void SceneGraph::load_files(std::unordered_map<std::string, HairStyle>& style_loads,
+                                std::unordered_map<std::string, Model>& model_loads) {
+        // Only once they're all known, since the loads write into the maps' elements. They're all
+        // Low priority jobs, so they don't hold up e.g. the ray tracer, but the loops in them aren't.
+        auto& job_system = JobSystem::get();
+
+        std::vector<JobSystem::Handle> loads;
+
+        for (auto& style_load : style_loads) {
+            loads.push_back(job_system.submit([&style_load] {
+                style_load.second = load_style(style_load.first);
+            }, { }, JobSystem::Low));
+        }
+
+        for (auto& model_load : model_loads) {
+            auto read = job_system.submit([&model_load] {
+                model_load.second = Model { model_load.first };
+            }, { }, JobSystem::Low);
+
+            // Separately, so the next model can be read while the distance field of this one is baked.
+            loads.push_back(job_system.submit([&model_load] {
+                if (model_load.second) prepare_model(model_load.second);
+            }, { read }, JobSystem::Low));
+        }
+
+        job_system.wait(loads);
+    }
+
     Model& SceneGraph::add_model(const std::string& asset_path) {
         auto path = scene_path + asset_path;
 
@@ -255,24 +653,42 @@ namespace vkhr {
         // Same thing here, this is likely the failure of not having Git LFS installed.
         if (!models[path]) throw std::runtime_error { "Couldn't find: " + path + "!" };
 
+        prepare_model(models[path]);
+
+        record_write_time(path);
+
         return models[path];
     }
 
     void SceneGraph::clear() {
         destroy_previous_node_caches();
+        node_caches_dirty = true;
         models.clear();
         hair_styles.clear();
+        write_times.clear();
         nodes.clear();
         nodes_by_name.clear();
         light_sources.clear();
         root = nullptr;
     }
 
+    bool SceneGraph::release_host_arrays() {
+        bool released { true };
+        for (auto& hair_style : hair_styles)
+            released &= hair_style.second.release_host_arrays();
+        return released;
+    }
+
     void SceneGraph::cleanup() {
+        clear_nodes();
+        light_sources.clear();
+    }
+
+    void SceneGraph::clear_nodes() {
         destroy_previous_node_caches();
+        node_caches_dirty = true;
         nodes.clear();
         nodes_by_name.clear();
-        light_sources.clear();
         root = nullptr;
     }
 
@@ -287,21 +703,26 @@ namespace vkhr {
     void SceneGraph::Node::add(Node* node) {
         node->set_parent_node(this);
         children.push_back(node);
+        node->mark_dirty(true);
     }
 
     void SceneGraph::Node::add(Model* model) {
         models.push_back(model);
+        mark_dirty(true);
     }
 
     void SceneGraph::Node::add(HairStyle* hair_style) {
         hair_styles.push_back(hair_style);
+        mark_dirty(true);
     }
 
     bool SceneGraph::Node::remove(std::vector<Model*>::iterator model) {
+        mark_dirty(true);
         return models.erase(model) != models.end();
     }
 
     bool SceneGraph::Node::remove(std::vector<HairStyle*>::iterator hair_style) {
+        mark_dirty(true);
         return hair_styles.erase(hair_style) != hair_styles.end();
     }
 
@@ -338,6 +759,7 @@ namespace vkhr {
     }
 
     bool SceneGraph::Node::remove(std::vector<Node*>::iterator child) {
+        mark_dirty(true);
         return children.erase(child) != children.end();
     }
 
@@ -352,32 +774,38 @@ namespace vkhr {
     void SceneGraph::Node::scale(const glm::vec3& scale) {
         this->scaling *= scale;
         recalculate_transform = true;
+        mark_dirty();
     }
 
     void SceneGraph::Node::set_rotation(const glm::vec3& axis, float angle) {
         this->rotation_axis = glm::normalize(axis);
         this->rotation_angle += angle;
         recalculate_transform = true;
+        mark_dirty();
     }
 
     void SceneGraph::Node::set_rotation_angle(float angle) {
         rotation_angle = angle;
         recalculate_transform = true;
+        mark_dirty();
     }
 
     void SceneGraph::Node::set_rotation_axis(const glm::vec3& axis) {
         rotation_axis = glm::normalize(axis);
         recalculate_transform = true;
+        mark_dirty();
     }
 
     void SceneGraph::Node::set_translation(const glm::vec3& translation) {
         this->translation = translation;
         recalculate_transform = true;
+        mark_dirty();
     }
 
     void SceneGraph::Node::set_scale(const glm::vec3& scale) {
         this->scaling = scale;
         recalculate_transform = true;
+        mark_dirty();
     }
 
     const glm::vec3& SceneGraph::Node::get_translation() const {
@@ -400,6 +828,14 @@ namespace vkhr {
         parent = node;
     }
 
+    void SceneGraph::Node::mark_dirty(bool restructured) {
+        transform_dirty = true;
+        for (auto node = this; node != nullptr; node = node->parent) {
+            node->subtree_dirty = true;
+            node->subtree_restructured |= restructured;
+        }
+    }
+
     SceneGraph::Node* SceneGraph::Node::get_parent_node() const {
         return parent;
     }
@@ -426,6 +862,64 @@ namespace vkhr {
         return model_matrix;
     }
 
+    void SceneGraph::Node::compute_bounds() {
+        std::vector<AABB> local_bounds;
+        for (auto model : models)
+            local_bounds.push_back(model->get_bounding_box());
+        for (auto hair_style : hair_styles)
+            local_bounds.push_back(hair_style->get_bounding_box());
+
+        glm::vec3 bounds_min { std::numeric_limits<float>::max() };
+        glm::vec3 bounds_max { std::numeric_limits<float>::lowest() };
+
+        // All of the corners, since the box might have been rotated.
+        for (const auto& local_bound : local_bounds) {
+            for (int corner { 0 }; corner < 8; ++corner) {
+                glm::vec3 offset { corner & 1, (corner >> 1) & 1, (corner >> 2) & 1 };
+                glm::vec3 point = model_matrix * glm::vec4 { local_bound.origin + offset * local_bound.size, 1.0f };
+                bounds_min = glm::min(bounds_min, point);
+                bounds_max = glm::max(bounds_max, point);
+            }
+        }
+
+        if (local_bounds.empty())
+            bounds_min = bounds_max = glm::vec3 { model_matrix[3] };
+
+        glm::vec3 size { bounds_max - bounds_min };
+
+        bounds = AABB {
+            bounds_min,
+            glm::length(size),
+            size,
+            size.x * size.y * size.z
+        };
+    }
+
+    const AABB& SceneGraph::Node::get_bounds() const {
+        return bounds;
+    }
+
+    bool SceneGraph::Node::in_frustum(const glm::mat4& view_projection) const {
+        auto row = [&](int i) { return glm::vec4 { view_projection[0][i], view_projection[1][i],
+                                                   view_projection[2][i], view_projection[3][i] }; };
+
+        // The planes of the (OpenGL-style) clip space, which also covers Vulkan's depth range.
+        std::array<glm::vec4, 6> planes {
+            row(3) + row(0), row(3) - row(0),
+            row(3) + row(1), row(3) - row(1),
+            row(3) + row(2), row(3) - row(2)
+        };
+
+        // Outside if the corner furthest along the normal is behind any plane.
+        for (const auto& plane : planes) {
+            glm::vec3 corner = bounds.origin + glm::step(glm::vec3 { 0.0f }, glm::vec3 { plane }) * bounds.size;
+            if (glm::dot(glm::vec3 { plane }, corner) + plane.w < 0.0f)
+                return false;
+        }
+
+        return true;
+    }
+
     const glm::mat4& SceneGraph::Node::get_matrix() const {
         return model_matrix;
     }
@@ -493,21 +987,41 @@ namespace vkhr {
             hair_style_cache.push_back(&node);
     }
 
-    void SceneGraph::rebuild_lights_buffer_caches() {
-        if (light_source_buffers.size() != light_sources.size())
+    bool SceneGraph::rebuild_lights_buffer_caches() {
+        bool rebuilt { false };
+
+        if (light_source_buffers.size() != light_sources.size()) {
             light_source_buffers.resize(light_sources.size());
+            rebuilt = true;
+        }
 
         std::size_t i { 0 };
 
         for (const auto& light_source : light_sources) {
-            light_source_buffers[i++] = light_source.get_buffer();
+            // Called first, so that the flag is cleared even if we're already rebuilding.
+            if (light_source.buffer_is_dirty() || rebuilt) {
+                light_source_buffers[i] = light_source.get_buffer();
+                rebuilt = true;
+            }
+
+            ++i;
         }
+
+        return rebuilt;
     }
 
     std::vector<LightSource::Buffer>& SceneGraph::fetch_light_source_buffers() const {
         return light_source_buffers;
     }
 
+    std::size_t SceneGraph::get_light_source_revision() const {
+        return light_source_revision;
+    }
+
+    std::size_t SceneGraph::get_node_revision() const {
+        return node_revision;
+    }
+
     void SceneGraph::destroy_previous_node_caches() {
         model_node_cache.clear();
         hair_style_cache.clear();
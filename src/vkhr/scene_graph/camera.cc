@@ -7,6 +7,7 @@
 #include <glm/gtx/rotate_vector.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <algorithm>
 #include <cmath>
 
 namespace vkhr {
@@ -213,6 +214,68 @@ namespace vkhr {
         return view_projection_matrix;
     }
 
+    static float halton(std::uint32_t index, std::uint32_t base) {
+        float fraction { 1.0f }, result { 0.0f };
+        while (index > 0) {
+            fraction /= base;
+            result += fraction * (index % base);
+            index /= base;
+        }
+
+        return result;
+    }
+
+    glm::vec2 Camera::get_jitter(std::uint32_t frame) {
+        auto index = frame % JitterSamples + 1; // since the 0th is 0.
+        return { halton(index, 2) - 0.5f, halton(index, 3) - 0.5f };
+    }
+
+    glm::mat4 Camera::get_jittered_projection_matrix(const glm::vec2& jitter) const {
+        auto jittered_projection = get_projection_matrix();
+        jittered_projection[2][0] -= 2.0f * jitter.x / width; // since the w is -z.
+        jittered_projection[2][1] -= 2.0f * jitter.y / height;
+        return jittered_projection;
+    }
+
+    void Camera::set_eye_separation(float eye_separation) {
+        this->eye_separation = std::max(eye_separation, 0.0f);
+    }
+
+    float Camera::get_eye_separation() const {
+        return eye_separation;
+    }
+
+    bool Camera::is_stereo() const {
+        return eye_separation > 0.0f;
+    }
+
+    glm::vec3 Camera::get_eye_position(std::uint32_t eye) const {
+        float side = eye == 0 ? 0.5f : -0.5f;
+        return position + glm::normalize(get_left_direction()) * eye_separation * side;
+    }
+
+    glm::mat4 Camera::get_eye_view_matrix(std::uint32_t eye) const {
+        auto eye_position = get_eye_position(eye);
+        return glm::lookAt(eye_position, look_at_point + (eye_position - position), up_direction);
+    }
+
+    glm::mat4 Camera::get_culling_view_projection() const {
+        if (!is_stereo())
+            return get_view_projection();
+
+        // Far enough behind the camera that the eyes are on the edges of its frustum, which has the
+        // same field of view, so the side planes of the eyes' frustums are all inside of its planes.
+        float half_width = std::tan(0.5f * field_of_view) * get_aspect_ratio();
+        float behind = 0.5f * eye_separation / half_width;
+
+        auto culling_projection = glm::perspective(field_of_view, get_aspect_ratio(),
+                                                   near_distance + behind, far_distance + behind);
+        culling_projection[1][1] *= -1; // Since Vulkan uses RHS coord-sys.
+
+        return culling_projection * glm::lookAt(position - get_forward_direction() * behind,
+                                                look_at_point, up_direction);
+    }
+
     glm::vec3 Camera::get_left_direction() const {
         return glm::cross(get_up_direction(),
                           get_forward_direction());
@@ -0,0 +1,136 @@
+#include <vkhr/scene_graph/camera_path.hh>
+
+#include <vkhr/scene_graph.hh>
+
+#include <algorithm>
+#include <fstream>
+
+namespace vkhr {
+    CameraPath::CameraPath(const std::string& file_path) {
+        load(file_path);
+    }
+
+    bool CameraPath::load(const std::string& file_path) {
+        std::ifstream file { file_path };
+
+        if (!file) return false;
+
+        try {
+            auto parser = nlohmann::json::parse(file);
+            auto camera_path = parser.find("cameraPath");
+            if (camera_path == parser.end())
+                return false;
+            return parse(*camera_path);
+        } catch (const nlohmann::json::exception&) {
+            return false;
+        }
+    }
+
+    bool CameraPath::save(const std::string& file_path) const {
+        std::ofstream file { file_path };
+
+        if (!file) return false;
+
+        nlohmann::json camera_path;
+        camera_path["cameraPath"] = dump();
+        file << camera_path.dump(4) << "\n";
+
+        return static_cast<bool>(file);
+    }
+
+    bool CameraPath::parse(const nlohmann::json& parser) {
+        clear();
+
+        for (const auto& keyframe : parser) {
+            Camera camera;
+            if (!SceneGraph::parse_camera_object(keyframe, camera))
+                return false;
+
+            float time = keyframes.empty() ? 0.0f : keyframes.back().time + 1.0f;
+            add_keyframe(camera, keyframe.value("time", time));
+        }
+
+        return true;
+    }
+
+    nlohmann::json CameraPath::dump() const {
+        auto parser = nlohmann::json::array();
+
+        for (const auto& keyframe : keyframes) {
+            const auto& origin  = keyframe.camera.get_position();
+            const auto& look_at = keyframe.camera.get_look_at_point();
+            const auto& upward  = keyframe.camera.get_up_direction();
+
+            parser.push_back({
+                { "time", keyframe.time },
+                { "fieldOfView", glm::degrees(keyframe.camera.get_field_of_view()) },
+                { "origin", { origin.x,  origin.y,  origin.z  } },
+                { "lookAt", { look_at.x, look_at.y, look_at.z } },
+                { "upward", { upward.x,  upward.y,  upward.z  } }
+            });
+        }
+
+        return parser;
+    }
+
+    void CameraPath::add_keyframe(const Camera& camera, float time) {
+        keyframes.push_back({ camera, time });
+    }
+
+    static bool same_view(const Camera& a, const Camera& b) {
+        return a.get_position()      == b.get_position()      &&
+               a.get_look_at_point() == b.get_look_at_point() &&
+               a.get_up_direction()  == b.get_up_direction()  &&
+               a.get_field_of_view() == b.get_field_of_view();
+    }
+
+    void CameraPath::record(const Camera& camera, float time) {
+        auto count = keyframes.size();
+        if (count >= 2 && same_view(keyframes[count - 1].camera, camera) &&
+                          same_view(keyframes[count - 2].camera, camera)) {
+            keyframes.back().time = time;
+        } else {
+            add_keyframe(camera, time);
+        }
+    }
+
+    void CameraPath::sample(float time, Camera& camera) const {
+        if (keyframes.empty())
+            return;
+
+        time += keyframes.front().time;
+
+        auto next = std::upper_bound(keyframes.begin(), keyframes.end(), time, [](float time, const Keyframe& keyframe) {
+            return time < keyframe.time;
+        });
+
+        const auto& from = next == keyframes.begin() ? *next : *(next - 1);
+        const auto& to   = next == keyframes.end()   ? *(next - 1) : *next;
+
+        auto length = to.time - from.time;
+        auto t = length > 0.0f ? glm::clamp((time - from.time) / length, 0.0f, 1.0f) : 0.0f;
+
+        camera.set_field_of_view(glm::mix(from.camera.get_field_of_view(), to.camera.get_field_of_view(), t));
+        camera.look_at(glm::mix(from.camera.get_look_at_point(), to.camera.get_look_at_point(), t),
+                       glm::mix(from.camera.get_position(),      to.camera.get_position(),      t),
+                       glm::mix(from.camera.get_up_direction(),  to.camera.get_up_direction(),  t));
+    }
+
+    float CameraPath::get_duration() const {
+        if (keyframes.empty())
+            return 0.0f;
+        return keyframes.back().time - keyframes.front().time;
+    }
+
+    std::size_t CameraPath::size() const {
+        return keyframes.size();
+    }
+
+    bool CameraPath::empty() const {
+        return keyframes.empty();
+    }
+
+    void CameraPath::clear() {
+        keyframes.clear();
+    }
+}
@@ -0,0 +1,458 @@
+#include <vkhr/scene_graph/hair_importer.hh>
+
+#include <vkhr/scene_graph/hair_style.hh>
+#include <vkhr/job_system.hh>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <vector>
+
+namespace vkhr {
+    namespace hair_importer {
+        static constexpr std::size_t ChunkSize { 65536 }; // vertices, per job.
+
+        static constexpr std::size_t MaximumStrandVertices { std::numeric_limits<unsigned short>::max() + 1u };
+
+        static std::string get_extension(const std::string& file_path) {
+            auto extension = std::filesystem::path { file_path }.extension().string();
+            std::transform(extension.begin(), extension.end(), extension.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return extension;
+        }
+
+        bool is_importable(const std::string& file_path) {
+            auto extension = get_extension(file_path);
+            return extension == ".tfx" || extension == ".abc";
+        }
+
+        bool import(const MemoryMap& file, const std::string& file_path, HairStyle& hair_style) {
+            auto extension = get_extension(file_path);
+            if (extension == ".tfx")
+                return import_tressfx(file, hair_style);
+            else if (extension == ".abc")
+                return import_alembic(file, hair_style);
+            return false;
+        }
+
+        // The TressFXTFXFileHeader, where the offsets are from the start of the file.
+        struct TressFXHeader {
+            float version;
+            std::uint32_t strand_count,
+                          vertices_per_strand;
+            std::uint32_t vertex_offset, // float4 each.
+                          strand_uv_offset,
+                          vertex_uv_offset,
+                          strand_thickness_offset,
+                          vertex_color_offset;
+            std::uint32_t reserved[32];
+        };
+
+        bool import_tressfx(const MemoryMap& file, HairStyle& hair_style) {
+            TressFXHeader header;
+            if (file.get_size() < sizeof(header))
+                return false;
+            std::memcpy(&header, file.get_data(), sizeof(header));
+
+            if (header.strand_count == 0 || header.vertices_per_strand < 2 ||
+                header.vertices_per_strand > MaximumStrandVertices)
+                return false;
+
+            std::size_t vertex_count { static_cast<std::size_t>(header.strand_count) * header.vertices_per_strand };
+            if (vertex_count > std::numeric_limits<unsigned>::max())
+                return false;
+
+            // As bytes, since nothing says the offset is aligned to a float, so they're copied out.
+            constexpr std::size_t PositionSize { 4 * sizeof(float) };
+            auto positions = file.view<char>(header.vertex_offset, vertex_count * PositionSize);
+            if (positions.empty())
+                return false;
+
+            // They're all the same length, so that's the default, and there's no need for the segments.
+            hair_style.segments.clear();
+            hair_style.set_strand_count(header.strand_count);
+            hair_style.set_default_segment_count(header.vertices_per_strand - 1);
+
+            hair_style.vertices.resize(vertex_count);
+            auto* vertices = hair_style.vertices.data();
+
+            int chunks { static_cast<int>((vertex_count + ChunkSize - 1) / ChunkSize) };
+            JobSystem::get().parallel_for(0, chunks, 1, [&](int chunk) {
+                std::size_t first { chunk * ChunkSize },
+                            last  { std::min(first + ChunkSize, vertex_count) };
+                const char* position { positions.data() + first * PositionSize };
+                for (std::size_t vertex { first }; vertex < last; ++vertex, position += PositionSize)
+                    std::memcpy(&vertices[vertex], position, sizeof(glm::vec3)); // the xyz of it.
+            });
+
+            return true;
+        }
+
+        // An Ogawa archive is a tree of groups, that are a 64-bit count and as many 64-bit offsets to
+        // their children, and of data, a 64-bit size and as many bytes. The top bit of an offset is set
+        // when it's data, and an offset of 0 is an empty child. It's read in place from the mapped file,
+        // and everything outside of it is seen as empty, so a truncated archive fails, but safely.
+        class Ogawa final {
+        public:
+            Ogawa(const MemoryMap& file) : file { file } { }
+
+            static constexpr std::uint64_t DataBit { 0x8000000000000000ull };
+
+            bool is_valid() const; // and was fully written, i.e. it's frozen.
+            std::uint64_t get_root() const;
+
+            std::uint64_t get_child_count(std::uint64_t group) const;
+            std::uint64_t get_child(std::uint64_t group, std::uint64_t child) const;
+
+            static bool is_group(std::uint64_t child) { return (child & DataBit) == 0; }
+
+            Span<char> get_data(std::uint64_t child) const;
+
+        private:
+            std::uint64_t read(std::uint64_t offset) const; // 0 outside.
+
+            const MemoryMap& file;
+        };
+
+        bool Ogawa::is_valid() const {
+            return file.get_size() >= 16 && std::memcmp(file.get_data(), "Ogawa", 5) == 0 &&
+                   static_cast<unsigned char>(file.get_data()[5]) == 0xff;
+        }
+
+        std::uint64_t Ogawa::get_root() const {
+            return read(8);
+        }
+
+        std::uint64_t Ogawa::read(std::uint64_t offset) const {
+            std::uint64_t value { 0 };
+            if (offset <= file.get_size() && file.get_size() - offset >= sizeof(value))
+                std::memcpy(&value, file.get_data() + offset, sizeof(value));
+            return value;
+        }
+
+        std::uint64_t Ogawa::get_child_count(std::uint64_t group) const {
+            if (!is_group(group) || group == 0)
+                return 0;
+            auto count = read(group);
+            if (count > (file.get_size() - group) / sizeof(std::uint64_t))
+                return 0; // it wouldn't fit.
+            return count;
+        }
+
+        std::uint64_t Ogawa::get_child(std::uint64_t group, std::uint64_t child) const {
+            if (child >= get_child_count(group))
+                return 0;
+            return read(group + (child + 1) * sizeof(std::uint64_t));
+        }
+
+        Span<char> Ogawa::get_data(std::uint64_t child) const {
+            auto offset = child & ~DataBit;
+            if (is_group(child) || offset == 0)
+                return Span<char> {  };
+            auto size = read(offset);
+            if (size > file.get_size())
+                return Span<char> {  };
+            return file.view<char>(offset + sizeof(std::uint64_t), size);
+        }
+
+        // What's needed of Alembic's property headers (see AbcCoreOgawa's ReadPropertyHeaders), which
+        // are packed in the last child of a compound property's group, in the order of its children.
+        struct AlembicProperty {
+            enum Type {
+                Compound,
+                Scalar,
+                Array
+            } type;
+
+            enum Pod {
+                Int32   = 6,
+                Uint32  = 5,
+                Float32 = 10
+            };
+
+            unsigned pod { 0 }, extent { 0 };
+            std::string name;
+            std::uint64_t group { 0 };
+        };
+
+        static std::vector<AlembicProperty> read_properties(const Ogawa& ogawa, std::uint64_t compound) {
+            std::vector<AlembicProperty> properties;
+
+            auto children = ogawa.get_child_count(compound);
+            if (children == 0)
+                return properties;
+
+            auto headers = ogawa.get_data(ogawa.get_child(compound, children - 1));
+            std::size_t position { 0 };
+
+            // The counts and sizes are 1, 2 or 4 bytes, by the header's size hint.
+            auto read_hinted = [&](unsigned size_hint, std::uint32_t& value) {
+                std::size_t size { size_hint == 0 ? 1u : size_hint == 1 ? 2u : 4u };
+                if (headers.size() - position < size)
+                    return false;
+                value = 0; // little-endian.
+                std::memcpy(&value, headers.data() + position, size);
+                position += size;
+                return true;
+            };
+
+            while (position < headers.size()) {
+                std::uint32_t info, skipped;
+                if (!read_hinted(2, info))
+                    return { };
+
+                AlembicProperty property;
+                auto type = info & 0x3; // 3 is a scalar-like array.
+                property.type = type == 0 ? AlembicProperty::Compound :
+                                type == 1 ? AlembicProperty::Scalar : AlembicProperty::Array;
+
+                unsigned size_hint { (info & 0xc) >> 2 };
+
+                if (property.type != AlembicProperty::Compound) {
+                    property.pod    = (info & 0xf0)    >> 4;
+                    property.extent = (info & 0xff000) >> 12;
+
+                    // With 0x800 there are no samples, and their count isn't written.
+                    if (!(info & 0x800) && !read_hinted(size_hint, skipped)) // the sample count.
+                        return { };
+                    if ((info & 0x200) && (!read_hinted(size_hint, skipped) || !read_hinted(size_hint, skipped)))
+                        return { }; // the first and last changed sample.
+                    if ((info & 0x100) && !read_hinted(size_hint, skipped))
+                        return { }; // the time sampling.
+                }
+
+                std::uint32_t name_size;
+                if (!read_hinted(size_hint, name_size) || headers.size() - position < name_size)
+                    return { };
+                property.name.assign(headers.data() + position, name_size);
+                position += name_size;
+
+                if (((info & 0xff00000) >> 20) == 0xff) { // metadata that isn't indexed.
+                    std::uint32_t metadata_size;
+                    if (!read_hinted(size_hint, metadata_size) || headers.size() - position < metadata_size)
+                        return { };
+                    position += metadata_size;
+                }
+
+                property.group = ogawa.get_child(compound, properties.size());
+                properties.push_back(std::move(property));
+            }
+
+            return properties;
+        }
+
+        static const AlembicProperty* find_property(const std::vector<AlembicProperty>& properties, const std::string& name,
+                                                    AlembicProperty::Type type, unsigned pod = 0, unsigned extent = 0) {
+            for (const auto& property : properties) {
+                if (property.name == name && property.type == type &&
+                    (type == AlembicProperty::Compound || (property.pod == pod && property.extent == extent)))
+                    return &property;
+            }
+
+            return nullptr;
+        }
+
+        // The first sample of an array property, which is its data, after a 16 byte digest of it, and
+        // then its dimensions, which are left out here, since all of the ones that are used are 1D.
+        static Span<char> read_first_sample(const Ogawa& ogawa, const AlembicProperty* property) {
+            if (property == nullptr)
+                return Span<char> {  };
+            auto sample = ogawa.get_data(ogawa.get_child(property->group, 0));
+            if (sample.size() < 16)
+                return Span<char> {  };
+            return Span<char> { sample.data() + 16, sample.size() - 16 };
+        }
+
+        // Views into the mapped file, which are unaligned, so every element is memcpy:ed out of them.
+        struct AlembicCurves {
+            Span<char> positions;     // float3.
+            Span<char> vertex_counts; // int32.
+            Span<char> widths;        // float, of the vertices, curves or all of them.
+            Span<char> width_indices; // uint32, if they're indexed.
+
+            std::size_t vertex_count { 0 }, curve_count { 0 }, width_count { 0 };
+
+            template<typename T>
+            static T get(const Span<char>& span, std::size_t i) {
+                T value;
+                std::memcpy(&value, span.data() + i * sizeof(T), sizeof(T));
+                return value;
+            }
+
+            float get_width(std::size_t i) const {
+                if (!width_indices.empty())
+                    i = get<std::uint32_t>(width_indices, i);
+                return i < widths.size() / sizeof(float) ? get<float>(widths, i) : 0.0f;
+            }
+        };
+
+        // The AbcGeom curves schema, i.e. a ".geom" compound with the nVertices (and P) of the curves.
+        static bool read_curves(const Ogawa& ogawa, std::uint64_t properties, AlembicCurves& curves) {
+            auto object = read_properties(ogawa, properties);
+            auto geometry = find_property(object, ".geom", AlembicProperty::Compound);
+            if (geometry == nullptr)
+                return false;
+
+            auto schema = read_properties(ogawa, geometry->group);
+
+            auto vertex_counts = find_property(schema, "nVertices", AlembicProperty::Array, AlembicProperty::Int32, 1);
+            auto positions = find_property(schema, "P", AlembicProperty::Array, AlembicProperty::Float32, 3);
+            if (vertex_counts == nullptr || positions == nullptr)
+                return false;
+
+            curves.positions = read_first_sample(ogawa, positions);
+            curves.vertex_counts = read_first_sample(ogawa, vertex_counts);
+            curves.vertex_count = curves.positions.size() / (3 * sizeof(float));
+            curves.curve_count = curves.vertex_counts.size() / sizeof(std::int32_t);
+
+            // The widths are a geometry parameter, so they're either an array or a compound with the
+            // values and the indices into them, if they're indexed.
+            if (auto widths = find_property(schema, "width", AlembicProperty::Array, AlembicProperty::Float32, 1)) {
+                curves.widths = read_first_sample(ogawa, widths);
+                curves.width_count = curves.widths.size() / sizeof(float);
+            } else if (auto indexed = find_property(schema, "width", AlembicProperty::Compound)) {
+                auto parameter = read_properties(ogawa, indexed->group);
+                curves.widths = read_first_sample(ogawa, find_property(parameter, ".vals", AlembicProperty::Array, AlembicProperty::Float32, 1));
+                curves.width_indices = read_first_sample(ogawa, find_property(parameter, ".indices", AlembicProperty::Array, AlembicProperty::Uint32, 1));
+                curves.width_count = curves.width_indices.empty() ? curves.widths.size() / sizeof(float)
+                                                                  : curves.width_indices.size() / sizeof(std::uint32_t);
+            }
+
+            // Any other count can't be mapped to the vertices, and then they're left out.
+            if (curves.width_count != curves.vertex_count && curves.width_count != curves.curve_count && curves.width_count != 1)
+                curves.widths = curves.width_indices = Span<char> {  };
+
+            return curves.curve_count != 0;
+        }
+
+        // An object's group has its properties, then the groups of its children, and then their headers.
+        static void find_curves(const Ogawa& ogawa, std::uint64_t object, std::vector<AlembicCurves>& curves, unsigned depth = 0) {
+            constexpr unsigned MaximumDepth { 256 }; // it's a tree, but a broken file might not be one.
+            if (depth == MaximumDepth)
+                return;
+
+            auto children = ogawa.get_child_count(object);
+            if (children == 0)
+                return;
+
+            AlembicCurves object_curves;
+            if (Ogawa::is_group(ogawa.get_child(object, 0)) && read_curves(ogawa, ogawa.get_child(object, 0), object_curves))
+                curves.push_back(object_curves);
+
+            for (std::uint64_t child { 1 }; child < children; ++child) {
+                auto child_object = ogawa.get_child(object, child);
+                if (Ogawa::is_group(child_object))
+                    find_curves(ogawa, child_object, curves, depth + 1);
+            }
+        }
+
+        bool import_alembic(const MemoryMap& file, HairStyle& hair_style) {
+            Ogawa ogawa { file };
+            if (!ogawa.is_valid())
+                return false; // e.g. an HDF5 archive, or one that's still being written.
+
+            // The version and library version, then the top object. Its metadata and time samplings follow.
+            auto root = ogawa.get_root();
+            if (ogawa.get_child_count(root) < 3 || !Ogawa::is_group(ogawa.get_child(root, 2)))
+                return false;
+
+            std::vector<AlembicCurves> curves;
+            find_curves(ogawa, ogawa.get_child(root, 2), curves);
+
+            // Only the vertex counts are read here, and it's split into chunks of curves that have around
+            // ChunkSize vertices, which then know where their strands go, so they're copied in parallel.
+            struct Chunk {
+                std::size_t object;
+                std::size_t first_curve, last_curve;
+                std::size_t source_vertex;
+                std::size_t strand, vertex;
+            };
+
+            std::vector<Chunk> chunks;
+            std::size_t strand_count { 0 }, vertex_count { 0 };
+            bool has_widths { false };
+
+            for (std::size_t object { 0 }; object < curves.size(); ++object) {
+                const auto& object_curves = curves[object];
+
+                std::size_t source_vertex { 0 };
+                for (std::size_t curve { 0 }; curve < object_curves.curve_count; ++curve) {
+                    if (curve == 0 || source_vertex - chunks.back().source_vertex >= ChunkSize)
+                        chunks.push_back({ object, curve, curve, source_vertex, strand_count, vertex_count });
+                    chunks.back().last_curve = curve + 1;
+
+                    auto curve_vertices = AlembicCurves::get<std::int32_t>(object_curves.vertex_counts, curve);
+                    if (curve_vertices < 0 || static_cast<std::size_t>(curve_vertices) > MaximumStrandVertices)
+                        return false;
+
+                    if (curve_vertices >= 2) {
+                        strand_count += 1;
+                        vertex_count += curve_vertices;
+                    }
+
+                    source_vertex += curve_vertices;
+                }
+
+                if (source_vertex != object_curves.vertex_count)
+                    return false; // the counts and the positions don't match.
+
+                has_widths = has_widths || !object_curves.widths.empty();
+            }
+
+            if (strand_count == 0 || vertex_count > std::numeric_limits<unsigned>::max())
+                return false;
+
+            hair_style.segments.resize(strand_count);
+            hair_style.vertices.resize(vertex_count);
+            hair_style.thickness.resize(has_widths ? vertex_count : 0);
+            hair_style.set_strand_count(static_cast<unsigned>(strand_count));
+
+            auto* segments = hair_style.segments.data();
+            auto* vertices = hair_style.vertices.data();
+            auto* thickness = hair_style.thickness.data();
+
+            float default_thickness { hair_style.get_default_thickness() };
+
+            JobSystem::get().parallel_for(0, static_cast<int>(chunks.size()), 1, [&](int chunk_index) {
+                const auto& chunk = chunks[chunk_index];
+                const auto& object_curves = curves[chunk.object];
+
+                auto source_vertex = chunk.source_vertex;
+                auto strand = chunk.strand, vertex = chunk.vertex;
+
+                for (auto curve = chunk.first_curve; curve < chunk.last_curve; ++curve) {
+                    auto curve_vertices = static_cast<std::size_t>(AlembicCurves::get<std::int32_t>(object_curves.vertex_counts, curve));
+
+                    if (curve_vertices >= 2) {
+                        segments[strand++] = static_cast<unsigned short>(curve_vertices - 1);
+
+                        std::memcpy(vertices + vertex, object_curves.positions.data() + source_vertex * sizeof(glm::vec3),
+                                    curve_vertices * sizeof(glm::vec3));
+
+                        if (has_widths) {
+                            for (std::size_t i { 0 }; i < curve_vertices; ++i) {
+                                if (object_curves.widths.empty())
+                                    thickness[vertex + i] = default_thickness;
+                                else if (object_curves.width_count == object_curves.vertex_count)
+                                    thickness[vertex + i] = object_curves.get_width(source_vertex + i) * 0.5f;
+                                else if (object_curves.width_count == object_curves.curve_count)
+                                    thickness[vertex + i] = object_curves.get_width(curve) * 0.5f;
+                                else
+                                    thickness[vertex + i] = object_curves.get_width(0) * 0.5f;
+                            }
+                        }
+
+                        vertex += curve_vertices;
+                    }
+
+                    source_vertex += curve_vertices;
+                }
+            });
+
+            return true;
+        }
+    }
+}
@@ -1,10 +1,18 @@
 #include <vkhr/scene_graph/hair_style.hh>
 
+#include <vkhr/scene_graph/hair_importer.hh>
+#include <vkhr/compression.hh>
+#include <vkhr/job_system.hh>
+
 #include <random>
 #include <cstring>
 #include <algorithm>
+#include <cmath>
+#include <filesystem>
 #include <fstream>
 #include <numeric>
+#include <limits>
+#include <type_traits>
 
 namespace vkhr {
     HairStyle::HairStyle(const std::string& file_path) {
@@ -21,7 +29,17 @@ namespace vkhr {
         return error_state;
     }
 
+    void HairStyle::reset_error_state() {
+        error_state = Error::None;
+    }
+
     bool HairStyle::load(const std::string& file_path) {
+        memory_map.reset(); // Reading the file into the vectors now.
+        this->file_path = file_path;
+
+        if (hair_importer::is_importable(file_path))
+            return import(file_path);
+
         std::ifstream file { file_path, std::ios::binary };
 
         if (!file) return set_error_state(Error::OpeningFile);
@@ -31,6 +49,13 @@ namespace vkhr {
 
         if (!valid_signature()) return set_error_state(Error::InvalidSignature);
 
+        if (is_compressed()) {
+            if (auto error = read_compressed(file); error != Error::None)
+                return set_error_state(error);
+            if (!format_is_valid()) return set_error_state(Error::InvalidFormat);
+            return set_error_state(Error::None);
+        }
+
         if (!read_segments(file)) return set_error_state(Error::ReadingSegments);
         if (!read_vertices(file)) return set_error_state(Error::ReadingVertices);
         if (!read_thickness(file)) return set_error_state(Error::ReadingThickness);
@@ -38,15 +63,140 @@ namespace vkhr {
         if (!read_color(file)) return set_error_state(Error::ReadingColor);
         if (!read_tangents(file)) return set_error_state(Error::ReadingTangents);
         if (!read_indices(file)) return set_error_state(Error::ReadingIndices);
+        if (!read_guides(file)) return set_error_state(Error::ReadingGuides);
+        if (!read_position_thickness(file)) return set_error_state(Error::ReadingPositionThickness);
+        if (!read_clusters(file)) return set_error_state(Error::ReadingClusters);
+
+        if (!format_is_valid()) return set_error_state(Error::InvalidFormat);
+
+        return set_error_state(Error::None);
+    }
+
+    bool HairStyle::map(const std::string& file_path) {
+        memory_map = std::make_shared<MemoryMap>(file_path);
+        this->file_path = file_path;
+
+        if (!*memory_map) {
+            memory_map.reset();
+            return set_error_state(Error::OpeningFile);
+        }
+
+        if (memory_map->get_size() < sizeof(FileHeader)) {
+            memory_map.reset();
+            return set_error_state(Error::ReadingFileHeader);
+        }
+
+        std::memcpy(&file_header, memory_map->get_data(), sizeof(FileHeader));
+
+        if (!valid_signature()) {
+            memory_map.reset();
+            return set_error_state(Error::InvalidSignature);
+        }
+
+        if (is_compressed() || !file_header.field.aligned) {
+            memory_map.reset();
+            return load(file_path);
+        }
+
+        segments.clear();     segments.shrink_to_fit();
+        vertices.clear();     vertices.shrink_to_fit();
+        thickness.clear();    thickness.shrink_to_fit();
+        transparency.clear(); transparency.shrink_to_fit();
+        color.clear();        color.shrink_to_fit();
+        tangents.clear();     tangents.shrink_to_fit();
+        indices.clear();      indices.shrink_to_fit();
+        guides.clear();       guides.shrink_to_fit();
+        position_thickness.clear(); position_thickness.shrink_to_fit();
+        clusters.clear();     clusters.shrink_to_fit();
+
+        const auto& field = file_header.field;
+        std::size_t offset { sizeof(FileHeader) };
+        std::size_t index_count = (file_header.vertex_count - file_header.strand_count) * 2;
+
+        if (!map_field(offset, field.has_segments, file_header.strand_count, mapped_segments))
+            return set_error_state(Error::ReadingSegments);
+        if (!map_field(offset, field.has_vertices, file_header.vertex_count, mapped_vertices))
+            return set_error_state(Error::ReadingVertices);
+        if (!map_field(offset, field.has_thickness, file_header.vertex_count, mapped_thickness))
+            return set_error_state(Error::ReadingThickness);
+        if (!map_field(offset, field.has_transparency, file_header.vertex_count, mapped_transparency))
+            return set_error_state(Error::ReadingTransparency);
+        if (!map_field(offset, field.has_color, file_header.vertex_count, mapped_color))
+            return set_error_state(Error::ReadingColor);
+        if (!map_field(offset, field.has_tangents, file_header.vertex_count, mapped_tangents))
+            return set_error_state(Error::ReadingTangents);
+        if (!map_field(offset, field.has_indices, index_count, mapped_indices))
+            return set_error_state(Error::ReadingIndices);
+        if (!map_field(offset, field.has_guides, file_header.strand_count, mapped_guides))
+            return set_error_state(Error::ReadingGuides);
+        if (!map_field(offset, field.has_position_thickness, file_header.vertex_count, mapped_position_thickness))
+            return set_error_state(Error::ReadingPositionThickness);
+        if (!map_field(offset, field.has_clusters, file_header.strand_count, mapped_clusters))
+            return set_error_state(Error::ReadingClusters);
 
         if (!format_is_valid()) return set_error_state(Error::InvalidFormat);
 
         return set_error_state(Error::None);
     }
 
-    bool HairStyle::save(const std::string& file_path) const {
+    bool HairStyle::is_mapped() const {
+        return memory_map != nullptr;
+    }
+
+    bool HairStyle::release_host_arrays() {
+        if (!is_mapped()) {
+            auto cache_path = get_cache_path(file_path);
+            if (!cache_is_current(cache_path, file_path))
+                return false;
+
+            HairStyle mapped_style;
+            if (!mapped_style.map(cache_path) || !mapped_style.is_mapped())
+                return false; // e.g. a compressed one, which is loaded.
+
+            mapped_style.set_file_path(file_path);
+            *this = std::move(mapped_style);
+        }
+
+        memory_map->evict();
+
+        return true;
+    }
+
+    void HairStyle::unmap() {
+        if (!is_mapped()) return;
+
+        segments.assign(mapped_segments.begin(), mapped_segments.end());
+        vertices.assign(mapped_vertices.begin(), mapped_vertices.end());
+        thickness.assign(mapped_thickness.begin(), mapped_thickness.end());
+        transparency.assign(mapped_transparency.begin(), mapped_transparency.end());
+        color.assign(mapped_color.begin(), mapped_color.end());
+        tangents.assign(mapped_tangents.begin(), mapped_tangents.end());
+        indices.assign(mapped_indices.begin(), mapped_indices.end());
+        guides.assign(mapped_guides.begin(), mapped_guides.end());
+        position_thickness.assign(mapped_position_thickness.begin(), mapped_position_thickness.end());
+        clusters.assign(mapped_clusters.begin(), mapped_clusters.end());
+
+        mapped_segments = {  };
+        mapped_vertices = {  };
+        mapped_thickness = {  };
+        mapped_transparency = {  };
+        mapped_color = {  };
+        mapped_tangents = {  };
+        mapped_indices = {  };
+        mapped_guides = {  };
+        mapped_position_thickness = {  };
+        mapped_clusters = {  };
+
+        memory_map.reset();
+    }
+
+    bool HairStyle::save(const std::string& file_path, bool compressed) const {
         complete_header(); // Fill in remaining header fields.
 
+        file_header.signature[3] = compressed ? 'Z' : 'R';
+        file_header.field.compressed = compressed;
+        file_header.field.aligned = !compressed;
+
         if (!format_is_valid()) return set_error_state(Error::InvalidFormat);
 
         std::ofstream file { file_path, std::ios::binary };
@@ -56,6 +206,9 @@ namespace vkhr {
         if (!file.write(reinterpret_cast<char*>(&file_header), sizeof(FileHeader)))
             return set_error_state(Error::WritingFileHeader);
 
+        if (compressed)
+            return set_error_state(write_compressed(file));
+
         if (!write_segments(file)) return set_error_state(Error::WritingSegments);
         if (!write_vertices(file)) return set_error_state(Error::WritingVertices);
         if (!write_thickness(file)) return set_error_state(Error::WritingThickness);
@@ -63,6 +216,9 @@ namespace vkhr {
         if (!write_color(file)) return set_error_state(Error::WritingColor);
         if (!write_tangents(file)) return set_error_state(Error::WritingTangents);
         if (!write_indices(file)) return set_error_state(Error::WritingIndices);
+        if (!write_guides(file)) return set_error_state(Error::WritingGuides);
+        if (!write_position_thickness(file)) return set_error_state(Error::WritingPositionThickness);
+        if (!write_clusters(file)) return set_error_state(Error::WritingClusters);
 
         // Signature is already set, so we don't need to check for validity.
 
@@ -70,8 +226,8 @@ namespace vkhr {
     }
 
     unsigned HairStyle::get_strand_count() const {
-        if (segments.size() != 0) {
-            return static_cast<unsigned>(segments.size());
+        if (has_segments()) {
+            return static_cast<unsigned>(get_segment_span().size());
         } else {
             // Use the manually defined one.
             return file_header.strand_count;
@@ -87,16 +243,19 @@ namespace vkhr {
     }
 
     unsigned HairStyle::get_vertex_count() const {
-        return static_cast<unsigned>(vertices.size());
+        return static_cast<unsigned>(get_vertex_span().size());
     }
 
-    bool HairStyle::has_segments() const { return segments.size(); }
-    bool HairStyle::has_vertices() const { return vertices.size(); }
-    bool HairStyle::has_thickness() const { return thickness.size(); }
-    bool HairStyle::has_transparency() const { return transparency.size(); }
-    bool HairStyle::has_color() const { return color.size(); }
-    bool HairStyle::has_tangents() const { return tangents.size(); }
-    bool HairStyle::has_indices() const { return indices.size(); }
+    bool HairStyle::has_segments() const { return get_segment_span().size(); }
+    bool HairStyle::has_vertices() const { return get_vertex_span().size(); }
+    bool HairStyle::has_thickness() const { return get_thickness_span().size(); }
+    bool HairStyle::has_transparency() const { return get_transparency_span().size(); }
+    bool HairStyle::has_color() const { return get_color_span().size(); }
+    bool HairStyle::has_tangents() const { return get_tangent_span().size(); }
+    bool HairStyle::has_indices() const { return get_index_span().size(); }
+    bool HairStyle::has_guides() const { return get_guide_span().size(); }
+    bool HairStyle::has_position_thickness() const { return get_position_thickness_span().size(); }
+    bool HairStyle::has_clusters() const { return get_cluster_span().size(); }
 
     // Pre-generated AABB for the hair styles.
     bool HairStyle::has_bounding_box() const {
@@ -141,6 +300,39 @@ namespace vkhr {
                            file_header.default_color[2] };
     }
 
+    const std::string& HairStyle::get_file_path() const {
+        return file_path;
+    }
+
+    void HairStyle::set_file_path(const std::string& file_path) {
+        this->file_path = file_path;
+    }
+
+    std::string HairStyle::get_ambient_occlusion_path() const {
+        return file_path + ".ao";
+    }
+
+    std::string HairStyle::get_impostor_path() const {
+        return file_path + ".impostor";
+    }
+
+    std::string HairStyle::get_cache_path(const std::string& file_path) {
+        return file_path + ".v" + std::to_string(CacheVersion) + ".cache";
+    }
+
+    std::string HairStyle::get_volume_cache_path() const {
+        return file_path + ".v" + std::to_string(CacheVersion) + ".volume";
+    }
+
+    bool HairStyle::cache_is_current(const std::string& cache_path, const std::string& file_path) {
+        std::error_code error;
+        auto cache_time = std::filesystem::last_write_time(cache_path, error);
+        if (error) return false;
+        auto file_time = std::filesystem::last_write_time(file_path, error);
+        if (error) return false;
+        return cache_time >= file_time;
+    }
+
     const char* HairStyle::get_information() const {
         return file_header.information;
     }
@@ -153,76 +345,134 @@ namespace vkhr {
     }
 
     void HairStyle::generate_thickness(float radius) {
-        thickness.clear();
-        thickness.reserve(get_vertex_count());
+        unmap();
+        position_thickness.clear(); // of the old vertices.
 
-        for (std::size_t strand { 0 }; strand < get_strand_count(); ++strand) {
-            unsigned segment_count { get_default_segment_count() };
+        auto strand_offsets = create_strand_offsets();
 
-            if (has_segments()) segment_count = segments[strand];
-
-            for (std::size_t segment { 0 }; segment < segment_count; ++segment)
-                thickness.push_back(radius);
+        thickness.assign(strand_offsets.back(), radius);
 
-            thickness.push_back(0);
-        }
+        // The tips are zero, so the strands taper off.
+        JobSystem::get().parallel_for(0, static_cast<int>(strand_offsets.size() - 1), 1024, [&](int strand) {
+            thickness[strand_offsets[strand + 1] - 1] = 0.0f;
+        });
     }
 
     void HairStyle::generate_tangents() {
-        tangents.clear();
-        tangents.reserve(get_vertex_count());
+        unmap();
 
-        std::size_t vertex { 0 };
+        auto strand_offsets = create_strand_offsets();
 
-        for (std::size_t strand { 0 }; strand < get_strand_count(); ++strand) {
-            unsigned segment_count { get_default_segment_count() };
+        tangents.resize(strand_offsets.back());
 
-            if (has_segments()) segment_count = segments[strand];
+        const auto* positions = vertices.data();
+        auto* strand_tangents = tangents.data();
+
+        // The strands are independent of each other, and within one it's a plain loop over arrays.
+        JobSystem::get().parallel_for(0, static_cast<int>(strand_offsets.size() - 1), 256, [&](int strand) {
+            std::size_t first_vertex { strand_offsets[strand] },
+                        last_vertex  { strand_offsets[strand + 1] - 1 };
 
-            for (std::size_t segment { 0 }; segment < segment_count; ++segment) {
-                const auto& current_vertex { vertices[vertex + 0] };
-                const auto& next_vertex    { vertices[vertex + 1] };
-                const auto tangent { next_vertex - current_vertex };
+            for (std::size_t vertex { first_vertex }; vertex < last_vertex; ++vertex)
+                strand_tangents[vertex] = glm::normalize(positions[vertex + 1] - positions[vertex]);
 
-                tangents.push_back(glm::normalize(tangent));
-                ++vertex;
+            // Special: the last one doesn't have a next vertex, so it's the one before it.
+            strand_tangents[last_vertex] = last_vertex > first_vertex ? strand_tangents[last_vertex - 1] : glm::vec3 { 0.0f };
+        });
+    }
+
+    void HairStyle::generate_indices() {
+        unmap();
+
+        auto strand_offsets = create_strand_offsets();
+        auto strand_count = strand_offsets.size() - 1;
+
+        indices.resize((strand_offsets.back() - strand_count) * 2);
+
+        auto* segment_indices = indices.data();
+
+        // A strand's first segment is its first vertex minus the strands before it (their last ones).
+        JobSystem::get().parallel_for(0, static_cast<int>(strand_count), 256, [&](int strand) {
+            std::size_t first_vertex  { strand_offsets[strand] },
+                        last_vertex   { strand_offsets[strand + 1] - 1 },
+                        first_segment { first_vertex - strand };
+
+            for (std::size_t vertex { first_vertex }; vertex < last_vertex; ++vertex) {
+                auto segment = first_segment + (vertex - first_vertex);
+                segment_indices[2*segment + 0] = static_cast<unsigned>(vertex + 0);
+                segment_indices[2*segment + 1] = static_cast<unsigned>(vertex + 1);
             }
+        });
+    }
 
-            tangents.push_back(tangents.back()); // Special:
-            ++vertex; // must derive tangents from previous.
+    std::vector<std::size_t> HairStyle::create_strand_offsets() const {
+        auto segments = get_segment_span();
+        auto strand_count = get_strand_count();
+
+        std::vector<std::size_t> strand_offsets(strand_count + 1);
+        strand_offsets[0] = 0;
+
+        for (std::size_t strand { 0 }; strand < strand_count; ++strand) {
+            unsigned segment_count { get_default_segment_count() };
+            if (has_segments()) segment_count = segments[strand];
+            strand_offsets[strand + 1] = strand_offsets[strand] + segment_count + 1;
         }
+
+        return strand_offsets;
     }
 
-    void HairStyle::generate_indices() {
-        indices.clear();
-        indices.reserve(get_segment_count() * 2);
+    std::vector<unsigned> HairStyle::create_strip_indices() const {
+        auto segments = get_segment_span();
 
-        std::size_t vertex { 0 };
+        std::vector<unsigned> strips;
+        strips.reserve(get_vertex_count() + get_strand_count());
+
+        unsigned vertex { 0 };
         for (std::size_t strand { 0 }; strand < get_strand_count(); ++strand) {
             unsigned segment_count { get_default_segment_count() };
 
-            if (has_segments()) segment_count = this->segments[strand];
+            if (has_segments()) segment_count = segments[strand];
 
-            for (std::size_t segment { 0 }; segment < segment_count; ++segment) {
-                indices.push_back(static_cast<unsigned>(vertex++));
-                indices.push_back(static_cast<unsigned>(vertex));
-            }
+            for (unsigned i { 0 }; i <= segment_count; ++i)
+                strips.push_back(vertex++);
 
-            ++vertex; // Skips the last one.
+            strips.push_back(RestartIndex);
         }
+
+        return strips;
     }
 
     void HairStyle::generate_bounding_box() {
+        auto positions = get_vertex_span();
+
+        // Reduced per chunk in parallel, and then those in order, since the loops don't have min and
+        // max reductions. The bounds start out at the origin, so it's always inside of them.
+        constexpr int Chunks { 256 };
+        std::vector<glm::vec3> min_chunks(Chunks, glm::vec3 { 0.0f }),
+                               max_chunks(Chunks, glm::vec3 { 0.0f });
+
+        std::size_t chunk_size { (positions.size() + Chunks - 1) / Chunks };
+
+        JobSystem::get().parallel_for(0, Chunks, 1, [&](int chunk) {
+            auto first = std::min(chunk * chunk_size, positions.size());
+            auto last  = std::min(first + chunk_size, positions.size());
+
+            glm::vec3 chunk_min { 0.0f }, chunk_max { 0.0f };
+            for (auto vertex = first; vertex < last; ++vertex) {
+                chunk_min = glm::min(chunk_min, positions[vertex]);
+                chunk_max = glm::max(chunk_max, positions[vertex]);
+            }
+
+            min_chunks[chunk] = chunk_min;
+            max_chunks[chunk] = chunk_max;
+        });
+
         glm::vec3 min_aabb { 0.0f, 0.0f, 0.0f },
                   max_aabb { 0.0f, 0.0f, 0.0f };
 
-        for (const auto& position : vertices) {
-            min_aabb.x = glm::min(position.x, min_aabb.x);
-            min_aabb.y = glm::min(position.y, min_aabb.y);
-            min_aabb.z = glm::min(position.z, min_aabb.z);
-            max_aabb.x = glm::max(position.x, max_aabb.x);
-            max_aabb.y = glm::max(position.y, max_aabb.y);
-            max_aabb.z = glm::max(position.z, max_aabb.z);
+        for (int chunk { 0 }; chunk < Chunks; ++chunk) {
+            min_aabb = glm::min(min_aabb, min_chunks[chunk]);
+            max_aabb = glm::max(max_aabb, max_chunks[chunk]);
         }
 
         std::memcpy(&file_header.bounding_box_min[0],
@@ -254,6 +504,120 @@ namespace vkhr {
         };
     }
 
+    HairStyle::Quantization HairStyle::get_quantization() const {
+        return static_cast<Quantization>(file_header.field.quantization);
+    }
+
+    void HairStyle::set_quantization(const Quantization quantization) {
+        file_header.field.quantization = static_cast<unsigned>(quantization);
+        if (quantization == Quantization::Packed)
+            update_quantized_thickness();
+    }
+
+    float HairStyle::get_quantized_thickness() const {
+        if (get_quantization() != Quantization::Packed)
+            update_quantized_thickness(); // or it's the one it was saved with.
+        return file_header.quantized_thickness;
+    }
+
+    // Octahedral mapping of the unit direction, folding the lower hemisphere (zero stays at zero).
+    static glm::vec2 encode_octahedron(const glm::vec3& direction) {
+        float length { glm::compAdd(glm::abs(direction)) };
+        if (length == 0.0f) return glm::vec2 { 0.0f };
+
+        glm::vec3 unit { direction / length };
+        glm::vec2 octahedron { unit.x, unit.y };
+        if (unit.z < 0.0f) {
+            octahedron = (1.0f - glm::abs(glm::vec2 { unit.y, unit.x })) *
+                         glm::vec2 { unit.x >= 0.0f ? 1.0f : -1.0f,
+                                     unit.y >= 0.0f ? 1.0f : -1.0f };
+        }
+
+        return glm::clamp(octahedron, -1.0f, 1.0f);
+    }
+
+    std::vector<HairStyle::QuantizedVertex> HairStyle::create_quantized_data() const {
+        std::vector<QuantizedVertex> quantized_vertices(get_vertex_count());
+
+        auto vertices  = get_vertex_span();
+        auto tangents  = get_tangent_span();
+        auto thickness = get_thickness_span();
+
+        auto bounds = get_bounding_box();
+        glm::vec3 scale { 1.0f / glm::max(bounds.size, glm::vec3 { 1e-6f }) };
+        float thickness_scale { 1.0f / get_quantized_thickness() };
+
+        JobSystem::get().parallel_for(0, static_cast<int>(get_vertex_count()), 1024, [&](int i) {
+            float radius { 0.042f };
+            if (has_thickness())
+                radius = thickness[i];
+
+            // Thickness is relative to the thickest vertex, see decode_strand_thickness.
+            glm::vec4 position_thickness { (vertices[i] - bounds.origin) * scale, radius * thickness_scale };
+            position_thickness = glm::clamp(position_thickness, 0.0f, 1.0f) * 65535.0f;
+
+            quantized_vertices[i].position_thickness = glm::u16vec4 { glm::round(position_thickness) };
+            quantized_vertices[i].tangent = glm::i16vec2 { glm::round(encode_octahedron(tangents[i]) * 32767.0f) };
+        });
+
+        return quantized_vertices;
+    }
+
+    std::vector<HairStyle::SegmentCluster> HairStyle::create_segment_clusters(std::size_t cluster_size) const {
+        auto indices  = get_index_span();
+        auto vertices = get_vertex_span();
+
+        std::size_t segment_count = indices.size() / 2;
+        std::vector<SegmentCluster> clusters((segment_count + cluster_size - 1) / cluster_size);
+
+        JobSystem::get().parallel_for(0, static_cast<int>(clusters.size()), 1, [&](int i) {
+            std::size_t first_segment = i * cluster_size;
+            std::size_t last_segment  = std::min(first_segment + cluster_size, segment_count);
+
+            glm::vec3 lower { std::numeric_limits<float>::max() };
+            glm::vec3 upper { std::numeric_limits<float>::lowest() };
+
+            for (std::size_t segment = first_segment; segment < last_segment; ++segment) {
+                for (std::size_t j = 0; j < 2; ++j) {
+                    lower = glm::min(lower, vertices[indices[2*segment + j]]);
+                    upper = glm::max(upper, vertices[indices[2*segment + j]]);
+                }
+            }
+
+            clusters[i].lower = lower;
+            clusters[i].upper = upper;
+            clusters[i].first_segment = static_cast<std::uint32_t>(first_segment);
+            clusters[i].segment_count = static_cast<std::uint32_t>(last_segment - first_segment);
+        });
+
+        return clusters;
+    }
+
+    std::vector<unsigned> HairStyle::create_curve_patches() const {
+        auto indices = get_index_span();
+
+        std::size_t segment_count = indices.size() / 2;
+        std::vector<unsigned> patches(segment_count * 4);
+
+        JobSystem::get().parallel_for(0, static_cast<int>(segment_count), 1024, [&](int i) {
+            std::size_t segment = i;
+
+            unsigned start = indices[2*segment + 0],
+                     end   = indices[2*segment + 1];
+
+            // Segments of the same strand share their end vertex.
+            bool has_previous = segment != 0 && indices[2*segment - 1] == start;
+            bool has_next     = segment + 1 < segment_count && indices[2*segment + 2] == end;
+
+            patches[4*segment + 0] = has_previous ? indices[2*segment - 2] : start;
+            patches[4*segment + 1] = start;
+            patches[4*segment + 2] = end;
+            patches[4*segment + 3] = has_next ? indices[2*segment + 3] : end;
+        });
+
+        return patches;
+    }
+
     HairStyle::Volume HairStyle::voxelize_vertices(std::size_t width, std::size_t height, std::size_t depth) const {
         Volume volume {
             {
@@ -267,7 +631,10 @@ namespace vkhr {
         volume.densities.resize(width * height * depth, 0); // ~ 16MiBs.
         glm::vec3 voxel_size { volume.bounds.size / volume.resolution };
 
-        std::vector<glm::vec3> precise_tangents(width * height * depth);
+        LargeBuffer<glm::vec3> precise_tangents(width * height * depth);
+
+        auto vertices = get_vertex_span();
+        auto tangents = get_tangent_span();
 
         for (unsigned int i { 0 }; i < get_vertex_count(); ++i) {
             auto& vertex = vertices[i];
@@ -280,65 +647,171 @@ namespace vkhr {
             }
         }
 
-        volume.tangents.resize(width * height * depth, glm::i8vec4 { 0, 0, 0, 0 });
+        volume.tangents.resize(width * height * depth, glm::i8vec2 { 0, 0 });
 
-        #pragma omp parallel for schedule(dynamic)
-        for (int i = 0; i < volume.densities.size(); ++i) {
-            glm::i8vec3 quantized  = precise_tangents[i] / static_cast<float>(volume.densities[i]) * 127.0f;
-            volume.tangents[i].x   = quantized.x;
-            volume.tangents[i].y   = quantized.y;
-            volume.tangents[i].z   = quantized.z;
-        }
+        JobSystem::get().parallel_for(0, static_cast<int>(volume.densities.size()), 4096, [&](int i) {
+            volume.tangents[i] = glm::i8vec2 { glm::round(encode_octahedron(precise_tangents[i]) * 127.0f) };
+        });
 
         return volume;
     }
 
-    HairStyle::Volume HairStyle::voxelize_segments(std::size_t width, std::size_t height, std::size_t depth) const {
-        Volume volume {
-            {
-                width,
-                height,
-                depth
-            },
-            get_bounding_box()
-        };
+    HairStyle::Volume HairStyle::voxelize_segments(std::size_t width, std::size_t height, std::size_t depth,
+                                                   Volume::Layout layout) const {
+        Volume volume;
+        voxelize_segments(volume, width, height, depth, layout);
+        volume.precise_tangents = LargeBuffer<glm::vec3> { }; // since it's not voxelized again.
+        return volume;
+    }
 
-        volume.densities.resize(width * height * depth, 0); // ~ 16MiBs.
+    void HairStyle::voxelize_segments(Volume& volume, std::size_t width, std::size_t height, std::size_t depth,
+                                      Volume::Layout layout) const {
+        volume.resolution = glm::vec3 { width, height, depth };
+        volume.bounds = get_bounding_box();
+
+        // With nothing in it yet, so this only checks if the resolution can be in the layout.
+        volume.densities.clear();
+        volume.tangents.clear();
+        volume.layout = Volume::Layout::Linear;
+        volume.set_layout(layout);
+
+        // Re-uses the storage if the volume was voxelized before.
+        volume.densities.assign(width * height * depth, 0); // ~ 16MiBs.
         glm::vec3 voxel_size { volume.bounds.size / volume.resolution };
 
-        std::vector<glm::vec3> precise_tangents(width * height * depth);
+        // Sized once here, before any of the threads below write or read into it.
+        auto& precise_tangents = volume.precise_tangents;
+        precise_tangents.assign(width * height * depth, glm::vec3 { 0.0f });
 
-        for (std::size_t i { 0 }; i < indices.size() - 1; i += 2) {
-            auto root { (vertices[indices[i]]     - volume.bounds.origin) / voxel_size };
-            auto tip  { (vertices[indices[i + 1]] - volume.bounds.origin) / voxel_size };
+        auto vertices = get_vertex_span();
+        auto tangents = get_tangent_span();
+        auto indices  = get_index_span();
 
-            auto direction { tip - root };
-            float steps { glm::compMax(glm::abs(direction)) };
-            direction /= steps; // [-1, 1]
+        // Each thread owns a slab of depth slices and only writes voxels inside it.
+        // Within a slab segments are visited in order, so results are deterministic
+        // and match the serial voxelization exactly (even when densities saturate).
+        constexpr int SlabDepth { 4 };
 
-            while (steps-- > 0.0f) {
-                auto voxel = glm::min(glm::floor(root), volume.resolution-1.0f);
-                int voxel_index = voxel.x + voxel.y*width + voxel.z*width*height;
-                if (volume.densities[voxel_index] != 255) {
-                    precise_tangents[voxel_index] += tangents[indices[i]];
-                    volume.densities[voxel_index] += 1;
-                }
+        const int slab_count = static_cast<int>((depth + SlabDepth - 1) / SlabDepth);
+        const float max_slice = static_cast<float>(depth) - 1.0f;
 
-                root += direction; // Move to the voxel we're going to rasterize.
-            }
+        const std::size_t segment_count { indices.size() / 2 };
+
+        // Conservative, the walk below never leaves the [root, tip] interval.
+        auto get_slabs = [&](std::size_t segment, int& first_slab, int& last_slab) {
+            float root_slice = (vertices[indices[2*segment + 0]].z - volume.bounds.origin.z) / voxel_size.z;
+            float tip_slice  = (vertices[indices[2*segment + 1]].z - volume.bounds.origin.z) / voxel_size.z;
+            float lowest_slice  = glm::clamp(glm::floor(glm::min(root_slice, tip_slice)) - 1.0f, 0.0f, max_slice);
+            float highest_slice = glm::clamp(glm::floor(glm::max(root_slice, tip_slice)) + 1.0f, 0.0f, max_slice);
+            first_slab = static_cast<int>(lowest_slice)  / SlabDepth;
+            last_slab  = static_cast<int>(highest_slice) / SlabDepth;
+        };
+
+        // Counting sorts the segments into the (usually one or two) slabs they might touch, so
+        // each slab only walks its own. They stay in segment order within a slab's own range.
+        std::vector<std::size_t> slab_offsets(slab_count + 1, 0);
+        for (std::size_t segment { 0 }; segment < segment_count; ++segment) {
+            int first_slab, last_slab;
+            get_slabs(segment, first_slab, last_slab);
+            for (int slab { first_slab }; slab <= last_slab; ++slab)
+                ++slab_offsets[slab + 1];
         }
 
-        volume.tangents.resize(width * height * depth, glm::i8vec4 { 0, 0, 0, 0 });
+        std::partial_sum(slab_offsets.begin(), slab_offsets.end(), slab_offsets.begin());
 
-        #pragma omp parallel for schedule(dynamic)
-        for (int i = 0; i < volume.densities.size(); ++i) {
-            glm::i8vec3 quantized  = precise_tangents[i] / static_cast<float>(volume.densities[i]) * 127.0f;
-            volume.tangents[i].x   = quantized.x;
-            volume.tangents[i].y   = quantized.y;
-            volume.tangents[i].z   = quantized.z;
+        std::vector<unsigned> slab_segments(slab_offsets.back());
+        std::vector<std::size_t> slab_ends(slab_offsets.begin(), slab_offsets.end() - 1);
+        for (std::size_t segment { 0 }; segment < segment_count; ++segment) {
+            int first_slab, last_slab;
+            get_slabs(segment, first_slab, last_slab);
+            for (int slab { first_slab }; slab <= last_slab; ++slab)
+                slab_segments[slab_ends[slab]++] = static_cast<unsigned>(segment);
         }
 
-        return volume;
+        JobSystem::get().parallel_for(0, slab_count, 1, [&](int slab) {
+            const float slab_start = static_cast<float>(slab * SlabDepth);
+            const float slab_end   = slab_start + SlabDepth;
+
+            for (std::size_t s { slab_offsets[slab] }; s < slab_offsets[slab + 1]; ++s) {
+                std::size_t i { 2 * static_cast<std::size_t>(slab_segments[s]) };
+
+                auto root { (vertices[indices[i]]     - volume.bounds.origin) / voxel_size };
+                auto tip  { (vertices[indices[i + 1]] - volume.bounds.origin) / voxel_size };
+
+                auto direction { tip - root };
+                float steps { glm::compMax(glm::abs(direction)) };
+                direction /= steps; // [-1, 1]
+
+                while (steps-- > 0.0f) {
+                    auto voxel = glm::min(glm::floor(root), volume.resolution-1.0f);
+
+                    if (voxel.z >= slab_start && voxel.z < slab_end) {
+                        auto voxel_index = volume.get_index(glm::uvec3 { voxel });
+                        if (volume.densities[voxel_index] != 255) {
+                            precise_tangents[voxel_index] += tangents[indices[i]];
+                            volume.densities[voxel_index] += 1;
+                        }
+                    }
+
+                    root += direction; // Move to the voxel we're going to rasterize.
+                }
+            }
+        });
+
+        volume.tangents.assign(width * height * depth, glm::i8vec2 { 0, 0 });
+
+        // The mean direction, since the octahedron only keeps it, and not how much the tangents agree.
+        JobSystem::get().parallel_for(0, static_cast<int>(volume.densities.size()), 4096, [&](int i) {
+            volume.tangents[i] = glm::i8vec2 { glm::round(encode_octahedron(precise_tangents[i]) * 127.0f) };
+        });
+    }
+
+    bool HairStyle::Volume::set_layout(Layout new_layout) {
+        if (new_layout == layout)
+            return true;
+
+        glm::uvec3 grid { resolution };
+
+        if (new_layout == Layout::Bricked && (grid.x % BrickSize || grid.y % BrickSize || grid.z % BrickSize))
+            return false;
+
+        glm::uvec3 bricks { grid / BrickSize };
+
+        // The BrickSize runs along x are contiguous in both, so it's copied one of them at a time.
+        auto swizzle = [&](auto& voxels) {
+            if (voxels.empty())
+                return;
+
+            std::remove_reference_t<decltype(voxels)> swizzled(voxels.size());
+
+            JobSystem::get().parallel_for(0, static_cast<int>(bricks.y * bricks.z), 1, [&](int brick_row) {
+                for (unsigned x { 0 }; x < bricks.x; ++x) {
+                    glm::uvec3 brick { x, brick_row % bricks.y, brick_row / bricks.y };
+                    std::size_t brick_start = (x + brick_row * static_cast<std::size_t>(bricks.x)) * BrickSize*BrickSize*BrickSize;
+
+                    for (unsigned k { 0 }; k < BrickSize; ++k)
+                    for (unsigned j { 0 }; j < BrickSize; ++j) {
+                        glm::uvec3 voxel { brick * BrickSize + glm::uvec3 { 0, j, k } };
+                        std::size_t linear  = voxel.x + voxel.y*grid.x + voxel.z*static_cast<std::size_t>(grid.x)*grid.y;
+                        std::size_t bricked = brick_start + j*BrickSize + k*BrickSize*BrickSize;
+
+                        if (new_layout == Layout::Bricked)
+                            std::copy_n(voxels.begin() + linear, BrickSize, swizzled.begin() + bricked);
+                        else
+                            std::copy_n(voxels.begin() + bricked, BrickSize, swizzled.begin() + linear);
+                    }
+                }
+            });
+
+            voxels.swap(swizzled);
+        };
+
+        swizzle(densities);
+        swizzle(tangents);
+
+        layout = new_layout;
+
+        return true;
     }
 
     void HairStyle::Volume::normalize() {
@@ -357,6 +830,12 @@ namespace vkhr {
     }
 
     bool HairStyle::Volume::save(const std::string& file_path) {
+        if (layout != Layout::Linear) {
+            auto linear_volume = *this;
+            linear_volume.set_layout(Layout::Linear);
+            return linear_volume.save(file_path);
+        }
+
         std::ofstream file { file_path, std::ios::binary };
         if (!file) return false; // Couldn't write to file.
 
@@ -365,23 +844,215 @@ namespace vkhr {
                         densities.size() * sizeof(densities[0])))
             return false;
 
+        if (!file.write(reinterpret_cast<const char*>(tangents.data()),
+                        tangents.size() * sizeof(tangents[0])))
+            return false;
+
         return true;
     }
 
+    bool HairStyle::Volume::load(const std::string& file_path) {
+        std::ifstream file { file_path, std::ios::binary };
+        if (!file) return false; // Hasn't been baked yet.
+
+        layout = Layout::Linear;
+
+        densities.resize(resolution.x * resolution.y * resolution.z);
+
+        if (!file.read(reinterpret_cast<char*>(densities.data()),
+                       densities.size() * sizeof(densities[0])))
+            return false;
+
+        tangents.clear(); // only some of the volumes have them.
+
+        if (file.peek() != std::ifstream::traits_type::eof()) {
+            tangents.resize(densities.size());
+            if (!file.read(reinterpret_cast<char*>(tangents.data()),
+                           tangents.size() * sizeof(tangents[0])))
+                return false;
+        }
+
+        // Isn't of the same resolution, i.e. too big.
+        if (file.peek() != std::ifstream::traits_type::eof())
+            return false;
+
+        return true;
+    }
+
+    bool HairStyle::Impostor::save(const std::string& file_path) const {
+        return occlusion.save(file_path + ".png") && tangents.save(file_path + ".tangents.png");
+    }
+
+    bool HairStyle::Impostor::load(const std::string& file_path) {
+        if (!occlusion.load(file_path + ".png") || !tangents.load(file_path + ".tangents.png"))
+            return false; // Hasn't been baked yet.
+
+        // Both have the same square of views.
+        return occlusion.get_width()  == tangents.get_width()  &&
+               occlusion.get_height() == tangents.get_height() &&
+               occlusion.get_width()  == occlusion.get_height() &&
+               occlusion.get_width() % views == 0;
+    }
+
+    // Same octahedron as the quantized tangents (see impostor.glsl), but at the centers of the views.
+    glm::vec3 HairStyle::Impostor::get_view_direction(unsigned view_x, unsigned view_y, unsigned views) {
+        glm::vec2 octahedron { (glm::vec2 { view_x, view_y } + 0.5f) / static_cast<float>(views) * 2.0f - 1.0f };
+        glm::vec3 direction { octahedron, 1.0f - std::abs(octahedron.x) - std::abs(octahedron.y) };
+        if (direction.z < 0.0f)
+            direction = glm::vec3 { (1.0f - glm::abs(glm::vec2 { direction.y, direction.x })) *
+                                    glm::vec2 { direction.x >= 0.0f ? 1.0f : -1.0f,
+                                                direction.y >= 0.0f ? 1.0f : -1.0f }, direction.z };
+        return glm::normalize(direction);
+    }
+
+    void HairStyle::Impostor::get_view_axes(const glm::vec3& direction, glm::vec3& right, glm::vec3& up) {
+        glm::vec3 upward { 0.0f, 1.0f, 0.0f };
+        if (std::abs(direction.y) > 0.999f)
+            upward = glm::vec3 { 0.0f, 0.0f, 1.0f }; // looking straight down.
+        right = glm::normalize(glm::cross(upward, direction));
+        up    = glm::cross(direction, right);
+    }
+
     void HairStyle::shuffle() {
         reduce(1.0f);
     }
 
+    // Spreads the lower 10 bits of x into every third bit, so that three of them can be interleaved.
+    static std::uint32_t part_by_two(std::uint32_t x) {
+        x &= 0x000003ff;
+        x = (x ^ (x << 16)) & 0xff0000ff;
+        x = (x ^ (x <<  8)) & 0x0300f00f;
+        x = (x ^ (x <<  4)) & 0x030c30c3;
+        x = (x ^ (x <<  2)) & 0x09249249;
+        return x;
+    }
+
+    void HairStyle::sort_strands(std::size_t cluster_size) {
+        unmap();
+        position_thickness.clear(); // of the old vertices.
+
+        std::size_t strand_count = get_strand_count();
+        if (strand_count == 0 || cluster_size == 0)
+            return;
+
+        std::vector<std::size_t> strand_offset(strand_count);
+        std::vector<unsigned> segment_counts(strand_count);
+
+        glm::vec3 lower { std::numeric_limits<float>::max() };
+        glm::vec3 upper { std::numeric_limits<float>::lowest() };
+
+        std::size_t vertex { 0 };
+        for (std::size_t strand { 0 }; strand < strand_count; ++strand) {
+            segment_counts[strand] = has_segments() ? segments[strand] : get_default_segment_count();
+            strand_offset[strand] = vertex;
+            lower = glm::min(lower, vertices[vertex]);
+            upper = glm::max(upper, vertices[vertex]);
+            vertex += segment_counts[strand] + 1;
+        }
+
+        glm::vec3 extent = glm::max(upper - lower, glm::vec3 { std::numeric_limits<float>::epsilon() });
+
+        std::vector<std::uint32_t> morton_codes(strand_count);
+        for (std::size_t strand { 0 }; strand < strand_count; ++strand) {
+            glm::uvec3 cell { glm::clamp((vertices[strand_offset[strand]] - lower) / extent, 0.0f, 1.0f) * 1023.0f };
+            morton_codes[strand] = part_by_two(cell.x) | (part_by_two(cell.y) << 1) | (part_by_two(cell.z) << 2);
+        }
+
+        std::vector<unsigned> strand_order(strand_count);
+        std::iota(strand_order.begin(), strand_order.end(), 0);
+
+        auto random_index = [&](std::size_t count) {
+            double random = xorshift64(&seed) / static_cast<double>(std::numeric_limits<std::uint64_t>::max());
+            return std::min(static_cast<std::size_t>(random * count), count - 1);
+        };
+
+        // The bands end at 1/16, 1/8, 1/4, 1/2 and all of the strands.
+        std::size_t band_start { 0 };
+        for (std::size_t band_divisor : { 16, 8, 4, 2, 1 }) {
+            std::size_t band_end = (strand_count + band_divisor - 1) / band_divisor;
+            if (band_end <= band_start)
+                continue;
+
+            auto first = strand_order.begin() + band_start,
+                 last  = strand_order.begin() + band_end;
+
+            std::stable_sort(first, last, [&](unsigned a, unsigned b) {
+                return morton_codes[a] < morton_codes[b];
+            });
+
+            std::vector<std::vector<unsigned>> clusters;
+            for (auto cluster = first; cluster < last; cluster += std::min<std::size_t>(cluster_size, last - cluster))
+                clusters.emplace_back(cluster, cluster + std::min<std::size_t>(cluster_size, last - cluster));
+
+            // Fisher-Yates, of the clusters and of the strands in them.
+            for (std::size_t i = clusters.size(); i > 1; --i)
+                std::swap(clusters[i - 1], clusters[random_index(i)]);
+
+            for (auto& cluster : clusters) {
+                for (std::size_t i = cluster.size(); i > 1; --i)
+                    std::swap(cluster[i - 1], cluster[random_index(i)]);
+                first = std::copy(cluster.begin(), cluster.end(), first);
+            }
+
+            band_start = band_end;
+        }
+
+        LargeBuffer<unsigned short> sorted_segments;
+        LargeBuffer<glm::vec3> sorted_vertices;
+        LargeBuffer<float> sorted_thickness;
+        LargeBuffer<glm::vec3> sorted_tangents;
+        LargeBuffer<float> sorted_transparency;
+        LargeBuffer<glm::vec3> sorted_color;
+
+        if (has_segments()) sorted_segments.reserve(strand_count);
+        if (has_vertices()) sorted_vertices.reserve(get_vertex_count());
+        if (has_thickness()) sorted_thickness.reserve(get_vertex_count());
+        if (has_tangents()) sorted_tangents.reserve(get_vertex_count());
+        if (has_transparency()) sorted_transparency.reserve(get_vertex_count());
+        if (has_color()) sorted_color.reserve(get_vertex_count());
+
+        for (auto strand : strand_order) {
+            std::size_t attribute_start = strand_offset[strand];
+            auto attribute_end = attribute_start + segment_counts[strand] + 1ul;
+
+            if (has_segments()) sorted_segments.push_back(segments[strand]);
+
+            if (has_vertices()) std::copy(vertices.begin() + attribute_start, vertices.begin() + attribute_end, std::back_inserter(sorted_vertices));
+            if (has_thickness()) std::copy(thickness.begin() + attribute_start, thickness.begin() + attribute_end, std::back_inserter(sorted_thickness));
+            if (has_tangents()) std::copy(tangents.begin() + attribute_start, tangents.begin() + attribute_end, std::back_inserter(sorted_tangents));
+            if (has_transparency()) std::copy(transparency.begin() + attribute_start, transparency.begin() + attribute_end, std::back_inserter(sorted_transparency));
+            if (has_color()) std::copy(color.begin() + attribute_start, color.begin() + attribute_end, std::back_inserter(sorted_color));
+        }
+
+        bool had_indices = has_indices();
+
+        segments = sorted_segments;
+        vertices = sorted_vertices;
+
+        if (had_indices) generate_indices();
+
+        guides.clear(); // the strands were re-ordered.
+        clusters.clear();
+
+        thickness = sorted_thickness;
+        tangents = sorted_tangents;
+        transparency = sorted_transparency;
+        color = sorted_color;
+    }
+
     void HairStyle::reduce(float ratio) {
+        unmap();
+        position_thickness.clear(); // of the old vertices.
+
         unsigned strands_left = get_strand_count() - std::ceil(get_strand_count() * ratio);
         unsigned vertex_count = get_vertex_count() - std::ceil(get_vertex_count() * ratio);
 
-        std::vector<unsigned short> reduced_segments;
-        std::vector<glm::vec3> reduced_vertices;
-        std::vector<float> reduced_thickness;
-        std::vector<glm::vec3> reduced_tangents;
-        std::vector<float> reduced_transparency;
-        std::vector<glm::vec3> reduced_color;
+        LargeBuffer<unsigned short> reduced_segments;
+        LargeBuffer<glm::vec3> reduced_vertices;
+        LargeBuffer<float> reduced_thickness;
+        LargeBuffer<glm::vec3> reduced_tangents;
+        LargeBuffer<float> reduced_transparency;
+        LargeBuffer<glm::vec3> reduced_color;
 
         // Pre-allocate memory to avoid making the re-allocations.
         if (has_segments()) reduced_segments.reserve(strands_left);
@@ -454,104 +1125,399 @@ namespace vkhr {
 
         generate_indices();
 
+        guides.clear(); // the strands were re-ordered.
+        clusters.clear();
+
         thickness = reduced_thickness;
         tangents = reduced_tangents;
         transparency = reduced_transparency;
         color = reduced_color;
     }
 
+    void HairStyle::decimate(unsigned stride) {
+        if (stride <= 1) return;
+
+        unmap();
+        position_thickness.clear(); // of the old vertices.
+
+        bool had_tangents = has_tangents();
+        bool had_indices  = has_indices();
+
+        LargeBuffer<unsigned short> decimated_segments;
+        LargeBuffer<glm::vec3> decimated_vertices;
+        LargeBuffer<float> decimated_thickness;
+        LargeBuffer<float> decimated_transparency;
+        LargeBuffer<glm::vec3> decimated_color;
+
+        std::size_t vertex_count = get_vertex_count() / stride + get_strand_count() * 2;
+
+        if (has_segments()) decimated_segments.reserve(get_strand_count());
+        decimated_vertices.reserve(vertex_count);
+        if (has_thickness()) decimated_thickness.reserve(vertex_count);
+        if (has_transparency()) decimated_transparency.reserve(vertex_count);
+        if (has_color()) decimated_color.reserve(vertex_count);
+
+        std::size_t first_vertex { 0 };
+        for (std::size_t strand { 0 }; strand < get_strand_count(); ++strand) {
+            unsigned segment_count { get_default_segment_count() };
+            if (has_segments()) segment_count = segments[strand];
+
+            unsigned kept_vertices { 0 };
+
+            // The root, every stride vertex after it, and the tip.
+            for (unsigned i { 0 }; i <= segment_count; ++i) {
+                if (i % stride != 0 && i != segment_count)
+                    continue;
+
+                std::size_t vertex = first_vertex + i;
+
+                decimated_vertices.push_back(vertices[vertex]);
+                if (has_thickness()) decimated_thickness.push_back(thickness[vertex]);
+                if (has_transparency()) decimated_transparency.push_back(transparency[vertex]);
+                if (has_color()) decimated_color.push_back(color[vertex]);
+
+                ++kept_vertices;
+            }
+
+            if (has_segments()) decimated_segments.push_back(kept_vertices - 1);
+
+            first_vertex += segment_count + 1;
+        }
+
+        if (!has_segments()) {
+            unsigned segment_count { get_default_segment_count() };
+            set_default_segment_count((segment_count + stride - 1) / stride);
+        }
+
+        segments = decimated_segments;
+        vertices = decimated_vertices;
+        thickness = decimated_thickness;
+        transparency = decimated_transparency;
+        color = decimated_color;
+
+        tangents.clear();
+        indices.clear();
+
+        if (had_tangents) generate_tangents();
+        if (had_indices)  generate_indices();
+    }
+
+    void HairStyle::generate_guides(float ratio) {
+        unmap();
+
+        unsigned strand_count = get_strand_count();
+        unsigned guide_count = std::max(static_cast<unsigned>(std::ceil(strand_count * ratio)), 1u);
+        guide_count = std::min(guide_count, strand_count);
+
+        std::vector<glm::vec3> roots;
+        roots.reserve(strand_count);
+
+        std::size_t vertex { 0 };
+        for (unsigned strand { 0 }; strand < strand_count; ++strand) {
+            roots.push_back(vertices[vertex]);
+            unsigned segment_count { get_default_segment_count() };
+            if (has_segments()) segment_count = segments[strand];
+            vertex += segment_count + 1;
+        }
+
+        guides.resize(strand_count);
+
+        JobSystem::get().parallel_for(0, static_cast<int>(strand_count), 256, [&](int strand) {
+            if (static_cast<unsigned>(strand) < guide_count) {
+                guides[strand] = strand; // follows itself.
+                return;
+            }
+
+            float closest_distance { std::numeric_limits<float>::max() };
+
+            for (unsigned guide { 0 }; guide < guide_count; ++guide) {
+                glm::vec3 offset { roots[strand] - roots[guide] };
+                float distance { glm::dot(offset, offset) };
+                if (distance < closest_distance) {
+                    closest_distance = distance;
+                    guides[strand] = guide;
+                }
+            }
+        });
+    }
+
+    unsigned HairStyle::get_guide_count() const {
+        auto guides = get_guide_span();
+        unsigned guide_count { 0 };
+        while (guide_count < guides.size() && guides[guide_count] == guide_count)
+            ++guide_count;
+        return guide_count;
+    }
+
+    void HairStyle::generate_clusters() {
+        unmap();
+
+        unsigned strand_count = get_strand_count();
+        if (strand_count == 0)
+            return;
+
+        auto strand_offsets = create_strand_offsets();
+
+        std::vector<glm::vec3> roots(strand_count);
+        for (unsigned strand { 0 }; strand < strand_count; ++strand)
+            roots[strand] = vertices[strand_offsets[strand]];
+
+        clusters.resize(strand_count);
+        std::iota(clusters.begin(), clusters.end(), 0u); // the ones before the last cut.
+
+        for (unsigned level { 1 }; level <= ClusterLevels; ++level) {
+            unsigned cut = get_cluster_cut(level);
+            unsigned previous_cut = get_cluster_cut(level - 1);
+
+            // A grid of about one of the roots before the cut per cell, with them sorted by their cell.
+            glm::vec3 lower { std::numeric_limits<float>::max() };
+            glm::vec3 upper { std::numeric_limits<float>::lowest() };
+            for (unsigned strand { 0 }; strand < cut; ++strand) {
+                lower = glm::min(lower, roots[strand]);
+                upper = glm::max(upper, roots[strand]);
+            }
+
+            glm::vec3 extent { glm::max(upper - lower, glm::vec3 { 1e-6f }) };
+            float cell_size = std::cbrt(extent.x * extent.y * extent.z / cut);
+            glm::ivec3 cells { glm::clamp(glm::ivec3 { glm::ceil(extent / cell_size) }, 1, 256) };
+            glm::vec3 cell_extent { extent / glm::vec3 { cells } };
+
+            auto cell_of = [&](const glm::vec3& root) {
+                return glm::clamp(glm::ivec3 { (root - lower) / cell_extent }, glm::ivec3 { 0 }, cells - 1);
+            };
+
+            auto cell_index = [&](const glm::ivec3& cell) {
+                return static_cast<std::size_t>(cell.x + cells.x * (cell.y + cells.y * cell.z));
+            };
+
+            std::vector<unsigned> cell_start(static_cast<std::size_t>(cells.x) * cells.y * cells.z + 1, 0);
+            for (unsigned strand { 0 }; strand < cut; ++strand)
+                ++cell_start[cell_index(cell_of(roots[strand])) + 1];
+            std::partial_sum(cell_start.begin(), cell_start.end(), cell_start.begin());
+
+            std::vector<unsigned> cell_strands(cut);
+            std::vector<unsigned> cell_fill(cell_start.begin(), cell_start.end() - 1);
+            for (unsigned strand { 0 }; strand < cut; ++strand)
+                cell_strands[cell_fill[cell_index(cell_of(roots[strand]))]++] = strand;
+
+            float min_cell_extent = std::min(std::min(cell_extent.x, cell_extent.y), cell_extent.z);
+            int max_ring = std::max(std::max(cells.x, cells.y), cells.z);
+
+            // Searched in rings of cells around the root's cell, until no closer root can be further out.
+            JobSystem::get().parallel_for(cut, static_cast<int>(previous_cut), 256, [&](int strand) {
+                glm::ivec3 center { cell_of(roots[strand]) };
+                float closest_distance { std::numeric_limits<float>::max() };
+
+                for (int ring { 0 }; ring <= max_ring; ++ring) {
+                    for (int z { center.z - ring }; z <= center.z + ring; ++z)
+                    for (int y { center.y - ring }; y <= center.y + ring; ++y)
+                    for (int x { center.x - ring }; x <= center.x + ring; ++x) {
+                        glm::ivec3 cell { x, y, z };
+                        if (glm::any(glm::lessThan(cell, glm::ivec3 { 0 })) || glm::any(glm::greaterThanEqual(cell, cells)))
+                            continue;
+                        if (glm::all(glm::lessThan(glm::abs(cell - center), glm::ivec3 { ring })))
+                            continue; // inside the ring, already searched.
+
+                        auto index = cell_index(cell);
+                        for (unsigned i { cell_start[index] }; i < cell_start[index + 1]; ++i) {
+                            glm::vec3 offset { roots[strand] - roots[cell_strands[i]] };
+                            float distance { glm::dot(offset, offset) };
+                            if (distance < closest_distance) {
+                                closest_distance = distance;
+                                clusters[strand] = cell_strands[i];
+                            }
+                        }
+                    }
+
+                    float ring_distance = ring * min_cell_extent;
+                    if (closest_distance <= ring_distance * ring_distance)
+                        break;
+                }
+            });
+        }
+    }
+
+    unsigned HairStyle::get_cluster_cut(unsigned level) const {
+        return std::max(get_strand_count() >> level, std::min(get_strand_count(), 1u));
+    }
+
+    std::vector<float> HairStyle::create_cluster_weights(unsigned level) const {
+        auto clusters = get_cluster_span();
+        std::vector<float> weights(get_strand_count(), 1.0f);
+
+        // The cuts are nested, so what's merged into a strand is merged along with it at the next cut.
+        for (unsigned cluster_level { 1 }; cluster_level <= std::min(level, ClusterLevels); ++cluster_level) {
+            for (unsigned strand { get_cluster_cut(cluster_level) }; strand < get_cluster_cut(cluster_level - 1); ++strand)
+                weights[clusters[strand]] += weights[strand];
+        }
+
+        weights.resize(get_cluster_cut(std::min(level, ClusterLevels)));
+
+        return weights;
+    }
+
     std::vector<glm::vec4> HairStyle::create_position_thickness_data() const {
         std::vector<glm::vec4> position_thicknesses(get_vertex_count());
-        #pragma omp parallel for schedule(dynamic)
-        for (int i = 0; i < static_cast<int>(get_vertex_count()); ++i) {
-            float thickness { 0.042f };
+        auto vertices  = get_vertex_span();
+        auto thickness = get_thickness_span();
+        JobSystem::get().parallel_for(0, static_cast<int>(get_vertex_count()), 1024, [&](int i) {
+            float radius { 0.042f };
             if (has_thickness())
-                thickness = this->thickness[i];
+                radius = thickness[i];
 
             position_thicknesses[i] = glm::vec4 {
                 vertices[i],
-                thickness
+                radius
             };
-        } return position_thicknesses;
+        }); return position_thicknesses;
+    }
+
+    void HairStyle::generate_position_thickness() {
+        unmap();
+        position_thickness = create_position_thickness_data();
     }
 
     std::vector<glm::vec4> HairStyle::create_tangent_transparency_data() const {
         std::vector<glm::vec4> tangent_transparency(get_vertex_count());
-        #pragma omp parallel for schedule(dynamic)
-        for (int i = 0; i < static_cast<int>(get_vertex_count()); ++i) {
-            float transparency { get_default_transparency() };
+        auto tangents     = get_tangent_span();
+        auto transparency = get_transparency_span();
+        JobSystem::get().parallel_for(0, static_cast<int>(get_vertex_count()), 1024, [&](int i) {
+            float opacity { get_default_transparency() };
             if (has_transparency())
-                transparency = this->transparency[i];
+                opacity = transparency[i];
 
             tangent_transparency[i] = glm::vec4 {
                 tangents[i],
-                transparency
+                opacity
             };
-        } return tangent_transparency;
+        }); return tangent_transparency;
     }
 
     std::vector<glm::vec4> HairStyle::create_color_transparency_data() const {
         std::vector<glm::vec4> color_transparencies(get_vertex_count());
-        #pragma omp parallel for schedule(dynamic)
-        for (int i = 0; i < static_cast<int>(get_vertex_count()); ++i) {
-            float transparency { get_default_transparency() };
+        auto colors       = get_color_span();
+        auto transparency = get_transparency_span();
+        JobSystem::get().parallel_for(0, static_cast<int>(get_vertex_count()), 1024, [&](int i) {
+            float opacity { get_default_transparency() };
             if (has_transparency()) {
-                transparency = this->transparency[i];
+                opacity = transparency[i];
             }
 
             glm::vec3 color { get_default_color() };
             if (has_color()) {
-                color = this->color[i];
+                color = colors[i];
             }
 
             color_transparencies[i] = glm::vec4 {
                 color,
-                transparency
+                opacity
             };
-        } return color_transparencies;
+        }); return color_transparencies;
     }
 
-    const std::vector<unsigned>& HairStyle::get_indices() const {
+    const LargeBuffer<unsigned>& HairStyle::get_indices() const {
         return indices;
     }
 
-    const std::vector<glm::vec3>& HairStyle::get_tangents() const {
+    const LargeBuffer<unsigned>& HairStyle::get_guides() const {
+        return guides;
+    }
+
+    const LargeBuffer<glm::vec3>& HairStyle::get_tangents() const {
         return tangents;
     }
 
-    const std::vector<float>& HairStyle::get_thickness() const {
+    const LargeBuffer<float>& HairStyle::get_thickness() const {
         return thickness;
     }
 
-    const std::vector<glm::vec3>& HairStyle::get_vertices() const {
+    const LargeBuffer<glm::vec3>& HairStyle::get_vertices() const {
         return vertices;
     }
 
-    const std::vector<unsigned short>& HairStyle::get_segments() const {
+    const LargeBuffer<unsigned short>& HairStyle::get_segments() const {
+        return segments;
+    }
+
+    const LargeBuffer<float>& HairStyle::get_transparency() const {
+        return transparency;
+    }
+
+    const LargeBuffer<glm::vec3>& HairStyle::get_color() const {
+        return color;
+    }
+
+    Span<unsigned short> HairStyle::get_segment_span() const {
+        if (is_mapped()) return mapped_segments;
         return segments;
     }
 
-    const std::vector<float>& HairStyle::get_transparency() const {
+    Span<glm::vec3> HairStyle::get_vertex_span() const {
+        if (is_mapped()) return mapped_vertices;
+        return vertices;
+    }
+
+    Span<float> HairStyle::get_thickness_span() const {
+        if (is_mapped()) return mapped_thickness;
+        return thickness;
+    }
+
+    Span<float> HairStyle::get_transparency_span() const {
+        if (is_mapped()) return mapped_transparency;
         return transparency;
     }
 
-    const std::vector<glm::vec3>& HairStyle::get_color() const {
+    Span<glm::vec3> HairStyle::get_color_span() const {
+        if (is_mapped()) return mapped_color;
         return color;
     }
 
+    Span<glm::vec3> HairStyle::get_tangent_span() const {
+        if (is_mapped()) return mapped_tangents;
+        return tangents;
+    }
+
+    Span<unsigned> HairStyle::get_index_span() const {
+        if (is_mapped()) return mapped_indices;
+        return indices;
+    }
+
+    Span<unsigned> HairStyle::get_guide_span() const {
+        if (is_mapped()) return mapped_guides;
+        return guides;
+    }
+
+    Span<glm::vec4> HairStyle::get_position_thickness_span() const {
+        if (is_mapped()) return mapped_position_thickness;
+        return position_thickness;
+    }
+
+    Span<unsigned> HairStyle::get_cluster_span() const {
+        if (is_mapped()) return mapped_clusters;
+        return clusters;
+    }
+
     bool HairStyle::valid_signature() const {
         return file_header.signature[0] == 'H' &&
                file_header.signature[1] == 'A' &&
                file_header.signature[2] == 'I' &&
-               file_header.signature[3] == 'R';
+              (file_header.signature[3] == 'R' ||
+               file_header.signature[3] == 'Z');
+    }
+
+    bool HairStyle::is_compressed() const {
+        return file_header.signature[3] == 'Z' && file_header.field.compressed;
     }
 
     bool HairStyle::format_is_valid() const {
         if (!has_vertices()) return false;
         if (!valid_signature()) return false;
-        if (has_thickness() && thickness.size() != vertices.size()) return false;
-        if (has_transparency() && transparency.size() != vertices.size()) return false;
-        if (has_color() && color.size() != vertices.size()) return false;
+        if (has_thickness() && get_thickness_span().size() != get_vertex_count()) return false;
+        if (has_transparency() && get_transparency_span().size() != get_vertex_count()) return false;
+        if (has_color() && get_color_span().size() != get_vertex_count()) return false;
+        if (has_guides() && get_guide_span().size() != get_strand_count()) return false;
+        if (has_position_thickness() && get_position_thickness_span().size() != get_vertex_count()) return false;
+        if (has_clusters() && get_cluster_span().size() != get_strand_count()) return false;
         return true; // The rest we assume is right. It's hard to verify.
     }
 
@@ -565,6 +1531,8 @@ namespace vkhr {
 
         file_header.strand_count = get_strand_count();
         file_header.vertex_count = get_vertex_count();
+
+        update_quantized_thickness();
     }
 
     void HairStyle::update_bitfield() const {
@@ -575,9 +1543,29 @@ namespace vkhr {
         file_header.field.has_color = has_color();
         file_header.field.has_tangents = has_tangents();
         file_header.field.has_indices = has_indices();
+        file_header.field.has_guides = has_guides();
+        file_header.field.has_position_thickness = has_position_thickness();
+        file_header.field.has_clusters = has_clusters();
         file_header.field.future_extension = 0;
     }
 
+    void HairStyle::update_quantized_thickness() const {
+        float thickest { 0.042f }; // like the ones without thickness are drawn.
+        if (has_thickness()) {
+            auto thickness = get_thickness_span();
+            if (!thickness.empty())
+                thickest = *std::max_element(thickness.begin(), thickness.end());
+        }
+
+        file_header.quantized_thickness = glm::max(thickest, 1e-6f);
+    }
+
+    std::size_t HairStyle::align_field(std::size_t offset) const {
+        if (!file_header.field.aligned)
+            return offset; // e.g. from before it was, or not written by us.
+        return (offset + FieldAlignment - 1) / FieldAlignment * FieldAlignment;
+    }
+
     bool HairStyle::set_error_state(const Error error_state) const {
         this->error_state = error_state;
         if (error_state == Error::None) {
@@ -634,56 +1622,243 @@ namespace vkhr {
         } return true;
     }
 
+    bool HairStyle::read_guides(std::ifstream& file) {
+        if (file_header.field.has_guides) {
+            guides.resize(file_header.strand_count);
+            return read_field(file, guides);
+        } return true;
+    }
+
+    bool HairStyle::read_position_thickness(std::ifstream& file) {
+        if (file_header.field.has_position_thickness) {
+            position_thickness.resize(file_header.vertex_count);
+            return read_field(file, position_thickness);
+        } return true;
+    }
+
+    bool HairStyle::read_clusters(std::ifstream& file) {
+        if (file_header.field.has_clusters) {
+            clusters.resize(file_header.strand_count);
+            return read_field(file, clusters);
+        } return true;
+    }
+
+    bool HairStyle::import(const std::string& file_path) {
+        MemoryMap file { file_path };
+
+        if (!file) return set_error_state(Error::OpeningFile);
+
+        file_header = FileHeader {  };
+
+        // Neither of the formats have these, so they're around what the shipped styles use.
+        set_default_thickness(0.042f);
+        set_default_transparency(0.6f);
+        set_default_color(glm::vec3 { 0.32f, 0.228f, 0.128f });
+
+        segments.clear();
+        vertices.clear();
+        thickness.clear();
+        transparency.clear();
+        color.clear();
+        tangents.clear();
+        indices.clear();
+        guides.clear();
+        position_thickness.clear();
+        clusters.clear();
+
+        if (!hair_importer::import(file, file_path, *this))
+            return set_error_state(Error::ImportingFile);
+
+        complete_header();
+
+        if (!format_is_valid()) return set_error_state(Error::InvalidFormat);
+
+        return set_error_state(Error::None);
+    }
+
+    HairStyle::Error HairStyle::read_compressed(std::ifstream& file) {
+        // Read in one go, e.g. network storage is much faster with few large reads.
+        auto data_begin = file.tellg();
+        file.seekg(0, std::ios::end);
+        std::vector<char> data(static_cast<std::size_t>(file.tellg() - data_begin));
+        file.seekg(data_begin);
+
+        if (!file.read(data.data(), data.size()))
+            return Error::ReadingSegments;
+
+        std::size_t offset { 0 };
+
+        auto read_words = [&](bool has_field, auto* words, std::size_t count, std::size_t stride) {
+            if (!has_field) return true;
+
+            std::uint64_t stream_size;
+            if (offset + sizeof(stream_size) > data.size()) return false;
+            std::memcpy(&stream_size, data.data() + offset, sizeof(stream_size));
+            offset += sizeof(stream_size);
+
+            if (offset + stream_size > data.size()) return false;
+            bool decompressed = compression::decompress(data.data() + offset, stream_size, words, count, stride);
+            offset += stream_size;
+
+            return decompressed;
+        };
+
+        const auto& field = file_header.field;
+        std::size_t strand_count { file_header.strand_count },
+                    vertex_count { file_header.vertex_count };
+
+        std::vector<std::uint32_t> wide_segments(field.has_segments ? strand_count : 0);
+        if (!read_words(field.has_segments, wide_segments.data(), strand_count, 1))
+            return Error::ReadingSegments;
+        segments.assign(wide_segments.begin(), wide_segments.end());
+
+        // The vec3 fields are predicted from the same component of the previous vertex.
+        vertices.resize(field.has_vertices ? vertex_count : 0);
+        if (!read_words(field.has_vertices, reinterpret_cast<float*>(vertices.data()), vertex_count * 3, 3))
+            return Error::ReadingVertices;
+        thickness.resize(field.has_thickness ? vertex_count : 0);
+        if (!read_words(field.has_thickness, thickness.data(), vertex_count, 1))
+            return Error::ReadingThickness;
+        transparency.resize(field.has_transparency ? vertex_count : 0);
+        if (!read_words(field.has_transparency, transparency.data(), vertex_count, 1))
+            return Error::ReadingTransparency;
+        color.resize(field.has_color ? vertex_count : 0);
+        if (!read_words(field.has_color, reinterpret_cast<float*>(color.data()), vertex_count * 3, 3))
+            return Error::ReadingColor;
+        tangents.resize(field.has_tangents ? vertex_count : 0);
+        if (!read_words(field.has_tangents, reinterpret_cast<float*>(tangents.data()), vertex_count * 3, 3))
+            return Error::ReadingTangents;
+
+        // Each index is predicted from the same end of the previous segment, i.e. off by one.
+        std::size_t index_count { (vertex_count - strand_count) * 2 };
+        indices.resize(field.has_indices ? index_count : 0);
+        if (!read_words(field.has_indices, indices.data(), index_count, 2))
+            return Error::ReadingIndices;
+        guides.resize(field.has_guides ? strand_count : 0);
+        if (!read_words(field.has_guides, guides.data(), strand_count, 1))
+            return Error::ReadingGuides;
+        position_thickness.resize(field.has_position_thickness ? vertex_count : 0);
+        if (!read_words(field.has_position_thickness, reinterpret_cast<float*>(position_thickness.data()), vertex_count * 4, 4))
+            return Error::ReadingPositionThickness;
+        clusters.resize(field.has_clusters ? strand_count : 0);
+        if (!read_words(field.has_clusters, clusters.data(), strand_count, 1))
+            return Error::ReadingClusters;
+
+        return Error::None;
+    }
+
+    HairStyle::Error HairStyle::write_compressed(std::ofstream& file) const {
+        auto write_stream = [&](bool has_field, const std::vector<char>& stream) {
+            if (!has_field) return true;
+            std::uint64_t stream_size { stream.size() };
+            return static_cast<bool>(file.write(reinterpret_cast<const char*>(&stream_size), sizeof(stream_size)) &&
+                                     file.write(stream.data(), stream.size()));
+        };
+
+        auto float_span = [](auto span, std::size_t components) {
+            return Span<float> { reinterpret_cast<const float*>(span.data()), span.size() * components };
+        };
+
+        const auto& field = file_header.field;
+
+        auto segment_span = get_segment_span();
+        std::vector<std::uint32_t> wide_segments(segment_span.begin(), segment_span.end());
+
+        if (!write_stream(field.has_segments, compression::compress(Span<std::uint32_t> { wide_segments }, 1)))
+            return Error::WritingSegments;
+        if (!write_stream(field.has_vertices, compression::compress(float_span(get_vertex_span(), 3), 3)))
+            return Error::WritingVertices;
+        if (!write_stream(field.has_thickness, compression::compress(get_thickness_span(), 1)))
+            return Error::WritingThickness;
+        if (!write_stream(field.has_transparency, compression::compress(get_transparency_span(), 1)))
+            return Error::WritingTransparency;
+        if (!write_stream(field.has_color, compression::compress(float_span(get_color_span(), 3), 3)))
+            return Error::WritingColor;
+        if (!write_stream(field.has_tangents, compression::compress(float_span(get_tangent_span(), 3), 3)))
+            return Error::WritingTangents;
+        if (!write_stream(field.has_indices, compression::compress(get_index_span(), 2)))
+            return Error::WritingIndices;
+        if (!write_stream(field.has_guides, compression::compress(get_guide_span(), 1)))
+            return Error::WritingGuides;
+        if (!write_stream(field.has_position_thickness, compression::compress(float_span(get_position_thickness_span(), 4), 4)))
+            return Error::WritingPositionThickness;
+        if (!write_stream(field.has_clusters, compression::compress(get_cluster_span(), 1)))
+            return Error::WritingClusters;
+
+        return Error::None;
+    }
+
     bool HairStyle::write_segments(std::ofstream& file) const {
         if (file_header.field.has_segments) {
-            return write_field(file, segments);
+            return write_field(file, get_segment_span());
         } return true;
     }
 
     bool HairStyle::write_vertices(std::ofstream& file) const {
         if (file_header.field.has_vertices) {
-            return write_field(file, vertices);
+            return write_field(file, get_vertex_span());
         } return true;
     }
 
     bool HairStyle::write_thickness(std::ofstream& file) const {
         if (file_header.field.has_thickness) {
-            return write_field(file, thickness);
+            return write_field(file, get_thickness_span());
         } return true;
     }
 
     bool HairStyle::write_transparancy(std::ofstream& file) const {
         if (file_header.field.has_transparency) {
-            return write_field(file, transparency);
+            return write_field(file, get_transparency_span());
         } return true;
     }
 
     bool HairStyle::write_color(std::ofstream& file) const {
         if (file_header.field.has_color) {
-            return write_field(file, color);
+            return write_field(file, get_color_span());
         } return true;
     }
 
     bool HairStyle::write_tangents(std::ofstream& file) const {
         if (file_header.field.has_tangents) {
-            return write_field(file, tangents);
+            return write_field(file, get_tangent_span());
         } return true;
     }
 
     bool HairStyle::write_indices(std::ofstream& file) const {
         if (file_header.field.has_indices) {
-            return write_field(file, indices);
+            return write_field(file, get_index_span());
+        } return true;
+    }
+
+    bool HairStyle::write_guides(std::ofstream& file) const {
+        if (file_header.field.has_guides) {
+            return write_field(file, get_guide_span());
+        } return true;
+    }
+
+    bool HairStyle::write_position_thickness(std::ofstream& file) const {
+        if (file_header.field.has_position_thickness) {
+            return write_field(file, get_position_thickness_span());
+        } return true;
+    }
+
+    bool HairStyle::write_clusters(std::ofstream& file) const {
+        if (file_header.field.has_clusters) {
+            return write_field(file, get_cluster_span());
         } return true;
     }
 
     std::size_t HairStyle::get_size() const {
         std::size_t size_in_bytes { 0 };
-        size_in_bytes += segments.size() * sizeof(segments[0]);
-        size_in_bytes += vertices.size() * sizeof(vertices[0]);
-        size_in_bytes += thickness.size() * sizeof(thickness[0]);
-        size_in_bytes += color.size() * sizeof(color[0]);
-        size_in_bytes += tangents.size() * sizeof(tangents[0]);
-        size_in_bytes += indices.size() * sizeof(indices[0]);
+        size_in_bytes += get_segment_span().size_in_bytes();
+        size_in_bytes += get_vertex_span().size_in_bytes();
+        size_in_bytes += get_thickness_span().size_in_bytes();
+        size_in_bytes += get_color_span().size_in_bytes();
+        size_in_bytes += get_tangent_span().size_in_bytes();
+        size_in_bytes += get_index_span().size_in_bytes();
+        size_in_bytes += get_guide_span().size_in_bytes();
+        size_in_bytes += get_position_thickness_span().size_in_bytes();
+        size_in_bytes += get_cluster_span().size_in_bytes();
         size_in_bytes += sizeof(FileHeader);
         return size_in_bytes;
     }
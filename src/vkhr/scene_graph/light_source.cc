@@ -15,6 +15,15 @@ namespace vkhr {
         return buffer;
     }
 
+    bool LightSource::buffer_is_dirty() const {
+        if (buffer_dirty) {
+            buffer_dirty = false;
+            return true;
+        }
+
+        return false;
+    }
+
     LightSource::Type LightSource::get_type() const {
         return type;
     }
@@ -37,6 +46,7 @@ namespace vkhr {
 
     void LightSource::set_type(Type light_source_type) {
         type = light_source_type;
+        buffer_dirty = true;
         switch (type) {
         case Type::Point:
             buffer.vector[3] = 1.0;
@@ -66,6 +76,7 @@ namespace vkhr {
         buffer.view_projection = bias * view_projection;
         buffer.near = near;
         buffer.far = far;
+        buffer_dirty = true;
     }
 
     const glm::vec4& LightSource::get_vector() const {
@@ -90,16 +101,35 @@ namespace vkhr {
         buffer.intensity[0] = intensity[0];
         buffer.intensity[1] = intensity[1];
         buffer.intensity[2] = intensity[2];
+        buffer_dirty = true;
     }
 
     void LightSource::set_cutoff_factor(float cutoff) {
         buffer.intensity[3] = cutoff;
+        buffer_dirty = true;
     }
 
     float LightSource::get_cutoff_factor() const {
         return buffer.intensity[3];
     }
 
+    void LightSource::set_range(float range) {
+        buffer.range = range;
+        buffer_dirty = true;
+    }
+
+    float LightSource::get_range() const {
+        return buffer.range;
+    }
+
+    float LightSource::get_attenuation(const glm::vec3& position) const {
+        if (type == Type::Directional || buffer.range <= 0.0f)
+            return 1.0f;
+        float distance = glm::distance(buffer.origin, position) / buffer.range;
+        float window = glm::clamp(1.0f - distance * distance * distance * distance, 0.0f, 1.0f);
+        return window * window;
+    }
+
     void LightSource::set_vector(glm::vec3 vector) {
         if (type == LightSource::Type::Directional)
             vector = glm::normalize(vector);
@@ -107,6 +137,7 @@ namespace vkhr {
         buffer.vector[0] = vector[0];
         buffer.vector[1] = vector[1];
         buffer.vector[2] = vector[2];
+        buffer_dirty = true;
     }
 
     void LightSource::set_origin(const glm::vec3& scene_origin, float distance) {
@@ -136,6 +167,7 @@ namespace vkhr {
 
         view_projection        = projection * view;
         buffer.view_projection = bias * view_projection;
+        buffer_dirty = true;
     }
 
     const glm::mat4& LightSource::get_view_projection() const {
@@ -1,6 +1,15 @@
 #include <vkhr/scene_graph/model.hh>
+#include <vkhr/scene_graph/hair_style.hh>
+#include <vkhr/job_system.hh>
 
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
 #include "vkhr/image.hh"
 
 namespace vkhr {
@@ -9,6 +18,26 @@ namespace vkhr {
     }
 
     bool Model::load(const std::string& file_path) {
+        auto cache_path = get_cache_path(file_path);
+
+        if (!HairStyle::cache_is_current(cache_path, file_path) || !map(cache_path)) {
+            if (!load_obj(file_path)) return false;
+            optimize();
+            save(cache_path); // read-only? Then it's just not cached.
+        }
+
+#ifdef USE_MODEL_TEXTURE
+		auto texturePath = file_path.substr(0, file_path.find_last_of("."));
+		texture = Texture::find(texturePath);
+		if (!texture)
+			image = Image{texturePath + ".png"};
+#endif	
+
+        success = true;
+        return success;
+    }
+
+    bool Model::load_obj(const std::string& file_path) {
         std::string error_msg { "" };
         std::string base_path { file_path.substr(0, file_path.find_last_of("\\/") + 1) };
         success = tinyobj::LoadObj(&attributes, &shapes, &materials,
@@ -16,47 +45,389 @@ namespace vkhr {
         if (!error_msg.empty()) std::cerr << error_msg << std::endl;
         if (!success) return false;
 
+        memory_map.reset();
+
         std::size_t index_count { 0 };
         for (const auto& shape : shapes) {
             index_count += shape.mesh.indices.size();
         }
 
+        vertices.clear();
+        elements.clear();
+        short_elements.clear();
+
         vertices.reserve(index_count);
         elements.reserve(index_count);
 
+        // The .obj indexes each attribute on its own, so a vertex is one of their combinations.
+        auto index_hash = [](const tinyobj::index_t& index) {
+            return static_cast<std::size_t>(index.vertex_index)   * 73856093u ^
+                   static_cast<std::size_t>(index.normal_index)   * 19349663u ^
+                   static_cast<std::size_t>(index.texcoord_index) * 83492791u;
+        };
+
+        auto index_equal = [](const tinyobj::index_t& lhs, const tinyobj::index_t& rhs) {
+            return lhs.vertex_index   == rhs.vertex_index &&
+                   lhs.normal_index   == rhs.normal_index &&
+                   lhs.texcoord_index == rhs.texcoord_index;
+        };
+
+        std::unordered_map<tinyobj::index_t, std::uint32_t,
+                           decltype(index_hash),
+                           decltype(index_equal)> unique_vertices { index_count, index_hash, index_equal };
+
         for (const auto& shape : shapes) {
             for (const auto& index : shape.mesh.indices) {
-                Vertex vertex;
-
-                vertex.position = {
-                    attributes.vertices[3 * index.vertex_index + 0],
-                    attributes.vertices[3 * index.vertex_index + 1],
-                    attributes.vertices[3 * index.vertex_index + 2]
-                };
-
-                vertex.texcoord = {
-                           attributes.texcoords[2 * index.texcoord_index + 0],
-                    1.0f - attributes.texcoords[2 * index.texcoord_index + 1]
-                };
-
-                vertex.normal = {
-                    attributes.normals[3 * index.normal_index + 0],
-                    attributes.normals[3 * index.normal_index + 1],
-                    attributes.normals[3 * index.normal_index + 2]
-                };
-
-                vertices.push_back(vertex);
-                elements.push_back(elements.size());
+                auto unique_vertex = unique_vertices.emplace(index, static_cast<std::uint32_t>(vertices.size()));
+
+                if (unique_vertex.second) {
+                    Vertex vertex;
+
+                    vertex.position = {
+                        attributes.vertices[3 * index.vertex_index + 0],
+                        attributes.vertices[3 * index.vertex_index + 1],
+                        attributes.vertices[3 * index.vertex_index + 2]
+                    };
+
+                    vertex.texcoord = {
+                               attributes.texcoords[2 * index.texcoord_index + 0],
+                        1.0f - attributes.texcoords[2 * index.texcoord_index + 1]
+                    };
+
+                    vertex.normal = {
+                        attributes.normals[3 * index.normal_index + 0],
+                        attributes.normals[3 * index.normal_index + 1],
+                        attributes.normals[3 * index.normal_index + 2]
+                    };
+
+                    vertices.push_back(vertex);
+                }
+
+                elements.push_back(unique_vertex.first->second);
             }
         }
 
-#ifdef USE_MODEL_TEXTURE
-		auto imagePath = file_path.substr(0, file_path.find_last_of(".")) + ".png";
-		image = Image{imagePath};
-#endif	
+        vertices.shrink_to_fit();
 
-        success = true;
-        return success;
+        if (!vertices.empty()) {
+            bounds_min = bounds_max = vertices.front().position;
+            for (const auto& vertex : vertices) {
+                bounds_min = glm::min(bounds_min, vertex.position);
+                bounds_max = glm::max(bounds_max, vertex.position);
+            }
+        }
+
+        return true;
+    }
+
+    // The scoring of "Linear-Speed Vertex Cache Optimisation" by T. Forsyth (2006), for a LRU cache.
+    static constexpr std::size_t VertexCacheSize { 32 };
+
+    static float vertex_cache_score(int cache_position, std::uint32_t live_triangles) {
+        if (live_triangles == 0) return -1.0f; // nothing left to draw with it.
+
+        float score { 0.0f };
+
+        if (cache_position >= 0) {
+            if (cache_position < 3) score = 0.75f; // the last triangle's, so it doesn't just fan around it.
+            else score = std::pow(1.0f - (cache_position - 3) / static_cast<float>(VertexCacheSize - 3), 1.5f);
+        }
+
+        // The vertices with few triangles left are finished first, so they don't come back later.
+        return score + 2.0f * std::pow(static_cast<float>(live_triangles), -0.5f);
+    }
+
+    // Greedily draws the best scoring triangle with its vertices in the cache next, or the next one
+    // that isn't drawn yet when none of them are, which is where a new cluster starts (see below).
+    static std::vector<std::uint32_t> optimize_vertex_cache(const std::vector<std::uint32_t>& elements,
+                                                            std::size_t vertex_count) {
+        std::size_t triangle_count { elements.size() / 3 };
+
+        std::vector<std::uint32_t> live_triangles(vertex_count, 0);
+        for (auto element : elements) ++live_triangles[element];
+
+        std::vector<std::uint32_t> triangle_offsets(vertex_count + 1, 0);
+        for (std::size_t vertex { 0 }; vertex < vertex_count; ++vertex)
+            triangle_offsets[vertex + 1] = triangle_offsets[vertex] + live_triangles[vertex];
+
+        std::vector<std::uint32_t> vertex_triangles(elements.size());
+        std::vector<std::uint32_t> next_triangle(triangle_offsets.begin(), triangle_offsets.end() - 1);
+        for (std::size_t triangle { 0 }; triangle < triangle_count; ++triangle)
+            for (std::size_t corner { 0 }; corner < 3; ++corner)
+                vertex_triangles[next_triangle[elements[3*triangle + corner]]++] = static_cast<std::uint32_t>(triangle);
+
+        std::vector<int> cache_positions(vertex_count, -1);
+        std::vector<float> vertex_scores(vertex_count);
+        for (std::size_t vertex { 0 }; vertex < vertex_count; ++vertex)
+            vertex_scores[vertex] = vertex_cache_score(-1, live_triangles[vertex]);
+
+        std::vector<float> triangle_scores(triangle_count);
+        for (std::size_t triangle { 0 }; triangle < triangle_count; ++triangle)
+            triangle_scores[triangle] = vertex_scores[elements[3*triangle + 0]] +
+                                        vertex_scores[elements[3*triangle + 1]] +
+                                        vertex_scores[elements[3*triangle + 2]];
+
+        std::vector<bool> drawn(triangle_count, false);
+
+        std::vector<std::uint32_t> optimized_elements;
+        optimized_elements.reserve(elements.size());
+
+        std::vector<std::uint32_t> cache, next_cache;
+        cache.reserve(VertexCacheSize + 3);
+        next_cache.reserve(VertexCacheSize + 3);
+
+        std::size_t next_undrawn { 0 };
+        long best_triangle { -1 };
+
+        for (std::size_t drawn_triangles { 0 }; drawn_triangles < triangle_count; ++drawn_triangles) {
+            if (best_triangle < 0) {
+                while (drawn[next_undrawn]) ++next_undrawn;
+                best_triangle = static_cast<long>(next_undrawn);
+            }
+
+            const auto* triangle = &elements[3 * best_triangle];
+            drawn[best_triangle] = true;
+
+            next_cache.clear();
+
+            for (std::size_t corner { 0 }; corner < 3; ++corner) {
+                auto vertex = triangle[corner];
+                optimized_elements.push_back(vertex);
+                next_cache.push_back(vertex);
+
+                // It's no longer live, so swap it out of the vertex's live triangles.
+                auto* first = &vertex_triangles[triangle_offsets[vertex]];
+                auto* last  = first + live_triangles[vertex];
+                std::iter_swap(std::find(first, last, static_cast<std::uint32_t>(best_triangle)), last - 1);
+                --live_triangles[vertex];
+            }
+
+            for (auto vertex : cache)
+                if (std::find(triangle, triangle + 3, vertex) == triangle + 3)
+                    next_cache.push_back(vertex);
+
+            // The ones pushed out of the cache are re-scored too, and their triangles with them.
+            for (std::size_t position { 0 }; position < next_cache.size(); ++position) {
+                auto vertex = next_cache[position];
+                cache_positions[vertex] = position < VertexCacheSize ? static_cast<int>(position) : -1;
+
+                float score = vertex_cache_score(cache_positions[vertex], live_triangles[vertex]);
+                float score_change = score - vertex_scores[vertex];
+                vertex_scores[vertex] = score;
+
+                for (std::uint32_t i { 0 }; i < live_triangles[vertex]; ++i)
+                    triangle_scores[vertex_triangles[triangle_offsets[vertex] + i]] += score_change;
+            }
+
+            if (next_cache.size() > VertexCacheSize)
+                next_cache.resize(VertexCacheSize);
+            std::swap(cache, next_cache);
+
+            best_triangle = -1;
+            float best_score { -1.0f };
+
+            for (auto vertex : cache) {
+                for (std::uint32_t i { 0 }; i < live_triangles[vertex]; ++i) {
+                    auto candidate = vertex_triangles[triangle_offsets[vertex] + i];
+                    if (triangle_scores[candidate] > best_score) {
+                        best_score = triangle_scores[candidate];
+                        best_triangle = candidate;
+                    }
+                }
+            }
+        }
+
+        return optimized_elements;
+    }
+
+    // Like the overdraw optimization in "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"
+    // by P. Sander et al. 2007: the cache-ordered triangles are split into clusters wherever a triangle
+    // misses all of its vertices in a (FIFO) cache anyway, so starting a cluster there doesn't cost any
+    // vertex transforms, and the clusters facing out from the center of the mesh are drawn first, since
+    // they're likely to occlude the rest of the mesh. The order of the triangles in a cluster is kept.
+    static std::vector<std::uint32_t> optimize_overdraw(const std::vector<std::uint32_t>& elements,
+                                                        const std::vector<Model::Vertex>& vertices) {
+        constexpr std::size_t FifoCacheSize { 16 };
+
+        std::size_t triangle_count { elements.size() / 3 };
+
+        std::vector<std::size_t> cluster_starts;
+        std::vector<std::size_t> cached_at(vertices.size(), 0); // what the miss counter was, plus one.
+        std::size_t misses { 0 };
+
+        for (std::size_t triangle { 0 }; triangle < triangle_count; ++triangle) {
+            int triangle_misses { 0 };
+
+            for (std::size_t corner { 0 }; corner < 3; ++corner) {
+                auto vertex = elements[3*triangle + corner];
+                if (cached_at[vertex] == 0 || misses - cached_at[vertex] + 1 > FifoCacheSize) {
+                    cached_at[vertex] = ++misses;
+                    ++triangle_misses;
+                }
+            }
+
+            if (triangle_misses == 3 || triangle == 0)
+                cluster_starts.push_back(triangle);
+        }
+
+        cluster_starts.push_back(triangle_count);
+
+        glm::vec3 mesh_centroid { 0.0f };
+        for (const auto& vertex : vertices)
+            mesh_centroid += vertex.position;
+        mesh_centroid /= static_cast<float>(std::max<std::size_t>(vertices.size(), 1));
+
+        std::size_t cluster_count { cluster_starts.size() - 1 };
+        std::vector<float> cluster_sort_keys(cluster_count);
+
+        for (std::size_t cluster { 0 }; cluster < cluster_count; ++cluster) {
+            glm::vec3 centroid { 0.0f }, normal { 0.0f };
+            float area { 0.0f };
+
+            for (auto triangle = cluster_starts[cluster]; triangle < cluster_starts[cluster + 1]; ++triangle) {
+                const auto& a = vertices[elements[3*triangle + 0]].position;
+                const auto& b = vertices[elements[3*triangle + 1]].position;
+                const auto& c = vertices[elements[3*triangle + 2]].position;
+
+                auto face = glm::cross(b - a, c - a); // twice the area, along the normal.
+                float face_area = glm::length(face);
+
+                centroid += (a + b + c) / 3.0f * face_area;
+                normal += face;
+                area += face_area;
+            }
+
+            if (area > 0.0f) centroid /= area;
+            float normal_length = glm::length(normal);
+            if (normal_length > 0.0f) normal /= normal_length;
+
+            cluster_sort_keys[cluster] = glm::dot(centroid - mesh_centroid, normal);
+        }
+
+        std::vector<std::size_t> cluster_order(cluster_count);
+        std::iota(cluster_order.begin(), cluster_order.end(), 0);
+        std::stable_sort(cluster_order.begin(), cluster_order.end(), [&](std::size_t lhs, std::size_t rhs) {
+            return cluster_sort_keys[lhs] > cluster_sort_keys[rhs];
+        });
+
+        std::vector<std::uint32_t> sorted_elements;
+        sorted_elements.reserve(elements.size());
+
+        for (auto cluster : cluster_order)
+            sorted_elements.insert(sorted_elements.end(),
+                                   elements.begin() + 3 * cluster_starts[cluster],
+                                   elements.begin() + 3 * cluster_starts[cluster + 1]);
+
+        return sorted_elements;
+    }
+
+    void Model::optimize() {
+        elements = optimize_vertex_cache(elements, vertices.size());
+        elements = optimize_overdraw(elements, vertices);
+
+        // Finally the vertices are stored in the order they are first drawn in, for the vertex fetches.
+        std::vector<std::uint32_t> remap(vertices.size(), std::numeric_limits<std::uint32_t>::max());
+        std::vector<Vertex> fetch_ordered_vertices;
+        fetch_ordered_vertices.reserve(vertices.size());
+
+        for (auto& element : elements) {
+            if (remap[element] == std::numeric_limits<std::uint32_t>::max()) {
+                remap[element] = static_cast<std::uint32_t>(fetch_ordered_vertices.size());
+                fetch_ordered_vertices.push_back(vertices[element]);
+            }
+
+            element = remap[element];
+        }
+
+        vertices = std::move(fetch_ordered_vertices);
+
+        if (vertices.size() <= std::numeric_limits<std::uint16_t>::max() + 1u) {
+            short_elements.assign(elements.begin(), elements.end());
+            elements.clear();
+            elements.shrink_to_fit();
+        }
+    }
+
+    std::string Model::get_cache_path(const std::string& file_path) {
+        return file_path + ".v" + std::to_string(CacheVersion) + ".mesh";
+    }
+
+    bool Model::save(const std::string& cache_path) const {
+        CacheHeader header;
+
+        std::memcpy(header.signature, "VKHM", sizeof(header.signature));
+        header.version = CacheVersion;
+        header.vertex_count  = static_cast<std::uint32_t>(get_vertex_span().size());
+        header.element_count = static_cast<std::uint32_t>(get_element_count());
+        header.element_size  = get_short_element_span().empty() ? sizeof(std::uint32_t) : sizeof(std::uint16_t);
+        header.bounds_min = bounds_min;
+        header.bounds_max = bounds_max;
+
+        std::ofstream file { cache_path, std::ios::binary };
+
+        if (!file) return false;
+
+        auto vertex_span = get_vertex_span();
+        auto element_span = get_element_span();
+        auto short_element_span = get_short_element_span();
+
+        return file.write(reinterpret_cast<const char*>(&header), sizeof(header)) &&
+               file.write(reinterpret_cast<const char*>(vertex_span.data()), vertex_span.size_in_bytes()) &&
+               file.write(reinterpret_cast<const char*>(element_span.data()), element_span.size_in_bytes()) &&
+               file.write(reinterpret_cast<const char*>(short_element_span.data()), short_element_span.size_in_bytes());
+    }
+
+    bool Model::map(const std::string& cache_path) {
+        auto cache = std::make_shared<MemoryMap>(cache_path);
+
+        if (!*cache || cache->get_size() < sizeof(CacheHeader))
+            return false;
+
+        CacheHeader header;
+        std::memcpy(&header, cache->get_data(), sizeof(header));
+
+        if (std::memcmp(header.signature, "VKHM", sizeof(header.signature)) != 0 ||
+            header.version != CacheVersion ||
+            (header.element_size != sizeof(std::uint16_t) && header.element_size != sizeof(std::uint32_t)))
+            return false;
+
+        std::size_t offset { sizeof(CacheHeader) };
+
+        auto cached_vertices = cache->view<Vertex>(offset, header.vertex_count);
+        if (cached_vertices.size() != header.vertex_count) return false;
+        offset += cached_vertices.size_in_bytes();
+
+        Span<std::uint32_t> cached_elements;
+        Span<std::uint16_t> cached_short_elements;
+
+        if (header.element_size == sizeof(std::uint16_t))
+            cached_short_elements = cache->view<std::uint16_t>(offset, header.element_count);
+        else cached_elements = cache->view<std::uint32_t>(offset, header.element_count);
+
+        if (cached_elements.size() + cached_short_elements.size() != header.element_count)
+            return false;
+
+        attributes = tinyobj::attrib_t { };
+        shapes.clear();
+        materials.clear();
+
+        vertices.clear();       vertices.shrink_to_fit();
+        elements.clear();       elements.shrink_to_fit();
+        short_elements.clear(); short_elements.shrink_to_fit();
+
+        memory_map = std::move(cache);
+        mapped_vertices = cached_vertices;
+        mapped_elements = cached_elements;
+        mapped_short_elements = cached_short_elements;
+
+        bounds_min = header.bounds_min;
+        bounds_max = header.bounds_max;
+
+        return true;
+    }
+
+    bool Model::is_mapped() const {
+        return memory_map != nullptr;
     }
 
     Model::operator bool() const {
@@ -75,17 +446,201 @@ namespace vkhr {
         return shapes;
     }
 
-    const std::vector<Model::Vertex>& Model::get_vertices() const {
+    Span<Model::Vertex> Model::get_vertex_span() const {
+        if (is_mapped()) return mapped_vertices;
         return vertices;
     }
 
-    const std::vector<std::uint32_t>& Model::get_elements() const {
+    Span<std::uint32_t> Model::get_element_span() const {
+        if (is_mapped()) return mapped_elements;
         return elements;
     }
 
+    Span<std::uint16_t> Model::get_short_element_span() const {
+        if (is_mapped()) return mapped_short_elements;
+        return short_elements;
+    }
+
+    std::size_t Model::get_element_count() const {
+        return get_element_span().size() + get_short_element_span().size();
+    }
+
+    std::uint32_t Model::get_element(std::size_t i) const {
+        if (auto short_elements = get_short_element_span(); !short_elements.empty())
+            return short_elements[i];
+        return get_element_span()[i];
+    }
+
+    AABB Model::get_bounding_box() const {
+        glm::vec3 size { bounds_max - bounds_min };
+
+        return AABB {
+            bounds_min,
+            glm::length(size),
+            size,
+            size.x * size.y * size.z
+        };
+    }
+
+    // From "Real-Time Collision Detection" by Christer Ericson (5.1.5).
+    static glm::vec3 closest_point_on_triangle(const glm::vec3& p, const glm::vec3& a,
+                                               const glm::vec3& b, const glm::vec3& c) {
+        glm::vec3 ab { b - a }, ac { c - a }, ap { p - a };
+
+        float d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+        if (d1 <= 0.0f && d2 <= 0.0f) return a;
+
+        glm::vec3 bp { p - b };
+        float d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+        if (d3 >= 0.0f && d4 <= d3) return b;
+
+        float vc = d1 * d4 - d3 * d2;
+        if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+            return a + ab * (d1 / (d1 - d3));
+
+        glm::vec3 cp { p - c };
+        float d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+        if (d6 >= 0.0f && d5 <= d6) return c;
+
+        float vb = d5 * d2 - d1 * d6;
+        if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+            return a + ac * (d2 / (d2 - d6));
+
+        float va = d3 * d6 - d5 * d4;
+        if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+            return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+        float denominator = 1.0f / (va + vb + vc);
+        return a + ab * (vb * denominator) + ac * (vc * denominator);
+    }
+
+    void Model::generate_distance_field(unsigned resolution, float padding) {
+        distance_field.resolution = glm::uvec3 { resolution };
+        distance_field.distances.assign(resolution * resolution * resolution, std::numeric_limits<float>::max());
+
+        glm::vec3 padding_size { (bounds_max - bounds_min) * padding };
+        distance_field.origin = bounds_min - padding_size;
+        distance_field.size   = bounds_max - bounds_min + 2.0f * padding_size;
+
+        std::size_t triangle_count { get_element_count() / 3 };
+        if (triangle_count == 0) return;
+
+        auto mesh_vertices = get_vertex_span();
+
+        // The triangles are binned into a coarser grid of cells (by their bounds), and each voxel only
+        // looks at the cells around it, ring by ring, until the rest of the rings are all further away.
+        glm::ivec3 cells { glm::max(glm::ivec3 { static_cast<int>(resolution / 4) }, glm::ivec3 { 1 }) };
+        glm::vec3 cell_size { distance_field.size / glm::vec3 { cells } };
+        float min_cell_size = std::min({ cell_size.x, cell_size.y, cell_size.z });
+
+        auto cell_of = [&](const glm::vec3& position) {
+            return glm::clamp(glm::ivec3 { glm::floor((position - distance_field.origin) / cell_size) },
+                              glm::ivec3 { 0 }, cells - 1);
+        };
+
+        std::vector<std::vector<std::uint32_t>> cell_triangles(cells.x * cells.y * cells.z);
+
+        for (std::uint32_t triangle { 0 }; triangle < triangle_count; ++triangle) {
+            const auto& a = mesh_vertices[get_element(3*triangle + 0)].position;
+            const auto& b = mesh_vertices[get_element(3*triangle + 1)].position;
+            const auto& c = mesh_vertices[get_element(3*triangle + 2)].position;
+
+            auto lower = cell_of(glm::min(a, glm::min(b, c)));
+            auto upper = cell_of(glm::max(a, glm::max(b, c)));
+
+            for (int z = lower.z; z <= upper.z; ++z)
+            for (int y = lower.y; y <= upper.y; ++y)
+            for (int x = lower.x; x <= upper.x; ++x)
+                cell_triangles[x + y*cells.x + z*cells.x*cells.y].push_back(triangle);
+        }
+
+        glm::vec3 voxel_size { distance_field.size / glm::vec3 { distance_field.resolution } };
+
+        auto bake_voxel = [&](const glm::vec3& position) {
+            float closest_distance { std::numeric_limits<float>::max() };
+            float closest_side { 1.0f };
+
+            auto cell = cell_of(position);
+            int max_ring = std::max({ cells.x, cells.y, cells.z });
+
+            for (int ring { 0 }; ring < max_ring; ++ring) {
+                for (int z = cell.z - ring; z <= cell.z + ring; ++z)
+                for (int y = cell.y - ring; y <= cell.y + ring; ++y)
+                for (int x = cell.x - ring; x <= cell.x + ring; ++x) {
+                    if (std::max({ std::abs(x - cell.x), std::abs(y - cell.y), std::abs(z - cell.z) }) != ring)
+                        continue; // was in an earlier ring.
+                    if (x < 0 || y < 0 || z < 0 || x >= cells.x || y >= cells.y || z >= cells.z)
+                        continue;
+
+                    for (auto triangle : cell_triangles[x + y*cells.x + z*cells.x*cells.y]) {
+                        const auto& a = mesh_vertices[get_element(3*triangle + 0)].position;
+                        const auto& b = mesh_vertices[get_element(3*triangle + 1)].position;
+                        const auto& c = mesh_vertices[get_element(3*triangle + 2)].position;
+
+                        auto closest_point = closest_point_on_triangle(position, a, b, c);
+                        float distance = glm::distance(position, closest_point);
+
+                        if (distance < closest_distance) {
+                            closest_distance = distance;
+                            // Inside if it's behind the (counter-clockwise) face.
+                            closest_side = glm::dot(position - closest_point, glm::cross(b - a, c - a)) < 0.0f ? -1.0f : 1.0f;
+                        }
+                    }
+                }
+
+                // Everything in the next rings is at least this far away.
+                if (closest_distance <= ring * min_cell_size)
+                    break;
+            }
+
+            return closest_side * closest_distance;
+        };
+
+        JobSystem::get().parallel_for(0, static_cast<int>(resolution), 1, [&](int k) {
+            for (unsigned j { 0 }; j < resolution; ++j)
+            for (unsigned i { 0 }; i < resolution; ++i) {
+                glm::vec3 position { distance_field.origin + (glm::vec3 { i, j, k } + 0.5f) * voxel_size };
+                distance_field.distances[i + j*resolution + k*resolution*resolution] = bake_voxel(position);
+            }
+        });
+    }
+
+    const Model::DistanceField& Model::get_distance_field() const {
+        return distance_field;
+    }
+
+    bool Model::has_distance_field() const {
+        return !distance_field.distances.empty();
+    }
+
+    float Model::DistanceField::sample(const glm::vec3& position) const {
+        glm::vec3 grid { (position - origin) / size * glm::vec3 { resolution } - 0.5f };
+        grid = glm::clamp(grid, glm::vec3 { 0.0f }, glm::vec3 { resolution - 1u });
+
+        glm::uvec3 lower { glm::min(glm::uvec3 { grid }, glm::max(resolution, 2u) - 2u) };
+        glm::vec3 weight { grid - glm::vec3 { lower } };
+
+        auto distance = [&](unsigned i, unsigned j, unsigned k) {
+            return distances[glm::min(i, resolution.x - 1) +
+                             glm::min(j, resolution.y - 1) * resolution.x +
+                             glm::min(k, resolution.z - 1) * resolution.x * resolution.y];
+        };
+
+        float x00 = glm::mix(distance(lower.x, lower.y,     lower.z),     distance(lower.x + 1, lower.y,     lower.z),     weight.x);
+        float x10 = glm::mix(distance(lower.x, lower.y + 1, lower.z),     distance(lower.x + 1, lower.y + 1, lower.z),     weight.x);
+        float x01 = glm::mix(distance(lower.x, lower.y,     lower.z + 1), distance(lower.x + 1, lower.y,     lower.z + 1), weight.x);
+        float x11 = glm::mix(distance(lower.x, lower.y + 1, lower.z + 1), distance(lower.x + 1, lower.y + 1, lower.z + 1), weight.x);
+
+        return glm::mix(glm::mix(x00, x10, weight.y), glm::mix(x01, x11, weight.y), weight.z);
+    }
+
 #ifdef USE_MODEL_TEXTURE
 	vkhr::Image Model::get_image() const {
 		return image;
 	}
+
+	const Texture& Model::get_texture() const {
+		return texture;
+	}
 #endif
 }
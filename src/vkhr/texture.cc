@@ -0,0 +1,221 @@
+#include <vkhr/texture.hh>
+
+#include <algorithm>
+#include <cstring>
+
+namespace vkhr {
+    // From the KTX 2.0 and DDS (DX10) specifications, for only the formats above.
+    static constexpr unsigned char Ktx2Identifier[12] { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+    static constexpr std::size_t Ktx2HeaderSize { 80 }; // with the index, and before the levels.
+
+    enum Ktx2Format : std::uint32_t {
+        Ktx2_BC1_RGB_UNORM  = 131, Ktx2_BC1_RGB_SRGB  = 132,
+        Ktx2_BC1_RGBA_UNORM = 133, Ktx2_BC1_RGBA_SRGB = 134,
+        Ktx2_BC5_UNORM      = 141,
+        Ktx2_BC7_UNORM      = 145, Ktx2_BC7_SRGB      = 146
+    };
+
+    static constexpr std::size_t DdsHeaderSize { 128 }; // with the magic.
+    static constexpr std::size_t DdsDx10HeaderSize { 20 };
+
+    enum DxgiFormat : std::uint32_t {
+        Dxgi_BC1_UNORM = 71, Dxgi_BC1_SRGB = 72,
+        Dxgi_BC5_UNORM = 83,
+        Dxgi_BC7_UNORM = 98, Dxgi_BC7_SRGB = 99
+    };
+
+    template<typename T>
+    static T read(const char* data, std::size_t offset) {
+        T value;
+        std::memcpy(&value, data + offset, sizeof(T));
+        return value;
+    }
+
+    Texture::Texture(const std::string& file_path) {
+        load(file_path);
+    }
+
+    bool Texture::load(const std::string& file_path) {
+        levels.clear();
+
+        auto memory_map = std::make_shared<MemoryMap>();
+        if (!memory_map->open(file_path))
+            return false;
+
+        file = memory_map;
+
+        bool loaded { false };
+        if (file->get_size() >= sizeof(Ktx2Identifier) && std::memcmp(file->get_data(), Ktx2Identifier, sizeof(Ktx2Identifier)) == 0)
+            loaded = load_ktx2();
+        else if (file->get_size() >= 4 && std::memcmp(file->get_data(), "DDS ", 4) == 0)
+            loaded = load_dds();
+
+        if (!loaded) {
+            levels.clear();
+            file.reset();
+        }
+
+        return loaded;
+    }
+
+    Texture::operator bool() const {
+        return !levels.empty();
+    }
+
+    Texture Texture::find(const std::string& path_without_extension) {
+        for (auto extension : { ".ktx2", ".dds" }) {
+            Texture texture { path_without_extension + extension };
+            if (texture) return texture;
+        }
+
+        return Texture { };
+    }
+
+    bool Texture::load_ktx2() {
+        if (file->get_size() < Ktx2HeaderSize)
+            return false;
+
+        const char* data = file->get_data();
+
+        auto vk_format    = read<std::uint32_t>(data, 12);
+        width             = read<std::uint32_t>(data, 20);
+        height            = read<std::uint32_t>(data, 24);
+        auto depth        = read<std::uint32_t>(data, 28);
+        auto layer_count  = read<std::uint32_t>(data, 32);
+        auto face_count   = read<std::uint32_t>(data, 36);
+        auto level_count  = std::max(read<std::uint32_t>(data, 40), 1u);
+        auto supercompression = read<std::uint32_t>(data, 44);
+
+        if (depth > 1 || layer_count > 1 || face_count != 1 || supercompression != 0)
+            return false;
+
+        switch (vk_format) {
+        case Ktx2_BC1_RGB_UNORM: case Ktx2_BC1_RGBA_UNORM: format = Format::BC1; srgb = false; break;
+        case Ktx2_BC1_RGB_SRGB:  case Ktx2_BC1_RGBA_SRGB:  format = Format::BC1; srgb = true;  break;
+        case Ktx2_BC5_UNORM: format = Format::BC5; srgb = false; break;
+        case Ktx2_BC7_UNORM: format = Format::BC7; srgb = false; break;
+        case Ktx2_BC7_SRGB:  format = Format::BC7; srgb = true;  break;
+        default: return false;
+        }
+
+        // The level index is three 64-bit words a level, of which only the offset and size are needed.
+        if (file->get_size() < Ktx2HeaderSize + level_count * 3 * sizeof(std::uint64_t))
+            return false;
+
+        for (std::uint32_t level { 0 }; level < level_count; ++level) {
+            auto offset = read<std::uint64_t>(data, Ktx2HeaderSize + level * 3 * sizeof(std::uint64_t));
+            auto size   = read<std::uint64_t>(data, Ktx2HeaderSize + level * 3 * sizeof(std::uint64_t) + sizeof(std::uint64_t));
+
+            unsigned level_width  = std::max(width  >> level, 1u),
+                     level_height = std::max(height >> level, 1u);
+
+            if (size != get_level_size(format, level_width, level_height) || offset + size > file->get_size())
+                return false;
+
+            levels.push_back({ static_cast<std::size_t>(offset), static_cast<std::size_t>(size), level_width, level_height });
+        }
+
+        return true;
+    }
+
+    bool Texture::load_dds() {
+        if (file->get_size() < DdsHeaderSize)
+            return false;
+
+        const char* data = file->get_data();
+
+        height           = read<std::uint32_t>(data, 12);
+        width            = read<std::uint32_t>(data, 16);
+        auto level_count = std::max(read<std::uint32_t>(data, 28), 1u);
+
+        char four_cc[4];
+        std::memcpy(four_cc, data + 84, sizeof(four_cc));
+
+        std::size_t offset { DdsHeaderSize };
+
+        if (std::memcmp(four_cc, "DXT1", 4) == 0) {
+            format = Format::BC1; srgb = false;
+        } else if (std::memcmp(four_cc, "ATI2", 4) == 0 || std::memcmp(four_cc, "BC5U", 4) == 0) {
+            format = Format::BC5; srgb = false;
+        } else if (std::memcmp(four_cc, "DX10", 4) == 0) {
+            if (file->get_size() < DdsHeaderSize + DdsDx10HeaderSize)
+                return false;
+
+            auto dxgi_format = read<std::uint32_t>(data, DdsHeaderSize);
+            auto array_size  = read<std::uint32_t>(data, DdsHeaderSize + 12);
+
+            if (array_size > 1)
+                return false;
+
+            switch (dxgi_format) {
+            case Dxgi_BC1_UNORM: format = Format::BC1; srgb = false; break;
+            case Dxgi_BC1_SRGB:  format = Format::BC1; srgb = true;  break;
+            case Dxgi_BC5_UNORM: format = Format::BC5; srgb = false; break;
+            case Dxgi_BC7_UNORM: format = Format::BC7; srgb = false; break;
+            case Dxgi_BC7_SRGB:  format = Format::BC7; srgb = true;  break;
+            default: return false;
+            }
+
+            offset += DdsDx10HeaderSize;
+        } else {
+            return false;
+        }
+
+        return add_levels(offset, level_count);
+    }
+
+    bool Texture::add_levels(std::size_t offset, std::size_t level_count) {
+        for (std::size_t level { 0 }; level < level_count; ++level) {
+            unsigned level_width  = std::max(width  >> level, 1u),
+                     level_height = std::max(height >> level, 1u);
+
+            auto size = get_level_size(format, level_width, level_height);
+            if (offset + size > file->get_size())
+                return false;
+
+            levels.push_back({ offset, size, level_width, level_height });
+            offset += size;
+        }
+
+        return true;
+    }
+
+    Texture::Format Texture::get_format() const {
+        return format;
+    }
+
+    bool Texture::is_srgb() const {
+        return srgb;
+    }
+
+    unsigned Texture::get_width() const {
+        return width;
+    }
+
+    unsigned Texture::get_height() const {
+        return height;
+    }
+
+    const std::vector<Texture::Level>& Texture::get_levels() const {
+        return levels;
+    }
+
+    const char* Texture::get_level_data(std::size_t level) const {
+        return file->get_data() + levels[level].offset;
+    }
+
+    std::size_t Texture::get_size_in_bytes() const {
+        std::size_t size { 0 };
+        for (const auto& level : levels)
+            size += level.size;
+        return size;
+    }
+
+    std::size_t Texture::get_block_size(Format format) {
+        return format == Format::BC1 ? 8 : 16;
+    }
+
+    std::size_t Texture::get_level_size(Format format, unsigned width, unsigned height) {
+        return static_cast<std::size_t>((width + 3) / 4) * ((height + 3) / 4) * get_block_size(format);
+    }
+}
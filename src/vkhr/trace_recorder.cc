@@ -0,0 +1,121 @@
+#include <vkhr/trace_recorder.hh>
+
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+namespace vkhr {
+    struct TraceEvent {
+        std::string name;
+        double begin_time, end_time;
+        std::size_t thread; // or 0 for the GPU.
+    };
+
+    struct Trace {
+        std::atomic<bool> recording { false };
+        std::string path;
+        std::mutex mutex;
+        std::vector<TraceEvent> events;
+        std::atomic<std::size_t> thread_count { 0 };
+    };
+
+    static Trace& get_trace() {
+        static Trace trace;
+        return trace;
+    }
+
+    static const TraceRecorder::Clock::time_point start_time { TraceRecorder::Clock::now() };
+
+    static constexpr int CpuProcess { 1 }, GpuProcess { 2 };
+
+    void TraceRecorder::start(const std::string& trace_path) {
+        auto& trace = get_trace();
+        std::lock_guard<std::mutex> lock { trace.mutex };
+        trace.path = trace_path;
+        trace.events.clear();
+        trace.recording = true;
+    }
+
+    bool TraceRecorder::stop() {
+        auto& trace = get_trace();
+        if (!trace.recording)
+            return false;
+
+        trace.recording = false;
+
+        std::lock_guard<std::mutex> lock { trace.mutex };
+
+        auto events = nlohmann::json::array();
+
+        events.push_back({ { "name", "process_name" }, { "ph", "M" }, { "pid", CpuProcess }, { "args", { { "name", "CPU" } } } });
+        events.push_back({ { "name", "process_name" }, { "ph", "M" }, { "pid", GpuProcess }, { "args", { { "name", "GPU" } } } });
+
+        for (const auto& event : trace.events) {
+            events.push_back({
+                { "name", event.name },
+                { "cat", event.thread == 0 ? "GPU" : "CPU" },
+                { "ph", "X" },
+                { "ts", event.begin_time },
+                { "dur", event.end_time - event.begin_time },
+                { "pid", event.thread == 0 ? GpuProcess : CpuProcess },
+                { "tid", event.thread }
+            });
+        }
+
+        std::ofstream file { trace.path };
+        if (!file)
+            return false;
+
+        file << nlohmann::json { { "traceEvents", events }, { "displayTimeUnit", "ms" } } << std::endl;
+
+        trace.events.clear();
+
+        return true;
+    }
+
+    bool TraceRecorder::is_recording() {
+        return get_trace().recording.load(std::memory_order_relaxed);
+    }
+
+    double TraceRecorder::get_time() {
+        return get_time(Clock::now());
+    }
+
+    double TraceRecorder::get_time(Clock::time_point time_point) {
+        return std::chrono::duration<double, std::micro> { time_point - start_time }.count();
+    }
+
+    void TraceRecorder::record_cpu_span(const char* name, double begin_time, double end_time) {
+        auto& trace = get_trace();
+        if (!trace.recording)
+            return;
+
+        // Numbered in the order they're first seen, starting at 1, since 0 is the GPU's track.
+        static thread_local std::size_t thread { ++trace.thread_count };
+
+        std::lock_guard<std::mutex> lock { trace.mutex };
+        trace.events.push_back({ name, begin_time, end_time, thread });
+    }
+
+    void TraceRecorder::record_gpu_span(const std::string& name, double begin_time, double end_time) {
+        auto& trace = get_trace();
+        if (!trace.recording)
+            return;
+
+        std::lock_guard<std::mutex> lock { trace.mutex };
+        trace.events.push_back({ name, begin_time, end_time, 0 });
+    }
+
+    TraceRecorder::Scope::Scope(const char* name) : name { name } {
+        if (is_recording())
+            begin_time = get_time();
+    }
+
+    TraceRecorder::Scope::~Scope() noexcept {
+        if (begin_time >= 0.0 && is_recording())
+            record_cpu_span(name, begin_time, get_time());
+    }
+}
@@ -0,0 +1,151 @@
+#include <vkhr/video_writer.hh>
+
+#include <iostream>
+
+namespace vkhr {
+    VideoWriter::VideoWriter(const std::string& output, unsigned frame_rate) {
+        open(output, frame_rate);
+    }
+
+    VideoWriter::~VideoWriter() noexcept {
+        close();
+    }
+
+    bool VideoWriter::open(const std::string& output, unsigned rate) {
+        close();
+
+        frame_rate = rate;
+        header_written = false;
+        written_frames = 0;
+        stopping = false;
+
+        piped = !output.empty() && output.front() == '|';
+
+        if (piped) {
+#ifndef WINDOWS
+            file = popen(output.c_str() + 1, "w");
+#else
+            file = _popen(output.c_str() + 1, "wb");
+#endif
+            raw = false;
+        } else {
+            file = std::fopen(output.c_str(), "wb");
+            raw = output.size() >= 5 && output.compare(output.size() - 5, 5, ".rgba") == 0;
+        }
+
+        if (file == nullptr)
+            return false;
+
+        write_thread = std::thread { &VideoWriter::write_loop, this };
+
+        return true;
+    }
+
+    bool VideoWriter::is_open() const {
+        return file != nullptr;
+    }
+
+    void VideoWriter::close() {
+        if (!write_thread.joinable())
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock { queue_mutex };
+            stopping = true;
+        }
+
+        queued.notify_one();
+        write_thread.join();
+
+#ifndef WINDOWS
+        if (piped) pclose(file);
+#else
+        if (piped) _pclose(file);
+#endif
+        else std::fclose(file);
+
+        file = nullptr;
+    }
+
+    void VideoWriter::write(Image&& frame) {
+        if (!is_open())
+            return;
+
+        {
+            std::unique_lock<std::mutex> lock { queue_mutex };
+            dequeued.wait(lock, [&] { return queue.size() < MaximumQueuedFrames; });
+            queue.push_back(std::move(frame));
+        }
+
+        queued.notify_one();
+    }
+
+    std::size_t VideoWriter::get_written_frames() const {
+        std::lock_guard<std::mutex> lock { queue_mutex };
+        return written_frames;
+    }
+
+    void VideoWriter::write_loop() {
+        std::unique_lock<std::mutex> lock { queue_mutex };
+
+        while (true) {
+            queued.wait(lock, [&] { return stopping || !queue.empty(); });
+
+            if (queue.empty())
+                break; // only stops once everything was written.
+
+            auto frame = std::move(queue.front());
+            queue.pop_front();
+            dequeued.notify_one();
+
+            lock.unlock();
+            bool written = write_frame(frame);
+            lock.lock();
+
+            if (!written) {
+                std::cerr << "Couldn't write frame " << written_frames << " of the video!" << std::endl;
+                queue.clear(); // e.g. the encoder went away.
+                dequeued.notify_all();
+                break;
+            }
+
+            ++written_frames;
+        }
+    }
+
+    bool VideoWriter::write_frame(const Image& frame) {
+        std::size_t pixel_count = frame.get_pixel_count();
+
+        if (raw)
+            return std::fwrite(frame.get_data(), Image::BytesPerPixel, pixel_count, file) == pixel_count;
+
+        if (!header_written) {
+            if (std::fprintf(file, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C444\n", frame.get_width(),
+                                                                            frame.get_height(),
+                                                                            frame_rate) < 0)
+                return false;
+            header_written = true;
+        }
+
+        if (std::fputs("FRAME\n", file) < 0)
+            return false;
+
+        planes.resize(pixel_count * 3);
+
+        auto y_plane = planes.data(),
+             u_plane = y_plane + pixel_count,
+             v_plane = u_plane + pixel_count;
+
+        const Color* pixels = frame.get_pixels();
+
+        // BT.601 in the limited "studio" range, since that's what Y4M readers all assume it is.
+        for (std::size_t i { 0 }; i < pixel_count; ++i) {
+            int r = pixels[i].r, g = pixels[i].g, b = pixels[i].b;
+            y_plane[i] = static_cast<unsigned char>((( 66 * r + 129 * g +  25 * b + 128) >> 8) +  16);
+            u_plane[i] = static_cast<unsigned char>(((-38 * r -  74 * g + 112 * b + 128) >> 8) + 128);
+            v_plane[i] = static_cast<unsigned char>(((112 * r -  94 * g -  18 * b + 128) >> 8) + 128);
+        }
+
+        return std::fwrite(planes.data(), 1, planes.size(), file) == planes.size();
+    }
+}
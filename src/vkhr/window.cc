@@ -4,9 +4,17 @@
 
 namespace vkhr {
     Window::Window(const int width, const int height, const std::string& title,
-                   const Image& icon, const bool fullscreen, const bool vsync)
+                   const Image& icon, const bool fullscreen, const bool vsync,
+                   const bool offscreen)
                   : width { width }, height { height }, title { title },
-                    vsync { vsync } { // fullscreen setting is set later
+                    vsync { vsync }, offscreen { offscreen } { // fullscreen setting is set later
+#if GLFW_VERSION_MAJOR > 3 || GLFW_VERSION_MINOR >= 4
+        // So it works on machines without any display, e.g. the GPU CI runners. Otherwise it's
+        // only a hidden window, and still needs one (e.g. Xvfb), but isn't presented to either.
+        if (offscreen)
+            glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
+
         if (!glfwInit()) {
             throw std::runtime_error { "Failed to initialize GLFW 3!" };
         }
@@ -60,6 +68,7 @@ namespace vkhr {
 
         glfwSetWindowUserPointer(handle, this);
         glfwSetFramebufferSizeCallback(handle, framebuffer_callback);
+        glfwSetWindowRefreshCallback(handle, refresh_callback);
         glfwSetWindowPos(handle, monitor_center_x, monitor_center_y);
         if (fullscreen) toggle_fullscreen();
     }
@@ -81,6 +90,10 @@ namespace vkhr {
         return fullscreen;
     }
 
+    bool Window::is_offscreen() const {
+        return offscreen;
+    }
+
     void Window::toggle_fullscreen() {
         if (frame_time != -1) surface_dirty = true;
         if (!fullscreen) {
@@ -250,6 +263,15 @@ namespace vkhr {
         return false;
     }
 
+    bool Window::needs_refresh() const {
+        if (refresh_needed) {
+            refresh_needed = false;
+            return true;
+        }
+
+        return false;
+    }
+
     void Window::poll_events() {
         if (frame_time == -1) { // First frame of program
             fps_update = frame_time = get_current_time();
@@ -278,6 +300,15 @@ namespace vkhr {
         ++frames;
     }
 
+    void Window::wait_events(float timeout) {
+        float elapsed_time = get_current_time();
+        frame_time = elapsed_time - last_frame_time;
+
+        glfwWaitEventsTimeout(timeout);
+
+        last_frame_time = get_current_time(); // not counting the wait.
+    }
+
     float Window::get_vertical_dpi() const {
         return vertical_dpi;
     }
@@ -303,6 +334,8 @@ namespace vkhr {
     }
 
     void Window::maximized() {
+        if (offscreen)
+            return; // it's never minimized, and there wouldn't be any events to wait for.
         int    new_width  = 0,   new_height  = 0;
         while (new_width == 0 || new_height == 0) {
             glfwGetFramebufferSize(handle, &new_width, &new_height);
@@ -312,6 +345,11 @@ namespace vkhr {
         set_resolution(new_width, new_height);
     }
 
+    void Window::refresh_callback(GLFWwindow* handle) {
+        Window* window { static_cast<Window*>(glfwGetWindowUserPointer(handle)) };
+        window->refresh_needed = true;
+    }
+
     void Window::framebuffer_callback(GLFWwindow* handle, int new_width, int new_height) {
         Window* window { static_cast<Window*>(glfwGetWindowUserPointer(handle)) };
         if (window->get_width() != new_width || window->get_height() != new_height) {
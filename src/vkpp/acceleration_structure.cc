@@ -0,0 +1,155 @@
+#include <vkpp/acceleration_structure.hh>
+
+#include <vkpp/command_buffer.hh>
+#include <vkpp/device.hh>
+
+#include <vkpp/exception.hh>
+
+#include <utility>
+
+namespace vkpp {
+#ifdef VK_KHR_acceleration_structure
+    static VkAccelerationStructureBuildGeometryInfoKHR get_build_info(VkAccelerationStructureTypeKHR type,
+                                                                      VkBuildAccelerationStructureFlagsKHR flags,
+                                                                      const VkAccelerationStructureGeometryKHR& geometry) {
+        VkAccelerationStructureBuildGeometryInfoKHR build_info;
+        build_info.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
+        build_info.pNext = nullptr;
+        build_info.type  = type;
+        build_info.flags = flags;
+        build_info.mode  = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+        build_info.srcAccelerationStructure = VK_NULL_HANDLE;
+        build_info.dstAccelerationStructure = VK_NULL_HANDLE;
+        build_info.geometryCount = 1;
+        build_info.pGeometries   = &geometry;
+        build_info.ppGeometries  = nullptr;
+        build_info.scratchData.deviceAddress = 0;
+        return build_info;
+    }
+
+    AccelerationStructure::AccelerationStructure(Device& logical_device,
+                                                 VkAccelerationStructureTypeKHR type,
+                                                 const VkAccelerationStructureGeometryKHR& geometry,
+                                                 std::uint32_t max_primitive_count,
+                                                 VkBuildAccelerationStructureFlagsKHR flags)
+                                                : type { type },
+                                                  flags { flags },
+                                                  device { logical_device.get_handle() } {
+        auto build_info = get_build_info(type, flags, geometry);
+
+        VkAccelerationStructureBuildSizesInfoKHR build_sizes;
+        build_sizes.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
+        build_sizes.pNext = nullptr;
+
+        vkGetAccelerationStructureBuildSizesKHR(device, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
+                                                &build_info, &max_primitive_count, &build_sizes);
+
+        storage = AddressableBuffer {
+            logical_device,
+            build_sizes.accelerationStructureSize,
+            VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR
+        };
+
+        scratch = AddressableBuffer {
+            logical_device,
+            build_sizes.buildScratchSize,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+        };
+
+        VkAccelerationStructureCreateInfoKHR create_info;
+        create_info.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
+        create_info.pNext = nullptr;
+        create_info.createFlags = 0;
+        create_info.buffer = storage.get_handle();
+        create_info.offset = 0;
+        create_info.size = build_sizes.accelerationStructureSize;
+        create_info.type = type;
+        create_info.deviceAddress = 0;
+
+        if (VkResult error = vkCreateAccelerationStructureKHR(device, &create_info, nullptr, &handle)) {
+            throw Exception { error, "couldn't create acceleration structure!" };
+        }
+    }
+
+    AccelerationStructure::~AccelerationStructure() noexcept {
+        if (handle != VK_NULL_HANDLE) {
+            vkDestroyAccelerationStructureKHR(device, handle, nullptr);
+        }
+    }
+
+    AccelerationStructure::AccelerationStructure(AccelerationStructure&& acceleration_structure) noexcept {
+        swap(*this, acceleration_structure);
+    }
+
+    AccelerationStructure& AccelerationStructure::operator=(AccelerationStructure&& acceleration_structure) noexcept {
+        swap(*this, acceleration_structure);
+        return *this;
+    }
+
+    void swap(AccelerationStructure& lhs, AccelerationStructure& rhs) {
+        using std::swap;
+
+        swap(lhs.type,  rhs.type);
+        swap(lhs.flags, rhs.flags);
+
+        swap(lhs.storage, rhs.storage);
+        swap(lhs.scratch, rhs.scratch);
+
+        swap(lhs.handle, rhs.handle);
+        swap(lhs.device, rhs.device);
+    }
+
+    VkAccelerationStructureKHR& AccelerationStructure::get_handle() {
+        return handle;
+    }
+
+    void AccelerationStructure::build(CommandBuffer& command_buffer,
+                                      const VkAccelerationStructureGeometryKHR& geometry,
+                                      std::uint32_t primitive_count) {
+        auto build_info = get_build_info(type, flags, geometry);
+        build_info.dstAccelerationStructure  = handle;
+        build_info.scratchData.deviceAddress = scratch.get_device_address();
+
+        VkAccelerationStructureBuildRangeInfoKHR build_range;
+        build_range.primitiveCount  = primitive_count;
+        build_range.primitiveOffset = 0;
+        build_range.firstVertex     = 0;
+        build_range.transformOffset = 0;
+
+        const VkAccelerationStructureBuildRangeInfoKHR* build_ranges { &build_range };
+
+        vkCmdBuildAccelerationStructuresKHR(command_buffer.get_handle(), 1, &build_info, &build_ranges);
+    }
+
+    VkDeviceAddress AccelerationStructure::get_device_address() const {
+        VkAccelerationStructureDeviceAddressInfoKHR address_info;
+        address_info.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR;
+        address_info.pNext = nullptr;
+        address_info.accelerationStructure = handle;
+        return vkGetAccelerationStructureDeviceAddressKHR(device, &address_info);
+    }
+
+    VkDeviceSize AccelerationStructure::get_size() const {
+        return storage.get_size();
+    }
+
+    void AccelerationStructure::setup_function_pointers(VkDevice device) {
+        vkCreateAccelerationStructureKHR  = (PFN_vkCreateAccelerationStructureKHR)  vkGetDeviceProcAddr(device, "vkCreateAccelerationStructureKHR");
+        vkDestroyAccelerationStructureKHR = (PFN_vkDestroyAccelerationStructureKHR) vkGetDeviceProcAddr(device, "vkDestroyAccelerationStructureKHR");
+        vkGetAccelerationStructureBuildSizesKHR = (PFN_vkGetAccelerationStructureBuildSizesKHR) vkGetDeviceProcAddr(device, "vkGetAccelerationStructureBuildSizesKHR");
+        vkGetAccelerationStructureDeviceAddressKHR = (PFN_vkGetAccelerationStructureDeviceAddressKHR) vkGetDeviceProcAddr(device, "vkGetAccelerationStructureDeviceAddressKHR");
+        vkCmdBuildAccelerationStructuresKHR = (PFN_vkCmdBuildAccelerationStructuresKHR) vkGetDeviceProcAddr(device, "vkCmdBuildAccelerationStructuresKHR");
+        if (!vkCreateAccelerationStructureKHR || !vkDestroyAccelerationStructureKHR || !vkGetAccelerationStructureBuildSizesKHR ||
+            !vkGetAccelerationStructureDeviceAddressKHR || !vkCmdBuildAccelerationStructuresKHR) {
+            throw Exception { "couldn't setup the acceleration structure!",
+            "the VK_KHR_acceleration_structure fns don't exist!"};
+        }
+    }
+
+    PFN_vkCreateAccelerationStructureKHR AccelerationStructure::vkCreateAccelerationStructureKHR = nullptr;
+    PFN_vkDestroyAccelerationStructureKHR AccelerationStructure::vkDestroyAccelerationStructureKHR = nullptr;
+    PFN_vkGetAccelerationStructureBuildSizesKHR AccelerationStructure::vkGetAccelerationStructureBuildSizesKHR = nullptr;
+    PFN_vkGetAccelerationStructureDeviceAddressKHR AccelerationStructure::vkGetAccelerationStructureDeviceAddressKHR = nullptr;
+    PFN_vkCmdBuildAccelerationStructuresKHR AccelerationStructure::vkCmdBuildAccelerationStructuresKHR = nullptr;
+#endif
+}
@@ -4,11 +4,43 @@
 #include <vkpp/exception.hh>
 #include <vkpp/debug_marker.hh>
 #include <vkpp/command_buffer.hh>
+#include <vkpp/staging_ring.hh>
 #include <vkpp/device.hh>
 
 #include <utility>
 
 namespace vkpp {
+    // Into a device local buffer, with the staging ring if there's one, or with a copy that's waited on.
+    static void upload(Device& device, CommandPool& command_pool, const void* buffer, VkDeviceSize size, Buffer& destination) {
+        auto staging_ring = command_pool.get_staging_ring();
+        if (staging_ring != nullptr && staging_ring->copy(buffer, size, destination))
+            return; // it's uploaded when the batch is submitted.
+
+        Buffer staging_buffer {
+            device,
+            size,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+        };
+
+        auto staging_memory_requirements = staging_buffer.get_memory_requirements();
+
+        DeviceMemory staging_memory {
+            device,
+            staging_memory_requirements,
+            DeviceMemory::Type::HostVisible
+        };
+
+        staging_buffer.bind(staging_memory);
+        staging_memory.copy(size, buffer);
+
+        auto command_buffer = command_pool.allocate_and_begin();
+        command_buffer.copy_buffer(staging_buffer, destination);
+        command_buffer.end();
+
+        command_pool.get_queue().submit(command_buffer)
+                                .wait_idle();
+    }
+
     Buffer::Buffer(Device& logical_device,
                    VkDeviceSize size_in_bytes,
                    VkBufferUsageFlags usage)
@@ -30,6 +62,21 @@ namespace vkpp {
         create_info.queueFamilyIndexCount = 0;
         create_info.pQueueFamilyIndices = nullptr;
 
+        std::uint32_t queue_families[2];
+
+        // Buffers are shared with the async compute queue, instead
+        // of transferring ownership every time we use them in both.
+        if (logical_device.has_async_compute_queue()) {
+            queue_families[0] = logical_device.get_graphics_queue().get_family_index();
+            queue_families[1] = logical_device.get_compute_queue().get_family_index();
+
+            sharing_mode = VK_SHARING_MODE_CONCURRENT;
+
+            create_info.sharingMode = sharing_mode;
+            create_info.queueFamilyIndexCount = 2;
+            create_info.pQueueFamilyIndices = queue_families;
+        }
+
         if (VkResult error = vkCreateBuffer(device, &create_info, nullptr, &handle)) {
             throw Exception { error, "couldn't create buffer!" };
         }
@@ -123,7 +170,30 @@ namespace vkpp {
 
     void Buffer::bind(DeviceMemory& device_memory, std::uint32_t offset) {
         memory = device_memory.get_handle();
-        vkBindBufferMemory(device, handle, memory, offset);
+        vkBindBufferMemory(device, handle, memory, device_memory.get_offset() + offset);
+    }
+
+    void Buffer::bind_peer(DeviceMemory& device_memory, std::uint32_t device_count, std::uint32_t memory_device) {
+        memory = device_memory.get_handle();
+
+        std::vector<std::uint32_t> device_indices(device_count, memory_device);
+
+        VkBindBufferMemoryDeviceGroupInfo device_group_info;
+        device_group_info.sType = VK_STRUCTURE_TYPE_BIND_BUFFER_MEMORY_DEVICE_GROUP_INFO;
+        device_group_info.pNext = nullptr;
+        device_group_info.deviceIndexCount = device_count;
+        device_group_info.pDeviceIndices = device_indices.data();
+
+        VkBindBufferMemoryInfo bind_info;
+        bind_info.sType = VK_STRUCTURE_TYPE_BIND_BUFFER_MEMORY_INFO;
+        bind_info.pNext = device_count > 1 ? &device_group_info : nullptr;
+        bind_info.buffer = handle;
+        bind_info.memory = memory;
+        bind_info.memoryOffset = device_memory.get_offset();
+
+        if (VkResult error = vkBindBufferMemory2(device, 1, &bind_info)) {
+            throw Exception { error, "couldn't bind the peer memory!" };
+        }
     }
 
     DeviceBuffer::DeviceBuffer(Device& device,
@@ -133,24 +203,26 @@ namespace vkpp {
                                VkBufferUsageFlags usage)
                               : Buffer { device,
                                          size,
-                                         VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage } {
-        Buffer staging_buffer {
-            device,
-            size,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT
-        };
-
-        auto staging_memory_requirements = staging_buffer.get_memory_requirements();
+                                         VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage } {
+        auto buffer_memory_requirements = get_memory_requirements();
 
-        DeviceMemory staging_memory {
+        device_memory = DeviceMemory {
             device,
-            staging_memory_requirements,
-            DeviceMemory::Type::HostVisible
+            buffer_memory_requirements,
+            DeviceMemory::Type::DeviceLocal
         };
 
-        staging_buffer.bind(staging_memory);
-        staging_memory.copy(size, buffer);
+        bind(device_memory);
+
+        upload(device, command_pool, buffer, size, *this);
+    }
 
+    DeviceBuffer::DeviceBuffer(Device& device,
+                               VkDeviceSize size,
+                               VkBufferUsageFlags usage)
+                              : Buffer { device,
+                                         size,
+                                         VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage } {
         auto buffer_memory_requirements = get_memory_requirements();
 
         device_memory = DeviceMemory {
@@ -160,21 +232,15 @@ namespace vkpp {
         };
 
         bind(device_memory);
-
-        auto command_buffer = command_pool.allocate_and_begin();
-        command_buffer.copy_buffer(staging_buffer, *this);
-        command_buffer.end();
-
-        command_pool.get_queue().submit(command_buffer)
-                                .wait_idle();
     }
 
     DeviceBuffer::DeviceBuffer(Device& device,
                                VkDeviceSize size,
-                               VkBufferUsageFlags usage)
+                               VkBufferUsageFlags usage,
+                               std::uint32_t memory_device)
                               : Buffer { device,
                                          size,
-                                         VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage } {
+                                         VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage } {
         auto buffer_memory_requirements = get_memory_requirements();
 
         device_memory = DeviceMemory {
@@ -183,7 +249,7 @@ namespace vkpp {
             DeviceMemory::Type::DeviceLocal
         };
 
-        bind(device_memory);
+        bind_peer(device_memory, device.get_device_count(), memory_device);
     }
 
     void swap(DeviceBuffer& lhs, DeviceBuffer& rhs) {
@@ -207,6 +273,75 @@ namespace vkpp {
         return device_memory;
     }
 
+#ifdef VK_KHR_buffer_device_address
+    AddressableBuffer::AddressableBuffer(Device& device,
+                                         CommandPool& command_pool,
+                                         const void* buffer,
+                                         VkDeviceSize size,
+                                         VkBufferUsageFlags usage)
+                                        : AddressableBuffer { device, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage } {
+        upload(device, command_pool, buffer, size, *this);
+    }
+
+    AddressableBuffer::AddressableBuffer(Device& device,
+                                         VkDeviceSize size,
+                                         VkBufferUsageFlags usage,
+                                         DeviceMemory::Type type)
+                                        : Buffer { device,
+                                                   size,
+                                                   VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT_KHR | usage } {
+        auto memory_requirements = get_memory_requirements();
+
+        device_memory = DeviceMemory {
+            device,
+            memory_requirements,
+            type,
+            VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT_KHR
+        };
+
+        bind(device_memory);
+    }
+
+    void swap(AddressableBuffer& lhs, AddressableBuffer& rhs) {
+        using std::swap;
+
+        swap(static_cast<Buffer&>(lhs), static_cast<Buffer&>(rhs));
+
+        swap(lhs.device_memory, rhs.device_memory);
+    }
+
+    AddressableBuffer& AddressableBuffer::operator=(AddressableBuffer&& buffer) noexcept {
+        swap(*this, buffer);
+        return *this;
+    }
+
+    AddressableBuffer::AddressableBuffer(AddressableBuffer&& buffer) noexcept {
+        swap(*this, buffer);
+    }
+
+    DeviceMemory& AddressableBuffer::get_device_memory() {
+        return device_memory;
+    }
+
+    VkDeviceAddress AddressableBuffer::get_device_address() const {
+        VkBufferDeviceAddressInfoKHR address_info;
+        address_info.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO_KHR;
+        address_info.pNext = nullptr;
+        address_info.buffer = handle;
+        return vkGetBufferDeviceAddressKHR(device, &address_info);
+    }
+
+    void AddressableBuffer::setup_function_pointers(VkDevice device) {
+        vkGetBufferDeviceAddressKHR = (PFN_vkGetBufferDeviceAddressKHR) vkGetDeviceProcAddr(device, "vkGetBufferDeviceAddressKHR");
+        if (vkGetBufferDeviceAddressKHR == nullptr) {
+            throw Exception { "couldn't setup the addressable buffer!",
+            "the vkGetBufferDeviceAddressKHR fn doesn't exist!"};
+        }
+    }
+
+    PFN_vkGetBufferDeviceAddressKHR AddressableBuffer::vkGetBufferDeviceAddressKHR = nullptr;
+#endif
+
     HostBuffer::HostBuffer(Device& device,
                            const void* buffer,
                            VkDeviceSize size,
@@ -302,10 +437,24 @@ namespace vkpp {
     IndexBuffer::IndexBuffer(Device& device,
                              CommandPool& command_pool,
                              const std::vector<unsigned>& indices)
+                            : IndexBuffer { device,
+                                            command_pool,
+                                            vkhr::Span<unsigned> { indices } } {  }
+
+    IndexBuffer::IndexBuffer(Device& device,
+                             CommandPool& command_pool,
+                             const std::vector<unsigned short>& indices)
+                            : IndexBuffer { device,
+                                            command_pool,
+                                            vkhr::Span<unsigned short> { indices } } {  }
+
+    IndexBuffer::IndexBuffer(Device& device,
+                             CommandPool& command_pool,
+                             const vkhr::Span<unsigned>& indices)
                             : DeviceBuffer { device,
                                              command_pool,
                                              indices.data(),
-                                             sizeof(indices[0]) * indices.size(),
+                                             indices.size_in_bytes(),
                                              VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
                                              VK_BUFFER_USAGE_STORAGE_BUFFER_BIT } {
         this->element_count = indices.size();
@@ -314,11 +463,11 @@ namespace vkpp {
 
     IndexBuffer::IndexBuffer(Device& device,
                              CommandPool& command_pool,
-                             const std::vector<unsigned short>& indices)
+                             const vkhr::Span<unsigned short>& indices)
                             : DeviceBuffer { device,
                                              command_pool,
                                              indices.data(),
-                                             sizeof(indices[0]) * indices.size(),
+                                             indices.size_in_bytes(),
                                              VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
                                              VK_BUFFER_USAGE_STORAGE_BUFFER_BIT } {
         this->element_count = indices.size();
@@ -352,8 +501,9 @@ namespace vkpp {
     }
 
     UniformBuffer::UniformBuffer(Device& device,
-                                 VkDeviceSize size)
-        : HostBuffer { device, size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT } {  }
+                                 VkDeviceSize size,
+                                 VkBufferUsageFlags usage)
+        : HostBuffer { device, size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | usage } {  }
 
     void swap(UniformBuffer& lhs, UniformBuffer& rhs) {
         using std::swap;
@@ -65,6 +65,44 @@ namespace vkpp {
         }
     }
 
+    void CommandBuffer::begin(RenderPass& render_pass, std::uint32_t subpass,
+                              Framebuffer& framebuffer,
+                              VkCommandBufferUsageFlags usage) {
+        begin(render_pass, subpass, framebuffer.get_handle(), usage);
+    }
+
+    void CommandBuffer::begin(RenderPass& render_pass, std::uint32_t subpass,
+                              VkCommandBufferUsageFlags usage) {
+        begin(render_pass, subpass, VK_NULL_HANDLE, usage);
+    }
+
+    void CommandBuffer::begin(RenderPass& render_pass, std::uint32_t subpass,
+                              VkFramebuffer framebuffer,
+                              VkCommandBufferUsageFlags usage) {
+        VkCommandBufferInheritanceInfo inheritance_info;
+        inheritance_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritance_info.pNext = nullptr;
+
+        inheritance_info.renderPass  = render_pass.get_handle();
+        inheritance_info.subpass     = subpass;
+        inheritance_info.framebuffer = framebuffer;
+
+        inheritance_info.occlusionQueryEnable = VK_FALSE;
+        inheritance_info.queryFlags = 0;
+        inheritance_info.pipelineStatistics = 0;
+
+        VkCommandBufferBeginInfo begin_info;
+        begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.pNext = nullptr;
+        begin_info.flags = usage | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+
+        begin_info.pInheritanceInfo = &inheritance_info;
+
+        if (VkResult error = vkBeginCommandBuffer(handle, &begin_info)) {
+            throw Exception { error, "failed to start recording command buffer!" };
+        }
+    }
+
     void CommandBuffer::pipeline_barrier(VkPipelineStageFlags source_stage_mask,
                                          VkPipelineStageFlags destination_stage_mask,
                                          VkMemoryBarrier memory_barrier) {
@@ -92,6 +130,17 @@ namespace vkpp {
                              1, &image_memory_barrier);
     }
 
+    void CommandBuffer::pipeline_barrier(VkPipelineStageFlags source_stage_mask,
+                                         VkPipelineStageFlags destination_stage_mask,
+                                         const std::vector<VkMemoryBarrier>& memory_barriers,
+                                         const std::vector<VkBufferMemoryBarrier>& buffer_memory_barriers,
+                                         const std::vector<VkImageMemoryBarrier>& image_memory_barriers) {
+        vkCmdPipelineBarrier(handle, source_stage_mask, destination_stage_mask, 0,
+                             static_cast<std::uint32_t>(memory_barriers.size()),        memory_barriers.data(),
+                             static_cast<std::uint32_t>(buffer_memory_barriers.size()), buffer_memory_barriers.data(),
+                             static_cast<std::uint32_t>(image_memory_barriers.size()),  image_memory_barriers.data());
+    }
+
     void CommandBuffer::blit_image(Image& source, Image& destination, VkFilter filter) {
         VkOffset3D blit_size;
         blit_size.x = destination.get_extent().width;
@@ -128,6 +177,24 @@ namespace vkpp {
                        1, &copy_region);
     }
 
+    void CommandBuffer::copy_image(Image& source, Image& destination,
+                                   std::uint32_t source_layer, VkOffset3D destination_offset) {
+        VkImageCopy copy_region {  };
+
+        copy_region.srcSubresource.aspectMask = source.get_aspect_mask();
+        copy_region.srcSubresource.baseArrayLayer = source_layer;
+        copy_region.srcSubresource.layerCount = 1;
+        copy_region.dstSubresource.aspectMask = destination.get_aspect_mask();
+        copy_region.dstSubresource.layerCount = 1;
+
+        copy_region.dstOffset = destination_offset;
+        copy_region.extent = source.get_extent();
+
+        vkCmdCopyImage(handle, source.get_handle(), source.get_layout(),
+                       destination.get_handle(), destination.get_layout(),
+                       1, &copy_region);
+    }
+
     void CommandBuffer::clear_color_image(Image& image, VkClearColorValue clear_color) {
         VkImageSubresourceRange clear_range {  };
 
@@ -163,10 +230,11 @@ namespace vkpp {
                         1, &buffer_copy);
     }
 
-    void CommandBuffer::copy_buffer_image(Buffer& source, Image& destination) {
+    void CommandBuffer::copy_buffer_image(Buffer& source, Image& destination,
+                                          VkDeviceSize source_offset) {
         VkBufferImageCopy region;
 
-        region.bufferOffset = 0;
+        region.bufferOffset = source_offset;
         region.bufferRowLength = 0;
         region.bufferImageHeight = 0;
 
@@ -184,8 +252,53 @@ namespace vkpp {
                                1, &region);
     }
 
+    void CommandBuffer::copy_buffer_image(Buffer& source, Image& destination,
+                                          const std::vector<VkBufferImageCopy>& regions) {
+        if (regions.empty())
+            return;
+
+        vkCmdCopyBufferToImage(handle,
+                               source.get_handle(), destination.get_handle(),
+                               destination.get_layout(),
+                               regions.size(), regions.data());
+    }
+
+    void CommandBuffer::copy_image_buffer(Image& source, Buffer& destination,
+                                          VkDeviceSize destination_offset) {
+        VkBufferImageCopy region;
+
+        region.bufferOffset = destination_offset;
+        region.bufferRowLength = 0; // i.e. tightly packed.
+        region.bufferImageHeight = 0;
+
+        region.imageSubresource.aspectMask = source.get_aspect_mask();
+        region.imageSubresource.mipLevel = 0;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+
+        region.imageOffset = { 0, 0, 0 };
+        region.imageExtent = source.get_extent();
+
+        vkCmdCopyImageToBuffer(handle,
+                               source.get_handle(), source.get_layout(),
+                               destination.get_handle(),
+                               1, &region);
+    }
+
+    void CommandBuffer::copy_image_buffer(Image& source, Buffer& destination,
+                                          const std::vector<VkBufferImageCopy>& regions) {
+        if (regions.empty())
+            return;
+
+        vkCmdCopyImageToBuffer(handle,
+                               source.get_handle(), source.get_layout(),
+                               destination.get_handle(),
+                               regions.size(), regions.data());
+    }
+
     void CommandBuffer::begin_render_pass(RenderPass& render_pass,
-                                          vkhr::vulkan::DepthMap& depth_map) {
+                                          vkhr::vulkan::DepthMap& depth_map,
+                                          VkSubpassContents contents) {
         VkRenderPassBeginInfo begin_info;
         begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
         begin_info.pNext = nullptr;
@@ -201,16 +314,28 @@ namespace vkpp {
         begin_info.pClearValues    = &depth_clear_value;
         begin_info.clearValueCount = 1;
 
-        vkCmdBeginRenderPass(handle, &begin_info, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdBeginRenderPass(handle, &begin_info, contents);
     }
 
-    void CommandBuffer::next_subpass() {
-        vkCmdNextSubpass(handle, VK_SUBPASS_CONTENTS_INLINE);
+    void CommandBuffer::next_subpass(VkSubpassContents contents) {
+        vkCmdNextSubpass(handle, contents);
+    }
+
+    void CommandBuffer::execute_commands(const std::vector<CommandBuffer*>& secondary_command_buffers) {
+        std::vector<VkCommandBuffer> command_buffers(secondary_command_buffers.size());
+        for (std::size_t i { 0 }; i < command_buffers.size(); ++i)
+            command_buffers[i] = secondary_command_buffers[i]->get_handle();
+
+        if (command_buffers.empty())
+            return;
+
+        vkCmdExecuteCommands(handle, command_buffers.size(), command_buffers.data());
     }
 
     void CommandBuffer::begin_render_pass(RenderPass& render_pass,
                                           Framebuffer& framebuffer,
-                                          VkClearValue clear_color) {
+                                          VkClearValue clear_color,
+                                          VkSubpassContents contents) {
         VkRenderPassBeginInfo begin_info;
         begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
         begin_info.pNext = nullptr;
@@ -231,7 +356,26 @@ namespace vkpp {
         begin_info.pClearValues    = clear_values.data();
         begin_info.clearValueCount = static_cast<std::uint32_t>(clear_values.size());
 
-        vkCmdBeginRenderPass(handle, &begin_info, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdBeginRenderPass(handle, &begin_info, contents);
+    }
+
+    void CommandBuffer::begin_render_pass(RenderPass& render_pass,
+                                          Framebuffer& framebuffer,
+                                          const std::vector<VkClearValue>& clear_values,
+                                          VkSubpassContents contents) {
+        VkRenderPassBeginInfo begin_info;
+        begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        begin_info.pNext = nullptr;
+
+        begin_info.renderPass = render_pass.get_handle();
+        begin_info.framebuffer = framebuffer.get_handle();
+        begin_info.renderArea.extent = framebuffer.get_extent();
+        begin_info.renderArea.offset = { 0, 0 };
+
+        begin_info.pClearValues    = clear_values.data();
+        begin_info.clearValueCount = static_cast<std::uint32_t>(clear_values.size());
+
+        vkCmdBeginRenderPass(handle, &begin_info, contents);
     }
 
     void CommandBuffer::set_viewport(VkViewport& viewport) {
@@ -259,11 +403,12 @@ namespace vkpp {
     }
 
     void CommandBuffer::bind_descriptor_set(DescriptorSet& descriptor_set,
-                                            Pipeline& pipeline) {
+                                            Pipeline& pipeline,
+                                            const std::vector<std::uint32_t>& dynamic_offsets) {
         vkCmdBindDescriptorSets(handle, pipeline.get_bind_point(),
                                 pipeline.get_layout().get_handle(),
                                 0, 1, &descriptor_set.get_handle(),
-                                0, nullptr);
+                                dynamic_offsets.size(), dynamic_offsets.data());
     }
 
     void CommandBuffer::bind_vertex_buffer(std::uint32_t first_binding,
@@ -312,6 +457,81 @@ namespace vkpp {
                          first_index, vertex_offset, first_instance);
     }
 
+    void CommandBuffer::draw_indirect(Buffer& buffer,
+                                      VkDeviceSize offset,
+                                      std::uint32_t draw_count,
+                                      std::uint32_t stride) {
+        vkCmdDrawIndirect(handle, buffer.get_handle(), offset,
+                          draw_count, stride);
+    }
+
+    void CommandBuffer::draw_indexed_indirect(Buffer& buffer,
+                                              VkDeviceSize offset,
+                                              std::uint32_t draw_count,
+                                              std::uint32_t stride) {
+        vkCmdDrawIndexedIndirect(handle, buffer.get_handle(), offset,
+                                 draw_count, stride);
+    }
+
+#ifdef VK_EXT_mesh_shader
+    void CommandBuffer::draw_mesh_tasks(std::uint32_t group_count_x,
+                                        std::uint32_t group_count_y,
+                                        std::uint32_t group_count_z) {
+        vkCmdDrawMeshTasksEXT(handle, group_count_x, group_count_y, group_count_z);
+    }
+
+    void CommandBuffer::setup_function_pointers(VkDevice device) {
+        vkCmdDrawMeshTasksEXT = (PFN_vkCmdDrawMeshTasksEXT) vkGetDeviceProcAddr(device, "vkCmdDrawMeshTasksEXT");
+        if (vkCmdDrawMeshTasksEXT == nullptr) {
+            throw Exception { "couldn't setup the command buffer!",
+            "the vkCmdDrawMeshTasksEXT fn doesn't exist!"};
+        }
+    }
+
+    PFN_vkCmdDrawMeshTasksEXT CommandBuffer::vkCmdDrawMeshTasksEXT = nullptr;
+#endif
+
+#ifdef VK_NV_shading_rate_image
+    void CommandBuffer::bind_shading_rate_image(ImageView& image_view) {
+        vkCmdBindShadingRateImageNV(handle, image_view.get_handle(), VK_IMAGE_LAYOUT_SHADING_RATE_OPTIMAL_NV);
+    }
+
+    void CommandBuffer::unbind_shading_rate_image() {
+        vkCmdBindShadingRateImageNV(handle, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_SHADING_RATE_OPTIMAL_NV);
+    }
+
+    void CommandBuffer::setup_shading_rate_function_pointers(VkDevice device) {
+        vkCmdBindShadingRateImageNV = (PFN_vkCmdBindShadingRateImageNV) vkGetDeviceProcAddr(device, "vkCmdBindShadingRateImageNV");
+        if (vkCmdBindShadingRateImageNV == nullptr) {
+            throw Exception { "couldn't setup the command buffer!",
+            "the vkCmdBindShadingRateImageNV fn doesn't exist!"};
+        }
+    }
+
+    PFN_vkCmdBindShadingRateImageNV CommandBuffer::vkCmdBindShadingRateImageNV = nullptr;
+#endif
+
+#ifdef VK_KHR_draw_indirect_count
+    void CommandBuffer::draw_indexed_indirect_count(Buffer& buffer, VkDeviceSize offset,
+                                                    Buffer& count_buffer, VkDeviceSize count_offset,
+                                                    std::uint32_t max_draw_count,
+                                                    std::uint32_t stride) {
+        vkCmdDrawIndexedIndirectCountKHR(handle, buffer.get_handle(), offset,
+                                         count_buffer.get_handle(), count_offset,
+                                         max_draw_count, stride);
+    }
+
+    void CommandBuffer::setup_indirect_count_function_pointers(VkDevice device) {
+        vkCmdDrawIndexedIndirectCountKHR = (PFN_vkCmdDrawIndexedIndirectCountKHR) vkGetDeviceProcAddr(device, "vkCmdDrawIndexedIndirectCountKHR");
+        if (vkCmdDrawIndexedIndirectCountKHR == nullptr) {
+            throw Exception { "couldn't setup the command buffer!",
+            "the vkCmdDrawIndexedIndirectCountKHR fn doesn't exist!"};
+        }
+    }
+
+    PFN_vkCmdDrawIndexedIndirectCountKHR CommandBuffer::vkCmdDrawIndexedIndirectCountKHR = nullptr;
+#endif
+
     void CommandBuffer::dispatch(std::uint32_t group_count_x,
                                  std::uint32_t group_count_y,
                                  std::uint32_t group_count_z) {
@@ -396,6 +616,7 @@ namespace vkpp {
         using std::swap;
 
         swap(lhs.handle, rhs.handle);
+        swap(lhs.staging_ring, rhs.staging_ring);
         swap(lhs.queue_family, rhs.queue_family);
         swap(lhs.device, rhs.device);
     }
@@ -408,6 +629,14 @@ namespace vkpp {
         return *queue_family;
     }
 
+    void CommandPool::set_staging_ring(StagingRing* staging_ring) {
+        this->staging_ring = staging_ring;
+    }
+
+    StagingRing* CommandPool::get_staging_ring() {
+        return staging_ring;
+    }
+
     void CommandPool::reset() {
         vkResetCommandPool(device, handle, VK_COMMAND_POOL_RESET_RELEASE_RESOURCES_BIT);
     }
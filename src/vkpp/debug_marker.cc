@@ -112,6 +112,20 @@ namespace vkpp {
         end(command_buffer);
     }
 
+    void DebugMarker::begin(CommandBuffer& command_buffer, const char* name, QueryPool& query_pool, QueryPool* statistics_pool) {
+        begin(command_buffer, name, query_pool);
+        if (statistics_pool != nullptr) {
+            statistics_pool->set_statistics_query(name, statistics_pool->query);
+            command_buffer.begin_query(*statistics_pool, statistics_pool->query++, 0);
+        }
+    }
+
+    void DebugMarker::close(CommandBuffer& command_buffer, const char* name, QueryPool& query_pool, QueryPool* statistics_pool) {
+        if (statistics_pool != nullptr)
+            command_buffer.end_query(*statistics_pool, statistics_pool->get_statistics_query(name));
+        close(command_buffer, name, query_pool);
+    }
+
     PFN_vkSetDebugUtilsObjectTagEXT DebugMarker::vkSetDebugUtilsObjectTagEXT = nullptr;
     PFN_vkSetDebugUtilsObjectNameEXT DebugMarker::vkSetDebugUtilsObjectNameEXT = nullptr;
     PFN_vkCmdBeginDebugUtilsLabelEXT DebugMarker::vkCmdBeginDebugUtilsLabelEXT = nullptr; 
@@ -0,0 +1,155 @@
+#include <vkpp/descriptor_cache.hh>
+
+#include <vkpp/device.hh>
+
+#include <vkpp/exception.hh>
+
+#include <algorithm>
+#include <utility>
+
+namespace vkpp {
+    DescriptorCache::DescriptorCache(Device& device, const std::vector<VkDescriptorPoolSize>& pool_sizes)
+                                    : pool_sizes { pool_sizes },
+                                      device { &device } {
+        descriptor_pools.emplace_back(device, pool_sizes);
+    }
+
+    DescriptorCache::DescriptorCache(DescriptorCache&& descriptor_cache) noexcept {
+        swap(*this, descriptor_cache);
+    }
+
+    DescriptorCache& DescriptorCache::operator=(DescriptorCache&& descriptor_cache) noexcept {
+        swap(*this, descriptor_cache);
+        return *this;
+    }
+
+    void swap(DescriptorCache& lhs, DescriptorCache& rhs) {
+        using std::swap;
+
+        swap(lhs.entries, rhs.entries);
+        swap(lhs.descriptor_pools, rhs.descriptor_pools);
+        swap(lhs.pool_sizes, rhs.pool_sizes);
+        swap(lhs.device, rhs.device);
+    }
+
+    DescriptorSet& DescriptorCache::get(DescriptorSet& descriptor_set,
+                                        const std::vector<DescriptorSet::Write>& writes) {
+        Key key;
+
+        key.reserve(1 + writes.size() * 5);
+
+        key.push_back(reinterpret_cast<std::uint64_t>(descriptor_set.get_handle()));
+
+        for (const auto& write : writes) {
+            key.push_back(write.binding);
+            key.push_back(reinterpret_cast<std::uint64_t>(write.buffer));
+            key.push_back(reinterpret_cast<std::uint64_t>(write.image_view));
+            key.push_back(reinterpret_cast<std::uint64_t>(write.sampler));
+            key.push_back(write.image_layout);
+        }
+
+        std::lock_guard<std::mutex> lock { mutex };
+
+        auto entry = entries.find(key);
+
+        if (entry != entries.end() && entry->second.version == descriptor_set.get_version())
+            return entry->second.descriptor_set;
+
+        if (entry == entries.end()) {
+            auto handle = allocate(descriptor_set.get_layout());
+            VkDescriptorPool freed_with_pool { VK_NULL_HANDLE };
+            auto device_handle = device->get_handle();
+
+            entry = entries.emplace(std::move(key), Entry {
+                DescriptorSet { handle, freed_with_pool, &descriptor_set.get_layout(), device_handle },
+                descriptor_set.get_version()
+            }).first;
+        }
+
+        // The base set was written since the copy was made (or it's a new copy), so
+        // the bindings that aren't replaced are copied over from it again, and then
+        // the per-draw resources are written on top of that, e.g. a hair style's.
+
+        auto& cached_set = entry->second.descriptor_set;
+
+        std::vector<VkCopyDescriptorSet> copies;
+
+        for (auto binding : descriptor_set.get_written_bindings()) {
+            if (std::any_of(writes.begin(), writes.end(), [&](const DescriptorSet::Write& write) {
+                    return write.binding == binding;
+                })) continue;
+
+            VkCopyDescriptorSet copy;
+            copy.sType = VK_STRUCTURE_TYPE_COPY_DESCRIPTOR_SET;
+            copy.pNext = nullptr;
+
+            copy.srcSet = descriptor_set.get_handle();
+            copy.srcBinding = binding;
+            copy.srcArrayElement = 0;
+
+            copy.dstSet = cached_set.get_handle();
+            copy.dstBinding = binding;
+            copy.dstArrayElement = 0;
+
+            copy.descriptorCount = descriptor_set.get_layout().get_binding(binding).count;
+
+            copies.push_back(copy);
+        }
+
+        vkUpdateDescriptorSets(device->get_handle(), 0, nullptr, copies.size(), copies.data());
+
+        for (const auto& write : writes)
+            cached_set.write(write);
+
+        entry->second.version = descriptor_set.get_version();
+
+        return cached_set;
+    }
+
+    void DescriptorCache::reset() {
+        std::lock_guard<std::mutex> lock { mutex };
+
+        entries.clear();
+
+        // Keeps the first pool around, since it'll likely be needed again.
+        descriptor_pools.resize(std::min<std::size_t>(descriptor_pools.size(), 1));
+
+        for (auto& descriptor_pool : descriptor_pools)
+            descriptor_pool.reset();
+    }
+
+    std::size_t DescriptorCache::size() const {
+        return entries.size();
+    }
+
+    std::size_t DescriptorCache::get_pool_count() const {
+        return descriptor_pools.size();
+    }
+
+    VkDescriptorSet DescriptorCache::allocate(DescriptorSet::Layout& layout) {
+        VkDescriptorSetAllocateInfo alloc_info;
+        alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        alloc_info.pNext = nullptr;
+
+        alloc_info.descriptorSetCount = 1;
+        alloc_info.pSetLayouts = &layout.get_handle();
+
+        VkDescriptorSet handle;
+
+        alloc_info.descriptorPool = descriptor_pools.back().get_handle();
+
+        VkResult error = vkAllocateDescriptorSets(device->get_handle(), &alloc_info, &handle);
+
+        if (error == VK_ERROR_OUT_OF_POOL_MEMORY || error == VK_ERROR_FRAGMENTED_POOL) {
+            descriptor_pools.emplace_back(*device, pool_sizes); // the last one is full.
+            alloc_info.descriptorPool = descriptor_pools.back().get_handle();
+            error = vkAllocateDescriptorSets(device->get_handle(), &alloc_info, &handle);
+        }
+
+        if (error) {
+            throw Exception { error, "couldn't allocate cached descriptor set!" };
+        }
+
+        return handle;
+    }
+}
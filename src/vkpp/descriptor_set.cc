@@ -1,4 +1,5 @@
 #include <vkpp/descriptor_set.hh>
+#include <vkpp/descriptor_cache.hh>
 
 #include <vkpp/device.hh>
 
@@ -6,9 +7,15 @@
 
 #include <vkpp/exception.hh>
 
+#include <algorithm>
 #include <utility>
+#include <mutex>
 
 namespace vkpp {
+    // The same set (e.g. a pipeline's set for the frame) can be written by
+    // several threads recording draws at once, which needs to be serialized.
+    static std::mutex descriptor_write_mutex;
+
     DescriptorSet::Layout::Layout(Device& logical_device)
                                  : device { logical_device.get_handle() } {
         VkDescriptorSetLayoutCreateInfo create_info;
@@ -102,14 +109,16 @@ namespace vkpp {
     DescriptorSet::DescriptorSet(VkDescriptorSet& descriptor_set,
                                  VkDescriptorPool& descriptor_pool,
                                  Layout* layout,
-                                 VkDevice& device)
+                                 VkDevice& device,
+                                 DescriptorCache* descriptor_cache)
                                 : handle { descriptor_set },
                                   pool   { descriptor_pool },
                                   layout { layout },
-                                  device { device } {  }
+                                  device { device },
+                                  cache  { descriptor_cache } {  }
 
     DescriptorSet::~DescriptorSet() noexcept {
-        if (handle != VK_NULL_HANDLE) {
+        if (handle != VK_NULL_HANDLE && pool != VK_NULL_HANDLE) {
             vkFreeDescriptorSets(device, pool, 1, &handle);
         }
     }
@@ -130,6 +139,10 @@ namespace vkpp {
         swap(lhs.pool,   rhs.pool);
         swap(lhs.layout, rhs.layout);
         swap(lhs.device, rhs.device);
+
+        swap(lhs.cache, rhs.cache);
+        swap(lhs.written_bindings, rhs.written_bindings);
+        swap(lhs.version, rhs.version);
     }
 
     VkDescriptorSet& DescriptorSet::get_handle() {
@@ -165,7 +178,15 @@ namespace vkpp {
         write_info.pBufferInfo      = &buffer_info;
         write_info.pTexelBufferView = nullptr;
 
+        std::lock_guard<std::mutex> lock { descriptor_write_mutex };
         vkUpdateDescriptorSets(device, 1, &write_info, 0, nullptr);
+        updated(binding);
+    }
+
+    void DescriptorSet::write(std::uint32_t binding,
+                              UniformRing& uniform_ring,
+                              const UniformRing::Range& range) {
+        write(binding, uniform_ring.get_buffer(), range.offset, range.size);
     }
 
     void DescriptorSet::write(std::uint32_t binding,
@@ -191,8 +212,41 @@ namespace vkpp {
         write_info.pBufferInfo      = nullptr;
         write_info.pTexelBufferView = nullptr;
 
+        std::lock_guard<std::mutex> lock { descriptor_write_mutex };
+        vkUpdateDescriptorSets(device, 1, &write_info, 0, nullptr);
+        updated(binding);
+    }
+
+#ifdef VK_KHR_acceleration_structure
+    void DescriptorSet::write(std::uint32_t binding,
+                              AccelerationStructure& acceleration_structure) {
+        VkWriteDescriptorSetAccelerationStructureKHR acceleration_structure_info;
+        acceleration_structure_info.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR;
+        acceleration_structure_info.pNext = nullptr;
+        acceleration_structure_info.accelerationStructureCount = 1;
+        acceleration_structure_info.pAccelerationStructures = &acceleration_structure.get_handle();
+
+        VkWriteDescriptorSet write_info;
+        write_info.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write_info.pNext = &acceleration_structure_info;
+
+        write_info.dstSet     = handle;
+        write_info.dstBinding = binding;
+
+        write_info.dstArrayElement = 0;
+
+        write_info.descriptorCount = 1;
+        write_info.descriptorType = layout->get_binding(binding).type;
+
+        write_info.pImageInfo       = nullptr;
+        write_info.pBufferInfo      = nullptr;
+        write_info.pTexelBufferView = nullptr;
+
+        std::lock_guard<std::mutex> lock { descriptor_write_mutex };
         vkUpdateDescriptorSets(device, 1, &write_info, 0, nullptr);
+        updated(binding);
     }
+#endif
 
     void DescriptorSet::write(std::uint32_t binding,
                               ImageView& image_view,
@@ -218,7 +272,82 @@ namespace vkpp {
         write_info.pBufferInfo      = nullptr;
         write_info.pTexelBufferView = nullptr;
 
+        std::lock_guard<std::mutex> lock { descriptor_write_mutex };
         vkUpdateDescriptorSets(device, 1, &write_info, 0, nullptr);
+        updated(binding);
+    }
+
+    DescriptorSet::Write::Write(std::uint32_t binding, Buffer& buffer)
+                               : binding { binding },
+                                 buffer  { buffer.get_handle() } {  }
+
+    DescriptorSet::Write::Write(std::uint32_t binding, ImageView& image_view)
+                               : binding      { binding },
+                                 image_view   { image_view.get_handle() },
+                                 image_layout { image_view.get_layout() } {  }
+
+    DescriptorSet::Write::Write(std::uint32_t binding, ImageView& image_view, Sampler& sampler)
+                               : binding      { binding },
+                                 image_view   { image_view.get_handle() },
+                                 image_layout { image_view.get_layout() },
+                                 sampler      { sampler.get_handle() } {  }
+
+    void DescriptorSet::write(const Write& write) {
+        VkDescriptorBufferInfo buffer_info;
+        buffer_info.buffer = write.buffer;
+        buffer_info.offset = 0;
+        buffer_info.range = VK_WHOLE_SIZE;
+
+        VkDescriptorImageInfo image_info;
+        image_info.imageView = write.image_view;
+        image_info.imageLayout = write.image_layout;
+        image_info.sampler = write.sampler;
+
+        VkWriteDescriptorSet write_info;
+        write_info.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write_info.pNext = nullptr;
+
+        write_info.dstSet     = handle;
+        write_info.dstBinding = write.binding;
+
+        write_info.dstArrayElement = 0;
+
+        write_info.descriptorCount = 1;
+        write_info.descriptorType = layout->get_binding(write.binding).type;
+
+        bool buffer_write = write.buffer != VK_NULL_HANDLE;
+
+        write_info.pImageInfo       = buffer_write ? nullptr : &image_info;
+        write_info.pBufferInfo      = buffer_write ? &buffer_info : nullptr;
+        write_info.pTexelBufferView = nullptr;
+
+        std::lock_guard<std::mutex> lock { descriptor_write_mutex };
+        vkUpdateDescriptorSets(device, 1, &write_info, 0, nullptr);
+        updated(write.binding);
+    }
+
+    DescriptorSet& DescriptorSet::with(const std::vector<Write>& writes) {
+        if (cache != nullptr)
+            return cache->get(*this, writes);
+
+        for (const auto& binding_write : writes)
+            write(binding_write);
+
+        return *this;
+    }
+
+    const std::vector<std::uint32_t>& DescriptorSet::get_written_bindings() const {
+        return written_bindings;
+    }
+
+    std::uint64_t DescriptorSet::get_version() const {
+        return version;
+    }
+
+    void DescriptorSet::updated(std::uint32_t binding) {
+        if (std::find(written_bindings.begin(), written_bindings.end(), binding) == written_bindings.end())
+            written_bindings.push_back(binding);
+        ++version;
     }
 
     DescriptorPool::DescriptorPool(Device& logical_device,
@@ -270,6 +399,8 @@ namespace vkpp {
         swap(lhs.handle, rhs.handle);
         swap(lhs.pool_sizes, rhs.pool_sizes);
         swap(lhs.device, rhs.device);
+
+        swap(lhs.descriptor_cache, rhs.descriptor_cache);
     }
 
     VkDescriptorPool& DescriptorPool::get_handle() {
@@ -280,6 +411,18 @@ namespace vkpp {
         return pool_sizes;
     }
 
+    void DescriptorPool::reset() {
+        vkResetDescriptorPool(device, handle, 0);
+    }
+
+    void DescriptorPool::set_descriptor_cache(DescriptorCache* descriptor_cache) {
+        this->descriptor_cache = descriptor_cache;
+    }
+
+    DescriptorCache* DescriptorPool::get_descriptor_cache() {
+        return descriptor_cache;
+    }
+
     DescriptorSet DescriptorPool::allocate(DescriptorSet::Layout& layout) {
         VkDescriptorSetAllocateInfo alloc_info;
         alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
@@ -296,7 +439,7 @@ namespace vkpp {
             throw Exception { error, "couldn't allocate descriptor set!" };
         }
 
-        return DescriptorSet { ds, handle, &layout, device };
+        return DescriptorSet { ds, handle, &layout, device, descriptor_cache };
     }
 
     std::vector<DescriptorSet> DescriptorPool::allocate(std::uint32_t amount,
@@ -325,7 +468,7 @@ namespace vkpp {
 
         for (auto ds : dss) {
             descriptor_sets.emplace_back(
-                ds, handle, &layout, device
+                ds, handle, &layout, device, descriptor_cache
             );
 
             if (!name.empty()) {
@@ -10,7 +10,9 @@ namespace vkpp {
     Device::Device(PhysicalDevice& physical_device,
                    const std::vector<Layer>& enabled_instance_layers,
                    const std::vector<Extension>& required_extensions,
-                   const VkPhysicalDeviceFeatures& required_features)
+                   const VkPhysicalDeviceFeatures& required_features,
+                   const void* extension_features,
+                   const std::vector<VkPhysicalDevice>& device_group)
                   : enabled_extensions { required_extensions },
                     enabled_features { required_features },
                     physical_device { &physical_device } {
@@ -41,9 +43,20 @@ namespace vkpp {
 
         VkDeviceCreateInfo create_info;
         create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-        create_info.pNext = nullptr;
+        create_info.pNext = extension_features;
         create_info.flags = 0;
 
+        // The queues and features are the ones of the first, which the others in the group match.
+        VkDeviceGroupDeviceCreateInfo group_create_info;
+        if (device_group.size() > 1) {
+            group_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_GROUP_DEVICE_CREATE_INFO;
+            group_create_info.pNext = extension_features;
+            group_create_info.physicalDeviceCount = static_cast<std::uint32_t>(device_group.size());
+            group_create_info.pPhysicalDevices = device_group.data();
+            create_info.pNext = &group_create_info;
+            device_count = group_create_info.physicalDeviceCount;
+        }
+
         std::vector<const char*> extension_names(required_extensions.size());
         for (std::size_t i { 0 }; i < extension_names.size(); ++i)
             extension_names[i] = required_extensions[i].name.c_str();
@@ -73,11 +86,14 @@ namespace vkpp {
         DebugMarker::object_name(handle, *this, VK_OBJECT_TYPE_DEVICE, "Logical Device");
 
         assign_queues(); // Get the queue object from the device.
+
+        memory_allocator = std::make_unique<MemoryAllocator>(handle, physical_device);
     }
 
     Device::~Device() noexcept {
         if (handle != VK_NULL_HANDLE) {
             wait_idle(); // for resources etc
+            memory_allocator.reset();
             vkDestroyDevice(handle, nullptr);
         }
     }
@@ -106,6 +122,11 @@ namespace vkpp {
 
         swap(lhs.physical_device, rhs.physical_device);
 
+        swap(lhs.pipeline_cache, rhs.pipeline_cache);
+        swap(lhs.memory_allocator, rhs.memory_allocator);
+
+        swap(lhs.device_count, rhs.device_count);
+
         swap(lhs.handle, rhs.handle);
     }
 
@@ -117,6 +138,24 @@ namespace vkpp {
         return *physical_device;
     }
 
+    void Device::set_pipeline_cache(VkPipelineCache pipeline_cache) {
+        this->pipeline_cache = pipeline_cache;
+    }
+
+    VkPipelineCache Device::get_pipeline_cache() const {
+        return pipeline_cache;
+    }
+
+    MemoryAllocator* Device::get_memory_allocator() {
+        return memory_allocator.get();
+    }
+
+    MemoryAllocator::Statistics Device::get_memory_statistics() const {
+        if (memory_allocator == nullptr)
+            return {  };
+        return memory_allocator->get_statistics();
+    }
+
     std::vector<Extension> Device::find(const std::vector<Extension>& extensions) const {
         return find(extensions, get_available_extensions());
     }
@@ -137,6 +176,10 @@ namespace vkpp {
         return compute_queue != nullptr;
     }
 
+    bool Device::has_async_compute_queue() const {
+        return has_compute_queue() && compute_queue != graphics_queue;
+    }
+
     bool Device::has_graphics_queue() const {
         return graphics_queue != nullptr;
     }
@@ -153,6 +196,18 @@ namespace vkpp {
         vkDeviceWaitIdle(handle);
     }
 
+    std::uint32_t Device::get_device_count() const {
+        return device_count;
+    }
+
+    bool Device::has_peer_copies(std::uint32_t heap_index, std::uint32_t local_device, std::uint32_t remote_device) const {
+        if (local_device >= device_count || remote_device >= device_count || local_device == remote_device)
+            return false;
+        VkPeerMemoryFeatureFlags peer_memory_features { 0 };
+        vkGetDeviceGroupPeerMemoryFeatures(handle, heap_index, local_device, remote_device, &peer_memory_features);
+        return (peer_memory_features & VK_PEER_MEMORY_FEATURE_COPY_DST_BIT) != 0;
+    }
+
     Queue& Device::get_compute_queue() {
         return *compute_queue;
     }
@@ -29,22 +29,58 @@ namespace vkpp {
     DeviceMemory::DeviceMemory(Device& logical_device, VkMemoryRequirements requirements,
                                Type memory_type) // Warning: default is host-side memory!
                               : size { requirements.size },
+                                allocator { logical_device.get_memory_allocator() },
                                 device { logical_device.get_handle() } {
+        auto& physical_device = logical_device.get_physical_device();
+
+        if (memory_type == Type::HostVisible) {
+            this->type = physical_device.find_host_visible_memory(requirements);
+        } else if (memory_type == Type::DeviceLocal) {
+            this->type = physical_device.find_device_local_memory(requirements);
+        }
+
+        if (allocator != nullptr) {
+            allocation = allocator->allocate(requirements, this->type);
+            handle = allocation.memory;
+            return;
+        }
+
         VkMemoryAllocateInfo alloc_info;
         alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
         alloc_info.pNext = nullptr;
 
         alloc_info.allocationSize = size;
+        alloc_info.memoryTypeIndex = this->type;
+
+        if (VkResult error = vkAllocateMemory(device, &alloc_info, nullptr, &handle)) {
+            throw Exception { error, "couldn't allocate device memory!" };
+        }
+    }
 
+    DeviceMemory::DeviceMemory(Device& logical_device, VkMemoryRequirements requirements,
+                               Type memory_type, VkMemoryAllocateFlags flags)
+                              : size { requirements.size },
+                                device { logical_device.get_handle() } {
         auto& physical_device = logical_device.get_physical_device();
 
         if (memory_type == Type::HostVisible) {
-            this->type = physical_device.find_host_visible_memory(requirements);
+            type = physical_device.find_host_visible_memory(requirements);
         } else if (memory_type == Type::DeviceLocal) {
-            this->type = physical_device.find_device_local_memory(requirements);
+            type = physical_device.find_device_local_memory(requirements);
         }
 
-        alloc_info.memoryTypeIndex = this->type;
+        VkMemoryAllocateFlagsInfo flags_info;
+        flags_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+        flags_info.pNext = nullptr;
+        flags_info.flags = flags;
+        flags_info.deviceMask = 0;
+
+        VkMemoryAllocateInfo alloc_info;
+        alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        alloc_info.pNext = &flags_info;
+
+        alloc_info.allocationSize = size;
+        alloc_info.memoryTypeIndex = type;
 
         if (VkResult error = vkAllocateMemory(device, &alloc_info, nullptr, &handle)) {
             throw Exception { error, "couldn't allocate device memory!" };
@@ -53,7 +89,11 @@ namespace vkpp {
 
     DeviceMemory::~DeviceMemory() noexcept {
         if (handle != VK_NULL_HANDLE) {
-            vkFreeMemory(device, handle, nullptr);
+            if (allocator != nullptr) {
+                allocator->free(allocation);
+            } else {
+                vkFreeMemory(device, handle, nullptr);
+            }
         }
     }
 
@@ -74,6 +114,9 @@ namespace vkpp {
 
         swap(lhs.size, rhs.size);
         swap(lhs.type, rhs.type);
+
+        swap(lhs.allocation, rhs.allocation);
+        swap(lhs.allocator,  rhs.allocator);
     }
 
     VkDeviceMemory& DeviceMemory::get_handle() {
@@ -88,12 +131,22 @@ namespace vkpp {
         return type;
     }
 
+    VkDeviceSize DeviceMemory::get_offset() const {
+        return allocation.offset;
+    }
+
     void DeviceMemory::map(VkDeviceSize offset, VkDeviceSize size, void** data) {
-        vkMapMemory(device, handle, offset, size, 0, data);
+        if (allocation.mapped != nullptr) {
+            *data = static_cast<char*>(allocation.mapped) + allocation.offset + offset;
+        } else {
+            vkMapMemory(device, handle, allocation.offset + offset, size, 0, data);
+        }
     }
 
     void DeviceMemory::unmap() {
-        vkUnmapMemory(device, handle);
+        if (allocation.mapped == nullptr) {
+            vkUnmapMemory(device, handle);
+        }
     }
 
     void DeviceMemory::copy(VkDeviceSize size, const void* data, VkDeviceSize offset) {
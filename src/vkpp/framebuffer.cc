@@ -89,6 +89,24 @@ namespace vkpp {
         }
     }
 
+    Framebuffer::Framebuffer(VkDevice& device,
+                             RenderPass& render_pass,
+                             const std::vector<VkImageView>& attachments,
+                             const VkExtent2D& extent)
+                            : extent { extent },
+                              image_views { attachments },
+                              render_pass { render_pass.get_handle() },
+                              device { device } {
+        auto create_info = partially_create_info();
+
+        create_info.attachmentCount = image_views.size();
+        create_info.pAttachments = image_views.data();
+
+        if (VkResult error = vkCreateFramebuffer(device, &create_info, nullptr, &handle)) {
+            throw Exception { error, "couldn't create framebuffer!" };
+        }
+    }
+
     Framebuffer::~Framebuffer() noexcept {
         if (handle != VK_NULL_HANDLE) {
             vkDestroyFramebuffer(device, handle, nullptr);
@@ -3,18 +3,22 @@
 #include <vkpp/device.hh>
 #include <vkpp/debug_marker.hh>
 #include <vkpp/command_buffer.hh>
+#include <vkpp/staging_ring.hh>
 #include <vkpp/queue.hh>
 
 #include <vkpp/exception.hh>
 
+#include <algorithm>
+#include <cstring>
 #include <utility>
 
 namespace vkpp {
     Image::Image(Device& logical_device, std::uint32_t width, std::uint32_t height,
                  std::uint32_t depth, VkFormat format, VkImageUsageFlags usage,
                  std::uint32_t mip_levels, VkSampleCountFlagBits samples,
-                 VkImageTiling tiling_mode)
-                : layout { VK_IMAGE_LAYOUT_UNDEFINED },
+                 VkImageTiling tiling_mode, std::uint32_t array_layers)
+                : array_layers { array_layers },
+                  layout { VK_IMAGE_LAYOUT_UNDEFINED },
                   tiling_mode { tiling_mode },
                   sharing_mode { VK_SHARING_MODE_EXCLUSIVE },
                   device { logical_device.get_handle() } {
@@ -46,7 +50,7 @@ namespace vkpp {
 
         this->mip_levels      = mip_levels;
         create_info.mipLevels = mip_levels;
-        create_info.arrayLayers = 1;
+        create_info.arrayLayers = array_layers;
 
         create_info.samples = samples;
         this->samples       = samples;
@@ -130,6 +134,7 @@ namespace vkpp {
         swap(lhs.aspect_mask, rhs.aspect_mask);
 
         swap(lhs.mip_levels, rhs.mip_levels);
+        swap(lhs.array_layers, rhs.array_layers);
         swap(lhs.samples,    rhs.samples);
 
         swap(lhs.layout, rhs.layout);
@@ -167,6 +172,10 @@ namespace vkpp {
         return layout;
     }
 
+    void Image::set_layout(VkImageLayout layout) {
+        this->layout = layout;
+    }
+
     VkImageAspectFlags Image::get_aspect_mask() const {
         return aspect_mask;
     }
@@ -175,6 +184,10 @@ namespace vkpp {
         return mip_levels;
     }
 
+    std::uint32_t Image::get_array_layers() const {
+        return array_layers;
+    }
+
     VkSampleCountFlagBits Image::get_samples() const {
         return samples;
     }
@@ -189,9 +202,75 @@ namespace vkpp {
         return requirements;
     }
 
+    std::vector<VkBufferImageCopy> Image::get_buffer_regions(VkDeviceSize& offset) const {
+        std::vector<VkBufferImageCopy> regions;
+
+        auto texel_size = get_texel_size(format);
+        if (texel_size == 0)
+            return regions;
+
+        for (std::uint32_t level { 0 }; level < mip_levels; ++level) {
+            VkBufferImageCopy region;
+
+            region.bufferOffset = offset;
+            region.bufferRowLength = 0; // i.e. tightly packed.
+            region.bufferImageHeight = 0;
+
+            region.imageSubresource.aspectMask = aspect_mask;
+            region.imageSubresource.mipLevel = level;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount = array_layers;
+
+            region.imageOffset = { 0, 0, 0 };
+            region.imageExtent = { std::max(extent.width  >> level, 1u),
+                                   std::max(extent.height >> level, 1u),
+                                   std::max(extent.depth  >> level, 1u) };
+
+            offset += texel_size * region.imageExtent.width * region.imageExtent.height * region.imageExtent.depth * array_layers;
+            offset  = (offset + 3) / 4 * 4; // the buffer offsets have to be a multiple of 4.
+
+            regions.push_back(region);
+        }
+
+        return regions;
+    }
+
+    VkDeviceSize Image::get_texel_size(VkFormat format) {
+        switch (format) {
+        case VK_FORMAT_R8_UNORM:
+        case VK_FORMAT_R8_SNORM:
+        case VK_FORMAT_R8_UINT:
+            return 1;
+        case VK_FORMAT_R8G8_UNORM:
+        case VK_FORMAT_R8G8_SNORM:
+        case VK_FORMAT_R16_UNORM:
+        case VK_FORMAT_R16_SFLOAT:
+        case VK_FORMAT_R16_UINT:
+            return 2;
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+        case VK_FORMAT_R16G16_UNORM:
+        case VK_FORMAT_R16G16_SFLOAT:
+        case VK_FORMAT_R32_UINT:
+        case VK_FORMAT_R32_SFLOAT:
+        case VK_FORMAT_D32_SFLOAT:
+            return 4;
+        case VK_FORMAT_R16G16B16A16_UNORM:
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+        case VK_FORMAT_R32G32_SFLOAT:
+            return 8;
+        case VK_FORMAT_R32G32B32A32_SFLOAT:
+            return 16;
+        default:
+            return 0;
+        }
+    }
+
     void Image::bind(DeviceMemory& device_memory, std::uint32_t offset) {
         memory = device_memory.get_handle();
-        vkBindImageMemory(device, handle, memory, offset);
+        vkBindImageMemory(device, handle, memory, device_memory.get_offset() + offset);
     }
 
     void Image::transition(CommandBuffer& command_buffer, VkImageLayout to) {
@@ -253,7 +332,9 @@ namespace vkpp {
                            VkAccessFlags src_access, VkAccessFlags dst_access,
                            VkImageLayout src_layout, VkImageLayout dst_layout,
                            VkPipelineStageFlags source_pipeline_stage,
-                           VkPipelineStageFlags destination_pipeline_stage) {
+                           VkPipelineStageFlags destination_pipeline_stage,
+                           std::uint32_t src_queue_family,
+                           std::uint32_t dst_queue_family) {
         VkImageMemoryBarrier barrier;
         barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
         barrier.pNext = nullptr;
@@ -261,17 +342,18 @@ namespace vkpp {
         barrier.oldLayout = src_layout;
         barrier.newLayout = dst_layout;
 
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        // Queue family ownership transfer if these aren't ignored.
+        barrier.srcQueueFamilyIndex = src_queue_family;
+        barrier.dstQueueFamilyIndex = dst_queue_family;
 
         barrier.image = get_handle();
 
         barrier.subresourceRange.aspectMask = get_aspect_mask();
 
         barrier.subresourceRange.baseMipLevel = 0;
-        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.levelCount = mip_levels;
         barrier.subresourceRange.baseArrayLayer = 0;
-        barrier.subresourceRange.layerCount = 1;
+        barrier.subresourceRange.layerCount = array_layers;
 
         barrier.srcAccessMask = src_access;
         barrier.dstAccessMask = dst_access;
@@ -309,7 +391,8 @@ namespace vkpp {
                                       static_cast<std::uint32_t>(image.get_height()),
                                       VK_FORMAT_R8G8B8A8_UNORM,
                                       VK_IMAGE_USAGE_SAMPLED_BIT |
-                                      VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                                      VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                                      (mip_levels > 1 ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0),
                                       mip_levels,
                                       VK_SAMPLE_COUNT_1_BIT,
                                       VK_IMAGE_TILING_OPTIMAL } {
@@ -344,20 +427,7 @@ namespace vkpp {
 
         bind(device_memory);
 
-        auto command_buffer = command_pool.allocate_and_begin();
-
-        transition(command_buffer, VK_IMAGE_LAYOUT_UNDEFINED,
-                                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-
-        command_buffer.copy_buffer_image(staging_buffer, *this);
-
-        transition(command_buffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
-        command_buffer.end();
-
-        command_pool.get_queue().submit(command_buffer)
-                                .wait_idle();
+        upload(command_pool, {}, mip_levels > 1);
     }
 
     DeviceImage::DeviceImage(Device& device,
@@ -453,7 +523,7 @@ namespace vkpp {
     DeviceImage::DeviceImage(Device& device,
                              std::uint32_t width, std::uint32_t height, std::uint32_t depth,
                              CommandPool& command_pool,
-                             std::vector<unsigned char>& volume,
+                             vkhr::LargeBuffer<unsigned char>& volume,
                              std::uint32_t mip_levels)
                             : Image { device,
                                       width,
@@ -461,6 +531,7 @@ namespace vkpp {
                                       depth,
                                       VK_FORMAT_R8_UNORM,
                                       VK_IMAGE_USAGE_SAMPLED_BIT |
+                                      VK_IMAGE_USAGE_TRANSFER_SRC_BIT | // e.g. vulkan::HairStyle::transfer_volumes.
                                       VK_IMAGE_USAGE_TRANSFER_DST_BIT |
                                       VK_IMAGE_USAGE_STORAGE_BIT,
                                       mip_levels,
@@ -497,33 +568,21 @@ namespace vkpp {
 
         bind(device_memory);
 
-        auto command_buffer = command_pool.allocate_and_begin();
-
-        transition(command_buffer, VK_IMAGE_LAYOUT_UNDEFINED,
-                                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-
-        command_buffer.copy_buffer_image(staging_buffer, *this);
-
-        transition(command_buffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
-        command_buffer.end();
-
-        command_pool.get_queue().submit(command_buffer)
-                                .wait_idle();
+        upload(command_pool);
     }
 
     DeviceImage::DeviceImage(Device& device,
                              std::uint32_t width, std::uint32_t height, std::uint32_t depth,
                              CommandPool& command_pool,
-                             std::vector<glm::i8vec4>& volume,
+                             vkhr::LargeBuffer<glm::i8vec2>& volume,
                              std::uint32_t mip_levels)
                             : Image { device,
                                       width,
                                       height,
                                       depth,
-                                      VK_FORMAT_R8G8B8A8_SNORM,
+                                      VK_FORMAT_R8G8_SNORM,
                                       VK_IMAGE_USAGE_SAMPLED_BIT |
+                                      VK_IMAGE_USAGE_TRANSFER_SRC_BIT | // e.g. vulkan::HairStyle::transfer_volumes.
                                       VK_IMAGE_USAGE_TRANSFER_DST_BIT |
                                       VK_IMAGE_USAGE_STORAGE_BIT,
                                       mip_levels,
@@ -560,15 +619,109 @@ namespace vkpp {
 
         bind(device_memory);
 
-        auto command_buffer = command_pool.allocate_and_begin();
+        upload(command_pool);
+    }
 
-        transition(command_buffer, VK_IMAGE_LAYOUT_UNDEFINED,
-                                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    DeviceImage::DeviceImage(Device& device, CommandPool& command_pool,
+                             const vkhr::Texture& texture)
+                            : Image { device,
+                                      texture.get_width(),
+                                      texture.get_height(),
+                                      get_texture_format(texture),
+                                      VK_IMAGE_USAGE_SAMPLED_BIT |
+                                      VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                                      static_cast<std::uint32_t>(texture.get_levels().size()),
+                                      VK_SAMPLE_COUNT_1_BIT,
+                                      VK_IMAGE_TILING_OPTIMAL } {
+        staging_buffer = Buffer {
+            device,
+            static_cast<VkDeviceSize>(texture.get_size_in_bytes()),
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+        };
 
-        command_buffer.copy_buffer_image(staging_buffer, *this);
+        auto staging_memory_requirements = staging_buffer.get_memory_requirements();
 
-        transition(command_buffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        staging_memory = DeviceMemory {
+            device,
+            staging_memory_requirements,
+            DeviceMemory::Type::HostVisible
+        };
+
+        staging_buffer.bind(staging_memory);
+
+        char* staging { nullptr };
+        staging_memory.map(0, texture.get_size_in_bytes(), reinterpret_cast<void**>(&staging));
+
+        std::vector<VkBufferImageCopy> regions;
+        VkDeviceSize offset { 0 };
+
+        // The levels are already in their block-compressed format, so this is the only copy made of them.
+        for (std::size_t level { 0 }; level < texture.get_levels().size(); ++level) {
+            const auto& texture_level = texture.get_levels()[level];
+            std::memcpy(staging + offset, texture.get_level_data(level), texture_level.size);
+
+            VkBufferImageCopy region;
+
+            region.bufferOffset = offset;
+            region.bufferRowLength = 0;
+            region.bufferImageHeight = 0;
+
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = static_cast<std::uint32_t>(level);
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount = 1;
+
+            region.imageOffset = { 0, 0, 0 };
+            region.imageExtent = { texture_level.width, texture_level.height, 1 };
+
+            regions.push_back(region);
+
+            offset += texture_level.size;
+        }
+
+        staging_memory.unmap();
+
+        auto image_memory_requirements = get_memory_requirements();
+
+        device_memory = DeviceMemory {
+            device,
+            image_memory_requirements,
+            DeviceMemory::Type::DeviceLocal
+        };
+
+        bind(device_memory);
+
+        upload(command_pool, regions);
+    }
+
+    VkFormat DeviceImage::get_texture_format(const vkhr::Texture& texture) {
+        switch (texture.get_format()) {
+        case vkhr::Texture::Format::BC1: return texture.is_srgb() ? VK_FORMAT_BC1_RGBA_SRGB_BLOCK : VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+        case vkhr::Texture::Format::BC5: return VK_FORMAT_BC5_UNORM_BLOCK;
+        case vkhr::Texture::Format::BC7: return texture.is_srgb() ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+        }
+
+        return VK_FORMAT_UNDEFINED;
+    }
+
+    std::uint32_t DeviceImage::get_mip_chain_length(std::uint32_t width, std::uint32_t height) {
+        std::uint32_t levels { 1 };
+        while ((width | height) >> levels)
+            ++levels;
+        return levels;
+    }
+
+    void DeviceImage::upload(CommandPool& command_pool, const std::vector<VkBufferImageCopy>& regions,
+                             bool generate_mips) {
+        // The staging buffer belongs to the image, so it's fine to batch this.
+        if (auto staging_ring = command_pool.get_staging_ring()) {
+            record_upload(staging_ring->get_command_buffer(), regions, generate_mips);
+            return;
+        }
+
+        auto command_buffer = command_pool.allocate_and_begin();
+
+        record_upload(command_buffer, regions, generate_mips);
 
         command_buffer.end();
 
@@ -576,6 +729,107 @@ namespace vkpp {
                                 .wait_idle();
     }
 
+    void DeviceImage::record_upload(CommandBuffer& command_buffer, const std::vector<VkBufferImageCopy>& regions,
+                                    bool generate_mips) {
+        // The other levels of e.g. the volume mips are written by their compute passes, not here.
+        if (mip_levels == 1 || (regions.empty() && !generate_mips)) {
+            transition(command_buffer, VK_IMAGE_LAYOUT_UNDEFINED,
+                                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+            if (regions.empty())
+                command_buffer.copy_buffer_image(staging_buffer, *this);
+            else command_buffer.copy_buffer_image(staging_buffer, *this, regions);
+            transition(command_buffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                       VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            return;
+        }
+
+        // Every level, unlike the transitions above.
+        transition(command_buffer, 0, VK_ACCESS_TRANSFER_WRITE_BIT,
+                   VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                   VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+        if (regions.empty()) {
+            command_buffer.copy_buffer_image(staging_buffer, *this);
+            generate_mipmaps(command_buffer);
+        } else {
+            command_buffer.copy_buffer_image(staging_buffer, *this, regions);
+            transition(command_buffer, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        }
+    }
+
+    void DeviceImage::generate_mipmaps(CommandBuffer& command_buffer) {
+        VkImageMemoryBarrier barrier;
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.pNext = nullptr;
+
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+
+        barrier.image = get_handle();
+
+        barrier.subresourceRange.aspectMask = get_aspect_mask();
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = 1;
+
+        auto width  = static_cast<std::int32_t>(extent.width),
+             height = static_cast<std::int32_t>(extent.height);
+
+        // Each level is blitted from the one before it, which is then done, and left for the shaders.
+        for (std::uint32_t level { 1 }; level < mip_levels; ++level) {
+            barrier.subresourceRange.baseMipLevel = level - 1;
+            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                            VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                            barrier);
+
+            VkImageBlit blit;
+
+            blit.srcSubresource = { get_aspect_mask(), level - 1, 0, 1 };
+            blit.srcOffsets[0] = { 0, 0, 0 };
+            blit.srcOffsets[1] = { width, height, 1 };
+
+            width  = std::max(width  / 2, 1);
+            height = std::max(height / 2, 1);
+
+            blit.dstSubresource = { get_aspect_mask(), level, 0, 1 };
+            blit.dstOffsets[0] = { 0, 0, 0 };
+            blit.dstOffsets[1] = { width, height, 1 };
+
+            vkCmdBlitImage(command_buffer.get_handle(),
+                           get_handle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           get_handle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           1, &blit, VK_FILTER_LINEAR);
+
+            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+            command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                            barrier);
+        }
+
+        barrier.subresourceRange.baseMipLevel = mip_levels - 1;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        command_buffer.pipeline_barrier(VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                        barrier);
+
+        layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    }
+
     void DeviceImage::staged_copy(vkhr::Image& image, CommandBuffer& command_buffer) {
         staging_memory.copy(image.get_size_in_bytes(), image.get_data());
 
@@ -588,7 +842,7 @@ namespace vkpp {
                                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
     }
 
-    void DeviceImage::staged_copy(std::vector<unsigned char>& volume, CommandBuffer& command_buffer) {
+    void DeviceImage::staged_copy(vkhr::LargeBuffer<unsigned char>& volume, CommandBuffer& command_buffer) {
         staging_memory.copy(volume.size() * sizeof(volume[0]), volume.data());
 
         transition(command_buffer, VK_IMAGE_LAYOUT_UNDEFINED,
@@ -617,6 +871,14 @@ namespace vkpp {
 
     ImageView::ImageView(Device& logical_device, Image& real_image,
                          VkImageLayout final_layout)
+                        : ImageView { logical_device, real_image, final_layout, 0, 1 } { }
+
+    ImageView::ImageView(Device& logical_device, Image& real_image,
+                         VkImageLayout final_layout,
+                         std::uint32_t base_mip_level,
+                         std::uint32_t mip_level_count,
+                         std::uint32_t base_array_layer,
+                         std::uint32_t array_layer_count)
                         : layout { final_layout },
                           image { real_image.get_handle() },
                           device { logical_device.get_handle() } {
@@ -629,6 +891,8 @@ namespace vkpp {
 
         if (real_image.get_extent().depth != 1) {
             create_info.viewType = VK_IMAGE_VIEW_TYPE_3D;
+        } else if (array_layer_count != 1) {
+            create_info.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
         } else {
             create_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
         }
@@ -641,10 +905,10 @@ namespace vkpp {
         create_info.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
 
         create_info.subresourceRange.aspectMask = real_image.get_aspect_mask();
-        create_info.subresourceRange.baseMipLevel = 0;
-        create_info.subresourceRange.levelCount = 1;
-        create_info.subresourceRange.baseArrayLayer = 0;
-        create_info.subresourceRange.layerCount = 1;
+        create_info.subresourceRange.baseMipLevel = base_mip_level;
+        create_info.subresourceRange.levelCount = mip_level_count;
+        create_info.subresourceRange.baseArrayLayer = base_array_layer;
+        create_info.subresourceRange.layerCount = array_layer_count;
 
         if (VkResult error = vkCreateImageView(device, &create_info, nullptr, &handle)) {
             throw Exception { error, "couldn't create image view!" };
@@ -3,6 +3,7 @@
 #include <vkpp/exception.hh>
 #include <vkpp/debug_marker.hh>
 
+#include <algorithm>
 #include <utility>
 
 namespace vkpp {
@@ -138,6 +139,32 @@ namespace vkpp {
         return physical_devices;
     }
 
+    std::vector<VkPhysicalDevice> Instance::find_device_group(PhysicalDevice& physical_device) const {
+        std::uint32_t group_count { 0 };
+        vkEnumeratePhysicalDeviceGroups(handle, &group_count, nullptr);
+
+        std::vector<VkPhysicalDeviceGroupProperties> groups(group_count);
+        for (auto& group : groups) {
+            group.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GROUP_PROPERTIES;
+            group.pNext = nullptr;
+        }
+
+        vkEnumeratePhysicalDeviceGroups(handle, &group_count, groups.data());
+
+        std::vector<VkPhysicalDevice> device_group { physical_device.get_handle() };
+
+        for (const auto& group : groups) {
+            auto first = group.physicalDevices, last = group.physicalDevices + group.physicalDeviceCount;
+            if (std::find(first, last, physical_device.get_handle()) == last)
+                continue;
+            for (auto device = first; device != last; ++device)
+                if (*device != physical_device.get_handle())
+                    device_group.push_back(*device); // after it, since it's device index 0.
+        }
+
+        return device_group;
+    }
+
     const std::vector<Extension>& Instance::get_enabled_extensions() const {
         return enabled_extensions;
     }
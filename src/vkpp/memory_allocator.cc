@@ -0,0 +1,168 @@
+#include <vkpp/memory_allocator.hh>
+
+#include <vkpp/physical_device.hh>
+
+#include <vkpp/exception.hh>
+
+#include <algorithm>
+#include <iterator>
+
+namespace vkpp {
+    MemoryAllocator::MemoryAllocator(VkDevice device, PhysicalDevice& physical_device, VkDeviceSize block_size)
+                                    : block_size { block_size },
+                                      buffer_image_granularity { physical_device.get_properties().limits.bufferImageGranularity },
+                                      memory_properties { &physical_device.get_memory_properties() },
+                                      device { device } { }
+
+    MemoryAllocator::~MemoryAllocator() noexcept {
+        for (auto& block : blocks) {
+            vkFreeMemory(device, block->memory, nullptr);
+        }
+    }
+
+    MemoryAllocator::Allocation MemoryAllocator::allocate(const VkMemoryRequirements& requirements, std::uint32_t type) {
+        std::lock_guard<std::mutex> lock { mutex };
+
+        Allocation allocation;
+
+        // We don't know if it's for a buffer or an image, so they are kept apart by the granularity.
+        VkDeviceSize alignment = std::max(requirements.alignment, buffer_image_granularity);
+
+        if (requirements.size <= block_size / 4) {
+            for (auto& block : blocks) {
+                if (block->type == type && sub_allocate(*block, requirements.size, alignment, allocation))
+                    break;
+            }
+
+            if (allocation.block == nullptr) {
+                auto block = create_block(type);
+                if (block != nullptr)
+                    sub_allocate(*block, requirements.size, alignment, allocation);
+            }
+        }
+
+        if (allocation.block == nullptr) {
+            // Large enough to have its own, or if we ran out of space for a new block.
+            VkMemoryAllocateInfo alloc_info;
+            alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            alloc_info.pNext = nullptr;
+
+            alloc_info.allocationSize = requirements.size;
+            alloc_info.memoryTypeIndex = type;
+
+            if (VkResult error = vkAllocateMemory(device, &alloc_info, nullptr, &allocation.memory)) {
+                throw Exception { error, "couldn't allocate device memory!" };
+            }
+
+            allocation.size = requirements.size;
+
+            statistics.reserved += allocation.size;
+            statistics.dedicated_allocations += 1;
+        }
+
+        statistics.used += allocation.size;
+        statistics.allocations += 1;
+
+        return allocation;
+    }
+
+    void MemoryAllocator::free(const Allocation& allocation) {
+        std::lock_guard<std::mutex> lock { mutex };
+
+        statistics.used -= allocation.size;
+        statistics.allocations -= 1;
+
+        if (allocation.block == nullptr) {
+            vkFreeMemory(device, allocation.memory, nullptr);
+            statistics.reserved -= allocation.size;
+            statistics.dedicated_allocations -= 1;
+            return;
+        }
+
+        auto& free_ranges = allocation.block->free_ranges;
+        auto range = free_ranges.emplace(allocation.offset, allocation.size).first;
+
+        // Coalesce with the free ranges right after and before it.
+        auto next = std::next(range);
+        if (next != free_ranges.end() && range->first + range->second == next->first) {
+            range->second += next->second;
+            free_ranges.erase(next);
+        }
+
+        if (range != free_ranges.begin()) {
+            auto previous = std::prev(range);
+            if (previous->first + previous->second == range->first) {
+                previous->second += range->second;
+                free_ranges.erase(range);
+            }
+        }
+    }
+
+    MemoryAllocator::Statistics MemoryAllocator::get_statistics() const {
+        std::lock_guard<std::mutex> lock { mutex };
+        return statistics;
+    }
+
+    bool MemoryAllocator::sub_allocate(Block& block, VkDeviceSize size, VkDeviceSize alignment, Allocation& allocation) {
+        for (auto range = block.free_ranges.begin(); range != block.free_ranges.end(); ++range) {
+            VkDeviceSize range_offset = range->first,
+                         range_size   = range->second;
+
+            VkDeviceSize offset = (range_offset + alignment - 1) / alignment * alignment;
+
+            if (offset + size > range_offset + range_size)
+                continue; // First-fit.
+
+            block.free_ranges.erase(range);
+
+            if (offset != range_offset)
+                block.free_ranges.emplace(range_offset, offset - range_offset);
+            if (offset + size != range_offset + range_size)
+                block.free_ranges.emplace(offset + size, range_offset + range_size - offset - size);
+
+            allocation.memory = block.memory;
+            allocation.offset = offset;
+            allocation.size   = size;
+            allocation.block  = &block;
+
+            if (block.mapped != nullptr)
+                allocation.mapped = block.mapped;
+
+            return true;
+        }
+
+        return false;
+    }
+
+    MemoryAllocator::Block* MemoryAllocator::create_block(std::uint32_t type) {
+        VkMemoryAllocateInfo alloc_info;
+        alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        alloc_info.pNext = nullptr;
+
+        alloc_info.allocationSize = block_size;
+        alloc_info.memoryTypeIndex = type;
+
+        auto block = std::make_unique<Block>();
+
+        if (vkAllocateMemory(device, &alloc_info, nullptr, &block->memory) != VK_SUCCESS)
+            return nullptr;
+
+        block->type = type;
+        block->size = block_size;
+        block->free_ranges.emplace(0, block_size);
+
+        if (memory_properties->memoryTypes[type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+            if (VkResult error = vkMapMemory(device, block->memory, 0, VK_WHOLE_SIZE, 0, &block->mapped)) {
+                vkFreeMemory(device, block->memory, nullptr);
+                throw Exception { error, "couldn't map device memory block!" };
+            }
+        }
+
+        statistics.reserved += block_size;
+        statistics.blocks += 1;
+
+        blocks.push_back(std::move(block));
+
+        return blocks.back().get();
+    }
+}
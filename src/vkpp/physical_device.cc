@@ -1,5 +1,7 @@
 #include <vkpp/physical_device.hh>
 
+#include <algorithm>
+
 namespace vkpp {
     PhysicalDevice::PhysicalDevice(const VkPhysicalDevice& physical_device)
                                   : handle { physical_device } {
@@ -46,6 +48,17 @@ namespace vkpp {
                     transfer_queue_family_index = i;
             }
         }
+
+        // Prefer a compute-only family, since work submitted on
+        // it can run asynchronously with the graphics queue's.
+        for (std::size_t i { 0 }; i < queue_families.size(); ++i) {
+            if (queue_families[i].queueCount > 0 &&
+                 (queue_families[i].queueFlags & VK_QUEUE_COMPUTE_BIT) &&
+                !(queue_families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
+                compute_queue_family_index = i;
+                break;
+            }
+        }
     }
 
     void PhysicalDevice::assign_queue_family_indices() {
@@ -108,6 +121,41 @@ namespace vkpp {
         return memory_properties.memoryHeaps[heap].size;
     }
 
+    bool PhysicalDevice::has_memory_budget() const {
+#ifdef VK_EXT_memory_budget
+        return std::find(available_extensions.begin(), available_extensions.end(),
+                         Extension { VK_EXT_MEMORY_BUDGET_EXTENSION_NAME }) != available_extensions.end();
+#else
+        return false;
+#endif
+    }
+
+    std::vector<PhysicalDevice::MemoryBudget> PhysicalDevice::get_memory_budgets() const {
+        std::vector<MemoryBudget> memory_budgets(memory_properties.memoryHeapCount);
+
+        for (std::size_t i { 0 }; i < memory_budgets.size(); ++i)
+            memory_budgets[i].budget = memory_properties.memoryHeaps[i].size;
+
+#ifdef VK_EXT_memory_budget
+        if (!has_memory_budget())
+            return memory_budgets;
+
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budget_properties { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT };
+        VkPhysicalDeviceMemoryProperties2 properties { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2 };
+        properties.pNext = &budget_properties;
+
+        // It changes with what's been allocated, so it has to be queried again every time.
+        vkGetPhysicalDeviceMemoryProperties2(handle, &properties);
+
+        for (std::size_t i { 0 }; i < memory_budgets.size(); ++i) {
+            memory_budgets[i].budget = budget_properties.heapBudget[i];
+            memory_budgets[i].usage  = budget_properties.heapUsage[i];
+        }
+#endif
+
+        return memory_budgets;
+    }
+
     std::uint32_t PhysicalDevice::find_memory(const VkMemoryRequirements& requirements,
                                               std::uint32_t property_flags) {
         for (std::uint32_t i { 0 }; i < memory_properties.memoryTypeCount; ++i) {
@@ -164,6 +212,11 @@ namespace vkpp {
         assign_queue_family_indices();
     }
 
+    void PhysicalDevice::assign_present_queue_indices() {
+        present_queue_family_index = graphics_queue_family_index;
+        assign_queue_family_indices();
+    }
+
     bool PhysicalDevice::has_present_queue(Surface& surface) const {
         if (!has_present_queue()) {
             VkBool32 presentation_supported { 0 };
@@ -194,6 +247,10 @@ namespace vkpp {
         return compute_queue_family_index != -1;
     }
 
+    bool PhysicalDevice::has_async_compute_queue() const {
+        return has_compute_queue() && compute_queue_family_index != graphics_queue_family_index;
+    }
+
     bool PhysicalDevice::has_graphics_queue() const {
         return graphics_queue_family_index != -1;
     }
@@ -199,7 +199,7 @@ namespace vkpp {
         create_info.basePipelineHandle = VK_NULL_HANDLE;
         create_info.basePipelineIndex = -1;
 
-        if (VkResult error = vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1,
+        if (VkResult error = vkCreateGraphicsPipelines(device, logical_device.get_pipeline_cache(), 1,
                                                        &create_info, nullptr, &handle)) {
             throw Exception { error, "couldn't create a graphics pipeline!" };
         }
@@ -289,6 +289,10 @@ namespace vkpp {
         input_assembly_state.topology = topology;
     }
 
+    void GraphicsPipeline::FixedFunction::enable_primitive_restart(bool enabled) {
+        input_assembly_state.primitiveRestartEnable = enabled ? VK_TRUE : VK_FALSE;
+    }
+
     std::uint32_t GraphicsPipeline::FixedFunction::get_patch_vertices() const {
         return tessellation_state.patchControlPoints;
     }
@@ -317,6 +321,21 @@ namespace vkpp {
         return scissor;
     }
 
+#ifdef VK_NV_shading_rate_image
+    void GraphicsPipeline::FixedFunction::enable_shading_rate_image(const std::vector<VkShadingRatePaletteEntryNV>& palette) {
+        shading_rate_palette_entries = palette;
+        shading_rate_palette.shadingRatePaletteEntryCount = shading_rate_palette_entries.size();
+        shading_rate_palette.pShadingRatePaletteEntries = shading_rate_palette_entries.data();
+
+        shading_rate_image_state.shadingRateImageEnable = VK_TRUE;
+        shading_rate_image_state.viewportCount = 1;
+        shading_rate_image_state.pShadingRatePalettes = &shading_rate_palette;
+
+        shading_rate_image_state.pNext = &coarse_sample_order_state;
+        viewport_state.pNext = &shading_rate_image_state;
+    }
+#endif
+
     void GraphicsPipeline::FixedFunction::set_line_width(float line_width) {
         rasterization_state.lineWidth = line_width;
     }
@@ -440,6 +459,22 @@ namespace vkpp {
             attachments.resize(a + 1);
         }
 
+        attachments[a].colorWriteMask =  VK_COLOR_COMPONENT_R_BIT |
+                                         VK_COLOR_COMPONENT_G_BIT |
+                                         VK_COLOR_COMPONENT_B_BIT |
+                                         VK_COLOR_COMPONENT_A_BIT;
+        attachments[a].blendEnable = VK_FALSE;
+
+        color_blending_state.attachmentCount = attachments.size();
+        color_blending_state.pAttachments    = attachments.data();
+    }
+
+    void GraphicsPipeline::FixedFunction::disable_color_writes_for(std::uint32_t a) {
+        if (attachments.size() <= a) {
+            attachments.resize(a + 1);
+        }
+
+        attachments[a].colorWriteMask = 0;
         attachments[a].blendEnable = VK_FALSE;
 
         color_blending_state.attachmentCount = attachments.size();
@@ -488,6 +523,48 @@ namespace vkpp {
         color_blending_state.pAttachments    = attachments.data();
     }
 
+    void GraphicsPipeline::FixedFunction::enable_accumulation_blending_for(std::uint32_t a) {
+        if (attachments.size() <= a) {
+            attachments.resize(a + 1);
+        }
+
+        attachments[a].colorWriteMask =  VK_COLOR_COMPONENT_R_BIT |
+                                         VK_COLOR_COMPONENT_G_BIT |
+                                         VK_COLOR_COMPONENT_B_BIT |
+                                         VK_COLOR_COMPONENT_A_BIT;
+        attachments[a].blendEnable = VK_TRUE;
+        attachments[a].srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+        attachments[a].dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+        attachments[a].colorBlendOp = VK_BLEND_OP_ADD;
+        attachments[a].srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        attachments[a].dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        attachments[a].alphaBlendOp = VK_BLEND_OP_ADD;
+
+        color_blending_state.attachmentCount = attachments.size();
+        color_blending_state.pAttachments    = attachments.data();
+    }
+
+    void GraphicsPipeline::FixedFunction::enable_revealage_blending_for(std::uint32_t a) {
+        if (attachments.size() <= a) {
+            attachments.resize(a + 1);
+        }
+
+        attachments[a].colorWriteMask =  VK_COLOR_COMPONENT_R_BIT |
+                                         VK_COLOR_COMPONENT_G_BIT |
+                                         VK_COLOR_COMPONENT_B_BIT |
+                                         VK_COLOR_COMPONENT_A_BIT;
+        attachments[a].blendEnable = VK_TRUE;
+        attachments[a].srcColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+        attachments[a].dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_COLOR;
+        attachments[a].colorBlendOp = VK_BLEND_OP_ADD;
+        attachments[a].srcAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+        attachments[a].dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        attachments[a].alphaBlendOp = VK_BLEND_OP_ADD;
+
+        color_blending_state.attachmentCount = attachments.size();
+        color_blending_state.pAttachments    = attachments.data();
+    }
+
     void GraphicsPipeline::FixedFunction::add_dynamic_state(VkDynamicState dynamic_state) {
         dynamic_states.push_back(dynamic_state);
         this->dynamic_state.dynamicStateCount = dynamic_states.size();
@@ -581,7 +658,15 @@ namespace vkpp {
 
         shader_info.module = shader_module.get_handle();
         shader_info.pName = entry_point.c_str();
-        shader_info.pSpecializationInfo = nullptr;
+
+        VkSpecializationInfo specialization_info;
+
+        specialization_info.mapEntryCount = shader_module.get_constants().size();
+        specialization_info.pMapEntries = shader_module.get_constants().data();
+        specialization_info.pData = shader_module.get_constants_data();
+        specialization_info.dataSize = shader_module.get_constants_data_size();
+
+        shader_info.pSpecializationInfo = &specialization_info;
 
         VkComputePipelineCreateInfo create_info;
         create_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
@@ -597,7 +682,7 @@ namespace vkpp {
         create_info.basePipelineHandle = VK_NULL_HANDLE;
         create_info.basePipelineIndex = -1;
 
-        if (VkResult error = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1,
+        if (VkResult error = vkCreateComputePipelines(device, logical_device.get_pipeline_cache(), 1,
                                                       &create_info, nullptr, &handle)) {
             throw Exception { error, "couldn't create a compute pipeline!" };
         }
@@ -0,0 +1,120 @@
+#include <vkpp/pipeline_cache.hh>
+
+#include <vkpp/device.hh>
+
+#include <vkpp/exception.hh>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+namespace vkpp {
+    PipelineCache::PipelineCache(Device& logical_device, const std::string& directory)
+                                : device { logical_device.get_handle() } {
+        const auto& properties = logical_device.get_physical_device().get_properties();
+
+        path = directory + "pipelines-";
+
+        for (auto byte : properties.pipelineCacheUUID) {
+            char hex[3];
+            std::snprintf(hex, sizeof(hex), "%02x", byte);
+            path.append(hex);
+        }
+
+        path.append("-" + std::to_string(properties.driverVersion) + ".cache");
+
+        std::ifstream file { path, std::ios::binary };
+
+        std::vector<char> data;
+
+        if (file) {
+            data.assign(std::istreambuf_iterator<char>(file),
+                        std::istreambuf_iterator<char>());
+        }
+
+        VkPipelineCacheCreateInfo create_info;
+        create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        create_info.pNext = nullptr;
+        create_info.flags = 0;
+
+        create_info.initialDataSize = data.size();
+        create_info.pInitialData    = data.data();
+
+        if (VkResult error = vkCreatePipelineCache(device, &create_info, nullptr, &handle)) {
+            // A stale or broken cache isn't fatal, we'll just have to start afresh.
+            create_info.initialDataSize = 0;
+            create_info.pInitialData    = nullptr;
+
+            if (vkCreatePipelineCache(device, &create_info, nullptr, &handle)) {
+                throw Exception { error, "couldn't create pipeline cache!" };
+            }
+        }
+    }
+
+    PipelineCache::~PipelineCache() noexcept {
+        if (handle != VK_NULL_HANDLE) {
+            vkDestroyPipelineCache(device, handle, nullptr);
+        }
+    }
+
+    PipelineCache::PipelineCache(PipelineCache&& pipeline_cache) noexcept {
+        swap(*this, pipeline_cache);
+    }
+
+    PipelineCache& PipelineCache::operator=(PipelineCache&& pipeline_cache) noexcept {
+        swap(*this, pipeline_cache);
+        return *this;
+    }
+
+    void swap(PipelineCache& lhs, PipelineCache& rhs) {
+        using std::swap;
+
+        swap(lhs.path, rhs.path);
+
+        swap(lhs.device, rhs.device);
+        swap(lhs.handle, rhs.handle);
+    }
+
+    VkPipelineCache& PipelineCache::get_handle() {
+        return handle;
+    }
+
+    const std::string& PipelineCache::get_path() const {
+        return path;
+    }
+
+    std::vector<char> PipelineCache::get_data() const {
+        std::size_t data_size { 0 };
+
+        if (VkResult error = vkGetPipelineCacheData(device, handle, &data_size, nullptr)) {
+            throw Exception { error, "couldn't get pipeline cache data size!" };
+        }
+
+        std::vector<char> data(data_size);
+
+        if (VkResult error = vkGetPipelineCacheData(device, handle, &data_size, data.data())) {
+            throw Exception { error, "couldn't get pipeline cache data!" };
+        }
+
+        data.resize(data_size);
+
+        return data;
+    }
+
+    bool PipelineCache::save() const {
+        if (handle == VK_NULL_HANDLE)
+            return false;
+
+        auto data = get_data();
+
+        std::ofstream file { path, std::ios::binary | std::ios::trunc };
+
+        if (!file)
+            return false;
+
+        file.write(data.data(), data.size());
+
+        return static_cast<bool>(file);
+    }
+}
@@ -26,7 +26,7 @@ namespace vkpp {
 
         ns_per_unit = device.get_physical_device().get_properties().limits.timestampPeriod;
 
-        timestamp_buffer = new std::uint64_t[query_count];
+        timestamp_buffer = new std::uint64_t[2 * query_count]; // and their availability.
 
         if (VkResult error = vkCreateQueryPool(this->device, &create_info, nullptr, &handle))
             throw Exception { error, "couldn't create query pool!" };
@@ -60,6 +60,10 @@ namespace vkpp {
 
         swap(lhs.timestamps, rhs.timestamps);
         swap(lhs.timestamp_ms_time, rhs.timestamp_ms_time);
+        swap(lhs.timestamp_spans, rhs.timestamp_spans);
+        swap(lhs.statistics_queries, rhs.statistics_queries);
+        swap(lhs.statistics, rhs.statistics);
+        swap(lhs.statistics_buffer, rhs.statistics_buffer);
         swap(lhs.timestamp_buffer, rhs.timestamp_buffer);
     }
 
@@ -122,21 +126,104 @@ namespace vkpp {
     }
 
     std::unordered_map<std::string, float>& QueryPool::request_timestamp_queries() {
-        get_results(0, get_query_count(),
-                    sizeof(std::uint64_t) * get_query_count(),
-                    timestamp_buffer, VK_QUERY_RESULT_64_BIT,
-                    sizeof(std::uint64_t));
+        if (query == 0)
+            return timestamp_ms_time;
+
+        // Only of the queries that were written, and never waiting for them: each one comes with
+        // whether it's available, and the timestamps that aren't yet keep their last durations.
+        get_results(0, query,
+                    2 * sizeof(std::uint64_t) * query,
+                    timestamp_buffer, VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT,
+                    2 * sizeof(std::uint64_t));
 
         for (const auto& timestamp : timestamps) {
-            std::int64_t begin_timestamp = timestamp_buffer[timestamp.second.begin];
-            std::int64_t end_timestamp   = timestamp_buffer[timestamp.second.end];
+            auto begin = timestamp.second.begin, end = timestamp.second.end;
+            if (begin >= query || end >= query)
+                continue;
+            if (timestamp_buffer[2 * begin + 1] == 0 || timestamp_buffer[2 * end + 1] == 0)
+                continue;
+
+            std::int64_t begin_timestamp = timestamp_buffer[2 * begin];
+            std::int64_t end_timestamp   = timestamp_buffer[2 * end];
             auto duration_in_ns  = (end_timestamp - begin_timestamp) * get_ns_per_unit();
             timestamp_ms_time[timestamp.first] = duration_in_ns / 1e6;
+            timestamp_spans[timestamp.first] = { begin_timestamp * static_cast<double>(get_ns_per_unit()),
+                                                 end_timestamp   * static_cast<double>(get_ns_per_unit()) };
         }
 
         return timestamp_ms_time;
     }
 
+    const std::unordered_map<std::string, QueryPool::TimestampSpan>& QueryPool::get_timestamp_spans() const {
+        return timestamp_spans;
+    }
+
+    void QueryPool::set_statistics_query(const std::string& name, std::uint32_t query) {
+        statistics_queries[name] = query;
+    }
+
+    std::uint32_t QueryPool::get_statistics_query(const std::string& name) const {
+        return statistics_queries.at(name);
+    }
+
+    std::unordered_map<std::string, QueryPool::PipelineStatistics>& QueryPool::request_statistics_queries() {
+        std::size_t counters { 0 }; // one 64-bit value for every enabled statistic.
+        for (auto flags = pipeline_statistics; flags != 0; flags &= flags - 1)
+            ++counters;
+
+        if (counters == 0 || query == 0)
+            return statistics;
+
+        std::size_t stride { counters + 1 }; // with the availability after the counters.
+
+        statistics_buffer.resize(stride * query_count);
+
+        // Not waiting either, so the queries that aren't available yet keep their old counters.
+        get_results(0, query, sizeof(std::uint64_t) * stride * query,
+                    statistics_buffer.data(), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT,
+                    sizeof(std::uint64_t) * stride);
+
+        for (const auto& statistics_query : statistics_queries) {
+            if (statistics_query.second >= query)
+                continue;
+
+            auto values = &statistics_buffer[statistics_query.second * stride];
+            if (values[counters] == 0)
+                continue;
+
+            auto& section = statistics[statistics_query.first];
+
+            // The results are in the same order as the bits of the flags.
+            for (std::uint32_t bit { 1 }, counter { 0 }; bit <= VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT; bit <<= 1) {
+                if ((pipeline_statistics & bit) == 0)
+                    continue;
+
+                auto value = values[counter++];
+
+                switch (bit) {
+                case VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT:
+                    section.vertex_invocations = value;
+                    break;
+                case VK_QUERY_PIPELINE_STATISTIC_GEOMETRY_SHADER_INVOCATIONS_BIT:
+                    section.geometry_invocations = value;
+                    break;
+                case VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT:
+                    section.clipping_primitives = value;
+                    break;
+                case VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT:
+                    section.fragment_invocations = value;
+                    break;
+                case VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT:
+                    section.compute_invocations = value;
+                    break;
+                default: break;
+                }
+            }
+        }
+
+        return statistics;
+    }
+
     std::vector<QueryPool> QueryPool::create(std::size_t count, Device& device, VkQueryType query_type, std::uint32_t query_count,
                                              VkQueryPipelineStatisticFlags pipeline_stats) {
         std::vector<QueryPool> query_pools;
@@ -151,6 +238,8 @@ namespace vkpp {
 
     void QueryPool::clear_timestamps() {
         timestamp_ms_time.clear();
+        timestamp_spans.clear();
+        statistics_queries.clear();
         timestamps.clear();
     }
 }
\ No newline at end of file
@@ -3,6 +3,36 @@
 #include <vkpp/exception.hh>
 
 namespace vkpp {
+    // Chained onto a submit that is only for one GPU of the group, and outlives it.
+    struct DeviceGroupSubmit {
+        DeviceGroupSubmit(VkSubmitInfo& submit_info, std::uint32_t device_index) {
+            if (device_index == Queue::AllDevices)
+                return;
+
+            wait_devices.assign(submit_info.waitSemaphoreCount, device_index);
+            signal_devices.assign(submit_info.signalSemaphoreCount, device_index);
+            device_mask = 1u << device_index;
+
+            info.sType = VK_STRUCTURE_TYPE_DEVICE_GROUP_SUBMIT_INFO;
+            info.pNext = submit_info.pNext;
+            info.waitSemaphoreCount = static_cast<std::uint32_t>(wait_devices.size());
+            info.pWaitSemaphoreDeviceIndices = wait_devices.data();
+            info.commandBufferCount = 1;
+            info.pCommandBufferDeviceMasks = &device_mask;
+            info.signalSemaphoreCount = static_cast<std::uint32_t>(signal_devices.size());
+            info.pSignalSemaphoreDeviceIndices = signal_devices.data();
+
+            submit_info.pNext = &info;
+        }
+
+        DeviceGroupSubmit(const DeviceGroupSubmit&) = delete;
+        DeviceGroupSubmit& operator=(const DeviceGroupSubmit&) = delete;
+
+        VkDeviceGroupSubmitInfo info;
+        std::vector<std::uint32_t> wait_devices, signal_devices;
+        std::uint32_t device_mask { 0 };
+    };
+
     Queue::Queue(const VkQueue& queue, std::uint32_t family_index)
                 : family_index { family_index }, handle { queue } { }
 
@@ -115,6 +145,124 @@ namespace vkpp {
         return *this;
     }
 
+    Queue& Queue::submit(CommandBuffer& command_buffer,
+                         const std::vector<Semaphore*>& wait,
+                         const std::vector<VkPipelineStageFlags>& wait_stages,
+                         const std::vector<Semaphore*>& signal) {
+        return submit(command_buffer, wait, wait_stages, signal, VkFence { VK_NULL_HANDLE });
+    }
+
+    Queue& Queue::submit(CommandBuffer& command_buffer,
+                         const std::vector<Semaphore*>& wait,
+                         const std::vector<VkPipelineStageFlags>& wait_stages,
+                         const std::vector<Semaphore*>& signal,
+                         Fence& fence,
+                         std::uint32_t device_index) {
+        return submit(command_buffer, wait, wait_stages, signal, fence.get_handle(), device_index);
+    }
+
+    Queue& Queue::submit(CommandBuffer& command_buffer,
+                         const std::vector<Semaphore*>& wait,
+                         const std::vector<VkPipelineStageFlags>& wait_stages,
+                         const std::vector<Semaphore*>& signal,
+                         VkFence fence, std::uint32_t device_index) {
+        std::vector<VkSemaphore> wait_semaphores(wait.size());
+        for (std::size_t i { 0 }; i < wait_semaphores.size(); ++i)
+            wait_semaphores[i] = wait[i]->get_handle();
+
+        std::vector<VkSemaphore> signal_semaphores(signal.size());
+        for (std::size_t i { 0 }; i < signal_semaphores.size(); ++i)
+            signal_semaphores[i] = signal[i]->get_handle();
+
+        VkSubmitInfo submit_info {  };
+        submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit_info.pNext = nullptr;
+
+        submit_info.waitSemaphoreCount = wait_semaphores.size();
+        submit_info.pWaitSemaphores = wait_semaphores.data();
+
+        submit_info.pWaitDstStageMask = wait_stages.data();
+
+        submit_info.commandBufferCount = 1;
+        submit_info.pCommandBuffers = &command_buffer.get_handle();
+
+        submit_info.signalSemaphoreCount = signal_semaphores.size();
+        submit_info.pSignalSemaphores = signal_semaphores.data();
+
+        DeviceGroupSubmit device_group_submit { submit_info, device_index };
+
+        if (VkResult error = vkQueueSubmit(handle, 1, &submit_info, fence)) {
+            throw Exception { error, "couldn't submit command buffer to the queue!" };
+        }
+
+        return *this;
+    }
+
+    Queue& Queue::submit(CommandBuffer& command_buffer,
+                         const std::vector<Semaphore*>& wait,
+                         const std::vector<VkPipelineStageFlags>& wait_stages,
+                         const std::vector<Semaphore*>& signal,
+                         std::uint32_t device_index) {
+        return submit(command_buffer, wait, wait_stages, signal, VkFence { VK_NULL_HANDLE }, device_index);
+    }
+
+#ifdef VK_KHR_timeline_semaphore
+    Queue& Queue::submit(CommandBuffer& command_buffer,
+                         const std::vector<Semaphore*>& wait,
+                         const std::vector<VkPipelineStageFlags>& wait_stages,
+                         const std::vector<Semaphore*>& signal,
+                         TimelineSemaphore& timeline,
+                         std::uint64_t timeline_value,
+                         std::uint32_t device_index) {
+        std::vector<VkSemaphore> wait_semaphores(wait.size());
+        for (std::size_t i { 0 }; i < wait_semaphores.size(); ++i)
+            wait_semaphores[i] = wait[i]->get_handle();
+
+        std::vector<VkSemaphore> signal_semaphores(signal.size());
+        for (std::size_t i { 0 }; i < signal_semaphores.size(); ++i)
+            signal_semaphores[i] = signal[i]->get_handle();
+
+        signal_semaphores.push_back(timeline.get_handle());
+
+        // The values of the binary semaphores are ignored.
+        std::vector<std::uint64_t> signal_values(signal_semaphores.size(), 0);
+        signal_values.back() = timeline_value;
+
+        VkTimelineSemaphoreSubmitInfoKHR timeline_info {  };
+        timeline_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+        timeline_info.pNext = nullptr;
+
+        timeline_info.waitSemaphoreValueCount = 0;
+        timeline_info.pWaitSemaphoreValues = nullptr;
+
+        timeline_info.signalSemaphoreValueCount = signal_values.size();
+        timeline_info.pSignalSemaphoreValues = signal_values.data();
+
+        VkSubmitInfo submit_info {  };
+        submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit_info.pNext = &timeline_info;
+
+        submit_info.waitSemaphoreCount = wait_semaphores.size();
+        submit_info.pWaitSemaphores = wait_semaphores.data();
+
+        submit_info.pWaitDstStageMask = wait_stages.data();
+
+        submit_info.commandBufferCount = 1;
+        submit_info.pCommandBuffers = &command_buffer.get_handle();
+
+        submit_info.signalSemaphoreCount = signal_semaphores.size();
+        submit_info.pSignalSemaphores = signal_semaphores.data();
+
+        DeviceGroupSubmit device_group_submit { submit_info, device_index };
+
+        if (VkResult error = vkQueueSubmit(handle, 1, &submit_info, VK_NULL_HANDLE)) {
+            throw Exception { error, "couldn't submit command buffer to the queue!" };
+        }
+
+        return *this;
+    }
+#endif
+
     Queue& Queue::wait_idle() {
         vkQueueWaitIdle(handle);
         return *this;
@@ -156,4 +304,36 @@ namespace vkpp {
 
         return *this;
     }
+
+#ifdef VK_GOOGLE_display_timing
+    Queue& Queue::present(SwapChain& swap_chain,
+                          std::uint32_t indices,
+                          Semaphore& wait,
+                          std::uint32_t present_id) {
+        VkPresentTimeGOOGLE present_time {  };
+        present_time.presentID = present_id;
+        present_time.desiredPresentTime = 0; // as soon as it can, like the others.
+
+        VkPresentTimesInfoGOOGLE present_times {  };
+        present_times.sType = VK_STRUCTURE_TYPE_PRESENT_TIMES_INFO_GOOGLE;
+        present_times.swapchainCount = 1;
+        present_times.pTimes = &present_time;
+
+        VkPresentInfoKHR present_info {  };
+        present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        present_info.pNext = &present_times;
+
+        present_info.waitSemaphoreCount = 1;
+        present_info.pWaitSemaphores = &wait.get_handle();
+        present_info.swapchainCount = 1;
+        present_info.pSwapchains = &swap_chain.get_handle();
+        present_info.pImageIndices = &indices;
+        present_info.pResults = nullptr;
+
+        auto state = vkQueuePresentKHR(handle,  &present_info);
+        swap_chain.set_state(state); // might be out-of-date...
+
+        return *this;
+    }
+#endif
 }
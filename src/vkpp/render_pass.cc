@@ -6,6 +6,9 @@
 #include <vkpp/exception.hh>
 
 #include <vkhr/rasterizer/depth_map.hh>
+#include <vkhr/rasterizer/opacity_map.hh>
+#include <vkhr/rasterizer/volume_target.hh>
+#include <vkhr/rasterizer/weighted_blended.hh>
 
 #include <utility>
 
@@ -13,7 +16,8 @@ namespace vkpp {
     RenderPass::RenderPass(Device& logical_device,
                            const std::vector<Attachment>& attachments,
                            const std::vector<Subpass>& subpasses,
-                           const std::vector<Dependency>& dependencies)
+                           const std::vector<Dependency>& dependencies,
+                           std::uint32_t view_mask)
                           : device { logical_device.get_handle() } {
         VkRenderPassCreateInfo create_info;
         create_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -125,6 +129,22 @@ namespace vkpp {
             create_info.pDependencies = nullptr;
         }
 
+        // Every subpass has the same views, and they're correlated since they all see the same geometry.
+        std::vector<std::uint32_t> view_masks(this->subpasses.size(), view_mask);
+
+        VkRenderPassMultiviewCreateInfo multiview_info;
+        multiview_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_MULTIVIEW_CREATE_INFO;
+        multiview_info.pNext = nullptr;
+        multiview_info.subpassCount = static_cast<std::uint32_t>(view_masks.size());
+        multiview_info.pViewMasks = view_masks.data();
+        multiview_info.dependencyCount = 0;
+        multiview_info.pViewOffsets = nullptr;
+        multiview_info.correlationMaskCount = 1;
+        multiview_info.pCorrelationMasks = &view_mask;
+
+        if (view_mask != 0)
+            create_info.pNext = &multiview_info;
+
         if (VkResult error = vkCreateRenderPass(device, &create_info, nullptr, &handle)) {
             throw Exception { error, "couldn't create the render pass!" };
         }
@@ -267,7 +287,8 @@ namespace vkpp {
         DebugMarker::object_name(device, imgui_pass, VK_OBJECT_TYPE_RENDER_PASS, "ImGui Pass");
     }
 
-    void RenderPass::create_modified_color_pass(RenderPass& color_pass, Device& device, SwapChain& swap_chain) {
+    void RenderPass::create_modified_color_pass(RenderPass& color_pass, Device& device, SwapChain& swap_chain,
+                                                std::uint32_t view_mask) {
         std::vector<RenderPass::Attachment> attachments {
             {
                 swap_chain.get_color_attachment_format(),
@@ -316,7 +337,8 @@ namespace vkpp {
              device,
              attachments,
              subpasses,
-             dependencies
+             dependencies,
+             view_mask
         };
 
         DebugMarker::object_name(device, color_pass, VK_OBJECT_TYPE_RENDER_PASS, "Color Pass");
@@ -366,4 +388,294 @@ namespace vkpp {
 
         DebugMarker::object_name(device, depth_pass, VK_OBJECT_TYPE_RENDER_PASS, "Depth Pass");
     }
+
+    // Same as the one above, but into every layer of a vkhr::vulkan::DepthMapArray at once.
+    void RenderPass::create_multiview_depth_pass(RenderPass& depth_pass, Device& device, std::uint32_t view_count) {
+        std::vector<RenderPass::Attachment> attachments {
+            {
+                vkhr::vulkan::DepthMap::get_attachment_format(),
+                vkhr::vulkan::DepthMap::get_read_depth_layout()
+            }
+        };
+
+        std::vector<RenderPass::Subpass> subpasses {
+            {
+                { 0, vkhr::vulkan::DepthMap::get_attachment_layout() }
+            }
+        };
+
+        std::vector<RenderPass::Dependency> dependencies {
+            {
+                VK_SUBPASS_EXTERNAL,
+                0,
+                VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                0,
+                VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+            },
+            {
+                0,
+                VK_SUBPASS_EXTERNAL,
+                VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                VK_ACCESS_SHADER_READ_BIT
+            }
+        };
+
+        depth_pass = RenderPass {
+             device,
+             attachments,
+             subpasses,
+             dependencies,
+             (1u << view_count) - 1 // all of the layers.
+        };
+
+        DebugMarker::object_name(device, depth_pass, VK_OBJECT_TYPE_RENDER_PASS, "Multiview Depth Pass");
+    }
+
+    void RenderPass::create_opacity_layer_pass(RenderPass& opacity_pass, Device& device) {
+        std::vector<RenderPass::Attachment> attachments {
+            {
+                vkhr::vulkan::OpacityMap::get_layer_format(),
+                vkhr::vulkan::OpacityMap::get_read_layer_layout()
+            }
+        };
+
+        std::vector<RenderPass::Subpass> subpasses {
+            {
+                { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL }
+            }
+        };
+
+        // The depth pass already makes its depth map visible to the fragment shader.
+        std::vector<RenderPass::Dependency> dependencies {
+            {
+                VK_SUBPASS_EXTERNAL,
+                0,
+                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                0,
+                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
+                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+            },
+            {
+                0,
+                VK_SUBPASS_EXTERNAL,
+                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                VK_ACCESS_SHADER_READ_BIT
+            }
+        };
+
+        opacity_pass = RenderPass {
+             device,
+             attachments,
+             subpasses,
+             dependencies
+        };
+
+        DebugMarker::object_name(device, opacity_pass, VK_OBJECT_TYPE_RENDER_PASS, "Opacity Layer Pass");
+    }
+
+    void RenderPass::create_scaled_volume_pass(RenderPass& volume_pass, Device& device) {
+        std::vector<RenderPass::Attachment> attachments {
+            {
+                vkhr::vulkan::VolumeTarget::get_color_format(),
+                vkhr::vulkan::VolumeTarget::get_read_color_layout()
+            },
+            {
+                vkhr::vulkan::DepthMap::get_attachment_format(),
+                vkhr::vulkan::DepthMap::get_read_depth_layout()
+            }
+        };
+
+        std::vector<RenderPass::Subpass> subpasses {
+            {
+                { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL },
+                { 1, vkhr::vulkan::DepthMap::get_attachment_layout() }
+            }
+        };
+
+        std::vector<RenderPass::Dependency> dependencies {
+            {
+                VK_SUBPASS_EXTERNAL,
+                0,
+                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                0,
+                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+            },
+            {
+                0,
+                VK_SUBPASS_EXTERNAL,
+                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                VK_ACCESS_SHADER_READ_BIT
+            }
+        };
+
+        volume_pass = RenderPass {
+             device,
+             attachments,
+             subpasses,
+             dependencies
+        };
+
+        DebugMarker::object_name(device, volume_pass, VK_OBJECT_TYPE_RENDER_PASS, "Scaled Volume Pass");
+    }
+
+    void RenderPass::create_weighted_blended_pass(RenderPass& weighted_blended_pass, Device& device, SwapChain& swap_chain) {
+        std::vector<RenderPass::Attachment> attachments {
+            {
+                vkhr::vulkan::WeightedBlended::get_accumulation_format(),
+                vkhr::vulkan::WeightedBlended::get_read_layout()
+            },
+            {
+                vkhr::vulkan::WeightedBlended::get_revealage_format(),
+                vkhr::vulkan::WeightedBlended::get_read_layout()
+            },
+            {
+                // Tested against the opaque depth of the color pass.
+                swap_chain.get_depth_attachment_format(),
+                swap_chain.get_depth_attachment_layout(),
+                VK_ATTACHMENT_STORE_OP_STORE,
+                VK_ATTACHMENT_LOAD_OP_LOAD,
+                VK_SAMPLE_COUNT_1_BIT,
+                swap_chain.get_depth_attachment_layout()
+            }
+        };
+
+        std::vector<RenderPass::Subpass> subpasses {
+            {
+                { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL },
+                { 1, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL },
+                { 2, swap_chain.get_depth_attachment_layout() }
+            }
+        };
+
+        std::vector<RenderPass::Dependency> dependencies {
+            {
+                VK_SUBPASS_EXTERNAL,
+                0,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+                VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_SHADER_READ_BIT |
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
+                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT
+            },
+            {
+                0,
+                VK_SUBPASS_EXTERNAL,
+                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                VK_ACCESS_SHADER_READ_BIT
+            }
+        };
+
+        weighted_blended_pass = RenderPass {
+             device,
+             attachments,
+             subpasses,
+             dependencies
+        };
+
+        DebugMarker::object_name(device, weighted_blended_pass, VK_OBJECT_TYPE_RENDER_PASS, "Weighted Blended Pass");
+    }
+
+    // Compatible with the color pass, so that the hair pipelines can be used in both, but the
+    // attachments are overwritten by the downsample instead, and are read by compute shaders.
+    void RenderPass::create_hair_pass(RenderPass& hair_pass, Device& device, SwapChain& swap_chain) {
+        std::vector<RenderPass::Attachment> attachments {
+            {
+                swap_chain.get_color_attachment_format(),
+                VK_IMAGE_LAYOUT_GENERAL,
+                VK_ATTACHMENT_STORE_OP_STORE,
+                VK_ATTACHMENT_LOAD_OP_DONT_CARE
+            },
+            {
+                swap_chain.get_depth_attachment_format(),
+                swap_chain.get_shader_read_only_layout(),
+                VK_ATTACHMENT_STORE_OP_STORE,
+                VK_ATTACHMENT_LOAD_OP_DONT_CARE
+            }
+        };
+
+        std::vector<RenderPass::Subpass> subpasses {
+            {
+                { 0, swap_chain.get_color_attachment_layout() },
+                { 1, swap_chain.get_depth_attachment_layout() }
+            },
+            {
+                { 0, swap_chain.get_color_attachment_layout() },
+                { 1, swap_chain.get_shader_read_only_layout() }
+            },
+        };
+
+        std::vector<RenderPass::Dependency> dependencies {
+            {
+                VK_SUBPASS_EXTERNAL,
+                0,
+                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                0,
+                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
+                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+            },
+            {
+                0,
+                1,
+                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
+                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
+                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                VK_ACCESS_INPUT_ATTACHMENT_READ_BIT
+            },
+            {
+                1,
+                VK_SUBPASS_EXTERNAL,
+                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                VK_ACCESS_SHADER_READ_BIT |
+                VK_ACCESS_SHADER_WRITE_BIT
+            }
+        };
+
+        hair_pass = RenderPass {
+             device,
+             attachments,
+             subpasses,
+             dependencies
+        };
+
+        DebugMarker::object_name(device, hair_pass, VK_OBJECT_TYPE_RENDER_PASS, "Hair Pass");
+    }
 }
@@ -20,7 +20,8 @@ namespace vkpp {
                      VkSamplerAddressMode wrap_v,
                      VkSamplerAddressMode wrap_w,
                      bool anisotropy,
-                     bool enable_compare_less_op)
+                     bool enable_compare_less_op,
+                     float max_lod)
                     : min_filter { min_filter },
                       mag_filter { mag_filter },
                       wrap_u { wrap_u },
@@ -46,7 +47,7 @@ namespace vkpp {
         create_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
         create_info.mipLodBias = 0.0;
         create_info.minLod = 0.0;
-        create_info.maxLod = 0.0;
+        create_info.maxLod = max_lod;
 
         create_info.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
 
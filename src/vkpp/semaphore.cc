@@ -64,4 +64,111 @@ namespace vkpp {
     VkSemaphore& Semaphore::get_handle() {
         return handle;
     }
+
+#ifdef VK_KHR_timeline_semaphore
+    TimelineSemaphore::~TimelineSemaphore() noexcept {
+        if (handle != VK_NULL_HANDLE) {
+            vkDestroySemaphore(device, handle, nullptr);
+        }
+    }
+
+    TimelineSemaphore TimelineSemaphore::create(Device& device, const char* name) {
+        TimelineSemaphore semaphore { device };
+        DebugMarker::object_name(device, semaphore,
+                                 VK_OBJECT_TYPE_SEMAPHORE,
+                                 name);
+        return semaphore;
+    }
+
+    TimelineSemaphore::TimelineSemaphore(Device& logical_device, std::uint64_t initial_value)
+                                        : device { logical_device.get_handle() } {
+        VkSemaphoreTypeCreateInfoKHR type_info;
+        type_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+        type_info.pNext = nullptr;
+        type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+        type_info.initialValue  = initial_value;
+
+        VkSemaphoreCreateInfo create_info;
+        create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        create_info.pNext = &type_info;
+        create_info.flags = 0;
+
+        if (VkResult error = vkCreateSemaphore(device, &create_info, nullptr, &handle)) {
+            throw Exception { error, "couldn't create timeline semaphore!" };
+        }
+    }
+
+    TimelineSemaphore::TimelineSemaphore(TimelineSemaphore&& semaphore) noexcept {
+        swap(*this, semaphore);
+    }
+
+    TimelineSemaphore& TimelineSemaphore::operator=(TimelineSemaphore&& semaphore) noexcept {
+        swap(*this, semaphore);
+        return *this;
+    }
+
+    void swap(TimelineSemaphore& lhs, TimelineSemaphore& rhs) {
+        using std::swap;
+
+        swap(lhs.handle, rhs.handle);
+        swap(lhs.device, rhs.device);
+    }
+
+    VkSemaphore& TimelineSemaphore::get_handle() {
+        return handle;
+    }
+
+    std::uint64_t TimelineSemaphore::get_value() const {
+        std::uint64_t value { 0 };
+        if (VkResult error = vkGetSemaphoreCounterValueKHR(device, handle, &value)) {
+            throw Exception { error, "couldn't get the timeline semaphore value!" };
+        }
+
+        return value;
+    }
+
+    bool TimelineSemaphore::wait(std::uint64_t value, std::uint64_t timeout) const {
+        VkSemaphoreWaitInfoKHR wait_info;
+        wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+        wait_info.pNext = nullptr;
+        wait_info.flags = 0;
+        wait_info.semaphoreCount = 1;
+        wait_info.pSemaphores = &handle;
+        wait_info.pValues = &value;
+
+        VkResult result = vkWaitSemaphoresKHR(device, &wait_info, timeout);
+
+        if (result != VK_SUCCESS && result != VK_TIMEOUT) {
+            throw Exception { result, "couldn't wait on the timeline semaphore!" };
+        }
+
+        return result == VK_SUCCESS;
+    }
+
+    void TimelineSemaphore::signal(std::uint64_t value) {
+        VkSemaphoreSignalInfoKHR signal_info;
+        signal_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO_KHR;
+        signal_info.pNext = nullptr;
+        signal_info.semaphore = handle;
+        signal_info.value = value;
+
+        if (VkResult error = vkSignalSemaphoreKHR(device, &signal_info)) {
+            throw Exception { error, "couldn't signal the timeline semaphore!" };
+        }
+    }
+
+    void TimelineSemaphore::setup_function_pointers(VkDevice device) {
+        vkGetSemaphoreCounterValueKHR = (PFN_vkGetSemaphoreCounterValueKHR) vkGetDeviceProcAddr(device, "vkGetSemaphoreCounterValueKHR");
+        vkWaitSemaphoresKHR  = (PFN_vkWaitSemaphoresKHR)  vkGetDeviceProcAddr(device, "vkWaitSemaphoresKHR");
+        vkSignalSemaphoreKHR = (PFN_vkSignalSemaphoreKHR) vkGetDeviceProcAddr(device, "vkSignalSemaphoreKHR");
+        if (!vkGetSemaphoreCounterValueKHR || !vkWaitSemaphoresKHR || !vkSignalSemaphoreKHR) {
+            throw Exception { "couldn't setup the timeline semaphore!",
+            "the VK_KHR_timeline_semaphore fns don't exist!"};
+        }
+    }
+
+    PFN_vkGetSemaphoreCounterValueKHR TimelineSemaphore::vkGetSemaphoreCounterValueKHR = nullptr;
+    PFN_vkWaitSemaphoresKHR TimelineSemaphore::vkWaitSemaphoresKHR = nullptr;
+    PFN_vkSignalSemaphoreKHR TimelineSemaphore::vkSignalSemaphoreKHR = nullptr;
+#endif
 }
@@ -10,8 +10,12 @@
 #include <windows.h>
 #endif
 
+#include <filesystem>
 #include <fstream>
+#include <future>
 #include <iostream>
+#include <iterator>
+#include <unordered_map>
 #include <utility>
 
 namespace vkpp {
@@ -36,6 +40,12 @@ namespace vkpp {
             shader_type = Type::Geometry;
         } else if (file_extension == "hlsl") {
             shader_type = Type::Compute;
+#ifdef VK_EXT_mesh_shader
+        } else if (file_extension == "task") {
+            shader_type = Type::Task;
+        } else if (file_extension == "mesh") {
+            shader_type = Type::Mesh;
+#endif
         } else {
             throw Exception { "couldn't create shader module!",
             "the shader at '" + file_path + "' isn't a stage" };
@@ -50,6 +60,7 @@ namespace vkpp {
         file_size = spirv.size();
 
         hashed_spirv = djb2a(spirv);
+        hashed_sources = hash_sources();
 
         VkShaderModuleCreateInfo create_info;
         create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
@@ -102,6 +113,7 @@ namespace vkpp {
 
         swap(lhs.file_size,    rhs.file_size);
         swap(lhs.hashed_spirv, rhs.hashed_spirv);
+        swap(lhs.hashed_sources, rhs.hashed_sources);
         swap(lhs.spirv,        rhs.spirv);
 
         swap(lhs.constants, rhs.constants);
@@ -114,18 +126,44 @@ namespace vkpp {
     }
 
     bool ShaderModule::recompile() {
+        compile();
+        return reload();
+    }
+
+    bool ShaderModule::compile() {
+        return compile(file_path, hashed_sources);
+    }
+
+    // Ray queries need SPIR-V 1.4 too, but they can be in any compute shader (see ray_tracing).
+    static bool uses_ray_queries(const std::string& file_path) {
+        std::ifstream file { file_path };
+        std::string source { std::istreambuf_iterator<char> { file },
+                             std::istreambuf_iterator<char> {      } };
+        return source.find("GL_EXT_ray_query") != std::string::npos;
+    }
+
+    bool ShaderModule::compile(const std::string& file_path, std::uint32_t& hashed_sources) {
+        auto source_hash = hash_sources(file_path);
+
+        if (source_hash == hashed_sources)
+            return false;
+
+        hashed_sources = source_hash;
+
+        auto file_extension = file_path.substr(file_path.find_last_of(".") + 1);
+        auto file_name      = file_path.substr(0, file_path.find_first_of("."));
+
         std::string compiler;
-        std::string shader_module_path;
 
         if (file_extension == "hlsl") {
             compiler = VKPP_SHADER_MODULE_HLSLC;
-            compiler.append(get_entry_point());
+            compiler.append(file_name.substr(file_name.find_last_of("\\/") + 1)); // entry point.
             compiler.append(" -c -o " + file_name + ".spv");
-            shader_module_path = file_name + ".spv";
         } else {
             compiler = VKPP_SHADER_MODULE_GLSLC;
+            if (file_extension == "task" || file_extension == "mesh" || uses_ray_queries(file_path))
+                compiler.append(VKPP_SHADER_MODULE_SPV14);
             compiler.append(" -o " + file_path + ".spv");
-            shader_module_path = file_path + ".spv";
         }
 
         compiler.append(" " + file_path);
@@ -151,6 +189,18 @@ namespace vkpp {
         }
 #endif
 
+        return true;
+    }
+
+    bool ShaderModule::reload() {
+        std::string shader_module_path;
+
+        if (file_extension == "hlsl") {
+            shader_module_path = file_name + ".spv";
+        } else {
+            shader_module_path = file_path + ".spv";
+        }
+
         auto spirv_candidate = load(shader_module_path);
         auto hash            = djb2a(spirv_candidate);
 
@@ -183,6 +233,91 @@ namespace vkpp {
         return false;
     }
 
+    void ShaderModule::compile(const std::vector<ShaderModule*>& shader_modules) {
+        auto sources = get_sources(shader_modules);
+        compile(sources);
+        update_sources(shader_modules, sources);
+    }
+
+    ShaderModule::Sources ShaderModule::get_sources(const std::vector<ShaderModule*>& shader_modules) {
+        // Pipelines share shaders, and we don't want two compilers writing the same file.
+        Sources sources;
+        for (auto shader_module : shader_modules)
+            sources.emplace(shader_module->file_path, shader_module->hashed_sources);
+        return sources;
+    }
+
+    void ShaderModule::compile(Sources& sources) {
+        std::vector<std::future<void>> compilations;
+        for (auto& source : sources) {
+            compilations.push_back(std::async(std::launch::async, [&source] {
+                compile(source.first, source.second);
+            }));
+        }
+
+        for (auto& compilation : compilations)
+            compilation.wait();
+    }
+
+    void ShaderModule::update_sources(const std::vector<ShaderModule*>& shader_modules, const Sources& sources) {
+        for (auto shader_module : shader_modules) {
+            auto source = sources.find(shader_module->file_path);
+            if (source != sources.end())
+                shader_module->hashed_sources = source->second;
+        }
+    }
+
+    std::uint32_t ShaderModule::hash_sources() const {
+        return hash_sources(file_path);
+    }
+
+    std::uint32_t ShaderModule::hash_sources(const std::string& file_path) {
+        std::vector<char> sources;
+        std::unordered_set<std::string> visited_files;
+        read_sources(file_path, sources, visited_files);
+
+        std::uint32_t hash { 5381 };
+
+        for (auto byte : sources) {
+            hash = hash * 33 ^ static_cast<int>(byte);
+        }
+
+        return hash;
+    }
+
+    void ShaderModule::read_sources(const std::string& file_path, std::vector<char>& sources,
+                                    std::unordered_set<std::string>& visited_files) {
+        if (!visited_files.insert(file_path).second)
+            return; // e.g. through include guards.
+
+        std::ifstream file { file_path };
+
+        if (!file)
+            return;
+
+        std::string directory = file_path.substr(0, file_path.find_last_of("\\/") + 1);
+
+        std::string line;
+        while (std::getline(file, line)) {
+            sources.insert(sources.end(), line.begin(), line.end());
+            sources.push_back('\n');
+
+            auto directive = line.find("#include");
+            if (directive == std::string::npos)
+                continue;
+
+            auto first_quote = line.find('"', directive);
+            auto last_quote  = line.find('"', first_quote + 1);
+
+            if (first_quote == std::string::npos || last_quote == std::string::npos)
+                continue;
+
+            auto include_path = directory + line.substr(first_quote + 1, last_quote - first_quote - 1);
+            read_sources(std::filesystem::path { include_path }.lexically_normal().string(),
+                         sources, visited_files);
+        }
+    }
+
     ShaderModule::Type ShaderModule::get_stage() const {
         return shader_type;
     }
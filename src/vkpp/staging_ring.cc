@@ -0,0 +1,136 @@
+#include <vkpp/staging_ring.hh>
+
+#include <vkpp/device.hh>
+#include <vkpp/queue.hh>
+
+#include <cstring>
+#include <utility>
+
+namespace vkpp {
+    StagingRing::StagingRing(Device& device, CommandPool& command_pool,
+                             VkDeviceSize size_in_bytes)
+                            : fence { device },
+                              command_pool { &command_pool } {
+        buffer = Buffer {
+            device,
+            size_in_bytes,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+        };
+
+        memory = DeviceMemory {
+            device,
+            buffer.get_memory_requirements(),
+            DeviceMemory::Type::HostVisible
+        };
+
+        buffer.bind(memory);
+
+        // It's host coherent, so it can stay mapped.
+        memory.map(0, size_in_bytes, reinterpret_cast<void**>(&mapped));
+    }
+
+    StagingRing::StagingRing(StagingRing&& staging_ring) noexcept {
+        swap(*this, staging_ring);
+    }
+
+    StagingRing& StagingRing::operator=(StagingRing&& staging_ring) noexcept {
+        swap(*this, staging_ring);
+        return *this;
+    }
+
+    void swap(StagingRing& lhs, StagingRing& rhs) {
+        using std::swap;
+
+        swap(lhs.buffer, rhs.buffer);
+        swap(lhs.memory, rhs.memory);
+        swap(lhs.mapped, rhs.mapped);
+
+        swap(lhs.offset, rhs.offset);
+        swap(lhs.uploaded_bytes, rhs.uploaded_bytes);
+
+        swap(lhs.recording, rhs.recording);
+
+        swap(lhs.command_buffer, rhs.command_buffer);
+        swap(lhs.fence, rhs.fence);
+
+        swap(lhs.command_pool, rhs.command_pool);
+
+        if (lhs.command_pool != nullptr && lhs.recording) lhs.command_pool->set_staging_ring(&lhs);
+        if (rhs.command_pool != nullptr && rhs.recording) rhs.command_pool->set_staging_ring(&rhs);
+    }
+
+    void StagingRing::begin() {
+        if (recording)
+            return;
+
+        offset = 0;
+        uploaded_bytes = 0;
+
+        command_buffer = command_pool->allocate_and_begin();
+        command_pool->set_staging_ring(this);
+
+        recording = true;
+    }
+
+    bool StagingRing::is_recording() const {
+        return recording;
+    }
+
+    bool StagingRing::copy(const void* data, VkDeviceSize size, Buffer& destination) {
+        if (!recording || size > buffer.get_size())
+            return false;
+
+        if (offset + size > buffer.get_size())
+            flush(); // and start again at the front.
+
+        std::memcpy(mapped + offset, data, static_cast<std::size_t>(size));
+        command_buffer.copy_buffer(buffer, destination, offset, 0);
+
+        // Keeps the next copy aligned for any texel or element.
+        offset = (offset + size + 15) / 16 * 16;
+        uploaded_bytes += size;
+
+        return true;
+    }
+
+    CommandBuffer& StagingRing::get_command_buffer() {
+        return command_buffer;
+    }
+
+    void StagingRing::flush() {
+        command_buffer.end();
+
+        fence.reset();
+        command_pool->get_queue().submit(command_buffer, { }, { }, { }, fence);
+        fence.wait_and_reset();
+
+        command_buffer = command_pool->allocate_and_begin();
+
+        offset = 0;
+    }
+
+    void StagingRing::submit() {
+        if (!recording)
+            return;
+
+        command_pool->set_staging_ring(nullptr);
+
+        command_buffer.end();
+
+        fence.reset();
+        command_pool->get_queue().submit(command_buffer, { }, { }, { }, fence);
+        fence.wait_and_reset();
+
+        command_buffer = CommandBuffer {  };
+
+        recording = false;
+    }
+
+    VkDeviceSize StagingRing::get_size() const {
+        return buffer.get_size();
+    }
+
+    VkDeviceSize StagingRing::get_uploaded_bytes() const {
+        return uploaded_bytes;
+    }
+}
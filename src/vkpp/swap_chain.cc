@@ -57,7 +57,8 @@ namespace vkpp {
         create_info.imageExtent = current_extent;
 
         create_info.imageArrayLayers = 1;
-        create_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_STORAGE_BIT;
+        create_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_STORAGE_BIT |
+                                 VK_IMAGE_USAGE_TRANSFER_DST_BIT; // the eyes are copied into it with stereo.
 
         std::int32_t queue_family_indices[] = {
             logical_device.get_physical_device().get_graphics_queue_family_index(),
@@ -101,6 +102,25 @@ namespace vkpp {
         command_pool.get_queue().submit(command_buffer).wait_idle();
     }
 
+    SwapChain::SwapChain(Device& logical_device, CommandPool& command_pool,
+                         const VkSurfaceFormatKHR& format,
+                         const VkExtent2D& extent,
+                         std::uint32_t image_count)
+                        : format { format },
+                          presentation_mode { PresentationMode::Immediate },
+                          current_extent { extent },
+                          device { logical_device.get_handle() } {
+        create_offscreen_images(logical_device, image_count);
+
+        auto command_buffer = command_pool.allocate_and_begin();
+        DebugMarker::begin(command_buffer, "Swapchain Depth Image Transition");
+        create_swapchain_depths(logical_device, command_buffer);
+        DebugMarker::end(command_buffer);
+        command_buffer.end();
+
+        command_pool.get_queue().submit(command_buffer).wait_idle();
+    }
+
     SwapChain::~SwapChain() noexcept {
         if (handle != VK_NULL_HANDLE) {
             vkDestroySwapchainKHR(device, handle, nullptr);
@@ -128,6 +148,9 @@ namespace vkpp {
         swap(lhs.general_image_views, rhs.general_image_views);
         swap(lhs.image_views, rhs.image_views);
 
+        swap(lhs.image_memories, rhs.image_memories);
+        swap(lhs.next_image, rhs.next_image);
+
         swap(lhs.format, rhs.format);
         swap(lhs.presentation_mode, rhs.presentation_mode);
         swap(lhs.current_extent, rhs.current_extent);
@@ -148,6 +171,8 @@ namespace vkpp {
     }
 
     std::uint32_t SwapChain::acquire_next_image(Fence& fence) {
+        if (is_offscreen())
+            return next_image++ % size(); // the fence won't be signaled.
         std::uint32_t next;
         vkAcquireNextImageKHR(device, handle, std::numeric_limits<std::uint64_t>::max(),
                               VK_NULL_HANDLE,
@@ -156,6 +181,8 @@ namespace vkpp {
     }
 
     std::uint32_t SwapChain::acquire_next_image(Semaphore& semaphore) {
+        if (is_offscreen())
+            return next_image++ % size(); // nor the semaphore.
         std::uint32_t next;
         state = vkAcquireNextImageKHR(device, handle,
                                       std::numeric_limits<std::uint64_t>::max(),
@@ -173,6 +200,10 @@ namespace vkpp {
                state == VK_SUBOPTIMAL_KHR; // Oh no
     }
 
+    bool SwapChain::is_offscreen() const {
+        return surface == nullptr;
+    }
+
     std::vector<Framebuffer> SwapChain::create_framebuffers(RenderPass& render_pass) {
         std::vector<Framebuffer> framebuffers;
 
@@ -208,6 +239,10 @@ namespace vkpp {
         return depth_buffer_view;
     }
 
+    Image& SwapChain::get_depth_buffer_image() {
+        return depth_buffer_image;
+    }
+
     std::vector<ImageView>& SwapChain::get_image_views() {
         return image_views;
     }
@@ -290,8 +325,6 @@ namespace vkpp {
         vkGetSwapchainImagesKHR(device, handle, &image_count, image_handles.data());
 
         images.reserve(image_count);
-        general_image_views.reserve(image_count);
-        image_views.reserve(image_count);
 
         std::size_t image_index { 0 };
         for (const auto& image_handle : image_handles) {
@@ -305,7 +338,43 @@ namespace vkpp {
                                 1, get_sample_count(),
                                 VK_IMAGE_TILING_OPTIMAL,
                                 false);
+        }
 
+        create_image_views();
+    }
+
+    void SwapChain::create_offscreen_images(Device& logical_device, std::uint32_t image_count) {
+        images.reserve(image_count);
+        image_memories.reserve(image_count);
+
+        for (std::uint32_t i { 0 }; i < image_count; ++i) {
+            images.emplace_back(logical_device,
+                                get_width(), get_height(),
+                                get_color_attachment_format(),
+                                VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                                VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+
+            std::string image_name { "Off-Screen Image #" + std::to_string(i) };
+            DebugMarker::object_name(device, images.back(), VK_OBJECT_TYPE_IMAGE, image_name.c_str());
+
+            image_memories.emplace_back(logical_device,
+                                        images.back().get_memory_requirements(),
+                                        DeviceMemory::Type::DeviceLocal);
+
+            DebugMarker::object_name(device, image_memories.back(), VK_OBJECT_TYPE_DEVICE_MEMORY, "Off-Screen Image Device Memory");
+
+            images.back().bind(image_memories.back());
+            image_handles.push_back(images.back().get_handle());
+        }
+
+        create_image_views();
+    }
+
+    void SwapChain::create_image_views() {
+        general_image_views.reserve(image_handles.size());
+        image_views.reserve(image_handles.size());
+
+        for (const auto& image_handle : image_handles) {
             VkImageViewCreateInfo create_info;
             create_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
             create_info.pNext = nullptr;
@@ -353,7 +422,8 @@ namespace vkpp {
             device,
             get_width(), get_height(),
             get_depth_attachment_format(),
-            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT
+            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT |
+            VK_IMAGE_USAGE_SAMPLED_BIT // for the strands rasterized in compute.
         };
 
         DebugMarker::object_name(device, depth_buffer_image, VK_OBJECT_TYPE_IMAGE, "Swapchain Depth Image");
@@ -436,4 +506,34 @@ namespace vkpp {
         return vsync ? SwapChain::PresentationMode::Fifo
                      : SwapChain::PresentationMode::Immediate;
     }
+
+#ifdef VK_GOOGLE_display_timing
+    std::vector<VkPastPresentationTimingGOOGLE> SwapChain::get_past_presentation_timing() {
+        std::vector<VkPastPresentationTimingGOOGLE> timings;
+
+        if (is_offscreen())
+            return timings;
+
+        std::uint32_t timing_count { 0 };
+        if (vkGetPastPresentationTimingGOOGLE(device, handle, &timing_count, nullptr) != VK_SUCCESS)
+            return timings; // e.g. out-of-date, and then they're gone with it.
+
+        timings.resize(timing_count);
+        if (vkGetPastPresentationTimingGOOGLE(device, handle, &timing_count, timings.data()) < VK_SUCCESS)
+            timing_count = 0;
+        timings.resize(timing_count); // VK_INCOMPLETE leaves the rest for the next call.
+
+        return timings;
+    }
+
+    void SwapChain::setup_display_timing_function_pointers(VkDevice device) {
+        vkGetPastPresentationTimingGOOGLE = (PFN_vkGetPastPresentationTimingGOOGLE) vkGetDeviceProcAddr(device, "vkGetPastPresentationTimingGOOGLE");
+        if (vkGetPastPresentationTimingGOOGLE == nullptr) {
+            throw Exception { "couldn't setup the swap chain!",
+            "the vkGetPastPresentationTimingGOOGLE fn doesn't exist!"};
+        }
+    }
+
+    PFN_vkGetPastPresentationTimingGOOGLE SwapChain::vkGetPastPresentationTimingGOOGLE = nullptr;
+#endif
 }
@@ -0,0 +1,81 @@
+#include <vkpp/uniform_ring.hh>
+
+#include <vkpp/device.hh>
+
+#include <vkpp/exception.hh>
+
+#include <utility>
+
+namespace vkpp {
+    UniformRing::UniformRing(Device& device, VkDeviceSize size_in_bytes) {
+        buffer = Buffer {
+            device,
+            size_in_bytes,
+            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
+        };
+
+        memory = DeviceMemory {
+            device,
+            buffer.get_memory_requirements(),
+            DeviceMemory::Type::HostVisible
+        };
+
+        buffer.bind(memory);
+
+        // It's host coherent, so it can stay mapped.
+        memory.map(0, size_in_bytes, reinterpret_cast<void**>(&mapped));
+
+        alignment = device.get_physical_device().get_properties().limits.minUniformBufferOffsetAlignment;
+    }
+
+    UniformRing::UniformRing(UniformRing&& uniform_ring) noexcept {
+        swap(*this, uniform_ring);
+    }
+
+    UniformRing& UniformRing::operator=(UniformRing&& uniform_ring) noexcept {
+        swap(*this, uniform_ring);
+        return *this;
+    }
+
+    void swap(UniformRing& lhs, UniformRing& rhs) {
+        using std::swap;
+
+        swap(lhs.buffer, rhs.buffer);
+        swap(lhs.memory, rhs.memory);
+        swap(lhs.mapped, rhs.mapped);
+
+        swap(lhs.offset, rhs.offset);
+        swap(lhs.alignment, rhs.alignment);
+    }
+
+    UniformRing::Range UniformRing::allocate(VkDeviceSize size_in_bytes) {
+        Range range;
+
+        range.offset = (offset + alignment - 1) / alignment * alignment;
+        range.size   = std::max<VkDeviceSize>(size_in_bytes, 1);
+
+        if (range.offset + range.size > buffer.get_size()) {
+            throw Exception { "couldn't allocate uniform range!", "the ring is full!" };
+        }
+
+        offset = range.offset + range.size;
+
+        return range;
+    }
+
+    void UniformRing::reset() {
+        offset = 0;
+    }
+
+    Buffer& UniformRing::get_buffer() {
+        return buffer;
+    }
+
+    VkDeviceSize UniformRing::get_size() const {
+        return buffer.get_size();
+    }
+
+    VkDeviceSize UniformRing::get_used_bytes() const {
+        return offset;
+    }
+}
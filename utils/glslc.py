@@ -16,13 +16,17 @@ class ShaderScript:
     """
 
     GLSLC = "glslc -O -g -c "
+    # Same as VKPP_SHADER_MODULE_SPV14 in vkpp's ShaderModule::compile.
+    GLSLC_SPV14 = "glslc -O -g --target-spv=spv1.4 -c "
 
     SHADER_TYPES = [ "*.vert",
                      "*.tesc",
                      "*.tese",
                      "*.geom",
                      "*.frag",
-                     "*.comp" ]
+                     "*.comp",
+                     "*.task",
+                     "*.mesh" ]
 
     def __init__(self):
         parser = argparse.ArgumentParser(description=self.DESCRIPTION,
@@ -41,6 +45,14 @@ class ShaderScript:
     def __exit__(self, error, value, trace):
         pass
 
+    # The mesh and task shaders, and the ray queries, need SPIR-V 1.4.
+    def needs_spv14(self, shader_file):
+        file_name, ext = os.path.splitext(shader_file)
+        if ext in [ ".task", ".mesh" ]:
+            return True
+        with open(shader_file) as shader:
+            return "GL_EXT_ray_query" in shader.read()
+
     def execute(self, location=sys.argv[0]):
         for directory in self.options.directories:
 
@@ -72,7 +84,10 @@ class ShaderScript:
                 command = command + dependencies.decode("utf-8")
                 command = command + "\t"
 
-                command = command + self.GLSLC
+                if self.needs_spv14(shader_file):
+                    command = command + self.GLSLC_SPV14
+                else:
+                    command = command + self.GLSLC
 
                 entry_point, ext = os.path.splitext(shader_file)
 